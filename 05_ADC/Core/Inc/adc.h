@@ -89,5 +89,13 @@ uint32_t read_adc_chx(void);
 */
 uint32_t read_adc_chx(void);
 
+/**
+* @brief            Convert result to mV.
+* @details          This function converts a raw 12-bit ADC0 result to mV for 0-5V range.
+* @param[in]        u16Raw - Raw ADC0 result.
+* @return           Result in mV.
+*/
+uint32_t adc_to_mv(uint16_t u16Raw);
+
 
 #endif	/* ADC_H */
@@ -0,0 +1,130 @@
+/**
+* @file				adc_cfg.h
+* @brief            Header for adc_cfg.c file
+*/
+
+#ifndef ADC_CFG_H
+#define ADC_CFG_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Calibration result, as left by the calibration sequence in ADC0 */
+typedef struct
+{
+	uint32_t u32Clps;
+	uint32_t u32Clp3;
+	uint32_t u32Clp2;
+	uint32_t u32Clp1;
+	uint32_t u32Clp0;
+	uint32_t u32Clpx;
+	uint32_t u32Clp9;
+	uint32_t u32Gain;			/* G */
+	uint32_t u32Offset;			/* OFS */
+	uint8_t u8Valid;			/* 1 once a calibration completed */
+} adc_cfg_cal_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Polls of SC3[CAL] before the calibration is given up; it takes about 15k ADCK = 2 ms at 8 MHz */
+#define ADC_CFG_CAL_TIMEOUT		(1000000U)
+
+/* Software oversampling: 13-16 bit results from 4^(bits - 12) conversions */
+#define ADC_CFG_OVS_MIN_BITS	(13U)
+#define ADC_CFG_OVS_MAX_BITS	(16U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Calibrate ADC0.
+* @details          Function to run the calibration sequence with 32 sample hardware averaging and a
+*                   software trigger, then restore SC2 / SC3 and store the result. Call it once after
+*                   ADC_init(), before any conversion is started.
+* @param[out]       pCal - Calibration result.
+* @return           1 if calibrated, 0 on time-out (pCal->u8Valid stays 0).
+*/
+uint8_t adc_cfg_calibrate(adc_cfg_cal_t *pCal);
+
+/**
+* @brief            Restore calibration.
+* @details          Function to write a stored calibration result back to ADC0, e.g. after a low power
+*                   mode reset the ADC, without running the sequence again.
+* @param[in]        pCal - Calibration result from adc_cfg_calibrate().
+* @return           1 if restored, 0 if pCal holds no valid calibration.
+*/
+uint8_t adc_cfg_restore(const adc_cfg_cal_t *pCal);
+
+/**
+* @brief            Set hardware averaging.
+* @details          Function to set how many conversions ADC0 averages into each result (SC3 AVGE/AVGS).
+*                   The result stays 12 bit: averaging lowers the noise, not the step size.
+* @param[in]        u8Samples - 1 (off), 4, 8, 16 or 32.
+* @return           1 if set, 0 if u8Samples is not one of these.
+*/
+uint8_t adc_cfg_average(uint8_t u8Samples);
+
+/**
+* @brief            Get hardware averaging.
+* @details          Function to return the conversions behind each result, from SC3.
+* @param        	void.
+* @return           1, 4, 8, 16 or 32.
+*/
+uint8_t adc_cfg_samples(void);
+
+/**
+* @brief            Set sample time.
+* @details          Function to set the input sample time (CFG2 SMPLTS). Longer sample times settle high
+*                   impedance sources such as the pot, at the cost of conversion rate.
+* @param[in]        u16Clocks - Sample time in ADCK clocks (2-256).
+* @return           1 if set, 0 if out of range.
+*/
+uint8_t adc_cfg_sample_time(uint16_t u16Clocks);
+
+/**
+* @brief            Oversampled conversion.
+* @details          Function to sum 4^(u8Bits - 12) software triggered conversions of one channel and
+*                   decimate the sum by 2^(u8Bits - 12). Needs at least 1 LSB of input noise to resolve
+*                   the extra bits, so leave hardware averaging off. Blocking, software trigger mode only.
+* @param[in]        u8Chan - ADC0 input channel (ADCH).
+* @param[in]        u8Bits - Result resolution (ADC_CFG_OVS_MIN_BITS-ADC_CFG_OVS_MAX_BITS).
+* @param[out]       pu32Result - Result, 0-(2^u8Bits - 1).
+* @return           1 if converted, 0 if u8Bits is out of range or ADC0 is hardware triggered.
+*/
+uint8_t adc_cfg_oversample(uint8_t u8Chan, uint8_t u8Bits, uint32_t *pu32Result);
+
+
+#endif	/* ADC_CFG_H */
@@ -0,0 +1,104 @@
+/**
+* @file				adc_conv.h
+* @brief            Header for adc_conv.c file
+*/
+
+#ifndef ADC_CONV_H
+#define ADC_CONV_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* 1: packed halfword kernel (Cortex-M4 DSP extension), 0: portable scalar kernel only */
+#if defined(__ARM_FEATURE_DSP) && (1 == __ARM_FEATURE_DSP)
+#define ADC_CONV_SIMD			(1U)
+#else
+#define ADC_CONV_SIMD			(0U)
+#endif
+
+/* Full scale of the 12 bit result */
+#define ADC_CONV_FULL_SCALE		(0xFFFU)
+
+/* Output scales: mV for 0-5V range, Q15 fraction of the 0-5V range */
+#define ADC_CONV_MV_SCALE		(5000U)
+#define ADC_CONV_Q15_SCALE		(32767U)
+
+/* y / 0xFFF rounded down, without a divide: 1 / (2^12 - 1) = 2^-12 * (1 + 2^-12 + 2^-24 + ...).
+   Exact for y = scale * result with both scales above and every 12 bit result; not for every scale */
+#define ADC_CONV_DIV_FULL_SCALE(y)	(((y) + ((y) >> 12U) + ((y) >> 24U) + 1U) >> 12U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Convert results to mV.
+* @details          Function to convert raw 12 bit results to mV for 0-5V range, (5000 * result) / 0xFFF
+*                   for each one. Two results per step with ADC_CONV_SIMD. pu16Mv may be pu16Raw.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pu16Mv - Results in mV.
+* @param[in]        u32Count - Number of results.
+* @return           void.
+*/
+void adc_conv_mv(const uint16_t *pu16Raw, uint16_t *pu16Mv, uint32_t u32Count);
+
+/**
+* @brief            Convert results to Q15.
+* @details          Function to convert raw 12 bit results to a Q15 fraction of the 0-5V range,
+*                   (32767 * result) / 0xFFF for each one. pi16Q15 may be pu16Raw.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pi16Q15 - Results in Q15 (0-32767).
+* @param[in]        u32Count - Number of results.
+* @return           void.
+*/
+void adc_conv_q15(const uint16_t *pu16Raw, int16_t *pi16Q15, uint32_t u32Count);
+
+/**
+* @brief            Convert results, scalar.
+* @details          Function to convert raw 12 bit results to (u32Scale * result) / 0xFFF one at a time.
+*                   Portable kernel, also used by adc_conv_mv() and adc_conv_q15() without ADC_CONV_SIMD.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pu16Out - Scaled results.
+* @param[in]        u32Count - Number of results.
+* @param[in]        u32Scale - Output at full scale, ADC_CONV_MV_SCALE or ADC_CONV_Q15_SCALE.
+* @return           void.
+*/
+void adc_conv_scalar(const uint16_t *pu16Raw, uint16_t *pu16Out, uint32_t u32Count, uint32_t u32Scale);
+
+
+#endif	/* ADC_CONV_H */
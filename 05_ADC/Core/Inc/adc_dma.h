@@ -0,0 +1,116 @@
+/**
+* @file				adc_dma.h
+* @brief            Header for adc_dma.c file
+*/
+
+#ifndef ADC_DMA_H
+#define ADC_DMA_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stddef.h>
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Called from the DMA interrupt with a filled half of the buffer (raw 12 bit results). The samples
+   stay valid until the DMA wraps back onto them, i.e. for the time of u32Count more conversions */
+typedef void (*adc_dma_block_t)(const uint16_t *pu16Samples, uint32_t u32Count);
+
+/* DMA statistics */
+typedef struct
+{
+	uint32_t u32Blocks;			/* Half buffers handed to the callback */
+	uint32_t u32Overruns;		/* Half buffers overwritten before the interrupt got to them */
+} adc_dma_stats_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* eDMA channel of ADC0, its interrupt is IRQ0 + channel */
+#define ADC_DMA_CH					(1U)
+
+/* DMAMUX request source: ADC0 */
+#define ADC_DMA_REQ_ADC0			(42U)
+
+/* IRQ1-DMA ch1 priority */
+#define ADC_DMA_IRQ_PRIO			(0xAU)
+
+/* Largest buffer: CITER holds 15 bits, and the count must be even */
+#define ADC_DMA_MAX_SAMPLES			(32766U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* DMA statistics, written by the DMA interrupt */
+extern volatile adc_dma_stats_t AdcDmaStats;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            ADC DMA Initialization.
+* @details          Function to switch the ADC_init() configuration to continuous conversions with
+*                   SC2[DMAEN] and set up eDMA channel ADC_DMA_CH as an endless copy of ADC0 R[0] into
+*                   pu16Buf: one 16 bit minor loop per conversion, a major loop over the whole buffer that
+*                   wraps back to its start, and interrupts at half and full buffer only. Call it after
+*                   ADC_init(), then adc_dma_start().
+* @param[out]       pu16Buf - Sample buffer, two halves.
+* @param[in]        u16Samples - Buffer size in samples, even (2-ADC_DMA_MAX_SAMPLES).
+* @param[in]        pfBlock - Called with each filled half buffer.
+* @return           1 if configured, 0 if u16Samples is odd or out of range (nothing written).
+*/
+uint8_t adc_dma_init(uint16_t *pu16Buf, uint16_t u16Samples, adc_dma_block_t pfBlock);
+
+/**
+* @brief            Start acquisition.
+* @details          Function to start continuous conversions of one channel into the buffer.
+* @param[in]        u16AdcChan - ADC Channel.
+* @return           void.
+*/
+void adc_dma_start(uint16_t u16AdcChan);
+
+/**
+* @brief            Stop acquisition.
+* @details          Function to stop the conversions. The DMA keeps its position in the buffer.
+* @param        	void.
+* @return           void.
+*/
+void adc_dma_stop(void);
+
+/**
+* @brief            DMA interrupt.
+* @details          Function to hand the half buffer the DMA has just left to the block callback.
+*                   Call it from DMA1_IRQHandler (channel ADC_DMA_CH).
+* @param        	void.
+* @return           void.
+*/
+void adc_dma_isr(void);
+
+
+#endif	/* ADC_DMA_H */
@@ -0,0 +1,176 @@
+/**
+* @file				adc_filt.h
+* @brief            Header for adc_filt.c file
+*/
+
+#ifndef ADC_FILT_H
+#define ADC_FILT_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* FIR stage */
+typedef struct
+{
+	const int16_t *pi16Coeffs;	/* u16Taps Q15 taps in time-reversed order, b[u16Taps-1] first (symmetric FIRs: any order) */
+	int16_t *pi16State;			/* 2 x u16Taps delay line, each input is written twice so the taps are contiguous */
+	uint16_t u16Taps;
+	uint16_t u16Index;			/* Delay line position of the next input */
+} adc_filt_fir_t;
+
+/* Cascaded biquad stage, direct form I */
+typedef struct
+{
+	const int16_t *pi16Coeffs;	/* 5 per section: b0, b1, b2, a1, a2 in Q15 >> u8PostShift, for
+								   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2] */
+	int32_t *pi32State;			/* 4 per section: x[n-1], x[n-2] in Q15, y[n-1], y[n-2] in Q31 */
+	uint8_t u8Sections;
+	uint8_t u8PostShift;		/* Coefficient headroom: 1 for |a1| up to 2 */
+} adc_filt_biquad_t;
+
+/* Moving average stage */
+typedef struct
+{
+	int16_t *pi16History;		/* Last u16Length inputs */
+	int32_t i32Sum;				/* Sum of pi16History */
+	uint16_t u16Length;			/* Power of 2 */
+	uint16_t u16Index;			/* Oldest input */
+	uint8_t u8Shift;			/* log2(u16Length) */
+} adc_filt_movavg_t;
+
+/* Pipeline stage */
+typedef struct
+{
+	uint8_t u8Type;				/* ADC_FILT_FIR / ADC_FILT_BIQUAD / ADC_FILT_MOVAVG */
+	void *pFilter;				/* adc_filt_fir_t / adc_filt_biquad_t / adc_filt_movavg_t */
+} adc_filt_stage_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Stage types */
+#define ADC_FILT_FIR			(0U)
+#define ADC_FILT_BIQUAD			(1U)
+#define ADC_FILT_MOVAVG			(2U)
+
+/* 1: FIR taps with SMLAD (Cortex-M4 DSP extension), 0: portable C */
+#if defined(__ARM_FEATURE_DSP) && (1 == __ARM_FEATURE_DSP)
+#define ADC_FILT_SIMD			(1U)
+#else
+#define ADC_FILT_SIMD			(0U)
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            FIR Initialization.
+* @details          Function to attach the taps and clear the delay line.
+* @param[out]       pFir - FIR stage.
+* @param[in]        pi16Coeffs - Q15 taps, time-reversed. The sum of their magnitudes must stay below 2.
+* @param[in]        u16Taps - Number of taps.
+* @param[in]        pi16State - Delay line, 2 x u16Taps.
+* @return           void.
+*/
+void adc_filt_fir_init(adc_filt_fir_t *pFir, const int16_t *pi16Coeffs, uint16_t u16Taps, int16_t *pi16State);
+
+/**
+* @brief            FIR filter.
+* @details          Function to filter a block of Q15 samples in place, 4 taps per loop step.
+* @param[in,out]    pFir - FIR stage.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_fir(adc_filt_fir_t *pFir, int16_t *pi16Data, uint32_t u32Count);
+
+/**
+* @brief            Biquad Initialization.
+* @details          Function to attach the coefficients and clear the state.
+* @param[out]       pBiquad - Biquad stage.
+* @param[in]        pi16Coeffs - 5 coefficients per section.
+* @param[in]        u8Sections - Number of sections.
+* @param[in]        u8PostShift - Coefficient scale: Q15 >> u8PostShift (0-2).
+* @param[in]        pi32State - State, 4 per section.
+* @return           void.
+*/
+void adc_filt_biquad_init(adc_filt_biquad_t *pBiquad, const int16_t *pi16Coeffs, uint8_t u8Sections,
+						  uint8_t u8PostShift, int32_t *pi32State);
+
+/**
+* @brief            Biquad filter.
+* @details          Function to filter a block of Q15 samples in place through each section in turn.
+*                   64 bit accumulator, Q31 feedback state, outputs rounded and saturated.
+* @param[in,out]    pBiquad - Biquad stage.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_biquad(adc_filt_biquad_t *pBiquad, int16_t *pi16Data, uint32_t u32Count);
+
+/**
+* @brief            Moving average Initialization.
+* @details          Function to attach and clear the history.
+* @param[out]       pAvg - Moving average stage.
+* @param[in]        pi16History - History, u16Length samples.
+* @param[in]        u16Length - Window, power of 2 (1-32768).
+* @return           1 if initialized, 0 if u16Length is not a power of 2.
+*/
+uint8_t adc_filt_movavg_init(adc_filt_movavg_t *pAvg, int16_t *pi16History, uint16_t u16Length);
+
+/**
+* @brief            Moving average filter.
+* @details          Function to average a block of Q15 samples in place over the last u16Length inputs,
+*                   with a running sum: O(1) per sample for any window.
+* @param[in,out]    pAvg - Moving average stage.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_movavg(adc_filt_movavg_t *pAvg, int16_t *pi16Data, uint32_t u32Count);
+
+/**
+* @brief            Run pipeline.
+* @details          Function to pass a block of Q15 samples through each stage in turn, in place.
+* @param[in]        pStages - Stages.
+* @param[in]        u8Stages - Number of stages.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_run(const adc_filt_stage_t *pStages, uint8_t u8Stages, int16_t *pi16Data, uint32_t u32Count);
+
+
+#endif	/* ADC_FILT_H */
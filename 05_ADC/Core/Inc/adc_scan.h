@@ -0,0 +1,125 @@
+/**
+* @file				adc_scan.h
+* @brief            Header for adc_scan.c file
+*/
+
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stddef.h>
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Called from the ADC0 interrupt with the raw 12 bit results of a sequence, in channel list order */
+typedef void (*adc_scan_callback_t)(const uint16_t *pu16Results, uint8_t u8Count);
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Channels per sequence: PDB0 channel 0 has 8 pre-triggers, they drive ADC0 SC1[0]-SC1[7] */
+#define ADC_SCAN_MAX_CHANNELS	(8U)
+
+/* PDB0 clock: bus clock, 40 MHz in NormalRUNmode_80MHz() */
+#define ADC_SCAN_PDB_CLOCK_HZ	(40000000U)
+
+/* Upper bound of one 12 bit conversion with SMPLTS=12 and ADCK=SOSCDIV2=8 MHz, used with the
+   hardware averaging of adc_cfg_samples() to reject rates the ADC cannot keep up with */
+#define ADC_SCAN_CONV_NS		(5000U)
+
+/* IRQ39-ADC0 priority */
+#define ADC_SCAN_IRQ_PRIO		(0xAU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Scan sequencer Initialization.
+* @details          Function to program ADC0 SC1[0]-SC1[n-1] with the channel list and PDB0 channel 0
+*                   pre-triggers, so one PDB0 period converts the whole list back-to-back. The ADC0
+*                   interrupt of the last channel reports the sequence. Call it after ADC_init() and
+*                   adc_cfg_average().
+* @param[in]        pu8Channels - ADC0 input channels (ADCH), converted in this order.
+* @param[in]        u8Count - Number of channels (1-ADC_SCAN_MAX_CHANNELS).
+* @param[in]        u32RateHz - Sequences per second.
+* @param[in]        pfCallback - Sequence callback, NULL for none.
+* @return           1 if configured, 0 if the list or the rate is not possible.
+*/
+uint8_t adc_scan_init(const uint8_t *pu8Channels, uint8_t u8Count, uint32_t u32RateHz, adc_scan_callback_t pfCallback);
+
+/**
+* @brief            Start scanning.
+* @details          Function to software trigger PDB0; it then restarts itself every period.
+* @param        	void.
+* @return           void.
+*/
+void adc_scan_start(void);
+
+/**
+* @brief            Stop scanning.
+* @details          Function to disable PDB0. A sequence already started completes.
+* @param        	void.
+* @return           void.
+*/
+void adc_scan_stop(void);
+
+/**
+* @brief            Read last sequence.
+* @details          Function to copy the raw results of the last completed sequence. Thread mode, the
+*                   copy is retried if the interrupt completed a sequence meanwhile.
+* @param[out]       pu16Results - Raw 12 bit results, one per channel of the list.
+* @return           Number of the sequence copied, 0 if none completed yet.
+*/
+uint32_t adc_scan_read(uint16_t *pu16Results);
+
+/**
+* @brief            Sequence errors.
+* @details          Function to return the PDB0 sequence errors: a pre-trigger came while the ADC was
+*                   still converting, so a channel of that sequence was skipped.
+* @param        	void.
+* @return           Sequence errors since adc_scan_init().
+*/
+uint32_t adc_scan_errors(void);
+
+/**
+* @brief            Scan interrupt.
+* @details          Function to read SC1[0]-SC1[n-1] results and report the sequence. Call it from
+*                   ADC0_IRQHandler.
+* @param        	void.
+* @return           void.
+*/
+void adc_scan_isr(void);
+
+
+#endif	/* ADC_SCAN_H */
@@ -15,6 +15,11 @@
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
 #include "clocks_and_modes.h"
 #include "adc.h"
+#include "adc_cfg.h"
+#include "adc_scan.h"
+#include "adc_dma.h"
+#include "adc_conv.h"
+#include "adc_filt.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
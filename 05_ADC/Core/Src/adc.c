@@ -10,6 +10,7 @@
 * 3) internal and external interfaces from this unit
 ==================================================================================================*/
 #include "adc.h"
+#include "adc_conv.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
@@ -61,7 +62,7 @@ void ADC_init(void)
 
 	ADC0->SC1[0] |= ADC_SC1_ADCH_MASK;	/* ADCH=1F: Module is disabled for conversions	*/
 										/* AIEN=0: Interrupts are disabled 			*/
-	ADC0->CFG1 |= (ADC_CFG1_ADIV_MASK | ADC_CFG1_MODE(1U));
+	ADC0->CFG1 = ADC_CFG1_ADIV(0U) | ADC_CFG1_MODE(1U);
 										/* ADICLK=0: Input clk=ALTCLK1=SOSCDIV2 	*/
 										/* ADIV=0: Prescaler=1 					*/
 										/* MODE=1: 12-bit conversion 				*/
@@ -110,7 +111,18 @@ uint32_t read_adc_chx(void)
 {
 	uint16_t adc_result = 0U;
 	adc_result = (uint16_t)(ADC0->R[0]); 		/* For SW trigger mode, R[0] is used */
-	return (uint32_t)((5000U*adc_result)/0xFFFU); /* Convert result to mv for 0-5V range */
+	return adc_to_mv(adc_result);				/* Convert result to mv for 0-5V range */
+}
+
+/**
+* @brief            Convert result to mV.
+* @details          This function converts a raw 12-bit ADC0 result to mV for 0-5V range.
+* @param[in]        u16Raw - Raw ADC0 result.
+* @return           Result in mV.
+*/
+uint32_t adc_to_mv(uint16_t u16Raw)
+{
+	return ADC_CONV_DIV_FULL_SCALE(ADC_CONV_MV_SCALE * (uint32_t)u16Raw);	/* (5000*u16Raw)/0xFFF, no divide */
 }
 
 
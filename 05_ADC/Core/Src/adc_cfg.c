@@ -0,0 +1,242 @@
+/**
+* @file				adc_cfg.c
+* @brief            ADC0 calibration, averaging and oversampling
+* @details			Calibration trims the converter's offset and gain once at boot; the result is kept so
+*					it can be written back later. Hardware averaging and software oversampling both trade
+*					conversion rate for noise: averaging N conversions divides white noise by sqrt(N),
+*					and summing 4^n conversions before a shift by n adds n bits of resolution.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "adc_cfg.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* SC3 AVGS for 32 conversions per result, used by the calibration sequence */
+#define ADC_CFG_AVGS_32			(3U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Calibrate ADC0.
+* @details          Function to run the calibration sequence with 32 sample hardware averaging and a
+*                   software trigger, then restore SC2 / SC3 and store the result. Call it once after
+*                   ADC_init(), before any conversion is started.
+* @param[out]       pCal - Calibration result.
+* @return           1 if calibrated, 0 on time-out (pCal->u8Valid stays 0).
+*/
+uint8_t adc_cfg_calibrate(adc_cfg_cal_t *pCal)
+{
+	uint32_t u32Sc2 = ADC0->SC2;
+	uint32_t u32Sc3 = ADC0->SC3;
+	uint32_t u32Polls = 0U;
+
+	pCal->u8Valid = 0U;
+
+	ADC0->SC2 = u32Sc2 & ~ADC_SC2_ADTRG_MASK;		/* ADTRG=0: calibration is software triggered */
+	ADC0->CLPS = 0U;								/* Clear the previous calibration */
+	ADC0->CLP3 = 0U;
+	ADC0->CLP2 = 0U;
+	ADC0->CLP1 = 0U;
+	ADC0->CLP0 = 0U;
+	ADC0->CLPX = 0U;
+	ADC0->CLP9 = 0U;
+	ADC0->SC3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(ADC_CFG_AVGS_32);	/* AVGE=1, AVGS=3: 32 samples */
+	ADC0->SC3 |= ADC_SC3_CAL_MASK;					/* CAL=1: start, cleared by hardware when done */
+
+	while ((0U != (ADC0->SC3 & ADC_SC3_CAL_MASK)) && (u32Polls < ADC_CFG_CAL_TIMEOUT))
+	{
+		u32Polls++;
+	}
+	(void)ADC0->R[0];								/* Clear COCO set by the sequence */
+
+	ADC0->SC3 = u32Sc3 & ~ADC_SC3_CAL_MASK;
+	ADC0->SC2 = u32Sc2;
+
+	if (u32Polls >= ADC_CFG_CAL_TIMEOUT)
+	{
+		return 0U;
+	}
+
+	pCal->u32Clps = ADC0->CLPS;
+	pCal->u32Clp3 = ADC0->CLP3;
+	pCal->u32Clp2 = ADC0->CLP2;
+	pCal->u32Clp1 = ADC0->CLP1;
+	pCal->u32Clp0 = ADC0->CLP0;
+	pCal->u32Clpx = ADC0->CLPX;
+	pCal->u32Clp9 = ADC0->CLP9;
+	pCal->u32Gain = ADC0->G;
+	pCal->u32Offset = ADC0->OFS;
+	pCal->u8Valid = 1U;
+	return 1U;
+}
+
+/**
+* @brief            Restore calibration.
+* @details          Function to write a stored calibration result back to ADC0, e.g. after a low power
+*                   mode reset the ADC, without running the sequence again.
+* @param[in]        pCal - Calibration result from adc_cfg_calibrate().
+* @return           1 if restored, 0 if pCal holds no valid calibration.
+*/
+uint8_t adc_cfg_restore(const adc_cfg_cal_t *pCal)
+{
+	if (1U != pCal->u8Valid)
+	{
+		return 0U;
+	}
+
+	ADC0->CLPS = pCal->u32Clps;
+	ADC0->CLP3 = pCal->u32Clp3;
+	ADC0->CLP2 = pCal->u32Clp2;
+	ADC0->CLP1 = pCal->u32Clp1;
+	ADC0->CLP0 = pCal->u32Clp0;
+	ADC0->CLPX = pCal->u32Clpx;
+	ADC0->CLP9 = pCal->u32Clp9;
+	ADC0->G = pCal->u32Gain;
+	ADC0->OFS = pCal->u32Offset;
+	return 1U;
+}
+
+/**
+* @brief            Set hardware averaging.
+* @details          Function to set how many conversions ADC0 averages into each result (SC3 AVGE/AVGS).
+*                   The result stays 12 bit: averaging lowers the noise, not the step size.
+* @param[in]        u8Samples - 1 (off), 4, 8, 16 or 32.
+* @return           1 if set, 0 if u8Samples is not one of these.
+*/
+uint8_t adc_cfg_average(uint8_t u8Samples)
+{
+	uint32_t u32Sc3 = ADC0->SC3 & ~(ADC_SC3_AVGE_MASK | ADC_SC3_AVGS_MASK | ADC_SC3_CAL_MASK);
+
+	switch (u8Samples)
+	{
+		case 1U:
+			break;											/* AVGE=0: one conversion per result */
+		case 4U:
+			u32Sc3 |= ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(0U);
+			break;
+		case 8U:
+			u32Sc3 |= ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(1U);
+			break;
+		case 16U:
+			u32Sc3 |= ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(2U);
+			break;
+		case 32U:
+			u32Sc3 |= ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(3U);
+			break;
+		default:
+			return 0U;
+	}
+
+	ADC0->SC3 = u32Sc3;									/* ADCO kept */
+	return 1U;
+}
+
+/**
+* @brief            Get hardware averaging.
+* @details          Function to return the conversions behind each result, from SC3.
+* @param        	void.
+* @return           1, 4, 8, 16 or 32.
+*/
+uint8_t adc_cfg_samples(void)
+{
+	uint32_t u32Sc3 = ADC0->SC3;
+
+	if (0U == (u32Sc3 & ADC_SC3_AVGE_MASK))
+	{
+		return 1U;
+	}
+	return (uint8_t)(4U << (u32Sc3 & ADC_SC3_AVGS_MASK));	/* AVGS 0-3: 4, 8, 16, 32 */
+}
+
+/**
+* @brief            Set sample time.
+* @details          Function to set the input sample time (CFG2 SMPLTS). Longer sample times settle high
+*                   impedance sources such as the pot, at the cost of conversion rate.
+* @param[in]        u16Clocks - Sample time in ADCK clocks (2-256).
+* @return           1 if set, 0 if out of range.
+*/
+uint8_t adc_cfg_sample_time(uint16_t u16Clocks)
+{
+	if ((u16Clocks < 2U) || (u16Clocks > 256U))
+	{
+		return 0U;
+	}
+
+	ADC0->CFG2 = ADC_CFG2_SMPLTS(u16Clocks - 1U);		/* SMPLTS=n: sample time is n+1 ADC clks */
+	return 1U;
+}
+
+/**
+* @brief            Oversampled conversion.
+* @details          Function to sum 4^(u8Bits - 12) software triggered conversions of one channel and
+*                   decimate the sum by 2^(u8Bits - 12). Needs at least 1 LSB of input noise to resolve
+*                   the extra bits, so leave hardware averaging off. Blocking, software trigger mode only.
+* @param[in]        u8Chan - ADC0 input channel (ADCH).
+* @param[in]        u8Bits - Result resolution (ADC_CFG_OVS_MIN_BITS-ADC_CFG_OVS_MAX_BITS).
+* @param[out]       pu32Result - Result, 0-(2^u8Bits - 1).
+* @return           1 if converted, 0 if u8Bits is out of range or ADC0 is hardware triggered.
+*/
+uint8_t adc_cfg_oversample(uint8_t u8Chan, uint8_t u8Bits, uint32_t *pu32Result)
+{
+	uint32_t u32Extra = 0U;
+	uint32_t u32Count = 0U;
+	uint32_t u32Sum = 0U;
+
+	if ((u8Bits < ADC_CFG_OVS_MIN_BITS) || (u8Bits > ADC_CFG_OVS_MAX_BITS)
+		|| (0U != (ADC0->SC2 & ADC_SC2_ADTRG_MASK)))
+	{
+		return 0U;
+	}
+
+	u32Extra = (uint32_t)u8Bits - 12U;
+	for (u32Count = 1UL << (2U * u32Extra); 0U != u32Count; u32Count--)
+	{
+		ADC0->SC1[0] = ADC_SC1_ADCH(u8Chan);				/* Software trigger */
+		while (0U == (ADC0->SC1[0] & ADC_SC1_COCO_MASK))
+		{
+		}
+		u32Sum += ADC0->R[0];								/* 256 x 0xFFF at most, no overflow */
+	}
+
+	*pu32Result = (u32Sum + (1UL << (u32Extra - 1U))) >> u32Extra;	/* Decimate, rounded */
+	return 1U;
+}
+
+
+/* END adc_cfg */
@@ -0,0 +1,151 @@
+/**
+* @file				adc_conv.c
+* @brief            Batch conversion of ADC results
+* @details			(scale * result) / 0xFFF without a divide: the product is formed with a 16 x 16 multiply
+*					and the divide by 0xFFF is a shift-add series, exact over the 12 bit range. The packed
+*					kernel loads two results per word and multiplies the bottom and top halfwords
+*					(SMULBB, SMULTB); each sample is independent, so there is no sum for SMLAD.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <string.h>
+#include "adc_conv.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+#if (1U == ADC_CONV_SIMD) && !defined(ADC_CONV_SMULBB)	/* A host build may supply C equivalents */
+/* r = bottom halfword of a x bottom halfword of b, signed */
+#define ADC_CONV_SMULBB(r, a, b)	__asm ("smulbb %0, %1, %2" : "=r" (r) : "r" (a), "r" (b))
+/* r = top halfword of a x bottom halfword of b, signed */
+#define ADC_CONV_SMULTB(r, a, b)	__asm ("smultb %0, %1, %2" : "=r" (r) : "r" (a), "r" (b))
+/* r = bottom halfword of a | bottom halfword of b << 16 */
+#define ADC_CONV_PKHBT(r, a, b)		__asm ("pkhbt %0, %1, %2, lsl #16" : "=r" (r) : "r" (a), "r" (b))
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void adc_conv_batch(const uint16_t *pu16Raw, uint16_t *pu16Out, uint32_t u32Count, uint32_t u32Scale);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Convert results.
+* @details          Packed kernel with ADC_CONV_SIMD, scalar kernel otherwise. Words are copied with
+*                   memcpy(), a single LDR/STR on Cortex-M4 (unaligned access allowed), so the arrays
+*                   need only halfword alignment.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pu16Out - Scaled results.
+* @param[in]        u32Count - Number of results.
+* @param[in]        u32Scale - Output at full scale, ADC_CONV_MV_SCALE or ADC_CONV_Q15_SCALE.
+* @return           void.
+*/
+static void adc_conv_batch(const uint16_t *pu16Raw, uint16_t *pu16Out, uint32_t u32Count, uint32_t u32Scale)
+{
+#if (1U == ADC_CONV_SIMD)
+	uint32_t u32Pairs = u32Count / 2U;
+	uint32_t u32Word = 0U;
+	uint32_t u32Lo = 0U;
+	uint32_t u32Hi = 0U;
+
+	while (0U != u32Pairs)
+	{
+		(void)memcpy(&u32Word, pu16Raw, sizeof(u32Word));	/* Two results */
+		ADC_CONV_SMULBB(u32Lo, u32Word, u32Scale);
+		ADC_CONV_SMULTB(u32Hi, u32Word, u32Scale);
+		u32Lo = ADC_CONV_DIV_FULL_SCALE(u32Lo);
+		u32Hi = ADC_CONV_DIV_FULL_SCALE(u32Hi);
+		ADC_CONV_PKHBT(u32Word, u32Lo, u32Hi);
+		(void)memcpy(pu16Out, &u32Word, sizeof(u32Word));
+		pu16Raw += 2U;
+		pu16Out += 2U;
+		u32Pairs--;
+	}
+	adc_conv_scalar(pu16Raw, pu16Out, u32Count & 1U, u32Scale);	/* Odd one out */
+#else
+	adc_conv_scalar(pu16Raw, pu16Out, u32Count, u32Scale);
+#endif
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Convert results to mV.
+* @details          Function to convert raw 12 bit results to mV for 0-5V range, (5000 * result) / 0xFFF
+*                   for each one. Two results per step with ADC_CONV_SIMD. pu16Mv may be pu16Raw.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pu16Mv - Results in mV.
+* @param[in]        u32Count - Number of results.
+* @return           void.
+*/
+void adc_conv_mv(const uint16_t *pu16Raw, uint16_t *pu16Mv, uint32_t u32Count)
+{
+	adc_conv_batch(pu16Raw, pu16Mv, u32Count, ADC_CONV_MV_SCALE);
+}
+
+/**
+* @brief            Convert results to Q15.
+* @details          Function to convert raw 12 bit results to a Q15 fraction of the 0-5V range,
+*                   (32767 * result) / 0xFFF for each one. pi16Q15 may be pu16Raw.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pi16Q15 - Results in Q15 (0-32767).
+* @param[in]        u32Count - Number of results.
+* @return           void.
+*/
+void adc_conv_q15(const uint16_t *pu16Raw, int16_t *pi16Q15, uint32_t u32Count)
+{
+	adc_conv_batch(pu16Raw, (uint16_t *)pi16Q15, u32Count, ADC_CONV_Q15_SCALE);
+}
+
+/**
+* @brief            Convert results, scalar.
+* @details          Function to convert raw 12 bit results to (u32Scale * result) / 0xFFF one at a time.
+*                   Portable kernel, also used by adc_conv_mv() and adc_conv_q15() without ADC_CONV_SIMD.
+* @param[in]        pu16Raw - Raw results (0-0xFFF).
+* @param[out]       pu16Out - Scaled results.
+* @param[in]        u32Count - Number of results.
+* @param[in]        u32Scale - Output at full scale, ADC_CONV_MV_SCALE or ADC_CONV_Q15_SCALE.
+* @return           void.
+*/
+void adc_conv_scalar(const uint16_t *pu16Raw, uint16_t *pu16Out, uint32_t u32Count, uint32_t u32Scale)
+{
+	uint32_t u32Index = 0U;
+	uint32_t u32Product = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		u32Product = u32Scale * pu16Raw[u32Index];
+		pu16Out[u32Index] = (uint16_t)ADC_CONV_DIV_FULL_SCALE(u32Product);
+	}
+}
+
+
+/* END adc_conv */
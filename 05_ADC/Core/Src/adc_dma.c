@@ -0,0 +1,193 @@
+/**
+* @file				adc_dma.c
+* @brief            ADC0 acquisition by eDMA
+* @details			ADC0 converts one channel continuously (SC3[ADCO]) and each conversion complete raises a
+*					DMA request (SC2[DMAEN]) that moves R[0] into a RAM buffer, which also clears COCO. The
+*					destination wraps at the end of the major loop (DLASTSGA) and the channel stays enabled
+*					(DREQ=0), so the DMA fills the two halves in turn. The CPU only sees the half and full
+*					buffer interrupts.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "adc_dma.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Samples the DMA has written in the current pass over the buffer */
+#define ADC_DMA_DONE()		((uint32_t)(DMA->TCD[ADC_DMA_CH].BITER.ELINKNO & DMA_TCD_BITER_ELINKNO_BITER_MASK) \
+							- (uint32_t)(DMA->TCD[ADC_DMA_CH].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK))
+
+/* ADCH=1F: SC1[0] disabled */
+#define ADC_DMA_DISABLED	(0x1FU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Sample buffer */
+static uint16_t *s_pu16Buf = NULL;
+
+/* Samples per half buffer */
+static uint32_t s_u32Half = 0U;
+
+/* Block callback */
+static adc_dma_block_t s_pfBlock = NULL;
+
+/* Half handed out last, NULL before the first one */
+static const uint16_t *s_pu16Last = NULL;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* DMA statistics, written by the DMA interrupt */
+volatile adc_dma_stats_t AdcDmaStats;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            ADC DMA Initialization.
+* @details          Function to switch the ADC_init() configuration to continuous conversions with
+*                   SC2[DMAEN] and set up eDMA channel ADC_DMA_CH as an endless copy of ADC0 R[0] into
+*                   pu16Buf: one 16 bit minor loop per conversion, a major loop over the whole buffer that
+*                   wraps back to its start, and interrupts at half and full buffer only. Call it after
+*                   ADC_init(), then adc_dma_start().
+* @param[out]       pu16Buf - Sample buffer, two halves.
+* @param[in]        u16Samples - Buffer size in samples, even (2-ADC_DMA_MAX_SAMPLES).
+* @param[in]        pfBlock - Called with each filled half buffer.
+* @return           1 if configured, 0 if u16Samples is odd or out of range (nothing written).
+*/
+uint8_t adc_dma_init(uint16_t *pu16Buf, uint16_t u16Samples, adc_dma_block_t pfBlock)
+{
+	if ((u16Samples < 2U) || (u16Samples > ADC_DMA_MAX_SAMPLES) || (0U != (u16Samples % 2U)))
+	{
+		return 0U;										/* Two equal halves, CITER holds 15 bits */
+	}
+
+	s_pu16Buf = pu16Buf;
+	s_u32Half = (uint32_t)u16Samples / 2U;
+	s_pfBlock = pfBlock;
+	s_pu16Last = NULL;
+	AdcDmaStats.u32Blocks = 0U;
+	AdcDmaStats.u32Overruns = 0U;
+
+	ADC0->SC1[0] = ADC_SC1_ADCH(ADC_DMA_DISABLED);		/* ADCH=1F: no conversion while the DMA is set up */
+														/* AIEN=0: the DMA takes the results, no ADC interrupt */
+	ADC0->SC2 = ADC_SC2_DMAEN_MASK;						/* ADTRG=0: SW trigger */
+														/* DMAEN=1: DMA request on each conversion complete */
+	ADC0->SC3 |= ADC_SC3_ADCO_MASK;						/* ADCO=1: continuous conversions after one trigger */
+
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* CGC=1: enable clock to DMAMUX (eDMA clock is on out of reset) */
+
+	DMA->CERQ = ADC_DMA_CH;								/* Channel requests off while the TCD is written */
+	DMAMUX->CHCFG[ADC_DMA_CH] = 0U;						/* Disable the request routing */
+
+	DMA->TCD[ADC_DMA_CH].SADDR = (uint32_t)&ADC0->R[0];					/* Result of SC1[0], low halfword */
+	DMA->TCD[ADC_DMA_CH].SOFF = 0U;										/* Same register every time */
+	DMA->TCD[ADC_DMA_CH].ATTR = DMA_TCD_ATTR_SMOD(0U)		/* SMOD=0: no source modulo */
+							  | DMA_TCD_ATTR_SSIZE(1U)		/* SSIZE=1: 16 bit reads */
+							  | DMA_TCD_ATTR_DMOD(0U)		/* DMOD=0: no destination modulo */
+							  | DMA_TCD_ATTR_DSIZE(1U);		/* DSIZE=1: 16 bit writes */
+	DMA->TCD[ADC_DMA_CH].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(2U);	/* Minor loop: one sample */
+	DMA->TCD[ADC_DMA_CH].SLAST = 0U;
+	DMA->TCD[ADC_DMA_CH].DADDR = (uint32_t)pu16Buf;
+	DMA->TCD[ADC_DMA_CH].DOFF = 2U;
+	DMA->TCD[ADC_DMA_CH].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(u16Samples);	/* Major loop: whole buffer */
+	DMA->TCD[ADC_DMA_CH].DLASTSGA = (uint32_t)(-(int32_t)((uint32_t)u16Samples * 2U));	/* Back to the buffer start */
+	DMA->TCD[ADC_DMA_CH].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(u16Samples);
+	DMA->TCD[ADC_DMA_CH].CSR = DMA_TCD_CSR_INTHALF_MASK		/* INTHALF=1: interrupt at half buffer */
+							 | DMA_TCD_CSR_INTMAJOR_MASK;	/* INTMAJOR=1: interrupt at full buffer */
+															/* DREQ=0: requests stay enabled after the major loop */
+
+	DMAMUX->CHCFG[ADC_DMA_CH] = DMAMUX_CHCFG_SOURCE(ADC_DMA_REQ_ADC0)		/* Request source: ADC0 */
+							  | DMAMUX_CHCFG_ENBL_MASK;						/* ENBL=1: route it */
+
+	S32_NVIC->ICPR[0] = 1U << (ADC_DMA_CH % 32U);  		/* IRQ1-DMA ch1: clr any pending IRQ*/
+	S32_NVIC->ISER[0] = 1U << (ADC_DMA_CH % 32U);  		/* IRQ1-DMA ch1: enable IRQ */
+	S32_NVIC->IP[ADC_DMA_CH] = ADC_DMA_IRQ_PRIO;		/* IRQ1-DMA ch1: priority 10 of 0-15 */
+
+	DMA->SERQ = ADC_DMA_CH;								/* Channel requests on */
+
+	return 1U;
+}
+
+/**
+* @brief            Start acquisition.
+* @details          Function to start continuous conversions of one channel into the buffer.
+* @param[in]        u16AdcChan - ADC Channel.
+* @return           void.
+*/
+void adc_dma_start(uint16_t u16AdcChan)
+{
+	ADC0->SC1[0] = ADC_SC1_ADCH(u16AdcChan);			/* Initiate continuous conversions */
+}
+
+/**
+* @brief            Stop acquisition.
+* @details          Function to stop the conversions. The DMA keeps its position in the buffer.
+* @param        	void.
+* @return           void.
+*/
+void adc_dma_stop(void)
+{
+	ADC0->SC1[0] = ADC_SC1_ADCH(ADC_DMA_DISABLED);		/* ADCH=1F: stop conversions */
+}
+
+/**
+* @brief            DMA interrupt.
+* @details          Function to hand the half buffer the DMA has just left to the block callback.
+*                   Call it from DMA1_IRQHandler (channel ADC_DMA_CH).
+* @param        	void.
+* @return           void.
+*/
+void adc_dma_isr(void)
+{
+	const uint16_t *pu16Block = NULL;
+
+	DMA->CINT = ADC_DMA_CH;								/* Clear the channel interrupt */
+	DMA->CDNE = ADC_DMA_CH;								/* Clear DONE left by the major loop */
+
+	/* The DMA is in the half after the filled one. Late by less than half a buffer, the position
+	   still tells which half was filled, whether the half or the major interrupt fired */
+	pu16Block = (ADC_DMA_DONE() >= s_u32Half) ? &s_pu16Buf[0] : &s_pu16Buf[s_u32Half];
+
+	if (pu16Block == s_pu16Last)
+	{
+		AdcDmaStats.u32Overruns++;						/* Interrupt missed a half: the other one was overwritten */
+	}
+	s_pu16Last = pu16Block;
+	AdcDmaStats.u32Blocks++;
+
+	if (NULL != s_pfBlock)
+	{
+		s_pfBlock(pu16Block, s_u32Half);
+	}
+}
+
+
+/* END adc_dma */
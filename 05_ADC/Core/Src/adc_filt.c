@@ -0,0 +1,303 @@
+/**
+* @file				adc_filt.c
+* @brief            Q15 filters for ADC samples
+* @details			FIR, cascaded biquad and moving average stages that filter blocks in place, e.g. a DMA
+*					half buffer or a scan sequence after adc_conv_q15(). The caller owns all coefficients
+*					and state, nothing is allocated. FIR products are Q30 in a 32 bit accumulator. The
+*					biquad keeps its outputs in Q31, so the rounding of the Q15 output does not circulate
+*					through the feedback. Outputs are rounded and saturated to Q15.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <string.h>
+#include "adc_filt.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Saturate to Q15 / Q31 */
+#define ADC_FILT_SAT16(x)		(((x) > 32767) ? 32767 : (((x) < -32768) ? -32768 : (x)))
+#define ADC_FILT_SAT32(x)		(((x) > 2147483647) ? 2147483647 : (((x) < -2147483647 - 1) ? -2147483647 - 1 : (x)))
+
+/* acc += bottom halfwords product + top halfwords product, signed */
+#if (1U == ADC_FILT_SIMD)
+#define ADC_FILT_SMLAD(acc, a, b)	__asm ("smlad %0, %1, %2, %0" : "+r" (acc) : "r" (a), "r" (b))
+#else
+#define ADC_FILT_SMLAD(acc, a, b)	((acc) += ((int32_t)(int16_t)(a) * (int16_t)(b)) \
+									+ ((int32_t)(int16_t)((a) >> 16U) * (int16_t)((b) >> 16U)))
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            FIR Initialization.
+* @details          Function to attach the taps and clear the delay line.
+* @param[out]       pFir - FIR stage.
+* @param[in]        pi16Coeffs - Q15 taps, time-reversed. The sum of their magnitudes must stay below 2.
+* @param[in]        u16Taps - Number of taps.
+* @param[in]        pi16State - Delay line, 2 x u16Taps.
+* @return           void.
+*/
+void adc_filt_fir_init(adc_filt_fir_t *pFir, const int16_t *pi16Coeffs, uint16_t u16Taps, int16_t *pi16State)
+{
+	pFir->pi16Coeffs = pi16Coeffs;
+	pFir->pi16State = pi16State;
+	pFir->u16Taps = u16Taps;
+	pFir->u16Index = 0U;
+	(void)memset(pi16State, 0, 2U * u16Taps * sizeof(int16_t));
+}
+
+/**
+* @brief            FIR filter.
+* @details          Function to filter a block of Q15 samples in place, 4 taps per loop step.
+* @param[in,out]    pFir - FIR stage.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_fir(adc_filt_fir_t *pFir, int16_t *pi16Data, uint32_t u32Count)
+{
+	const uint32_t u32Taps = pFir->u16Taps;
+	uint32_t u32Index = pFir->u16Index;
+	uint32_t u32Sample = 0U;
+	uint32_t u32Tap = 0U;
+	const int16_t *pi16Window = NULL;
+	uint32_t u32Coeffs = 0U;
+	uint32_t u32Window = 0U;
+	int32_t i32Acc = 0;
+
+	for (u32Sample = 0U; u32Sample < u32Count; u32Sample++)
+	{
+		/* Input twice: the window of the last u32Taps inputs is then contiguous, oldest first */
+		pFir->pi16State[u32Index] = pi16Data[u32Sample];
+		pFir->pi16State[u32Index + u32Taps] = pi16Data[u32Sample];
+		pi16Window = &pFir->pi16State[u32Index + 1U];
+
+		i32Acc = 1 << 14;									/* Rounding */
+		for (u32Tap = 0U; (u32Tap + 4U) <= u32Taps; u32Tap += 4U)
+		{
+			(void)memcpy(&u32Coeffs, &pFir->pi16Coeffs[u32Tap], sizeof(u32Coeffs));	/* Two taps per word */
+			(void)memcpy(&u32Window, &pi16Window[u32Tap], sizeof(u32Window));
+			ADC_FILT_SMLAD(i32Acc, u32Coeffs, u32Window);
+			(void)memcpy(&u32Coeffs, &pFir->pi16Coeffs[u32Tap + 2U], sizeof(u32Coeffs));
+			(void)memcpy(&u32Window, &pi16Window[u32Tap + 2U], sizeof(u32Window));
+			ADC_FILT_SMLAD(i32Acc, u32Coeffs, u32Window);
+		}
+		for (; u32Tap < u32Taps; u32Tap++)
+		{
+			i32Acc += (int32_t)pFir->pi16Coeffs[u32Tap] * pi16Window[u32Tap];	/* Last 0-3 taps */
+		}
+		i32Acc >>= 15;
+		pi16Data[u32Sample] = (int16_t)ADC_FILT_SAT16(i32Acc);
+
+		u32Index = (u32Index + 1U < u32Taps) ? (u32Index + 1U) : 0U;
+	}
+	pFir->u16Index = (uint16_t)u32Index;
+}
+
+/**
+* @brief            Biquad Initialization.
+* @details          Function to attach the coefficients and clear the state.
+* @param[out]       pBiquad - Biquad stage.
+* @param[in]        pi16Coeffs - 5 coefficients per section.
+* @param[in]        u8Sections - Number of sections.
+* @param[in]        u8PostShift - Coefficient scale: Q15 >> u8PostShift (0-2).
+* @param[in]        pi32State - State, 4 per section.
+* @return           void.
+*/
+void adc_filt_biquad_init(adc_filt_biquad_t *pBiquad, const int16_t *pi16Coeffs, uint8_t u8Sections,
+						  uint8_t u8PostShift, int32_t *pi32State)
+{
+	pBiquad->pi16Coeffs = pi16Coeffs;
+	pBiquad->pi32State = pi32State;
+	pBiquad->u8Sections = u8Sections;
+	pBiquad->u8PostShift = u8PostShift;
+	(void)memset(pi32State, 0, 4U * u8Sections * sizeof(int32_t));
+}
+
+/**
+* @brief            Biquad filter.
+* @details          Function to filter a block of Q15 samples in place through each section in turn.
+*                   64 bit accumulator, Q31 feedback state, outputs rounded and saturated.
+* @param[in,out]    pBiquad - Biquad stage.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_biquad(adc_filt_biquad_t *pBiquad, int16_t *pi16Data, uint32_t u32Count)
+{
+	const uint32_t u32Shift = 15U - pBiquad->u8PostShift;
+	const int16_t *pi16Coeffs = pBiquad->pi16Coeffs;
+	int32_t *pi32State = pBiquad->pi32State;
+	uint32_t u32Section = 0U;
+	uint32_t u32Sample = 0U;
+	int32_t i32B0, i32B1, i32B2, i32A1, i32A2;
+	int32_t i32X1, i32X2, i32Y1, i32Y2;
+	int32_t i32X = 0;
+	int64_t i64Acc = 0;
+
+	for (u32Section = 0U; u32Section < pBiquad->u8Sections; u32Section++)
+	{
+		/* Section coefficients and state in registers for the whole block */
+		i32B0 = pi16Coeffs[0];
+		i32B1 = pi16Coeffs[1];
+		i32B2 = pi16Coeffs[2];
+		i32A1 = pi16Coeffs[3];
+		i32A2 = pi16Coeffs[4];
+		i32X1 = pi32State[0];
+		i32X2 = pi32State[1];
+		i32Y1 = pi32State[2];
+		i32Y2 = pi32State[3];
+
+		for (u32Sample = 0U; u32Sample < u32Count; u32Sample++)
+		{
+			i32X = pi16Data[u32Sample];
+			i64Acc = (int64_t)(i32B0 * i32X) + (int64_t)(i32B1 * i32X1) + (int64_t)(i32B2 * i32X2);
+			i64Acc *= 0x10000;								/* Q15 x Q15 = Q30, to Q46 (a signed shift) */
+			i64Acc += (int64_t)i32A1 * i32Y1;				/* Q15 x Q31 = Q46, SMLAL */
+			i64Acc += (int64_t)i32A2 * i32Y2;
+			i64Acc >>= u32Shift;							/* Back to Q31 */
+			i32X2 = i32X1;
+			i32X1 = i32X;
+			i32Y2 = i32Y1;
+			i32Y1 = (int32_t)ADC_FILT_SAT32(i64Acc);
+			i64Acc = ((int64_t)i32Y1 + 0x8000) >> 16U;		/* Output rounded to Q15 */
+			pi16Data[u32Sample] = (int16_t)ADC_FILT_SAT16(i64Acc);
+		}
+
+		pi32State[0] = i32X1;
+		pi32State[1] = i32X2;
+		pi32State[2] = i32Y1;
+		pi32State[3] = i32Y2;
+		pi16Coeffs += 5U;
+		pi32State += 4U;
+	}
+}
+
+/**
+* @brief            Moving average Initialization.
+* @details          Function to attach and clear the history.
+* @param[out]       pAvg - Moving average stage.
+* @param[in]        pi16History - History, u16Length samples.
+* @param[in]        u16Length - Window, power of 2 (1-32768).
+* @return           1 if initialized, 0 if u16Length is not a power of 2.
+*/
+uint8_t adc_filt_movavg_init(adc_filt_movavg_t *pAvg, int16_t *pi16History, uint16_t u16Length)
+{
+	uint8_t u8Shift = 0U;
+
+	if ((0U == u16Length) || (0U != (u16Length & (u16Length - 1U))))
+	{
+		return 0U;
+	}
+	while ((1UL << u8Shift) < u16Length)
+	{
+		u8Shift++;
+	}
+
+	pAvg->pi16History = pi16History;
+	pAvg->i32Sum = 0;
+	pAvg->u16Length = u16Length;
+	pAvg->u16Index = 0U;
+	pAvg->u8Shift = u8Shift;
+	(void)memset(pi16History, 0, u16Length * sizeof(int16_t));
+
+	return 1U;
+}
+
+/**
+* @brief            Moving average filter.
+* @details          Function to average a block of Q15 samples in place over the last u16Length inputs,
+*                   with a running sum: O(1) per sample for any window.
+* @param[in,out]    pAvg - Moving average stage.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_movavg(adc_filt_movavg_t *pAvg, int16_t *pi16Data, uint32_t u32Count)
+{
+	const uint32_t u32Mask = (uint32_t)pAvg->u16Length - 1U;
+	const int32_t i32Round = (int32_t)(((uint32_t)pAvg->u16Length) >> 1U);
+	uint32_t u32Index = pAvg->u16Index;
+	int32_t i32Sum = pAvg->i32Sum;
+	uint32_t u32Sample = 0U;
+
+	for (u32Sample = 0U; u32Sample < u32Count; u32Sample++)
+	{
+		i32Sum += (int32_t)pi16Data[u32Sample] - pAvg->pi16History[u32Index];	/* In: newest, out: oldest */
+		pAvg->pi16History[u32Index] = pi16Data[u32Sample];
+		u32Index = (u32Index + 1U) & u32Mask;
+		pi16Data[u32Sample] = (int16_t)((i32Sum + i32Round) >> pAvg->u8Shift);
+	}
+	pAvg->u16Index = (uint16_t)u32Index;
+	pAvg->i32Sum = i32Sum;
+}
+
+/**
+* @brief            Run pipeline.
+* @details          Function to pass a block of Q15 samples through each stage in turn, in place.
+* @param[in]        pStages - Stages.
+* @param[in]        u8Stages - Number of stages.
+* @param[in,out]    pi16Data - Q15 samples.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_filt_run(const adc_filt_stage_t *pStages, uint8_t u8Stages, int16_t *pi16Data, uint32_t u32Count)
+{
+	uint32_t u32Stage = 0U;
+
+	for (u32Stage = 0U; u32Stage < u8Stages; u32Stage++)
+	{
+		switch (pStages[u32Stage].u8Type)
+		{
+			case ADC_FILT_FIR:
+				adc_filt_fir((adc_filt_fir_t *)pStages[u32Stage].pFilter, pi16Data, u32Count);
+				break;
+			case ADC_FILT_BIQUAD:
+				adc_filt_biquad((adc_filt_biquad_t *)pStages[u32Stage].pFilter, pi16Data, u32Count);
+				break;
+			case ADC_FILT_MOVAVG:
+				adc_filt_movavg((adc_filt_movavg_t *)pStages[u32Stage].pFilter, pi16Data, u32Count);
+				break;
+			default:
+				break;											/* Unknown stage: skipped */
+		}
+	}
+}
+
+
+/* END adc_filt */
@@ -0,0 +1,260 @@
+/**
+* @file				adc_scan.c
+* @brief            ADC0 scan sequencer
+* @details			PDB0 channel 0 pre-trigger 0 starts SC1[0] at the beginning of each PDB0 period; the
+*					other pre-triggers are back-to-back, each starts the next SC1[n] when the previous
+*					conversion completes. The whole channel list converts without the core, and only the
+*					last channel raises the ADC0 interrupt.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "adc_scan.h"
+#include "adc_cfg.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* PDB0 TRGSEL=15: software trigger */
+#define ADC_SCAN_PDB_SWTRIG		(15U)
+
+/* Pre-trigger 0 delay in PDB0 clocks from the start of the period */
+#define ADC_SCAN_PDB_DLY0		(1U)
+
+/* ADCH=1F: SC1[n] disabled */
+#define ADC_SCAN_DISABLED		(0x1FU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* PDB0 SC[MULT] multiplication factors */
+static const uint8_t s_au8Mult[4] = {1U, 10U, 20U, 40U};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Channels in the list */
+static uint8_t s_u8Count = 0U;
+
+/* Sequence callback */
+static adc_scan_callback_t s_pfCallback = NULL;
+
+/* Results of the last sequence, written by the ADC0 interrupt */
+static volatile uint16_t s_au16Result[ADC_SCAN_MAX_CHANNELS];
+
+/* Completed sequences, incremented after s_au16Result is written */
+static volatile uint32_t s_u32Sequences = 0U;
+
+/* PDB0 sequence errors */
+static volatile uint32_t s_u32Errors = 0U;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Scan sequencer Initialization.
+* @details          Function to program ADC0 SC1[0]-SC1[n-1] with the channel list and PDB0 channel 0
+*                   pre-triggers, so one PDB0 period converts the whole list back-to-back. The ADC0
+*                   interrupt of the last channel reports the sequence. Call it after ADC_init() and
+*                   adc_cfg_average().
+* @param[in]        pu8Channels - ADC0 input channels (ADCH), converted in this order.
+* @param[in]        u8Count - Number of channels (1-ADC_SCAN_MAX_CHANNELS).
+* @param[in]        u32RateHz - Sequences per second.
+* @param[in]        pfCallback - Sequence callback, NULL for none.
+* @return           1 if configured, 0 if the list or the rate is not possible.
+*/
+uint8_t adc_scan_init(const uint8_t *pu8Channels, uint8_t u8Count, uint32_t u32RateHz, adc_scan_callback_t pfCallback)
+{
+	uint32_t u32Prescaler = 0U;
+	uint32_t u32Mult = 0U;
+	uint32_t u32Div = 0U;
+	uint32_t u32Ticks = 0U;
+	uint32_t u32BestDiv = 0xFFFFFFFFU;
+	uint32_t u32BestSc = 0U;
+	uint32_t u32BestMod = 0U;
+	uint32_t u32Mask = 0U;
+	uint32_t u32Index = 0U;
+
+	if ((0U == u8Count) || (u8Count > ADC_SCAN_MAX_CHANNELS) || (0U == u32RateHz)
+		|| (((uint64_t)u8Count * adc_cfg_samples() * ADC_SCAN_CONV_NS * u32RateHz) > 1000000000U))
+	{
+		return 0U;											/* Empty list, or the ADC cannot keep up */
+	}
+
+	/* Smallest PDB0 clock divider whose 16 bit counter still spans one period: finest rate steps */
+	for (u32Mult = 0U; u32Mult < 4U; u32Mult++)
+	{
+		for (u32Prescaler = 0U; u32Prescaler < 8U; u32Prescaler++)
+		{
+			u32Div = (1UL << u32Prescaler) * s_au8Mult[u32Mult];
+			u32Ticks = (uint32_t)(((uint64_t)ADC_SCAN_PDB_CLOCK_HZ + ((uint64_t)u32Div * u32RateHz / 2U))
+								/ ((uint64_t)u32Div * u32RateHz));
+			if ((u32Ticks > ADC_SCAN_PDB_DLY0) && (u32Ticks <= 0x10000U) && (u32Div < u32BestDiv))
+			{
+				u32BestDiv = u32Div;
+				u32BestSc = PDB_SC_PRESCALER(u32Prescaler) | PDB_SC_MULT(u32Mult);
+				u32BestMod = u32Ticks - 1U;
+			}
+		}
+	}
+	if (0xFFFFFFFFU == u32BestDiv)
+	{
+		return 0U;											/* Rate out of the PDB0 range */
+	}
+
+	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable bus clock in PDB0, before it is stopped */
+	adc_scan_stop();
+	s_u8Count = u8Count;
+	s_pfCallback = pfCallback;
+	s_u32Sequences = 0U;
+	s_u32Errors = 0U;
+
+	/* ADC0: hardware trigger, SC1[n] holds channel n, interrupt on the last one */
+	SIM->ADCOPT &= ~(SIM_ADCOPT_ADC0TRGSEL_MASK | SIM_ADCOPT_ADC0PRETRGSEL_MASK);
+															/* ADC0TRGSEL=0: PDB0 trigger */
+															/* ADC0PRETRGSEL=0: PDB0 pre-triggers */
+	ADC0->SC2 |= ADC_SC2_ADTRG_MASK;						/* ADTRG=1: HW trigger */
+	for (u32Index = 0U; u32Index < ADC_SCAN_MAX_CHANNELS; u32Index++)
+	{
+		if (u32Index < u8Count)
+		{
+			ADC0->SC1[u32Index] = ADC_SC1_ADCH(pu8Channels[u32Index])
+								| ((u32Index == (u8Count - 1U)) ? ADC_SC1_AIEN_MASK : 0U);
+			u32Mask |= 1UL << u32Index;
+		}
+		else
+		{
+			ADC0->SC1[u32Index] = ADC_SC1_ADCH(ADC_SCAN_DISABLED);
+		}
+	}
+
+	/* PDB0: continuous, software trigger, pre-trigger 0 delayed, 1-7 back-to-back */
+	PDB0->SC = u32BestSc | PDB_SC_TRGSEL(ADC_SCAN_PDB_SWTRIG) | PDB_SC_CONT_MASK | PDB_SC_PDBEN_MASK;
+	PDB0->MOD = u32BestMod;
+	PDB0->CH[0].DLY[0] = ADC_SCAN_PDB_DLY0;
+	PDB0->CH[0].C1 = PDB_C1_EN(u32Mask) | PDB_C1_TOS(1U) | PDB_C1_BB(u32Mask & ~1UL);
+	PDB0->CH[0].S &= ~PDB_S_ERR_MASK;						/* Clear stale sequence errors (write 0) */
+	PDB0->SC |= PDB_SC_LDOK_MASK;							/* Load MOD, DLY */
+
+	S32_NVIC->ICPR[1] = 1U << (39 % 32);					/* IRQ39-ADC0: clr any pending IRQ */
+	S32_NVIC->ISER[1] = 1U << (39 % 32);					/* IRQ39-ADC0: enable IRQ */
+	S32_NVIC->IP[39] = ADC_SCAN_IRQ_PRIO;					/* IRQ39-ADC0: priority 10 of 0-15 */
+
+	return 1U;
+}
+
+/**
+* @brief            Start scanning.
+* @details          Function to software trigger PDB0; it then restarts itself every period.
+* @param        	void.
+* @return           void.
+*/
+void adc_scan_start(void)
+{
+	PDB0->SC |= PDB_SC_SWTRIG_MASK;
+}
+
+/**
+* @brief            Stop scanning.
+* @details          Function to disable PDB0. A sequence already started completes.
+* @param        	void.
+* @return           void.
+*/
+void adc_scan_stop(void)
+{
+	PDB0->SC &= ~PDB_SC_PDBEN_MASK;
+}
+
+/**
+* @brief            Read last sequence.
+* @details          Function to copy the raw results of the last completed sequence. Thread mode, the
+*                   copy is retried if the interrupt completed a sequence meanwhile.
+* @param[out]       pu16Results - Raw 12 bit results, one per channel of the list.
+* @return           Number of the sequence copied, 0 if none completed yet.
+*/
+uint32_t adc_scan_read(uint16_t *pu16Results)
+{
+	uint32_t u32Sequence = 0U;
+	uint32_t u32Index = 0U;
+
+	do
+	{
+		u32Sequence = s_u32Sequences;
+		for (u32Index = 0U; u32Index < s_u8Count; u32Index++)
+		{
+			pu16Results[u32Index] = s_au16Result[u32Index];
+		}
+	} while (u32Sequence != s_u32Sequences);				/* Interrupted by a new sequence: copy again */
+
+	return u32Sequence;
+}
+
+/**
+* @brief            Sequence errors.
+* @details          Function to return the PDB0 sequence errors: a pre-trigger came while the ADC was
+*                   still converting, so a channel of that sequence was skipped.
+* @param        	void.
+* @return           Sequence errors since adc_scan_init().
+*/
+uint32_t adc_scan_errors(void)
+{
+	return s_u32Errors;
+}
+
+/**
+* @brief            Scan interrupt.
+* @details          Function to read SC1[0]-SC1[n-1] results and report the sequence. Call it from
+*                   ADC0_IRQHandler.
+* @param        	void.
+* @return           void.
+*/
+void adc_scan_isr(void)
+{
+	uint16_t au16Result[ADC_SCAN_MAX_CHANNELS];
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < s_u8Count; u32Index++)
+	{
+		au16Result[u32Index] = (uint16_t)(ADC0->R[u32Index] & ADC_R_D_MASK);	/* Read clears COCO */
+		s_au16Result[u32Index] = au16Result[u32Index];
+	}
+	s_u32Sequences++;
+
+	if (0U != (PDB0->CH[0].S & PDB_S_ERR_MASK))
+	{
+		PDB0->CH[0].S &= ~PDB_S_ERR_MASK;					/* Clear sequence errors (write 0) */
+		s_u32Errors++;
+	}
+
+	if (NULL != s_pfCallback)
+	{
+		s_pfCallback(au16Result, s_u8Count);
+	}
+}
+
+
+/* END adc_scan */
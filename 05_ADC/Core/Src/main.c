@@ -24,10 +24,47 @@
 #define PTD16		(16U)
 /* Port PTD0, bit 0: EVB output to blue LED */
 #define PTD0		(0U)
+/* 1: PDB0 converts the channel list in hardware SCAN_RATE_HZ times per second, 0: SW trigger and wait per channel */
+#define SCAN_MODE		(1U)
+/* Channel list sequences per second */
+#define SCAN_RATE_HZ	(1000U)
+/* 1: ADC0 converts AD12 continuously into a DMA ping-pong buffer (overrides SCAN_MODE) */
+#define DMA_MODE		(0U)
+/* Size of that buffer in samples, each half is handed to the block callback */
+#define DMA_SAMPLES		(512U)
+/* Conversions ADC0 averages in hardware into each result: 1 (off), 4, 8, 16 or 32 */
+#define ADC_AVG_SAMPLES	(1U)
+/* Pot resolution without SCAN_MODE / DMA_MODE: 12, or 13-16 to oversample 4^(bits - 12) conversions */
+#define OVS_BITS		(12U)
+/* 1: time adc_conv_mv() against adc_conv_scalar() at start up, results in u32ConvRateSimd / u32ConvRateScalar */
+#define CONV_BENCH_MODE	(0U)
+/* 1: time the Q15 filters against a float reference at start up, see au32FiltRate / au32FiltRefRate */
+#define FILT_BENCH_MODE	(0U)
+/* Samples per benchmark run */
+#define CONV_BENCH_SAMPLES	(1024U)
+/* Pot filter: moving average window at SCAN_RATE_HZ */
+#define POT_AVG_LENGTH	(16U)
+/* Core clock in MHz, SysTick counts core clocks */
+#define CORE_CLOCK_MHZ	(80U)
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
 ==================================================================================================*/
+#if (1U == SCAN_MODE) && (0U == DMA_MODE)
+/* Scan list: AD12 pot on EVB, AD29 Vrefsh */
+const uint8_t au8ScanChannels[2] = {12U, 29U};
+
+/* Pot filter: 20 Hz 2nd order Butterworth low-pass at 1 kHz, b0 b1 b2 a1 a2 in Q14 */
+const int16_t ai16PotBiquad[5] = {59, 119, 59, 29863, -13716};
+#endif
+
+#if (1U == FILT_BENCH_MODE)
+/* 16 tap low-pass FIR, 0.1 fs (Hamming window), Q15, symmetric */
+const int16_t ai16BenchFir[16] = {-114, -159, -139, 291, 1450, 3284, 5246, 6525, 6525, 5246, 3284, 1450, 291, -139, -159, -114};
+
+/* 50 Hz 2nd order Butterworth low-pass at 1 kHz, b0 b1 b2 a1 a2 in Q14 */
+const int16_t ai16BenchBiquad[5] = {329, 658, 329, 25576, -10508};
+#endif
 
 /*==================================================================================================
 *                                      LOCAL VARIABLES
@@ -46,6 +83,51 @@ uint32_t u32AdcResultInMv_pot = 0U;
 /* ADC0 Channel 29 Result in miliVolts */
 uint32_t u32AdcResultInMv_Vrefsh = 0U;
 
+/* ADC0 calibration result, from boot */
+adc_cfg_cal_t AdcCal;
+
+#if (OVS_BITS > 12U)
+/* ADC0 Channel 12 oversampled result, OVS_BITS */
+uint32_t u32AdcResultOvs = 0U;
+#endif
+
+#if (1U == DMA_MODE)
+/* ADC0 DMA buffer, two halves of DMA_SAMPLES / 2 */
+uint16_t au16AdcDmaBuf[DMA_SAMPLES];
+#endif
+
+#if (1U == SCAN_MODE) && (0U == DMA_MODE)
+/* Pot filter stages and their state */
+adc_filt_movavg_t PotAvg;
+int16_t ai16PotHistory[POT_AVG_LENGTH];
+adc_filt_biquad_t PotBiquad;
+int32_t ai32PotBiquadState[4];
+const adc_filt_stage_t aPotFilter[2] = {{ADC_FILT_MOVAVG, &PotAvg}, {ADC_FILT_BIQUAD, &PotBiquad}};
+#endif
+
+#if (1U == FILT_BENCH_MODE)
+/* Filter rates in samples per us x 100: FIR, biquad, moving average; Q15 and float reference */
+uint32_t au32FiltRate[3];
+uint32_t au32FiltRefRate[3];
+/* Largest difference to the float reference in Q15 LSB x 100 */
+uint32_t au32FiltMaxErr[3];
+/* Benchmark buffers */
+int16_t ai16FiltIn[CONV_BENCH_SAMPLES];
+int16_t ai16FiltOut[CONV_BENCH_SAMPLES];
+float af32FiltRef[CONV_BENCH_SAMPLES];
+#endif
+
+#if (1U == CONV_BENCH_MODE)
+/* mV conversion rates in samples per us x 100: adc_conv_mv(), adc_conv_scalar() */
+uint32_t u32ConvRateSimd = 0U;
+uint32_t u32ConvRateScalar = 0U;
+/* Results of both kernels that differ from (5000*result)/0xFFF */
+uint32_t u32ConvMismatch = 0U;
+/* Benchmark buffers */
+uint16_t au16BenchRaw[CONV_BENCH_SAMPLES];
+uint16_t au16BenchMv[CONV_BENCH_SAMPLES];
+#endif
+
 /*==================================================================================================
 *                                   LOCAL FUNCTION PROTOTYPES
 ==================================================================================================*/
@@ -65,6 +147,49 @@ void WDOG_disable(void);
 */
 void PORT_init(void);
 
+#if (1U == DMA_MODE)
+/**
+* @brief            ADC DMA block.
+* @details          Average of a filled half buffer to the pot result.
+* @param[in]        pu16Samples - Raw 12 bit results.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_block(const uint16_t *pu16Samples, uint32_t u32Count);
+#endif
+
+#if (1U == SCAN_MODE) && (0U == DMA_MODE)
+/**
+* @brief            ADC scan sequence.
+* @details          Filter the pot result and convert both results to mV.
+* @param[in]        pu16Results - Raw 12 bit results: AD12, AD29.
+* @param[in]        u8Count - Number of results.
+* @return           void.
+*/
+void adc_sequence(const uint16_t *pu16Results, uint8_t u8Count);
+#endif
+
+#if (1U == CONV_BENCH_MODE)
+/**
+* @brief            Conversion benchmark.
+* @details          Time both mV kernels over CONV_BENCH_SAMPLES results with SysTick and check them.
+* @param        	void.
+* @return           void.
+*/
+void conv_bench(void);
+#endif
+
+#if (1U == FILT_BENCH_MODE)
+/**
+* @brief            Filter benchmark.
+* @details          Time each Q15 filter and its float reference over CONV_BENCH_SAMPLES samples with
+*                   SysTick and compare the outputs.
+* @param        	void.
+* @return           void.
+*/
+void filt_bench(void);
+#endif
+
 /*==================================================================================================
 *                                       LOCAL FUNCTIONS
 ==================================================================================================*/
@@ -98,6 +223,211 @@ void PORT_init(void)
 															/* Port D16: Data Direction= output */
 }
 
+#if (1U == DMA_MODE)
+/**
+* @brief            ADC DMA block.
+* @details          Average of a filled half buffer to the pot result.
+* @param[in]        pu16Samples - Raw 12 bit results.
+* @param[in]        u32Count - Number of samples.
+* @return           void.
+*/
+void adc_block(const uint16_t *pu16Samples, uint32_t u32Count)
+{
+	uint32_t u32Sum = 0U;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		u32Sum += pu16Samples[u32Index];
+	}
+	u32AdcResultInMv_pot = adc_to_mv((uint16_t)(u32Sum / u32Count));
+}
+#endif
+
+#if (1U == CONV_BENCH_MODE)
+/**
+* @brief            Conversion benchmark.
+* @details          Time both mV kernels over CONV_BENCH_SAMPLES results with SysTick and check them.
+* @param        	void.
+* @return           void.
+*/
+void conv_bench(void)
+{
+	uint32_t u32Index = 0U;
+	uint32_t u32Start = 0U;
+	uint32_t u32Clocks = 0U;
+
+	for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+	{
+		au16BenchRaw[u32Index] = (uint16_t)((u32Index * 7U) & 0xFFFU);	/* Spread over the 12 bit range */
+	}
+
+	S32_SysTick->RVR = S32_SysTick_RVR_RELOAD(0xFFFFFFU);	/* Free running 24 bit down counter */
+	S32_SysTick->CVR = 0U;
+	S32_SysTick->CSR = S32_SysTick_CSR_CLKSOURCE_MASK | S32_SysTick_CSR_ENABLE_MASK;	/* Core clock, no interrupt */
+
+	u32Start = S32_SysTick->CVR;
+	adc_conv_scalar(au16BenchRaw, au16BenchMv, CONV_BENCH_SAMPLES, ADC_CONV_MV_SCALE);
+	u32Clocks = (u32Start - S32_SysTick->CVR) & 0xFFFFFFU;
+	u32ConvRateScalar = (CONV_BENCH_SAMPLES * CORE_CLOCK_MHZ * 100U) / u32Clocks;
+	for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+	{
+		u32ConvMismatch += (au16BenchMv[u32Index] != ((5000U * au16BenchRaw[u32Index]) / 0xFFFU)) ? 1U : 0U;
+	}
+
+	u32Start = S32_SysTick->CVR;
+	adc_conv_mv(au16BenchRaw, au16BenchMv, CONV_BENCH_SAMPLES);
+	u32Clocks = (u32Start - S32_SysTick->CVR) & 0xFFFFFFU;
+	u32ConvRateSimd = (CONV_BENCH_SAMPLES * CORE_CLOCK_MHZ * 100U) / u32Clocks;
+	for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+	{
+		u32ConvMismatch += (au16BenchMv[u32Index] != ((5000U * au16BenchRaw[u32Index]) / 0xFFFU)) ? 1U : 0U;
+	}
+
+	S32_SysTick->CSR = 0U;
+}
+#endif
+
+#if (1U == SCAN_MODE) && (0U == DMA_MODE)
+/**
+* @brief            ADC scan sequence.
+* @details          Filter the pot result and convert both results to mV.
+* @param[in]        pu16Results - Raw 12 bit results: AD12, AD29.
+* @param[in]        u8Count - Number of results.
+* @return           void.
+*/
+void adc_sequence(const uint16_t *pu16Results, uint8_t u8Count)
+{
+	int16_t i16Pot = 0;
+
+	adc_conv_q15(&pu16Results[0], &i16Pot, 1U);			/* Q15 fraction of 0-5V */
+	adc_filt_run(aPotFilter, 2U, &i16Pot, 1U);				/* Noise no longer moves the LED thresholds */
+	i16Pot = (i16Pot < 0) ? 0 : i16Pot;						/* Low-pass may undershoot at 0V */
+	u32AdcResultInMv_pot = (((uint32_t)i16Pot * 5000U) + 16384U) >> 15U;
+	u32AdcResultInMv_Vrefsh = adc_to_mv(pu16Results[u8Count - 1U]);
+}
+#endif
+
+#if (1U == FILT_BENCH_MODE)
+/**
+* @brief            Filter benchmark.
+* @details          Time each Q15 filter and its float reference over CONV_BENCH_SAMPLES samples with
+*                   SysTick and compare the outputs.
+* @param        	void.
+* @return           void.
+*/
+void filt_bench(void)
+{
+	static int16_t ai16FirState[32];
+	static int32_t ai32BiquadState[4];
+	static int16_t ai16History[16];
+	adc_filt_fir_t Fir;
+	adc_filt_biquad_t Biquad;
+	adc_filt_movavg_t Avg;
+	float f32X1 = 0.0F, f32X2 = 0.0F, f32Y1 = 0.0F, f32Y2 = 0.0F;
+	float f32Acc = 0.0F;
+	float f32Err = 0.0F;
+	uint32_t u32Seed = 1U;
+	uint32_t u32Stage = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Tap = 0U;
+	uint32_t u32Start = 0U;
+	uint32_t u32Clocks = 0U;
+
+	for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+	{
+		u32Seed = (u32Seed * 1664525U) + 1013904223U;			/* Ramp plus noise, like a pot being turned */
+		ai16FiltIn[u32Index] = (int16_t)((u32Index * 24U) + ((u32Seed >> 20U) & 0x7FFU));
+	}
+
+	S32_SysTick->RVR = S32_SysTick_RVR_RELOAD(0xFFFFFFU);	/* Free running 24 bit down counter */
+	S32_SysTick->CVR = 0U;
+	S32_SysTick->CSR = S32_SysTick_CSR_CLKSOURCE_MASK | S32_SysTick_CSR_ENABLE_MASK;	/* Core clock, no interrupt */
+
+	for (u32Stage = 0U; u32Stage < 3U; u32Stage++)
+	{
+		adc_filt_fir_init(&Fir, ai16BenchFir, 16U, ai16FirState);
+		adc_filt_biquad_init(&Biquad, ai16BenchBiquad, 1U, 1U, ai32BiquadState);
+		(void)adc_filt_movavg_init(&Avg, ai16History, 16U);
+		for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+		{
+			ai16FiltOut[u32Index] = ai16FiltIn[u32Index];
+		}
+
+		/* Q15 filter in place */
+		u32Start = S32_SysTick->CVR;
+		if (ADC_FILT_FIR == u32Stage)
+		{
+			adc_filt_fir(&Fir, ai16FiltOut, CONV_BENCH_SAMPLES);
+		}
+		else if (ADC_FILT_BIQUAD == u32Stage)
+		{
+			adc_filt_biquad(&Biquad, ai16FiltOut, CONV_BENCH_SAMPLES);
+		}
+		else
+		{
+			adc_filt_movavg(&Avg, ai16FiltOut, CONV_BENCH_SAMPLES);
+		}
+		u32Clocks = (u32Start - S32_SysTick->CVR) & 0xFFFFFFU;
+		au32FiltRate[u32Stage] = (CONV_BENCH_SAMPLES * CORE_CLOCK_MHZ * 100U) / u32Clocks;
+
+		/* Float reference, same coefficients */
+		f32X1 = 0.0F;
+		f32X2 = 0.0F;
+		f32Y1 = 0.0F;
+		f32Y2 = 0.0F;
+		u32Start = S32_SysTick->CVR;
+		for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+		{
+			f32Acc = 0.0F;
+			if (ADC_FILT_FIR == u32Stage)
+			{
+				for (u32Tap = 0U; (u32Tap < 16U) && (u32Tap <= u32Index); u32Tap++)
+				{
+					f32Acc += (float)ai16BenchFir[15U - u32Tap] * (float)ai16FiltIn[u32Index - u32Tap];
+				}
+				f32Acc *= (1.0F / 32768.0F);
+			}
+			else if (ADC_FILT_BIQUAD == u32Stage)
+			{
+				f32Acc = ((float)ai16BenchBiquad[0] * (float)ai16FiltIn[u32Index]) + ((float)ai16BenchBiquad[1] * f32X1)
+					   + ((float)ai16BenchBiquad[2] * f32X2);
+				f32Acc = (f32Acc * (1.0F / 16384.0F)) + ((float)ai16BenchBiquad[3] * (1.0F / 16384.0F) * f32Y1)
+					   + ((float)ai16BenchBiquad[4] * (1.0F / 16384.0F) * f32Y2);
+				f32X2 = f32X1;
+				f32X1 = (float)ai16FiltIn[u32Index];
+				f32Y2 = f32Y1;
+				f32Y1 = f32Acc;
+			}
+			else
+			{
+				for (u32Tap = 0U; (u32Tap < 16U) && (u32Tap <= u32Index); u32Tap++)
+				{
+					f32Acc += (float)ai16FiltIn[u32Index - u32Tap];
+				}
+				f32Acc *= (1.0F / 16.0F);
+			}
+			af32FiltRef[u32Index] = f32Acc;
+		}
+		u32Clocks = (u32Start - S32_SysTick->CVR) & 0xFFFFFFU;
+		au32FiltRefRate[u32Stage] = (CONV_BENCH_SAMPLES * CORE_CLOCK_MHZ * 100U) / u32Clocks;
+
+		au32FiltMaxErr[u32Stage] = 0U;
+		for (u32Index = 0U; u32Index < CONV_BENCH_SAMPLES; u32Index++)
+		{
+			f32Err = (float)ai16FiltOut[u32Index] - af32FiltRef[u32Index];
+			f32Err = (f32Err < 0.0F) ? -f32Err : f32Err;
+			if ((uint32_t)(f32Err * 100.0F) > au32FiltMaxErr[u32Stage])
+			{
+				au32FiltMaxErr[u32Stage] = (uint32_t)(f32Err * 100.0F);
+			}
+		}
+	}
+
+	S32_SysTick->CSR = 0U;
+}
+#endif
+
 /*==================================================================================================
 *                                       GLOBAL FUNCTIONS
 ==================================================================================================*/
@@ -125,6 +455,25 @@ int main(void)
 	PORT_init(); 			/* Init port clocks and gpio outputs */
 	
 	ADC_init(); 			/* Init ADC resolution 12 bit*/
+	(void)adc_cfg_calibrate(&AdcCal);			/* Offset and gain trim, kept in AdcCal */
+	(void)adc_cfg_average(ADC_AVG_SAMPLES);
+	
+#if (1U == CONV_BENCH_MODE)
+	conv_bench();			/* mV kernels: samples per us x 100 in u32ConvRateSimd / u32ConvRateScalar */
+#endif
+#if (1U == FILT_BENCH_MODE)
+	filt_bench();			/* Q15 filters: samples per us x 100 in au32FiltRate, float in au32FiltRefRate */
+#endif
+	
+#if (1U == DMA_MODE)
+	(void)adc_dma_init(au16AdcDmaBuf, DMA_SAMPLES, adc_block);	/* Continuous conversions, DMA into two halves */
+	adc_dma_start(12U);
+#elif (1U == SCAN_MODE)
+	(void)adc_filt_movavg_init(&PotAvg, ai16PotHistory, POT_AVG_LENGTH);
+	adc_filt_biquad_init(&PotBiquad, ai16PotBiquad, 1U, 1U, ai32PotBiquadState);
+	(void)adc_scan_init(au8ScanChannels, 2U, SCAN_RATE_HZ, adc_sequence);	/* PDB0 pre-triggers convert AD12, AD29 */
+	adc_scan_start();
+#endif
 
 	/*----------------------------------------------------------- */
 	/*    Infinite For                                            */
@@ -133,11 +482,28 @@ int main(void)
 	{
 		u32Idle_counter++;						/* Increment idle counter */
 		
+#if (1U == DMA_MODE)
+												/* u32AdcResultInMv_pot is written by adc_block() */
+#elif (1U == SCAN_MODE)
+												/* Results are filtered and written by adc_sequence() */
+#else
+#if (OVS_BITS > 12U)
+		(void)adc_cfg_oversample(12U, OVS_BITS, &u32AdcResultOvs);	/* Pot at OVS_BITS resolution */
+		u32AdcResultInMv_pot = (ADC_CONV_MV_SCALE * u32AdcResultOvs) / ((1UL << OVS_BITS) - 1U);
+#else
 		convertAdcChan(12U); 					/* Convert Channel AD12 to pot on EVB */
 		while(adc_complete() == 0U)				/* Wait for conversion complete flag */
 		{
 		}
 		u32AdcResultInMv_pot = read_adc_chx(); 	/* Get channel's conversion results in mv */
+#endif
+		
+		convertAdcChan(29U); 					/* Convert chan 29, Vrefsh */
+		while(adc_complete() == 0U) 				/* Wait for conversion complete flag */
+		{
+		}
+		u32AdcResultInMv_Vrefsh = read_adc_chx(); /* Get channel's conversion results in mv */
+#endif
 		
 		if (u32AdcResultInMv_pot > 3750U) 		/* If result > 3.75V */
 		{ 
@@ -158,14 +524,34 @@ int main(void)
 		{
 			PTD->PSOR |= (1U << PTD0 | 1U << PTD15 | 1U << PTD16); /* Turn off all LEDs */
 		}
-		
-		convertAdcChan(29U); 					/* Convert chan 29, Vrefsh */
-		while(adc_complete() == 0U) 				/* Wait for conversion complete flag */
-		{
-		}
-		u32AdcResultInMv_Vrefsh = read_adc_chx(); /* Get channel's conversion results in mv */		
 	}
 }
 
+#if (1U == SCAN_MODE) && (0U == DMA_MODE)
+/**
+* @brief            ADC0 interrupt.
+* @details          Last channel of the scan list converted.
+* @param        	void.
+* @return           void.
+*/
+void ADC0_IRQHandler(void)
+{
+	adc_scan_isr();
+}
+#endif
+
+#if (1U == DMA_MODE)
+/**
+* @brief            DMA channel 1 interrupt.
+* @details          Half of the ADC0 DMA buffer filled.
+* @param        	void.
+* @return           void.
+*/
+void DMA1_IRQHandler(void)
+{
+	adc_dma_isr();
+}
+#endif
+
 
 /* END main */
@@ -0,0 +1,307 @@
+/**
+* @file				device_registers.h
+* @brief			Host register model view of the S32K144 peripherals used by the ADC drivers
+* @details			Replaces the S32K144 device header when the drivers are built on a host against
+*					sim_adc.c. Register blocks have the silicon layout and base addresses: sim_adc_init()
+*					maps them at those addresses, so ADC0, PDB0 and every driver macro stay constant.
+*					Only the registers and fields the 05_ADC drivers use are declared.
+*/
+
+#ifndef DEVICE_REGISTERS_H
+#define DEVICE_REGISTERS_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+#define __I		volatile const
+#define __O		volatile
+#define __IO	volatile
+
+/* ADC */
+typedef struct
+{
+	__IO uint32_t SC1[16];				/* 0x00 */
+	__IO uint32_t CFG1;					/* 0x40 */
+	__IO uint32_t CFG2;					/* 0x44 */
+	__I  uint32_t R[16];				/* 0x48 */
+	__IO uint32_t CV[2];				/* 0x88 */
+	__IO uint32_t SC2;					/* 0x90 */
+	__IO uint32_t SC3;					/* 0x94 */
+	__IO uint32_t BASE_OFS;				/* 0x98 */
+	__IO uint32_t OFS;					/* 0x9C */
+	__IO uint32_t USR_OFS;				/* 0xA0 */
+	__IO uint32_t XOFS;					/* 0xA4 */
+	__IO uint32_t YOFS;					/* 0xA8 */
+	__IO uint32_t G;					/* 0xAC */
+	__IO uint32_t UG;					/* 0xB0 */
+	__IO uint32_t CLPS;					/* 0xB4 */
+	__IO uint32_t CLP3;					/* 0xB8 */
+	__IO uint32_t CLP2;					/* 0xBC */
+	__IO uint32_t CLP1;					/* 0xC0 */
+	__IO uint32_t CLP0;					/* 0xC4 */
+	__IO uint32_t CLPX;					/* 0xC8 */
+	__IO uint32_t CLP9;					/* 0xCC */
+} ADC_Type;
+
+/* PDB */
+typedef struct
+{
+	__IO uint32_t SC;					/* 0x00 */
+	__IO uint32_t MOD;					/* 0x04 */
+	__I  uint32_t CNT;					/* 0x08 */
+	__IO uint32_t IDLY;					/* 0x0C */
+	struct
+	{
+		__IO uint32_t C1;				/* 0x10 + 0x28 x n */
+		__IO uint32_t S;
+		__IO uint32_t DLY[8];
+	} CH[2];
+} PDB_Type;
+
+/* SIM: ADC trigger options only */
+typedef struct
+{
+	uint8_t RESERVED_0[24];
+	__IO uint32_t ADCOPT;				/* 0x18 */
+} SIM_Type;
+
+/* PCC */
+typedef struct
+{
+	__IO uint32_t PCCn[122];
+} PCC_Type;
+
+/* eDMA */
+typedef struct
+{
+	__IO uint32_t CR;					/* 0x000 */
+	__I  uint32_t ES;					/* 0x004 */
+	uint8_t RESERVED_0[4];
+	__IO uint32_t ERQ;					/* 0x00C */
+	uint8_t RESERVED_1[4];
+	__IO uint32_t EEI;					/* 0x014 */
+	__O  uint8_t CEEI;					/* 0x018 */
+	__O  uint8_t SEEI;
+	__O  uint8_t CERQ;
+	__O  uint8_t SERQ;
+	__O  uint8_t CDNE;					/* 0x01C */
+	__O  uint8_t SSRT;
+	__O  uint8_t CERR;
+	__O  uint8_t CINT;
+	uint8_t RESERVED_2[4];
+	__IO uint32_t INT;					/* 0x024 */
+	uint8_t RESERVED_3[4];
+	__IO uint32_t ERR;					/* 0x02C */
+	uint8_t RESERVED_4[4];
+	__I  uint32_t HRS;					/* 0x034 */
+	uint8_t RESERVED_5[12];
+	__IO uint32_t EARS;					/* 0x044 */
+	uint8_t RESERVED_6[184];
+	__IO uint8_t DCHPRI[16];			/* 0x100 */
+	uint8_t RESERVED_7[3824];
+	struct
+	{
+		__IO uint32_t SADDR;			/* 0x1000 + 32 x n */
+		__IO uint16_t SOFF;
+		__IO uint16_t ATTR;
+		union
+		{
+			__IO uint32_t MLNO;
+			__IO uint32_t MLOFFNO;
+			__IO uint32_t MLOFFYES;
+		} NBYTES;
+		__IO uint32_t SLAST;
+		__IO uint32_t DADDR;
+		__IO uint16_t DOFF;
+		union
+		{
+			__IO uint16_t ELINKNO;
+			__IO uint16_t ELINKYES;
+		} CITER;
+		__IO uint32_t DLASTSGA;
+		__IO uint16_t CSR;
+		union
+		{
+			__IO uint16_t ELINKNO;
+			__IO uint16_t ELINKYES;
+		} BITER;
+	} TCD[16];
+} DMA_Type;
+
+/* DMAMUX */
+typedef struct
+{
+	__IO uint8_t CHCFG[16];
+} DMAMUX_Type;
+
+/* NVIC */
+typedef struct
+{
+	__IO uint32_t ISER[8];				/* 0x000 */
+	uint8_t RESERVED_0[96];
+	__IO uint32_t ICER[8];				/* 0x080 */
+	uint8_t RESERVED_1[96];
+	__IO uint32_t ISPR[8];				/* 0x100 */
+	uint8_t RESERVED_2[96];
+	__IO uint32_t ICPR[8];				/* 0x180 */
+	uint8_t RESERVED_3[96];
+	__I  uint32_t IABR[8];				/* 0x200 */
+	uint8_t RESERVED_4[224];
+	__IO uint8_t IP[240];				/* 0x300 */
+} S32_NVIC_Type;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Peripheral base addresses, as on the S32K144 */
+#define ADC0_BASE					(0x4003B000U)
+#define PDB0_BASE					(0x40036000U)
+#define SIM_BASE					(0x40048000U)
+#define PCC_BASE					(0x40065000U)
+#define DMA_BASE					(0x40008000U)
+#define DMAMUX_BASE					(0x40021000U)
+#define S32_NVIC_BASE				(0xE000E100U)
+
+#define ADC0						((ADC_Type *)ADC0_BASE)
+#define PDB0						((PDB_Type *)PDB0_BASE)
+#define SIM							((SIM_Type *)SIM_BASE)
+#define PCC							((PCC_Type *)PCC_BASE)
+#define DMA							((DMA_Type *)DMA_BASE)
+#define DMAMUX						((DMAMUX_Type *)DMAMUX_BASE)
+#define S32_NVIC					((S32_NVIC_Type *)S32_NVIC_BASE)
+
+/* ADC SC1 */
+#define ADC_SC1_ADCH_MASK			(0x0000001FU)
+#define ADC_SC1_ADCH(x)				((uint32_t)(x) & ADC_SC1_ADCH_MASK)
+#define ADC_SC1_AIEN_MASK			(0x00000040U)
+#define ADC_SC1_COCO_MASK			(0x00000080U)
+#define ADC_SC1_COCO_SHIFT			(7U)
+
+/* ADC CFG1, CFG2 */
+#define ADC_CFG1_ADICLK_MASK		(0x00000003U)
+#define ADC_CFG1_MODE_MASK			(0x0000000CU)
+#define ADC_CFG1_MODE_SHIFT			(2U)
+#define ADC_CFG1_MODE(x)			(((uint32_t)(x) << ADC_CFG1_MODE_SHIFT) & ADC_CFG1_MODE_MASK)
+#define ADC_CFG1_ADIV_MASK			(0x00000060U)
+#define ADC_CFG1_ADIV_SHIFT			(5U)
+#define ADC_CFG1_ADIV(x)			(((uint32_t)(x) << ADC_CFG1_ADIV_SHIFT) & ADC_CFG1_ADIV_MASK)
+#define ADC_CFG2_SMPLTS_MASK		(0x000000FFU)
+#define ADC_CFG2_SMPLTS(x)			((uint32_t)(x) & ADC_CFG2_SMPLTS_MASK)
+
+/* ADC R */
+#define ADC_R_D_MASK				(0x00000FFFU)
+
+/* ADC SC2, SC3 */
+#define ADC_SC2_DMAEN_MASK			(0x00000004U)
+#define ADC_SC2_ADTRG_MASK			(0x00000040U)
+#define ADC_SC3_AVGS_MASK			(0x00000003U)
+#define ADC_SC3_AVGS(x)				((uint32_t)(x) & ADC_SC3_AVGS_MASK)
+#define ADC_SC3_AVGE_MASK			(0x00000004U)
+#define ADC_SC3_ADCO_MASK			(0x00000008U)
+#define ADC_SC3_CAL_MASK			(0x00000080U)
+
+/* PDB SC */
+#define PDB_SC_LDOK_MASK			(0x00000001U)
+#define PDB_SC_CONT_MASK			(0x00000002U)
+#define PDB_SC_MULT_MASK			(0x0000000CU)
+#define PDB_SC_MULT_SHIFT			(2U)
+#define PDB_SC_MULT(x)				(((uint32_t)(x) << PDB_SC_MULT_SHIFT) & PDB_SC_MULT_MASK)
+#define PDB_SC_PDBEN_MASK			(0x00000080U)
+#define PDB_SC_TRGSEL_MASK			(0x00000F00U)
+#define PDB_SC_TRGSEL_SHIFT			(8U)
+#define PDB_SC_TRGSEL(x)			(((uint32_t)(x) << PDB_SC_TRGSEL_SHIFT) & PDB_SC_TRGSEL_MASK)
+#define PDB_SC_PRESCALER_MASK		(0x00007000U)
+#define PDB_SC_PRESCALER_SHIFT		(12U)
+#define PDB_SC_PRESCALER(x)			(((uint32_t)(x) << PDB_SC_PRESCALER_SHIFT) & PDB_SC_PRESCALER_MASK)
+#define PDB_SC_SWTRIG_MASK			(0x00010000U)
+
+/* PDB C1, S */
+#define PDB_C1_EN_MASK				(0x000000FFU)
+#define PDB_C1_EN(x)				((uint32_t)(x) & PDB_C1_EN_MASK)
+#define PDB_C1_TOS_MASK				(0x0000FF00U)
+#define PDB_C1_TOS(x)				(((uint32_t)(x) << 8U) & PDB_C1_TOS_MASK)
+#define PDB_C1_BB_MASK				(0x00FF0000U)
+#define PDB_C1_BB(x)				(((uint32_t)(x) << 16U) & PDB_C1_BB_MASK)
+#define PDB_S_ERR_MASK				(0x000000FFU)
+
+/* SIM ADCOPT */
+#define SIM_ADCOPT_ADC0TRGSEL_MASK		(0x00000001U)
+#define SIM_ADCOPT_ADC0PRETRGSEL_MASK	(0x00000030U)
+
+/* PCC */
+#define PCC_PCCn_CGC_MASK			(0x40000000U)
+#define PCC_PCCn_PCS_MASK			(0x07000000U)
+#define PCC_PCCn_PCS_SHIFT			(24U)
+#define PCC_PCCn_PCS(x)				(((uint32_t)(x) << PCC_PCCn_PCS_SHIFT) & PCC_PCCn_PCS_MASK)
+#define PCC_DMAMUX_INDEX			(33U)
+#define PCC_PDB0_INDEX				(54U)
+#define PCC_ADC0_INDEX				(59U)
+
+/* eDMA TCD */
+#define DMA_TCD_ATTR_DSIZE(x)		((uint16_t)((x) & 0x7U))
+#define DMA_TCD_ATTR_DMOD(x)		((uint16_t)(((x) << 3U) & 0xF8U))
+#define DMA_TCD_ATTR_SSIZE(x)		((uint16_t)(((x) << 8U) & 0x700U))
+#define DMA_TCD_ATTR_SMOD(x)		((uint16_t)(((x) << 11U) & 0xF800U))
+#define DMA_TCD_NBYTES_MLNO_NBYTES(x)	((uint32_t)(x))
+#define DMA_TCD_CITER_ELINKNO_CITER_MASK	(0x7FFFU)
+#define DMA_TCD_CITER_ELINKNO_CITER(x)	((uint16_t)((x) & DMA_TCD_CITER_ELINKNO_CITER_MASK))
+#define DMA_TCD_BITER_ELINKNO_BITER_MASK	(0x7FFFU)
+#define DMA_TCD_BITER_ELINKNO_BITER(x)	((uint16_t)((x) & DMA_TCD_BITER_ELINKNO_BITER_MASK))
+#define DMA_TCD_CSR_START_MASK		(0x0001U)
+#define DMA_TCD_CSR_INTMAJOR_MASK	(0x0002U)
+#define DMA_TCD_CSR_INTHALF_MASK	(0x0004U)
+#define DMA_TCD_CSR_DREQ_MASK		(0x0008U)
+#define DMA_TCD_CSR_ACTIVE_MASK		(0x0040U)
+#define DMA_TCD_CSR_DONE_MASK		(0x0080U)
+
+/* DMAMUX */
+#define DMAMUX_CHCFG_SOURCE(x)		((uint8_t)((x) & 0x3FU))
+#define DMAMUX_CHCFG_TRIG_MASK		(0x40U)
+#define DMAMUX_CHCFG_ENBL_MASK		(0x80U)
+
+/* Packed kernel of adc_conv.c on the host, built with __ARM_FEATURE_DSP: C equivalents of its DSP
+   instructions, same results for any operands */
+#if defined(__ARM_FEATURE_DSP) && !defined(__arm__)
+#define ADC_CONV_SMULBB(r, a, b)	((r) = (uint32_t)((int32_t)(int16_t)(uint16_t)(a) * (int32_t)(int16_t)(uint16_t)(b)))
+#define ADC_CONV_SMULTB(r, a, b)	((r) = (uint32_t)((int32_t)(int16_t)(uint16_t)((a) >> 16U) * (int32_t)(int16_t)(uint16_t)(b)))
+#define ADC_CONV_PKHBT(r, a, b)		((r) = ((uint32_t)(a) & 0xFFFFU) | ((uint32_t)(b) << 16U))
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+
+
+#endif	/* DEVICE_REGISTERS_H */
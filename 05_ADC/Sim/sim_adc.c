@@ -0,0 +1,1513 @@
+/**
+* @file			sim_adc.c
+* @brief		Host ADC0 and PDB0 register model
+* @details		Each register block is a memfd page mapped twice: at its silicon address without access
+*				rights (device view, used by the drivers) and anywhere else read/write (model view, used
+*				here). A driver access faults. The SIGSEGV handler opens the page and single-steps the
+*				instruction with the x86 trap flag; the SIGTRAP handler closes the page again and applies
+*				the side effects of the access: conversion start and abort on an SC1[n] write, COCO
+*				cleared by the R[n] read, calibration, PDB0 LDOK, SWTRIG and ERR write 0 to clear, NVIC
+*				enable state. A read fault opens the page read-only, so a read-modify-write instruction
+*				faults a second time and is handled as a write.
+*
+*				ADC0 converts in 12 bit mode only, clocked from the PCC source (SOSCDIV2, SIRCDIV2,
+*				FIRCDIV2 or SPLLDIV2 as set up by clocks_and_modes.c) divided by CFG1[ADIV]. A result
+*				takes (SMPLTS + 1 + SIM_ADC_CONV_ADCK) ADCK per conversion, times the SC3 hardware
+*				averaging, and is the rounded mean of the conversions. Each conversion is the channel
+*				input plus white noise, rounded to the nearest code; offset and gain are off by
+*				SIM_ADC_UNCAL_xxx until the calibration result is in CLPx, G and OFS. Software triggers
+*				(SC1[0]) and continuous conversions (SC3[ADCO]) are modelled, or PDB0 hardware triggers.
+*
+*				PDB0 runs from the 40 MHz bus clock with PRESCALER and MULT, software triggered
+*				(TRGSEL=15), one shot or continuous. Channel 0 pre-triggers start SC1[n] at DLY[n] (TOS)
+*				or back-to-back (BB) when SC1[n-1] completes. A pre-trigger while ADC0 is converting sets
+*				ERR and is dropped. MOD and DLY take effect at LDOK. Pre-triggers go to ADC0 only with
+*				SIM_ADCOPT at its PDB0 routing and SC2[ADTRG]=1.
+*
+*				eDMA channels routed to ADC0 (DMAMUX source 42) run one minor loop per result while
+*				SC2[DMAEN]=1: CITER/BITER, SMOD/DMOD, SLAST/DLASTSGA, INTHALF/INTMAJOR and DREQ. Reading
+*				R[n] clears COCO. Addresses outside the register blocks are host addresses, so a test
+*				using the eDMA must link its buffers below 4 GB (-no-pie).
+*
+*				A read of SC1[n] while SC1[n] converts, or of SC3 while CAL runs, is a poll: the model
+*				runs up to the end of the conversion or calibration before the read completes.
+*				Interrupts that became pending meanwhile are taken from the next sim_adc_run(), never
+*				inside thread code. Linux on x86-64 only.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#define _GNU_SOURCE
+#include <math.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "sim_adc.h"
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "sim_adc.c: register access trapping needs Linux on x86-64"
+#endif
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Register block at its silicon address */
+typedef struct
+{
+	uintptr_t uBase;				/* Silicon address */
+	uint32_t u32Size;				/* Bytes, whole pages */
+	uint8_t u8Kind;					/* SIM_REGION_xxx */
+	volatile uint8_t *pu8Model;		/* Model view */
+} sim_region_t;
+
+/* Trapped access in progress */
+typedef struct
+{
+	sim_region_t *pRegion;			/* NULL: none */
+	uintptr_t uPage;				/* Device view page */
+	uint32_t u32Offset;				/* Word offset in the region */
+	uint32_t u32Old;				/* Word before the access */
+	uint8_t u8Write;				/* Write or read-modify-write */
+} sim_access_t;
+
+/* ADC0 conversion and calibration state */
+typedef struct
+{
+	uint8_t u8Busy;					/* Conversion running */
+	uint8_t u8Index;				/* SC1[n] converted */
+	uint8_t u8Chan;					/* Its ADCH, latched at the start */
+	uint8_t u8Hw;					/* Started by a PDB0 pre-trigger */
+	uint32_t u32Samples;			/* Conversions of the result (hardware averaging) */
+	uint64_t u64Due;				/* End of the result */
+	uint8_t u8Cal;					/* Calibration running */
+	uint64_t u64CalDue;
+	uint32_t u32Polls;				/* SC1[n] reads without a result coming */
+} sim_adc_t;
+
+/* PDB0 counter */
+typedef struct
+{
+	uint8_t u8Running;				/* Counting */
+	uint64_t u64Start;				/* Start of the period */
+	uint64_t u64Clock;				/* Ticks per PDB0 clock */
+	uint32_t u32Mod;				/* MOD and channel 0 DLY loaded by LDOK */
+	uint32_t au32Dly[8];
+	uint8_t u8Pending;				/* Delayed pre-triggers still to come in this period */
+} sim_pdb_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Register block page */
+#define SIM_PAGE				(0x1000U)
+
+/* Region kinds */
+#define SIM_REGION_ADC			(0U)
+#define SIM_REGION_PDB			(1U)
+#define SIM_REGION_SCS			(2U)		/* NVIC */
+#define SIM_REGION_DMA			(3U)		/* eDMA control registers and TCDs */
+#define SIM_REGION_PLAIN		(4U)		/* Plain memory, not trapped */
+#define SIM_REGION_COUNT		(7U)
+
+/* SC1[n] reads without a conversion of SC1[n] running: a poll loop that never ends */
+#define SIM_POLL_LIMIT			(100000U)
+
+/* Interrupt numbers */
+#define SIM_IRQ_COUNT			(128U)
+
+/* ADCH=1F: SC1[n] disabled */
+#define SIM_ADCH_OFF			(0x1FU)
+
+/* PDB0 TRGSEL=15: software trigger */
+#define SIM_PDB_SWTRIG			(15U)
+
+/* Bus clock, 40 MHz, in ticks */
+#define SIM_BUS_TICKS			(SIM_ADC_TICK_HZ / 40000000U)
+
+/* Register offsets */
+#define SIM_OFF(reg)			((uint32_t)offsetof(ADC_Type, reg))
+#define SIM_SC1_END				(SIM_OFF(CFG1))
+#define SIM_R_OFF				(SIM_OFF(R))
+#define SIM_R_END				(SIM_OFF(CV))
+#define SIM_SC3_OFF				(SIM_OFF(SC3))
+#define SIM_PDB_SC_OFF			((uint32_t)offsetof(PDB_Type, SC))
+#define SIM_PDB_S0_OFF			((uint32_t)offsetof(PDB_Type, CH[0].S))
+#define SIM_PDB_S1_OFF			((uint32_t)offsetof(PDB_Type, CH[1].S))
+#define SIM_NVIC_OFF			(S32_NVIC_BASE - 0xE000E000U)
+
+/* eDMA */
+#define SIM_DMA_CEEI_OFF		((uint32_t)offsetof(DMA_Type, CEEI))	/* CEEI, SEEI, CERQ, SERQ */
+#define SIM_DMA_CDNE_OFF		((uint32_t)offsetof(DMA_Type, CDNE))	/* CDNE, SSRT, CERR, CINT */
+#define SIM_DMA_INT_OFF			((uint32_t)offsetof(DMA_Type, INT))
+#define SIM_DMA_BYTES_NOP		(0x80808080U)
+#define SIM_DMA_NOP				(0x80U)
+#define SIM_DMA_ALL				(0x40U)		/* CAER, SAER, ...: all channels */
+#define SIM_DMA_CSR_ESG			(0x0010U)
+#define SIM_DMA_CSR_MAJORELINK	(0x0020U)
+#define SIM_DMA_ITER_ELINK		(0x8000U)
+#define SIM_DMA_REQ_ADC0		(42U)
+
+/* Register blocks, model view */
+#define SIM_WORD(region, off)	(*(volatile uint32_t *)&(region)->pu8Model[(off)])
+#define SIM_ADC0()				((ADC_Type *)(uintptr_t)s_aRegion[0].pu8Model)
+#define SIM_PDB0()				((PDB_Type *)(uintptr_t)s_aRegion[1].pu8Model)
+#define SIM_NVIC()				((S32_NVIC_Type *)(uintptr_t)&s_aRegion[2].pu8Model[SIM_NVIC_OFF])
+#define SIM_DMA()				((DMA_Type *)(uintptr_t)s_aRegion[3].pu8Model)
+#define SIM_OPT()				((SIM_Type *)(uintptr_t)s_aRegion[4].pu8Model)
+#define SIM_PCC()				((PCC_Type *)(uintptr_t)s_aRegion[5].pu8Model)
+#define SIM_DMAMUX()			((DMAMUX_Type *)(uintptr_t)s_aRegion[6].pu8Model)
+
+/* Silicon layout */
+_Static_assert(offsetof(ADC_Type, CFG1) == 0x40U, "ADC_Type CFG1");
+_Static_assert(offsetof(ADC_Type, R) == 0x48U, "ADC_Type R");
+_Static_assert(offsetof(ADC_Type, SC2) == 0x90U, "ADC_Type SC2");
+_Static_assert(offsetof(ADC_Type, G) == 0xACU, "ADC_Type G");
+_Static_assert(offsetof(ADC_Type, CLP9) == 0xCCU, "ADC_Type CLP9");
+_Static_assert(offsetof(PDB_Type, CH[0].DLY) == 0x18U, "PDB_Type DLY");
+_Static_assert(offsetof(PDB_Type, CH[1].C1) == 0x38U, "PDB_Type CH");
+_Static_assert(offsetof(SIM_Type, ADCOPT) == 0x18U, "SIM_Type ADCOPT");
+_Static_assert(offsetof(S32_NVIC_Type, IP) == 0x300U, "S32_NVIC_Type IP");
+_Static_assert(offsetof(DMA_Type, TCD) == 0x1000U, "DMA_Type TCD");
+_Static_assert(offsetof(DMA_Type, CDNE) == 0x1CU, "DMA_Type CDNE");
+_Static_assert(offsetof(DMA_Type, INT) == 0x24U, "DMA_Type INT");
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* PDB0 SC[MULT] multiplication factors */
+static const uint8_t s_au8Mult[4] = {1U, 10U, 20U, 40U};
+
+/* Calibration result: CLPS, CLP3, CLP2, CLP1, CLP0, CLPX, CLP9, G, OFS */
+static const uint32_t s_au32Trim[9] = {0x2EU, 0x174U, 0xBAU, 0x5DU, 0x2EU, 0x1CU, 0x12U, 0x3F8U, 0xFFFDU};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Register blocks */
+static sim_region_t s_aRegion[SIM_REGION_COUNT] =
+{
+	{ADC0_BASE, SIM_PAGE, SIM_REGION_ADC, NULL},
+	{PDB0_BASE, SIM_PAGE, SIM_REGION_PDB, NULL},
+	{0xE000E000U, SIM_PAGE, SIM_REGION_SCS, NULL},
+	{DMA_BASE, 2U * SIM_PAGE, SIM_REGION_DMA, NULL},
+	{SIM_BASE, SIM_PAGE, SIM_REGION_PLAIN, NULL},
+	{PCC_BASE, SIM_PAGE, SIM_REGION_PLAIN, NULL},
+	{DMAMUX_BASE, SIM_PAGE, SIM_REGION_PLAIN, NULL}
+};
+
+static sim_access_t s_Access;
+static sim_adc_t s_Adc;
+static sim_pdb_t s_Pdb;
+static sim_adc_stats_t s_Stats;
+
+/* Inputs: levels in mV, source, noise in LSB rms */
+static double s_adInput[32];
+static sim_adc_source_t s_pfSource;
+static double s_dNoise;
+
+/* Interrupts: handlers, NVIC state, handler calls without time passing */
+static sim_adc_isr_t s_apfIsr[SIM_IRQ_COUNT];
+static uint32_t s_au32NvicEnabled[4];
+static uint32_t s_au32NvicPending[4];
+static uint8_t s_au8IrqCalls[SIM_IRQ_COUNT];
+
+/* Model time */
+static uint64_t s_u64Now;
+
+/* Random numbers of the noise: xorshift64*, second value of the Box-Muller pair */
+static uint64_t s_u64Random;
+static double s_dGauss;
+static uint8_t s_u8GaussValid;
+
+/* Checks */
+static uint32_t s_u32Checks;
+static uint32_t s_u32Failed;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void sim_fatal(const char *pcFormat, ...);
+static sim_region_t *sim_region_find(uintptr_t uAddr);
+static void sim_segv(int iSig, siginfo_t *pInfo, void *pvContext);
+static void sim_trap(int iSig, siginfo_t *pInfo, void *pvContext);
+static void sim_map(void);
+static double sim_gauss(void);
+static uint64_t sim_adck_ticks(void);
+static uint32_t sim_samples(uint32_t u32Sc3);
+static uint8_t sim_trimmed(void);
+static uint16_t sim_convert(uint8_t u8Chan, uint32_t u32Samples);
+static void sim_adc_start(uint8_t u8Index, uint8_t u8Hw);
+static void sim_adc_done(void);
+static void sim_cal_done(void);
+static void sim_adc_pre(sim_region_t *pRegion, uint32_t u32Off);
+static void sim_adc_read(sim_region_t *pRegion, uint32_t u32Off);
+static void sim_adc_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static void sim_pdb_fire(uint8_t u8Pre);
+static void sim_pdb_period(void);
+static uint64_t sim_pdb_due(uint8_t u8Pre);
+static void sim_pdb_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static void sim_scs_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static void sim_dma_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static volatile uint8_t *sim_dma_addr(uint32_t u32Addr);
+static uint32_t sim_dma_next(uint32_t u32Addr, int16_t s16Offset, uint32_t u32Mod);
+static void sim_dma_minor(uint32_t u32Ch);
+static void sim_dma_service(void);
+static uint8_t sim_irq_active(uint32_t u32Irq);
+static void sim_irq_dispatch(void);
+static uint8_t sim_event(void);
+static void sim_run(uint64_t u64End, uint8_t u8Irqs);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Stop on a model error.
+* @param[in]        pcFormat - printf format.
+* @return           void.
+*/
+static void sim_fatal(const char *pcFormat, ...)
+{
+	va_list args;
+
+	va_start(args, pcFormat);
+	(void)fprintf(stderr, "sim_adc: ");
+	(void)vfprintf(stderr, pcFormat, args);
+	(void)fprintf(stderr, "\n");
+	va_end(args);
+	(void)fflush(stderr);
+	_exit(2);
+}
+
+/**
+* @brief            Register block of an address.
+* @param[in]        uAddr - Address.
+* @return           Region, NULL if none.
+*/
+static sim_region_t *sim_region_find(uintptr_t uAddr)
+{
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		if ((uAddr >= s_aRegion[u32Index].uBase) && (uAddr < (s_aRegion[u32Index].uBase + s_aRegion[u32Index].u32Size)))
+		{
+			return &s_aRegion[u32Index];
+		}
+	}
+	return NULL;
+}
+
+/**
+* @brief            Register access fault.
+* @details          Pre-access update, open the page, single-step the instruction.
+* @param[in]        iSig - SIGSEGV.
+* @param[in]        pInfo - Fault address.
+* @param[in]        pvContext - Interrupted context.
+* @return           void.
+*/
+static void sim_segv(int iSig, siginfo_t *pInfo, void *pvContext)
+{
+	ucontext_t *pContext = (ucontext_t *)pvContext;
+	uintptr_t uAddr = (uintptr_t)pInfo->si_addr;
+	sim_region_t *pRegion = sim_region_find(uAddr);
+	uint8_t u8Write = (0 != (pContext->uc_mcontext.gregs[REG_ERR] & 2)) ? 1U : 0U;
+
+	(void)iSig;
+	if (NULL == pRegion)
+	{
+		sim_fatal("access to %p, not a modelled register", pInfo->si_addr);
+	}
+
+	if (NULL != s_Access.pRegion)				/* Second fault of the instruction: it also writes */
+	{
+		if ((pRegion != s_Access.pRegion) || (0U == u8Write))
+		{
+			sim_fatal("instruction accesses two registers at %p", pInfo->si_addr);
+		}
+		s_Access.u8Write = 1U;
+		(void)mprotect((void *)s_Access.uPage, SIM_PAGE, PROT_READ | PROT_WRITE);
+		return;
+	}
+
+	if ((SIM_REGION_ADC == pRegion->u8Kind) && (0U == (SIM_PCC()->PCCn[PCC_ADC0_INDEX] & PCC_PCCn_CGC_MASK)))
+	{
+		sim_fatal("ADC0 register access with the PCC clock gated (offset 0x%02X)", (uint32_t)(uAddr - pRegion->uBase));
+	}
+	if ((SIM_REGION_PDB == pRegion->u8Kind) && (0U == (SIM_PCC()->PCCn[PCC_PDB0_INDEX] & PCC_PCCn_CGC_MASK)))
+	{
+		sim_fatal("PDB0 register access with the PCC clock gated (offset 0x%02X)", (uint32_t)(uAddr - pRegion->uBase));
+	}
+
+	s_Stats.u32Accesses++;
+	s_Access.pRegion = pRegion;
+	s_Access.uPage = uAddr & ~(uintptr_t)(SIM_PAGE - 1U);
+	s_Access.u32Offset = (uint32_t)(uAddr - pRegion->uBase) & ~3U;
+	s_Access.u8Write = u8Write;
+
+	if ((SIM_REGION_ADC == pRegion->u8Kind) && (0U == u8Write))
+	{
+		sim_adc_pre(pRegion, s_Access.u32Offset);
+	}
+	s_Access.u32Old = SIM_WORD(pRegion, s_Access.u32Offset);
+
+	(void)mprotect((void *)s_Access.uPage, SIM_PAGE, (0U != u8Write) ? (PROT_READ | PROT_WRITE) : PROT_READ);
+	pContext->uc_mcontext.gregs[REG_EFL] |= 0x100;	/* TF: trap after the instruction */
+}
+
+/**
+* @brief            Register access done.
+* @details          Close the page, apply the side effects of the access.
+* @param[in]        iSig - SIGTRAP.
+* @param[in]        pInfo - Unused.
+* @param[in]        pvContext - Interrupted context.
+* @return           void.
+*/
+static void sim_trap(int iSig, siginfo_t *pInfo, void *pvContext)
+{
+	ucontext_t *pContext = (ucontext_t *)pvContext;
+	sim_region_t *pRegion = s_Access.pRegion;
+
+	(void)iSig;
+	(void)pInfo;
+	if (NULL == pRegion)
+	{
+		sim_fatal("unexpected SIGTRAP");
+	}
+	pContext->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+	(void)mprotect((void *)s_Access.uPage, SIM_PAGE, PROT_NONE);
+	s_Access.pRegion = NULL;
+
+	switch (pRegion->u8Kind)
+	{
+		case SIM_REGION_ADC:
+			if (0U != s_Access.u8Write)
+			{
+				sim_adc_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			else
+			{
+				sim_adc_read(pRegion, s_Access.u32Offset);
+			}
+			break;
+		case SIM_REGION_PDB:
+			if (0U != s_Access.u8Write)
+			{
+				sim_pdb_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+		case SIM_REGION_SCS:
+			if (0U != s_Access.u8Write)
+			{
+				sim_scs_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+		default:
+			if (0U != s_Access.u8Write)
+			{
+				sim_dma_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+	}
+}
+
+/**
+* @brief            Map the register blocks.
+* @param        	void.
+* @return           void.
+*/
+static void sim_map(void)
+{
+	struct sigaction action;
+	uint32_t u32Index = 0U;
+	uint32_t u32Total = 0U;
+	uint32_t u32Offset = 0U;
+	void *pvDevice = NULL;
+	void *pvModel = NULL;
+	int iFd = memfd_create("sim_adc", 0U);
+
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		u32Total += s_aRegion[u32Index].u32Size;
+	}
+	if ((iFd < 0) || (0 != ftruncate(iFd, (off_t)u32Total)))
+	{
+		sim_fatal("memfd");
+	}
+
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		pvDevice = mmap((void *)s_aRegion[u32Index].uBase, s_aRegion[u32Index].u32Size,
+						(SIM_REGION_PLAIN == s_aRegion[u32Index].u8Kind) ? (PROT_READ | PROT_WRITE) : PROT_NONE,
+						MAP_SHARED | MAP_FIXED_NOREPLACE, iFd, (off_t)u32Offset);
+		pvModel = mmap(NULL, s_aRegion[u32Index].u32Size, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, (off_t)u32Offset);
+		if ((pvDevice != (void *)s_aRegion[u32Index].uBase) || (MAP_FAILED == pvModel))
+		{
+			sim_fatal("cannot map the registers at 0x%08lX", (unsigned long)s_aRegion[u32Index].uBase);
+		}
+		s_aRegion[u32Index].pu8Model = (volatile uint8_t *)pvModel;
+		u32Offset += s_aRegion[u32Index].u32Size;
+	}
+
+	(void)memset(&action, 0, sizeof(action));
+	action.sa_sigaction = sim_segv;
+	action.sa_flags = SA_SIGINFO;
+	(void)sigaction(SIGSEGV, &action, NULL);
+	action.sa_sigaction = sim_trap;
+	(void)sigaction(SIGTRAP, &action, NULL);
+}
+
+/**
+* @brief            Gaussian random number, mean 0, standard deviation 1 (xorshift64*, Box-Muller).
+* @param        	void.
+* @return           Number.
+*/
+static double sim_gauss(void)
+{
+	double adUniform[2];
+	double dRadius = 0.0;
+	uint32_t u32Index = 0U;
+
+	if (0U != s_u8GaussValid)
+	{
+		s_u8GaussValid = 0U;
+		return s_dGauss;
+	}
+	for (u32Index = 0U; u32Index < 2U; u32Index++)
+	{
+		s_u64Random ^= s_u64Random >> 12U;
+		s_u64Random ^= s_u64Random << 25U;
+		s_u64Random ^= s_u64Random >> 27U;
+		adUniform[u32Index] = ((double)((s_u64Random * 0x2545F4914F6CDD1DULL) >> 11U) + 1.0) / 9007199254740992.0;	/* (0, 1] */
+	}
+	dRadius = sqrt(-2.0 * log(adUniform[0]));
+	s_dGauss = dRadius * sin(2.0 * M_PI * adUniform[1]);
+	s_u8GaussValid = 1U;
+	return dRadius * cos(2.0 * M_PI * adUniform[1]);
+}
+
+/**
+* @brief            ADC clock period.
+* @details          PCC clock source divided by CFG1[ADIV]. The sources are the DIV2 outputs of
+*					clocks_and_modes.c: SOSCDIV2 and SIRCDIV2 8 MHz, FIRCDIV2 48 MHz, SPLLDIV2 40 MHz.
+* @param        	void.
+* @return           Ticks per ADCK.
+*/
+static uint64_t sim_adck_ticks(void)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	uint32_t u32Pcc = SIM_PCC()->PCCn[PCC_ADC0_INDEX];
+	uint64_t u64Ticks = 0U;
+
+	switch ((u32Pcc & PCC_PCCn_PCS_MASK) >> PCC_PCCn_PCS_SHIFT)
+	{
+		case 1U:
+		case 2U:
+			u64Ticks = SIM_ADC_TICK_HZ / 8000000U;
+			break;
+		case 3U:
+			u64Ticks = SIM_ADC_TICK_HZ / 48000000U;
+			break;
+		case 6U:
+			u64Ticks = SIM_ADC_TICK_HZ / 40000000U;
+			break;
+		default:
+			sim_fatal("ADC0 clock: PCC PCS %u not modelled", (u32Pcc & PCC_PCCn_PCS_MASK) >> PCC_PCCn_PCS_SHIFT);
+			break;
+	}
+	if ((0U != (pAdc->CFG1 & ADC_CFG1_ADICLK_MASK)) || (ADC_CFG1_MODE(1U) != (pAdc->CFG1 & ADC_CFG1_MODE_MASK)))
+	{
+		sim_fatal("ADC0 CFG1 0x%08X: only ADICLK=0 (PCC clock), MODE=1 (12 bit) modelled", pAdc->CFG1);
+	}
+	return u64Ticks << ((pAdc->CFG1 & ADC_CFG1_ADIV_MASK) >> ADC_CFG1_ADIV_SHIFT);
+}
+
+/**
+* @brief            Conversions per result.
+* @param[in]        u32Sc3 - SC3.
+* @return           1, 4, 8, 16 or 32.
+*/
+static uint32_t sim_samples(uint32_t u32Sc3)
+{
+	return (0U == (u32Sc3 & ADC_SC3_AVGE_MASK)) ? 1U : (4UL << (u32Sc3 & ADC_SC3_AVGS_MASK));
+}
+
+/**
+* @brief            Calibration result in place.
+* @param        	void.
+* @return           1 if CLPx, G and OFS hold the result of a calibration.
+*/
+static uint8_t sim_trimmed(void)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+
+	return ((s_au32Trim[0] == pAdc->CLPS) && (s_au32Trim[1] == pAdc->CLP3) && (s_au32Trim[2] == pAdc->CLP2)
+			&& (s_au32Trim[3] == pAdc->CLP1) && (s_au32Trim[4] == pAdc->CLP0) && (s_au32Trim[5] == pAdc->CLPX)
+			&& (s_au32Trim[6] == pAdc->CLP9) && (s_au32Trim[7] == pAdc->G) && (s_au32Trim[8] == pAdc->OFS)) ? 1U : 0U;
+}
+
+/**
+* @brief            Result of a channel.
+* @details          Input in LSB, offset and gain error without calibration, noise per conversion,
+*					each conversion rounded to a code, the result the rounded mean.
+* @param[in]        u8Chan - ADCH.
+* @param[in]        u32Samples - Conversions.
+* @return           12 bit result.
+*/
+static uint16_t sim_convert(uint8_t u8Chan, uint32_t u32Samples)
+{
+	double dInput = (NULL != s_pfSource) ? s_pfSource(u8Chan, s_u64Now) : s_adInput[u8Chan];
+	double dLsb = dInput * SIM_ADC_FULL_SCALE / SIM_ADC_VREF_MV;
+	double dCode = 0.0;
+	uint32_t u32Sum = 0U;
+	uint32_t u32Index = 0U;
+
+	if (0U == sim_trimmed())
+	{
+		dLsb = dLsb * (1.0 + SIM_ADC_UNCAL_GAIN) + SIM_ADC_UNCAL_OFFSET;
+	}
+	for (u32Index = 0U; u32Index < u32Samples; u32Index++)
+	{
+		dCode = floor(dLsb + ((s_dNoise > 0.0) ? (s_dNoise * sim_gauss()) : 0.0) + 0.5);
+		u32Sum += (dCode < 0.0) ? 0U : ((dCode > SIM_ADC_FULL_SCALE) ? 4095U : (uint32_t)dCode);
+	}
+	s_Stats.u32Conversions += u32Samples;
+	return (uint16_t)((u32Sum + u32Samples / 2U) / u32Samples);
+}
+
+/**
+* @brief            Start a result of SC1[n].
+* @details          An SC1[n] with ADCH=1F does not convert.
+* @param[in]        u8Index - n.
+* @param[in]        u8Hw - Started by a PDB0 pre-trigger.
+* @return           void.
+*/
+static void sim_adc_start(uint8_t u8Index, uint8_t u8Hw)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	uint8_t u8Chan = (uint8_t)(pAdc->SC1[u8Index] & ADC_SC1_ADCH_MASK);
+
+	if (SIM_ADCH_OFF == u8Chan)
+	{
+		return;
+	}
+	s_Adc.u8Busy = 1U;
+	s_Adc.u8Index = u8Index;
+	s_Adc.u8Chan = u8Chan;
+	s_Adc.u8Hw = u8Hw;
+	s_Adc.u32Samples = sim_samples(pAdc->SC3);
+	s_Adc.u64Due = s_u64Now + sim_adc_result_ticks();
+}
+
+/**
+* @brief            End of a result: R[n], COCO, next continuous conversion or back-to-back pre-trigger.
+* @param        	void.
+* @return           void.
+*/
+static void sim_adc_done(void)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	uint8_t u8Index = s_Adc.u8Index;
+
+	s_Adc.u8Busy = 0U;
+	if (0U != (pAdc->SC1[u8Index] & ADC_SC1_COCO_MASK))
+	{
+		s_Stats.u32Overwritten++;
+	}
+	*(volatile uint32_t *)&pAdc->R[u8Index] = sim_convert(s_Adc.u8Chan, s_Adc.u32Samples);
+	pAdc->SC1[u8Index] |= ADC_SC1_COCO_MASK;
+	s_Stats.u32Results++;
+
+	if (0U != s_Adc.u8Hw)
+	{
+		u8Index++;
+		if ((u8Index < 8U) && (0U != (SIM_PDB0()->CH[0].C1 & PDB_C1_EN(1UL << u8Index) & (PDB_C1_BB(1UL << u8Index) >> 16U))))
+		{
+			sim_pdb_fire(u8Index);					/* Back-to-back: next pre-trigger */
+		}
+	}
+	else if ((0U != (pAdc->SC3 & ADC_SC3_ADCO_MASK)) && (0U == (pAdc->SC2 & ADC_SC2_ADTRG_MASK)))
+	{
+		sim_adc_start(0U, 0U);						/* Continuous conversions */
+	}
+	else
+	{
+	}
+}
+
+/**
+* @brief            End of the calibration: result in CLPx, G and OFS, CAL cleared, COCO set.
+* @param        	void.
+* @return           void.
+*/
+static void sim_cal_done(void)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+
+	s_Adc.u8Cal = 0U;
+	pAdc->CLPS = s_au32Trim[0];
+	pAdc->CLP3 = s_au32Trim[1];
+	pAdc->CLP2 = s_au32Trim[2];
+	pAdc->CLP1 = s_au32Trim[3];
+	pAdc->CLP0 = s_au32Trim[4];
+	pAdc->CLPX = s_au32Trim[5];
+	pAdc->CLP9 = s_au32Trim[6];
+	pAdc->G = s_au32Trim[7];
+	pAdc->OFS = s_au32Trim[8];
+	pAdc->SC3 &= ~ADC_SC3_CAL_MASK;
+	pAdc->SC1[0] |= ADC_SC1_COCO_MASK;
+	s_Stats.u32Calibrations++;
+}
+
+/**
+* @brief            ADC0 read, before the instruction: a poll of SC1[n] or SC3 waits for its flag.
+* @param[in]        pRegion - ADC0 registers.
+* @param[in]        u32Off - Word offset.
+* @return           void.
+*/
+static void sim_adc_pre(sim_region_t *pRegion, uint32_t u32Off)
+{
+	uint64_t u64Due = 0U;
+
+	if ((u32Off < SIM_SC1_END) && (0U == (SIM_WORD(pRegion, u32Off) & ADC_SC1_COCO_MASK)))
+	{
+		if ((0U != s_Adc.u8Busy) && ((u32Off / 4U) == s_Adc.u8Index))
+		{
+			u64Due = s_Adc.u64Due;
+		}
+		else if (++s_Adc.u32Polls > SIM_POLL_LIMIT)
+		{
+			sim_fatal("SC1[%u] polled without a conversion running", u32Off / 4U);
+		}
+		else
+		{
+		}
+	}
+	else if ((SIM_SC3_OFF == u32Off) && (0U != s_Adc.u8Cal))
+	{
+		u64Due = s_Adc.u64CalDue;
+	}
+	else
+	{
+	}
+
+	if (0U != u64Due)
+	{
+		s_Stats.u64PollTicks += u64Due - s_u64Now;
+		sim_run(u64Due, 0U);						/* Model only: no handlers inside thread code */
+		s_Adc.u32Polls = 0U;
+	}
+}
+
+/**
+* @brief            ADC0 read: R[n] clears COCO of SC1[n].
+* @param[in]        pRegion - ADC0 registers.
+* @param[in]        u32Off - Word offset.
+* @return           void.
+*/
+static void sim_adc_read(sim_region_t *pRegion, uint32_t u32Off)
+{
+	if ((u32Off >= SIM_R_OFF) && (u32Off < SIM_R_END))
+	{
+		SIM_WORD(pRegion, (u32Off - SIM_R_OFF)) &= ~ADC_SC1_COCO_MASK;
+	}
+}
+
+/**
+* @brief            ADC0 write: SC1[n] start and abort, R read-only, SC3[CAL] start.
+* @param[in]        pRegion - ADC0 registers.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_adc_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+
+	s_Adc.u32Polls = 0U;
+	if (u32Off < SIM_SC1_END)
+	{
+		SIM_WORD(pRegion, u32Off) = u32New & ~ADC_SC1_COCO_MASK;	/* Write clears COCO */
+		if ((0U != s_Adc.u8Busy) && (((u32Off / 4U) == s_Adc.u8Index) || ((0U == u32Off) && (0U == s_Adc.u8Hw))))
+		{
+			s_Adc.u8Busy = 0U;
+			s_Stats.u32Aborted++;
+		}
+		if ((0U == u32Off) && (0U == (pAdc->SC2 & ADC_SC2_ADTRG_MASK)) && (0U == s_Adc.u8Cal))
+		{
+			sim_adc_start(0U, 0U);					/* Software trigger */
+		}
+	}
+	else if ((u32Off >= SIM_R_OFF) && (u32Off < SIM_R_END))
+	{
+		SIM_WORD(pRegion, u32Off) = u32Old;			/* Read-only */
+	}
+	else if (SIM_SC3_OFF == u32Off)
+	{
+		if (0U != s_Adc.u8Cal)
+		{
+			SIM_WORD(pRegion, u32Off) = u32New | ADC_SC3_CAL_MASK;	/* Cleared by the hardware only */
+		}
+		else if (0U != (u32New & ADC_SC3_CAL_MASK))
+		{
+			if (0U != (pAdc->SC2 & ADC_SC2_ADTRG_MASK))
+			{
+				sim_fatal("ADC0 calibration started with SC2[ADTRG]=1");
+			}
+			if (0U != s_Adc.u8Busy)
+			{
+				s_Adc.u8Busy = 0U;
+				s_Stats.u32Aborted++;
+			}
+			s_Adc.u8Cal = 1U;
+			s_Adc.u64CalDue = s_u64Now + SIM_ADC_CAL_CONV * sim_adc_result_ticks();
+		}
+		else
+		{
+		}
+	}
+	else
+	{
+	}
+}
+
+/**
+* @brief            PDB0 channel 0 pre-trigger: start SC1[n], or ERR if ADC0 is converting.
+* @param[in]        u8Pre - Pre-trigger n.
+* @return           void.
+*/
+static void sim_pdb_fire(uint8_t u8Pre)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	PDB_Type *pPdb = SIM_PDB0();
+
+	if ((0U != (SIM_OPT()->ADCOPT & (SIM_ADCOPT_ADC0TRGSEL_MASK | SIM_ADCOPT_ADC0PRETRGSEL_MASK)))
+		|| (0U == (pAdc->SC2 & ADC_SC2_ADTRG_MASK)))
+	{
+		return;										/* Not routed to ADC0, or ADC0 software triggered */
+	}
+	if ((0U != s_Adc.u8Busy) || (0U != s_Adc.u8Cal))
+	{
+		pPdb->CH[0].S |= 1UL << u8Pre;				/* Sequence error, pre-trigger dropped */
+		s_Stats.u32PdbErrors++;
+		return;
+	}
+	s_Stats.u32PdbTriggers++;
+	sim_adc_start(u8Pre, 1U);
+}
+
+/**
+* @brief            Start of a PDB0 period: delayed pre-triggers armed, the ones without delay fire.
+* @param        	void.
+* @return           void.
+*/
+static void sim_pdb_period(void)
+{
+	uint32_t u32C1 = SIM_PDB0()->CH[0].C1;
+	uint8_t u8Pre = 0U;
+
+	if (0U != (u32C1 & PDB_C1_BB(1U)))
+	{
+		sim_fatal("PDB0 pre-trigger 0 back-to-back (chained to channel 1) not modelled");
+	}
+	s_Pdb.u8Pending = (uint8_t)((u32C1 & PDB_C1_EN_MASK) & ~((u32C1 & PDB_C1_BB_MASK) >> 16U));
+	for (u8Pre = 0U; u8Pre < 8U; u8Pre++)
+	{
+		if ((0U != (s_Pdb.u8Pending & (1U << u8Pre))) && (0U == (u32C1 & PDB_C1_TOS(1UL << u8Pre))))
+		{
+			s_Pdb.u8Pending &= (uint8_t)~(1U << u8Pre);
+			sim_pdb_fire(u8Pre);					/* TOS=0: at the trigger */
+		}
+	}
+}
+
+/**
+* @brief            Time of a delayed pre-trigger in the current period.
+* @param[in]        u8Pre - Pre-trigger n.
+* @return           Ticks.
+*/
+static uint64_t sim_pdb_due(uint8_t u8Pre)
+{
+	return s_Pdb.u64Start + (uint64_t)s_Pdb.au32Dly[u8Pre] * s_Pdb.u64Clock;
+}
+
+/**
+* @brief            PDB0 write: LDOK loads MOD and DLY, SWTRIG starts the counter, PDBEN=0 stops it,
+*					S[ERR] write 0 to clear.
+* @param[in]        pRegion - PDB0 registers.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_pdb_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	PDB_Type *pPdb = SIM_PDB0();
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+	uint32_t u32Index = 0U;
+
+	if ((SIM_PDB_S0_OFF == u32Off) || (SIM_PDB_S1_OFF == u32Off))
+	{
+		SIM_WORD(pRegion, u32Off) = (u32New & ~PDB_S_ERR_MASK) | (u32Old & u32New & PDB_S_ERR_MASK);
+		return;
+	}
+	if (SIM_PDB_SC_OFF != u32Off)
+	{
+		return;										/* MOD, DLY: buffered until LDOK */
+	}
+
+	pPdb->SC = u32New & ~(PDB_SC_LDOK_MASK | PDB_SC_SWTRIG_MASK);
+	if (0U == (u32New & PDB_SC_PDBEN_MASK))
+	{
+		s_Pdb.u8Running = 0U;
+		return;										/* LDOK, SWTRIG ignored while disabled */
+	}
+	if (0U != (u32New & PDB_SC_LDOK_MASK))
+	{
+		s_Pdb.u32Mod = pPdb->MOD & 0xFFFFU;
+		for (u32Index = 0U; u32Index < 8U; u32Index++)
+		{
+			s_Pdb.au32Dly[u32Index] = pPdb->CH[0].DLY[u32Index] & 0xFFFFU;
+		}
+	}
+	if ((0U != (u32New & PDB_SC_SWTRIG_MASK))
+		&& (SIM_PDB_SWTRIG == ((u32New & PDB_SC_TRGSEL_MASK) >> PDB_SC_TRGSEL_SHIFT)))
+	{
+		s_Pdb.u8Running = 1U;
+		s_Pdb.u64Start = s_u64Now;
+		s_Pdb.u64Clock = (uint64_t)SIM_BUS_TICKS * (1UL << ((u32New & PDB_SC_PRESCALER_MASK) >> PDB_SC_PRESCALER_SHIFT))
+					   * s_au8Mult[(u32New & PDB_SC_MULT_MASK) >> PDB_SC_MULT_SHIFT];
+		sim_pdb_period();
+	}
+}
+
+/**
+* @brief            NVIC write: ISER/ICER set and clear the enables, ISPR/ICPR the pending bits.
+* @param[in]        pRegion - System control space.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_scs_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	S32_NVIC_Type *pNvic = SIM_NVIC();
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+	uint32_t u32Reg = 0U;
+	uint32_t u32Index = 0U;
+
+	(void)u32Old;
+	if ((u32Off < SIM_NVIC_OFF) || (u32Off >= (SIM_NVIC_OFF + 0x200U)))
+	{
+		return;										/* IABR, IP: plain */
+	}
+	u32Reg = (u32Off - SIM_NVIC_OFF) / 0x80U;
+	u32Index = ((u32Off - SIM_NVIC_OFF) % 0x80U) / 4U;
+	if (u32Index >= 4U)
+	{
+		return;
+	}
+
+	switch (u32Reg)
+	{
+		case 0U:
+			s_au32NvicEnabled[u32Index] |= u32New;
+			break;
+		case 1U:
+			s_au32NvicEnabled[u32Index] &= ~u32New;
+			break;
+		case 2U:
+			s_au32NvicPending[u32Index] |= u32New;
+			break;
+		default:
+			s_au32NvicPending[u32Index] &= ~u32New;
+			break;
+	}
+	pNvic->ISER[u32Index] = s_au32NvicEnabled[u32Index];	/* Both read the enable state */
+	pNvic->ICER[u32Index] = s_au32NvicEnabled[u32Index];
+	pNvic->ISPR[u32Index] = s_au32NvicPending[u32Index];
+	pNvic->ICPR[u32Index] = s_au32NvicPending[u32Index];
+}
+
+/**
+* @brief            eDMA write: CERQ/SERQ set and clear ERQ, CDNE clears DONE, CINT and INT clear INT.
+* @details          CEEI, SEEI, SSRT and CERR are ignored, the other registers and the TCDs are plain.
+* @param[in]        pRegion - eDMA registers.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_dma_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	DMA_Type *pDma = SIM_DMA();
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+	uint32_t u32Byte = 0U;
+	uint32_t u32Value = 0U;
+	uint32_t u32Mask = 0U;
+	uint32_t u32Ch = 0U;
+
+	if (SIM_DMA_INT_OFF == u32Off)
+	{
+		SIM_WORD(pRegion, u32Off) = u32Old & ~u32New;	/* Write 1 to clear */
+		return;
+	}
+	if ((SIM_DMA_CEEI_OFF != u32Off) && (SIM_DMA_CDNE_OFF != u32Off))
+	{
+		return;
+	}
+
+	SIM_WORD(pRegion, u32Off) = SIM_DMA_BYTES_NOP;
+	for (u32Byte = 0U; u32Byte < 4U; u32Byte++)
+	{
+		u32Value = (u32New >> (8U*u32Byte)) & 0xFFU;
+		if (0U != (u32Value & SIM_DMA_NOP))
+		{
+			continue;								/* Not written, or NOP */
+		}
+		u32Mask = (0U != (u32Value & SIM_DMA_ALL)) ? 0xFFFFU : (1UL << (u32Value & 0xFU));
+		switch (u32Off + u32Byte)
+		{
+			case (uint32_t)offsetof(DMA_Type, CERQ):
+				pDma->ERQ &= ~u32Mask;
+				break;
+			case (uint32_t)offsetof(DMA_Type, SERQ):
+				pDma->ERQ |= u32Mask;
+				break;
+			case (uint32_t)offsetof(DMA_Type, CDNE):
+				for (u32Ch = 0U; u32Ch < 16U; u32Ch++)
+				{
+					if (0U != (u32Mask & (1UL << u32Ch)))
+					{
+						pDma->TCD[u32Ch].CSR &= (uint16_t)~DMA_TCD_CSR_DONE_MASK;
+					}
+				}
+				break;
+			case (uint32_t)offsetof(DMA_Type, CINT):
+				pDma->INT &= ~u32Mask;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/**
+* @brief            eDMA bus address.
+* @param[in]        u32Addr - Address in a TCD.
+* @return           Model view of a register block, else the host address itself.
+*/
+static volatile uint8_t *sim_dma_addr(uint32_t u32Addr)
+{
+	sim_region_t *pRegion = sim_region_find(u32Addr);
+
+	if (NULL != pRegion)
+	{
+		return &pRegion->pu8Model[u32Addr - pRegion->uBase];
+	}
+	return (volatile uint8_t *)(uintptr_t)u32Addr;
+}
+
+/**
+* @brief            eDMA address after a transfer.
+* @param[in]        u32Addr - Address.
+* @param[in]        s16Offset - SOFF or DOFF.
+* @param[in]        u32Mod - SMOD or DMOD: only the low u32Mod bits change, 0: no modulo.
+* @return           Next address.
+*/
+static uint32_t sim_dma_next(uint32_t u32Addr, int16_t s16Offset, uint32_t u32Mod)
+{
+	uint32_t u32Next = u32Addr + (uint32_t)(int32_t)s16Offset;
+	uint32_t u32Mask = (0U == u32Mod) ? 0xFFFFFFFFU : ((1UL << u32Mod) - 1UL);
+
+	return (u32Addr & ~u32Mask) | (u32Next & u32Mask);
+}
+
+/**
+* @brief            eDMA minor loop of a channel.
+* @details          NBYTES in SSIZE transfers, a read of ADC0 R[n] clears COCO, then CITER counts down:
+*					INTHALF at BITER/2, at 0 the major loop ends (SLAST, DLASTSGA, CITER reload, DONE,
+*					INTMAJOR, DREQ).
+* @param[in]        u32Ch - Channel.
+* @return           void.
+*/
+static void sim_dma_minor(uint32_t u32Ch)
+{
+	DMA_Type *pDma = SIM_DMA();
+	uint32_t u32Attr = pDma->TCD[u32Ch].ATTR;
+	uint32_t u32Size = 1UL << ((u32Attr >> 8U) & 0x7U);
+	uint32_t u32Biter = pDma->TCD[u32Ch].BITER.ELINKNO;
+	uint32_t u32Citer = pDma->TCD[u32Ch].CITER.ELINKNO;
+	uint32_t u32Bytes = pDma->TCD[u32Ch].NBYTES.MLNO;
+	uint32_t u32Done = 0U;
+	uint32_t u32Word = 0U;
+	uint32_t u32Src = 0U;
+
+	if ((u32Size != (1UL << (u32Attr & 0x7U))) || (u32Size > 4U) || (0U == u32Bytes) || (0U != (u32Bytes % u32Size))
+		|| (0U == (u32Biter & DMA_TCD_BITER_ELINKNO_BITER_MASK)) || (0U == (u32Citer & DMA_TCD_CITER_ELINKNO_CITER_MASK))
+		|| (0U != ((u32Biter | u32Citer) & SIM_DMA_ITER_ELINK))
+		|| (0U != (pDma->TCD[u32Ch].CSR & (SIM_DMA_CSR_ESG | SIM_DMA_CSR_MAJORELINK))))
+	{
+		sim_fatal("eDMA channel %u: TCD setup not modelled (ATTR 0x%04X, NBYTES %u, CITER %u, BITER %u, CSR 0x%04X)",
+				  u32Ch, u32Attr, u32Bytes, u32Citer, u32Biter, (uint32_t)pDma->TCD[u32Ch].CSR);
+	}
+
+	for (u32Done = 0U; u32Done < u32Bytes; u32Done += u32Size)
+	{
+		u32Src = pDma->TCD[u32Ch].SADDR;
+		(void)memcpy(&u32Word, (const void *)(uintptr_t)sim_dma_addr(u32Src), u32Size);
+		(void)memcpy((void *)(uintptr_t)sim_dma_addr(pDma->TCD[u32Ch].DADDR), &u32Word, u32Size);
+		if ((u32Src >= (ADC0_BASE + SIM_R_OFF)) && (u32Src < (ADC0_BASE + SIM_R_END)))
+		{
+			SIM_ADC0()->SC1[(u32Src - ADC0_BASE - SIM_R_OFF) / 4U] &= ~ADC_SC1_COCO_MASK;	/* R[n] read */
+		}
+		pDma->TCD[u32Ch].SADDR = sim_dma_next(u32Src, (int16_t)pDma->TCD[u32Ch].SOFF, (u32Attr >> 11U) & 0x1FU);
+		pDma->TCD[u32Ch].DADDR = sim_dma_next(pDma->TCD[u32Ch].DADDR, (int16_t)pDma->TCD[u32Ch].DOFF, (u32Attr >> 3U) & 0x1FU);
+	}
+	s_Stats.u32DmaMinorLoops++;
+
+	u32Citer--;
+	if (0U != u32Citer)
+	{
+		pDma->TCD[u32Ch].CITER.ELINKNO = (uint16_t)u32Citer;
+		if ((0U != (pDma->TCD[u32Ch].CSR & DMA_TCD_CSR_INTHALF_MASK)) && (u32Citer == (u32Biter / 2U)))
+		{
+			pDma->INT |= 1UL << u32Ch;
+		}
+		return;
+	}
+	pDma->TCD[u32Ch].SADDR += pDma->TCD[u32Ch].SLAST;
+	pDma->TCD[u32Ch].DADDR += pDma->TCD[u32Ch].DLASTSGA;
+	pDma->TCD[u32Ch].CITER.ELINKNO = (uint16_t)u32Biter;
+	pDma->TCD[u32Ch].CSR |= DMA_TCD_CSR_DONE_MASK;
+	if (0U != (pDma->TCD[u32Ch].CSR & DMA_TCD_CSR_INTMAJOR_MASK))
+	{
+		pDma->INT |= 1UL << u32Ch;
+	}
+	if (0U != (pDma->TCD[u32Ch].CSR & DMA_TCD_CSR_DREQ_MASK))
+	{
+		pDma->ERQ &= ~(1UL << u32Ch);				/* DREQ: requests off after the major loop */
+	}
+}
+
+/**
+* @brief            eDMA requests.
+* @details          A channel with ERQ set, routed by the DMAMUX (clock on) to ADC0 runs one minor loop
+*					while SC2[DMAEN]=1 and a COCO flag is set. The minor loop must read the R[n] of that
+*					flag. Other request sources are not modelled.
+* @param        	void.
+* @return           void.
+*/
+static void sim_dma_service(void)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	DMA_Type *pDma = SIM_DMA();
+	uint32_t u32Ch = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Coco = 0U;
+
+	if (0U == (SIM_PCC()->PCCn[PCC_DMAMUX_INDEX] & PCC_PCCn_CGC_MASK))
+	{
+		return;
+	}
+	for (u32Ch = 0U; u32Ch < 16U; u32Ch++)
+	{
+		if ((DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(SIM_DMA_REQ_ADC0)) != SIM_DMAMUX()->CHCFG[u32Ch])
+		{
+			continue;
+		}
+		while ((0U != (pDma->ERQ & (1UL << u32Ch))) && (0U != (pAdc->SC2 & ADC_SC2_DMAEN_MASK)))
+		{
+			u32Coco = 0U;
+			for (u32Index = 0U; u32Index < 16U; u32Index++)
+			{
+				u32Coco += (pAdc->SC1[u32Index] >> ADC_SC1_COCO_SHIFT) & 1U;
+			}
+			if (0U == u32Coco)
+			{
+				break;
+			}
+			sim_dma_minor(u32Ch);
+			for (u32Index = 0U; u32Index < 16U; u32Index++)
+			{
+				u32Coco -= (pAdc->SC1[u32Index] >> ADC_SC1_COCO_SHIFT) & 1U;
+			}
+			if (0U == u32Coco)
+			{
+				sim_fatal("eDMA channel %u: ADC0 request, but the minor loop read no R[n] with COCO set", u32Ch);
+			}
+		}
+	}
+}
+
+/**
+* @brief            Interrupt source state.
+* @param[in]        u32Irq - Interrupt number.
+* @return           1 if the source requests the interrupt.
+*/
+static uint8_t sim_irq_active(uint32_t u32Irq)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+	uint32_t u32Index = 0U;
+
+	if (u32Irq < 16U)								/* eDMA channel */
+	{
+		return (0U != (SIM_DMA()->INT & (1UL << u32Irq))) ? 1U : 0U;
+	}
+	if (SIM_ADC_IRQ_ADC0 == u32Irq)
+	{
+		for (u32Index = 0U; u32Index < 16U; u32Index++)
+		{
+			if ((ADC_SC1_AIEN_MASK | ADC_SC1_COCO_MASK) == (pAdc->SC1[u32Index] & (ADC_SC1_AIEN_MASK | ADC_SC1_COCO_MASK)))
+			{
+				return 1U;
+			}
+		}
+	}
+	return 0U;
+}
+
+/**
+* @brief            Take the pending interrupts, lowest IP value first.
+* @param        	void.
+* @return           void.
+*/
+static void sim_irq_dispatch(void)
+{
+	S32_NVIC_Type *pNvic = SIM_NVIC();
+	uint32_t u32Irq = 0U;
+	int32_t s32Best = -1;
+	uint32_t u32BestPrio = 0U;
+	uint32_t u32Bit = 0U;
+
+	for (;;)
+	{
+		s32Best = -1;
+		for (u32Irq = 0U; u32Irq < SIM_IRQ_COUNT; u32Irq++)
+		{
+			u32Bit = 1UL << (u32Irq % 32U);
+			if ((NULL == s_apfIsr[u32Irq]) || (s_au8IrqCalls[u32Irq] > SIM_ADC_STORM_CALLS)
+				|| (0U == (s_au32NvicEnabled[u32Irq / 32U] & u32Bit))
+				|| ((0U == (s_au32NvicPending[u32Irq / 32U] & u32Bit)) && (0U == sim_irq_active(u32Irq))))
+			{
+				continue;
+			}
+			if ((s32Best < 0) || (pNvic->IP[u32Irq] < u32BestPrio))
+			{
+				s32Best = (int32_t)u32Irq;
+				u32BestPrio = pNvic->IP[u32Irq];
+			}
+		}
+		if (s32Best < 0)
+		{
+			return;
+		}
+
+		u32Irq = (uint32_t)s32Best;
+		s_au32NvicPending[u32Irq / 32U] &= ~(1UL << (u32Irq % 32U));
+		pNvic->ISPR[u32Irq / 32U] = s_au32NvicPending[u32Irq / 32U];
+		pNvic->ICPR[u32Irq / 32U] = s_au32NvicPending[u32Irq / 32U];
+		s_au8IrqCalls[u32Irq]++;
+		if (s_au8IrqCalls[u32Irq] > SIM_ADC_STORM_CALLS)
+		{
+			s_Stats.u32IrqStorms++;					/* Source never cleared: held off until time passes */
+			continue;
+		}
+		s_Stats.u32Irqs++;
+		s_apfIsr[u32Irq]();
+	}
+}
+
+/**
+* @brief            Handle one event due now: end of a result first, then the calibration, the PDB0
+*					period and the delayed pre-triggers.
+* @param        	void.
+* @return           1 if an event was handled.
+*/
+static uint8_t sim_event(void)
+{
+	PDB_Type *pPdb = SIM_PDB0();
+	uint8_t u8Pre = 0U;
+
+	if ((0U != s_Adc.u8Busy) && (s_Adc.u64Due <= s_u64Now))
+	{
+		sim_adc_done();
+		return 1U;
+	}
+	if ((0U != s_Adc.u8Cal) && (s_Adc.u64CalDue <= s_u64Now))
+	{
+		sim_cal_done();
+		return 1U;
+	}
+	if (0U == s_Pdb.u8Running)
+	{
+		return 0U;
+	}
+	for (u8Pre = 0U; u8Pre < 8U; u8Pre++)
+	{
+		if ((0U != (s_Pdb.u8Pending & (1U << u8Pre))) && (sim_pdb_due(u8Pre) <= s_u64Now))
+		{
+			s_Pdb.u8Pending &= (uint8_t)~(1U << u8Pre);
+			sim_pdb_fire(u8Pre);
+			return 1U;
+		}
+	}
+	if ((s_Pdb.u64Start + ((uint64_t)s_Pdb.u32Mod + 1U) * s_Pdb.u64Clock) <= s_u64Now)
+	{
+		if (0U == (pPdb->SC & PDB_SC_CONT_MASK))
+		{
+			s_Pdb.u8Running = 0U;					/* One shot */
+		}
+		else
+		{
+			s_Pdb.u64Start += ((uint64_t)s_Pdb.u32Mod + 1U) * s_Pdb.u64Clock;
+			sim_pdb_period();
+		}
+		return 1U;
+	}
+	return 0U;
+}
+
+/**
+* @brief            Event loop.
+* @param[in]        u64End - Model time to stop at.
+* @param[in]        u8Irqs - Take interrupts, 0 inside a trapped access.
+* @return           void.
+*/
+static void sim_run(uint64_t u64End, uint8_t u8Irqs)
+{
+	uint64_t u64Next = 0U;
+	uint8_t u8Pre = 0U;
+
+	for (;;)
+	{
+		while (0U != sim_event())
+		{
+		}
+		sim_dma_service();
+		if (0U != u8Irqs)
+		{
+			sim_irq_dispatch();
+		}
+		if (s_u64Now >= u64End)
+		{
+			return;
+		}
+
+		u64Next = u64End;							/* Next event */
+		if ((0U != s_Adc.u8Busy) && (s_Adc.u64Due < u64Next))
+		{
+			u64Next = s_Adc.u64Due;
+		}
+		if ((0U != s_Adc.u8Cal) && (s_Adc.u64CalDue < u64Next))
+		{
+			u64Next = s_Adc.u64CalDue;
+		}
+		if (0U != s_Pdb.u8Running)
+		{
+			for (u8Pre = 0U; u8Pre < 8U; u8Pre++)
+			{
+				if ((0U != (s_Pdb.u8Pending & (1U << u8Pre))) && (sim_pdb_due(u8Pre) < u64Next))
+				{
+					u64Next = sim_pdb_due(u8Pre);
+				}
+			}
+			if ((s_Pdb.u64Start + ((uint64_t)s_Pdb.u32Mod + 1U) * s_Pdb.u64Clock) < u64Next)
+			{
+				u64Next = s_Pdb.u64Start + ((uint64_t)s_Pdb.u32Mod + 1U) * s_Pdb.u64Clock;
+			}
+		}
+
+		s_u64Now = (u64Next > s_u64Now) ? u64Next : (s_u64Now + 1U);
+		(void)memset(s_au8IrqCalls, 0, sizeof(s_au8IrqCalls));
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Model reset.
+* @details          Maps the register blocks on the first call. Every call puts all registers to their
+*					reset values and clears time, inputs, noise, handlers and counters.
+* @param        	void.
+* @return           void.
+*/
+void sim_adc_init(void)
+{
+	uint32_t u32Index = 0U;
+
+	if (NULL == s_aRegion[0].pu8Model)
+	{
+		sim_map();
+	}
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		(void)memset((void *)s_aRegion[u32Index].pu8Model, 0, s_aRegion[u32Index].u32Size);
+	}
+
+	(void)memset(&s_Access, 0, sizeof(s_Access));
+	(void)memset(&s_Adc, 0, sizeof(s_Adc));
+	(void)memset(&s_Pdb, 0, sizeof(s_Pdb));
+	(void)memset(&s_Stats, 0, sizeof(s_Stats));
+	(void)memset(s_adInput, 0, sizeof(s_adInput));
+	(void)memset(s_apfIsr, 0, sizeof(s_apfIsr));
+	(void)memset(s_au32NvicEnabled, 0, sizeof(s_au32NvicEnabled));
+	(void)memset(s_au32NvicPending, 0, sizeof(s_au32NvicPending));
+	(void)memset(s_au8IrqCalls, 0, sizeof(s_au8IrqCalls));
+	SIM_WORD(&s_aRegion[3], SIM_DMA_CEEI_OFF) = SIM_DMA_BYTES_NOP;
+	SIM_WORD(&s_aRegion[3], SIM_DMA_CDNE_OFF) = SIM_DMA_BYTES_NOP;
+	for (u32Index = 0U; u32Index < 16U; u32Index++)
+	{
+		SIM_ADC0()->SC1[u32Index] = ADC_SC1_ADCH(SIM_ADCH_OFF);
+	}
+	SIM_ADC0()->CFG2 = ADC_CFG2_SMPLTS(12U);
+	SIM_PDB0()->MOD = 0xFFFFU;
+	s_Pdb.u32Mod = 0xFFFFU;
+	s_pfSource = NULL;
+	s_dNoise = 0.0;
+	s_u64Now = 0U;
+	s_u64Random = 0x2545F4914F6CDD1DULL;
+	s_u8GaussValid = 0U;
+}
+
+/**
+* @brief            Input level.
+* @param[in]        u8Chan - ADC0 input channel (ADCH, 0-30).
+* @param[in]        dMv - Input voltage in mV.
+* @return           void.
+*/
+void sim_adc_input(uint8_t u8Chan, double dMv)
+{
+	s_adInput[u8Chan & ADC_SC1_ADCH_MASK] = dMv;
+}
+
+/**
+* @brief            Input source.
+* @details          Called for each conversion with its end time, instead of the sim_adc_input() levels.
+* @param[in]        pfSource - Source, NULL: the sim_adc_input() levels.
+* @return           void.
+*/
+void sim_adc_source(sim_adc_source_t pfSource)
+{
+	s_pfSource = pfSource;
+}
+
+/**
+* @brief            Input noise.
+* @details          White Gaussian noise added to every conversion, before the quantisation.
+* @param[in]        dLsbRms - Noise in 12 bit LSB rms, 0: none.
+* @return           void.
+*/
+void sim_adc_noise(double dLsbRms)
+{
+	s_dNoise = dLsbRms;
+}
+
+/**
+* @brief            Interrupt handler.
+* @details          The handler runs while its source is active and its NVIC bit is enabled, lowest
+*					IP value first. Handlers run between model events only, never inside the caller.
+* @param[in]        u32Irq - Interrupt number, SIM_ADC_IRQ_xxx.
+* @param[in]        pfIsr - Handler, NULL: none.
+* @return           void.
+*/
+void sim_adc_irq(uint32_t u32Irq, sim_adc_isr_t pfIsr)
+{
+	s_apfIsr[u32Irq % SIM_IRQ_COUNT] = pfIsr;
+}
+
+/**
+* @brief            Run the model.
+* @details          Advances time by u64Ticks: PDB0 periods and pre-triggers, conversions, DMA
+*					transfers, interrupts.
+* @param[in]        u64Ticks - Ticks.
+* @return           void.
+*/
+void sim_adc_run(uint64_t u64Ticks)
+{
+	s_Adc.u32Polls = 0U;
+	sim_run(s_u64Now + u64Ticks, 1U);
+}
+
+/**
+* @brief            Model time.
+* @param        	void.
+* @return           Ticks since sim_adc_init().
+*/
+uint64_t sim_adc_now(void)
+{
+	return s_u64Now;
+}
+
+/**
+* @brief            Result time.
+* @details          From the PCC clock source, CFG1[ADIV], CFG2[SMPLTS] and the SC3 hardware averaging.
+* @param        	void.
+* @return           Ticks per result.
+*/
+uint64_t sim_adc_result_ticks(void)
+{
+	ADC_Type *pAdc = SIM_ADC0();
+
+	return (uint64_t)sim_samples(pAdc->SC3) * ((pAdc->CFG2 & ADC_CFG2_SMPLTS_MASK) + 1U + SIM_ADC_CONV_ADCK) * sim_adck_ticks();
+}
+
+/**
+* @brief            Model counters.
+* @param        	void.
+* @return           Counters.
+*/
+const sim_adc_stats_t *sim_adc_stats(void)
+{
+	return &s_Stats;
+}
+
+/**
+* @brief            Test check.
+* @param[in]        iOk - Result.
+* @param[in]        pcText - Condition.
+* @param[in]        pcFile - File.
+* @param[in]        iLine - Line.
+* @return           iOk.
+*/
+int sim_check(int iOk, const char *pcText, const char *pcFile, int iLine)
+{
+	s_u32Checks++;
+	if (0 == iOk)
+	{
+		s_u32Failed++;
+		(void)printf("%s:%d: check failed: %s\n", pcFile, iLine, pcText);
+	}
+	return iOk;
+}
+
+/**
+* @brief            Test result.
+* @details          Prints the number of checks and failures.
+* @param[in]        pcName - Test name.
+* @return           0 if all checks passed, else 1 (process exit code).
+*/
+int sim_check_result(const char *pcName)
+{
+	(void)printf("%s: %u checks, %u failed\n", pcName, s_u32Checks, s_u32Failed);
+	return (0U == s_u32Failed) ? 0 : 1;
+}
+
+
+/* END sim_adc */
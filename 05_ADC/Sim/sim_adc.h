@@ -0,0 +1,202 @@
+/**
+* @file				sim_adc.h
+* @brief            Header for sim_adc.c file
+* @details			Host model of ADC0, PDB0 and the peripherals around them, for running the unchanged
+*					05_ADC drivers in host tests. Register blocks sit at their S32K144 addresses (see
+*					device_registers.h); every driver access is trapped and gets the silicon side effects.
+*					Conversions take their time from the ADC clock, the sample time and the hardware
+*					averaging, and convert a test input voltage with offset, gain and white noise.
+*/
+
+#ifndef SIM_ADC_H
+#define SIM_ADC_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+#include "device_registers.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Input voltage of a channel in mV at a model time, replaces the sim_adc_input() levels */
+typedef double (*sim_adc_source_t)(uint8_t u8Chan, uint64_t u64Time);
+
+/* Interrupt handler */
+typedef void (*sim_adc_isr_t)(void);
+
+/* Model counters, cleared by sim_adc_init() */
+typedef struct
+{
+	uint32_t u32Accesses;				/* Trapped register accesses */
+	uint32_t u32Conversions;			/* Conversions, each one of a hardware average counted */
+	uint32_t u32Results;				/* Results written to R[n] */
+	uint32_t u32Overwritten;			/* Results written over one not read yet (COCO still set) */
+	uint32_t u32Aborted;				/* Conversions aborted by an SC1[n] write */
+	uint32_t u32Calibrations;			/* Calibration sequences completed */
+	uint32_t u32PdbTriggers;			/* PDB0 pre-triggers that started a conversion */
+	uint32_t u32PdbErrors;				/* PDB0 pre-triggers while ADC0 was converting (ERR set) */
+	uint32_t u32DmaMinorLoops;			/* eDMA minor loops (results moved from R[n]) */
+	uint32_t u32IrqStorms;				/* Interrupt still active after SIM_ADC_STORM_CALLS handler calls */
+	uint32_t u32Irqs;					/* Handler calls */
+	uint64_t u64PollTicks;				/* Model time spent in COCO and CAL poll loops */
+} sim_adc_stats_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Model time base: 240 MHz, a whole number of ticks per clock of 8, 40 and 48 MHz */
+#define SIM_ADC_TICK_HZ			(240000000U)
+#define SIM_ADC_US(us)			((uint64_t)(us) * (SIM_ADC_TICK_HZ / 1000000U))
+#define SIM_ADC_MS(ms)			((uint64_t)(ms) * (SIM_ADC_TICK_HZ / 1000U))
+
+/* Transfer function: 0-5000 mV (VREFH) to 0-4095, result = round(mV * 4095 / 5000) + errors */
+#define SIM_ADC_VREF_MV			(5000.0)
+#define SIM_ADC_FULL_SCALE		(4095.0)
+
+/* ADCK clocks of a conversion after the sample time (SMPLTS + 1): ADC_init() then takes 40 ADCK,
+   5 us at 8 MHz, the ADC_SCAN_CONV_NS of adc_scan.h */
+#define SIM_ADC_CONV_ADCK		(27U)
+
+/* Calibration: conversions of the sequence, each with the hardware averaging set in SC3 */
+#define SIM_ADC_CAL_CONV		(12U)
+
+/* Offset and gain error until the calibration result is in CLPx, G and OFS */
+#define SIM_ADC_UNCAL_OFFSET	(3.0)		/* LSB */
+#define SIM_ADC_UNCAL_GAIN		(-0.005)	/* Relative */
+
+/* Interrupt numbers of the modelled sources */
+#define SIM_ADC_IRQ_DMA(ch)		(ch)
+#define SIM_ADC_IRQ_ADC0		(39U)
+
+/* A handler that leaves its source active this often in a row is counted as an interrupt storm */
+#define SIM_ADC_STORM_CALLS		(64U)
+
+/* Test check: prints the failed condition, counted by sim_check_result() */
+#define SIM_CHECK(cond)			sim_check((cond) ? 1 : 0, #cond, __FILE__, __LINE__)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Model reset.
+* @details          Maps the register blocks on the first call. Every call puts all registers to their
+*					reset values and clears time, inputs, noise, handlers and counters.
+* @param        	void.
+* @return           void.
+*/
+void sim_adc_init(void);
+
+/**
+* @brief            Input level.
+* @param[in]        u8Chan - ADC0 input channel (ADCH, 0-30).
+* @param[in]        dMv - Input voltage in mV.
+* @return           void.
+*/
+void sim_adc_input(uint8_t u8Chan, double dMv);
+
+/**
+* @brief            Input source.
+* @details          Called for each conversion with its end time, instead of the sim_adc_input() levels.
+* @param[in]        pfSource - Source, NULL: the sim_adc_input() levels.
+* @return           void.
+*/
+void sim_adc_source(sim_adc_source_t pfSource);
+
+/**
+* @brief            Input noise.
+* @details          White Gaussian noise added to every conversion, before the quantisation.
+* @param[in]        dLsbRms - Noise in 12 bit LSB rms, 0: none.
+* @return           void.
+*/
+void sim_adc_noise(double dLsbRms);
+
+/**
+* @brief            Interrupt handler.
+* @details          The handler runs while its source is active and its NVIC bit is enabled, lowest
+*					IP value first. Handlers run between model events only, never inside the caller.
+* @param[in]        u32Irq - Interrupt number, SIM_ADC_IRQ_xxx.
+* @param[in]        pfIsr - Handler, NULL: none.
+* @return           void.
+*/
+void sim_adc_irq(uint32_t u32Irq, sim_adc_isr_t pfIsr);
+
+/**
+* @brief            Run the model.
+* @details          Advances time by u64Ticks: PDB0 periods and pre-triggers, conversions, DMA
+*					transfers, interrupts.
+* @param[in]        u64Ticks - Ticks.
+* @return           void.
+*/
+void sim_adc_run(uint64_t u64Ticks);
+
+/**
+* @brief            Model time.
+* @param        	void.
+* @return           Ticks since sim_adc_init().
+*/
+uint64_t sim_adc_now(void);
+
+/**
+* @brief            Result time.
+* @details          From the PCC clock source, CFG1[ADIV], CFG2[SMPLTS] and the SC3 hardware averaging.
+* @param        	void.
+* @return           Ticks per result.
+*/
+uint64_t sim_adc_result_ticks(void);
+
+/**
+* @brief            Model counters.
+* @param        	void.
+* @return           Counters.
+*/
+const sim_adc_stats_t *sim_adc_stats(void);
+
+/**
+* @brief            Test check.
+* @param[in]        iOk - Result.
+* @param[in]        pcText - Condition.
+* @param[in]        pcFile - File.
+* @param[in]        iLine - Line.
+* @return           iOk.
+*/
+int sim_check(int iOk, const char *pcText, const char *pcFile, int iLine);
+
+/**
+* @brief            Test result.
+* @details          Prints the number of checks and failures.
+* @param[in]        pcName - Test name.
+* @return           0 if all checks passed, else 1 (process exit code).
+*/
+int sim_check_result(const char *pcName);
+
+
+#endif	/* SIM_ADC_H */
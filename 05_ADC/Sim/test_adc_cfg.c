@@ -0,0 +1,269 @@
+/**
+* @file			test_adc_cfg.c
+* @brief		Host test of calibration, hardware averaging and oversampling (adc_cfg.c) on the
+*				register model
+* @details		Calibration: time of the sequence, offset and gain error before and after, and after a
+*				reset with the stored result restored. Resolution against result rate: each averaging
+*				and oversampling mode converts random levels with 1 LSB rms input noise, the rms error
+*				against the true level gives the 05_ADC.md table.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <math.h>
+#include <stdio.h>
+#include "sim_adc.h"
+#include "adc.h"
+#include "adc_cfg.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Resolution mode */
+typedef struct
+{
+	const char *pcName;
+	uint8_t u8Average;				/* Hardware averaging, 1: off */
+	uint8_t u8Bits;					/* Oversampled result bits, 12: no oversampling */
+	double dDocError;				/* 05_ADC.md error, 12 bit LSB rms */
+} test_mode_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Pot channel of main.c */
+#define TEST_CHAN				(12U)
+
+/* Input noise of the resolution table, 12 bit LSB rms */
+#define TEST_NOISE_LSB			(1.0)
+
+/* Results per mode: TEST_CONVERSIONS conversions, at least TEST_MIN_RESULTS, at most TEST_MAX_RESULTS */
+#define TEST_CONVERSIONS		(32768U)
+#define TEST_MIN_RESULTS		(256U)
+#define TEST_MAX_RESULTS		(2048U)
+
+/* Levels of the calibration check */
+#define TEST_CAL_LEVELS			(16U)
+
+/* rms error of the 12 bit step: ENOB = 12 - log2(error / TEST_STEP_RMS) */
+#define TEST_STEP_RMS			(0.29)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* 05_ADC.md resolution table */
+static const test_mode_t s_aModes[9] =
+{
+	{"No averaging", 1U, 12U, 1.04},
+	{"Hardware average 4", 4U, 12U, 0.60},
+	{"Hardware average 8", 8U, 12U, 0.47},
+	{"Hardware average 16", 16U, 12U, 0.38},
+	{"Hardware average 32", 32U, 12U, 0.34},
+	{"Oversample, 13 bit", 1U, 13U, 0.54},
+	{"Oversample, 14 bit", 1U, 14U, 0.27},
+	{"Oversample, 15 bit", 1U, 15U, 0.14},
+	{"Oversample, 16 bit", 1U, 16U, 0.07}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Random levels: xorshift32 */
+static uint32_t s_u32Random = 0x12345678U;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static double test_level(void);
+static void test_input(double dLsb);
+static uint16_t test_convert(void);
+static uint32_t test_cal_error(void);
+static void test_calibration(void);
+static void test_resolution(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Random level, 10-4085 LSB.
+*/
+static double test_level(void)
+{
+	s_u32Random ^= s_u32Random << 13U;
+	s_u32Random ^= s_u32Random >> 17U;
+	s_u32Random ^= s_u32Random << 5U;
+	return 10.0 + 4075.0 * (double)s_u32Random / 4294967296.0;
+}
+
+/**
+* @brief            Pot input at a level in 12 bit LSB.
+*/
+static void test_input(double dLsb)
+{
+	sim_adc_input(TEST_CHAN, dLsb * SIM_ADC_VREF_MV / SIM_ADC_FULL_SCALE);
+}
+
+/**
+* @brief            One software triggered result, as the main.c polling loop.
+*/
+static uint16_t test_convert(void)
+{
+	convertAdcChan(TEST_CHAN);
+	while (0U == adc_complete())
+	{
+	}
+	return (uint16_t)(ADC0->R[0] & ADC_R_D_MASK);
+}
+
+/**
+* @brief            Largest error in LSB over TEST_CAL_LEVELS levels in the middle of their code.
+*/
+static uint32_t test_cal_error(void)
+{
+	uint32_t u32Code = 0U;
+	uint32_t u32Result = 0U;
+	uint32_t u32Max = 0U;
+
+	for (u32Code = 100U; u32Code < 4096U; u32Code += 4000U / TEST_CAL_LEVELS)
+	{
+		test_input((double)u32Code);
+		u32Result = test_convert();
+		u32Result = (u32Result > u32Code) ? (u32Result - u32Code) : (u32Code - u32Result);
+		u32Max = (u32Result > u32Max) ? u32Result : u32Max;
+	}
+	return u32Max;
+}
+
+/**
+* @brief            Calibration time, error before and after, and after a reset with adc_cfg_restore().
+*/
+static void test_calibration(void)
+{
+	adc_cfg_cal_t cal;
+	adc_cfg_cal_t none = {0};
+	uint32_t u32Before = 0U;
+	uint32_t u32After = 0U;
+	uint32_t u32Reset = 0U;
+	uint32_t u32Restored = 0U;
+	uint64_t u64Start = 0U;
+	uint64_t u64Time = 0U;
+
+	sim_adc_init();
+	ADC_init();
+	u32Before = test_cal_error();
+	u64Start = sim_adc_now();
+	SIM_CHECK(1U == adc_cfg_calibrate(&cal));
+	u64Time = sim_adc_now() - u64Start;
+	SIM_CHECK(0U == ADC0->SC3);								/* SC3 of ADC_init() restored */
+	SIM_CHECK(0U == (ADC0->SC1[0] & ADC_SC1_COCO_MASK));
+	u32After = test_cal_error();
+	SIM_CHECK(1U == sim_adc_stats()->u32Calibrations);
+
+	sim_adc_init();											/* Reset: trim lost */
+	ADC_init();
+	u32Reset = test_cal_error();
+	SIM_CHECK(0U == adc_cfg_restore(&none));
+	SIM_CHECK(1U == adc_cfg_restore(&cal));
+	u32Restored = test_cal_error();
+
+	(void)printf("test_adc_cfg: calibration takes %u us; largest error %u LSB before, %u after, %u after a reset, "
+				 "%u restored\n",
+				 (uint32_t)(u64Time / SIM_ADC_US(1U)), u32Before, u32After, u32Reset, u32Restored);
+
+	SIM_CHECK((u64Time > SIM_ADC_MS(1U)) && (u64Time < SIM_ADC_MS(3U)));	/* About 2 ms (ADC_CFG_CAL_TIMEOUT) */
+	SIM_CHECK(u32Before > 1U);
+	SIM_CHECK(0U == u32After);
+	SIM_CHECK(u32Reset > 1U);
+	SIM_CHECK(0U == u32Restored);
+	SIM_CHECK(0U == sim_adc_stats()->u32Calibrations);			/* Restored, not run again */
+}
+
+/**
+* @brief            rms error and result rate of each mode, against the 05_ADC.md table.
+*/
+static void test_resolution(void)
+{
+	const test_mode_t *pMode = NULL;
+	adc_cfg_cal_t cal;
+	double dLevel = 0.0;
+	double dError = 0.0;
+	double dSum = 0.0;
+	uint32_t u32Result = 0U;
+	uint32_t u32Mode = 0U;
+	uint32_t u32Index = 0U;
+	uint64_t u64Start = 0U;
+	uint32_t u32Rate = 0U;
+	uint32_t u32Conversions = 0U;
+	uint32_t u32Results = 0U;
+
+	(void)printf("test_adc_cfg: %.1f LSB rms input noise, random levels\n", TEST_NOISE_LSB);
+	for (u32Mode = 0U; u32Mode < 9U; u32Mode++)
+	{
+		pMode = &s_aModes[u32Mode];
+		u32Conversions = (uint32_t)pMode->u8Average << (2U * (pMode->u8Bits - 12U));
+		u32Results = TEST_CONVERSIONS / u32Conversions;
+		u32Results = (u32Results < TEST_MIN_RESULTS) ? TEST_MIN_RESULTS
+				   : ((u32Results > TEST_MAX_RESULTS) ? TEST_MAX_RESULTS : u32Results);
+		sim_adc_init();
+		ADC_init();
+		SIM_CHECK(1U == adc_cfg_calibrate(&cal));
+		SIM_CHECK(1U == adc_cfg_average(pMode->u8Average));
+		sim_adc_noise(TEST_NOISE_LSB);
+
+		dSum = 0.0;
+		u64Start = sim_adc_now();
+		for (u32Index = 0U; u32Index < u32Results; u32Index++)
+		{
+			dLevel = test_level();
+			test_input(dLevel);
+			if (12U == pMode->u8Bits)
+			{
+				u32Result = test_convert();
+			}
+			else
+			{
+				SIM_CHECK(1U == adc_cfg_oversample(TEST_CHAN, pMode->u8Bits, &u32Result));
+			}
+			dError = (double)u32Result / (double)(1UL << (pMode->u8Bits - 12U)) - dLevel;
+			dSum += dError * dError;
+		}
+		dError = sqrt(dSum / u32Results);
+		u32Rate = (uint32_t)((uint64_t)u32Results * SIM_ADC_TICK_HZ / (sim_adc_now() - u64Start));
+
+		(void)printf("test_adc_cfg: %-20s %3u conversions per result: %.2f LSB rms, ENOB %.1f, %u results/s (%u results)\n",
+					 pMode->pcName, u32Conversions, dError, 12.0 - log2(dError / TEST_STEP_RMS), u32Rate, u32Results);
+
+		SIM_CHECK(fabs(dError - pMode->dDocError) <= (0.05 * pMode->dDocError + 0.005));
+		SIM_CHECK((200000U >> (2U * (pMode->u8Bits - 12U))) / pMode->u8Average == u32Rate);	/* 5 us per conversion */
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_calibration();
+	test_resolution();
+
+	return sim_check_result("test_adc_cfg");
+}
+
+
+/* END test_adc_cfg */
@@ -0,0 +1,213 @@
+/**
+* @file			test_adc_conv.c
+* @brief		Host test of the batch conversion (adc_conv.c)
+* @details		Every 12 bit result at both scales against the divide formula: the shift-add macro,
+*				adc_to_mv(), adc_conv_scalar() and the batch functions, whole array, at odd halfword
+*				alignment, odd counts and in place. test_adc_conv_dsp builds the same test with
+*				__ARM_FEATURE_DSP and the C equivalents of device_registers.h, so the packed kernel runs.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_adc.h"
+#include "adc.h"
+#include "adc_conv.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* 12 bit results */
+#define TEST_RESULTS			(ADC_CONV_FULL_SCALE + 1U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* All results in order, one spare halfword in front for odd alignment */
+static uint16_t s_au16Raw[TEST_RESULTS + 1U];
+
+/* Converted results, one spare halfword in front */
+static uint16_t s_au16Out[TEST_RESULTS + 1U];
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_fill(uint16_t *pu16Raw, uint32_t u32Count, uint32_t u32First);
+static uint32_t test_mismatch(const uint16_t *pu16Out, uint32_t u32Count, uint32_t u32First, uint32_t u32Scale);
+static void test_batch(uint32_t u32Scale, uint32_t u32Offset, uint32_t u32Count, uint8_t u8InPlace);
+static void test_formula(void);
+static void test_kernels(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Results u32First, u32First + 1, ... wrapping at 0xFFF.
+*/
+static void test_fill(uint16_t *pu16Raw, uint32_t u32Count, uint32_t u32First)
+{
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		pu16Raw[u32Index] = (uint16_t)((u32First + u32Index) % TEST_RESULTS);
+	}
+}
+
+/**
+* @brief            Outputs that differ from (u32Scale * result) / 0xFFF.
+*/
+static uint32_t test_mismatch(const uint16_t *pu16Out, uint32_t u32Count, uint32_t u32First, uint32_t u32Scale)
+{
+	uint32_t u32Index = 0U;
+	uint32_t u32Bad = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		if ((u32Scale * ((u32First + u32Index) % TEST_RESULTS) / ADC_CONV_FULL_SCALE) != pu16Out[u32Index])
+		{
+			u32Bad++;
+		}
+	}
+	return u32Bad;
+}
+
+/**
+* @brief            One batch call at a halfword offset, into s_au16Out or in place.
+*/
+static void test_batch(uint32_t u32Scale, uint32_t u32Offset, uint32_t u32Count, uint8_t u8InPlace)
+{
+	uint16_t *pu16Raw = &s_au16Raw[u32Offset];
+	uint16_t *pu16Out = (0U != u8InPlace) ? pu16Raw : &s_au16Out[u32Offset];
+	uint32_t u32First = (7U * u32Count + u32Offset) % TEST_RESULTS;
+
+	test_fill(pu16Raw, u32Count, u32First);
+	(void)memset(s_au16Out, 0xA5, sizeof(s_au16Out));
+	if (ADC_CONV_MV_SCALE == u32Scale)
+	{
+		adc_conv_mv(pu16Raw, pu16Out, u32Count);
+	}
+	else
+	{
+		adc_conv_q15(pu16Raw, (int16_t *)pu16Out, u32Count);
+	}
+	SIM_CHECK(0U == test_mismatch(pu16Out, u32Count, u32First, u32Scale));
+	if ((0U == u8InPlace) && ((u32Offset + u32Count) <= TEST_RESULTS))
+	{
+		SIM_CHECK(0xA5A5U == s_au16Out[u32Offset + u32Count]);		/* Nothing written past the end */
+	}
+}
+
+/**
+* @brief            Shift-add macro, adc_to_mv() and adc_conv_scalar() for every result at both scales.
+*/
+static void test_formula(void)
+{
+	static const uint32_t au32Scale[2] = {ADC_CONV_MV_SCALE, ADC_CONV_Q15_SCALE};
+	uint32_t au32Bad[2] = {0U, 0U};
+	uint32_t u32MvBad = 0U;
+	uint32_t u32ScalarBad = 0U;
+	uint32_t u32Scale = 0U;
+	uint32_t u32Raw = 0U;
+
+	for (u32Scale = 0U; u32Scale < 2U; u32Scale++)
+	{
+		for (u32Raw = 0U; u32Raw < TEST_RESULTS; u32Raw++)
+		{
+			if (ADC_CONV_DIV_FULL_SCALE(au32Scale[u32Scale] * u32Raw) != (au32Scale[u32Scale] * u32Raw / ADC_CONV_FULL_SCALE))
+			{
+				au32Bad[u32Scale]++;
+			}
+		}
+		test_fill(s_au16Raw, TEST_RESULTS, 0U);
+		adc_conv_scalar(s_au16Raw, s_au16Out, TEST_RESULTS, au32Scale[u32Scale]);
+		u32ScalarBad += test_mismatch(s_au16Out, TEST_RESULTS, 0U, au32Scale[u32Scale]);
+	}
+	for (u32Raw = 0U; u32Raw < TEST_RESULTS; u32Raw++)
+	{
+		if (adc_to_mv((uint16_t)u32Raw) != (ADC_CONV_MV_SCALE * u32Raw / ADC_CONV_FULL_SCALE))
+		{
+			u32MvBad++;
+		}
+	}
+
+	(void)printf("test_adc_conv: %u results against (scale * result) / 0xFFF: %u mismatches at 5000, %u at 32767, "
+				 "%u in adc_to_mv(), %u in adc_conv_scalar()\n",
+				 TEST_RESULTS, au32Bad[0], au32Bad[1], u32MvBad, u32ScalarBad);
+
+	SIM_CHECK(0U == au32Bad[0]);
+	SIM_CHECK(0U == au32Bad[1]);
+	SIM_CHECK(0U == u32MvBad);
+	SIM_CHECK(0U == u32ScalarBad);
+}
+
+/**
+* @brief            adc_conv_mv() and adc_conv_q15(): whole range, odd alignment, odd counts, in place.
+*/
+static void test_kernels(void)
+{
+	static const uint32_t au32Count[5] = {TEST_RESULTS, TEST_RESULTS - 1U, 1U, 3U, 0U};
+	uint32_t u32Batches = 0U;
+	uint32_t u32Count = 0U;
+	uint32_t u32Offset = 0U;
+	uint8_t u8InPlace = 0U;
+
+	(void)printf("test_adc_conv: %s kernel (ADC_CONV_SIMD %u)\n", (1U == ADC_CONV_SIMD) ? "packed" : "scalar", ADC_CONV_SIMD);
+	for (u32Count = 0U; u32Count < 5U; u32Count++)
+	{
+		for (u32Offset = 0U; u32Offset < 2U; u32Offset++)
+		{
+			for (u8InPlace = 0U; u8InPlace < 2U; u8InPlace++)
+			{
+				if ((au32Count[u32Count] + u32Offset) > (TEST_RESULTS + 1U))
+				{
+					continue;
+				}
+				test_batch(ADC_CONV_MV_SCALE, u32Offset, au32Count[u32Count], u8InPlace);
+				test_batch(ADC_CONV_Q15_SCALE, u32Offset, au32Count[u32Count], u8InPlace);
+				u32Batches += 2U;
+			}
+		}
+	}
+	(void)printf("test_adc_conv: adc_conv_mv(), adc_conv_q15(): %u batches of 0-%u results at even and odd "
+				 "alignment, in place and not\n", u32Batches, TEST_RESULTS);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_formula();
+	test_kernels();
+
+	return sim_check_result("test_adc_conv");
+}
+
+
+/* END test_adc_conv */
@@ -0,0 +1,303 @@
+/**
+* @file			test_adc_dma.c
+* @brief		Host test of the eDMA acquisition (adc_dma.c) on the register model
+* @details		ADC0 set up by ADC_init() and calibrated, then switched to continuous conversions into a
+*				ping-pong buffer. The input is a ramp one code per conversion, so every lost or doubled
+*				sample shows up as a step other than 1. The benchmark reports the handoff cost per
+*				second: interrupts, register accesses in the interrupt, and the core load at the
+*				60 clocks per interrupt of 05_ADC.md.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include "sim_adc.h"
+#include "adc.h"
+#include "adc_cfg.h"
+#include "adc_dma.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Benchmark case */
+typedef struct
+{
+	uint32_t u32Rate;				/* Samples per s */
+	uint16_t u16Half;				/* Samples per half buffer */
+	uint8_t u8Pcs;					/* PCC ADC0 clock source */
+	uint16_t u16SampleTime;			/* ADCK */
+} test_case_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Pot channel of main.c */
+#define TEST_CHAN				(12U)
+
+/* Largest buffer of the benchmark */
+#define TEST_MAX_BUF			(2048U)
+
+/* Benchmark run */
+#define TEST_RUN_MS				(1000U)
+
+/* Core clocks of one DMA interrupt with entry and exit, without the callback (05_ADC.md) */
+#define TEST_ISR_CLOCKS			(60U)
+#define TEST_CORE_HZ			(80000000U)
+
+/* PCC ADC0 clock sources: SOSCDIV2 (8 MHz), SPLLDIV2 (40 MHz) */
+#define TEST_PCS_SOSCDIV2		(1U)
+#define TEST_PCS_SPLLDIV2		(6U)
+
+/* Overrun test: half buffer, DMA interrupt held off less than a half after the next one (no loss)
+   and more (the other half is written over) */
+#define TEST_HALF				(256U)
+#define TEST_LATE_SAMPLES		(TEST_HALF + TEST_HALF / 2U)
+#define TEST_LOST_SAMPLES		(2U * TEST_HALF + TEST_HALF / 2U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* 05_ADC.md DMA table */
+static const test_case_t s_aCases[3] =
+{
+	{100000U, 256U, TEST_PCS_SOSCDIV2, 80U - 27U},	/* 80 ADCK at 8 MHz */
+	{1000000U, 256U, TEST_PCS_SPLLDIV2, 13U},		/* 40 ADCK at 40 MHz */
+	{1000000U, 1024U, TEST_PCS_SPLLDIV2, 13U}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Ping-pong buffer, written by the DMA */
+static uint16_t s_au16Buf[TEST_MAX_BUF];
+
+/* Ticks per conversion of the ramp */
+static uint64_t s_u64Conv;
+
+/* Samples handed to the block callback: next expected code, samples, gaps, samples in the gaps */
+static int32_t s_s32Next;
+static uint32_t s_u32Received;
+static uint32_t s_u32Gaps;
+static uint32_t s_u32GapSamples;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static double test_ramp(uint8_t u8Chan, uint64_t u64Time);
+static void test_block(const uint16_t *pu16Samples, uint32_t u32Count);
+static void test_setup(uint8_t u8Pcs, uint16_t u16SampleTime, uint16_t u16Samples);
+static void test_run_until(uint32_t u32Loops);
+static void test_irq_off(uint32_t u32Samples);
+static void test_params(void);
+static void test_bench(void);
+static void test_overrun(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Ramp input: the code of each conversion is one above the one before.
+*/
+static double test_ramp(uint8_t u8Chan, uint64_t u64Time)
+{
+	return (double)((u64Time / s_u64Conv) % 4096U) * SIM_ADC_VREF_MV / SIM_ADC_FULL_SCALE;
+}
+
+/**
+* @brief            Block callback: count ramp gaps.
+*/
+static void test_block(const uint16_t *pu16Samples, uint32_t u32Count)
+{
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		if ((s_s32Next >= 0) && ((int32_t)pu16Samples[u32Index] != s_s32Next))
+		{
+			s_u32Gaps++;
+			s_u32GapSamples += ((uint32_t)pu16Samples[u32Index] - (uint32_t)s_s32Next) % 4096U;
+		}
+		s_s32Next = (int32_t)((pu16Samples[u32Index] + 1U) % 4096U);
+		s_u32Received++;
+	}
+}
+
+/**
+* @brief            ADC0 as in main(), calibrated, clocked from u8Pcs, DMA into u16Samples.
+*/
+static void test_setup(uint8_t u8Pcs, uint16_t u16SampleTime, uint16_t u16Samples)
+{
+	adc_cfg_cal_t cal;
+
+	sim_adc_init();
+	ADC_init();
+	PCC->PCCn[PCC_ADC0_INDEX] = 0U;								/* Disable clock to change PCS */
+	PCC->PCCn[PCC_ADC0_INDEX] = PCC_PCCn_PCS(u8Pcs) | PCC_PCCn_CGC_MASK;
+	SIM_CHECK(1U == adc_cfg_sample_time(u16SampleTime));
+	SIM_CHECK(1U == adc_cfg_calibrate(&cal));
+	s_u64Conv = sim_adc_result_ticks();
+	sim_adc_source(test_ramp);
+	SIM_CHECK(1U == adc_dma_init(s_au16Buf, u16Samples, test_block));
+	sim_adc_irq(SIM_ADC_IRQ_DMA(ADC_DMA_CH), adc_dma_isr);
+
+	s_s32Next = -1;
+	s_u32Received = 0U;
+	s_u32Gaps = 0U;
+	s_u32GapSamples = 0U;
+}
+
+/**
+* @brief            Run in 1 us steps until the DMA has moved u32Loops more samples.
+*/
+static void test_run_until(uint32_t u32Loops)
+{
+	uint32_t u32Start = sim_adc_stats()->u32DmaMinorLoops;
+
+	while ((sim_adc_stats()->u32DmaMinorLoops - u32Start) < u32Loops)
+	{
+		sim_adc_run(SIM_ADC_US(1U));
+	}
+}
+
+/**
+* @brief            Disable the DMA interrupt right after an interrupt for u32Samples samples.
+*/
+static void test_irq_off(uint32_t u32Samples)
+{
+	uint32_t u32Blocks = AdcDmaStats.u32Blocks;
+
+	while (u32Blocks == AdcDmaStats.u32Blocks)
+	{
+		sim_adc_run(SIM_ADC_US(1U));
+	}
+	u32Blocks = AdcDmaStats.u32Blocks;
+	S32_NVIC->ICER[0] = 1UL << ADC_DMA_CH;
+	test_run_until(u32Samples);
+	SIM_CHECK(u32Blocks == AdcDmaStats.u32Blocks);
+	S32_NVIC->ISER[0] = 1UL << ADC_DMA_CH;
+	test_run_until(2U * TEST_HALF);
+}
+
+/**
+* @brief            Buffer sizes adc_dma_init() must refuse, without touching ADC0 or the eDMA.
+*/
+static void test_params(void)
+{
+	uint32_t u32Accesses = 0U;
+
+	sim_adc_init();
+	ADC_init();
+	u32Accesses = sim_adc_stats()->u32Accesses;
+	SIM_CHECK(0U == adc_dma_init(s_au16Buf, 0U, test_block));
+	SIM_CHECK(0U == adc_dma_init(s_au16Buf, 1U, test_block));
+	SIM_CHECK(0U == adc_dma_init(s_au16Buf, 255U, test_block));
+	SIM_CHECK(0U == adc_dma_init(s_au16Buf, ADC_DMA_MAX_SAMPLES + 1U, test_block));
+	SIM_CHECK(0U == adc_dma_init(s_au16Buf, ADC_DMA_MAX_SAMPLES + 2U, test_block));
+	SIM_CHECK(u32Accesses == sim_adc_stats()->u32Accesses);
+	SIM_CHECK(1U == adc_dma_init(s_au16Buf, 2U, test_block));
+	SIM_CHECK(2U == DMA->TCD[ADC_DMA_CH].BITER.ELINKNO);
+}
+
+/**
+* @brief            Handoff cost at 100 ksps and 1 Msps: every sample in order, one interrupt per half.
+*/
+static void test_bench(void)
+{
+	const test_case_t *pCase = NULL;
+	uint32_t u32Case = 0U;
+	uint32_t u32Accesses = 0U;
+	uint32_t u32Irqs = 0U;
+	uint32_t u32Loops = 0U;
+	uint32_t u32Rate = 0U;
+
+	for (u32Case = 0U; u32Case < 3U; u32Case++)
+	{
+		pCase = &s_aCases[u32Case];
+		test_setup(pCase->u8Pcs, pCase->u16SampleTime, 2U * pCase->u16Half);
+		SIM_CHECK((SIM_ADC_TICK_HZ / pCase->u32Rate) == s_u64Conv);
+		adc_dma_start(TEST_CHAN);
+		u32Accesses = sim_adc_stats()->u32Accesses;
+		sim_adc_run(SIM_ADC_MS(TEST_RUN_MS));
+		u32Accesses = sim_adc_stats()->u32Accesses - u32Accesses;	/* Thread code idle: interrupt only */
+		adc_dma_stop();
+		u32Irqs = sim_adc_stats()->u32Irqs;
+		u32Loops = sim_adc_stats()->u32DmaMinorLoops;
+		u32Rate = (uint32_t)((uint64_t)u32Irqs * 1000U / TEST_RUN_MS);
+
+		(void)printf("test_adc_dma: %u samples/s, half buffer %u: %u interrupts/s, %u samples per interrupt, "
+					 "%u register accesses per interrupt, load %u.%03u %% at %u clocks per interrupt\n",
+					 (uint32_t)((uint64_t)u32Loops * 1000U / TEST_RUN_MS), pCase->u16Half, u32Rate,
+					 s_u32Received / u32Irqs, u32Accesses / u32Irqs,
+					 (uint32_t)((uint64_t)u32Rate * TEST_ISR_CLOCKS * 100U / TEST_CORE_HZ),
+					 (uint32_t)((uint64_t)u32Rate * TEST_ISR_CLOCKS * 100000U / TEST_CORE_HZ % 1000U), TEST_ISR_CLOCKS);
+
+		SIM_CHECK((pCase->u32Rate * TEST_RUN_MS / 1000U) == u32Loops);		/* Every result moved by the DMA */
+		SIM_CHECK((u32Loops / pCase->u16Half) == AdcDmaStats.u32Blocks);	/* Half and major loop interrupts */
+		SIM_CHECK(AdcDmaStats.u32Blocks == u32Irqs);
+		SIM_CHECK(((uint32_t)pCase->u16Half * AdcDmaStats.u32Blocks) == s_u32Received);
+		SIM_CHECK(0U == AdcDmaStats.u32Overruns);
+		SIM_CHECK(0U == s_u32Gaps);
+		SIM_CHECK(0U == sim_adc_stats()->u32Overwritten);
+		SIM_CHECK(0U == sim_adc_stats()->u32IrqStorms);
+		SIM_CHECK(((uint64_t)u32Rate * TEST_ISR_CLOCKS * 100U) < ((uint64_t)TEST_CORE_HZ / 2U));	/* Under 0.5 % */
+	}
+}
+
+/**
+* @brief            Late DMA interrupt: the position tells the completed half until the other half is
+*					written over, then one overrun is counted and one half is lost.
+*/
+static void test_overrun(void)
+{
+	test_setup(TEST_PCS_SPLLDIV2, 13U, 2U * TEST_HALF);
+	adc_dma_start(TEST_CHAN);
+	test_run_until(2U * TEST_HALF);
+	test_irq_off(TEST_LATE_SAMPLES);
+
+	(void)printf("test_adc_dma: DMA interrupt off for %u samples: %u overruns, %u samples lost\n",
+				 TEST_LATE_SAMPLES, AdcDmaStats.u32Overruns, s_u32GapSamples);
+
+	SIM_CHECK(0U == AdcDmaStats.u32Overruns);
+	SIM_CHECK(0U == s_u32Gaps);
+
+	test_irq_off(TEST_LOST_SAMPLES);
+	adc_dma_stop();
+
+	(void)printf("test_adc_dma: DMA interrupt off for %u samples: %u overruns, %u samples lost\n",
+				 TEST_LOST_SAMPLES, AdcDmaStats.u32Overruns, s_u32GapSamples);
+
+	SIM_CHECK(1U == AdcDmaStats.u32Overruns);
+	SIM_CHECK(1U == s_u32Gaps);
+	SIM_CHECK(TEST_HALF == s_u32GapSamples);							/* The half written over */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_params();
+	test_bench();
+	test_overrun();
+
+	return sim_check_result("test_adc_dma");
+}
+
+
+/* END test_adc_dma */
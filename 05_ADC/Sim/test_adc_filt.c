@@ -0,0 +1,317 @@
+/**
+* @file			test_adc_filt.c
+* @brief		Host test of the Q15 filters (adc_filt.c) against a float reference
+* @details		The FILT_BENCH_MODE input and coefficients of main.c: a ramp plus noise through the
+*				16 tap FIR, the 50 Hz biquad and the 16 sample moving average, each against a double
+*				reference with the same coefficients. The pot filter of scan mode with Q31 and with
+*				Q15 feedback state. Block after block must give the same output as one block.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sim_adc.h"
+#include "adc_filt.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Samples per run (CONV_BENCH_SAMPLES of main.c) */
+#define TEST_SAMPLES			(1024U)
+
+/* Pot filter run: 10 s at SCAN_RATE_HZ */
+#define TEST_POT_SAMPLES		(10000U)
+
+/* Moving average window (POT_AVG_LENGTH of main.c) */
+#define TEST_AVG_LENGTH			(16U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* 16 tap low-pass FIR, 0.1 fs (Hamming window), Q15, symmetric (main.c) */
+static const int16_t s_ai16Fir[16] = {-114, -159, -139, 291, 1450, 3284, 5246, 6525, 6525, 5246, 3284, 1450, 291, -139, -159, -114};
+
+/* 50 Hz 2nd order Butterworth low-pass at 1 kHz, b0 b1 b2 a1 a2 in Q14 (main.c) */
+static const int16_t s_ai16Biquad[5] = {329, 658, 329, 25576, -10508};
+
+/* Pot filter: 20 Hz 2nd order Butterworth low-pass at 1 kHz, b0 b1 b2 a1 a2 in Q14 (main.c) */
+static const int16_t s_ai16PotBiquad[5] = {59, 119, 59, 29863, -13716};
+
+/* Block sizes of the block after block check, repeated */
+static const uint32_t s_au32Blocks[6] = {1U, 7U, 64U, 3U, 256U, 2U};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Input, Q15 output, float reference */
+static int16_t s_ai16In[TEST_POT_SAMPLES];
+static int16_t s_ai16Out[TEST_POT_SAMPLES];
+static int16_t s_ai16Block[TEST_POT_SAMPLES];
+static double s_adRef[TEST_POT_SAMPLES];
+
+/* Stage state */
+static int16_t s_ai16FirState[32];
+static int32_t s_ai32BiquadState[4];
+static int16_t s_ai16History[TEST_AVG_LENGTH];
+static adc_filt_fir_t s_Fir;
+static adc_filt_biquad_t s_Biquad;
+static adc_filt_movavg_t s_Avg;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_ramp(void);
+static void test_stage_init(uint32_t u32Stage, const int16_t *pi16Biquad);
+static void test_stage_run(uint32_t u32Stage, int16_t *pi16Data, uint32_t u32Count);
+static void test_reference(uint32_t u32Stage, const int16_t *pi16Biquad, uint32_t u32Count);
+static double test_max_error(const int16_t *pi16Out, uint32_t u32Count);
+static uint32_t test_blocks(uint32_t u32Stage, const int16_t *pi16Biquad, uint32_t u32Count);
+static void test_stages(void);
+static void test_pot(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Ramp plus noise, like a pot being turned (filt_bench() of main.c).
+*/
+static void test_ramp(void)
+{
+	uint32_t u32Seed = 1U;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < TEST_SAMPLES; u32Index++)
+	{
+		u32Seed = (u32Seed * 1664525U) + 1013904223U;
+		s_ai16In[u32Index] = (int16_t)((u32Index * 24U) + ((u32Seed >> 20U) & 0x7FFU));
+	}
+}
+
+/**
+* @brief            Stage u32Stage (ADC_FILT_FIR / ADC_FILT_BIQUAD / ADC_FILT_MOVAVG) with clear state.
+*/
+static void test_stage_init(uint32_t u32Stage, const int16_t *pi16Biquad)
+{
+	if (ADC_FILT_FIR == u32Stage)
+	{
+		adc_filt_fir_init(&s_Fir, s_ai16Fir, 16U, s_ai16FirState);
+	}
+	else if (ADC_FILT_BIQUAD == u32Stage)
+	{
+		adc_filt_biquad_init(&s_Biquad, pi16Biquad, 1U, 1U, s_ai32BiquadState);
+	}
+	else
+	{
+		SIM_CHECK(1U == adc_filt_movavg_init(&s_Avg, s_ai16History, TEST_AVG_LENGTH));
+	}
+}
+
+/**
+* @brief            One block through stage u32Stage, in place.
+*/
+static void test_stage_run(uint32_t u32Stage, int16_t *pi16Data, uint32_t u32Count)
+{
+	const adc_filt_stage_t aStage[1] =
+	{
+		{(uint8_t)u32Stage, (ADC_FILT_FIR == u32Stage) ? (void *)&s_Fir
+						  : ((ADC_FILT_BIQUAD == u32Stage) ? (void *)&s_Biquad : (void *)&s_Avg)}
+	};
+
+	adc_filt_run(aStage, 1U, pi16Data, u32Count);
+}
+
+/**
+* @brief            Double reference of stage u32Stage over s_ai16In, same coefficients, into s_adRef.
+*/
+static void test_reference(uint32_t u32Stage, const int16_t *pi16Biquad, uint32_t u32Count)
+{
+	double dX1 = 0.0, dX2 = 0.0, dY1 = 0.0, dY2 = 0.0;
+	double dAcc = 0.0;
+	uint32_t u32Index = 0U;
+	uint32_t u32Tap = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		dAcc = 0.0;
+		if (ADC_FILT_FIR == u32Stage)
+		{
+			for (u32Tap = 0U; (u32Tap < 16U) && (u32Tap <= u32Index); u32Tap++)
+			{
+				dAcc += (double)s_ai16Fir[15U - u32Tap] * (double)s_ai16In[u32Index - u32Tap];
+			}
+			dAcc /= 32768.0;
+		}
+		else if (ADC_FILT_BIQUAD == u32Stage)
+		{
+			dAcc = ((double)pi16Biquad[0] * (double)s_ai16In[u32Index] + (double)pi16Biquad[1] * dX1
+				 + (double)pi16Biquad[2] * dX2 + (double)pi16Biquad[3] * dY1 + (double)pi16Biquad[4] * dY2) / 16384.0;
+			dX2 = dX1;
+			dX1 = (double)s_ai16In[u32Index];
+			dY2 = dY1;
+			dY1 = dAcc;
+		}
+		else
+		{
+			for (u32Tap = 0U; (u32Tap < TEST_AVG_LENGTH) && (u32Tap <= u32Index); u32Tap++)
+			{
+				dAcc += (double)s_ai16In[u32Index - u32Tap];
+			}
+			dAcc /= (double)TEST_AVG_LENGTH;
+		}
+		s_adRef[u32Index] = dAcc;
+	}
+}
+
+/**
+* @brief            Largest difference of a Q15 output from s_adRef, in LSB.
+*/
+static double test_max_error(const int16_t *pi16Out, uint32_t u32Count)
+{
+	double dMax = 0.0;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		dMax = fmax(dMax, fabs((double)pi16Out[u32Index] - s_adRef[u32Index]));
+	}
+	return dMax;
+}
+
+/**
+* @brief            s_ai16In through stage u32Stage in blocks of s_au32Blocks sizes.
+* @return           Samples that differ from s_ai16Out, the same input as one block.
+*/
+static uint32_t test_blocks(uint32_t u32Stage, const int16_t *pi16Biquad, uint32_t u32Count)
+{
+	uint32_t u32Done = 0U;
+	uint32_t u32Size = 0U;
+	uint32_t u32Block = 0U;
+	uint32_t u32Bad = 0U;
+
+	(void)memcpy(s_ai16Block, s_ai16In, u32Count * sizeof(int16_t));
+	test_stage_init(u32Stage, pi16Biquad);
+	while (u32Done < u32Count)
+	{
+		u32Size = s_au32Blocks[u32Block % 6U];
+		u32Size = ((u32Done + u32Size) > u32Count) ? (u32Count - u32Done) : u32Size;
+		test_stage_run(u32Stage, &s_ai16Block[u32Done], u32Size);
+		u32Done += u32Size;
+		u32Block++;
+	}
+	for (u32Done = 0U; u32Done < u32Count; u32Done++)
+	{
+		u32Bad += (s_ai16Block[u32Done] != s_ai16Out[u32Done]) ? 1U : 0U;
+	}
+	return u32Bad;
+}
+
+/**
+* @brief            FIR, biquad and moving average of filt_bench() against the float reference.
+*/
+static void test_stages(void)
+{
+	static const char * const apcName[3] = {"FIR, 16 taps", "Biquad, 1 section", "Moving average, 16"};
+	static const double adDocError[3] = {0.5, 0.76, 0.5};		/* 05_ADC.md, Q15 LSB */
+	double dError = 0.0;
+	uint32_t u32Bad = 0U;
+	uint32_t u32Stage = 0U;
+
+	test_ramp();
+	(void)printf("test_adc_filt: %s FIR taps (ADC_FILT_SIMD %u), ramp plus noise, %u samples\n",
+				 (1U == ADC_FILT_SIMD) ? "SMLAD" : "C", ADC_FILT_SIMD, TEST_SAMPLES);
+	for (u32Stage = 0U; u32Stage < 3U; u32Stage++)
+	{
+		(void)memcpy(s_ai16Out, s_ai16In, TEST_SAMPLES * sizeof(int16_t));
+		test_stage_init(u32Stage, s_ai16Biquad);
+		test_stage_run(u32Stage, s_ai16Out, TEST_SAMPLES);
+		test_reference(u32Stage, s_ai16Biquad, TEST_SAMPLES);
+		dError = test_max_error(s_ai16Out, TEST_SAMPLES);
+		u32Bad = test_blocks(u32Stage, s_ai16Biquad, TEST_SAMPLES);
+
+		(void)printf("test_adc_filt: %-18s max error %.2f LSB, %u samples differ when run in blocks\n",
+					 apcName[u32Stage], dError, u32Bad);
+
+		SIM_CHECK(dError <= adDocError[u32Stage] + 0.005);
+		SIM_CHECK(0U == u32Bad);
+	}
+}
+
+/**
+* @brief            Pot filter of scan mode over a slow ramp plus noise: the Q31 feedback state of
+*					adc_filt_biquad() against Q15 state, y rounded to Q15 before it is fed back.
+*/
+static void test_pot(void)
+{
+	double dError = 0.0;
+	double dQ15Error = 0.0;
+	int32_t i32Y1 = 0, i32Y2 = 0, i32X1 = 0, i32X2 = 0;
+	int32_t i32Acc = 0;
+	uint32_t u32Seed = 1U;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < TEST_POT_SAMPLES; u32Index++)
+	{
+		u32Seed = (u32Seed * 1664525U) + 1013904223U;			/* 0-30000 in 10 s, 64 LSB of noise */
+		s_ai16In[u32Index] = (int16_t)((u32Index * 3U) + ((u32Seed >> 26U) & 0x3FU));
+	}
+	(void)memcpy(s_ai16Out, s_ai16In, TEST_POT_SAMPLES * sizeof(int16_t));
+	test_stage_init(ADC_FILT_BIQUAD, s_ai16PotBiquad);
+	test_stage_run(ADC_FILT_BIQUAD, s_ai16Out, TEST_POT_SAMPLES);
+	test_reference(ADC_FILT_BIQUAD, s_ai16PotBiquad, TEST_POT_SAMPLES);
+	dError = test_max_error(s_ai16Out, TEST_POT_SAMPLES);
+
+	for (u32Index = 0U; u32Index < TEST_POT_SAMPLES; u32Index++)
+	{
+		i32Acc = s_ai16PotBiquad[0] * s_ai16In[u32Index] + s_ai16PotBiquad[1] * i32X1 + s_ai16PotBiquad[2] * i32X2
+			   + s_ai16PotBiquad[3] * i32Y1 + s_ai16PotBiquad[4] * i32Y2;
+		i32X2 = i32X1;
+		i32X1 = s_ai16In[u32Index];
+		i32Y2 = i32Y1;
+		i32Y1 = (i32Acc + (1 << 13)) >> 14;
+		s_ai16Block[u32Index] = (int16_t)i32Y1;
+	}
+	dQ15Error = test_max_error(s_ai16Block, TEST_POT_SAMPLES);
+
+	(void)printf("test_adc_filt: pot filter, 20 Hz low-pass, %u samples: max error %.2f LSB with Q31 state, "
+				 "%.2f LSB with Q15 state\n", TEST_POT_SAMPLES, dError, dQ15Error);
+
+	SIM_CHECK(dError < 1.0);
+	SIM_CHECK(dQ15Error > 1.0);
+	SIM_CHECK(0U == test_blocks(ADC_FILT_BIQUAD, s_ai16PotBiquad, TEST_POT_SAMPLES));
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_stages();
+	test_pot();
+
+	return sim_check_result("test_adc_filt");
+}
+
+
+/* END test_adc_filt */
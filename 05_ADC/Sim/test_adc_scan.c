@@ -0,0 +1,271 @@
+/**
+* @file			test_adc_scan.c
+* @brief		Host test of the PDB0 scan sequencer (adc_scan.c) on the register model
+* @details		ADC0 set up by ADC_init() (SOSCDIV2, 8 MHz) and calibrated, each channel at a fixed
+*				level. PDB0 triggers the channel list every period; the ADC0 interrupt hands each
+*				sequence to the callback, which checks the results and the time between sequences.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include "sim_adc.h"
+#include "adc.h"
+#include "adc_cfg.h"
+#include "adc_scan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Run per case */
+#define TEST_RUN_MS				(100U)
+
+/* Fastest rate adc_scan_init() accepts for a list, at the hardware averaging set */
+#define TEST_MAX_RATE(n, avg)	(1000000000U / ((n) * (avg) * ADC_SCAN_CONV_NS))
+
+/* Result of channel n: codes well apart, levels in the middle of their code */
+#define TEST_CODE(n)			(100U + 500U * (n))
+
+/* PDB0 clock in model ticks, pre-trigger 0 delay in PDB0 clocks (ADC_SCAN_PDB_DLY0 of adc_scan.c) */
+#define TEST_PDB_TICKS			(SIM_ADC_TICK_HZ / ADC_SCAN_PDB_CLOCK_HZ)
+#define TEST_PDB_DLY0			(1U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Channel list: pot (ADC0_SE12) first, then the others in reverse order */
+static const uint8_t s_au8Channels[ADC_SCAN_MAX_CHANNELS] = {12U, 7U, 6U, 5U, 4U, 3U, 2U, 1U};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Sequences seen by the callback, results off their code, time of the first one and spacing */
+static uint32_t s_u32Sequences;
+static uint32_t s_u32Wrong;
+static uint64_t s_u64First;
+static uint64_t s_u64Last;
+static uint64_t s_u64MinGap;
+static uint64_t s_u64MaxGap;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_sequence(const uint16_t *pu16Results, uint8_t u8Count);
+static void test_setup(void);
+static uint64_t test_scan(uint8_t u8Count, uint32_t u32RateHz);
+static void test_clock(void);
+static void test_rates(void);
+static void test_limits(void);
+static void test_overlap(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Sequence callback: results and spacing.
+*/
+static void test_sequence(const uint16_t *pu16Results, uint8_t u8Count)
+{
+	uint64_t u64Now = sim_adc_now();
+	uint8_t u8Index = 0U;
+
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		if (TEST_CODE(u8Index) != pu16Results[u8Index])
+		{
+			s_u32Wrong++;
+		}
+	}
+	if (0U == s_u32Sequences)
+	{
+		s_u64First = u64Now;
+	}
+	else
+	{
+		s_u64MinGap = ((u64Now - s_u64Last) < s_u64MinGap) ? (u64Now - s_u64Last) : s_u64MinGap;
+		s_u64MaxGap = ((u64Now - s_u64Last) > s_u64MaxGap) ? (u64Now - s_u64Last) : s_u64MaxGap;
+	}
+	s_u64Last = u64Now;
+	s_u32Sequences++;
+}
+
+/**
+* @brief            ADC0 as in main(), calibrated, channel n of the list at TEST_CODE(n).
+*/
+static void test_setup(void)
+{
+	adc_cfg_cal_t cal;
+	uint8_t u8Index = 0U;
+
+	sim_adc_init();
+	ADC_init();
+	SIM_CHECK(1U == adc_cfg_calibrate(&cal));
+	for (u8Index = 0U; u8Index < ADC_SCAN_MAX_CHANNELS; u8Index++)
+	{
+		sim_adc_input(s_au8Channels[u8Index], (double)TEST_CODE(u8Index) * SIM_ADC_VREF_MV / SIM_ADC_FULL_SCALE);
+	}
+	sim_adc_irq(SIM_ADC_IRQ_ADC0, adc_scan_isr);
+
+	s_u32Sequences = 0U;
+	s_u32Wrong = 0U;
+	s_u64MinGap = UINT64_MAX;
+	s_u64MaxGap = 0U;
+}
+
+/**
+* @brief            Scan u8Count channels at u32RateHz for TEST_RUN_MS, then stop.
+* @return           Model time of the start.
+*/
+static uint64_t test_scan(uint8_t u8Count, uint32_t u32RateHz)
+{
+	uint64_t u64Start = 0U;
+
+	SIM_CHECK(1U == adc_scan_init(s_au8Channels, u8Count, u32RateHz, test_sequence));
+	u64Start = sim_adc_now();
+	adc_scan_start();
+	sim_adc_run(SIM_ADC_MS(TEST_RUN_MS));
+	adc_scan_stop();
+	sim_adc_run(SIM_ADC_MS(1U));
+	return u64Start;
+}
+
+/**
+* @brief            ADC_init(): SOSCDIV2 undivided, a 12 bit result takes ADC_SCAN_CONV_NS.
+*/
+static void test_clock(void)
+{
+	sim_adc_init();
+	ADC_init();
+
+	(void)printf("test_adc_scan: ADC_init(): %u ns per result\n",
+				 (uint32_t)(sim_adc_result_ticks() * 1000U / SIM_ADC_US(1U)));
+
+	SIM_CHECK((SIM_ADC_US(1U) * ADC_SCAN_CONV_NS / 1000U) == sim_adc_result_ticks());
+}
+
+/**
+* @brief            2 and 8 channels at 1 kHz and at the fastest rate: every sequence, one interrupt
+*					each, exact spacing, no sequence error.
+*/
+static void test_rates(void)
+{
+	static const uint8_t au8Count[2] = {2U, 8U};
+	uint32_t u32Rate = 0U;
+	uint64_t u64Start = 0U;
+	uint64_t u64Period = 0U;
+	uint16_t au16Read[ADC_SCAN_MAX_CHANNELS];
+	uint32_t u32Case = 0U;
+
+	for (u32Case = 0U; u32Case < 4U; u32Case++)
+	{
+		test_setup();
+		u32Rate = (0U == (u32Case % 2U)) ? 1000U : TEST_MAX_RATE(au8Count[u32Case / 2U], 1U);
+		u64Start = test_scan(au8Count[u32Case / 2U], u32Rate);
+		u64Period = SIM_ADC_TICK_HZ / u32Rate;
+
+		(void)printf("test_adc_scan: %u channels at %u Hz: %u sequences in %u ms, %u interrupts, first after %u ns, "
+					 "spacing %u-%u ns, %u sequence errors\n",
+					 au8Count[u32Case / 2U], u32Rate, s_u32Sequences, TEST_RUN_MS, sim_adc_stats()->u32Irqs,
+					 (uint32_t)((s_u64First - u64Start) * 1000U / SIM_ADC_US(1U)),
+					 (uint32_t)(s_u64MinGap * 1000U / SIM_ADC_US(1U)), (uint32_t)(s_u64MaxGap * 1000U / SIM_ADC_US(1U)),
+					 adc_scan_errors());
+
+		SIM_CHECK((u32Rate * TEST_RUN_MS / 1000U) == s_u32Sequences);
+		SIM_CHECK(s_u32Sequences == sim_adc_stats()->u32Irqs);
+		SIM_CHECK(0U == s_u32Wrong);
+		SIM_CHECK((u64Start + TEST_PDB_DLY0 * TEST_PDB_TICKS + au8Count[u32Case / 2U] * sim_adc_result_ticks()) == s_u64First);
+		SIM_CHECK((u64Period == s_u64MinGap) && (u64Period == s_u64MaxGap));
+		SIM_CHECK(0U == adc_scan_errors());
+		SIM_CHECK(0U == sim_adc_stats()->u32PdbErrors);
+		SIM_CHECK(0U == sim_adc_stats()->u32Overwritten);
+		SIM_CHECK(s_u32Sequences == adc_scan_read(au16Read));
+		SIM_CHECK((TEST_CODE(0U) == au16Read[0]) && (TEST_CODE(1U) == au16Read[1]));
+	}
+}
+
+/**
+* @brief            Lists and rates adc_scan_init() must reject, and the rate limit with averaging.
+*/
+static void test_limits(void)
+{
+	test_setup();
+	SIM_CHECK(0U == adc_scan_init(s_au8Channels, 8U, TEST_MAX_RATE(8U, 1U) + 1U, test_sequence));
+	SIM_CHECK(0U == adc_scan_init(s_au8Channels, 2U, 0U, test_sequence));
+	SIM_CHECK(0U == adc_scan_init(s_au8Channels, 0U, 1000U, test_sequence));
+	SIM_CHECK(0U == adc_scan_init(s_au8Channels, ADC_SCAN_MAX_CHANNELS + 1U, 1000U, test_sequence));
+	SIM_CHECK(0U == sim_adc_stats()->u32PdbTriggers);
+
+	SIM_CHECK(1U == adc_cfg_average(4U));
+	SIM_CHECK(0U == adc_scan_init(s_au8Channels, 2U, TEST_MAX_RATE(2U, 4U) + 1U, test_sequence));
+	(void)test_scan(2U, TEST_MAX_RATE(2U, 4U));
+
+	(void)printf("test_adc_scan: 2 channels, 4 sample averaging, at %u Hz: %u sequences, %u sequence errors\n",
+				 TEST_MAX_RATE(2U, 4U), s_u32Sequences, adc_scan_errors());
+
+	SIM_CHECK((TEST_MAX_RATE(2U, 4U) * TEST_RUN_MS / 1000U) == s_u32Sequences);
+	SIM_CHECK(0U == s_u32Wrong);
+	SIM_CHECK(0U == sim_adc_stats()->u32PdbErrors);
+}
+
+/**
+* @brief            Sample time raised after adc_scan_init(): the sequence outlasts the period, the next
+*					pre-trigger hits a busy ADC, PDB0 sets ERR and drops that sequence.
+*/
+static void test_overlap(void)
+{
+	uint32_t u32Rate = TEST_MAX_RATE(2U, 1U);
+
+	test_setup();
+	SIM_CHECK(1U == adc_scan_init(s_au8Channels, 2U, u32Rate, test_sequence));
+	SIM_CHECK(1U == adc_cfg_sample_time(20U));				/* 47 ADCK: 5.875 us per result */
+	adc_scan_start();
+	sim_adc_run(SIM_ADC_MS(TEST_RUN_MS));
+	adc_scan_stop();
+	sim_adc_run(SIM_ADC_MS(1U));
+
+	(void)printf("test_adc_scan: 2 channels at %u Hz, 5.875 us per result: %u sequences, %u sequence errors, "
+				 "%u pre-triggers dropped\n",
+				 u32Rate, s_u32Sequences, adc_scan_errors(), sim_adc_stats()->u32PdbErrors);
+
+	SIM_CHECK((s_u32Sequences + 1U) >= (u32Rate * TEST_RUN_MS / 2000U));		/* Every other period */
+	SIM_CHECK(s_u32Sequences <= (u32Rate * TEST_RUN_MS / 2000U + 1U));
+	SIM_CHECK((adc_scan_errors() + 1U) >= s_u32Sequences);
+	SIM_CHECK(adc_scan_errors() <= sim_adc_stats()->u32PdbErrors);
+	SIM_CHECK(0U == s_u32Wrong);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_clock();
+	test_rates();
+	test_limits();
+	test_overlap();
+
+	return sim_check_result("test_adc_scan");
+}
+
+
+/* END test_adc_scan */
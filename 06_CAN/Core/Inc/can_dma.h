@@ -0,0 +1,133 @@
+/**
+* @file				can_dma.h
+* @brief            Header for can_dma.c file
+*/
+
+#ifndef CAN_DMA_H
+#define CAN_DMA_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Frame as copied by the DMA from the RX FIFO output (MB0), raw msg buffer words */
+typedef struct
+{
+	uint32_t CS;				/* Word 0: IDHIT (31:23), SRR, IDE, RTR, DLC, TIME STAMP */
+	uint32_t ID;				/* Word 1: ID */
+	uint32_t DATA[2];			/* Words 2..3: payload, big-endian */
+} can_dma_frame_t;
+
+/* Called from the DMA interrupt with a completed half of the buffer. The frames stay valid until the
+   DMA wraps back onto them, i.e. for the time it takes to receive u32Count more frames */
+typedef void (*can_dma_block_t)(const can_dma_frame_t *pFrames, uint32_t u32Count);
+
+/* DMA statistics */
+typedef struct
+{
+	uint32_t u32Blocks;			/* Half buffers handed to the callback */
+	uint32_t u32Overruns;		/* Half buffers overwritten before the interrupt got to them */
+} can_dma_stats_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* eDMA channel of the RX FIFO, its interrupt is IRQ0 + channel */
+#define CAN_DMA_CH					(0U)
+
+/* DMAMUX request source: FlexCAN0 */
+#define CAN_DMA_REQ_FLEXCAN0		(54U)
+
+/* IRQ0-DMA ch0 priority: below IRQ81-CAN0, a block callback may run long */
+#define CAN_DMA_IRQ_PRIO			(0xAU)
+
+/* Bytes per frame, one DMA minor loop */
+#define CAN_DMA_FRAME_BYTES			(16U)
+
+/* Largest buffer: CITER holds 15 bits, and the count must be even */
+#define CAN_DMA_MAX_FRAMES			(32766U)
+
+/* Filter element index from the C/S word of a DMA frame */
+#define CAN_DMA_CS_IDHIT_MASK		(0xFF800000U)
+#define CAN_DMA_CS_IDHIT_SHIFT		(23U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* DMA statistics, written by the DMA interrupt */
+extern volatile can_dma_stats_t CanDmaStats;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            RX FIFO DMA Initialization.
+* @details          Function to set up eDMA channel CAN_DMA_CH as an endless circular copy of the FlexCAN0
+*                   RX FIFO into pBuf: one 16 byte minor loop per frame, a major loop over the whole buffer
+*                   that wraps back to its start, and interrupts at half and full buffer only. Call it before
+*                   FLEXCAN0_init_rx_fifo_dma(), so frames are taken from the first one on.
+* @param[out]       pBuf - Circular frame buffer.
+* @param[in]        u16Frames - Buffer size in frames, even (2-CAN_DMA_MAX_FRAMES).
+* @param[in]        pfBlock - Called with each completed half buffer.
+* @return           void.
+*/
+void can_dma_init(can_dma_frame_t *pBuf, uint16_t u16Frames, can_dma_block_t pfBlock);
+
+/**
+* @brief            DMA interrupt.
+* @details          Function to hand the half buffer the DMA has just left to the block callback.
+*                   Call it from DMA0_IRQHandler (channel CAN_DMA_CH).
+* @param        	void.
+* @return           void.
+*/
+void can_dma_isr(void);
+
+/**
+* @brief            Frames pending.
+* @details          Function to return how many frames the DMA has written to the half in progress,
+*                   for a caller that wants to look at them before the half is complete (e.g. on an idle bus).
+* @param        	void.
+* @return           Number of frames from the start of the current half.
+*/
+uint32_t can_dma_pending(void);
+
+/**
+* @brief            Decode DMA frame.
+* @details          Function to convert a raw DMA frame into a received frame. u8Code holds the index of the
+*                   filter element that accepted it, u8Mb is 0 (RX FIFO output), u64Timestamp is left 0.
+* @param[in]        pRaw - DMA frame.
+* @param[out]       pFrame - Received frame.
+* @return           void.
+*/
+void can_dma_decode(const can_dma_frame_t *pRaw, can_frame_t *pFrame);
+
+
+#endif	/* CAN_DMA_H */
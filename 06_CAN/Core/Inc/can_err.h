@@ -0,0 +1,139 @@
+/**
+* @file				can_err.h
+* @brief            Header for can_err.c file
+*/
+
+#ifndef CAN_ERR_H
+#define CAN_ERR_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+#include "can_time.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Called on every state change with the new CAN_ERR_xxx state, from the error interrupt or can_err_poll() */
+typedef void (*can_err_callback_t)(uint8_t u8State);
+
+/* Error state and counters, written by the error interrupt (state also by can_err_poll()) */
+typedef struct
+{
+	uint8_t u8State;				/* CAN_ERR_ACTIVE / WARNING / PASSIVE / BUS_OFF */
+	uint8_t u8Recovery;				/* CAN_ERR_RECOVER_AUTO or CAN_ERR_RECOVER_MANUAL */
+	uint32_t u32ErrorFrames;		/* Error interrupts (ESR1[ERRINT]) */
+	uint32_t u32ErrorOverruns;		/* Errors lost before ESR1 was read (ESR1[ERROVR]) */
+	uint32_t u32StuffErrors;		/* ESR1[STFERR] */
+	uint32_t u32FormErrors;			/* ESR1[FRMERR] */
+	uint32_t u32CrcErrors;			/* ESR1[CRCERR] */
+	uint32_t u32AckErrors;			/* ESR1[ACKERR] */
+	uint32_t u32BitErrors;			/* ESR1[BIT0ERR] / ESR1[BIT1ERR] */
+	uint32_t u32Warnings;			/* TX or RX error counter reached 96 (TWRNINT / RWRNINT) */
+	uint32_t u32BusOff;				/* Bus off events (BOFFINT) */
+	uint32_t u32Recoveries;			/* Bus off recoveries completed (BOFFDONEINT) */
+	uint32_t u32MbOverruns;			/* Receive MBs re-armed after an overrun */
+	uint64_t u64BusOffTime;			/* Timebase time of the last bus off */
+	uint64_t u64LastRecovery;		/* Bus off to error active of the last recovery, timebase ticks */
+	uint64_t u64MaxRecovery;		/* Longest recovery, timebase ticks */
+} can_err_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Fault confinement states */
+#define CAN_ERR_ACTIVE				(0U)	/* Error active, both error counters below 96 */
+#define CAN_ERR_WARNING				(1U)	/* Error active, an error counter at 96 or more */
+#define CAN_ERR_PASSIVE				(2U)	/* Error passive, an error counter above 127 */
+#define CAN_ERR_BUS_OFF				(3U)	/* Bus off, TX error counter above 255 */
+
+/* Bus off recovery */
+#define CAN_ERR_RECOVER_AUTO		(0U)	/* FlexCAN rejoins after 128 x 11 recessive bits (BOFFREC=0) */
+#define CAN_ERR_RECOVER_MANUAL		(1U)	/* Stays bus off until can_err_recover() (BOFFREC=1) */
+
+/* IRQ78-CAN0 ORed / IRQ79-CAN0 Error priority: same as IRQ81-CAN0 MB, the handlers share the timebase */
+#define CAN_ERR_IRQ_PRIO			(0x8U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* CAN0 error state and counters */
+extern volatile can_err_t CanErr;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Error handling Initialization.
+* @details          Function to clear the counters, select the bus off recovery and enable the bus off,
+*                   bus off done, warning and error interrupts of FLEXCAN0 (IRQ78, IRQ79). Call it after
+*                   FLEXCAN0 is initialized.
+* @param[in]        u8Recovery - CAN_ERR_RECOVER_AUTO or CAN_ERR_RECOVER_MANUAL.
+* @param[in]        pfCallback - State change callback, NULL for none.
+* @return           void.
+*/
+void can_err_init(uint8_t u8Recovery, can_err_callback_t pfCallback);
+
+/**
+* @brief            Error interrupt.
+* @details          Function to count and clear the ESR1 events and update the state. Call it from
+*                   CAN0_ORed_IRQHandler and CAN0_Error_IRQHandler.
+* @param        	void.
+* @return           void.
+*/
+void can_err_isr(void);
+
+/**
+* @brief            Update state.
+* @details          Function to follow the error counters back down: leaving error passive or warning
+*                   raises no interrupt. Thread mode, e.g. once per statistics period.
+* @param        	void.
+* @return           CAN_ERR_xxx state.
+*/
+uint8_t can_err_poll(void);
+
+/**
+* @brief            Start bus off recovery.
+* @details          Function to let FLEXCAN0 rejoin the bus in manual recovery: BOFFREC is negated until
+*                   the 128 x 11 recessive bits are seen, then set again by the interrupt.
+* @param        	void.
+* @return           1 if a recovery was started, 0 if not bus off or in automatic recovery.
+*/
+uint8_t can_err_recover(void);
+
+/**
+* @brief            Re-arm overrun msg buffer.
+* @details          Function to set a receive MB that reported CODE=OVERRUN back to EMPTY and count it.
+*                   Called from the CAN0 MB interrupt after the MB is read and unlocked.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @return           void.
+*/
+void can_err_rearm_mb(uint8_t u8Mb);
+
+
+#endif	/* CAN_ERR_H */
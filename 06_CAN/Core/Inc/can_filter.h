@@ -0,0 +1,82 @@
+/**
+* @file				can_filter.h
+* @brief            Header for can_filter.c file
+*/
+
+#ifndef CAN_FILTER_H
+#define CAN_FILTER_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan_core.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Acceptance filter: a frame is accepted if (frame ID & u32Mask) == (u32Id & u32Mask) */
+typedef struct
+{
+	uint32_t u32Id;				/* Filter ID, CAN_ID_EXT_FLAG for extended IDs (always compared) */
+	uint32_t u32Mask;			/* ID bits to compare: 0x7FF / 0x1FFFFFFF checks the full ID */
+	uint32_t u32FalseAccepts;	/* IDs accepted by the filter that are not in the wanted set */
+} can_filter_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Largest wanted ID set the planner takes */
+#define CAN_FILTER_MAX_IDS			(32U)
+
+/* Full ID masks */
+#define CAN_FILTER_STD_MASK			(0x000007FFU)
+#define CAN_FILTER_EXT_MASK			(0x1FFFFFFFU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Plan acceptance filters.
+* @details          Function to cover a set of wanted IDs with at most u8Budget masked filters (one
+*                   receive MB each). Starting from one exact filter per ID, the two filters whose merge
+*                   lets the fewest unwanted IDs through are merged until the budget is met. Standard
+*                   and extended IDs never share a filter. Runs in O(n^3) per merge, call it at init.
+* @param[in]        pu32Ids - Wanted IDs, CAN_ID_EXT_FLAG for extended IDs. Duplicates are allowed.
+* @param[in]        u8Count - Number of IDs (1 to CAN_FILTER_MAX_IDS).
+* @param[in]        u8Budget - Number of filters available.
+* @param[out]       pFilters - Filters, u8Budget entries.
+* @return           Number of filters used, 0 if the set is too large or the budget is smaller than
+*                   the number of ID types (standard / extended) in the set.
+*/
+uint8_t can_filter_plan(const uint32_t *pu32Ids, uint8_t u8Count, uint8_t u8Budget, can_filter_t *pFilters);
+
+
+#endif	/* CAN_FILTER_H */
@@ -0,0 +1,118 @@
+/**
+* @file				can_gw.h
+* @brief            Header for can_gw.c file
+*/
+
+#ifndef CAN_GW_H
+#define CAN_GW_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Route: frames received on u8Src with an ID in u32IdLow..u32IdHigh go to every instance in u8DstMask */
+typedef struct
+{
+	uint32_t u32IdLow;				/* First ID of the range, CAN_ID_EXT_FLAG for extended IDs */
+	uint32_t u32IdHigh;				/* Last ID of the range, same ID type */
+	uint32_t u32IdNew;				/* ID sent for u32IdLow (the range keeps its offsets), or CAN_GW_KEEP_ID */
+	uint16_t u16MinGapMs;			/* Minimum time between forwarded frames of the route, 0 = no limit */
+	uint8_t u8Src;					/* Source instance (0-2) */
+	uint8_t u8DstMask;				/* Destination instances, bit n = CANn */
+} can_gw_route_t;
+
+/* Gateway counters */
+typedef struct
+{
+	volatile uint32_t u32Forwarded;			/* Frames forwarded */
+	volatile uint32_t u32NoRoute;			/* Frames without a route (or remote frames), dropped */
+	volatile uint32_t u32RateLimited;		/* Frames dropped by the route rate limit */
+	volatile uint32_t u32FifoOverflow;		/* Frames lost because an RX FIFO was full */
+} can_gw_stats_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Route keeps the received ID */
+#define CAN_GW_KEEP_ID				(0xFFFFFFFFU)
+
+/* Destination mask bit of an instance */
+#define CAN_GW_DST(inst)			((uint8_t)(1U << (inst)))
+
+/* Transmit MBs of each instance (the RX FIFO and its filter table use MB0-MB7) */
+#define CAN_GW_TX_MB_FIRST			(8U)
+#define CAN_GW_TX_MB_COUNT			(8U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* Gateway counters */
+extern can_gw_stats_t CanGwStats;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Gateway controller Initialization.
+* @details          Function to initialize a FlexCAN instance for the gateway: FLEXCAN0 bit timing,
+*                   RX FIFO accepting every ID (keeps the arrival order), transmit MBs CAN_GW_TX_MB_FIRST on,
+*                   self reception off. No interrupt is enabled. Pins and transceivers of CAN1/CAN2 are set
+*                   up by the caller.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @return           void.
+*/
+void can_gw_init_controller(uint8_t u8Inst);
+
+/**
+* @brief            Gateway Initialization.
+* @details          Function to install the routing table and clear the counters.
+* @param[in]        pRoutes - Routes sorted by (u8Src, u32IdLow), ranges of one source must not overlap.
+* @param[in]        u8Count - Number of routes.
+* @param[out]       pu32LastMs - Rate limit state, one word per route.
+* @return           void.
+*/
+void can_gw_init(const can_gw_route_t *pRoutes, uint8_t u8Count, uint32_t *pu32LastMs);
+
+/**
+* @brief            Service gateway instance.
+* @details          Function to forward the frames waiting in the RX FIFO of an instance. Each frame is
+*                   copied from the FIFO output MB straight into a transmit MB of every destination. A
+*                   frame stays in the FIFO while a destination has no free MB (or a pending frame with
+*                   the same ID) and is retried on the next call. Call it from the main loop: the gateway
+*                   enables no interrupt, and a FIFO interrupt would stay pending while a frame waits.
+* @param[in]        u8Inst - Source FlexCAN instance (0-2).
+* @param[in]        u32NowMs - Current time in ms, for the rate limits.
+* @return           void.
+*/
+void can_gw_service(uint8_t u8Inst, uint32_t u32NowMs);
+
+
+#endif	/* CAN_GW_H */
@@ -0,0 +1,187 @@
+/**
+* @file				can_isotp.h
+* @brief            Header for can_isotp.c file
+*/
+
+#ifndef CAN_ISOTP_H
+#define CAN_ISOTP_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Sends one CAN frame of the link. Returns 1 if the frame was accepted, 0 to retry later */
+typedef uint8_t (*can_isotp_send_t)(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+
+/* Called when a message has been received (u32Length bytes in the receive buffer) or a
+   reception failed (u32Length = 0, u8Result != CAN_ISOTP_OK) */
+typedef void (*can_isotp_rx_done_t)(uint32_t u32Length, uint8_t u8Result);
+
+/* Called when a transmission has finished or failed */
+typedef void (*can_isotp_tx_done_t)(uint8_t u8Result);
+
+/* Link configuration */
+typedef struct
+{
+	uint32_t u32TxId;				/* ID of frames sent by this node, CAN_ID_EXT_FLAG for extended */
+	uint32_t u32RxId;				/* ID of frames received from the peer */
+	uint8_t u8FrameSize;			/* CAN_DL: 8 (classic) or 12..64 (CAN FD, not with can_send) */
+	uint8_t u8BlockSize;			/* BS sent in our flow control, 0 = no further FC */
+	uint8_t u8StMin;				/* STmin sent in our flow control (ISO 15765-2 encoding) */
+	uint8_t u8Padding;				/* Value of unused bytes in padded frames */
+	can_isotp_send_t pfSend;		/* Frame transmit function, e.g. can_send */
+	can_isotp_rx_done_t pfRxDone;	/* Receive indication, may be NULL */
+	can_isotp_tx_done_t pfTxDone;	/* Transmit confirmation, may be NULL */
+} can_isotp_cfg_t;
+
+/* Link state */
+typedef struct
+{
+	can_isotp_cfg_t cfg;			/* Configuration */
+
+	uint8_t *pu8RxBuf;				/* Caller receive buffer, messages are reassembled in place */
+	uint32_t u32RxSize;				/* Size of the receive buffer */
+	uint32_t u32RxLength;			/* Length of the message being received */
+	uint32_t u32RxPos;				/* Bytes received so far */
+	uint32_t u32RxDeadline;			/* N_Cr: time by which the next CF must arrive */
+	uint8_t u8RxState;				/* CAN_ISOTP_RX_xxx */
+	uint8_t u8RxSn;					/* Next expected sequence number */
+	uint8_t u8RxBlockLeft;			/* CFs left before we send the next FC */
+	uint8_t u8RxDl;					/* RX_DL: length of the FF, every CF but the last has it */
+
+	const uint8_t *pu8TxBuf;		/* Caller transmit buffer, sent in place */
+	uint32_t u32TxLength;			/* Length of the message being sent */
+	uint32_t u32TxPos;				/* Bytes sent so far */
+	uint32_t u32TxDeadline;			/* N_Bs: time by which the FC must arrive, or time of the next CF */
+	uint32_t u32TxStMinUs;			/* Peer STmin in microseconds */
+	uint8_t u8TxState;				/* CAN_ISOTP_TX_xxx */
+	uint8_t u8TxSn;					/* Next sequence number */
+	uint8_t u8TxBlockSize;			/* Peer BS */
+	uint8_t u8TxBlockLeft;			/* CFs left before we wait for the next FC */
+	uint8_t u8TxWaitCount;			/* FC WAIT frames received in a row */
+} can_isotp_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Result codes */
+#define CAN_ISOTP_OK				(0U)	/* Transfer completed */
+#define CAN_ISOTP_TIMEOUT			(1U)	/* N_Bs or N_Cr expired */
+#define CAN_ISOTP_WRONG_SN			(2U)	/* Consecutive frame out of sequence */
+#define CAN_ISOTP_OVERFLOW			(3U)	/* Message larger than the receive buffer */
+#define CAN_ISOTP_UNEXPECTED		(4U)	/* New first/single frame aborted a reception */
+#define CAN_ISOTP_WFT_OVERRUN		(5U)	/* Too many FC WAIT frames */
+#define CAN_ISOTP_BUSY				(6U)	/* A transmission is already running */
+#define CAN_ISOTP_INVALID_LENGTH	(7U)	/* Empty message, ISO 15765-2 has no SF_DL=0 */
+#define CAN_ISOTP_WRONG_DL			(8U)	/* Consecutive frame length does not match RX_DL */
+
+/* Receive states */
+#define CAN_ISOTP_RX_IDLE			(0U)
+#define CAN_ISOTP_RX_CF				(1U)	/* Receiving consecutive frames */
+
+/* Transmit states */
+#define CAN_ISOTP_TX_IDLE			(0U)
+#define CAN_ISOTP_TX_FF				(1U)	/* First or single frame to be sent */
+#define CAN_ISOTP_TX_WAIT_FC		(2U)	/* Waiting for flow control */
+#define CAN_ISOTP_TX_CF				(3U)	/* Sending consecutive frames */
+
+/* N_Bs / N_Cr timeouts in microseconds */
+#define CAN_ISOTP_TIMEOUT_US		(1000000U)
+
+/* FC WAIT frames accepted in a row (N_WFTmax) */
+#define CAN_ISOTP_WFT_MAX			(8U)
+
+/* Largest message: 32 bit FF_DL escape */
+#define CAN_ISOTP_MAX_LENGTH		(0xFFFFFFFFU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Initialize link.
+* @details          Function to copy the configuration and set both directions idle. can_send()
+*                   carries classic frames only, so a link sending through it must use 8 byte frames.
+* @param[out]       pLink - Link.
+* @param[in]        pCfg - Configuration.
+* @return           1 if done, 0 if the frame size is not a CAN_DL or too large for can_send().
+*/
+uint8_t can_isotp_init(can_isotp_t *pLink, const can_isotp_cfg_t *pCfg);
+
+/**
+* @brief            Set receive buffer.
+* @details          Function to give the link the buffer incoming messages are reassembled into.
+*                   The buffer is owned by the link until the receive indication.
+* @param[in,out]    pLink - Link.
+* @param[out]       pu8Buf - Buffer.
+* @param[in]        u32Size - Buffer size in bytes.
+* @return           void.
+*/
+void can_isotp_set_rx_buffer(can_isotp_t *pLink, uint8_t *pu8Buf, uint32_t u32Size);
+
+/**
+* @brief            Send message.
+* @details          Function to start sending a message. The data is read in place and must stay
+*                   unchanged until the transmit confirmation. Frames go out from can_isotp_poll().
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Message.
+* @param[in]        u32Length - Message length in bytes (1 or more).
+* @return           CAN_ISOTP_OK if started, CAN_ISOTP_BUSY if a transmission is running,
+*                   CAN_ISOTP_INVALID_LENGTH for an empty message (SF_DL=0 is not a valid frame).
+*/
+uint8_t can_isotp_send(can_isotp_t *pLink, const uint8_t *pu8Data, uint32_t u32Length);
+
+/**
+* @brief            Receive frame.
+* @details          Function to process a frame received with the link receive ID.
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Frame data bytes.
+* @param[in]        u8Length - Frame data length.
+* @param[in]        u32NowUs - Current time in microseconds (free running, wraps).
+* @return           void.
+*/
+void can_isotp_rx_frame(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs);
+
+/**
+* @brief            Run link.
+* @details          Function to send pending frames once STmin has elapsed and check timeouts.
+*                   Call it from the main loop at least as often as the shortest STmin.
+* @param[in,out]    pLink - Link.
+* @param[in]        u32NowUs - Current time in microseconds (free running, wraps).
+* @return           void.
+*/
+void can_isotp_poll(can_isotp_t *pLink, uint32_t u32NowUs);
+
+
+#endif	/* CAN_ISOTP_H */
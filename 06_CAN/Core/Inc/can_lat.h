@@ -0,0 +1,97 @@
+/**
+* @file				can_lat.h
+* @brief            Header for can_lat.c file
+*/
+
+#ifndef CAN_LAT_H
+#define CAN_LAT_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "can_time.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Number of histogram buckets: the last one counts 2^15 bit times (65 ms at 500 kbit/s) and above */
+#define CAN_LAT_BUCKETS		(17U)
+
+/* Latency histogram in timebase ticks (CAN0 bit times). Bucket 0 counts 0 ticks, bucket k counts
+   2^(k-1) to 2^k - 1 ticks */
+typedef struct
+{
+	volatile uint32_t au32Bucket[CAN_LAT_BUCKETS];	/* Samples per bucket */
+	volatile uint32_t u32Count;						/* Samples recorded */
+	volatile uint32_t u32Max;						/* Largest sample, saturated at 0xFFFFFFFF */
+} can_lat_hist_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* Reception (MB time stamp) to application (frame taken from the receive ring) */
+extern can_lat_hist_t CanLatRx;
+
+/* can_send() call to transmission (MB time stamp of the sent frame) */
+extern can_lat_hist_t CanLatTx;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Record latency.
+* @details          Function to add the time from u64Start to u64End to a histogram. A histogram must
+*                   only be recorded from one context.
+* @param[in,out]    pHist - Histogram.
+* @param[in]        u64Start - Start time (can_time_xxx).
+* @param[in]        u64End - End time.
+* @return           void.
+*/
+void can_lat_record(can_lat_hist_t *pHist, uint64_t u64Start, uint64_t u64End);
+
+/**
+* @brief            Get percentile.
+* @details          Function to return an upper bound of the given percentile of the recorded latencies.
+* @param[in]        pHist - Histogram.
+* @param[in]        u16PerMille - Percentile in per mille (500 = median, 990 = 99th percentile).
+* @return           Upper bound in ticks (end of the bucket holding the percentile, at most u32Max), 0 if empty.
+*/
+uint32_t can_lat_percentile(const can_lat_hist_t *pHist, uint16_t u16PerMille);
+
+/**
+* @brief            Clear histogram.
+* @param[out]       pHist - Histogram.
+* @return           void.
+*/
+void can_lat_reset(can_lat_hist_t *pHist);
+
+
+#endif	/* CAN_LAT_H */
@@ -0,0 +1,109 @@
+/**
+* @file				can_replay.h
+* @brief            Header for can_replay.c file
+*/
+
+#ifndef CAN_REPLAY_H
+#define CAN_REPLAY_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+#include "can_trace.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Sends one replayed frame. Returns 1 if the frame was accepted, 0 to retry later */
+typedef uint8_t (*can_replay_send_t)(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+
+/* Replay state */
+typedef struct
+{
+	const uint8_t *pu8Trace;		/* Trace stream: can_trace_header() followed by records */
+	uint32_t u32Size;				/* Stream size in bytes */
+	uint32_t u32Pos;				/* Read position of the next record */
+	uint32_t u32TickHz;				/* Tick rate of the trace */
+	uint16_t u16ScalePct;			/* Timing in percent of the original, 0 = as fast as possible */
+	can_replay_send_t pfSend;		/* Frame transmit function, e.g. can_send */
+	uint64_t u64Start;				/* Timebase time of the first record */
+	uint64_t u64TraceTime;			/* Trace time of the pending record, in trace ticks from the first record */
+	uint32_t u32Id;					/* Pending record: ID */
+	uint8_t au8Data[64];			/* Pending record: data */
+	uint8_t u8Length;				/* Pending record: data length */
+	uint8_t u8Flags;				/* Pending record: flags byte */
+	uint8_t u8Pending;				/* 1 if a record is waiting for its time */
+	uint32_t u32Sent;				/* Frames sent */
+	uint32_t u32Skipped;			/* TX and CAN FD records, not replayed */
+	uint32_t u32Retries;			/* Send attempts refused (transmit queue full) */
+	uint64_t u64MaxLate;			/* Largest delay behind the scaled trace time, timebase ticks */
+	uint8_t u8Error;				/* 1 if the stream was malformed or cut off */
+} can_replay_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Timing modes (u16ScalePct) */
+#define CAN_REPLAY_ORIGINAL			(100U)	/* Original timing */
+#define CAN_REPLAY_FAST				(0U)	/* As fast as the transmit queue takes frames */
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Start replay.
+* @details          Function to check the trace header and schedule the first record at time u64Now. Later
+*                   records keep their distance to the first one, the time from can_trace_start() to the
+*                   first record is not replayed.
+* @param[out]       pReplay - Replay state.
+* @param[in]        pu8Trace - Trace stream, e.g. a can_trace dump placed in flash.
+* @param[in]        u32Size - Stream size in bytes.
+* @param[in]        u16ScalePct - CAN_REPLAY_ORIGINAL, CAN_REPLAY_FAST, or timing in percent (200 = half speed).
+* @param[in]        pfSend - Frame transmit function.
+* @param[in]        u64Now - Current time (can_time_now()).
+* @return           1 if started, 0 if the stream has no valid header.
+*/
+uint8_t can_replay_start(can_replay_t *pReplay, const uint8_t *pu8Trace, uint32_t u32Size,
+						 uint16_t u16ScalePct, can_replay_send_t pfSend, uint64_t u64Now);
+
+/**
+* @brief            Run replay.
+* @details          Function to send every received-frame record whose scaled time has come. Call it
+*                   from the main loop.
+* @param[in,out]    pReplay - Replay state.
+* @param[in]        u64Now - Current time (can_time_now()).
+* @return           1 while records are left, 0 when the replay is finished.
+*/
+uint8_t can_replay_poll(can_replay_t *pReplay, uint64_t u64Now);
+
+
+#endif	/* CAN_REPLAY_H */
@@ -0,0 +1,100 @@
+/**
+* @file				can_ring.h
+* @brief            Header for can_ring.c file
+*/
+
+#ifndef CAN_RING_H
+#define CAN_RING_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Number of frames held by a ring. Must be a power of 2 */
+#define CAN_RING_SIZE		(32U)
+
+/* Single producer / single consumer frame ring */
+typedef struct
+{
+	volatile uint32_t u32Head;				/* Free running write index, only changed by producer */
+	volatile uint32_t u32Tail;				/* Free running read index, only changed by consumer */
+	volatile uint32_t u32Overflow;			/* Frames dropped because the ring was full */
+	volatile uint32_t u32MaxDepth;			/* Highest fill level seen by the producer */
+	can_frame_t aFrames[CAN_RING_SIZE];		/* Frame storage */
+} can_ring_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Ring Initialization.
+* @details          Function to empty the ring and reset its overflow counter and high water mark.
+* @param[in]        pRing - Frame ring.
+* @return           void.
+*/
+void can_ring_init(can_ring_t *pRing);
+
+/**
+* @brief            Push frame.
+* @details          Function to append a frame to the ring. Called by the producer (ISR) only.
+* @param[in]        pRing - Frame ring.
+* @param[in]        pFrame - Frame to store.
+* @return           1 if stored, 0 if the ring was full and the frame was dropped.
+*/
+uint8_t can_ring_push(can_ring_t *pRing, const can_frame_t *pFrame);
+
+/**
+* @brief            Pop frame.
+* @details          Function to take the oldest frame from the ring without blocking. Called by the consumer only.
+* @param[in]        pRing - Frame ring.
+* @param[out]       pFrame - Oldest frame.
+* @return           1 if a frame was returned, 0 if the ring was empty.
+*/
+uint8_t can_ring_pop(can_ring_t *pRing, can_frame_t *pFrame);
+
+/**
+* @brief            Get fill level.
+* @details          Function to return the number of frames waiting in the ring.
+* @param[in]        pRing - Frame ring.
+* @return           Number of frames.
+*/
+uint32_t can_ring_count(const can_ring_t *pRing);
+
+
+#endif	/* CAN_RING_H */
@@ -0,0 +1,138 @@
+/**
+* @file				can_signal.h
+* @brief            Header for can_signal.c file
+*/
+
+#ifndef CAN_SIGNAL_H
+#define CAN_SIGNAL_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Signal of a frame payload. Build it with CAN_SIGNAL_INTEL() / CAN_SIGNAL_MOTOROLA(); all
+   fields are constants, so a message is described by a const table in flash */
+typedef struct
+{
+	uint8_t u8Order;			/* CAN_SIGNAL_ORDER_xxx */
+	uint8_t u8Shift;			/* Position of the signal LSB in the 64 bit payload value of that order */
+	uint32_t u32Mask;			/* Raw value mask, length bits */
+	uint32_t u32Sign;			/* Sign bit of the raw value, 0 for unsigned signals */
+	float fFactor;				/* Physical value = raw * factor + offset, in float: raw values of more than
+								   24 bits are rounded (24 bit mantissa), use the raw functions for them */
+	float fOffset;
+} can_signal_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Byte order */
+#define CAN_SIGNAL_ORDER_INTEL		(0U)	/* Little endian, DBC @1 */
+#define CAN_SIGNAL_ORDER_MOTOROLA	(1U)	/* Big endian, DBC @0 */
+
+/* Raw value mask and sign bit of a signal with len bits (1-32) */
+#define CAN_SIGNAL_MASK(len)		(0xFFFFFFFFU >> (32U - (len)))
+#define CAN_SIGNAL_SIGN(len, sgn)	((0U != (sgn)) ? (1UL << ((len) - 1U)) : 0U)
+
+/* 0 if cond holds, a compile error (negative array size) if not. start and len must be constants */
+#define CAN_SIGNAL_CHECK(cond)		(0U * sizeof(char[(cond) ? 1 : -1]))
+
+/* Motorola MSB as a bit number of the 64 bit payload value (byte 0 in bits 63:56) */
+#define CAN_SIGNAL_MOTOROLA_MSB(start)	((7U - ((start) >> 3U))*8U + ((start) & 7U))
+
+/* Intel signal: start is the DBC start bit (LSB), len 1-32 bits, sgn 1 for signed (DBC -).
+   The signal must end in the 8 byte payload (start + len <= 64) */
+#define CAN_SIGNAL_INTEL(start, len, sgn, factor, offset)		\
+	{ CAN_SIGNAL_ORDER_INTEL,									\
+	  (uint8_t)((start) + CAN_SIGNAL_CHECK(((len) >= 1U) && ((len) <= 32U) && (((start) + (len)) <= 64U))), \
+	  CAN_SIGNAL_MASK(len), CAN_SIGNAL_SIGN(len, sgn), (factor), (offset) }
+
+/* Motorola signal: start is the DBC start bit (MSB, sawtooth numbering), len 1-32 bits.
+   The signal must end in the 8 byte payload (len bits from the MSB down to byte 7 bit 0) */
+#define CAN_SIGNAL_MOTOROLA(start, len, sgn, factor, offset)	\
+	{ CAN_SIGNAL_ORDER_MOTOROLA,								\
+	  (uint8_t)(CAN_SIGNAL_MOTOROLA_MSB(start) + 1U - (len)		\
+				+ CAN_SIGNAL_CHECK(((len) >= 1U) && ((len) <= 32U) && ((start) <= 63U) \
+								   && ((CAN_SIGNAL_MOTOROLA_MSB(start) + 1U) >= (len)))), \
+	  CAN_SIGNAL_MASK(len), CAN_SIGNAL_SIGN(len, sgn), (factor), (offset) }
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Get raw signal value.
+* @details          Function to extract a signal from an 8 byte payload and sign extend it.
+* @param[in]        pSignal - Signal.
+* @param[in]        pu32Data - Payload (2 words, MB byte order), e.g. RxDATA or can_frame_t.u32Data.
+* @return           Raw value. Cast it to uint32_t for an unsigned 32 bit signal.
+*/
+int32_t can_signal_get_raw(const can_signal_t *pSignal, const uint32_t *pu32Data);
+
+/**
+* @brief            Set raw signal value.
+* @details          Function to insert a signal into an 8 byte payload, other bits are kept.
+* @param[in]        pSignal - Signal.
+* @param[in,out]    pu32Data - Payload (2 words, MB byte order).
+* @param[in]        u32Raw - Raw value (two's complement for signed signals), truncated to the signal length.
+* @return           void.
+*/
+void can_signal_set_raw(const can_signal_t *pSignal, uint32_t *pu32Data, uint32_t u32Raw);
+
+/**
+* @brief            Unpack message.
+* @details          Function to decode the physical values of all signals of a message. float holds
+*                   integers up to 2^24 exactly, so raw values above that lose their low bits.
+* @param[in]        pSignals - Signal table of the message.
+* @param[in]        u8Count - Number of signals.
+* @param[in]        pu32Data - Payload (2 words, MB byte order).
+* @param[out]       pfValues - Physical values, one per signal.
+* @return           void.
+*/
+void can_signal_unpack(const can_signal_t *pSignals, uint8_t u8Count, const uint32_t *pu32Data, float *pfValues);
+
+/**
+* @brief            Pack message.
+* @details          Function to encode physical values (rounded to the nearest raw value and saturated
+*                   to the signal range) into a payload. Above 2^24 a float steps by more than one raw
+*                   value, so not every raw value of a longer signal can be packed.
+* @param[in]        pSignals - Signal table of the message.
+* @param[in]        u8Count - Number of signals.
+* @param[in]        pfValues - Physical values, one per signal.
+* @param[out]       pu32Data - Payload (2 words, MB byte order), cleared first.
+* @return           void.
+*/
+void can_signal_pack(const can_signal_t *pSignals, uint8_t u8Count, const float *pfValues, uint32_t *pu32Data);
+
+
+#endif	/* CAN_SIGNAL_H */
@@ -0,0 +1,147 @@
+/**
+* @file				can_stats.h
+* @brief            Header for can_stats.c file
+*/
+
+#ifndef CAN_STATS_H
+#define CAN_STATS_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+#include "can_time.h"
+#include "can_tx.h"
+#include "can_err.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Number of IDs counted individually, further IDs are counted together */
+#define CAN_STATS_ID_SLOTS		(16U)
+
+/* Counters, only ever incremented by the CAN0 MB interrupt */
+typedef struct
+{
+	uint32_t au32MbRx[32];						/* Frames received per MB */
+	uint32_t au32MbTx[32];						/* Frames sent per MB */
+	uint32_t au32MbOverrun[32];					/* Frames lost per MB (CODE=OVERRUN at read) */
+	uint32_t au32IdCount[CAN_STATS_ID_SLOTS];	/* Frames per ID slot, rx and tx */
+	uint32_t u32IdOther;						/* Frames of IDs without a slot */
+	uint32_t u32Frames;							/* Frames received and sent */
+	uint32_t u32Bits;							/* Bus bits of those frames */
+} can_stats_counters_t;
+
+/* Statistics since the last can_stats_reset() */
+typedef struct
+{
+	can_stats_counters_t counters;				/* Counter increments */
+	uint32_t au32Id[CAN_STATS_ID_SLOTS];		/* ID of each slot, CAN_STATS_FREE if unused */
+	uint64_t u64Elapsed;						/* Time covered, in bit times */
+	uint16_t u16BusLoad;						/* Bus load in per mille */
+	uint8_t u8TxErrors;							/* ECR[TXERRCNT] now */
+	uint8_t u8RxErrors;							/* ECR[RXERRCNT] now */
+	uint8_t u8FaultConf;						/* Fault confinement now (FLTCONF coding): 0 active, 1 passive, 2 bus off */
+	uint32_t u32BusOff;							/* Bus off events (CanErr.u32BusOff) */
+	uint32_t u32ErrorFrames;					/* Error events (CanErr.u32ErrorFrames) */
+	uint32_t u32TxDropped;						/* Frames refused by can_send() */
+} can_stats_snapshot_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Unused ID slot */
+#define CAN_STATS_FREE			(0xFFFFFFFFU)
+
+/* Bus bits of a data frame without stuff bits, including the 3 bit intermission:
+   standard ID 47 + 8n, extended ID 67 + 8n. The bus load reads low by the stuff bits, up to 18 %. */
+#define CAN_STATS_FRAME_BITS(id, len)	(((0U != ((id) & CAN_ID_EXT_FLAG)) ? 67U : 47U) + 8U*(uint32_t)(len))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Statistics Initialization.
+* @details          Function to clear all counters and ID slots. Call it before the CAN0 interrupt is enabled.
+* @param        	void.
+* @return           void.
+*/
+void can_stats_init(void);
+
+/**
+* @brief            Count received frame.
+* @details          Function to count a frame read from a receive MB. Called from the CAN0 MB interrupt.
+* @param[in]        pFrame - Received frame.
+* @param[in]        u8Overrun - 1 if frames were lost in the MB before this one (CODE=OVERRUN).
+* @return           void.
+*/
+void can_stats_rx(const can_frame_t *pFrame, uint8_t u8Overrun);
+
+/**
+* @brief            Count sent frame.
+* @details          Function to count a frame sent from a transmit MB. Called from the CAN0 MB interrupt.
+* @param[in]        u8Mb - Transmit MB.
+* @param[in]        u32Id - Frame ID.
+* @param[in]        u8Length - Number of data bytes.
+* @return           void.
+*/
+void can_stats_tx(uint8_t u8Mb, uint32_t u32Id, uint8_t u8Length);
+
+/**
+* @brief            Take snapshot.
+* @details          Function to return the statistics since the last reset, bus load over that time and
+*                   the current error state. Thread mode only; the interrupt keeps counting meanwhile.
+* @param[out]       pSnapshot - Statistics.
+* @return           void.
+*/
+void can_stats_snapshot(can_stats_snapshot_t *pSnapshot);
+
+/**
+* @brief            Reset statistics.
+* @details          Function to restart all counters and the bus load window. Thread mode only. The
+*                   counters keep running; the reset stores a baseline, so interrupts stay enabled.
+* @param        	void.
+* @return           void.
+*/
+void can_stats_reset(void);
+
+/**
+* @brief            Send statistics frame.
+* @details          Function to queue an 8 byte diagnostic frame: bus load %, TXERRCNT, RXERRCNT, bus off
+*                   events, overruns, dropped TX frames (each saturated at 255) and frames (16 bit, big endian).
+* @param[in]        u32Id - Frame ID.
+* @param[in]        pSnapshot - Statistics.
+* @return           1 if queued, 0 if the transmit queue was full.
+*/
+uint8_t can_stats_send(uint32_t u32Id, const can_stats_snapshot_t *pSnapshot);
+
+
+#endif	/* CAN_STATS_H */
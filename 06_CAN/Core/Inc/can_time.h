@@ -0,0 +1,101 @@
+/**
+* @file				can_time.h
+* @brief            Header for can_time.c file
+*/
+
+#ifndef CAN_TIME_H
+#define CAN_TIME_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* LPIT0 functional clock: SPLL_DIV2_CLK = 160 MHz / 4 */
+#define CAN_TIME_LPIT_CLK_HZ		(40000000U)
+
+/* Timebase ticks (CAN0 bit times) to microseconds */
+#define CAN_TIME_TICKS_TO_US(t)		((uint64_t)(t) * 1000000U / FLEXCAN0_BITRATE)
+
+/* IRQ48-LPIT0 ch0 priority: same as IRQ81-CAN0 so neither preempts the other (a TIMER read unlocks MBs) */
+#define CAN_TIME_IRQ_PRIO			(0x8U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Timebase Initialization.
+* @details          Function to start LPIT0 channel 0 at half the CAN0 TIMER wrap period and enable its
+*                   interrupt. Call it after FLEXCAN0 initialization.
+* @param        	void.
+* @return           void.
+*/
+void can_time_init(void);
+
+/**
+* @brief            Sample timebase.
+* @details          Function to fold the CAN0 TIMER ticks since the last sample into the 64 bit time.
+*                   Called from the LPIT0 ch0 interrupt, at least once per TIMER wrap.
+* @param        	void.
+* @return           void.
+*/
+void can_time_isr(void);
+
+/**
+* @brief            Extend time stamp.
+* @details          Function to turn a 16 bit msg buffer time stamp into the 64 bit timebase. The frame
+*                   must be less than one TIMER wrap old, so call it from the CAN0 MB interrupt after
+*                   the MBs have been read (it reads TIMER).
+* @param[in]        u16Stamp - C/S TIME STAMP of a received or transmitted frame.
+* @return           Time in CAN0 bit times.
+*/
+uint64_t can_time_extend(uint16_t u16Stamp);
+
+/**
+* @brief            Get time.
+* @details          Function to return the current 64 bit time. The result is consistent from thread mode
+*                   and interrupts. It reads the CAN0 TIMER, which unlocks a locked receive MB: do not call
+*                   it while an MB is being read (C/S word read, data not yet copied), e.g. from an
+*                   interrupt that can preempt the CAN0 MB interrupt.
+* @param        	void.
+* @return           Time in CAN0 bit times.
+*/
+uint64_t can_time_now(void);
+
+
+#endif	/* CAN_TIME_H */
@@ -0,0 +1,132 @@
+/**
+* @file				can_trace.h
+* @brief            Header for can_trace.c file
+*/
+
+#ifndef CAN_TRACE_H
+#define CAN_TRACE_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Trace buffer size in bytes. Must be a power of 2 */
+#define CAN_TRACE_SIZE				(4096U)
+
+/* Recorder state */
+typedef struct
+{
+	volatile uint32_t u32Head;				/* Free running write index, only changed by the recorder (CAN0 ISR) */
+	volatile uint32_t u32Tail;				/* Free running read index, only changed by the reader */
+	volatile uint32_t u32Dropped;			/* Records dropped because the buffer was full */
+	volatile uint8_t u8Running;				/* 1 while recording */
+	uint64_t u64Last;						/* Time of the last stored record */
+	uint8_t au8Buf[CAN_TRACE_SIZE];			/* Encoded records */
+} can_trace_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Stream header: 'C' 'T' 'R' version, then the tick rate in Hz (32 bit little-endian) */
+#define CAN_TRACE_HEADER_SIZE		(8U)
+#define CAN_TRACE_VERSION			(1U)
+
+/* Record flags byte: direction, frame format and DLC */
+#define CAN_TRACE_RX				(0x00U)
+#define CAN_TRACE_TX				(0x80U)
+#define CAN_TRACE_IDE				(0x40U)		/* 29 bit ID, set from CAN_ID_EXT_FLAG */
+#define CAN_TRACE_FDF				(0x20U)		/* CAN FD frame, DLC 9-15 code 12-64 bytes */
+#define CAN_TRACE_BRS				(0x10U)		/* CAN FD bit rate switch */
+#define CAN_TRACE_DLC_MASK			(0x0FU)
+
+/* Largest record: flags, 10 byte time delta, 5 byte ID, 64 data bytes */
+#define CAN_TRACE_RECORD_MAX		(1U + 10U + 5U + 64U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* CAN0 trace recorder */
+extern can_trace_t CanTrace;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Start recording.
+* @details          Function to empty the trace buffer and record from time u64Now on. Call it with the
+*                   CAN0 interrupt disabled or before it is enabled.
+* @param[in]        u64Now - Current time (can_time_now()), the first record is relative to it.
+* @return           void.
+*/
+void can_trace_start(uint64_t u64Now);
+
+/**
+* @brief            Stop recording.
+* @details          Function to freeze the trace, e.g. when the fault shows up. Stored records stay readable.
+* @param        	void.
+* @return           void.
+*/
+void can_trace_stop(void);
+
+/**
+* @brief            Record frame.
+* @details          Function to append one frame to the trace: flags byte, zigzag varint time delta to the
+*                   previous record, varint ID, then the data bytes. Called from the CAN0 interrupt only.
+* @param[in]        u8Dir - CAN_TRACE_RX or CAN_TRACE_TX, ORed with CAN_TRACE_FDF/BRS for CAN FD frames.
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @param[in]        u64Time - Frame time stamp (64 bit timebase).
+* @param[in]        pu32Data - Data words, MB byte order.
+* @param[in]        u8Dlc - DLC (0-8, 0-15 for CAN FD).
+* @return           1 if stored, 0 if stopped or dropped because the buffer was full.
+*/
+uint8_t can_trace_record(uint8_t u8Dir, uint32_t u32Id, uint64_t u64Time, const uint32_t *pu32Data, uint8_t u8Dlc);
+
+/**
+* @brief            Write stream header.
+* @details          Function to write the CAN_TRACE_HEADER_SIZE byte header that starts a trace dump.
+* @param[out]       pu8Buf - Header bytes.
+* @param[in]        u32TickHz - Timebase tick rate, FLEXCAN0_BITRATE for the CAN0 timebase.
+* @return           void.
+*/
+void can_trace_header(uint8_t *pu8Buf, uint32_t u32TickHz);
+
+/**
+* @brief            Read trace.
+* @details          Function to move up to u32Size bytes of recorded data out of the buffer. Records may be
+*                   split between reads; the concatenated output after the header is the trace stream.
+* @param[out]       pu8Buf - Destination.
+* @param[in]        u32Size - Destination size in bytes.
+* @return           Number of bytes copied.
+*/
+uint32_t can_trace_read(uint8_t *pu8Buf, uint32_t u32Size);
+
+
+#endif	/* CAN_TRACE_H */
@@ -0,0 +1,115 @@
+/**
+* @file				can_tx.h
+* @brief            Header for can_tx.c file
+*/
+
+#ifndef CAN_TX_H
+#define CAN_TX_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan.h"
+#include "can_lat.h"
+#include "can_stats.h"
+#include "can_trace.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Called from the MB interrupt when a frame has been transmitted */
+typedef void (*can_tx_callback_t)(uint32_t u32Id);
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* First transmit msg buffer of the pool */
+#define CAN_TX_MB_FIRST		(FLEXCAN0_TX_MB_FIRST)
+
+/* Number of transmit msg buffers in the pool (MB8-MB11) */
+#define CAN_TX_MB_COUNT		(4U)
+
+/* Transmit msg buffers, one bit per MB */
+#define CAN_TX_MB_MASK		(((1UL << CAN_TX_MB_COUNT) - 1UL) << CAN_TX_MB_FIRST)
+
+/* Number of frames the software queue holds while all transmit MBs are busy */
+#define CAN_TX_QUEUE_SIZE	(32U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Transmit engine Initialization.
+* @details          Function to inactivate the transmit MB pool, empty the queue and enable TX MB interrupts.
+*                   IRQ81 is left enabled or disabled in the NVIC as it was found.
+* @param[in]        pfCallback - TX complete callback, may be NULL.
+* @return           void.
+*/
+void can_tx_init(can_tx_callback_t pfCallback);
+
+/**
+* @brief            Send frame.
+* @details          Function to queue a data frame for transmission without blocking. Frames leave in
+*                   CAN priority order (lowest ID first); frames with the same ID leave in call order.
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @param[in]        pu8Data - Data bytes.
+* @param[in]        u8Length - Number of data bytes (0-8).
+* @return           1 if queued, 0 if the queue was full or the length is invalid.
+*/
+uint8_t can_send(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+
+/**
+* @brief            Get queued frames.
+* @details          Function to return the number of frames waiting for a free transmit MB.
+* @param	        void.
+* @return           Number of frames.
+*/
+uint32_t can_tx_pending(void);
+
+/**
+* @brief            Get dropped frames.
+* @details          Function to return the number of frames refused because the queue was full.
+* @param	        void.
+* @return           Number of frames.
+*/
+uint32_t can_tx_dropped(void);
+
+/**
+* @brief            Transmit MB interrupt handling.
+* @details          Function to release completed transmit MBs, report them and refill them from the queue.
+*                   Called from the CAN0 MB interrupt.
+* @param[in]        u32Flags - Flagged MBs (IFLAG1), only the transmit pool bits are used.
+* @return           void.
+*/
+void can_tx_isr(uint32_t u32Flags);
+
+
+#endif	/* CAN_TX_H */
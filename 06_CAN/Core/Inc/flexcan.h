@@ -12,15 +12,89 @@
 * 2) needed interfaces from external units
 * 3) internal and external interfaces from this unit
 ==================================================================================================*/
+#include <stddef.h>
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan_core.h"
+#include "can_filter.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
 ==================================================================================================*/
+/* Received CAN frame, as copied out of a message buffer */
+typedef struct
+{
+	uint32_t u32Id;				/* Standard or extended ID, CAN_ID_EXT_FLAG set for extended */
+	uint8_t u8Code;				/* Message buffer CODE field at time of read */
+	uint8_t u8Length;			/* Number of data bytes (DLC) */
+	uint16_t u16Timestamp;		/* Free running timer value captured at reception */
+	uint32_t u32Data[2];		/* Message data (2 words, MB byte order) */
+	uint64_t u64Timestamp;		/* u16Timestamp extended by can_time_extend(), 0 if not extended */
+	uint8_t u8Mb;				/* Message buffer the frame was read from (0: RX FIFO output) */
+} can_frame_t;
 
 /*==================================================================================================
 *                                       LOCAL MACROS
 ==================================================================================================*/
+/* FlexCAN instance driven by the FLEXCAN0_xxx functions */
+#define FLEXCAN0_INST				(0U)
+
+/* Registers of that instance */
+#define FLEXCAN0_BASE				FLEXCAN_BASE(FLEXCAN0_INST)
+
+/* CAN clock. CLKSRC=0: Fcanclk = Fosc = 8 MHz */
+#define FLEXCAN0_CLK_HZ				(8000000U)
+
+/* Nominal bit rate, also the tick rate of the free running TIMER */
+#ifndef FLEXCAN0_BITRATE
+#define FLEXCAN0_BITRATE			(500000U)
+#endif
+
+/* Sample point in per mille of the bit time */
+#define FLEXCAN0_SAMPLE_POINT		(750U)
+
+/* Receive msg buffers serviced by the MB interrupt (MB4) */
+#define FLEXCAN0_RX_MB_MASK			(0x00000010U)
+
+/* First msg buffer of the transmit pool (can_tx.c), the receive setups stay below it */
+#define FLEXCAN0_TX_MB_FIRST		(8U)
+
+/* RX FIFO filter table: (RFFN+1) x 8 elements from MB6, at most 104 (RFFN=12) */
+#define FLEXCAN_FIFO_MAX_ELEMENTS	(104U)
+
+/* Filter elements whose table ends below the transmit pool (8 per 2 MBs) */
+#define FLEXCAN0_FIFO_MAX_FILTERS	(((FLEXCAN0_TX_MB_FIRST - 6U) / 2U) * 8U)
+
+/* RX FIFO flags in IFLAG1 (RFEN=1) */
+#define FLEXCAN_FIFO_AVAILABLE_FLAG	(0x00000020U)	/* BUF5I: frames available */
+#define FLEXCAN_FIFO_WARNING_FLAG	(0x00000040U)	/* BUF6I: FIFO almost full */
+#define FLEXCAN_FIFO_OVERFLOW_FLAG	(0x00000080U)	/* BUF7I: FIFO overflow */
+
+/* RX FIFO filter element formats (MCR[IDAM]) */
+#define FLEXCAN_FIFO_FORMAT_A		(0U)		/* One full ID per element */
+#define FLEXCAN_FIFO_FORMAT_B		(1U)		/* Two 14 bit IDs per element */
+#define FLEXCAN_FIFO_FORMAT_C		(2U)		/* Four 8 bit partial IDs per element */
+
+/* Format A element: RTR=0, IDE, standard ID or full extended ID */
+#define FLEXCAN_FIFO_ID_A(id)		((0U != ((id) & CAN_ID_EXT_FLAG)) \
+									? (0x40000000U | (((id) & 0x1FFFFFFFU) << 1U)) \
+									: (((id) & 0x7FFU) << 19U))
+
+/* Format B half element: IDE, standard ID or 14 MSBs of the extended ID */
+#define FLEXCAN_FIFO_B_HALF(id)		((0U != ((id) & CAN_ID_EXT_FLAG)) \
+									? (0x4000U | (((id) >> 15U) & 0x3FFFU)) \
+									: (((id) & 0x7FFU) << 3U))
+
+/* Format B element: two IDs */
+#define FLEXCAN_FIFO_ID_B(id0, id1)	((FLEXCAN_FIFO_B_HALF(id0) << 16U) | FLEXCAN_FIFO_B_HALF(id1))
+
+/* Format C quarter element: 8 MSBs of the standard or extended ID */
+#define FLEXCAN_FIFO_C_PART(id)		((0U != ((id) & CAN_ID_EXT_FLAG)) \
+									? (((id) >> 21U) & 0xFFU) \
+									: (((id) >> 3U) & 0xFFU))
+
+/* Format C element: four partial IDs */
+#define FLEXCAN_FIFO_ID_C(id0, id1, id2, id3)	((FLEXCAN_FIFO_C_PART(id0) << 24U) | (FLEXCAN_FIFO_C_PART(id1) << 16U) \
+												| (FLEXCAN_FIFO_C_PART(id2) << 8U) | FLEXCAN_FIFO_C_PART(id3))
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
@@ -52,6 +126,9 @@ extern uint32_t RxDATA[2];
 /* Received message time */
 extern uint32_t RxTIMESTAMP;
 
+/* Frames lost because the RX FIFO was full */
+extern uint32_t RxFifoOverflow;
+
 /*==================================================================================================
 *                                   LOCAL FUNCTION PROTOTYPES
 ==================================================================================================*/
@@ -71,6 +148,46 @@ extern uint32_t RxTIMESTAMP;
 */
 void FLEXCAN0_init(void);
 
+/**
+* @brief            FlexCAN0 RX FIFO Initialization.
+* @details          Function to initialize FLEXCAN0 for 500 KHz bit time with the legacy RX FIFO enabled.
+*                   The FIFO output is MB0, MB0-5 hold the 6 FIFO frames, the filter table follows from MB6
+*                   (2 MBs per 8 filter elements). Elements past u8Count repeat the last element.
+*                   The table must end below the transmit pool (FLEXCAN0_TX_MB_FIRST): 8 elements with MB8.
+* @param[in]        u8Format - Filter element format (FLEXCAN_FIFO_FORMAT_A/B/C).
+* @param[in]        pu32Filters - Filter elements, built with FLEXCAN_FIFO_ID_A/B/C.
+* @param[in]        pu32Masks - Individual mask per element in the same format, NULL to check all bits.
+* @param[in]        u8Count - Number of filter elements, 1 to FLEXCAN0_FIFO_MAX_FILTERS.
+* @return           1 if set up, 0 if u8Count is out of range (module left as it was).
+*/
+uint8_t FLEXCAN0_init_rx_fifo(uint8_t u8Format, const uint32_t *pu32Filters, const uint32_t *pu32Masks, uint8_t u8Count);
+
+/**
+* @brief            FlexCAN0 RX FIFO DMA Initialization.
+* @details          Function to initialize FLEXCAN0 like FLEXCAN0_init_rx_fifo() with the FIFO DMA request
+*                   enabled (MCR[DMA]=1). Frames available requests a DMA transfer instead of an interrupt;
+*                   the DMA reads MB0 (C/S, ID, DATA0, DATA1) and the read of the last word pops the FIFO.
+*                   The C/S word holds the filter element index (IDHIT) in bits 31:23.
+* @param[in]        u8Format - Filter element format (FLEXCAN_FIFO_FORMAT_A/B/C).
+* @param[in]        pu32Filters - Filter elements, built with FLEXCAN_FIFO_ID_A/B/C.
+* @param[in]        pu32Masks - Individual mask per element in the same format, NULL to check all bits.
+* @param[in]        u8Count - Number of filter elements, 1 to FLEXCAN0_FIFO_MAX_FILTERS.
+* @return           1 if set up, 0 if u8Count is out of range (module left as it was).
+*/
+uint8_t FLEXCAN0_init_rx_fifo_dma(uint8_t u8Format, const uint32_t *pu32Filters, const uint32_t *pu32Masks, uint8_t u8Count);
+
+/**
+* @brief            FlexCAN0 filtered receive Initialization.
+* @details          Function to initialize FLEXCAN0 for 500 KHz bit time with one receive MB per filter,
+*                   from u8FirstMb on. Each MB checks only the ID bits of its filter mask (IRMQ=1).
+* @param[in]        pFilters - Filters, e.g. from can_filter_plan().
+* @param[in]        u8Count - Number of filters.
+* @param[in]        u8FirstMb - First receive MB.
+* @return           IFLAG1 bits of the receive MBs, 0 if the MBs would reach the transmit pool
+*                   (FLEXCAN0_TX_MB_FIRST) or u8Count is 0 (module left as it was).
+*/
+uint32_t FLEXCAN0_init_rx_filters(const can_filter_t *pFilters, uint8_t u8Count, uint8_t u8FirstMb);
+
 /**
 * @brief            Transmit msg.
 * @details          Function to transmit defined msg, using ID 0x555.
@@ -87,5 +204,90 @@ void FLEXCAN0_transmit_msg(void);
 */
 void FLEXCAN0_receive_msg(void);
 
+/**
+* @brief            Read msg buffer.
+* @details          Function to copy a received frame out of a msg buffer and clear its flag.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[out]       pFrame - Received frame.
+* @return           void.
+*/
+void FLEXCAN0_read_mb(uint8_t u8Mb, can_frame_t *pFrame);
+
+/**
+* @brief            Receive all pending msg buffers.
+* @details          Function to read IFLAG1 once, copy every flagged MB of the mask in one pass (lowest MB
+*                   first) and clear each flag right after its copy, while the MB is still locked. A frame
+*                   that arrives for it later in the batch sets the flag again and is not lost.
+* @param[in]        u32MbMask - Msg buffers to service, one bit per MB.
+* @param[out]       pFrames - Received frames, room for one frame per bit set in u32MbMask.
+* @return           Number of frames copied.
+*/
+uint32_t FLEXCAN0_receive_all(uint32_t u32MbMask, can_frame_t *pFrames);
+
+/**
+* @brief            Read RX FIFO.
+* @details          Function to pop the oldest frame from the legacy RX FIFO. Frames come out in arrival order.
+*                   u8Code of the frame holds the index of the filter element that accepted it (RXFIR[IDHIT]).
+* @param[out]       pFrame - Received frame.
+* @return           1 if a frame was returned, 0 if the FIFO was empty.
+*/
+uint8_t FLEXCAN0_read_rx_fifo(can_frame_t *pFrame);
+
+/**
+* @brief            Write msg buffer.
+* @details          Function to load a data frame into an inactive msg buffer and activate it for transmission.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @param[in]        pu32Data - Data (2 words, MB byte order).
+* @param[in]        u8Length - Number of data bytes (0-8).
+* @return           void.
+*/
+void FLEXCAN0_write_mb(uint8_t u8Mb, uint32_t u32Id, const uint32_t *pu32Data, uint8_t u8Length);
+
+/**
+* @brief            Set msg buffer code.
+* @details          Function to write the CODE field of a msg buffer, clearing the rest of its C/S word.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[in]        u8Code - CODE value (FLEXCAN_RX_xxx / FLEXCAN_TX_xxx).
+* @return           void.
+*/
+void FLEXCAN0_set_mb_code(uint8_t u8Mb, uint8_t u8Code);
+
+/**
+* @brief            Enable msg buffer interrupts.
+* @details          Function to clear pending flags and enable interrupts for the selected msg buffers.
+* @param[in]        u32MbMask - Msg buffers to enable, one bit per MB.
+* @return           void.
+*/
+void FLEXCAN0_enable_mb_interrupts(uint32_t u32MbMask);
+
+/**
+* @brief            Set loopback.
+* @details          Function to switch FLEXCAN0 loopback mode (CTRL1[LPB]) on or off, passing through freeze mode.
+*                   In loopback the transmitted frames are received by the own msg buffers / RX FIFO and the
+*                   CAN0_TX pin stays recessive. Msg buffer contents and the rest of the setup are kept.
+* @param[in]        u8Enable - 1: loopback, 0: normal mode.
+* @return           void.
+*/
+void FLEXCAN0_set_loopback(uint8_t u8Enable);
+
+/**
+* @brief            Enable error interrupts.
+* @details          Function to enable the bus off, bus off done, TX/RX warning and error interrupts and to
+*                   select the bus off recovery, passing through freeze mode (MCR[WRNEN] is freeze-only).
+* @param[in]        u8Manual - 0: automatic bus off recovery, 1: stay bus off until BOFFREC is negated.
+* @return           void.
+*/
+void FLEXCAN0_enable_error_interrupts(uint8_t u8Manual);
+
+/**
+* @brief            Set bus off recovery.
+* @details          Function to write CTRL1[BOFFREC] at run time. Negating it while bus off starts the
+*                   recovery: FlexCAN rejoins after 128 x 11 recessive bits.
+* @param[in]        u8Manual - 0: automatic bus off recovery, 1: stay bus off until BOFFREC is negated.
+* @return           void.
+*/
+void FLEXCAN0_set_bus_off_recovery(uint8_t u8Manual);
+
 
 #endif	/* FLEXCAN_H */
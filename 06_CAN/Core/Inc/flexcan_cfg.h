@@ -0,0 +1,30 @@
+/**
+* @file				flexcan_cfg.h
+* @brief			FlexCAN driver configuration of the 06_CAN project
+*/
+
+#ifndef FLEXCAN_CFG_H
+#define FLEXCAN_CFG_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Frame format of CAN0: 0 = classic CAN 2.0, 1 = CAN FD (EDL=1, BRS=1) */
+#define FLEXCAN_CFG_FD				(0U)
+
+/* CAN0 msg buffer data size (FLEXCAN_MBDS_8/16/32/64). Classic CAN: FLEXCAN_MBDS_8 (0U) */
+#define FLEXCAN_CFG_MBDS			(0U)
+
+
+#endif	/* FLEXCAN_CFG_H */
@@ -0,0 +1,192 @@
+/**
+* @file				flexcan_core.h
+* @brief			FlexCAN instance and msg buffer geometry, shared by the classic and FD drivers
+* @details			All macros take the instance number (0..2) as a constant. With a constant instance
+*					and MB number the base address, MB stride and MB offset fold to constants. The frame
+*					format and the CAN0 payload size come from flexcan_cfg.h of the project.
+*/
+
+#ifndef FLEXCAN_CORE_H
+#define FLEXCAN_CORE_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan_cfg.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Msg buffer view of FlexCAN RAM. Only the first FLEXCAN_MB_PAYLOAD(inst)/4 DATA words exist */
+typedef struct
+{
+	uint32_t CS;			/* Word 0: EDL, BRS, ESI, CODE, SRR, IDE, RTR, DLC, TIME STAMP */
+	uint32_t ID;			/* Word 1: PRIO, ID */
+	uint32_t DATA[16U];		/* Words 2..17: payload, big-endian */
+} flexcan_mb_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Frame ID flag: frame uses a 29 bit extended ID */
+#define CAN_ID_EXT_FLAG				(0x80000000U)
+
+/* Msg buf word 0 (C/S) fields */
+#define FLEXCAN_MB_CS_EDL_MASK		(0x80000000U)
+#define FLEXCAN_MB_CS_BRS_MASK		(0x40000000U)
+#define FLEXCAN_MB_CS_CODE_MASK		(0x0F000000U)
+#define FLEXCAN_MB_CS_CODE_SHIFT	(24U)
+#define FLEXCAN_MB_CS_SRR_MASK		(0x00400000U)
+#define FLEXCAN_MB_CS_IDE_MASK		(0x00200000U)
+#define FLEXCAN_MB_CS_DLC_MASK		(0x000F0000U)
+#define FLEXCAN_MB_CS_DLC_SHIFT		(16U)
+#define FLEXCAN_MB_CS_TIME_MASK		(0x0000FFFFU)
+
+/* Msg buf word 1 (ID) fields */
+#define FLEXCAN_MB_ID_STD_MASK		(0x1FFC0000U)
+#define FLEXCAN_MB_ID_STD_SHIFT		(18U)
+#define FLEXCAN_MB_ID_EXT_MASK		(0x1FFFFFFFU)
+
+/* Msg buf CODE values */
+#define FLEXCAN_RX_INACTIVE			(0x0U)
+#define FLEXCAN_RX_FULL				(0x2U)
+#define FLEXCAN_RX_EMPTY			(0x4U)
+#define FLEXCAN_RX_OVERRUN			(0x6U)
+#define FLEXCAN_TX_INACTIVE			(0x8U)
+#define FLEXCAN_TX_DATA				(0xCU)
+
+/* Msg buffer data sizes (FDCTRL[MBDSR0] encoding) */
+#define FLEXCAN_MBDS_8				(0U)	/*  8 bytes:  4 words per MB */
+#define FLEXCAN_MBDS_16				(1U)	/* 16 bytes:  6 words per MB */
+#define FLEXCAN_MBDS_32				(2U)	/* 32 bytes: 10 words per MB */
+#define FLEXCAN_MBDS_64				(3U)	/* 64 bytes: 18 words per MB */
+
+/* Number of FlexCAN instances */
+#define FLEXCAN_INSTANCE_COUNT		(3U)
+
+/* Instance base address and PCC slot */
+#define FLEXCAN_BASE(inst)			((0U == (inst)) ? CAN0 : ((1U == (inst)) ? CAN1 : CAN2))
+#define FLEXCAN_PCC_INDEX(inst)		((0U == (inst)) ? PCC_FlexCAN0_INDEX : ((1U == (inst)) ? PCC_FlexCAN1_INDEX : PCC_FlexCAN2_INDEX))
+
+/* Instance resources: CAN0 has 32 MBs (512 bytes) and CAN FD, CAN1/CAN2 have 16 MBs (256 bytes) */
+#define FLEXCAN_RAM_WORDS(inst)		((0U == (inst)) ? 128U : 64U)
+#define FLEXCAN_MAX_MB(inst)		((0U == (inst)) ? 32U : 16U)
+#define FLEXCAN_FD_CAPABLE(inst)	(0U == (inst))
+
+/* Instance runs CAN FD frames */
+#define FLEXCAN_FD(inst)			(FLEXCAN_FD_CAPABLE(inst) && (0U != FLEXCAN_CFG_FD))
+
+/* Msg buffer data size of an instance: FLEXCAN_CFG_MBDS on an FD instance, else 8 bytes */
+#define FLEXCAN_MBDS(inst)			(FLEXCAN_FD(inst) ? FLEXCAN_CFG_MBDS : FLEXCAN_MBDS_8)
+
+/* Msg buffer payload bytes, total words and count of an instance */
+#define FLEXCAN_MB_PAYLOAD(inst)	(8U << FLEXCAN_MBDS(inst))
+#define FLEXCAN_MB_WORDS(inst)		(2U + (2U << FLEXCAN_MBDS(inst)))
+#define FLEXCAN_MB_COUNT(inst)		(((FLEXCAN_RAM_WORDS(inst) / FLEXCAN_MB_WORDS(inst)) < FLEXCAN_MAX_MB(inst)) \
+									? (FLEXCAN_RAM_WORDS(inst) / FLEXCAN_MB_WORDS(inst)) : FLEXCAN_MAX_MB(inst))
+
+/* Msg buffer mb of an instance */
+#define FLEXCAN_MB(inst, mb)		((volatile flexcan_mb_t *)&FLEXCAN_BASE(inst)->RAMn[(uint32_t)(mb) * FLEXCAN_MB_WORDS(inst)])
+
+/* C/S format bits of an instance: EDL=1, BRS=1 for CAN FD frames */
+#define FLEXCAN_MB_CS_FORMAT(inst)	(FLEXCAN_FD(inst) ? (FLEXCAN_MB_CS_EDL_MASK | FLEXCAN_MB_CS_BRS_MASK) : 0U)
+
+/* C/S word with CODE and DLC in the frame format of an instance */
+#define FLEXCAN_MB_CS(inst, code, dlc)	(FLEXCAN_MB_CS_FORMAT(inst) \
+										| ((uint32_t)(code) << FLEXCAN_MB_CS_CODE_SHIFT) \
+										| (((uint32_t)(dlc) << FLEXCAN_MB_CS_DLC_SHIFT) & FLEXCAN_MB_CS_DLC_MASK))
+
+/* C/S ID bits for a frame ID: SRR=1, IDE=1 for an extended ID */
+#define FLEXCAN_MB_CS_IDE(id)		((0U != ((id) & CAN_ID_EXT_FLAG)) ? (FLEXCAN_MB_CS_SRR_MASK | FLEXCAN_MB_CS_IDE_MASK) : 0U)
+
+/* ID word for a frame ID */
+#define FLEXCAN_MB_ID(id)			((0U != ((id) & CAN_ID_EXT_FLAG)) \
+									? ((id) & FLEXCAN_MB_ID_EXT_MASK) \
+									: (((id) << FLEXCAN_MB_ID_STD_SHIFT) & FLEXCAN_MB_ID_STD_MASK))
+
+/* Frame ID from a C/S word and an ID word */
+#define FLEXCAN_MB_FRAME_ID(cs, id)	((0U != ((cs) & FLEXCAN_MB_CS_IDE_MASK)) \
+									? (((id) & FLEXCAN_MB_ID_EXT_MASK) | CAN_ID_EXT_FLAG) \
+									: (((id) & FLEXCAN_MB_ID_STD_MASK) >> FLEXCAN_MB_ID_STD_SHIFT))
+
+/* Called in each FlexCAN register poll loop. Empty on target. A host register model can define it
+   (before this header, e.g. in its device_registers.h) to advance FRZACK/NOTRDY of the instance */
+#ifndef FLEXCAN_POLL_HOOK
+#define FLEXCAN_POLL_HOOK(pCan)
+#endif
+
+/* Completes an NVIC mask write (ICER) before the next instruction: no CAN interrupt is taken after it.
+   A host register model can define it (before this header) as a compiler barrier */
+#ifndef FLEXCAN_IRQ_BARRIER
+#define FLEXCAN_IRQ_BARRIER()		__asm volatile ("dsb\n\tisb" ::: "memory")
+#endif
+
+#if (0U == FLEXCAN_CFG_FD) && (FLEXCAN_MBDS_8 != FLEXCAN_CFG_MBDS)
+#error "FLEXCAN_CFG_MBDS: classic CAN msg buffers hold 8 bytes"
+#endif
+
+#if (FLEXCAN_CFG_MBDS > FLEXCAN_MBDS_64)
+#error "FLEXCAN_CFG_MBDS: use FLEXCAN_MBDS_8/16/32/64"
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Enter freeze mode.
+* @details          Enable the instance clock, select the CAN clock source and enter freeze mode.
+*					Bit timing is left to the caller.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8Clksrc - 0: oscillator clock, 1: peripheral clock (SYS_CLK).
+* @return           void.
+*/
+void FLEXCAN_enter_freeze(uint8_t u8Inst, uint8_t u8Clksrc);
+
+/**
+* @brief            Leave freeze mode.
+* @details          Write the final MCR value, which negates FRZ/HALT, and wait for the module to be ready.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u32Mcr - MCR value.
+* @return           void.
+*/
+void FLEXCAN_leave_freeze(uint8_t u8Inst, uint32_t u32Mcr);
+
+/**
+* @brief            Reset msg buffers.
+* @details          In freeze mode, clear the whole MB RAM (all CODE=0, inactive) and set every
+*					individual and the global mask to check all ID bits.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @return           void.
+*/
+void FLEXCAN_reset_mbs(uint8_t u8Inst);
+
+
+#endif	/* FLEXCAN_CORE_H */
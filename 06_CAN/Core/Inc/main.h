@@ -15,6 +15,16 @@
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
 #include "clocks_and_modes.h"
 #include "flexcan.h"
+#include "can_ring.h"
+#include "can_tx.h"
+#include "can_isotp.h"
+#include "can_time.h"
+#include "can_lat.h"
+#include "can_stats.h"
+#include "can_err.h"
+#include "can_dma.h"
+#include "can_replay.h"
+#include "can_gw.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
@@ -39,6 +49,11 @@
 /*==================================================================================================
 *                                      GLOBAL VARIABLES
 ==================================================================================================*/
+/* CAN0 received frames, filled by the MB interrupt */
+extern can_ring_t CanRxRing;
+
+/* Milliseconds since start, counted by SysTick */
+extern volatile uint32_t u32TickMs;
 
 /*==================================================================================================
 *                                   LOCAL FUNCTION PROTOTYPES
@@ -51,6 +66,45 @@
 /*==================================================================================================
 *                                       GLOBAL FUNCTIONS
 ==================================================================================================*/
+/**
+* @brief            CAN0 MB 0-15 interrupt.
+* @details          Copy every flagged receive MB (or the RX FIFO) into the receive ring, refill completed transmit MBs.
+* @param        	void.
+* @return           void.
+*/
+void CAN0_ORed_0_15_MB_IRQHandler(void);
+
+/**
+* @brief            CAN0 ORed interrupt.
+* @details          Bus off, bus off done and TX/RX warning events.
+* @param        	void.
+* @return           void.
+*/
+void CAN0_ORed_IRQHandler(void);
+
+/**
+* @brief            CAN0 Error interrupt.
+* @details          Error frames.
+* @param        	void.
+* @return           void.
+*/
+void CAN0_Error_IRQHandler(void);
+
+/**
+* @brief            LPIT0 channel 0 interrupt.
+* @details          Sample the CAN0 TIMER for the 64 bit timebase.
+* @param        	void.
+* @return           void.
+*/
+void LPIT0_Ch0_IRQHandler(void);
+
+/**
+* @brief            SysTick interrupt.
+* @details          Count milliseconds.
+* @param        	void.
+* @return           void.
+*/
+void SysTick_Handler(void);
 
 
 #endif	/* MAIN_H */
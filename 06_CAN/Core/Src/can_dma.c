@@ -0,0 +1,187 @@
+/**
+* @file			can_dma.c
+* @brief		FlexCAN0 RX FIFO draining by eDMA
+* @details		Each FIFO DMA request moves one frame (the 4 words of MB0) into a circular RAM buffer. The
+*				source address wraps inside MB0 (SMOD), the destination wraps at the end of the major loop
+*				(DLASTSGA), and the channel stays enabled (DREQ=0), so the copy never stops. The CPU only
+*				sees the half and full buffer interrupts.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_dma.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Frames the DMA has written in the current pass over the buffer */
+#define CAN_DMA_DONE()		((uint32_t)(DMA->TCD[CAN_DMA_CH].BITER.ELINKNO & DMA_TCD_BITER_ELINKNO_BITER_MASK) \
+							- (uint32_t)(DMA->TCD[CAN_DMA_CH].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Circular frame buffer */
+static can_dma_frame_t *s_pBuf = NULL;
+
+/* Frames per half buffer */
+static uint32_t s_u32Half = 0U;
+
+/* Block callback */
+static can_dma_block_t s_pfBlock = NULL;
+
+/* Half handed out last, NULL before the first one */
+static const can_dma_frame_t *s_pLast = NULL;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* DMA statistics, written by the DMA interrupt */
+volatile can_dma_stats_t CanDmaStats;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            RX FIFO DMA Initialization.
+* @details          Function to set up eDMA channel CAN_DMA_CH as an endless circular copy of the FlexCAN0
+*                   RX FIFO into pBuf: one 16 byte minor loop per frame, a major loop over the whole buffer
+*                   that wraps back to its start, and interrupts at half and full buffer only. Call it before
+*                   FLEXCAN0_init_rx_fifo_dma(), so frames are taken from the first one on.
+* @param[out]       pBuf - Circular frame buffer.
+* @param[in]        u16Frames - Buffer size in frames, even (2-CAN_DMA_MAX_FRAMES).
+* @param[in]        pfBlock - Called with each completed half buffer.
+* @return           void.
+*/
+void can_dma_init(can_dma_frame_t *pBuf, uint16_t u16Frames, can_dma_block_t pfBlock)
+{
+	s_pBuf = pBuf;
+	s_u32Half = (uint32_t)u16Frames / 2U;
+	s_pfBlock = pfBlock;
+	s_pLast = NULL;
+	CanDmaStats.u32Blocks = 0U;
+	CanDmaStats.u32Overruns = 0U;
+
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* CGC=1: enable clock to DMAMUX (eDMA clock is on out of reset) */
+
+	DMA->CERQ = CAN_DMA_CH;								/* Channel requests off while the TCD is written */
+	DMAMUX->CHCFG[CAN_DMA_CH] = 0U;						/* Disable the request routing */
+
+	DMA->TCD[CAN_DMA_CH].SADDR = (uint32_t)&FLEXCAN0_BASE->RAMn[0];		/* RX FIFO output, MB0 word 0 */
+	DMA->TCD[CAN_DMA_CH].SOFF = 4U;										/* Next word of MB0 */
+	DMA->TCD[CAN_DMA_CH].ATTR = DMA_TCD_ATTR_SMOD(4U)		/* SMOD=4: source wraps every 16 bytes, back to MB0 word 0 */
+							  | DMA_TCD_ATTR_SSIZE(2U)		/* SSIZE=2: 32 bit reads */
+							  | DMA_TCD_ATTR_DMOD(0U)		/* DMOD=0: no destination modulo */
+							  | DMA_TCD_ATTR_DSIZE(2U);		/* DSIZE=2: 32 bit writes */
+	DMA->TCD[CAN_DMA_CH].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(CAN_DMA_FRAME_BYTES);	/* Minor loop: one frame */
+	DMA->TCD[CAN_DMA_CH].SLAST = 0U;									/* Source already back at MB0 (SMOD) */
+	DMA->TCD[CAN_DMA_CH].DADDR = (uint32_t)pBuf;
+	DMA->TCD[CAN_DMA_CH].DOFF = 4U;
+	DMA->TCD[CAN_DMA_CH].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(u16Frames);	/* Major loop: whole buffer */
+	DMA->TCD[CAN_DMA_CH].DLASTSGA = (uint32_t)(-(int32_t)((uint32_t)u16Frames * CAN_DMA_FRAME_BYTES));	/* Back to the buffer start */
+	DMA->TCD[CAN_DMA_CH].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(u16Frames);
+	DMA->TCD[CAN_DMA_CH].CSR = DMA_TCD_CSR_INTHALF_MASK		/* INTHALF=1: interrupt at half buffer */
+							 | DMA_TCD_CSR_INTMAJOR_MASK;	/* INTMAJOR=1: interrupt at full buffer */
+															/* DREQ=0: requests stay enabled after the major loop */
+
+	DMAMUX->CHCFG[CAN_DMA_CH] = DMAMUX_CHCFG_SOURCE(CAN_DMA_REQ_FLEXCAN0)	/* Request source: FlexCAN0 */
+							  | DMAMUX_CHCFG_ENBL_MASK;						/* ENBL=1: route it */
+
+	S32_NVIC->ICPR[0] = 1U << (CAN_DMA_CH % 32U);  		/* IRQ0-DMA ch0: clr any pending IRQ*/
+	S32_NVIC->ISER[0] = 1U << (CAN_DMA_CH % 32U);  		/* IRQ0-DMA ch0: enable IRQ */
+	S32_NVIC->IP[CAN_DMA_CH] = CAN_DMA_IRQ_PRIO;		/* IRQ0-DMA ch0: priority 10 of 0-15 */
+
+	DMA->SERQ = CAN_DMA_CH;								/* Channel requests on */
+}
+
+/**
+* @brief            DMA interrupt.
+* @details          Function to hand the half buffer the DMA has just left to the block callback.
+*                   Call it from DMA0_IRQHandler (channel CAN_DMA_CH).
+* @param        	void.
+* @return           void.
+*/
+void can_dma_isr(void)
+{
+	const can_dma_frame_t *pBlock = NULL;
+
+	DMA->CINT = CAN_DMA_CH;								/* Clear the channel interrupt */
+	DMA->CDNE = CAN_DMA_CH;								/* Clear DONE left by the major loop */
+
+	/* The DMA is in the half after the completed one. Late by less than half a buffer, the position
+	   still tells which half completed, whether the half or the major interrupt fired */
+	pBlock = (CAN_DMA_DONE() >= s_u32Half) ? &s_pBuf[0] : &s_pBuf[s_u32Half];
+
+	if (pBlock == s_pLast)
+	{
+		CanDmaStats.u32Overruns++;						/* Interrupt missed a half: the other one was overwritten */
+	}
+	s_pLast = pBlock;
+	CanDmaStats.u32Blocks++;
+
+	if (NULL != s_pfBlock)
+	{
+		s_pfBlock(pBlock, s_u32Half);
+	}
+}
+
+/**
+* @brief            Frames pending.
+* @details          Function to return how many frames the DMA has written to the half in progress,
+*                   for a caller that wants to look at them before the half is complete (e.g. on an idle bus).
+* @param        	void.
+* @return           Number of frames from the start of the current half.
+*/
+uint32_t can_dma_pending(void)
+{
+	uint32_t u32Done = CAN_DMA_DONE();
+
+	return (u32Done >= s_u32Half) ? (u32Done - s_u32Half) : u32Done;
+}
+
+/**
+* @brief            Decode DMA frame.
+* @details          Function to convert a raw DMA frame into a received frame. u8Code holds the index of the
+*                   filter element that accepted it, u8Mb is 0 (RX FIFO output), u64Timestamp is left 0.
+* @param[in]        pRaw - DMA frame.
+* @param[out]       pFrame - Received frame.
+* @return           void.
+*/
+void can_dma_decode(const can_dma_frame_t *pRaw, can_frame_t *pFrame)
+{
+	pFrame->u32Id = FLEXCAN_MB_FRAME_ID(pRaw->CS, pRaw->ID);	/* Standard ID, or extended ID with CAN_ID_EXT_FLAG */
+	pFrame->u8Code = (uint8_t)((pRaw->CS & CAN_DMA_CS_IDHIT_MASK) >> CAN_DMA_CS_IDHIT_SHIFT);
+	pFrame->u8Length = (uint8_t)((pRaw->CS & FLEXCAN_MB_CS_DLC_MASK) >> FLEXCAN_MB_CS_DLC_SHIFT);
+	pFrame->u16Timestamp = (uint16_t)(pRaw->CS & FLEXCAN_MB_CS_TIME_MASK);
+	pFrame->u32Data[0] = pRaw->DATA[0];
+	pFrame->u32Data[1] = pRaw->DATA[1];
+	pFrame->u64Timestamp = 0U;
+	pFrame->u8Mb = 0U;
+}
+
+
+/* END can_dma */
@@ -0,0 +1,258 @@
+/**
+* @file			can_err.c
+* @brief		CAN0 error handling
+* @details		Follows the fault confinement state from the ESR1 interrupts (error, TX/RX warning, bus off,
+*				bus off done), counts the error events and controls the bus off recovery. Without it a
+*				node that went bus off with BOFFREC=1, or whose error flags were never cleared, needed a
+*				reset to receive again.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <string.h>
+#include "can_err.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* IRQ78-CAN0 ORed and IRQ79-CAN0 Error: masked while the state is updated from thread mode, DSB/ISB as
+   in can_tx.c so neither can be taken after the ICER write */
+#define CAN_ERR_IRQ_BITS	((1U << (78 % 32)) | (1U << (79 % 32)))
+#define CAN_ERR_LOCK()		do { S32_NVIC->ICER[2] = CAN_ERR_IRQ_BITS; FLEXCAN_IRQ_BARRIER(); } while (0)
+#define CAN_ERR_UNLOCK()	(S32_NVIC->ISER[2] = CAN_ERR_IRQ_BITS)
+
+/* ESR1 interrupt flags (write 1 to clear) */
+#define CAN_ERR_ESR1_FLAGS	(CAN_ESR1_ERRINT_MASK | CAN_ESR1_BOFFINT_MASK | CAN_ESR1_RWRNINT_MASK \
+							| CAN_ESR1_TWRNINT_MASK | CAN_ESR1_BOFFDONEINT_MASK | CAN_ESR1_ERROVR_MASK)
+
+/* Error counter levels of the warning and error passive states */
+#define CAN_ERR_WARNING_LEVEL	(96U)
+#define CAN_ERR_PASSIVE_LEVEL	(128U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* State change callback */
+static can_err_callback_t s_pfCallback = NULL;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* CAN0 error state and counters */
+volatile can_err_t CanErr;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint8_t can_err_state(void);
+static void can_err_set_state(uint8_t u8State);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Current state.
+* @details          Error active / warning / passive from the ECR error counters, bus off from a bus off
+*                   without its bus off done. ECR is read instead of ESR1, so the error type bits (clear on
+*                   read) are left to the interrupt.
+* @param        	void.
+* @return           CAN_ERR_xxx state.
+*/
+static uint8_t can_err_state(void)
+{
+	uint32_t u32Ecr = FLEXCAN0_BASE->ECR;
+	uint32_t u32Tx = (u32Ecr & CAN_ECR_TXERRCNT_MASK) >> CAN_ECR_TXERRCNT_SHIFT;
+	uint32_t u32Rx = (u32Ecr & CAN_ECR_RXERRCNT_MASK) >> CAN_ECR_RXERRCNT_SHIFT;
+
+	if (CanErr.u32Recoveries != CanErr.u32BusOff)
+	{
+		return CAN_ERR_BUS_OFF;							/* Bus off until BOFFDONEINT */
+	}
+	if ((u32Tx >= CAN_ERR_PASSIVE_LEVEL) || (u32Rx >= CAN_ERR_PASSIVE_LEVEL))
+	{
+		return CAN_ERR_PASSIVE;
+	}
+	if ((u32Tx >= CAN_ERR_WARNING_LEVEL) || (u32Rx >= CAN_ERR_WARNING_LEVEL))
+	{
+		return CAN_ERR_WARNING;
+	}
+	return CAN_ERR_ACTIVE;
+}
+
+/**
+* @brief            Set state.
+* @details          Store a new state and report the change.
+* @param[in]        u8State - CAN_ERR_xxx state.
+* @return           void.
+*/
+static void can_err_set_state(uint8_t u8State)
+{
+	if (u8State != CanErr.u8State)
+	{
+		CanErr.u8State = u8State;
+		if (NULL != s_pfCallback)
+		{
+			s_pfCallback(u8State);
+		}
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Error handling Initialization.
+* @details          Function to clear the counters, select the bus off recovery and enable the bus off,
+*                   bus off done, warning and error interrupts of FLEXCAN0 (IRQ78, IRQ79). Call it after
+*                   FLEXCAN0 is initialized.
+* @param[in]        u8Recovery - CAN_ERR_RECOVER_AUTO or CAN_ERR_RECOVER_MANUAL.
+* @param[in]        pfCallback - State change callback, NULL for none.
+* @return           void.
+*/
+void can_err_init(uint8_t u8Recovery, can_err_callback_t pfCallback)
+{
+	(void)memset((void *)&CanErr, 0, sizeof(CanErr));
+	CanErr.u8Recovery = u8Recovery;
+	s_pfCallback = pfCallback;
+
+	FLEXCAN0_enable_error_interrupts(u8Recovery);
+	FLEXCAN0_BASE->ESR1 = CAN_ERR_ESR1_FLAGS;			/* Clear stale flags (write 1 to clear) */
+
+	S32_NVIC->ICPR[2] = (1U << (78 % 32)) | (1U << (79 % 32));	/* IRQ78-CAN0 ORed, IRQ79-CAN0 Error: clr any pending IRQ */
+	S32_NVIC->IP[78] = CAN_ERR_IRQ_PRIO;				/* IRQ78-CAN0 ORed: bus off, bus off done, warnings */
+	S32_NVIC->IP[79] = CAN_ERR_IRQ_PRIO;				/* IRQ79-CAN0 Error: error frames */
+	CAN_ERR_UNLOCK();									/* Enable both IRQs */
+}
+
+/**
+* @brief            Error interrupt.
+* @details          Function to count and clear the ESR1 events and update the state. Call it from
+*                   CAN0_ORed_IRQHandler and CAN0_Error_IRQHandler.
+* @param        	void.
+* @return           void.
+*/
+void can_err_isr(void)
+{
+	uint32_t u32Esr1 = FLEXCAN0_BASE->ESR1;				/* Read clears the error type bits */
+	uint64_t u64Now = 0U;
+
+	FLEXCAN0_BASE->ESR1 = u32Esr1 & CAN_ERR_ESR1_FLAGS;	/* Clear the handled flags only */
+
+	if (0U != (u32Esr1 & CAN_ESR1_ERRINT_MASK))
+	{
+		CanErr.u32ErrorFrames++;
+		CanErr.u32StuffErrors += (0U != (u32Esr1 & CAN_ESR1_STFERR_MASK)) ? 1U : 0U;
+		CanErr.u32FormErrors += (0U != (u32Esr1 & CAN_ESR1_FRMERR_MASK)) ? 1U : 0U;
+		CanErr.u32CrcErrors += (0U != (u32Esr1 & CAN_ESR1_CRCERR_MASK)) ? 1U : 0U;
+		CanErr.u32AckErrors += (0U != (u32Esr1 & CAN_ESR1_ACKERR_MASK)) ? 1U : 0U;
+		CanErr.u32BitErrors += (0U != (u32Esr1 & (CAN_ESR1_BIT0ERR_MASK | CAN_ESR1_BIT1ERR_MASK))) ? 1U : 0U;
+	}
+	if (0U != (u32Esr1 & CAN_ESR1_ERROVR_MASK))
+	{
+		CanErr.u32ErrorOverruns++;						/* A second error came before ESR1 was read */
+	}
+	if (0U != (u32Esr1 & (CAN_ESR1_TWRNINT_MASK | CAN_ESR1_RWRNINT_MASK)))
+	{
+		CanErr.u32Warnings++;
+	}
+
+	if (0U != (u32Esr1 & CAN_ESR1_BOFFINT_MASK))
+	{
+		CanErr.u32BusOff++;
+		CanErr.u64BusOffTime = can_time_now();
+		can_err_set_state(CAN_ERR_BUS_OFF);
+	}
+	if ((0U != (u32Esr1 & CAN_ESR1_BOFFDONEINT_MASK)) && (CanErr.u32Recoveries != CanErr.u32BusOff))
+	{
+		u64Now = can_time_now();
+		CanErr.u32Recoveries++;							/* Back on the bus, ECR is cleared */
+		CanErr.u64LastRecovery = u64Now - CanErr.u64BusOffTime;
+		if (CanErr.u64LastRecovery > CanErr.u64MaxRecovery)
+		{
+			CanErr.u64MaxRecovery = CanErr.u64LastRecovery;
+		}
+		if (CAN_ERR_RECOVER_MANUAL == CanErr.u8Recovery)
+		{
+			FLEXCAN0_set_bus_off_recovery(1U);			/* Hold the next bus off again */
+		}
+	}
+
+	can_err_set_state(can_err_state());
+}
+
+/**
+* @brief            Update state.
+* @details          Function to follow the error counters back down: leaving error passive or warning
+*                   raises no interrupt. Thread mode, e.g. once per statistics period.
+* @param        	void.
+* @return           CAN_ERR_xxx state.
+*/
+uint8_t can_err_poll(void)
+{
+	CAN_ERR_LOCK();
+	can_err_set_state(can_err_state());
+	CAN_ERR_UNLOCK();
+
+	return CanErr.u8State;
+}
+
+/**
+* @brief            Start bus off recovery.
+* @details          Function to let FLEXCAN0 rejoin the bus in manual recovery: BOFFREC is negated until
+*                   the 128 x 11 recessive bits are seen, then set again by the interrupt.
+* @param        	void.
+* @return           1 if a recovery was started, 0 if not bus off or in automatic recovery.
+*/
+uint8_t can_err_recover(void)
+{
+	uint8_t u8Started = 0U;
+
+	CAN_ERR_LOCK();
+	if ((CAN_ERR_RECOVER_MANUAL == CanErr.u8Recovery) && (CAN_ERR_BUS_OFF == CanErr.u8State))
+	{
+		FLEXCAN0_set_bus_off_recovery(0U);				/* BOFFREC=0: count 128 x 11 recessive bits, rejoin */
+		u8Started = 1U;
+	}
+	CAN_ERR_UNLOCK();
+
+	return u8Started;
+}
+
+/**
+* @brief            Re-arm overrun msg buffer.
+* @details          Function to set a receive MB that reported CODE=OVERRUN back to EMPTY and count it.
+*                   Called from the CAN0 MB interrupt after the MB is read and unlocked. The C/S read
+*                   locks the MB again, TIMER is read to release it.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @return           void.
+*/
+void can_err_rearm_mb(uint8_t u8Mb)
+{
+	volatile flexcan_mb_t *pMb = FLEXCAN_MB(FLEXCAN0_INST, u8Mb);
+	uint32_t dummy = 0U;
+
+	pMb->CS = (pMb->CS & FLEXCAN_MB_CS_IDE_MASK)		/* Keep IDE, it is part of the filter */
+			| ((uint32_t)FLEXCAN_RX_EMPTY << FLEXCAN_MB_CS_CODE_SHIFT);
+	dummy = FLEXCAN0_BASE->TIMER;						/* Read TIMER to unlock the msg buffer */
+	(void)dummy;
+	CanErr.u32MbOverruns++;
+}
+
+
+/* END can_err */
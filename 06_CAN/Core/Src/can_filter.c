@@ -0,0 +1,194 @@
+/**
+* @file			can_filter.c
+* @brief		Acceptance filter planner
+* @details		Compiles a list of wanted IDs into receive MB IDs and individual masks (RXIMR), so the
+*				controller drops unwanted frames instead of the CPU.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_filter.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Full ID mask of a filter ID */
+#define CAN_FILTER_FULL_MASK(id)	((0U != ((id) & CAN_ID_EXT_FLAG)) ? CAN_FILTER_EXT_MASK : CAN_FILTER_STD_MASK)
+
+/* ID matches filter ID and mask, including the ID type */
+#define CAN_FILTER_MATCH(id, fid, mask)	((((id) ^ (fid)) & ((mask) | CAN_ID_EXT_FLAG)) == 0U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint32_t can_filter_false_accepts(const uint32_t *pu32Ids, uint8_t u8Count, uint32_t u32Id, uint32_t u32Mask);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Count false accepts.
+* @param[in]        pu32Ids - Wanted IDs, no duplicates.
+* @param[in]        u8Count - Number of IDs.
+* @param[in]        u32Id - Filter ID.
+* @param[in]        u32Mask - Filter mask.
+* @return           IDs accepted by the filter minus the wanted IDs among them.
+*/
+static uint32_t can_filter_false_accepts(const uint32_t *pu32Ids, uint8_t u8Count, uint32_t u32Id, uint32_t u32Mask)
+{
+	uint32_t u32Free = CAN_FILTER_FULL_MASK(u32Id) & ~u32Mask;	/* Don't care bits */
+	uint32_t u32Accepted = 1U;
+	uint8_t u8Index = 0U;
+
+	while (0U != u32Free)
+	{
+		u32Accepted <<= 1U;									/* 2^(don't care bits) */
+		u32Free &= u32Free - 1U;
+	}
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		if (CAN_FILTER_MATCH(pu32Ids[u8Index], u32Id, u32Mask))
+		{
+			u32Accepted--;
+		}
+	}
+	return u32Accepted;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Plan acceptance filters.
+* @details          Function to cover a set of wanted IDs with at most u8Budget masked filters (one
+*                   receive MB each). Starting from one exact filter per ID, the two filters whose merge
+*                   lets the fewest unwanted IDs through are merged until the budget is met. Standard
+*                   and extended IDs never share a filter. Runs in O(n^3) per merge, call it at init.
+* @param[in]        pu32Ids - Wanted IDs, CAN_ID_EXT_FLAG for extended IDs. Duplicates are allowed.
+* @param[in]        u8Count - Number of IDs (1 to CAN_FILTER_MAX_IDS).
+* @param[in]        u8Budget - Number of filters available.
+* @param[out]       pFilters - Filters, u8Budget entries.
+* @return           Number of filters used, 0 if the set is too large or the budget is smaller than
+*                   the number of ID types (standard / extended) in the set.
+*/
+uint8_t can_filter_plan(const uint32_t *pu32Ids, uint8_t u8Count, uint8_t u8Budget, can_filter_t *pFilters)
+{
+	uint32_t au32Ids[CAN_FILTER_MAX_IDS];					/* Wanted IDs without duplicates */
+	uint32_t au32FilterId[CAN_FILTER_MAX_IDS];
+	uint32_t au32FilterMask[CAN_FILTER_MAX_IDS];
+	uint8_t u8Ids = 0U;
+	uint8_t u8Filters = 0U;
+	uint8_t u8I = 0U;
+	uint8_t u8J = 0U;
+	uint8_t u8BestI = 0U;
+	uint8_t u8BestJ = 0U;
+	uint32_t u32BestCost = 0U;
+	uint32_t u32Cost = 0U;
+	uint32_t u32Mask = 0U;
+	uint32_t u32Id = 0U;
+
+	if ((0U == u8Count) || (u8Count > CAN_FILTER_MAX_IDS))
+	{
+		return 0U;
+	}
+
+	for (u8I = 0U; u8I < u8Count; u8I++)					/* One exact filter per distinct ID */
+	{
+		u32Id = pu32Ids[u8I] & (CAN_ID_EXT_FLAG | CAN_FILTER_FULL_MASK(pu32Ids[u8I]));
+		u8J = 0U;
+		while ((u8J < u8Ids) && (au32Ids[u8J] != u32Id))
+		{
+			u8J++;
+		}
+		if (u8J == u8Ids)
+		{
+			au32Ids[u8Ids] = u32Id;
+			au32FilterId[u8Ids] = u32Id;
+			au32FilterMask[u8Ids] = CAN_FILTER_FULL_MASK(u32Id);
+			u8Ids++;
+		}
+	}
+	u8Filters = u8Ids;
+
+	while (u8Filters > u8Budget)
+	{
+		u32BestCost = 0xFFFFFFFFU;
+		u8BestI = u8Filters;
+		for (u8I = 0U; u8I < u8Filters; u8I++)				/* Cheapest merge of two filters of the same ID type */
+		{
+			for (u8J = u8I + 1U; u8J < u8Filters; u8J++)
+			{
+				if (0U != ((au32FilterId[u8I] ^ au32FilterId[u8J]) & CAN_ID_EXT_FLAG))
+				{
+					continue;
+				}
+				u32Mask = au32FilterMask[u8I] & au32FilterMask[u8J] & ~(au32FilterId[u8I] ^ au32FilterId[u8J]);
+				u32Cost = can_filter_false_accepts(au32Ids, u8Ids, au32FilterId[u8I], u32Mask);
+				if (u32Cost < u32BestCost)
+				{
+					u32BestCost = u32Cost;
+					u8BestI = u8I;
+					u8BestJ = u8J;
+				}
+			}
+		}
+		if (u8BestI == u8Filters)
+		{
+			return 0U;										/* Only one standard and one extended filter left */
+		}
+
+		u32Mask = au32FilterMask[u8BestI] & au32FilterMask[u8BestJ] & ~(au32FilterId[u8BestI] ^ au32FilterId[u8BestJ]);
+		u32Id = au32FilterId[u8BestI] & (u32Mask | CAN_ID_EXT_FLAG);
+		au32FilterId[u8BestI] = u32Id;
+		au32FilterMask[u8BestI] = u32Mask;
+
+		u8J = 0U;											/* Drop filters the merged one covers, BestJ included */
+		for (u8I = 0U; u8I < u8Filters; u8I++)
+		{
+			if ((u8I != u8BestI) && (0U == (u32Mask & ~au32FilterMask[u8I]))
+				&& CAN_FILTER_MATCH(au32FilterId[u8I], u32Id, u32Mask))
+			{
+				continue;
+			}
+			au32FilterId[u8J] = au32FilterId[u8I];
+			au32FilterMask[u8J] = au32FilterMask[u8I];
+			u8J++;
+		}
+		u8Filters = u8J;
+	}
+
+	for (u8I = 0U; u8I < u8Filters; u8I++)
+	{
+		pFilters[u8I].u32Id = au32FilterId[u8I];
+		pFilters[u8I].u32Mask = au32FilterMask[u8I];
+		pFilters[u8I].u32FalseAccepts = can_filter_false_accepts(au32Ids, u8Ids, au32FilterId[u8I], au32FilterMask[u8I]);
+	}
+	return u8Filters;
+}
+
+
+/* END can_filter */
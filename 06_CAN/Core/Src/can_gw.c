@@ -0,0 +1,299 @@
+/**
+* @file			can_gw.c
+* @brief		CAN0/CAN1/CAN2 gateway
+* @details		Routes frames between the FlexCAN instances through a sorted table of ID ranges with
+*				optional ID translation and rate limits. Frames move from the RX FIFO output MB to the
+*				transmit MBs register to register, without a copy in RAM.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_gw.h"
+#include "flexcan_timing.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Msg buf word 0 RTR bit: remote frame */
+#define CAN_GW_CS_RTR_MASK		(0x00100000U)
+
+/* No free transmit MB */
+#define CAN_GW_NO_MB			(0xFFU)
+
+/* Msg buffer mb of a variable instance (all gateway instances use 8 byte MBs) */
+#define CAN_GW_MB(pCan, mb)		((volatile flexcan_mb_t *)&(pCan)->RAMn[(uint32_t)(mb) * 4U])
+
+#if (0U != FLEXCAN_CFG_FD)
+#error "can_gw: the gateway runs classic CAN frames (8 byte msg buffers) on all instances"
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Instance base addresses */
+static CAN_Type * const s_apCan[FLEXCAN_INSTANCE_COUNT] = CAN_BASE_PTRS;
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Routing table */
+static const can_gw_route_t *s_pRoutes = NULL;
+static uint8_t s_u8RouteCount = 0U;
+
+/* Time of the last forwarded frame per route */
+static uint32_t *s_pu32LastMs = NULL;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* Gateway counters */
+can_gw_stats_t CanGwStats;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static int32_t can_gw_lookup(uint8_t u8Src, uint32_t u32Id);
+static uint8_t can_gw_free_mb(CAN_Type *pCan, uint32_t u32Id);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Find route.
+* @details          Binary search for the last route starting at or before (u8Src, u32Id).
+* @param[in]        u8Src - Source instance.
+* @param[in]        u32Id - Frame ID.
+* @return           Route index, -1 if no range holds the ID.
+*/
+static int32_t can_gw_lookup(uint8_t u8Src, uint32_t u32Id)
+{
+	int32_t s32Low = 0;
+	int32_t s32High = (int32_t)s_u8RouteCount - 1;
+	int32_t s32Mid = 0;
+	int32_t s32Found = -1;
+
+	while (s32Low <= s32High)
+	{
+		s32Mid = (s32Low + s32High) / 2;
+		if ((s_pRoutes[s32Mid].u8Src < u8Src)
+			|| ((s_pRoutes[s32Mid].u8Src == u8Src) && (s_pRoutes[s32Mid].u32IdLow <= u32Id)))
+		{
+			s32Found = s32Mid;								/* Candidate, look for a later start */
+			s32Low = s32Mid + 1;
+		}
+		else
+		{
+			s32High = s32Mid - 1;
+		}
+	}
+
+	if ((s32Found >= 0) && (s_pRoutes[s32Found].u8Src == u8Src) && (u32Id <= s_pRoutes[s32Found].u32IdHigh))
+	{
+		return s32Found;
+	}
+	return -1;
+}
+
+/**
+* @brief            Find free transmit MB.
+* @details          An MB is free when its CODE is back to TX inactive. A frame whose ID is still pending
+*                   in another MB waits, so frames with the same ID leave in order.
+* @param[in]        pCan - Destination instance.
+* @param[in]        u32Id - ID to send.
+* @return           MB number, CAN_GW_NO_MB if none.
+*/
+static uint8_t can_gw_free_mb(CAN_Type *pCan, uint32_t u32Id)
+{
+	uint8_t u8Free = CAN_GW_NO_MB;
+	uint8_t u8Mb = 0U;
+	uint32_t u32Cs = 0U;
+
+	for (u8Mb = CAN_GW_TX_MB_FIRST; u8Mb < (CAN_GW_TX_MB_FIRST + CAN_GW_TX_MB_COUNT); u8Mb++)
+	{
+		u32Cs = CAN_GW_MB(pCan, u8Mb)->CS;
+		if (FLEXCAN_TX_INACTIVE == ((u32Cs & FLEXCAN_MB_CS_CODE_MASK) >> FLEXCAN_MB_CS_CODE_SHIFT))
+		{
+			if (CAN_GW_NO_MB == u8Free)
+			{
+				u8Free = u8Mb;
+			}
+		}
+		else if (u32Id == FLEXCAN_MB_FRAME_ID(u32Cs, CAN_GW_MB(pCan, u8Mb)->ID))
+		{
+			return CAN_GW_NO_MB;							/* Same ID pending: keep order */
+		}
+	}
+	return u8Free;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Gateway controller Initialization.
+* @details          Function to initialize a FlexCAN instance for the gateway: FLEXCAN0 bit timing,
+*                   RX FIFO accepting every ID (keeps the arrival order), transmit MBs CAN_GW_TX_MB_FIRST on,
+*                   self reception off. No interrupt is enabled. Pins and transceivers of CAN1/CAN2 are set
+*                   up by the caller.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @return           void.
+*/
+void can_gw_init_controller(uint8_t u8Inst)
+{
+	CAN_Type *pCan = s_apCan[u8Inst];
+	uint8_t u8Index = 0U;
+
+	FLEXCAN_enter_freeze(u8Inst, 0U);					/* CLKSRC=0: Clock Source = oscillator (8 MHz) */
+
+	pCan->CTRL1 = FLEXCAN_CTRL1_TIMING(FLEXCAN0_CLK_HZ, FLEXCAN0_BITRATE, FLEXCAN0_SAMPLE_POINT)
+				| CAN_CTRL1_SMP(1U);        			/* Same bit timing as CAN0 */
+
+	FLEXCAN_reset_mbs(u8Inst);							/* Clear msg bufs, masks check all bits */
+
+	for (u8Index = 0U; u8Index < 8U; u8Index++)
+	{
+		pCan->RAMn[6U*4U + u8Index] = 0U;				/* Filter table (MB6-MB7): 8 elements, any ID */
+		pCan->RXIMR[u8Index] = 0U;						/* Individual masks: don't care */
+	}
+	pCan->RXFGMASK = 0U;								/* FIFO global mask: don't care */
+
+	for (u8Index = CAN_GW_TX_MB_FIRST; u8Index < (CAN_GW_TX_MB_FIRST + CAN_GW_TX_MB_COUNT); u8Index++)
+	{
+		CAN_GW_MB(pCan, u8Index)->CS = (uint32_t)FLEXCAN_TX_INACTIVE << FLEXCAN_MB_CS_CODE_SHIFT;	/* CODE=8: TX inactive */
+	}
+
+	FLEXCAN_leave_freeze(u8Inst, CAN_MCR_RFEN_MASK		/* RFEN=1: legacy RX FIFO enabled, RFFN=0 */
+								| CAN_MCR_IRMQ_MASK		/* IRMQ=1: individual masks */
+								| CAN_MCR_SRXDIS_MASK	/* SRXDIS=1: forwarded frames are not received back */
+								| CAN_MCR_MAXMB(CAN_GW_TX_MB_FIRST + CAN_GW_TX_MB_COUNT - 1U));
+}
+
+/**
+* @brief            Gateway Initialization.
+* @details          Function to install the routing table and clear the counters.
+* @param[in]        pRoutes - Routes sorted by (u8Src, u32IdLow), ranges of one source must not overlap.
+* @param[in]        u8Count - Number of routes.
+* @param[out]       pu32LastMs - Rate limit state, one word per route.
+* @return           void.
+*/
+void can_gw_init(const can_gw_route_t *pRoutes, uint8_t u8Count, uint32_t *pu32LastMs)
+{
+	uint8_t u8Index = 0U;
+
+	s_pRoutes = pRoutes;
+	s_u8RouteCount = u8Count;
+	s_pu32LastMs = pu32LastMs;
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		s_pu32LastMs[u8Index] = 0U - (uint32_t)pRoutes[u8Index].u16MinGapMs;	/* First frame passes */
+	}
+
+	CanGwStats.u32Forwarded = 0U;
+	CanGwStats.u32NoRoute = 0U;
+	CanGwStats.u32RateLimited = 0U;
+	CanGwStats.u32FifoOverflow = 0U;
+}
+
+/**
+* @brief            Service gateway instance.
+* @details          Function to forward the frames waiting in the RX FIFO of an instance. Each frame is
+*                   copied from the FIFO output MB straight into a transmit MB of every destination. A
+*                   frame stays in the FIFO while a destination has no free MB (or a pending frame with
+*                   the same ID) and is retried on the next call. Call it from the main loop: the gateway
+*                   enables no interrupt, and a FIFO interrupt would stay pending while a frame waits.
+* @param[in]        u8Inst - Source FlexCAN instance (0-2).
+* @param[in]        u32NowMs - Current time in ms, for the rate limits.
+* @return           void.
+*/
+void can_gw_service(uint8_t u8Inst, uint32_t u32NowMs)
+{
+	CAN_Type *pCan = s_apCan[u8Inst];
+	volatile flexcan_mb_t *pSrc = CAN_GW_MB(pCan, 0U);	/* FIFO output */
+	volatile flexcan_mb_t *pDst = NULL;
+	const can_gw_route_t *pRoute = NULL;
+	uint8_t au8Mb[FLEXCAN_INSTANCE_COUNT];
+	uint32_t u32Cs = 0U;
+	uint32_t u32Id = 0U;
+	uint32_t u32NewId = 0U;
+	int32_t s32Route = 0;
+	uint8_t u8Dst = 0U;
+	uint32_t dummy = 0U;
+
+	if (0U != (pCan->IFLAG1 & FLEXCAN_FIFO_OVERFLOW_FLAG))
+	{
+		CanGwStats.u32FifoOverflow++;
+		pCan->IFLAG1 = FLEXCAN_FIFO_OVERFLOW_FLAG | FLEXCAN_FIFO_WARNING_FLAG;
+	}
+
+	while (0U != (pCan->IFLAG1 & FLEXCAN_FIFO_AVAILABLE_FLAG))
+	{
+		u32Cs = pSrc->CS;								/* Locks the FIFO output */
+		u32Id = FLEXCAN_MB_FRAME_ID(u32Cs, pSrc->ID);
+		s32Route = (0U != (u32Cs & CAN_GW_CS_RTR_MASK)) ? -1 : can_gw_lookup(u8Inst, u32Id);
+
+		if (s32Route < 0)
+		{
+			CanGwStats.u32NoRoute++;
+		}
+		else if ((u32NowMs - s_pu32LastMs[s32Route]) < s_pRoutes[s32Route].u16MinGapMs)
+		{
+			CanGwStats.u32RateLimited++;
+		}
+		else
+		{
+			pRoute = &s_pRoutes[s32Route];
+			u32NewId = (CAN_GW_KEEP_ID == pRoute->u32IdNew) ? u32Id : (pRoute->u32IdNew + (u32Id - pRoute->u32IdLow));
+
+			for (u8Dst = 0U; u8Dst < FLEXCAN_INSTANCE_COUNT; u8Dst++)	/* All destinations need a free MB */
+			{
+				au8Mb[u8Dst] = CAN_GW_NO_MB;
+				if (0U != (pRoute->u8DstMask & CAN_GW_DST(u8Dst)))
+				{
+					au8Mb[u8Dst] = can_gw_free_mb(s_apCan[u8Dst], u32NewId);
+					if (CAN_GW_NO_MB == au8Mb[u8Dst])
+					{
+						dummy = pCan->TIMER;				/* Unlock, frame stays in the FIFO */
+						(void)dummy;
+						return;
+					}
+				}
+			}
+
+			for (u8Dst = 0U; u8Dst < FLEXCAN_INSTANCE_COUNT; u8Dst++)
+			{
+				if (CAN_GW_NO_MB != au8Mb[u8Dst])
+				{
+					pDst = CAN_GW_MB(s_apCan[u8Dst], au8Mb[u8Dst]);
+					s_apCan[u8Dst]->IFLAG1 = 1UL << au8Mb[u8Dst];		/* Clear flag of the previous frame */
+					pDst->DATA[0] = pSrc->DATA[0];					/* MB to MB, no copy in RAM */
+					pDst->DATA[1] = pSrc->DATA[1];
+					pDst->ID = FLEXCAN_MB_ID(u32NewId);
+					pDst->CS = ((uint32_t)FLEXCAN_TX_DATA << FLEXCAN_MB_CS_CODE_SHIFT)	/* CODE=0xC: transmit */
+							 | FLEXCAN_MB_CS_IDE(u32NewId)
+							 | (u32Cs & FLEXCAN_MB_CS_DLC_MASK);
+				}
+			}
+			s_pu32LastMs[s32Route] = u32NowMs;
+			CanGwStats.u32Forwarded++;
+		}
+
+		dummy = pCan->TIMER;							/* Unlock the FIFO output */
+		(void)dummy;
+		pCan->IFLAG1 = FLEXCAN_FIFO_AVAILABLE_FLAG;		/* Release output, next frame moves up */
+	}
+}
+
+
+/* END can_gw */
@@ -0,0 +1,651 @@
+/**
+* @file			can_isotp.c
+* @brief		ISO 15765-2 (ISO-TP) transport layer
+* @details		Segments messages into single, first and consecutive frames and reassembles them
+*				with flow control. Frames are sent through the link send function and fed in with
+*				can_isotp_rx_frame(), so the layer works on classic (8 byte) and CAN FD frames.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <string.h>
+#include "can_isotp.h"
+#include "can_tx.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Protocol control information, high nibble of byte 0 */
+#define ISOTP_PCI_SF			(0x00U)		/* Single frame */
+#define ISOTP_PCI_FF			(0x10U)		/* First frame */
+#define ISOTP_PCI_CF			(0x20U)		/* Consecutive frame */
+#define ISOTP_PCI_FC			(0x30U)		/* Flow control */
+
+/* Flow status of a flow control frame */
+#define ISOTP_FS_CTS			(0U)		/* Continue to send */
+#define ISOTP_FS_WAIT			(1U)		/* Wait */
+#define ISOTP_FS_OVFLW			(2U)		/* Overflow, abort */
+
+/* Largest SF_DL with the one byte PCI */
+#define ISOTP_SF_CLASSIC_MAX	(7U)
+
+/* Largest FF_DL with the 12 bit length field */
+#define ISOTP_FF_DL_12BIT_MAX	(4095U)
+
+/* Classic CAN frame length, also the smallest padded frame */
+#define ISOTP_CLASSIC_DL		(8U)
+
+/* Largest CAN FD frame length */
+#define ISOTP_MAX_DL			(64U)
+
+/* Time a is at or after time b (wrap safe) */
+#define ISOTP_TIME_REACHED(a, b)	((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* CAN FD frame lengths above 8 bytes */
+static const uint8_t s_au8FdLength[7U] = {12U, 16U, 20U, 24U, 32U, 48U, 64U};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint8_t can_isotp_frame_length(uint8_t u8Needed);
+static uint32_t can_isotp_stmin_us(uint8_t u8StMin);
+static uint8_t can_isotp_transmit(can_isotp_t *pLink, uint8_t *pu8Frame, uint8_t u8Used, uint8_t u8Length);
+static void can_isotp_send_fc(can_isotp_t *pLink, uint8_t u8Status);
+static void can_isotp_rx_end(can_isotp_t *pLink, uint32_t u32Length, uint8_t u8Result);
+static void can_isotp_tx_end(can_isotp_t *pLink, uint8_t u8Result);
+static void can_isotp_tx_first(can_isotp_t *pLink, uint32_t u32NowUs);
+static void can_isotp_tx_consecutive(can_isotp_t *pLink, uint32_t u32NowUs);
+static void can_isotp_rx_single(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length);
+static void can_isotp_rx_first(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs);
+static void can_isotp_rx_consecutive(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs);
+static void can_isotp_rx_flow_control(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Padded frame length.
+* @details          Smallest valid CAN frame length holding u8Needed bytes, at least 8 (frames are
+*                   always padded to the classic length).
+* @param[in]        u8Needed - Bytes used in the frame (1-64).
+* @return           Frame length.
+*/
+static uint8_t can_isotp_frame_length(uint8_t u8Needed)
+{
+	uint8_t u8Index = 0U;
+
+	if (u8Needed <= ISOTP_CLASSIC_DL)
+	{
+		return ISOTP_CLASSIC_DL;
+	}
+	while (s_au8FdLength[u8Index] < u8Needed)
+	{
+		u8Index++;
+	}
+	return s_au8FdLength[u8Index];
+}
+
+/**
+* @brief            Decode STmin.
+* @param[in]        u8StMin - STmin byte: 0x00-0x7F ms, 0xF1-0xF9 100-900 us, reserved values 127 ms.
+* @return           Separation time in microseconds.
+*/
+static uint32_t can_isotp_stmin_us(uint8_t u8StMin)
+{
+	if (u8StMin <= 0x7FU)
+	{
+		return (uint32_t)u8StMin * 1000U;
+	}
+	if ((u8StMin >= 0xF1U) && (u8StMin <= 0xF9U))
+	{
+		return ((uint32_t)u8StMin - 0xF0U) * 100U;
+	}
+	return 127000U;
+}
+
+/**
+* @brief            Pad and send frame.
+* @param[in]        pLink - Link.
+* @param[in,out]    pu8Frame - Frame, bytes from u8Used on are padded.
+* @param[in]        u8Used - Bytes filled in.
+* @param[in]        u8Length - Frame length.
+* @return           1 if the frame was accepted.
+*/
+static uint8_t can_isotp_transmit(can_isotp_t *pLink, uint8_t *pu8Frame, uint8_t u8Used, uint8_t u8Length)
+{
+	(void)memset(&pu8Frame[u8Used], pLink->cfg.u8Padding, (uint32_t)u8Length - u8Used);
+	return pLink->cfg.pfSend(pLink->cfg.u32TxId, pu8Frame, u8Length);
+}
+
+/**
+* @brief            Send flow control.
+* @details          A lost FC is recovered by the peer N_Bs timeout, so the send result is not checked.
+* @param[in]        pLink - Link.
+* @param[in]        u8Status - Flow status (ISOTP_FS_xxx).
+* @return           void.
+*/
+static void can_isotp_send_fc(can_isotp_t *pLink, uint8_t u8Status)
+{
+	uint8_t au8Frame[ISOTP_CLASSIC_DL];
+
+	au8Frame[0] = ISOTP_PCI_FC | u8Status;
+	au8Frame[1] = pLink->cfg.u8BlockSize;
+	au8Frame[2] = pLink->cfg.u8StMin;
+	(void)can_isotp_transmit(pLink, au8Frame, 3U, ISOTP_CLASSIC_DL);
+}
+
+/**
+* @brief            End reception.
+* @param[in,out]    pLink - Link.
+* @param[in]        u32Length - Message length, 0 on error.
+* @param[in]        u8Result - CAN_ISOTP_xxx.
+* @return           void.
+*/
+static void can_isotp_rx_end(can_isotp_t *pLink, uint32_t u32Length, uint8_t u8Result)
+{
+	pLink->u8RxState = CAN_ISOTP_RX_IDLE;
+	if (NULL != pLink->cfg.pfRxDone)
+	{
+		pLink->cfg.pfRxDone(u32Length, u8Result);
+	}
+}
+
+/**
+* @brief            End transmission.
+* @param[in,out]    pLink - Link.
+* @param[in]        u8Result - CAN_ISOTP_xxx.
+* @return           void.
+*/
+static void can_isotp_tx_end(can_isotp_t *pLink, uint8_t u8Result)
+{
+	pLink->u8TxState = CAN_ISOTP_TX_IDLE;
+	pLink->pu8TxBuf = NULL;
+	if (NULL != pLink->cfg.pfTxDone)
+	{
+		pLink->cfg.pfTxDone(u8Result);
+	}
+}
+
+/**
+* @brief            Send single or first frame.
+* @param[in,out]    pLink - Link.
+* @param[in]        u32NowUs - Current time in microseconds.
+* @return           void.
+*/
+static void can_isotp_tx_first(can_isotp_t *pLink, uint32_t u32NowUs)
+{
+	uint8_t au8Frame[ISOTP_MAX_DL];
+	uint8_t u8FrameSize = pLink->cfg.u8FrameSize;
+	uint32_t u32Length = pLink->u32TxLength;
+	uint8_t u8Header = 0U;
+
+	if (u32Length <= ISOTP_SF_CLASSIC_MAX)					/* SF, one byte PCI */
+	{
+		au8Frame[0] = ISOTP_PCI_SF | (uint8_t)u32Length;
+		(void)memcpy(&au8Frame[1], pLink->pu8TxBuf, u32Length);
+		if (1U == can_isotp_transmit(pLink, au8Frame, (uint8_t)(u32Length + 1U), ISOTP_CLASSIC_DL))
+		{
+			can_isotp_tx_end(pLink, CAN_ISOTP_OK);
+		}
+		return;
+	}
+
+	if ((u8FrameSize > ISOTP_CLASSIC_DL) && (u32Length <= (u8FrameSize - 2U)))	/* SF, CAN FD escape */
+	{
+		au8Frame[0] = ISOTP_PCI_SF;
+		au8Frame[1] = (uint8_t)u32Length;
+		(void)memcpy(&au8Frame[2], pLink->pu8TxBuf, u32Length);
+		if (1U == can_isotp_transmit(pLink, au8Frame, (uint8_t)(u32Length + 2U), can_isotp_frame_length((uint8_t)(u32Length + 2U))))
+		{
+			can_isotp_tx_end(pLink, CAN_ISOTP_OK);
+		}
+		return;
+	}
+
+	if (u32Length <= ISOTP_FF_DL_12BIT_MAX)					/* FF, 12 bit FF_DL */
+	{
+		au8Frame[0] = ISOTP_PCI_FF | (uint8_t)(u32Length >> 8U);
+		au8Frame[1] = (uint8_t)u32Length;
+		u8Header = 2U;
+	}
+	else													/* FF, 32 bit FF_DL escape */
+	{
+		au8Frame[0] = ISOTP_PCI_FF;
+		au8Frame[1] = 0U;
+		au8Frame[2] = (uint8_t)(u32Length >> 24U);
+		au8Frame[3] = (uint8_t)(u32Length >> 16U);
+		au8Frame[4] = (uint8_t)(u32Length >> 8U);
+		au8Frame[5] = (uint8_t)u32Length;
+		u8Header = 6U;
+	}
+	(void)memcpy(&au8Frame[u8Header], pLink->pu8TxBuf, (uint32_t)u8FrameSize - u8Header);
+
+	if (1U == can_isotp_transmit(pLink, au8Frame, u8FrameSize, u8FrameSize))
+	{
+		pLink->u32TxPos = (uint32_t)u8FrameSize - u8Header;
+		pLink->u8TxSn = 1U;
+		pLink->u8TxWaitCount = 0U;
+		pLink->u32TxDeadline = u32NowUs + CAN_ISOTP_TIMEOUT_US;	/* N_Bs */
+		pLink->u8TxState = CAN_ISOTP_TX_WAIT_FC;
+	}
+}
+
+/**
+* @brief            Send consecutive frames.
+* @details          Sends every CF that is due: one per STmin, or back to back until the send
+*                   function refuses a frame when STmin is 0. Stops at the end of a block.
+* @param[in,out]    pLink - Link.
+* @param[in]        u32NowUs - Current time in microseconds.
+* @return           void.
+*/
+static void can_isotp_tx_consecutive(can_isotp_t *pLink, uint32_t u32NowUs)
+{
+	uint8_t au8Frame[ISOTP_MAX_DL];
+	uint32_t u32Chunk = 0U;
+
+	while ((CAN_ISOTP_TX_CF == pLink->u8TxState) && ISOTP_TIME_REACHED(u32NowUs, pLink->u32TxDeadline))
+	{
+		u32Chunk = pLink->u32TxLength - pLink->u32TxPos;
+		if (u32Chunk > ((uint32_t)pLink->cfg.u8FrameSize - 1U))
+		{
+			u32Chunk = (uint32_t)pLink->cfg.u8FrameSize - 1U;
+		}
+
+		au8Frame[0] = ISOTP_PCI_CF | pLink->u8TxSn;
+		(void)memcpy(&au8Frame[1], &pLink->pu8TxBuf[pLink->u32TxPos], u32Chunk);
+		if (0U == can_isotp_transmit(pLink, au8Frame, (uint8_t)(u32Chunk + 1U), can_isotp_frame_length((uint8_t)(u32Chunk + 1U))))
+		{
+			return;											/* Retry on the next poll */
+		}
+
+		pLink->u32TxPos += u32Chunk;
+		pLink->u8TxSn = (pLink->u8TxSn + 1U) & 0x0FU;
+
+		if (pLink->u32TxPos >= pLink->u32TxLength)
+		{
+			can_isotp_tx_end(pLink, CAN_ISOTP_OK);
+		}
+		else if ((0U != pLink->u8TxBlockSize) && (0U == --pLink->u8TxBlockLeft))
+		{
+			pLink->u32TxDeadline = u32NowUs + CAN_ISOTP_TIMEOUT_US;	/* N_Bs */
+			pLink->u8TxState = CAN_ISOTP_TX_WAIT_FC;
+		}
+		else
+		{
+			pLink->u32TxDeadline = u32NowUs + pLink->u32TxStMinUs;
+		}
+	}
+}
+
+/**
+* @brief            Receive single frame.
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Frame data.
+* @param[in]        u8Length - Frame length.
+* @return           void.
+*/
+static void can_isotp_rx_single(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	uint32_t u32SfDl = pu8Data[0] & 0x0FU;
+	uint8_t u8Header = 1U;
+
+	if (0U == u32SfDl)										/* CAN FD escape: SF_DL in byte 1 */
+	{
+		if (u8Length <= ISOTP_CLASSIC_DL)
+		{
+			return;
+		}
+		u32SfDl = pu8Data[1];
+		u8Header = 2U;
+	}
+	if ((0U == u32SfDl) || (u32SfDl > ((uint32_t)u8Length - u8Header)))
+	{
+		return;												/* Invalid SF_DL: ignore */
+	}
+
+	if (CAN_ISOTP_RX_CF == pLink->u8RxState)
+	{
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_UNEXPECTED);
+	}
+	if ((NULL == pLink->pu8RxBuf) || (u32SfDl > pLink->u32RxSize))
+	{
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_OVERFLOW);
+		return;
+	}
+
+	(void)memcpy(pLink->pu8RxBuf, &pu8Data[u8Header], u32SfDl);
+	can_isotp_rx_end(pLink, u32SfDl, CAN_ISOTP_OK);
+}
+
+/**
+* @brief            Receive first frame.
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Frame data.
+* @param[in]        u8Length - Frame length.
+* @param[in]        u32NowUs - Current time in microseconds.
+* @return           void.
+*/
+static void can_isotp_rx_first(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs)
+{
+	uint32_t u32FfDl = (((uint32_t)pu8Data[0] & 0x0FU) << 8U) | pu8Data[1];
+	uint32_t u32Chunk = 0U;
+	uint8_t u8Header = 2U;
+
+	if (u8Length < ISOTP_CLASSIC_DL)
+	{
+		return;												/* FF always fills the frame */
+	}
+	if (0U == u32FfDl)										/* 32 bit FF_DL escape */
+	{
+		u32FfDl = ((uint32_t)pu8Data[2] << 24U) | ((uint32_t)pu8Data[3] << 16U)
+				| ((uint32_t)pu8Data[4] << 8U) | pu8Data[5];
+		u8Header = 6U;
+		if (u32FfDl <= ISOTP_FF_DL_12BIT_MAX)
+		{
+			return;											/* Escape only for more than 4095 bytes: ignore */
+		}
+	}
+	u32Chunk = (uint32_t)u8Length - u8Header;
+	if (u32FfDl <= u32Chunk)
+	{
+		return;												/* Would fit a SF: ignore */
+	}
+
+	if (CAN_ISOTP_RX_CF == pLink->u8RxState)
+	{
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_UNEXPECTED);
+	}
+	if ((NULL == pLink->pu8RxBuf) || (u32FfDl > pLink->u32RxSize))
+	{
+		can_isotp_send_fc(pLink, ISOTP_FS_OVFLW);
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_OVERFLOW);
+		return;
+	}
+
+	(void)memcpy(pLink->pu8RxBuf, &pu8Data[u8Header], u32Chunk);	/* Straight into the caller buffer */
+	pLink->u32RxLength = u32FfDl;
+	pLink->u32RxPos = u32Chunk;
+	pLink->u8RxSn = 1U;
+	pLink->u8RxDl = u8Length;
+	pLink->u8RxBlockLeft = pLink->cfg.u8BlockSize;
+	pLink->u32RxDeadline = u32NowUs + CAN_ISOTP_TIMEOUT_US;	/* N_Cr */
+	pLink->u8RxState = CAN_ISOTP_RX_CF;
+
+	can_isotp_send_fc(pLink, ISOTP_FS_CTS);
+}
+
+/**
+* @brief            Receive consecutive frame.
+* @details          Every CF but the last must have the length of the FF (RX_DL). The last one may be
+*                   shorter, but must hold the rest of the message.
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Frame data.
+* @param[in]        u8Length - Frame length.
+* @param[in]        u32NowUs - Current time in microseconds.
+* @return           void.
+*/
+static void can_isotp_rx_consecutive(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs)
+{
+	uint32_t u32Chunk = (uint32_t)u8Length - 1U;
+	uint32_t u32Left = 0U;
+
+	if (CAN_ISOTP_RX_CF != pLink->u8RxState)
+	{
+		return;												/* Not expecting a CF: ignore */
+	}
+	if ((pu8Data[0] & 0x0FU) != pLink->u8RxSn)
+	{
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_WRONG_SN);
+		return;
+	}
+
+	u32Left = pLink->u32RxLength - pLink->u32RxPos;
+	if ((u8Length > pLink->u8RxDl) || ((u8Length < pLink->u8RxDl) && (u32Chunk < u32Left)))
+	{
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_WRONG_DL);
+		return;
+	}
+	if (u32Chunk > u32Left)
+	{
+		u32Chunk = u32Left;									/* Last CF: drop padding */
+	}
+	(void)memcpy(&pLink->pu8RxBuf[pLink->u32RxPos], &pu8Data[1], u32Chunk);
+	pLink->u32RxPos += u32Chunk;
+	pLink->u8RxSn = (pLink->u8RxSn + 1U) & 0x0FU;
+
+	if (pLink->u32RxPos >= pLink->u32RxLength)
+	{
+		can_isotp_rx_end(pLink, pLink->u32RxLength, CAN_ISOTP_OK);
+		return;
+	}
+
+	pLink->u32RxDeadline = u32NowUs + CAN_ISOTP_TIMEOUT_US;	/* N_Cr */
+	if ((0U != pLink->cfg.u8BlockSize) && (0U == --pLink->u8RxBlockLeft))
+	{
+		pLink->u8RxBlockLeft = pLink->cfg.u8BlockSize;
+		can_isotp_send_fc(pLink, ISOTP_FS_CTS);				/* Next block */
+	}
+}
+
+/**
+* @brief            Receive flow control.
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Frame data.
+* @param[in]        u8Length - Frame length.
+* @param[in]        u32NowUs - Current time in microseconds.
+* @return           void.
+*/
+static void can_isotp_rx_flow_control(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs)
+{
+	if ((CAN_ISOTP_TX_WAIT_FC != pLink->u8TxState) || (u8Length < 3U))
+	{
+		return;												/* Not expecting a FC: ignore */
+	}
+
+	switch (pu8Data[0] & 0x0FU)
+	{
+	case ISOTP_FS_CTS:
+		pLink->u8TxBlockSize = pu8Data[1];
+		pLink->u8TxBlockLeft = pu8Data[1];
+		pLink->u32TxStMinUs = can_isotp_stmin_us(pu8Data[2]);
+		pLink->u8TxWaitCount = 0U;
+		pLink->u32TxDeadline = u32NowUs;					/* First CF is due now */
+		pLink->u8TxState = CAN_ISOTP_TX_CF;
+		break;
+
+	case ISOTP_FS_WAIT:
+		if (++pLink->u8TxWaitCount > CAN_ISOTP_WFT_MAX)
+		{
+			can_isotp_tx_end(pLink, CAN_ISOTP_WFT_OVERRUN);
+		}
+		else
+		{
+			pLink->u32TxDeadline = u32NowUs + CAN_ISOTP_TIMEOUT_US;	/* Restart N_Bs */
+		}
+		break;
+
+	case ISOTP_FS_OVFLW:
+		can_isotp_tx_end(pLink, CAN_ISOTP_OVERFLOW);
+		break;
+
+	default:
+		break;												/* Reserved flow status: ignore */
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Initialize link.
+* @details          Function to copy the configuration and set both directions idle. can_send()
+*                   carries classic frames only, so a link sending through it must use 8 byte frames.
+* @param[out]       pLink - Link.
+* @param[in]        pCfg - Configuration.
+* @return           1 if done, 0 if the frame size is not a CAN_DL or too large for can_send().
+*/
+uint8_t can_isotp_init(can_isotp_t *pLink, const can_isotp_cfg_t *pCfg)
+{
+	if ((pCfg->u8FrameSize < ISOTP_CLASSIC_DL) || (pCfg->u8FrameSize > ISOTP_MAX_DL)
+		|| (can_isotp_frame_length(pCfg->u8FrameSize) != pCfg->u8FrameSize))
+	{
+		return 0U;
+	}
+	if ((can_send == pCfg->pfSend) && (pCfg->u8FrameSize > ISOTP_CLASSIC_DL))
+	{
+		return 0U;											/* FD frames would be refused forever */
+	}
+
+	(void)memset(pLink, 0, sizeof(*pLink));
+	pLink->cfg = *pCfg;
+	pLink->u8RxState = CAN_ISOTP_RX_IDLE;
+	pLink->u8TxState = CAN_ISOTP_TX_IDLE;
+
+	return 1U;
+}
+
+/**
+* @brief            Set receive buffer.
+* @details          Function to give the link the buffer incoming messages are reassembled into.
+*                   The buffer is owned by the link until the receive indication.
+* @param[in,out]    pLink - Link.
+* @param[out]       pu8Buf - Buffer.
+* @param[in]        u32Size - Buffer size in bytes.
+* @return           void.
+*/
+void can_isotp_set_rx_buffer(can_isotp_t *pLink, uint8_t *pu8Buf, uint32_t u32Size)
+{
+	pLink->pu8RxBuf = pu8Buf;
+	pLink->u32RxSize = u32Size;
+}
+
+/**
+* @brief            Send message.
+* @details          Function to start sending a message. The data is read in place and must stay
+*                   unchanged until the transmit confirmation. Frames go out from can_isotp_poll().
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Message.
+* @param[in]        u32Length - Message length in bytes (1 or more).
+* @return           CAN_ISOTP_OK if started, CAN_ISOTP_BUSY if a transmission is running,
+*                   CAN_ISOTP_INVALID_LENGTH for an empty message (SF_DL=0 is not a valid frame).
+*/
+uint8_t can_isotp_send(can_isotp_t *pLink, const uint8_t *pu8Data, uint32_t u32Length)
+{
+	if (0U == u32Length)
+	{
+		return CAN_ISOTP_INVALID_LENGTH;
+	}
+	if (CAN_ISOTP_TX_IDLE != pLink->u8TxState)
+	{
+		return CAN_ISOTP_BUSY;
+	}
+
+	pLink->pu8TxBuf = pu8Data;
+	pLink->u32TxLength = u32Length;
+	pLink->u32TxPos = 0U;
+	pLink->u8TxState = CAN_ISOTP_TX_FF;
+
+	return CAN_ISOTP_OK;
+}
+
+/**
+* @brief            Receive frame.
+* @details          Function to process a frame received with the link receive ID.
+* @param[in,out]    pLink - Link.
+* @param[in]        pu8Data - Frame data bytes.
+* @param[in]        u8Length - Frame data length.
+* @param[in]        u32NowUs - Current time in microseconds (free running, wraps).
+* @return           void.
+*/
+void can_isotp_rx_frame(can_isotp_t *pLink, const uint8_t *pu8Data, uint8_t u8Length, uint32_t u32NowUs)
+{
+	if (0U == u8Length)
+	{
+		return;
+	}
+
+	switch (pu8Data[0] & 0xF0U)
+	{
+	case ISOTP_PCI_SF:
+		can_isotp_rx_single(pLink, pu8Data, u8Length);
+		break;
+
+	case ISOTP_PCI_FF:
+		can_isotp_rx_first(pLink, pu8Data, u8Length, u32NowUs);
+		break;
+
+	case ISOTP_PCI_CF:
+		can_isotp_rx_consecutive(pLink, pu8Data, u8Length, u32NowUs);
+		break;
+
+	case ISOTP_PCI_FC:
+		can_isotp_rx_flow_control(pLink, pu8Data, u8Length, u32NowUs);
+		break;
+
+	default:
+		break;												/* Unknown PCI: ignore */
+	}
+}
+
+/**
+* @brief            Run link.
+* @details          Function to send pending frames once STmin has elapsed and check timeouts.
+*                   Call it from the main loop at least as often as the shortest STmin.
+* @param[in,out]    pLink - Link.
+* @param[in]        u32NowUs - Current time in microseconds (free running, wraps).
+* @return           void.
+*/
+void can_isotp_poll(can_isotp_t *pLink, uint32_t u32NowUs)
+{
+	if ((CAN_ISOTP_RX_CF == pLink->u8RxState) && ISOTP_TIME_REACHED(u32NowUs, pLink->u32RxDeadline))
+	{
+		can_isotp_rx_end(pLink, 0U, CAN_ISOTP_TIMEOUT);		/* N_Cr expired */
+	}
+
+	switch (pLink->u8TxState)
+	{
+	case CAN_ISOTP_TX_FF:
+		can_isotp_tx_first(pLink, u32NowUs);
+		break;
+
+	case CAN_ISOTP_TX_WAIT_FC:
+		if (ISOTP_TIME_REACHED(u32NowUs, pLink->u32TxDeadline))
+		{
+			can_isotp_tx_end(pLink, CAN_ISOTP_TIMEOUT);		/* N_Bs expired */
+		}
+		break;
+
+	case CAN_ISOTP_TX_CF:
+		can_isotp_tx_consecutive(pLink, u32NowUs);
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+/* END can_isotp */
@@ -0,0 +1,140 @@
+/**
+* @file			can_lat.c
+* @brief		Frame latency histograms
+* @details		Log2 histograms of receive-to-application and request-to-transmit latencies, in CAN0
+*				bit times of the can_time timebase. Read them at runtime (debugger or code) to tune
+*				interrupt priorities and the main loop.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_lat.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Number of significant bits of x != 0 (CLZ on Cortex-M4) */
+#define CAN_LAT_BITS(x)		(32U - (uint32_t)__builtin_clz(x))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* Reception (MB time stamp) to application (frame taken from the receive ring) */
+can_lat_hist_t CanLatRx;
+
+/* can_send() call to transmission (MB time stamp of the sent frame) */
+can_lat_hist_t CanLatTx;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Record latency.
+* @details          Function to add the time from u64Start to u64End to a histogram. A histogram must
+*                   only be recorded from one context.
+* @param[in,out]    pHist - Histogram.
+* @param[in]        u64Start - Start time (can_time_xxx).
+* @param[in]        u64End - End time.
+* @return           void.
+*/
+void can_lat_record(can_lat_hist_t *pHist, uint64_t u64Start, uint64_t u64End)
+{
+	uint64_t u64Delta = (u64End > u64Start) ? (u64End - u64Start) : 0U;
+	uint32_t u32Delta = (u64Delta > 0xFFFFFFFFU) ? 0xFFFFFFFFU : (uint32_t)u64Delta;
+	uint32_t u32Bucket = 0U;
+
+	if (0U != u32Delta)
+	{
+		u32Bucket = CAN_LAT_BITS(u32Delta);
+		if (u32Bucket >= CAN_LAT_BUCKETS)
+		{
+			u32Bucket = CAN_LAT_BUCKETS - 1U;
+		}
+	}
+
+	pHist->au32Bucket[u32Bucket]++;
+	pHist->u32Count++;
+	if (u32Delta > pHist->u32Max)
+	{
+		pHist->u32Max = u32Delta;
+	}
+}
+
+/**
+* @brief            Get percentile.
+* @details          Function to return an upper bound of the given percentile of the recorded latencies.
+* @param[in]        pHist - Histogram.
+* @param[in]        u16PerMille - Percentile in per mille (500 = median, 990 = 99th percentile).
+* @return           Upper bound in ticks (end of the bucket holding the percentile, at most u32Max), 0 if empty.
+*/
+uint32_t can_lat_percentile(const can_lat_hist_t *pHist, uint16_t u16PerMille)
+{
+	uint32_t u32Target = (uint32_t)(((uint64_t)pHist->u32Count * u16PerMille + 999U) / 1000U);
+	uint32_t u32Sum = 0U;
+	uint32_t u32Bucket = 0U;
+	uint32_t u32Bound = 0U;
+
+	if (0U == pHist->u32Count)
+	{
+		return 0U;
+	}
+
+	for (u32Bucket = 0U; u32Bucket < (CAN_LAT_BUCKETS - 1U); u32Bucket++)
+	{
+		u32Sum += pHist->au32Bucket[u32Bucket];
+		if (u32Sum >= u32Target)
+		{
+			u32Bound = (0U == u32Bucket) ? 0U : ((1UL << u32Bucket) - 1U);	/* Last tick of bucket */
+			return (u32Bound < pHist->u32Max) ? u32Bound : pHist->u32Max;	/* No sample above the largest one */
+		}
+	}
+	return pHist->u32Max;									/* Overflow bucket: largest sample */
+}
+
+/**
+* @brief            Clear histogram.
+* @param[out]       pHist - Histogram.
+* @return           void.
+*/
+void can_lat_reset(can_lat_hist_t *pHist)
+{
+	uint32_t u32Bucket = 0U;
+
+	for (u32Bucket = 0U; u32Bucket < CAN_LAT_BUCKETS; u32Bucket++)
+	{
+		pHist->au32Bucket[u32Bucket] = 0U;
+	}
+	pHist->u32Count = 0U;
+	pHist->u32Max = 0U;
+}
+
+
+/* END can_lat */
@@ -0,0 +1,228 @@
+/**
+* @file			can_replay.c
+* @brief		CAN trace replay
+* @details		Plays the received frames of a can_trace dump back through the transmit engine, with the
+*				original timing, scaled timing or as fast as possible. With FlexCAN0 in loopback
+*				(FLEXCAN0_set_loopback()) the frames come back through the real receive MBs / RX FIFO and
+*				the CAN0 interrupt, so the receive path can be measured with recorded traffic.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_replay.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Data bytes per DLC, classic frames stop at 8 */
+static const uint8_t s_au8DlcLength[2][16] =
+{
+	{0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 8U, 8U, 8U, 8U, 8U, 8U, 8U},
+	{0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint8_t can_replay_varint(can_replay_t *pReplay, uint64_t *pu64Value);
+static uint8_t can_replay_next(can_replay_t *pReplay);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Read varint.
+* @param[in,out]    pReplay - Replay state.
+* @param[out]       pu64Value - Value.
+* @return           1 if read, 0 if the stream ends inside the value.
+*/
+static uint8_t can_replay_varint(can_replay_t *pReplay, uint64_t *pu64Value)
+{
+	uint64_t u64Value = 0U;
+	uint32_t u32Shift = 0U;
+	uint8_t u8Byte = 0U;
+
+	do
+	{
+		if ((pReplay->u32Pos >= pReplay->u32Size) || (u32Shift > 63U))
+		{
+			return 0U;
+		}
+		u8Byte = pReplay->pu8Trace[pReplay->u32Pos++];
+		u64Value |= (uint64_t)(u8Byte & 0x7FU) << u32Shift;
+		u32Shift += 7U;
+	} while (0U != (u8Byte & 0x80U));
+
+	*pu64Value = u64Value;
+	return 1U;
+}
+
+/**
+* @brief            Load next record.
+* @details          Decode the next record into the pending fields and advance the trace time.
+* @param[in,out]    pReplay - Replay state.
+* @return           1 if a record is pending, 0 at the end of the stream (u8Error set if cut off).
+*/
+static uint8_t can_replay_next(can_replay_t *pReplay)
+{
+	uint64_t u64Delta = 0U;
+	uint64_t u64Id = 0U;
+	uint32_t u32Index = 0U;
+
+	pReplay->u8Pending = 0U;
+	if (pReplay->u32Pos >= pReplay->u32Size)
+	{
+		return 0U;
+	}
+
+	pReplay->u8Flags = pReplay->pu8Trace[pReplay->u32Pos++];
+	pReplay->u8Length = s_au8DlcLength[(0U != (pReplay->u8Flags & CAN_TRACE_FDF)) ? 1U : 0U][pReplay->u8Flags & CAN_TRACE_DLC_MASK];
+
+	if ((0U == can_replay_varint(pReplay, &u64Delta)) || (0U == can_replay_varint(pReplay, &u64Id))
+		|| ((pReplay->u32Size - pReplay->u32Pos) < pReplay->u8Length))
+	{
+		pReplay->u8Error = 1U;
+		return 0U;
+	}
+
+	pReplay->u64TraceTime += (u64Delta >> 1U) ^ (0U - (u64Delta & 1U));	/* Undo zigzag, wraps for negative deltas */
+	pReplay->u32Id = (uint32_t)u64Id | ((0U != (pReplay->u8Flags & CAN_TRACE_IDE)) ? CAN_ID_EXT_FLAG : 0U);
+	for (u32Index = 0U; u32Index < pReplay->u8Length; u32Index++)
+	{
+		pReplay->au8Data[u32Index] = pReplay->pu8Trace[pReplay->u32Pos++];
+	}
+
+	pReplay->u8Pending = 1U;
+	return 1U;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Start replay.
+* @details          Function to check the trace header and schedule the first record at time u64Now. Later
+*                   records keep their distance to the first one, the time from can_trace_start() to the
+*                   first record is not replayed.
+* @param[out]       pReplay - Replay state.
+* @param[in]        pu8Trace - Trace stream, e.g. a can_trace dump placed in flash.
+* @param[in]        u32Size - Stream size in bytes.
+* @param[in]        u16ScalePct - CAN_REPLAY_ORIGINAL, CAN_REPLAY_FAST, or timing in percent (200 = half speed).
+* @param[in]        pfSend - Frame transmit function.
+* @param[in]        u64Now - Current time (can_time_now()).
+* @return           1 if started, 0 if the stream has no valid header.
+*/
+uint8_t can_replay_start(can_replay_t *pReplay, const uint8_t *pu8Trace, uint32_t u32Size,
+						 uint16_t u16ScalePct, can_replay_send_t pfSend, uint64_t u64Now)
+{
+	pReplay->pu8Trace = pu8Trace;
+	pReplay->u32Size = u32Size;
+	pReplay->u32Pos = CAN_TRACE_HEADER_SIZE;
+	pReplay->u16ScalePct = u16ScalePct;
+	pReplay->pfSend = pfSend;
+	pReplay->u64Start = u64Now;
+	pReplay->u64TraceTime = 0U;
+	pReplay->u8Pending = 0U;
+	pReplay->u32Sent = 0U;
+	pReplay->u32Skipped = 0U;
+	pReplay->u32Retries = 0U;
+	pReplay->u64MaxLate = 0U;
+	pReplay->u8Error = 0U;
+
+	if ((u32Size < CAN_TRACE_HEADER_SIZE) || ('C' != pu8Trace[0]) || ('T' != pu8Trace[1])
+		|| ('R' != pu8Trace[2]) || (CAN_TRACE_VERSION != pu8Trace[3]))
+	{
+		pReplay->u8Error = 1U;
+		return 0U;
+	}
+
+	pReplay->u32TickHz = (uint32_t)pu8Trace[4] | ((uint32_t)pu8Trace[5] << 8U)
+					   | ((uint32_t)pu8Trace[6] << 16U) | ((uint32_t)pu8Trace[7] << 24U);
+	if (0U == pReplay->u32TickHz)
+	{
+		pReplay->u8Error = 1U;
+		return 0U;
+	}
+
+	if (1U == can_replay_next(pReplay))
+	{
+		pReplay->u64TraceTime = 0U;				/* First record plays at u64Now, its delta counts from can_trace_start() */
+	}
+	return 1U;
+}
+
+/**
+* @brief            Run replay.
+* @details          Function to send every received-frame record whose scaled time has come. Call it
+*                   from the main loop.
+* @param[in,out]    pReplay - Replay state.
+* @param[in]        u64Now - Current time (can_time_now()).
+* @return           1 while records are left, 0 when the replay is finished.
+*/
+uint8_t can_replay_poll(can_replay_t *pReplay, uint64_t u64Now)
+{
+	uint64_t u64Due = 0U;
+
+	while (0U != pReplay->u8Pending)
+	{
+		if (0U != (pReplay->u8Flags & (CAN_TRACE_TX | CAN_TRACE_FDF)))
+		{
+			pReplay->u32Skipped++;						/* Own transmissions, and CAN FD on a classic bus */
+			(void)can_replay_next(pReplay);
+			continue;
+		}
+
+		if (CAN_REPLAY_FAST != pReplay->u16ScalePct)
+		{
+			/* Trace ticks to CAN0 timebase ticks, then scaled */
+			u64Due = pReplay->u64Start + pReplay->u64TraceTime * FLEXCAN0_BITRATE / pReplay->u32TickHz
+										 * pReplay->u16ScalePct / 100U;
+			if ((int64_t)(u64Now - u64Due) < 0)
+			{
+				return 1U;								/* Not yet */
+			}
+			if ((u64Now - u64Due) > pReplay->u64MaxLate)
+			{
+				pReplay->u64MaxLate = u64Now - u64Due;
+			}
+		}
+
+		if (0U == pReplay->pfSend(pReplay->u32Id, pReplay->au8Data, pReplay->u8Length))
+		{
+			pReplay->u32Retries++;						/* Transmit queue full: same record next poll */
+			return 1U;
+		}
+
+		pReplay->u32Sent++;
+		(void)can_replay_next(pReplay);
+	}
+
+	return 0U;
+}
+
+
+/* END can_replay */
@@ -0,0 +1,133 @@
+/**
+* @file				can_ring.c
+* @brief            Lock-free CAN frame ring
+*/
+ 
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_ring.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Index mask, CAN_RING_SIZE is a power of 2 */
+#define CAN_RING_MASK		(CAN_RING_SIZE - 1U)
+
+/* Keep the compiler from moving frame copies across the index update */
+#define CAN_RING_BARRIER()	__asm volatile ("" ::: "memory")
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Ring Initialization.
+* @details          Function to empty the ring and reset its overflow counter and high water mark.
+* @param[in]        pRing - Frame ring.
+* @return           void.
+*/
+void can_ring_init(can_ring_t *pRing)
+{
+	pRing->u32Head = 0U;
+	pRing->u32Tail = 0U;
+	pRing->u32Overflow = 0U;
+	pRing->u32MaxDepth = 0U;
+}
+
+/**
+* @brief            Push frame.
+* @details          Function to append a frame to the ring. Called by the producer (ISR) only.
+* @param[in]        pRing - Frame ring.
+* @param[in]        pFrame - Frame to store.
+* @return           1 if stored, 0 if the ring was full and the frame was dropped.
+*/
+uint8_t can_ring_push(can_ring_t *pRing, const can_frame_t *pFrame)
+{
+	uint32_t u32Head = pRing->u32Head;
+
+	if ((u32Head - pRing->u32Tail) >= CAN_RING_SIZE)	/* Ring full: keep the older frames */
+	{
+		pRing->u32Overflow++;
+		return 0U;
+	}
+
+	pRing->aFrames[u32Head & CAN_RING_MASK] = *pFrame;	/* Store frame before publishing it */
+	CAN_RING_BARRIER();
+	pRing->u32Head = u32Head + 1U;						/* Publish frame to consumer */
+
+	if ((u32Head + 1U - pRing->u32Tail) > pRing->u32MaxDepth)
+	{
+		pRing->u32MaxDepth = u32Head + 1U - pRing->u32Tail;	/* High water mark */
+	}
+
+	return 1U;
+}
+
+/**
+* @brief            Pop frame.
+* @details          Function to take the oldest frame from the ring without blocking. Called by the consumer only.
+* @param[in]        pRing - Frame ring.
+* @param[out]       pFrame - Oldest frame.
+* @return           1 if a frame was returned, 0 if the ring was empty.
+*/
+uint8_t can_ring_pop(can_ring_t *pRing, can_frame_t *pFrame)
+{
+	uint32_t u32Tail = pRing->u32Tail;
+
+	if (u32Tail == pRing->u32Head)						/* Ring empty */
+	{
+		return 0U;
+	}
+
+	CAN_RING_BARRIER();
+	*pFrame = pRing->aFrames[u32Tail & CAN_RING_MASK];	/* Copy frame before releasing its slot */
+	CAN_RING_BARRIER();
+	pRing->u32Tail = u32Tail + 1U;						/* Release slot to producer */
+
+	return 1U;
+}
+
+/**
+* @brief            Get fill level.
+* @details          Function to return the number of frames waiting in the ring.
+* @param[in]        pRing - Frame ring.
+* @return           Number of frames.
+*/
+uint32_t can_ring_count(const can_ring_t *pRing)
+{
+	return pRing->u32Head - pRing->u32Tail;
+}
+
+
+/* END can_ring */
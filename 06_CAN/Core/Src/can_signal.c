@@ -0,0 +1,217 @@
+/**
+* @file			can_signal.c
+* @brief		Signal pack/unpack of CAN payloads
+* @details		A signal table per message (DBC start bit, length, byte order, sign, factor, offset)
+*				replaces hand written shifts and masks. The payload is read as one 64 bit value in the
+*				byte order of the signal, so each signal is a single shift, mask and sign extension.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_signal.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Reverse byte order of a word: MB data words are big-endian (byte 0 in bits 31:24) */
+#if defined(__CC_ARM)
+#define CAN_SIGNAL_BSWAP32(x)	(__rev(x))
+#else
+#define CAN_SIGNAL_BSWAP32(x)	(__builtin_bswap32(x))
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint64_t can_signal_load(uint8_t u8Order, const uint32_t *pu32Data);
+static void can_signal_store(uint8_t u8Order, uint32_t *pu32Data, uint64_t u64Value);
+static uint32_t can_signal_round(const can_signal_t *pSignal, float fValue);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Load payload.
+* @details          Motorola: byte 0 in bits 63:56. Intel: byte 0 in bits 7:0, so the DBC start bit
+*                   is the bit number.
+* @param[in]        u8Order - CAN_SIGNAL_ORDER_xxx.
+* @param[in]        pu32Data - Payload (2 words, MB byte order).
+* @return           64 bit payload value.
+*/
+static uint64_t can_signal_load(uint8_t u8Order, const uint32_t *pu32Data)
+{
+	if (CAN_SIGNAL_ORDER_MOTOROLA == u8Order)
+	{
+		return ((uint64_t)pu32Data[0] << 32U) | pu32Data[1];
+	}
+	return ((uint64_t)CAN_SIGNAL_BSWAP32(pu32Data[1]) << 32U) | CAN_SIGNAL_BSWAP32(pu32Data[0]);
+}
+
+/**
+* @brief            Store payload.
+* @param[in]        u8Order - CAN_SIGNAL_ORDER_xxx.
+* @param[out]       pu32Data - Payload (2 words, MB byte order).
+* @param[in]        u64Value - 64 bit payload value.
+* @return           void.
+*/
+static void can_signal_store(uint8_t u8Order, uint32_t *pu32Data, uint64_t u64Value)
+{
+	if (CAN_SIGNAL_ORDER_MOTOROLA == u8Order)
+	{
+		pu32Data[0] = (uint32_t)(u64Value >> 32U);
+		pu32Data[1] = (uint32_t)u64Value;
+	}
+	else
+	{
+		pu32Data[0] = CAN_SIGNAL_BSWAP32((uint32_t)u64Value);
+		pu32Data[1] = CAN_SIGNAL_BSWAP32((uint32_t)(u64Value >> 32U));
+	}
+}
+
+/**
+* @brief            Round to nearest raw value.
+* @details          Halves away from zero. Values outside the signal range (NaN included) saturate,
+*                   so an unsigned 32 bit signal never goes through int32_t.
+* @param[in]        pSignal - Signal.
+* @param[in]        fValue - Raw value before rounding.
+* @return           Raw value, two's complement for signed signals.
+*/
+static uint32_t can_signal_round(const can_signal_t *pSignal, float fValue)
+{
+	if (0U == pSignal->u32Sign)
+	{
+		if (!(fValue > 0.0f))
+		{
+			return 0U;
+		}
+		if (fValue >= (float)pSignal->u32Mask)
+		{
+			return pSignal->u32Mask;
+		}
+		return (uint32_t)(fValue + 0.5f);
+	}
+	if (!(fValue > -(float)pSignal->u32Sign))
+	{
+		return pSignal->u32Sign;			/* Most negative value */
+	}
+	if (fValue >= (float)(pSignal->u32Sign - 1U))
+	{
+		return pSignal->u32Sign - 1U;		/* Most positive value */
+	}
+	return (uint32_t)(int32_t)((fValue >= 0.0f) ? (fValue + 0.5f) : (fValue - 0.5f));
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Get raw signal value.
+* @details          Function to extract a signal from an 8 byte payload and sign extend it.
+* @param[in]        pSignal - Signal.
+* @param[in]        pu32Data - Payload (2 words, MB byte order), e.g. RxDATA or can_frame_t.u32Data.
+* @return           Raw value. Cast it to uint32_t for an unsigned 32 bit signal.
+*/
+int32_t can_signal_get_raw(const can_signal_t *pSignal, const uint32_t *pu32Data)
+{
+	uint32_t u32Raw = (uint32_t)(can_signal_load(pSignal->u8Order, pu32Data) >> pSignal->u8Shift) & pSignal->u32Mask;
+
+	return (int32_t)((u32Raw ^ pSignal->u32Sign) - pSignal->u32Sign);	/* Sign extend, no-op when unsigned */
+}
+
+/**
+* @brief            Set raw signal value.
+* @details          Function to insert a signal into an 8 byte payload, other bits are kept.
+* @param[in]        pSignal - Signal.
+* @param[in,out]    pu32Data - Payload (2 words, MB byte order).
+* @param[in]        u32Raw - Raw value (two's complement for signed signals), truncated to the signal length.
+* @return           void.
+*/
+void can_signal_set_raw(const can_signal_t *pSignal, uint32_t *pu32Data, uint32_t u32Raw)
+{
+	uint64_t u64Value = can_signal_load(pSignal->u8Order, pu32Data);
+
+	u64Value &= ~((uint64_t)pSignal->u32Mask << pSignal->u8Shift);
+	u64Value |= (uint64_t)(u32Raw & pSignal->u32Mask) << pSignal->u8Shift;
+	can_signal_store(pSignal->u8Order, pu32Data, u64Value);
+}
+
+/**
+* @brief            Unpack message.
+* @details          Function to decode the physical values of all signals of a message. float holds
+*                   integers up to 2^24 exactly, so raw values above that lose their low bits.
+* @param[in]        pSignals - Signal table of the message.
+* @param[in]        u8Count - Number of signals.
+* @param[in]        pu32Data - Payload (2 words, MB byte order).
+* @param[out]       pfValues - Physical values, one per signal.
+* @return           void.
+*/
+void can_signal_unpack(const can_signal_t *pSignals, uint8_t u8Count, const uint32_t *pu32Data, float *pfValues)
+{
+	uint64_t au64Value[2];
+	uint32_t u32Raw = 0U;
+	float fRaw = 0.0f;
+	uint8_t u8Index = 0U;
+
+	au64Value[CAN_SIGNAL_ORDER_INTEL] = can_signal_load(CAN_SIGNAL_ORDER_INTEL, pu32Data);	/* Load once per order */
+	au64Value[CAN_SIGNAL_ORDER_MOTOROLA] = can_signal_load(CAN_SIGNAL_ORDER_MOTOROLA, pu32Data);
+
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		u32Raw = (uint32_t)(au64Value[pSignals[u8Index].u8Order] >> pSignals[u8Index].u8Shift) & pSignals[u8Index].u32Mask;
+		fRaw = (0U != pSignals[u8Index].u32Sign)
+			   ? (float)(int32_t)((u32Raw ^ pSignals[u8Index].u32Sign) - pSignals[u8Index].u32Sign)
+			   : (float)u32Raw;		/* Unsigned 32 bit values above 0x7FFFFFFF stay positive */
+		pfValues[u8Index] = fRaw * pSignals[u8Index].fFactor + pSignals[u8Index].fOffset;
+	}
+}
+
+/**
+* @brief            Pack message.
+* @details          Function to encode physical values (rounded to the nearest raw value and saturated
+*                   to the signal range) into a payload. Above 2^24 a float steps by more than one raw
+*                   value, so not every raw value of a longer signal can be packed.
+* @param[in]        pSignals - Signal table of the message.
+* @param[in]        u8Count - Number of signals.
+* @param[in]        pfValues - Physical values, one per signal.
+* @param[out]       pu32Data - Payload (2 words, MB byte order), cleared first.
+* @return           void.
+*/
+void can_signal_pack(const can_signal_t *pSignals, uint8_t u8Count, const float *pfValues, uint32_t *pu32Data)
+{
+	uint8_t u8Index = 0U;
+
+	pu32Data[0] = 0U;
+	pu32Data[1] = 0U;
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		can_signal_set_raw(&pSignals[u8Index], pu32Data,
+						   can_signal_round(&pSignals[u8Index], (pfValues[u8Index] - pSignals[u8Index].fOffset) / pSignals[u8Index].fFactor));
+	}
+}
+
+
+/* END can_signal */
@@ -0,0 +1,250 @@
+/**
+* @file			can_stats.c
+* @brief		CAN0 driver statistics and bus load
+* @details		The CAN0 MB interrupt is the only writer of the counters. Snapshot and reset work on a
+*				baseline copy in thread mode, so neither needs to mask the interrupt.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <string.h>
+#include "can_stats.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Counter words in can_stats_counters_t */
+#define CAN_STATS_WORDS			(sizeof(can_stats_counters_t) / sizeof(uint32_t))
+
+/* Saturate a counter to one byte */
+#define CAN_STATS_SAT8(x)		((uint8_t)(((x) > 0xFFU) ? 0xFFU : (x)))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Running counters, written by the CAN0 MB interrupt only */
+static volatile can_stats_counters_t s_Counters;
+
+/* ID of each slot, claimed by the CAN0 MB interrupt */
+static volatile uint32_t s_au32Id[CAN_STATS_ID_SLOTS];
+
+/* Counters at the last reset, thread mode only */
+static can_stats_counters_t s_Baseline;
+
+/* Time of the last reset, error events and TX drops at that time, thread mode only */
+static uint64_t s_u64ResetTime = 0U;
+static uint32_t s_u32BusOffBase = 0U;
+static uint32_t s_u32ErrorFramesBase = 0U;
+static uint32_t s_u32TxDroppedBase = 0U;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void can_stats_count_id(uint32_t u32Id, uint8_t u8Length);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Count frame per ID.
+* @details          The first CAN_STATS_ID_SLOTS distinct IDs get a slot (linear probing from a hash of
+*                   the ID), later IDs are counted in u32IdOther.
+* @param[in]        u32Id - Frame ID.
+* @param[in]        u8Length - Number of data bytes.
+* @return           void.
+*/
+static void can_stats_count_id(uint32_t u32Id, uint8_t u8Length)
+{
+	uint32_t u32Slot = (u32Id ^ (u32Id >> 7U)) % CAN_STATS_ID_SLOTS;
+	uint32_t u32Probe = 0U;
+
+	s_Counters.u32Frames++;
+	s_Counters.u32Bits += CAN_STATS_FRAME_BITS(u32Id, u8Length);
+
+	for (u32Probe = 0U; u32Probe < CAN_STATS_ID_SLOTS; u32Probe++)
+	{
+		if (CAN_STATS_FREE == s_au32Id[u32Slot])
+		{
+			s_au32Id[u32Slot] = u32Id;						/* Claim a free slot */
+		}
+		if (u32Id == s_au32Id[u32Slot])
+		{
+			s_Counters.au32IdCount[u32Slot]++;
+			return;
+		}
+		u32Slot = (u32Slot + 1U) % CAN_STATS_ID_SLOTS;
+	}
+	s_Counters.u32IdOther++;								/* All slots taken */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Statistics Initialization.
+* @details          Function to clear all counters and ID slots. Call it before the CAN0 interrupt is enabled.
+* @param        	void.
+* @return           void.
+*/
+void can_stats_init(void)
+{
+	uint32_t u32Index = 0U;
+
+	(void)memset((void *)&s_Counters, 0, sizeof(s_Counters));
+	(void)memset(&s_Baseline, 0, sizeof(s_Baseline));
+	for (u32Index = 0U; u32Index < CAN_STATS_ID_SLOTS; u32Index++)
+	{
+		s_au32Id[u32Index] = CAN_STATS_FREE;
+	}
+	can_stats_reset();
+}
+
+/**
+* @brief            Count received frame.
+* @details          Function to count a frame read from a receive MB. Called from the CAN0 MB interrupt.
+* @param[in]        pFrame - Received frame.
+* @param[in]        u8Overrun - 1 if frames were lost in the MB before this one (CODE=OVERRUN).
+* @return           void.
+*/
+void can_stats_rx(const can_frame_t *pFrame, uint8_t u8Overrun)
+{
+	s_Counters.au32MbRx[pFrame->u8Mb & 31U]++;
+	if (0U != u8Overrun)
+	{
+		s_Counters.au32MbOverrun[pFrame->u8Mb & 31U]++;
+	}
+	can_stats_count_id(pFrame->u32Id, pFrame->u8Length);
+}
+
+/**
+* @brief            Count sent frame.
+* @details          Function to count a frame sent from a transmit MB. Called from the CAN0 MB interrupt.
+* @param[in]        u8Mb - Transmit MB.
+* @param[in]        u32Id - Frame ID.
+* @param[in]        u8Length - Number of data bytes.
+* @return           void.
+*/
+void can_stats_tx(uint8_t u8Mb, uint32_t u32Id, uint8_t u8Length)
+{
+	s_Counters.au32MbTx[u8Mb & 31U]++;
+	can_stats_count_id(u32Id, u8Length);
+}
+
+/**
+* @brief            Take snapshot.
+* @details          Function to return the statistics since the last reset, bus load over that time and
+*                   the current error state. Thread mode only; the interrupt keeps counting meanwhile.
+* @param[out]       pSnapshot - Statistics.
+* @return           void.
+*/
+void can_stats_snapshot(can_stats_snapshot_t *pSnapshot)
+{
+	const volatile uint32_t *pu32Now = (const volatile uint32_t *)&s_Counters;
+	const uint32_t *pu32Base = (const uint32_t *)&s_Baseline;
+	uint32_t *pu32Out = (uint32_t *)&pSnapshot->counters;
+	uint32_t u32Ecr = FLEXCAN0_BASE->ECR;
+	uint32_t u32Index = 0U;
+	uint64_t u64Load = 0U;
+
+	for (u32Index = 0U; u32Index < CAN_STATS_WORDS; u32Index++)
+	{
+		pu32Out[u32Index] = pu32Now[u32Index] - pu32Base[u32Index];	/* Word reads are atomic, wrap safe */
+	}
+	for (u32Index = 0U; u32Index < CAN_STATS_ID_SLOTS; u32Index++)
+	{
+		pSnapshot->au32Id[u32Index] = s_au32Id[u32Index];
+	}
+
+	pSnapshot->u64Elapsed = can_time_now() - s_u64ResetTime;
+	if (0U != pSnapshot->u64Elapsed)
+	{
+		u64Load = (uint64_t)pSnapshot->counters.u32Bits * 1000U / pSnapshot->u64Elapsed;	/* Bits over bit times */
+	}
+	pSnapshot->u16BusLoad = (uint16_t)((u64Load > 1000U) ? 1000U : u64Load);
+
+	pSnapshot->u8TxErrors = (uint8_t)((u32Ecr & CAN_ECR_TXERRCNT_MASK) >> CAN_ECR_TXERRCNT_SHIFT);
+	pSnapshot->u8RxErrors = (uint8_t)((u32Ecr & CAN_ECR_RXERRCNT_MASK) >> CAN_ECR_RXERRCNT_SHIFT);
+	pSnapshot->u8FaultConf = (CAN_ERR_BUS_OFF == CanErr.u8State) ? 2U : ((CAN_ERR_PASSIVE == CanErr.u8State) ? 1U : 0U);
+															/* Not ESR1: reading it clears the error type bits */
+	pSnapshot->u32BusOff = CanErr.u32BusOff - s_u32BusOffBase;			/* Counted by the error interrupt */
+	pSnapshot->u32ErrorFrames = CanErr.u32ErrorFrames - s_u32ErrorFramesBase;
+	pSnapshot->u32TxDropped = can_tx_dropped() - s_u32TxDroppedBase;
+}
+
+/**
+* @brief            Reset statistics.
+* @details          Function to restart all counters and the bus load window. Thread mode only. The
+*                   counters keep running; the reset stores a baseline, so interrupts stay enabled.
+* @param        	void.
+* @return           void.
+*/
+void can_stats_reset(void)
+{
+	const volatile uint32_t *pu32Now = (const volatile uint32_t *)&s_Counters;
+	uint32_t *pu32Base = (uint32_t *)&s_Baseline;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < CAN_STATS_WORDS; u32Index++)
+	{
+		pu32Base[u32Index] = pu32Now[u32Index];
+	}
+	s_u64ResetTime = can_time_now();
+	s_u32BusOffBase = CanErr.u32BusOff;
+	s_u32ErrorFramesBase = CanErr.u32ErrorFrames;
+	s_u32TxDroppedBase = can_tx_dropped();
+}
+
+/**
+* @brief            Send statistics frame.
+* @details          Function to queue an 8 byte diagnostic frame: bus load %, TXERRCNT, RXERRCNT, bus off
+*                   events, overruns, dropped TX frames (each saturated at 255) and frames (16 bit, big endian).
+* @param[in]        u32Id - Frame ID.
+* @param[in]        pSnapshot - Statistics.
+* @return           1 if queued, 0 if the transmit queue was full.
+*/
+uint8_t can_stats_send(uint32_t u32Id, const can_stats_snapshot_t *pSnapshot)
+{
+	uint8_t au8Data[8];
+	uint32_t u32Overrun = 0U;
+	uint32_t u32Frames = (pSnapshot->counters.u32Frames > 0xFFFFU) ? 0xFFFFU : pSnapshot->counters.u32Frames;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < 32U; u32Index++)
+	{
+		u32Overrun += pSnapshot->counters.au32MbOverrun[u32Index];
+	}
+
+	au8Data[0] = (uint8_t)((pSnapshot->u16BusLoad + 5U) / 10U);
+	au8Data[1] = pSnapshot->u8TxErrors;
+	au8Data[2] = pSnapshot->u8RxErrors;
+	au8Data[3] = CAN_STATS_SAT8(pSnapshot->u32BusOff);
+	au8Data[4] = CAN_STATS_SAT8(u32Overrun);
+	au8Data[5] = CAN_STATS_SAT8(pSnapshot->u32TxDropped);
+	au8Data[6] = (uint8_t)(u32Frames >> 8U);
+	au8Data[7] = (uint8_t)u32Frames;
+
+	return can_send(u32Id, au8Data, 8U);
+}
+
+
+/* END can_stats */
@@ -0,0 +1,158 @@
+/**
+* @file			can_time.c
+* @brief		64 bit CAN timebase
+* @details		Extends the 16 bit CAN0 free running TIMER (one tick per bit time) to a monotonic 64 bit
+*				time. LPIT0 channel 0 samples the TIMER twice per wrap; msg buffer time stamps are placed
+*				relative to the latest sample.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_time.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* LPIT0 ch0 period: half a TIMER wrap (32768 bit times) */
+#define CAN_TIME_LPIT_TVAL		((uint32_t)(32768ULL * CAN_TIME_LPIT_CLK_HZ / FLEXCAN0_BITRATE) - 1U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* 64 bit time at the last sample */
+static volatile uint64_t s_u64Base = 0U;
+
+/* TIMER value at the last sample */
+static volatile uint16_t s_u16Last = 0U;
+
+/* Incremented by every sample, lets readers detect a sample during their read */
+static volatile uint32_t s_u32Seq = 0U;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void can_time_sample(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Sample TIMER.
+* @details          Interrupt context only (LPIT0 ch0 or CAN0 MB, same priority).
+* @param        	void.
+* @return           void.
+*/
+static void can_time_sample(void)
+{
+	uint16_t u16Now = (uint16_t)FLEXCAN0_BASE->TIMER;		/* Also unlocks msg buffers */
+
+	s_u32Seq++;
+	s_u64Base += (uint16_t)(u16Now - s_u16Last);			/* Ticks since the last sample, wrap safe */
+	s_u16Last = u16Now;
+	s_u32Seq++;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Timebase Initialization.
+* @details          Function to start LPIT0 channel 0 at half the CAN0 TIMER wrap period and enable its
+*                   interrupt. Call it after FLEXCAN0 initialization.
+* @param        	void.
+* @return           void.
+*/
+void can_time_init(void)
+{
+	s_u16Last = (uint16_t)FLEXCAN0_BASE->TIMER;
+	s_u64Base = 0U;
+
+	PCC->PCCn[PCC_LPIT_INDEX] = PCC_PCCn_PCS(6U);    	/* Clock Src = 6 (SPLL2_DIV2_CLK)*/
+	PCC->PCCn[PCC_LPIT_INDEX] |= PCC_PCCn_CGC_MASK; 	/* Enable clk to LPIT0 regs 		*/
+
+	LPIT0->MCR |= LPIT_MCR_M_CEN_MASK;  				/* M_CEN=1: enable module clk */
+	LPIT0->MIER |= LPIT_MIER_TIE0_MASK;  				/* TIE0=1: Timer Interrupt Enabled for Chan 0 */
+	LPIT0->TMR[0].TVAL = CAN_TIME_LPIT_TVAL;     		/* Chan 0 period: 32768 CAN0 bit times */
+	LPIT0->TMR[0].TCTRL |= LPIT_TMR_TCTRL_T_EN_MASK;	/* T_EN=1, MODE=0: 32 bit periodic counter */
+
+	S32_NVIC->ICPR[1] = 1U << (48 % 32);  				/* IRQ48-LPIT0 ch0: clr any pending IRQ*/
+	S32_NVIC->ISER[1] = 1U << (48 % 32);  				/* IRQ48-LPIT0 ch0: enable IRQ */
+	S32_NVIC->IP[48] = CAN_TIME_IRQ_PRIO;              	/* IRQ48-LPIT0 ch0: priority of IRQ81-CAN0 */
+}
+
+/**
+* @brief            Sample timebase.
+* @details          Function to fold the CAN0 TIMER ticks since the last sample into the 64 bit time.
+*                   Called from the LPIT0 ch0 interrupt, at least once per TIMER wrap.
+* @param        	void.
+* @return           void.
+*/
+void can_time_isr(void)
+{
+	LPIT0->MSR |= LPIT_MSR_TIF0_MASK; 					/* Clear LPIT0 timer flag 0 */
+	can_time_sample();
+}
+
+/**
+* @brief            Extend time stamp.
+* @details          Function to turn a 16 bit msg buffer time stamp into the 64 bit timebase. The frame
+*                   must be less than one TIMER wrap old, so call it from the CAN0 MB interrupt after
+*                   the MBs have been read (it reads TIMER).
+* @param[in]        u16Stamp - C/S TIME STAMP of a received or transmitted frame.
+* @return           Time in CAN0 bit times.
+*/
+uint64_t can_time_extend(uint16_t u16Stamp)
+{
+	can_time_sample();
+	return s_u64Base - (uint16_t)(s_u16Last - u16Stamp);	/* Stamp is at most one wrap before the sample */
+}
+
+/**
+* @brief            Get time.
+* @details          Function to return the current 64 bit time. The result is consistent from thread mode
+*                   and interrupts. It reads the CAN0 TIMER, which unlocks a locked receive MB: do not call
+*                   it while an MB is being read (C/S word read, data not yet copied), e.g. from an
+*                   interrupt that can preempt the CAN0 MB interrupt.
+* @param        	void.
+* @return           Time in CAN0 bit times.
+*/
+uint64_t can_time_now(void)
+{
+	uint64_t u64Base = 0U;
+	uint16_t u16Last = 0U;
+	uint16_t u16Now = 0U;
+	uint32_t u32Seq = 0U;
+
+	do
+	{
+		u32Seq = s_u32Seq;
+		u64Base = s_u64Base;
+		u16Last = s_u16Last;
+		u16Now = (uint16_t)FLEXCAN0_BASE->TIMER;
+	} while (u32Seq != s_u32Seq);						/* A sample interrupted the read: retry */
+
+	return u64Base + (uint16_t)(u16Now - u16Last);
+}
+
+
+/* END can_time */
@@ -0,0 +1,267 @@
+/**
+* @file			can_trace.c
+* @brief		CAN trace recorder
+* @details		Received and transmitted frames are encoded into a byte ring: a flags byte (direction,
+*				IDE, FDF, BRS, DLC), the time since the previous record as a zigzag varint, the ID as a
+*				varint and the data bytes. A back-to-back classic frame takes 12-13 bytes instead of the
+*				16 byte msg buffer and 8 byte time stamp.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_trace.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+#define CAN_TRACE_MASK			(CAN_TRACE_SIZE - 1U)
+
+/* Keep the compiler from reordering buffer accesses around the index updates */
+#define CAN_TRACE_BARRIER()		__asm volatile ("" ::: "memory")
+
+/* Store one byte at the write index */
+#define CAN_TRACE_PUT(idx, b)	(CanTrace.au8Buf[(idx)++ & CAN_TRACE_MASK] = (uint8_t)(b))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Data bytes per DLC, classic frames stop at 8 */
+static const uint8_t s_au8DlcLength[2][16] =
+{
+	{0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 8U, 8U, 8U, 8U, 8U, 8U, 8U},
+	{0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* CAN0 trace recorder */
+can_trace_t CanTrace;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint32_t can_trace_varint_size(uint64_t u64Value);
+static uint32_t can_trace_put_varint(uint32_t u32Idx, uint64_t u64Value);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Varint size.
+* @details          Number of 7 bit groups needed for a value.
+* @param[in]        u64Value - Value.
+* @return           Encoded size in bytes (1-10).
+*/
+static uint32_t can_trace_varint_size(uint64_t u64Value)
+{
+	uint32_t u32Size = 1U;
+	uint32_t u32Low = (uint32_t)u64Value;
+
+	if (0U != (u64Value >> 32U))							/* Rare: gap of more than 2^32 ticks */
+	{
+		while (u64Value >= 0x80U)
+		{
+			u64Value >>= 7U;
+			u32Size++;
+		}
+		return u32Size;
+	}
+
+	while (u32Low >= 0x80U)									/* 32 bit shifts on the usual path */
+	{
+		u32Low >>= 7U;
+		u32Size++;
+	}
+	return u32Size;
+}
+
+/**
+* @brief            Put varint.
+* @details          Store a value as 7 bit groups, least significant first, bit 7 set on all but the last.
+*                   The caller has checked the space.
+* @param[in]        u32Idx - Write index.
+* @param[in]        u64Value - Value.
+* @return           Write index after the value.
+*/
+static uint32_t can_trace_put_varint(uint32_t u32Idx, uint64_t u64Value)
+{
+	uint32_t u32Low = 0U;
+
+	while (0U != (u64Value >> 32U))
+	{
+		CAN_TRACE_PUT(u32Idx, ((uint32_t)u64Value & 0x7FU) | 0x80U);
+		u64Value >>= 7U;
+	}
+
+	u32Low = (uint32_t)u64Value;
+	while (u32Low >= 0x80U)
+	{
+		CAN_TRACE_PUT(u32Idx, (u32Low & 0x7FU) | 0x80U);
+		u32Low >>= 7U;
+	}
+	CAN_TRACE_PUT(u32Idx, u32Low);
+
+	return u32Idx;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Start recording.
+* @details          Function to empty the trace buffer and record from time u64Now on. Call it with the
+*                   CAN0 interrupt disabled or before it is enabled.
+* @param[in]        u64Now - Current time (can_time_now()), the first record is relative to it.
+* @return           void.
+*/
+void can_trace_start(uint64_t u64Now)
+{
+	CanTrace.u32Head = 0U;
+	CanTrace.u32Tail = 0U;
+	CanTrace.u32Dropped = 0U;
+	CanTrace.u64Last = u64Now;
+	CanTrace.u8Running = 1U;
+}
+
+/**
+* @brief            Stop recording.
+* @details          Function to freeze the trace, e.g. when the fault shows up. Stored records stay readable.
+* @param        	void.
+* @return           void.
+*/
+void can_trace_stop(void)
+{
+	CanTrace.u8Running = 0U;
+}
+
+/**
+* @brief            Record frame.
+* @details          Function to append one frame to the trace: flags byte, zigzag varint time delta to the
+*                   previous record, varint ID, then the data bytes. Called from the CAN0 interrupt only.
+* @param[in]        u8Dir - CAN_TRACE_RX or CAN_TRACE_TX, ORed with CAN_TRACE_FDF/BRS for CAN FD frames.
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @param[in]        u64Time - Frame time stamp (64 bit timebase).
+* @param[in]        pu32Data - Data words, MB byte order.
+* @param[in]        u8Dlc - DLC (0-8, 0-15 for CAN FD).
+* @return           1 if stored, 0 if stopped or dropped because the buffer was full.
+*/
+uint8_t can_trace_record(uint8_t u8Dir, uint32_t u32Id, uint64_t u64Time, const uint32_t *pu32Data, uint8_t u8Dlc)
+{
+	uint32_t u32Head = CanTrace.u32Head;
+	uint64_t u64Delta = u64Time - CanTrace.u64Last;
+	uint32_t u32RawId = u32Id & ~CAN_ID_EXT_FLAG;
+	uint32_t u32Length = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Word = 0U;
+	uint8_t u8Flags = 0U;
+
+	if (0U == CanTrace.u8Running)
+	{
+		return 0U;
+	}
+
+	u8Dlc &= CAN_TRACE_DLC_MASK;
+	u32Length = s_au8DlcLength[(0U != (u8Dir & CAN_TRACE_FDF)) ? 1U : 0U][u8Dlc];
+	u8Flags = (uint8_t)((u8Dir & (CAN_TRACE_TX | CAN_TRACE_FDF | CAN_TRACE_BRS))
+					  | ((0U != (u32Id & CAN_ID_EXT_FLAG)) ? CAN_TRACE_IDE : 0U)
+					  | u8Dlc);
+
+	/* Zigzag: a TX completion handled after a later RX frame gives a small negative delta */
+	u64Delta = (u64Delta << 1U) ^ (0U - (u64Delta >> 63U));
+
+	if ((CAN_TRACE_SIZE - (u32Head - CanTrace.u32Tail))
+		< (1U + can_trace_varint_size(u64Delta) + can_trace_varint_size(u32RawId) + u32Length))
+	{
+		CanTrace.u32Dropped++;								/* Buffer full: keep the older records */
+		return 0U;
+	}
+
+	CAN_TRACE_PUT(u32Head, u8Flags);
+	u32Head = can_trace_put_varint(u32Head, u64Delta);
+	u32Head = can_trace_put_varint(u32Head, u32RawId);
+
+	for (u32Index = 0U; u32Index < u32Length; u32Index++)	/* Byte 0 is the MSB of data word 0 */
+	{
+		if (0U == (u32Index & 3U))
+		{
+			u32Word = pu32Data[u32Index >> 2U];
+		}
+		CAN_TRACE_PUT(u32Head, u32Word >> 24U);
+		u32Word <<= 8U;
+	}
+
+	CanTrace.u64Last = u64Time;
+	CAN_TRACE_BARRIER();
+	CanTrace.u32Head = u32Head;								/* Publish the record to the reader */
+
+	return 1U;
+}
+
+/**
+* @brief            Write stream header.
+* @details          Function to write the CAN_TRACE_HEADER_SIZE byte header that starts a trace dump.
+* @param[out]       pu8Buf - Header bytes.
+* @param[in]        u32TickHz - Timebase tick rate, FLEXCAN0_BITRATE for the CAN0 timebase.
+* @return           void.
+*/
+void can_trace_header(uint8_t *pu8Buf, uint32_t u32TickHz)
+{
+	pu8Buf[0] = (uint8_t)'C';
+	pu8Buf[1] = (uint8_t)'T';
+	pu8Buf[2] = (uint8_t)'R';
+	pu8Buf[3] = CAN_TRACE_VERSION;
+	pu8Buf[4] = (uint8_t)u32TickHz;
+	pu8Buf[5] = (uint8_t)(u32TickHz >> 8U);
+	pu8Buf[6] = (uint8_t)(u32TickHz >> 16U);
+	pu8Buf[7] = (uint8_t)(u32TickHz >> 24U);
+}
+
+/**
+* @brief            Read trace.
+* @details          Function to move up to u32Size bytes of recorded data out of the buffer. Records may be
+*                   split between reads; the concatenated output after the header is the trace stream.
+* @param[out]       pu8Buf - Destination.
+* @param[in]        u32Size - Destination size in bytes.
+* @return           Number of bytes copied.
+*/
+uint32_t can_trace_read(uint8_t *pu8Buf, uint32_t u32Size)
+{
+	uint32_t u32Tail = CanTrace.u32Tail;
+	uint32_t u32Count = CanTrace.u32Head - u32Tail;
+	uint32_t u32Index = 0U;
+
+	if (u32Count > u32Size)
+	{
+		u32Count = u32Size;
+	}
+
+	CAN_TRACE_BARRIER();
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		pu8Buf[u32Index] = CanTrace.au8Buf[(u32Tail + u32Index) & CAN_TRACE_MASK];
+	}
+	CAN_TRACE_BARRIER();
+	CanTrace.u32Tail = u32Tail + u32Count;					/* Release the bytes to the recorder */
+
+	return u32Count;
+}
+
+
+/* END can_trace */
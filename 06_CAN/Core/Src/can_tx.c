@@ -0,0 +1,388 @@
+/**
+* @file				can_tx.c
+* @brief            FlexCAN multi-mailbox transmit engine
+*/
+ 
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_tx.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Queued frame */
+typedef struct
+{
+	uint32_t u32Key;			/* Arbitration priority, lower value wins */
+	uint32_t u32Seq;			/* Queue order, keeps frames with equal keys in call order */
+	uint32_t u32Id;				/* Standard ID, or extended ID with CAN_ID_EXT_FLAG set */
+	uint32_t u32Data[2];		/* Data (2 words, MB byte order) */
+	uint8_t u8Length;			/* Number of data bytes */
+	uint64_t u64Request;		/* Time of the can_send() call */
+} can_tx_entry_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* IRQ81-CAN0 ORed MB 0-15: masked while the queue and MB pool are updated from thread mode. DSB/ISB
+   make the ICER write take effect before the next instruction, so IRQ81 cannot be taken inside */
+#define CAN_TX_IRQ_BIT		(1U << (81 % 32))
+#define CAN_TX_LOCK()		do { S32_NVIC->ICER[2] = CAN_TX_IRQ_BIT; FLEXCAN_IRQ_BARRIER(); } while (0)
+#define CAN_TX_UNLOCK()		(S32_NVIC->ISER[2] = CAN_TX_IRQ_BIT)
+
+/* No free transmit MB */
+#define CAN_TX_NO_MB		(0xFFU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Software priority queue, binary min-heap on (u32Key, u32Seq) */
+static can_tx_entry_t s_aQueue[CAN_TX_QUEUE_SIZE];
+
+/* Number of frames in s_aQueue */
+static uint32_t s_u32QueueCount = 0U;
+
+/* Sequence number given to the next queued frame */
+static uint32_t s_u32Seq = 0U;
+
+/* Frames refused because the queue was full */
+static uint32_t s_u32Dropped = 0U;
+
+/* Transmit MBs currently loaded, one bit per MB */
+static uint32_t s_u32BusyMbs = 0U;
+
+/* ID loaded in each transmit MB of the pool */
+static uint32_t s_au32MbId[CAN_TX_MB_COUNT];
+
+/* Data length of the frame loaded in each transmit MB of the pool */
+static uint8_t s_au8MbLength[CAN_TX_MB_COUNT];
+
+/* can_send() time of the frame loaded in each transmit MB of the pool */
+static uint64_t s_au64MbRequest[CAN_TX_MB_COUNT];
+
+/* TX complete callback */
+static can_tx_callback_t s_pfCallback = NULL;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint32_t can_tx_key(uint32_t u32Id);
+static uint8_t can_tx_before(const can_tx_entry_t *pA, const can_tx_entry_t *pB);
+static void can_tx_queue_push(const can_tx_entry_t *pEntry);
+static void can_tx_queue_pop(can_tx_entry_t *pEntry);
+static uint8_t can_tx_id_busy(uint32_t u32Id);
+static void can_tx_refill(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Arbitration key.
+* @details          Map an ID to the order the bus arbitrates it: 11 bit base ID, then IDE
+*                   (standard wins over extended with the same base ID), then the 18 bit ID extension.
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @return           Key, lower value wins arbitration.
+*/
+static uint32_t can_tx_key(uint32_t u32Id)
+{
+	if (0U != (u32Id & CAN_ID_EXT_FLAG))
+	{
+		return ((u32Id & 0x1FFC0000U) << 1U) | 0x00040000U | (u32Id & 0x0003FFFFU);
+	}
+	return (u32Id & 0x7FFU) << 19U;
+}
+
+/**
+* @brief            Compare queued frames.
+* @param[in]        pA - Frame A.
+* @param[in]        pB - Frame B.
+* @return           1 if A must be sent before B.
+*/
+static uint8_t can_tx_before(const can_tx_entry_t *pA, const can_tx_entry_t *pB)
+{
+	if (pA->u32Key != pB->u32Key)
+	{
+		return (uint8_t)(pA->u32Key < pB->u32Key);
+	}
+	return (uint8_t)((int32_t)(pA->u32Seq - pB->u32Seq) < 0);	/* Wrap safe call order */
+}
+
+/**
+* @brief            Insert frame into the heap.
+* @param[in]        pEntry - Frame, the queue must not be full.
+* @return           void.
+*/
+static void can_tx_queue_push(const can_tx_entry_t *pEntry)
+{
+	uint32_t u32Pos = s_u32QueueCount++;
+	uint32_t u32Parent = 0U;
+
+	while (u32Pos > 0U)						/* Sift up */
+	{
+		u32Parent = (u32Pos - 1U) >> 1U;
+		if (0U == can_tx_before(pEntry, &s_aQueue[u32Parent]))
+		{
+			break;
+		}
+		s_aQueue[u32Pos] = s_aQueue[u32Parent];
+		u32Pos = u32Parent;
+	}
+	s_aQueue[u32Pos] = *pEntry;
+}
+
+/**
+* @brief            Remove highest priority frame from the heap.
+* @param[out]       pEntry - Frame, the queue must not be empty.
+* @return           void.
+*/
+static void can_tx_queue_pop(can_tx_entry_t *pEntry)
+{
+	uint32_t u32Pos = 0U;
+	uint32_t u32Child = 0U;
+	can_tx_entry_t *pLast = NULL;
+
+	*pEntry = s_aQueue[0];
+	pLast = &s_aQueue[--s_u32QueueCount];
+
+	for (;;)								/* Sift the last entry down from the root */
+	{
+		u32Child = (u32Pos << 1U) + 1U;
+		if (u32Child >= s_u32QueueCount)
+		{
+			break;
+		}
+		if (((u32Child + 1U) < s_u32QueueCount) && (0U != can_tx_before(&s_aQueue[u32Child + 1U], &s_aQueue[u32Child])))
+		{
+			u32Child++;
+		}
+		if (0U == can_tx_before(&s_aQueue[u32Child], pLast))
+		{
+			break;
+		}
+		s_aQueue[u32Pos] = s_aQueue[u32Child];
+		u32Pos = u32Child;
+	}
+	s_aQueue[u32Pos] = *pLast;
+}
+
+/**
+* @brief            Check pending ID.
+* @param[in]        u32Id - Frame ID.
+* @return           1 if a transmit MB already holds a frame with this ID.
+*/
+static uint8_t can_tx_id_busy(uint32_t u32Id)
+{
+	uint8_t u8Index = 0U;
+
+	for (u8Index = 0U; u8Index < CAN_TX_MB_COUNT; u8Index++)
+	{
+		if ((0U != ((s_u32BusyMbs >> (CAN_TX_MB_FIRST + u8Index)) & 1U)) && (s_au32MbId[u8Index] == u32Id))
+		{
+			return 1U;
+		}
+	}
+	return 0U;
+}
+
+/**
+* @brief            Refill transmit MBs.
+* @details          Load queued frames into free MBs, highest priority first. All loaded MBs take part in
+*                   the next arbitration (CTRL1[LBUF]=0: lowest ID first), so frames leave back to back.
+*                   A frame whose ID is still pending in an MB waits, to keep same-ID frames in order.
+* @param        	void.
+* @return           void.
+*/
+static void can_tx_refill(void)
+{
+	can_tx_entry_t entry;
+	uint32_t u32Free = 0U;
+	uint8_t u8Mb = 0U;
+
+	while (s_u32QueueCount > 0U)
+	{
+		u32Free = CAN_TX_MB_MASK & ~s_u32BusyMbs;
+		if ((0U == u32Free) || (0U != can_tx_id_busy(s_aQueue[0].u32Id)))
+		{
+			break;
+		}
+
+		for (u8Mb = CAN_TX_MB_FIRST; 0U == ((u32Free >> u8Mb) & 1U); u8Mb++)	/* Lowest free MB */
+		{
+		}
+
+		can_tx_queue_pop(&entry);
+		s_au32MbId[u8Mb - CAN_TX_MB_FIRST] = entry.u32Id;
+		s_au64MbRequest[u8Mb - CAN_TX_MB_FIRST] = entry.u64Request;
+		s_au8MbLength[u8Mb - CAN_TX_MB_FIRST] = entry.u8Length;
+		s_u32BusyMbs |= 1UL << u8Mb;
+		FLEXCAN0_write_mb(u8Mb, entry.u32Id, entry.u32Data, entry.u8Length);
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Transmit engine Initialization.
+* @details          Function to inactivate the transmit MB pool, empty the queue and enable TX MB interrupts.
+*                   IRQ81 is left enabled or disabled in the NVIC as it was found.
+* @param[in]        pfCallback - TX complete callback, may be NULL.
+* @return           void.
+*/
+void can_tx_init(can_tx_callback_t pfCallback)
+{
+	uint32_t u32IrqEnabled = S32_NVIC->ISER[2] & CAN_TX_IRQ_BIT;
+	uint8_t u8Mb = 0U;
+
+	CAN_TX_LOCK();
+	for (u8Mb = CAN_TX_MB_FIRST; u8Mb < (CAN_TX_MB_FIRST + CAN_TX_MB_COUNT); u8Mb++)
+	{
+		FLEXCAN0_set_mb_code(u8Mb, FLEXCAN_TX_INACTIVE);	/* CODE=8: TX inactive */
+	}
+	s_u32QueueCount = 0U;
+	s_u32Seq = 0U;
+	s_u32Dropped = 0U;
+	s_u32BusyMbs = 0U;
+	s_pfCallback = pfCallback;
+	FLEXCAN0_enable_mb_interrupts(CAN_TX_MB_MASK);	/* TX complete raises the MB interrupt */
+	if (0U != u32IrqEnabled)
+	{
+		CAN_TX_UNLOCK();							/* NVIC_init_IRQs() enables it otherwise */
+	}
+}
+
+/**
+* @brief            Send frame.
+* @details          Function to queue a data frame for transmission without blocking. Frames leave in
+*                   CAN priority order (lowest ID first); frames with the same ID leave in call order.
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @param[in]        pu8Data - Data bytes.
+* @param[in]        u8Length - Number of data bytes (0-8).
+* @return           1 if queued, 0 if the queue was full or the length is invalid.
+*/
+uint8_t can_send(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	can_tx_entry_t entry;
+	uint8_t u8Index = 0U;
+
+	if (u8Length > 8U)
+	{
+		return 0U;
+	}
+
+	entry.u64Request = can_time_now();
+	entry.u32Id = u32Id;
+	entry.u32Key = can_tx_key(u32Id);
+	entry.u8Length = u8Length;
+	entry.u32Data[0] = 0U;
+	entry.u32Data[1] = 0U;
+	for (u8Index = 0U; u8Index < u8Length; u8Index++)	/* Byte 0 goes to the MSB of data word 0 */
+	{
+		entry.u32Data[u8Index >> 2U] |= (uint32_t)pu8Data[u8Index] << (24U - 8U*(u8Index & 3U));
+	}
+
+	CAN_TX_LOCK();
+	if (s_u32QueueCount >= CAN_TX_QUEUE_SIZE)
+	{
+		s_u32Dropped++;
+		CAN_TX_UNLOCK();
+		return 0U;
+	}
+	entry.u32Seq = s_u32Seq++;
+	can_tx_queue_push(&entry);
+	can_tx_refill();							/* Goes straight to an MB when one is free */
+	CAN_TX_UNLOCK();
+
+	return 1U;
+}
+
+/**
+* @brief            Get queued frames.
+* @details          Function to return the number of frames waiting for a free transmit MB.
+* @param	        void.
+* @return           Number of frames.
+*/
+uint32_t can_tx_pending(void)
+{
+	return s_u32QueueCount;
+}
+
+/**
+* @brief            Get dropped frames.
+* @details          Function to return the number of frames refused because the queue was full.
+* @param	        void.
+* @return           Number of frames.
+*/
+uint32_t can_tx_dropped(void)
+{
+	return s_u32Dropped;
+}
+
+/**
+* @brief            Transmit MB interrupt handling.
+* @details          Function to release completed transmit MBs, report them and refill them from the queue.
+*                   Called from the CAN0 MB interrupt.
+* @param[in]        u32Flags - Flagged MBs (IFLAG1), only the transmit pool bits are used.
+* @return           void.
+*/
+void can_tx_isr(uint32_t u32Flags)
+{
+	uint32_t au32DoneId[CAN_TX_MB_COUNT];
+	uint32_t au32Data[2];
+	uint64_t u64Time = 0U;
+	volatile flexcan_mb_t *pMb = NULL;
+	uint8_t u8Index = 0U;
+
+	u32Flags &= CAN_TX_MB_MASK & s_u32BusyMbs;
+	if (0U == u32Flags)
+	{
+		return;
+	}
+
+	for (u8Index = 0U; u8Index < CAN_TX_MB_COUNT; u8Index++)
+	{
+		au32DoneId[u8Index] = s_au32MbId[u8Index];		/* Keep IDs, refill reuses the MBs */
+		if (0U != ((u32Flags >> (CAN_TX_MB_FIRST + u8Index)) & 1U))
+		{
+			pMb = FLEXCAN_MB(FLEXCAN0_INST, CAN_TX_MB_FIRST + u8Index);
+			u64Time = can_time_extend((uint16_t)(pMb->CS & FLEXCAN_MB_CS_TIME_MASK));
+			can_stats_tx(CAN_TX_MB_FIRST + u8Index, s_au32MbId[u8Index], s_au8MbLength[u8Index]);
+			can_lat_record(&CanLatTx, s_au64MbRequest[u8Index], u64Time);	/* Request to TX time stamp */
+			au32Data[0] = pMb->DATA[0];					/* Sent data is still in the MB */
+			au32Data[1] = pMb->DATA[1];
+			(void)can_trace_record(CAN_TRACE_TX, s_au32MbId[u8Index], u64Time, au32Data, s_au8MbLength[u8Index]);
+		}
+	}
+
+	FLEXCAN0_BASE->IFLAG1 = u32Flags;					/* Clear all completed TX MB flags at once */
+	s_u32BusyMbs &= ~u32Flags;
+
+	can_tx_refill();							/* Reload freed MBs before reporting, keeps the bus busy */
+
+	for (u8Index = 0U; u8Index < CAN_TX_MB_COUNT; u8Index++)
+	{
+		if ((0U != ((u32Flags >> (CAN_TX_MB_FIRST + u8Index)) & 1U)) && (NULL != s_pfCallback))
+		{
+			s_pfCallback(au32DoneId[u8Index]);
+		}
+	}
+}
+
+
+/* END can_tx */
@@ -10,6 +10,7 @@
 * 3) internal and external interfaces from this unit
 ==================================================================================================*/
 #include "flexcan.h"
+#include "flexcan_timing.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
@@ -18,8 +19,12 @@
 /*==================================================================================================
 *                                       LOCAL MACROS
 ==================================================================================================*/
-/* Msg Buffer Size. (CAN 2.0AB: 2 hdr +  2 data= 4 words) */
-#define MSG_BUF_SIZE		(4U)
+#if !FLEXCAN_CTRL1_VALID(FLEXCAN0_CLK_HZ, FLEXCAN0_BITRATE, FLEXCAN0_SAMPLE_POINT)
+#error "FLEXCAN0: bit rate / sample point not reachable with CTRL1 segment ranges"
+#endif
+
+/* Index of the lowest set bit, x != 0 (RBIT + CLZ on Cortex-M4) */
+#define FLEXCAN_CTZ(x)		((uint32_t)__builtin_ctz(x))
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
@@ -51,78 +56,248 @@ uint32_t RxDATA[2] = {0U};
 /* Received message time */
 uint32_t RxTIMESTAMP = 0U;
 
+/* Frames lost because the RX FIFO was full */
+uint32_t RxFifoOverflow = 0U;
+
 /*==================================================================================================
 *                                   LOCAL FUNCTION PROTOTYPES
 ==================================================================================================*/
+static void FLEXCAN0_enter_config(void);
+static void FLEXCAN0_leave_config(uint32_t u32Mcr);
+static void FLEXCAN0_copy_mb(uint8_t u8Mb, can_frame_t *pFrame);
+static uint8_t FLEXCAN0_setup_rx_fifo(uint8_t u8Format, const uint32_t *pu32Filters, const uint32_t *pu32Masks, uint8_t u8Count, uint32_t u32Mcr);
+static uint32_t FLEXCAN0_freeze(void);
 
 /*==================================================================================================
 *                                       LOCAL FUNCTIONS
 ==================================================================================================*/
-
-/*==================================================================================================
-*                                       GLOBAL FUNCTIONS
-==================================================================================================*/
 /**
-* @brief            FlexCAN0 Initialization.
-* @details          Function to initialize FLEXCAN0 for 500 KHz bit time, clears CAN0 32 msg bufs.
+* @brief            Enter configuration.
+* @details          Enable the FlexCAN0 clock, enter freeze mode, configure 500 KHz bit time and clear
+*                   all 32 msg bufs.
 * @param        	void.
 * @return           void.
 */
-void FLEXCAN0_init(void)
+static void FLEXCAN0_enter_config(void)
 {
+	FLEXCAN_enter_freeze(FLEXCAN0_INST, 0U);	/* CLKSRC=0: Clock Source = oscillator (8 MHz) */
 
+	FLEXCAN0_BASE->CTRL1 = FLEXCAN_CTRL1_TIMING(FLEXCAN0_CLK_HZ, FLEXCAN0_BITRATE, FLEXCAN0_SAMPLE_POINT)
+											/* 500 KHz, 75%: 16 time quanta, PRESDIV = 0               */
+											/* PSEG2 = Phase_Seg2 - 1 = 4 - 1 = 3                           */
+											/* PSEG1 = PSEG2 = 3                                            */
+											/* PROPSEG= Prop_Seg - 1 = 7 - 1 = 6                            */
+											/* RJW: since Phase_Seg2 >=4, RJW+1=4 so RJW=3.                 */
+				|CAN_CTRL1_SMP(1U);        	/* SMP = 1: use 3 bits per CAN sample                           */
+											/* CLKSRC=0 (unchanged): Fcanclk= Fosc= 8 MHz                   */
+
+	FLEXCAN_reset_mbs(FLEXCAN0_INST);		/* CAN0: clear 32 msg bufs x 4 words/msg buf = 128 words, all masks */
+}
+
+/**
+* @brief            Leave configuration.
+* @details          Write the final MCR value, which negates FRZ/HALT, and wait for the module to be ready.
+* @param[in]        u32Mcr - MCR value.
+* @return           void.
+*/
+static void FLEXCAN0_leave_config(uint32_t u32Mcr)
+{
+	FLEXCAN_leave_freeze(FLEXCAN0_INST, u32Mcr);
+}
+
+/**
+* @brief            Copy msg buffer.
+* @details          Copy a frame out of a msg buffer. Reading the C/S word locks the MB; the caller unlocks
+*                   it (TIMER read or next MB lock) and clears its flag.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[out]       pFrame - Received frame.
+* @return           void.
+*/
+static void FLEXCAN0_copy_mb(uint8_t u8Mb, can_frame_t *pFrame)
+{
+	volatile flexcan_mb_t *pMb = FLEXCAN_MB(FLEXCAN0_INST, u8Mb);
+	uint32_t u32Cs = 0U;
+	uint32_t u32Id = 0U;
+
+	u32Cs = pMb->CS;							/* Read C/S word first: locks the MB */
+	u32Id = pMb->ID;							/* Read ID word */
+	pFrame->u32Data[0] = pMb->DATA[0];			/* Read data word 0 */
+	pFrame->u32Data[1] = pMb->DATA[1];			/* Read data word 1 */
+
+	pFrame->u32Id = FLEXCAN_MB_FRAME_ID(u32Cs, u32Id);	/* Standard ID, or extended ID with CAN_ID_EXT_FLAG */
+	pFrame->u8Code = (uint8_t)((u32Cs & FLEXCAN_MB_CS_CODE_MASK) >> FLEXCAN_MB_CS_CODE_SHIFT);
+	pFrame->u8Length = (uint8_t)((u32Cs & FLEXCAN_MB_CS_DLC_MASK) >> FLEXCAN_MB_CS_DLC_SHIFT);
+	pFrame->u16Timestamp = (uint16_t)(u32Cs & FLEXCAN_MB_CS_TIME_MASK);
+	pFrame->u64Timestamp = 0U;					/* Extended later, see can_time_extend() */
+	pFrame->u8Mb = u8Mb;
+}
+
+/**
+* @brief            Set up RX FIFO.
+* @details          Initialize FLEXCAN0 with the legacy RX FIFO and its filter table, see FLEXCAN0_init_rx_fifo().
+* @param[in]        u8Format - Filter element format (FLEXCAN_FIFO_FORMAT_A/B/C).
+* @param[in]        pu32Filters - Filter elements, built with FLEXCAN_FIFO_ID_A/B/C.
+* @param[in]        pu32Masks - Individual mask per element in the same format, NULL to check all bits.
+* @param[in]        u8Count - Number of filter elements, 1 to FLEXCAN0_FIFO_MAX_FILTERS.
+* @param[in]        u32Mcr - Additional MCR bits (CAN_MCR_DMA_MASK or 0).
+* @return           1 if set up, 0 if u8Count is out of range (module left as it was).
+*/
+static uint8_t FLEXCAN0_setup_rx_fifo(uint8_t u8Format, const uint32_t *pu32Filters, const uint32_t *pu32Masks, uint8_t u8Count, uint32_t u32Mcr)
+{
 	uint32_t u32Index = 0U;
+	uint32_t u32Rffn = 0U;
+	uint32_t u32Elements = 0U;
+
+	if ((0U == u8Count) || (u8Count > FLEXCAN_FIFO_MAX_ELEMENTS) || (u8Count > FLEXCAN0_FIFO_MAX_FILTERS))
+	{
+		return 0U;								/* RFFN>12, or the table would reach the transmit pool */
+	}
+
+	u32Rffn = ((uint32_t)u8Count + 7U) / 8U - 1U;	/* RFFN: (RFFN+1) x 8 filter elements */
+	u32Elements = (u32Rffn + 1U) * 8U;
 
-	PCC->PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK; 	/* CGC=1: enable clock to FlexCAN0 */
+	FLEXCAN0_enter_config();					/* Clock, freeze mode, bit timing, clear msg bufs */
 
-	CAN0->MCR |= CAN_MCR_MDIS_MASK;         				/* MDIS=1: Disable module before selecting clock  */
-	CAN0->CTRL1 &= ~CAN_CTRL1_CLKSRC_MASK;  				/* CLKSRC=0: Clock Source = oscillator (8 MHz)    */
-	CAN0->MCR &= ~CAN_MCR_MDIS_MASK;        				/* MDIS=0; Enable module config. (Sets FRZ, HALT) */
+	FLEXCAN0_BASE->CTRL2 = (FLEXCAN0_BASE->CTRL2 & ~CAN_CTRL2_RFFN_MASK) | CAN_CTRL2_RFFN(u32Rffn);
 
-	while (!((CAN0->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT))  /* wait for FRZACK=1 on freeze mode entry/exit */
+	for (u32Index = 0U; u32Index < u32Elements; u32Index++)
 	{
+		/* Filter table starts at MB6 word 0 */
+		FLEXCAN0_BASE->RAMn[6U*FLEXCAN_MB_WORDS(FLEXCAN0_INST) + u32Index] = pu32Filters[(u32Index < u8Count) ? u32Index : (u8Count - 1U)];
 	}
 
-	CAN0->CTRL1 = CAN_CTRL1_PSEG2(3U)  		/* Configure for 500 KHz bit time                               */
-				|CAN_CTRL1_PSEG1(3U)       	/* Time quanta freq = 16 time quanta x 500 KHz bit time= 8MHz   */
-				|CAN_CTRL1_PROPSEG(6U)     	/* PRESDIV+1 = Fclksrc/Ftq = 8 MHz/8 MHz = 1                    */
-				|CAN_CTRL1_RJW(3U)         	/*    so PRESDIV = 0                                            */
-				|CAN_CTRL1_SMP(1U);        	/* PSEG2 = Phase_Seg2 - 1 = 4 - 1 = 3                           */
-											/* PSEG1 = PSEG2 = 3                                            */
-											/* PROPSEG= Prop_Seg - 1 = 7 - 1 = 6                            */
-											/* RJW: since Phase_Seg2 >=4, RJW+1=4 so RJW=3.                 */
-											/* SMP = 1: use 3 bits per CAN sample                           */
-											/* CLKSRC=0 (unchanged): Fcanclk= Fosc= 8 MHz                   */
- 
-	for(u32Index = 0U; u32Index < 128U; u32Index++)		/* CAN0: clear 32 msg bufs x 4 words/msg buf = 128 words */
-	{                    
-		CAN0->RAMn[u32Index] = 0U;  					/* Clear msg buf word */
+	for (u32Index = 0U; u32Index < 32U; u32Index++)		/* Elements with an individual mask (IRMQ=1) */
+	{
+		FLEXCAN0_BASE->RXIMR[u32Index] = ((NULL != pu32Masks) && (u32Index < u8Count)) ? pu32Masks[u32Index] : 0xFFFFFFFFU;
 	}
-	
-	for(u32Index = 0U; u32Index < 16U; u32Index++)		/* In FRZ mode, init CAN0 16 msg buf filters */
-	{                                 						
-		CAN0->RXIMR[u32Index] = 0xFFFFFFFFU;    		/* Check all ID bits for incoming messages */
+
+	FLEXCAN0_BASE->RXFGMASK = 0xFFFFFFFFU;				/* Elements past the individual masks: check all bits */
+
+	FLEXCAN0_leave_config(u32Mcr
+						| CAN_MCR_RFEN_MASK			/* RFEN=1: legacy RX FIFO enabled */
+						| CAN_MCR_IRMQ_MASK			/* IRMQ=1: individual masks */
+						| CAN_MCR_IDAM(u8Format)	/* IDAM: filter element format */
+						| CAN_MCR_MAXMB(31U));		/* Negate halt state for 32 MBs */
+
+	return 1U;
+}
+
+/**
+* @brief            Freeze running module.
+* @details          Request freeze mode on the running module and wait for it, e.g. to change a freeze-only
+*                   setting. Msg buffer contents are kept. FLEXCAN0_leave_config() resumes.
+* @param        	void.
+* @return           MCR value to resume with, FRZ/HALT negated.
+*/
+static uint32_t FLEXCAN0_freeze(void)
+{
+	uint32_t u32Mcr = FLEXCAN0_BASE->MCR & ~(CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK);
+
+	FLEXCAN0_BASE->MCR = u32Mcr | CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK;	/* Request freeze mode */
+	while (!((FLEXCAN0_BASE->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT))  /* wait for FRZACK=1 */
+	{
+		FLEXCAN_POLL_HOOK(FLEXCAN0_BASE);
 	}
+
+	return u32Mcr;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            FlexCAN0 Initialization.
+* @details          Function to initialize FLEXCAN0 for 500 KHz bit time, clears CAN0 32 msg bufs.
+* @param        	void.
+* @return           void.
+*/
+void FLEXCAN0_init(void)
+{
+	FLEXCAN0_enter_config();					/* Clock, freeze mode, bit timing, clear msg bufs and masks */
 	
-	CAN0->RXMGMASK = 0x1FFFFFFFU;                  		/* Global acceptance mask: check all ID bits    */
-	
-	CAN0->RAMn[4U*MSG_BUF_SIZE + 0U] = 0x04000000U; 	/* Msg Buf 4, word 0: Enable for reception  */
+	FLEXCAN_MB(FLEXCAN0_INST, 4U)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_RX_EMPTY, 0U);
+														/* Msg Buf 4, word 0: Enable for reception  */
 														/* EDL,BRS,ESI=0: CANFD not used                */
 														/* CODE=4: MB set to RX inactive                */
 														/* IDE=0: Standard ID                           */
 														/* SRR, RTR, TIME STAMP = 0: not applicable     */
 	
-	CAN0->RAMn[4U*MSG_BUF_SIZE + 1U] = 0x14440000U; 	/* Msg Buf 4, word 1: Standard ID = 0x511       */
+	FLEXCAN_MB(FLEXCAN0_INST, 4U)->ID = FLEXCAN_MB_ID(0x511U);	/* Msg Buf 4, word 1: Standard ID = 0x511 */
+
+	FLEXCAN0_leave_config(CAN_MCR_MAXMB(FLEXCAN_MB_COUNT(FLEXCAN0_INST) - 1U));	/* Negate FlexCAN 1 halt state for 32 MBs */
+}
+
+/**
+* @brief            FlexCAN0 RX FIFO Initialization.
+* @details          Function to initialize FLEXCAN0 for 500 KHz bit time with the legacy RX FIFO enabled.
+*                   The FIFO output is MB0, MB0-5 hold the 6 FIFO frames, the filter table follows from MB6
+*                   (2 MBs per 8 filter elements). Elements past u8Count repeat the last element.
+*                   The table must end below the transmit pool (FLEXCAN0_TX_MB_FIRST): 8 elements with MB8.
+* @param[in]        u8Format - Filter element format (FLEXCAN_FIFO_FORMAT_A/B/C).
+* @param[in]        pu32Filters - Filter elements, built with FLEXCAN_FIFO_ID_A/B/C.
+* @param[in]        pu32Masks - Individual mask per element in the same format, NULL to check all bits.
+* @param[in]        u8Count - Number of filter elements, 1 to FLEXCAN0_FIFO_MAX_FILTERS.
+* @return           1 if set up, 0 if u8Count is out of range (module left as it was).
+*/
+uint8_t FLEXCAN0_init_rx_fifo(uint8_t u8Format, const uint32_t *pu32Filters, const uint32_t *pu32Masks, uint8_t u8Count)
+{
+	return FLEXCAN0_setup_rx_fifo(u8Format, pu32Filters, pu32Masks, u8Count, 0U);
+}
+
+/**
+* @brief            FlexCAN0 RX FIFO DMA Initialization.
+* @details          Function to initialize FLEXCAN0 like FLEXCAN0_init_rx_fifo() with the FIFO DMA request
+*                   enabled (MCR[DMA]=1). Frames available requests a DMA transfer instead of an interrupt;
+*                   the DMA reads MB0 (C/S, ID, DATA0, DATA1) and the read of the last word pops the FIFO.
+*                   The C/S word holds the filter element index (IDHIT) in bits 31:23.
+* @param[in]        u8Format - Filter element format (FLEXCAN_FIFO_FORMAT_A/B/C).
+* @param[in]        pu32Filters - Filter elements, built with FLEXCAN_FIFO_ID_A/B/C.
+* @param[in]        pu32Masks - Individual mask per element in the same format, NULL to check all bits.
+* @param[in]        u8Count - Number of filter elements, 1 to FLEXCAN0_FIFO_MAX_FILTERS.
+* @return           1 if set up, 0 if u8Count is out of range (module left as it was).
+*/
+uint8_t FLEXCAN0_init_rx_fifo_dma(uint8_t u8Format, const uint32_t *pu32Filters, const uint32_t *pu32Masks, uint8_t u8Count)
+{
+	return FLEXCAN0_setup_rx_fifo(u8Format, pu32Filters, pu32Masks, u8Count, CAN_MCR_DMA_MASK);	/* DMA=1: FIFO DMA request */
+}
 
-	CAN0->MCR = 0x0000001FU;       						/* Negate FlexCAN 1 halt state for 32 MBs */
+/**
+* @brief            FlexCAN0 filtered receive Initialization.
+* @details          Function to initialize FLEXCAN0 for 500 KHz bit time with one receive MB per filter,
+*                   from u8FirstMb on. Each MB checks only the ID bits of its filter mask (IRMQ=1).
+* @param[in]        pFilters - Filters, e.g. from can_filter_plan().
+* @param[in]        u8Count - Number of filters.
+* @param[in]        u8FirstMb - First receive MB.
+* @return           IFLAG1 bits of the receive MBs, 0 if the MBs would reach the transmit pool
+*                   (FLEXCAN0_TX_MB_FIRST) or u8Count is 0 (module left as it was).
+*/
+uint32_t FLEXCAN0_init_rx_filters(const can_filter_t *pFilters, uint8_t u8Count, uint8_t u8FirstMb)
+{
+	uint32_t u32Flags = 0U;
+	uint8_t u8Index = 0U;
+	uint8_t u8Mb = 0U;
 
-	while ((CAN0->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)  /* wait for FRZACK to clear (not in freeze mode) */
+	if ((0U == u8Count) || (((uint32_t)u8FirstMb + u8Count) > FLEXCAN0_TX_MB_FIRST))
 	{
+		return 0U;								/* Also keeps them in the ORed MB 0-15 interrupt */
 	}
 
-	while ((CAN0->MCR & CAN_MCR_NOTRDY_MASK) >> CAN_MCR_NOTRDY_SHIFT)  /* wait for NOTRDY to clear (module ready) */
+	FLEXCAN0_enter_config();					/* Clock, freeze mode, bit timing, clear msg bufs and masks */
+
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
 	{
+		u8Mb = u8FirstMb + u8Index;
+		FLEXCAN_MB(FLEXCAN0_INST, u8Mb)->ID = FLEXCAN_MB_ID(pFilters[u8Index].u32Id);
+		FLEXCAN_MB(FLEXCAN0_INST, u8Mb)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_RX_EMPTY, 0U)	/* CODE=4: MB empty, ready to receive */
+											| FLEXCAN_MB_CS_IDE(pFilters[u8Index].u32Id);		/* IDE is always compared */
+		FLEXCAN0_BASE->RXIMR[u8Mb] = FLEXCAN_MB_ID(pFilters[u8Index].u32Mask | (pFilters[u8Index].u32Id & CAN_ID_EXT_FLAG));
+		u32Flags |= 1UL << u8Mb;
 	}
+
+	FLEXCAN0_leave_config(CAN_MCR_IRMQ_MASK		/* IRMQ=1: individual masks */
+						| CAN_MCR_MAXMB(FLEXCAN_MB_COUNT(FLEXCAN0_INST) - 1U));	/* Negate halt state for 32 MBs */
+
+	return u32Flags;
 }
 
 /**
@@ -133,12 +308,12 @@ void FLEXCAN0_init(void)
 */
 void FLEXCAN0_transmit_msg(void)
 { 
-	CAN0->IFLAG1 = 0x00000001U;  				  /* Clear CAN 0 MB 0 flag without clearing others*/
+	FLEXCAN0_BASE->IFLAG1 = 0x00000001U;  				  /* Clear CAN 0 MB 0 flag without clearing others*/
 
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 2U] = 0xA5112233U; /* MB0 word 2: data word 0 */
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 3U] = 0x44556677U; /* MB0 word 3: data word 1 */
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 1U] = 0x15540000U; /* MB0 word 1: Tx msg with STD ID 0x555 */
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 0U] = 0x0C400000U | 8U << CAN_WMBn_CS_DLC_SHIFT;
+	FLEXCAN_MB(FLEXCAN0_INST, 0U)->DATA[0] = 0xA5112233U; /* MB0 word 2: data word 0 */
+	FLEXCAN_MB(FLEXCAN0_INST, 0U)->DATA[1] = 0x44556677U; /* MB0 word 3: data word 1 */
+	FLEXCAN_MB(FLEXCAN0_INST, 0U)->ID = 0x15540000U; 		/* MB0 word 1: Tx msg with STD ID 0x555 */
+	FLEXCAN_MB(FLEXCAN0_INST, 0U)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_TX_DATA, 8U) | FLEXCAN_MB_CS_SRR_MASK;
 													/* MB0 word 0:                              	*/
 													/* EDL,BRS,ESI=0: CANFD not used                */
 													/* CODE=0xC: Activate msg buf to transmit       */
@@ -159,21 +334,219 @@ void FLEXCAN0_receive_msg(void)
 	uint8_t u8Index = 0U;
 	uint32_t dummy = 0U;
 
-	RxCODE   = (CAN0->RAMn[4U*MSG_BUF_SIZE + 0U] & 0x07000000U) >> 24U;  							/* Read CODE field */
-	RxID     = (CAN0->RAMn[4U*MSG_BUF_SIZE + 1U] & CAN_WMBn_ID_ID_MASK)  >> CAN_WMBn_ID_ID_SHIFT;  	/* Read ID          */
-	RxLENGTH = (CAN0->RAMn[4U*MSG_BUF_SIZE + 0U] & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT; 	/* Read Message Length */
+	RxCODE   = (FLEXCAN_MB(FLEXCAN0_INST, 4U)->CS & 0x07000000U) >> 24U;  								/* Read CODE field */
+	RxID     = (FLEXCAN_MB(FLEXCAN0_INST, 4U)->ID & CAN_WMBn_ID_ID_MASK)  >> CAN_WMBn_ID_ID_SHIFT;  	/* Read ID          */
+	RxLENGTH = (FLEXCAN_MB(FLEXCAN0_INST, 4U)->CS & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT; 	/* Read Message Length */
 
 	for (u8Index = 0U; u8Index < 2U; u8Index++)
 	{  
 		/* Read two words of data (8 bytes) */
-		RxDATA[u8Index] = CAN0->RAMn[4U*MSG_BUF_SIZE + 2U + u8Index];
+		RxDATA[u8Index] = FLEXCAN_MB(FLEXCAN0_INST, 4U)->DATA[u8Index];
 	}
 	
-	RxTIMESTAMP = (CAN0->RAMn[0U*MSG_BUF_SIZE + 0U] & 0x000FFFFU);
+	RxTIMESTAMP = (FLEXCAN_MB(FLEXCAN0_INST, 4U)->CS & FLEXCAN_MB_CS_TIME_MASK);	/* Time stamp of MB4 */
 	
-	dummy = CAN0->TIMER;				/* Read TIMER to unlock message buffers */
+	dummy = FLEXCAN0_BASE->TIMER;				/* Read TIMER to unlock message buffers */
 	
-	CAN0->IFLAG1 = 0x00000010U;       	/* Clear CAN 0 MB 4 flag without clearing others*/
+	FLEXCAN0_BASE->IFLAG1 = 0x00000010U;       	/* Clear CAN 0 MB 4 flag without clearing others*/
+}
+
+/**
+* @brief            Read msg buffer.
+* @details          Function to copy a received frame out of a msg buffer and clear its flag.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[out]       pFrame - Received frame.
+* @return           void.
+*/
+void FLEXCAN0_read_mb(uint8_t u8Mb, can_frame_t *pFrame)
+{
+	uint32_t dummy = 0U;
+
+	FLEXCAN0_copy_mb(u8Mb, pFrame);			/* Copy frame, MB stays locked */
+
+	dummy = FLEXCAN0_BASE->TIMER;					/* Read TIMER to unlock message buffers */
+	(void)dummy;
+
+	FLEXCAN0_BASE->IFLAG1 = 1UL << u8Mb;				/* Clear this MB flag without clearing others */
+}
+
+/**
+* @brief            Receive all pending msg buffers.
+* @details          Function to read IFLAG1 once, copy every flagged MB of the mask in one pass (lowest MB
+*                   first) and clear each flag right after its copy, while the MB is still locked. A frame
+*                   that arrives for it later in the batch sets the flag again and is not lost.
+* @param[in]        u32MbMask - Msg buffers to service, one bit per MB.
+* @param[out]       pFrames - Received frames, room for one frame per bit set in u32MbMask.
+* @return           Number of frames copied.
+*/
+uint32_t FLEXCAN0_receive_all(uint32_t u32MbMask, can_frame_t *pFrames)
+{
+	uint32_t u32Flags = FLEXCAN0_BASE->IFLAG1 & u32MbMask;	/* Single read of the flag register */
+	uint32_t u32Pending = u32Flags;
+	uint32_t u32Count = 0U;
+	uint32_t dummy = 0U;
+
+	if (0U == u32Flags)
+	{
+		return 0U;
+	}
+
+	while (0U != u32Pending)
+	{
+		FLEXCAN0_copy_mb((uint8_t)FLEXCAN_CTZ(u32Pending), &pFrames[u32Count]);	/* Locking the next MB unlocks the previous one */
+		FLEXCAN0_BASE->IFLAG1 = u32Pending & (0U - u32Pending);	/* Clear this MB flag while it is locked (lowest set bit) */
+		u32Count++;
+		u32Pending &= u32Pending - 1U;		/* Clear lowest set bit */
+	}
+
+	dummy = FLEXCAN0_BASE->TIMER;					/* Read TIMER to unlock the last MB */
+	(void)dummy;
+
+	return u32Count;
+}
+
+/**
+* @brief            Read RX FIFO.
+* @details          Function to pop the oldest frame from the legacy RX FIFO. Frames come out in arrival order.
+*                   u8Code of the frame holds the index of the filter element that accepted it (RXFIR[IDHIT]).
+* @param[out]       pFrame - Received frame.
+* @return           1 if a frame was returned, 0 if the FIFO was empty.
+*/
+uint8_t FLEXCAN0_read_rx_fifo(can_frame_t *pFrame)
+{
+	uint32_t dummy = 0U;
+
+	if (0U != (FLEXCAN0_BASE->IFLAG1 & FLEXCAN_FIFO_OVERFLOW_FLAG))
+	{
+		RxFifoOverflow++;							/* A frame was lost: FIFO was full */
+		FLEXCAN0_BASE->IFLAG1 = FLEXCAN_FIFO_OVERFLOW_FLAG | FLEXCAN_FIFO_WARNING_FLAG;
+	}
+
+	if (0U == (FLEXCAN0_BASE->IFLAG1 & FLEXCAN_FIFO_AVAILABLE_FLAG))
+	{
+		return 0U;
+	}
+
+	FLEXCAN0_copy_mb(0U, pFrame);					/* FIFO output is MB0 */
+	pFrame->u8Code = (uint8_t)((FLEXCAN0_BASE->RXFIR & CAN_RXFIR_IDHIT_MASK) >> CAN_RXFIR_IDHIT_SHIFT);
+
+	dummy = FLEXCAN0_BASE->TIMER;							/* Read TIMER to unlock message buffers */
+	(void)dummy;
+
+	FLEXCAN0_BASE->IFLAG1 = FLEXCAN_FIFO_AVAILABLE_FLAG;		/* Release output, next frame moves up */
+
+	return 1U;
+}
+
+/**
+* @brief            Write msg buffer.
+* @details          Function to load a data frame into an inactive msg buffer and activate it for transmission.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[in]        u32Id - Standard ID, or extended ID with CAN_ID_EXT_FLAG set.
+* @param[in]        pu32Data - Data (2 words, MB byte order).
+* @param[in]        u8Length - Number of data bytes (0-8).
+* @return           void.
+*/
+void FLEXCAN0_write_mb(uint8_t u8Mb, uint32_t u32Id, const uint32_t *pu32Data, uint8_t u8Length)
+{
+	volatile flexcan_mb_t *pMb = FLEXCAN_MB(FLEXCAN0_INST, u8Mb);
+
+	pMb->DATA[0] = pu32Data[0];					/* word 2: data word 0 */
+	pMb->DATA[1] = pu32Data[1];					/* word 3: data word 1 */
+	pMb->ID = FLEXCAN_MB_ID(u32Id);				/* word 1: standard or extended ID */
+
+	pMb->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_TX_DATA, u8Length)	/* CODE=0xC: Activate msg buf to transmit */
+			| FLEXCAN_MB_CS_IDE(u32Id);			/* word 0 last: MB takes part in the next arbitration */
+}
+
+/**
+* @brief            Set msg buffer code.
+* @details          Function to write the CODE field of a msg buffer, clearing the rest of its C/S word.
+* @param[in]        u8Mb - Msg buffer number (0-31).
+* @param[in]        u8Code - CODE value (FLEXCAN_RX_xxx / FLEXCAN_TX_xxx).
+* @return           void.
+*/
+void FLEXCAN0_set_mb_code(uint8_t u8Mb, uint8_t u8Code)
+{
+	FLEXCAN_MB(FLEXCAN0_INST, u8Mb)->CS = (uint32_t)u8Code << FLEXCAN_MB_CS_CODE_SHIFT;
+}
+
+/**
+* @brief            Enable msg buffer interrupts.
+* @details          Function to clear pending flags and enable interrupts for the selected msg buffers.
+* @param[in]        u32MbMask - Msg buffers to enable, one bit per MB.
+* @return           void.
+*/
+void FLEXCAN0_enable_mb_interrupts(uint32_t u32MbMask)
+{
+	FLEXCAN0_BASE->IFLAG1 = u32MbMask;				/* Clear any stale flags (write 1 to clear) */
+	FLEXCAN0_BASE->IMASK1 |= u32MbMask;				/* BUFnM=1: MB flag raises an interrupt */
+}
+
+/**
+* @brief            Set loopback.
+* @details          Function to switch FLEXCAN0 loopback mode (CTRL1[LPB]) on or off, passing through freeze mode.
+*                   In loopback the transmitted frames are received by the own msg buffers / RX FIFO and the
+*                   CAN0_TX pin stays recessive. Msg buffer contents and the rest of the setup are kept.
+* @param[in]        u8Enable - 1: loopback, 0: normal mode.
+* @return           void.
+*/
+void FLEXCAN0_set_loopback(uint8_t u8Enable)
+{
+	uint32_t u32Mcr = FLEXCAN0_freeze();
+
+	if (0U != u8Enable)
+	{
+		FLEXCAN0_BASE->CTRL1 |= CAN_CTRL1_LPB_MASK;		/* LPB=1: transmitted frames are looped back internally */
+	}
+	else
+	{
+		FLEXCAN0_BASE->CTRL1 &= ~CAN_CTRL1_LPB_MASK;	/* LPB=0: normal bus operation */
+	}
+
+	FLEXCAN0_leave_config(u32Mcr);						/* Same MCR as before, FRZ/HALT negated */
+}
+
+
+/**
+* @brief            Enable error interrupts.
+* @details          Function to enable the bus off, bus off done, TX/RX warning and error interrupts and to
+*                   select the bus off recovery, passing through freeze mode (MCR[WRNEN] is freeze-only).
+* @param[in]        u8Manual - 0: automatic bus off recovery, 1: stay bus off until BOFFREC is negated.
+* @return           void.
+*/
+void FLEXCAN0_enable_error_interrupts(uint8_t u8Manual)
+{
+	uint32_t u32Mcr = FLEXCAN0_freeze();
+
+	FLEXCAN0_BASE->CTRL1 = (FLEXCAN0_BASE->CTRL1 & ~CAN_CTRL1_BOFFREC_MASK)
+						 | CAN_CTRL1_BOFFMSK_MASK			/* BOFFMSK=1: bus off interrupt */
+						 | CAN_CTRL1_ERRMSK_MASK			/* ERRMSK=1: error interrupt */
+						 | CAN_CTRL1_TWRNMSK_MASK			/* TWRNMSK=1: TX warning interrupt */
+						 | CAN_CTRL1_RWRNMSK_MASK			/* RWRNMSK=1: RX warning interrupt */
+						 | ((0U != u8Manual) ? CAN_CTRL1_BOFFREC_MASK : 0U);	/* BOFFREC=1: no automatic recovery */
+	FLEXCAN0_BASE->CTRL2 |= CAN_CTRL2_BOFFDONEMSK_MASK;	/* BOFFDONEMSK=1: bus off done interrupt */
+
+	FLEXCAN0_leave_config(u32Mcr | CAN_MCR_WRNEN_MASK);	/* WRNEN=1: TWRNINT/RWRNINT are set */
+}
+
+/**
+* @brief            Set bus off recovery.
+* @details          Function to write CTRL1[BOFFREC] at run time. Negating it while bus off starts the
+*                   recovery: FlexCAN rejoins after 128 x 11 recessive bits.
+* @param[in]        u8Manual - 0: automatic bus off recovery, 1: stay bus off until BOFFREC is negated.
+* @return           void.
+*/
+void FLEXCAN0_set_bus_off_recovery(uint8_t u8Manual)
+{
+	if (0U != u8Manual)
+	{
+		FLEXCAN0_BASE->CTRL1 |= CAN_CTRL1_BOFFREC_MASK;
+	}
+	else
+	{
+		FLEXCAN0_BASE->CTRL1 &= ~CAN_CTRL1_BOFFREC_MASK;
+	}
 }
 
 
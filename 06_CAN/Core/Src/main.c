@@ -22,12 +22,85 @@
 #define PTE4		(4U)
 /* Port PTE5, bit 5: EVB CAN0_TX */
 #define PTE5		(5U)
+/* Port PTA12, bit 12: CAN1_RX (GATEWAY_MODE, external transceiver) */
+#define PTA12		(12U)
+/* Port PTA13, bit 13: CAN1_TX (GATEWAY_MODE, external transceiver) */
+#define PTA13		(13U)
 /* Port PTD16, bit 16: EVB output to green LED */
 #define PTD16		(16U)
+/* ID of the message sent to the CAN tool */
+#define TX_MSG_ID	(0x555U)
+/* ID of the message received from the CAN tool */
+#define RX_MSG_ID	(0x511U)
+/* Demo modes below can also be set with -D, the Sim tests build main.c that way */
+/* 1: receive through the 6 frame RX FIFO, 0: receive with MB4 */
+#ifndef RX_FIFO_MODE
+#define RX_FIFO_MODE	(0U)
+#endif
+/* 1: RX_MSG_ID frames carry ISO-TP messages, each one is echoed back on TX_MSG_ID */
+#ifndef ISOTP_MODE
+#define ISOTP_MODE		(0U)
+#endif
+/* 1: the RX FIFO is drained by eDMA into a circular buffer (overrides RX_FIFO_MODE) */
+#ifndef RX_DMA_MODE
+#define RX_DMA_MODE		(0U)
+#endif
+/* Size of that buffer in frames, each half is handed to the receive ring at once */
+#define RX_DMA_FRAMES	(2U * CAN_RING_SIZE)
+/* 1: FlexCAN0 in loopback replays au8ReplayTrace through the receive path */
+#ifndef REPLAY_MODE
+#define REPLAY_MODE		(0U)
+#endif
+/* Replay timing in percent of the original, CAN_REPLAY_FAST: as fast as possible */
+#define REPLAY_SCALE_PCT	(CAN_REPLAY_ORIGINAL)
+/* 1: CAN0 and CAN1 forward all frames to each other (can_gw), the other demos are not run */
+#ifndef GATEWAY_MODE
+#define GATEWAY_MODE	(0U)
+#endif
+/* Bus off recovery: CAN_ERR_RECOVER_AUTO, or CAN_ERR_RECOVER_MANUAL to rejoin BUSOFF_HOLD_MS after bus off */
+#ifndef BUSOFF_RECOVERY
+#define BUSOFF_RECOVERY	(CAN_ERR_RECOVER_AUTO)
+#endif
+#define BUSOFF_HOLD_MS	(100U)
+/* ID of the statistics frame sent every STATS_PERIOD_MS */
+#define STATS_MSG_ID	(0x7F0U)
+/* Statistics frame period, 0 disables it */
+#define STATS_PERIOD_MS	(1000U)
+/* SysTick reload for a 1 ms tick at 80 MHz core clock */
+#define SYSTICK_RELOAD_1MS	(80000U - 1U)
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
 ==================================================================================================*/
+/* Data of the message sent to the CAN tool */
+const uint8_t au8TxMsgData[8] = {0xA5U, 0x11U, 0x22U, 0x33U, 0x44U, 0x55U, 0x66U, 0x77U};
+
+#if (1U == RX_FIFO_MODE) || (1U == RX_DMA_MODE)
+/* RX FIFO filter table: accept RX_MSG_ID only */
+const uint32_t au32RxFifoFilters[1] = {FLEXCAN_FIFO_ID_A(RX_MSG_ID)};
+#endif
+
+#if (1U == REPLAY_MODE)
+/* Trace to replay (can_trace_header() and records): four RX_MSG_ID frames 1 ms apart at 500 kbit/s */
+const uint8_t au8ReplayTrace[] =
+{
+	'C', 'T', 'R', CAN_TRACE_VERSION, 0x20U, 0xA1U, 0x07U, 0x00U,	/* Header, 500000 ticks/s */
+	0x08U, 0xE8U, 0x07U, 0x91U, 0x0AU, 0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U,	/* RX, DLC 8, +500, 0x511 */
+	0x08U, 0xE8U, 0x07U, 0x91U, 0x0AU, 0x11U, 0x12U, 0x13U, 0x14U, 0x15U, 0x16U, 0x17U, 0x18U,
+	0x08U, 0xE8U, 0x07U, 0x91U, 0x0AU, 0x21U, 0x22U, 0x23U, 0x24U, 0x25U, 0x26U, 0x27U, 0x28U,
+	0x08U, 0xE8U, 0x07U, 0x91U, 0x0AU, 0x31U, 0x32U, 0x33U, 0x34U, 0x35U, 0x36U, 0x37U, 0x38U
+};
+#endif
+
+#if (1U == GATEWAY_MODE)
+/* Gateway routes: every standard ID from CAN0 to CAN1 and back (CAN0 and CAN1 ignore their own frames) */
+const can_gw_route_t aGatewayRoutes[2] =
+{
+	/* first ID, last ID, new ID,         min gap ms, src, destinations */
+	{0x000U,     0x7FFU,  CAN_GW_KEEP_ID, 0U,         0U,  CAN_GW_DST(1U)},
+	{0x000U,     0x7FFU,  CAN_GW_KEEP_ID, 0U,         1U,  CAN_GW_DST(0U)}
+};
+#endif
 
 /*==================================================================================================
 *                                      LOCAL VARIABLES
@@ -40,6 +113,32 @@
 /*==================================================================================================
 *                                      GLOBAL VARIABLES
 ==================================================================================================*/
+/* CAN0 received frames, filled by the MB interrupt */
+can_ring_t CanRxRing;
+
+/* Milliseconds since start, counted by SysTick */
+volatile uint32_t u32TickMs = 0U;
+
+#if (1U == RX_DMA_MODE)
+/* RX FIFO frames, written by eDMA */
+can_dma_frame_t CanDmaBuf[RX_DMA_FRAMES];
+#endif
+
+#if (1U == REPLAY_MODE)
+/* Replay state and results: sent, skipped, max lateness */
+can_replay_t CanReplay;
+#endif
+
+#if (1U == GATEWAY_MODE)
+/* Gateway rate limit state, one word per route */
+uint32_t au32GatewayRouteMs[2];
+#endif
+
+#if (1U == ISOTP_MODE)
+/* ISO-TP link and its message buffer, received messages are sent back from the same buffer */
+can_isotp_t IsotpLink;
+uint8_t au8IsotpBuf[512];
+#endif
 
 /*==================================================================================================
 *                                   LOCAL FUNCTION PROTOTYPES
@@ -52,6 +151,14 @@
 */
 void WDOG_disable(void);
 
+/**
+* @brief            Initialize an interrupt.
+* @details          To initialize an interrupt.
+* @param        	void.
+* @return           void.
+*/
+void NVIC_init_IRQs(void);
+
 /**
 * @brief            Configure Port.
 * @details          Enable clocks to GPIO modules and configure GPIO ports.
@@ -60,6 +167,46 @@ void WDOG_disable(void);
 */
 void PORT_init(void);
 
+/**
+* @brief            Start SysTick.
+* @details          1 ms SysTick interrupt, the time base of the ISO-TP timers.
+* @param        	void.
+* @return           void.
+*/
+void SysTick_init(void);
+
+#if (1U == ISOTP_MODE)
+/**
+* @brief            ISO-TP receive indication.
+* @details          Echo a received message back to the CAN tool.
+* @param[in]        u32Length - Message length, 0 on error.
+* @param[in]        u8Result - CAN_ISOTP_xxx.
+* @return           void.
+*/
+void IsotpRxDone(uint32_t u32Length, uint8_t u8Result);
+#endif
+
+#if (1U == RX_DMA_MODE)
+/**
+* @brief            RX DMA block.
+* @details          Move a completed half of the DMA buffer into the receive ring.
+* @param[in]        pFrames - DMA frames.
+* @param[in]        u32Count - Number of frames.
+* @return           void.
+*/
+void RxDmaBlock(const can_dma_frame_t *pFrames, uint32_t u32Count);
+#endif
+
+#if (1U == GATEWAY_MODE)
+/**
+* @brief            Run the gateway.
+* @details          CAN0 <-> CAN1 gateway, serviced from this loop. Does not return.
+* @param        	void.
+* @return           void.
+*/
+void Gateway_run(void);
+#endif
+
 /*==================================================================================================
 *                                       LOCAL FUNCTIONS
 ==================================================================================================*/
@@ -76,6 +223,19 @@ void WDOG_disable(void)
 	WDOG->CS = 0x00002100U;			/* Disable watchdog */
 }
 
+/**
+* @brief            Initialize an interrupt.
+* @details          To initialize an interrupt.
+* @param        	void.
+* @return           void.
+*/
+void NVIC_init_IRQs(void)
+{
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);  /* IRQ81-CAN0 ORed MB 0-15: clr any pending IRQ*/
+	S32_NVIC->ISER[2] = 1U << (81 % 32);  /* IRQ81-CAN0 ORed MB 0-15: enable IRQ */
+	S32_NVIC->IP[81] = 0x8U;              /* IRQ81-CAN0 ORed MB 0-15: priority 8 of 0-15*/
+}
+
 /**
 * @brief            Configure Port.
 * @details          Enable clocks to GPIO modules and configure GPIO ports.
@@ -88,21 +248,120 @@ void PORT_init(void)
 	PORTE->PCR[PTE4] |= PORT_PCR_MUX(5U); 	/* Port E4: MUX = ALT5, CAN0_RX */
 	PORTE->PCR[PTE5] |= PORT_PCR_MUX(5U); 	/* Port E5: MUX = ALT5, CAN0_TX */
 	
+#if (1U == GATEWAY_MODE)
+	PCC->PCCn[PCC_PORTA_INDEX] |= PCC_PCCn_CGC_MASK; /* Enable clock for PORTA */
+	PORTA->PCR[PTA12] |= PORT_PCR_MUX(3U); 	/* Port A12: MUX = ALT3, CAN1_RX */
+	PORTA->PCR[PTA13] |= PORT_PCR_MUX(3U); 	/* Port A13: MUX = ALT3, CAN1_TX */
+	
+#endif
 	PCC->PCCn[PCC_PORTD_INDEX ]|=PCC_PCCn_CGC_MASK; /* Enable clock for PORTD */
 	PORTD->PCR[PTD16] = PORT_PCR_MUX(1U); 	/* Port D16: MUX = GPIO (to green LED) */
 	PTD->PDDR |= 1U << 16U; 				/* Port D16: Data direction = output */
 }
 
+/**
+* @brief            Start SysTick.
+* @details          1 ms SysTick interrupt, the time base of the ISO-TP timers.
+* @param        	void.
+* @return           void.
+*/
+void SysTick_init(void)
+{
+	S32_SysTick->CSR = 0U;							/* Disable SysTick during setup */
+	S32_SysTick->RVR = S32_SysTick_RVR_RELOAD(SYSTICK_RELOAD_1MS);	/* 1 ms period */
+	S32_SysTick->CVR = 0U;							/* Clear current value */
+	S32_SysTick->CSR = S32_SysTick_CSR_CLKSOURCE_MASK	/* Core clock */
+					 | S32_SysTick_CSR_TICKINT_MASK		/* Interrupt on wrap */
+					 | S32_SysTick_CSR_ENABLE_MASK;		/* Start */
+}
+
+#if (1U == ISOTP_MODE)
+/**
+* @brief            ISO-TP receive indication.
+* @details          Echo a received message back to the CAN tool.
+* @param[in]        u32Length - Message length, 0 on error.
+* @param[in]        u8Result - CAN_ISOTP_xxx.
+* @return           void.
+*/
+void IsotpRxDone(uint32_t u32Length, uint8_t u8Result)
+{
+	if (CAN_ISOTP_OK == u8Result)
+	{
+		(void)can_isotp_send(&IsotpLink, au8IsotpBuf, u32Length);	/* Busy: the message is dropped */
+	}
+}
+#endif
+
+#if (1U == RX_DMA_MODE)
+/**
+* @brief            RX DMA block.
+* @details          Move a completed half of the DMA buffer into the receive ring.
+* @param[in]        pFrames - DMA frames.
+* @param[in]        u32Count - Number of frames.
+* @return           void.
+*/
+void RxDmaBlock(const can_dma_frame_t *pFrames, uint32_t u32Count)
+{
+	can_frame_t frame;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		can_dma_decode(&pFrames[u32Index], &frame);	/* Frames may be older than a TIMER wrap: time stamp not extended */
+		can_stats_rx(&frame, 0U);					/* FIFO losses are counted by the DMA buffer overruns */
+		(void)can_ring_push(&CanRxRing, &frame);	/* Drops are counted by the ring */
+	}
+}
+#endif
+
+#if (1U == GATEWAY_MODE)
+/**
+* @brief            Run the gateway.
+* @details          CAN0 <-> CAN1 gateway, serviced from this loop. Does not return.
+* @param        	void.
+* @return           void.
+*/
+void Gateway_run(void)
+{
+	can_gw_init_controller(0U);		/* CAN0: EVB transceiver */
+	can_gw_init_controller(1U);		/* CAN1: PTA12/PTA13 */
+	can_gw_init(aGatewayRoutes, 2U, au32GatewayRouteMs);
+	
+	SysTick_init();					/* 1 ms time base of the rate limits */
+	
+	for(;;)
+	{
+		can_gw_service(0U, u32TickMs);	/* Polled: a frame waiting for a destination MB stays in the FIFO */
+		can_gw_service(1U, u32TickMs);
+	}
+}
+#endif
+
 /*==================================================================================================
 *                                       GLOBAL FUNCTIONS
 ==================================================================================================*/
+#ifndef SIM_CAN
 /**
 * @brief			The main function for the project.       
+* @details			Not built on the host: the Sim tests link the interrupt handlers below and run their own main().
 */
 int main(void)
 {
 	/* receive msg counter */
 	uint32_t rx_msg_count = 0U;
+	/* frame taken from the receive ring */
+	can_frame_t rx_frame;
+	/* statistics of the last period */
+	can_stats_snapshot_t stats;
+	/* time of the last statistics frame */
+	uint32_t stats_ms = 0U;
+#if (1U == ISOTP_MODE)
+	/* frame data bytes */
+	uint8_t au8Data[8];
+	uint8_t u8Index = 0U;
+	/* ISO-TP link to the CAN tool: 8 byte frames, no flow control pauses */
+	can_isotp_cfg_t isotp_cfg = {TX_MSG_ID, RX_MSG_ID, 8U, 0U, 0U, 0xCCU, can_send, IsotpRxDone, NULL};
+#endif
 
 	/*----------------------------------------------------------- */
 	/*    Initialization                                          */
@@ -117,28 +376,217 @@ int main(void)
 	
 	NormalRUNmode_80MHz();  /* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
 	
+#if (1U == GATEWAY_MODE)
+	Gateway_run();			/* CAN0 <-> CAN1 gateway, does not return */
+	
+#endif
+#if (1U == RX_DMA_MODE)
+	can_ring_init(&CanRxRing);	/* Empty the receive ring before the DMA interrupt can fill it */
+	
+	can_dma_init(CanDmaBuf, RX_DMA_FRAMES, RxDmaBlock);	/* eDMA copies the RX FIFO, interrupts per half buffer */
+	
+	(void)FLEXCAN0_init_rx_fifo_dma(FLEXCAN_FIFO_FORMAT_A, au32RxFifoFilters, NULL, 1U);	/* Init FlexCAN0 with RX FIFO DMA request */
+#elif (1U == RX_FIFO_MODE)
+	(void)FLEXCAN0_init_rx_fifo(FLEXCAN_FIFO_FORMAT_A, au32RxFifoFilters, NULL, 1U);	/* Init FlexCAN0 with RX FIFO */
+	
+	can_ring_init(&CanRxRing);	/* Empty the receive ring before the ISR can fill it */
+	
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN_FIFO_AVAILABLE_FLAG);	/* FIFO frames available raises an interrupt */
+#else
 	FLEXCAN0_init(); 		/* Init FlexCAN0 */
 	
-	FLEXCAN0_transmit_msg(); /* Transmit initial message from EVB to CAN tool */
+	can_ring_init(&CanRxRing);	/* Empty the receive ring before the ISR can fill it */
+	
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);	/* Receive MBs raise an interrupt */
+#endif
+	
+#if (1U == REPLAY_MODE)
+	FLEXCAN0_set_loopback(1U);	/* Replayed frames are received by the own MBs, bus pins stay recessive */
+	
+#endif
+	can_stats_init();		/* Driver statistics, before the CAN0 interrupt is enabled */
+	
+	can_tx_init(NULL);		/* Transmit MB pool and queue, no TX complete callback */
+	
+#if (1U == ISOTP_MODE)
+	(void)can_isotp_init(&IsotpLink, &isotp_cfg);	/* ISO-TP link over the transmit engine */
+	can_isotp_set_rx_buffer(&IsotpLink, au8IsotpBuf, sizeof(au8IsotpBuf));
+#endif
+	
+	can_trace_start(0U);	/* Record CAN0 traffic from timebase start, see can_trace_read() */
+	
+	SysTick_init();			/* 1 ms time base */
+	
+	NVIC_init_IRQs();       /* Enable desired interrupts and priorities */
+	
+	can_time_init();		/* 64 bit CAN timebase, LPIT0 ch0 samples the CAN0 TIMER */
+	
+	can_err_init(BUSOFF_RECOVERY, NULL);	/* Bus off, warning and error interrupts, after the timebase */
+	
+	can_stats_reset();		/* Bus load window starts with the timebase */
+	
+#if (1U == REPLAY_MODE)
+	(void)can_replay_start(&CanReplay, au8ReplayTrace, sizeof(au8ReplayTrace), REPLAY_SCALE_PCT, can_send, can_time_now());
+#endif
+	
+	(void)can_send(TX_MSG_ID, au8TxMsgData, 8U);	/* Transmit initial message from EVB to CAN tool */
 	
 	/*----------------------------------------------------------- */
 	/*    Infinite For                                            */
 	/*----------------------------------------------------------- */ 
 	for(;;)
 	{
-		if (1U == ((CAN0->IFLAG1 >> 4U) & 1U))	/* If CAN 0 MB 4 flag is set (received msg), read MB4 */
+		while (1U == can_ring_pop(&CanRxRing, &rx_frame))	/* Drain frames queued by the MB interrupt */
 		{
-			FLEXCAN0_receive_msg(); 	/* Read message */
+			if (0U != rx_frame.u64Timestamp)	/* 0: not extended (RX DMA frames), no latency to record */
+			{
+				can_lat_record(&CanLatRx, rx_frame.u64Timestamp, can_time_now());	/* Reception to application */
+			}
 			rx_msg_count++; 			/* Increment receive msg counter */
 			if (rx_msg_count >= 1000U) 	/* If 1000 messages have been received, */
 			{ 
 				PTD->PTOR |= 1U << 16U; /* toggle output port D16 (Green LED) */
 				rx_msg_count = 0U; /* and reset message counter */
 			}
-			FLEXCAN0_transmit_msg(); /* Transmit message using MB0 */	
+#if (1U == ISOTP_MODE)
+			if (RX_MSG_ID == rx_frame.u32Id)
+			{
+				for (u8Index = 0U; u8Index < rx_frame.u8Length; u8Index++)	/* Byte 0 is the MSB of data word 0 */
+				{
+					au8Data[u8Index] = (uint8_t)(rx_frame.u32Data[u8Index >> 2U] >> (24U - 8U*(u8Index & 3U)));
+				}
+				can_isotp_rx_frame(&IsotpLink, au8Data, rx_frame.u8Length, u32TickMs * 1000U);
+			}
+#else
+			(void)can_send(TX_MSG_ID, au8TxMsgData, 8U);	/* Queue reply, sent from the TX MB pool */
+#endif
+		}
+		if ((0U != STATS_PERIOD_MS) && ((u32TickMs - stats_ms) >= STATS_PERIOD_MS))
+		{
+			stats_ms += STATS_PERIOD_MS;
+			(void)can_err_poll();							/* Error passive / warning back to active */
+			can_stats_snapshot(&stats);
+			can_stats_reset();								/* Next period */
+			(void)can_stats_send(STATS_MSG_ID, &stats);		/* Bus load and error counters to the CAN tool */
+		}
+#if (CAN_ERR_RECOVER_MANUAL == BUSOFF_RECOVERY)
+		if ((CAN_ERR_BUS_OFF == CanErr.u8State)
+			&& ((can_time_now() - CanErr.u64BusOffTime) >= ((uint64_t)BUSOFF_HOLD_MS * (FLEXCAN0_BITRATE / 1000U))))
+		{
+			(void)can_err_recover();						/* Rejoin after the hold time */
 		}
+#endif
+#if (1U == ISOTP_MODE)
+		can_isotp_poll(&IsotpLink, u32TickMs * 1000U);	/* Pending frames and timeouts */
+#endif
+#if (1U == REPLAY_MODE)
+		(void)can_replay_poll(&CanReplay, can_time_now());	/* Frames whose trace time has come */
+#endif
 	}
 }
+#endif	/* SIM_CAN */
+
+/**
+* @brief            CAN0 MB 0-15 interrupt.
+* @details          Copy every flagged receive MB (or the RX FIFO) into the receive ring, refill completed transmit MBs.
+* @param        	void.
+* @return           void.
+*/
+void CAN0_ORed_0_15_MB_IRQHandler(void)
+{
+	can_frame_t aFrames[16];
+	uint32_t u32Count = 0U;
+	uint32_t u32Index = 0U;
+
+#if (1U == RX_DMA_MODE)
+	(void)u32Count;									/* RX FIFO served by eDMA, see RxDmaBlock() */
+	(void)u32Index;
+	(void)aFrames;
+#elif (1U == RX_FIFO_MODE)
+	while (1U == FLEXCAN0_read_rx_fifo(&aFrames[0]))	/* Drain the RX FIFO in arrival order */
+	{
+		aFrames[0].u64Timestamp = can_time_extend(aFrames[0].u16Timestamp);
+		can_stats_rx(&aFrames[0], 0U);					/* FIFO losses are counted in RxFifoOverflow */
+		(void)can_trace_record(CAN_TRACE_RX, aFrames[0].u32Id, aFrames[0].u64Timestamp, aFrames[0].u32Data, aFrames[0].u8Length);
+		(void)can_ring_push(&CanRxRing, &aFrames[0]);	/* Drops are counted by the ring */
+	}
+	(void)u32Count;
+	(void)u32Index;
+#else
+	u32Count = FLEXCAN0_receive_all(FLEXCAN0_RX_MB_MASK, aFrames);	/* Drain all flagged receive MBs */
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		aFrames[u32Index].u64Timestamp = can_time_extend(aFrames[u32Index].u16Timestamp);	/* MBs unlocked: TIMER read is safe */
+		can_stats_rx(&aFrames[u32Index], (uint8_t)(FLEXCAN_RX_OVERRUN == aFrames[u32Index].u8Code));
+		if (FLEXCAN_RX_OVERRUN == aFrames[u32Index].u8Code)
+		{
+			can_err_rearm_mb(aFrames[u32Index].u8Mb);		/* Back to EMPTY */
+		}
+		(void)can_trace_record(CAN_TRACE_RX, aFrames[u32Index].u32Id, aFrames[u32Index].u64Timestamp,
+							   aFrames[u32Index].u32Data, aFrames[u32Index].u8Length);
+		(void)can_ring_push(&CanRxRing, &aFrames[u32Index]);	/* Drops are counted by the ring */
+	}
+#endif
+
+	can_tx_isr(CAN0->IFLAG1 & CAN0->IMASK1);	/* Transmit MB pool */
+}
+
+/**
+* @brief            CAN0 ORed interrupt.
+* @details          Bus off, bus off done and TX/RX warning events.
+* @param        	void.
+* @return           void.
+*/
+void CAN0_ORed_IRQHandler(void)
+{
+	can_err_isr();
+}
+
+/**
+* @brief            CAN0 Error interrupt.
+* @details          Error frames.
+* @param        	void.
+* @return           void.
+*/
+void CAN0_Error_IRQHandler(void)
+{
+	can_err_isr();
+}
+
+#if (1U == RX_DMA_MODE)
+/**
+* @brief            DMA channel 0 interrupt.
+* @details          Hand a completed half of the RX DMA buffer to RxDmaBlock().
+* @param        	void.
+* @return           void.
+*/
+void DMA0_IRQHandler(void)
+{
+	can_dma_isr();
+}
+#endif
+
+/**
+* @brief            LPIT0 channel 0 interrupt.
+* @details          Sample the CAN0 TIMER for the 64 bit timebase.
+* @param        	void.
+* @return           void.
+*/
+void LPIT0_Ch0_IRQHandler(void)
+{
+	can_time_isr();
+}
+
+/**
+* @brief            SysTick interrupt.
+* @details          Count milliseconds.
+* @param        	void.
+* @return           void.
+*/
+void SysTick_Handler(void)
+{
+	u32TickMs++;
+}
 
 
 /* END main */
@@ -0,0 +1,548 @@
+/**
+* @file				device_registers.h
+* @brief			Host register model view of the S32K144 peripherals used by the CAN drivers
+* @details			Replaces the S32K144 device header when the drivers are built on a host against
+*					sim_can.c. Register blocks have the silicon layout and base addresses: sim_can_init()
+*					maps them at those addresses, so CAN_BASE_PTRS and every driver macro stay constant.
+*					Only the registers and fields the 06_CAN and 07_CANFD drivers and the 06_CAN main.c use
+*					are declared.
+*/
+
+#ifndef DEVICE_REGISTERS_H
+#define DEVICE_REGISTERS_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+#define __I		volatile const
+#define __O		volatile
+#define __IO	volatile
+
+/* FlexCAN */
+typedef struct
+{
+	__IO uint32_t MCR;					/* 0x000 */
+	__IO uint32_t CTRL1;				/* 0x004 */
+	__IO uint32_t TIMER;				/* 0x008 */
+	uint8_t RESERVED_0[4];
+	__IO uint32_t RXMGMASK;				/* 0x010 */
+	__IO uint32_t RX14MASK;				/* 0x014 */
+	__IO uint32_t RX15MASK;				/* 0x018 */
+	__IO uint32_t ECR;					/* 0x01C */
+	__IO uint32_t ESR1;					/* 0x020 */
+	uint8_t RESERVED_1[4];
+	__IO uint32_t IMASK1;				/* 0x028 */
+	uint8_t RESERVED_2[4];
+	__IO uint32_t IFLAG1;				/* 0x030 */
+	__IO uint32_t CTRL2;				/* 0x034 */
+	__I  uint32_t ESR2;					/* 0x038 */
+	uint8_t RESERVED_3[8];
+	__I  uint32_t CRCR;					/* 0x044 */
+	__IO uint32_t RXFGMASK;				/* 0x048 */
+	__I  uint32_t RXFIR;				/* 0x04C */
+	__IO uint32_t CBT;					/* 0x050 */
+	uint8_t RESERVED_4[44];
+	__IO uint32_t RAMn[128];			/* 0x080 */
+	uint8_t RESERVED_5[1536];
+	__IO uint32_t RXIMR[32];			/* 0x880 */
+	uint8_t RESERVED_6[512];
+	__IO uint32_t CTRL1_PN;				/* 0xB00 */
+	__IO uint32_t CTRL2_PN;
+	__IO uint32_t WU_MTC;
+	__IO uint32_t FLT_ID1;
+	__IO uint32_t FLT_DLC;
+	__IO uint32_t PL1_LO;
+	__IO uint32_t PL1_HI;
+	__IO uint32_t FLT_ID2_IDMASK;
+	__IO uint32_t PL2_PLMASK_LO;
+	__IO uint32_t PL2_PLMASK_HI;
+	uint8_t RESERVED_7[24];
+	struct
+	{
+		__I uint32_t WMBn_CS;			/* 0xB40 */
+		__I uint32_t WMBn_ID;
+		__I uint32_t WMBn_D03;
+		__I uint32_t WMBn_D47;
+	} WMB[4];
+	uint8_t RESERVED_8[128];
+	__IO uint32_t FDCTRL;				/* 0xC00 */
+	__IO uint32_t FDCBT;				/* 0xC04 */
+	__I  uint32_t FDCRC;				/* 0xC08 */
+} CAN_Type;
+
+/* PCC */
+typedef struct
+{
+	__IO uint32_t PCCn[122];
+} PCC_Type;
+
+/* LPIT */
+typedef struct
+{
+	__I  uint32_t VERID;				/* 0x00 */
+	__I  uint32_t PARAM;				/* 0x04 */
+	__IO uint32_t MCR;					/* 0x08 */
+	__IO uint32_t MSR;					/* 0x0C */
+	__IO uint32_t MIER;					/* 0x10 */
+	__IO uint32_t SETTEN;				/* 0x14 */
+	__IO uint32_t CLRTEN;				/* 0x18 */
+	uint8_t RESERVED_0[4];
+	struct
+	{
+		__IO uint32_t TVAL;				/* 0x20 + 16 x n */
+		__I  uint32_t CVAL;
+		__IO uint32_t TCTRL;
+		uint8_t RESERVED_0[4];
+	} TMR[4];
+} LPIT_Type;
+
+/* eDMA */
+typedef struct
+{
+	__IO uint32_t CR;					/* 0x000 */
+	__I  uint32_t ES;					/* 0x004 */
+	uint8_t RESERVED_0[4];
+	__IO uint32_t ERQ;					/* 0x00C */
+	uint8_t RESERVED_1[4];
+	__IO uint32_t EEI;					/* 0x014 */
+	__O  uint8_t CEEI;					/* 0x018 */
+	__O  uint8_t SEEI;
+	__O  uint8_t CERQ;
+	__O  uint8_t SERQ;
+	__O  uint8_t CDNE;					/* 0x01C */
+	__O  uint8_t SSRT;
+	__O  uint8_t CERR;
+	__O  uint8_t CINT;
+	uint8_t RESERVED_2[4];
+	__IO uint32_t INT;					/* 0x024 */
+	uint8_t RESERVED_3[4];
+	__IO uint32_t ERR;					/* 0x02C */
+	uint8_t RESERVED_4[4];
+	__I  uint32_t HRS;					/* 0x034 */
+	uint8_t RESERVED_5[12];
+	__IO uint32_t EARS;					/* 0x044 */
+	uint8_t RESERVED_6[184];
+	__IO uint8_t DCHPRI[16];			/* 0x100 */
+	uint8_t RESERVED_7[3824];
+	struct
+	{
+		__IO uint32_t SADDR;			/* 0x1000 + 32 x n */
+		__IO uint16_t SOFF;
+		__IO uint16_t ATTR;
+		union
+		{
+			__IO uint32_t MLNO;
+			__IO uint32_t MLOFFNO;
+			__IO uint32_t MLOFFYES;
+		} NBYTES;
+		__IO uint32_t SLAST;
+		__IO uint32_t DADDR;
+		__IO uint16_t DOFF;
+		union
+		{
+			__IO uint16_t ELINKNO;
+			__IO uint16_t ELINKYES;
+		} CITER;
+		__IO uint32_t DLASTSGA;
+		__IO uint16_t CSR;
+		union
+		{
+			__IO uint16_t ELINKNO;
+			__IO uint16_t ELINKYES;
+		} BITER;
+	} TCD[16];
+} DMA_Type;
+
+/* DMAMUX */
+typedef struct
+{
+	__IO uint8_t CHCFG[16];
+} DMAMUX_Type;
+
+/* FTFC: FCCOB in groups of 4 stored in reverse order, as in the S32K144 header */
+typedef struct
+{
+	__IO uint8_t FSTAT;					/* 0x00 */
+	__IO uint8_t FCNFG;
+	__I  uint8_t FSEC;
+	__I  uint8_t FOPT;
+	__IO uint8_t FCCOB[12];				/* 0x04 */
+	__IO uint8_t FPROT[4];				/* 0x10 */
+} FTFC_Type;
+
+/* LMEM: code cache control only */
+typedef struct
+{
+	__IO uint32_t PCCCR;				/* 0x000 */
+} LMEM_Type;
+
+/* NVIC */
+typedef struct
+{
+	__IO uint32_t ISER[8];				/* 0x000 */
+	uint8_t RESERVED_0[96];
+	__IO uint32_t ICER[8];				/* 0x080 */
+	uint8_t RESERVED_1[96];
+	__IO uint32_t ISPR[8];				/* 0x100 */
+	uint8_t RESERVED_2[96];
+	__IO uint32_t ICPR[8];				/* 0x180 */
+	uint8_t RESERVED_3[96];
+	__I  uint32_t IABR[8];				/* 0x200 */
+	uint8_t RESERVED_4[224];
+	__IO uint8_t IP[240];				/* 0x300 */
+} S32_NVIC_Type;
+
+/* SysTick */
+typedef struct
+{
+	__IO uint32_t CSR;
+	__IO uint32_t RVR;
+	__IO uint32_t CVR;
+	__I  uint32_t CALIB;
+} S32_SysTick_Type;
+
+/* WDOG, PORT and GPIO: declared for main.c only, not modelled (the Sim tests do not call its setup) */
+typedef struct
+{
+	__IO uint32_t CS;
+	__IO uint32_t CNT;
+	__IO uint32_t TOVAL;
+	__IO uint32_t WIN;
+} WDOG_Type;
+
+typedef struct
+{
+	__IO uint32_t PCR[32];
+} PORT_Type;
+
+typedef struct
+{
+	__IO uint32_t PDOR;
+	__O  uint32_t PSOR;
+	__O  uint32_t PCOR;
+	__O  uint32_t PTOR;
+	__I  uint32_t PDIR;
+	__IO uint32_t PDDR;
+	__IO uint32_t PIDR;
+} GPIO_Type;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Peripheral base addresses, as on the S32K144 */
+#define CAN0_BASE					(0x40024000U)
+#define CAN1_BASE					(0x40025000U)
+#define CAN2_BASE					(0x4002B000U)
+#define PCC_BASE					(0x40065000U)
+#define LPIT0_BASE					(0x40037000U)
+#define DMA_BASE					(0x40008000U)
+#define DMAMUX_BASE					(0x40021000U)
+#define FTFC_BASE					(0x40020000U)
+#define LMEM_BASE					(0xE0082000U)
+#define S32_NVIC_BASE				(0xE000E100U)
+#define S32_SysTick_BASE			(0xE000E010U)
+#define WDOG_BASE					(0x40052000U)
+#define PORTA_BASE					(0x40049000U)
+#define PORTD_BASE					(0x4004C000U)
+#define PORTE_BASE					(0x4004D000U)
+#define PTD_BASE					(0x400FF0C0U)
+
+#define CAN0						((CAN_Type *)CAN0_BASE)
+#define CAN1						((CAN_Type *)CAN1_BASE)
+#define CAN2						((CAN_Type *)CAN2_BASE)
+#define PCC							((PCC_Type *)PCC_BASE)
+#define LPIT0						((LPIT_Type *)LPIT0_BASE)
+#define DMA							((DMA_Type *)DMA_BASE)
+#define DMAMUX						((DMAMUX_Type *)DMAMUX_BASE)
+#define FTFC						((FTFC_Type *)FTFC_BASE)
+#define LMEM						((LMEM_Type *)LMEM_BASE)
+#define S32_NVIC					((S32_NVIC_Type *)S32_NVIC_BASE)
+#define S32_SysTick					((S32_SysTick_Type *)S32_SysTick_BASE)
+#define WDOG						((WDOG_Type *)WDOG_BASE)
+#define PORTA						((PORT_Type *)PORTA_BASE)
+#define PORTD						((PORT_Type *)PORTD_BASE)
+#define PORTE						((PORT_Type *)PORTE_BASE)
+#define PTD							((GPIO_Type *)PTD_BASE)
+
+#define CAN_INSTANCE_COUNT			(3U)
+#define CAN_BASE_PTRS				{ CAN0, CAN1, CAN2 }
+
+/* CAN MCR */
+#define CAN_MCR_MDIS_MASK			(0x80000000U)
+#define CAN_MCR_FRZ_MASK			(0x40000000U)
+#define CAN_MCR_RFEN_MASK			(0x20000000U)
+#define CAN_MCR_HALT_MASK			(0x10000000U)
+#define CAN_MCR_NOTRDY_MASK			(0x08000000U)
+#define CAN_MCR_NOTRDY_SHIFT		(27U)
+#define CAN_MCR_SOFTRST_MASK		(0x02000000U)
+#define CAN_MCR_FRZACK_MASK			(0x01000000U)
+#define CAN_MCR_FRZACK_SHIFT		(24U)
+#define CAN_MCR_SUPV_MASK			(0x00800000U)
+#define CAN_MCR_WRNEN_MASK			(0x00200000U)
+#define CAN_MCR_LPMACK_MASK			(0x00100000U)
+#define CAN_MCR_SRXDIS_MASK			(0x00020000U)
+#define CAN_MCR_IRMQ_MASK			(0x00010000U)
+#define CAN_MCR_DMA_MASK			(0x00008000U)
+#define CAN_MCR_LPRIOEN_MASK		(0x00002000U)
+#define CAN_MCR_AEN_MASK			(0x00001000U)
+#define CAN_MCR_FDEN_MASK			(0x00000800U)
+#define CAN_MCR_IDAM_MASK			(0x00000300U)
+#define CAN_MCR_IDAM_SHIFT			(8U)
+#define CAN_MCR_IDAM(x)				(((uint32_t)(x) << CAN_MCR_IDAM_SHIFT) & CAN_MCR_IDAM_MASK)
+#define CAN_MCR_MAXMB_MASK			(0x0000007FU)
+#define CAN_MCR_MAXMB(x)			((uint32_t)(x) & CAN_MCR_MAXMB_MASK)
+
+/* CAN CTRL1 */
+#define CAN_CTRL1_PRESDIV_MASK		(0xFF000000U)
+#define CAN_CTRL1_PRESDIV_SHIFT		(24U)
+#define CAN_CTRL1_PRESDIV(x)		(((uint32_t)(x) << CAN_CTRL1_PRESDIV_SHIFT) & CAN_CTRL1_PRESDIV_MASK)
+#define CAN_CTRL1_RJW_MASK			(0x00C00000U)
+#define CAN_CTRL1_RJW(x)			(((uint32_t)(x) << 22U) & CAN_CTRL1_RJW_MASK)
+#define CAN_CTRL1_PSEG1_MASK		(0x00380000U)
+#define CAN_CTRL1_PSEG1_SHIFT		(19U)
+#define CAN_CTRL1_PSEG1(x)			(((uint32_t)(x) << CAN_CTRL1_PSEG1_SHIFT) & CAN_CTRL1_PSEG1_MASK)
+#define CAN_CTRL1_PSEG2_MASK		(0x00070000U)
+#define CAN_CTRL1_PSEG2_SHIFT		(16U)
+#define CAN_CTRL1_PSEG2(x)			(((uint32_t)(x) << CAN_CTRL1_PSEG2_SHIFT) & CAN_CTRL1_PSEG2_MASK)
+#define CAN_CTRL1_BOFFMSK_MASK		(0x00008000U)
+#define CAN_CTRL1_ERRMSK_MASK		(0x00004000U)
+#define CAN_CTRL1_CLKSRC_MASK		(0x00002000U)
+#define CAN_CTRL1_LPB_MASK			(0x00001000U)
+#define CAN_CTRL1_TWRNMSK_MASK		(0x00000800U)
+#define CAN_CTRL1_RWRNMSK_MASK		(0x00000400U)
+#define CAN_CTRL1_SMP_MASK			(0x00000080U)
+#define CAN_CTRL1_SMP(x)			(((uint32_t)(x) << 7U) & CAN_CTRL1_SMP_MASK)
+#define CAN_CTRL1_BOFFREC_MASK		(0x00000040U)
+#define CAN_CTRL1_TSYN_MASK			(0x00000020U)
+#define CAN_CTRL1_LBUF_MASK			(0x00000010U)
+#define CAN_CTRL1_LOM_MASK			(0x00000008U)
+#define CAN_CTRL1_PROPSEG_MASK		(0x00000007U)
+#define CAN_CTRL1_PROPSEG(x)		((uint32_t)(x) & CAN_CTRL1_PROPSEG_MASK)
+
+/* CAN CTRL2 */
+#define CAN_CTRL2_ERRMSK_FAST_MASK	(0x80000000U)
+#define CAN_CTRL2_BOFFDONEMSK_MASK	(0x40000000U)
+#define CAN_CTRL2_RFFN_MASK			(0x0F000000U)
+#define CAN_CTRL2_RFFN_SHIFT		(24U)
+#define CAN_CTRL2_RFFN(x)			(((uint32_t)(x) << CAN_CTRL2_RFFN_SHIFT) & CAN_CTRL2_RFFN_MASK)
+#define CAN_CTRL2_TASD_MASK			(0x00F80000U)
+#define CAN_CTRL2_TASD(x)			(((uint32_t)(x) << 19U) & CAN_CTRL2_TASD_MASK)
+#define CAN_CTRL2_MRP_MASK			(0x00040000U)
+#define CAN_CTRL2_RRS_MASK			(0x00020000U)
+#define CAN_CTRL2_EACEN_MASK		(0x00010000U)
+#define CAN_CTRL2_ISOCANFDEN_MASK	(0x00001000U)
+
+/* CAN ESR1 */
+#define CAN_ESR1_WAKINT_MASK		(0x00000001U)
+#define CAN_ESR1_ERRINT_MASK		(0x00000002U)
+#define CAN_ESR1_BOFFINT_MASK		(0x00000004U)
+#define CAN_ESR1_FLTCONF_MASK		(0x00000030U)
+#define CAN_ESR1_FLTCONF_SHIFT		(4U)
+#define CAN_ESR1_RXWRN_MASK			(0x00000100U)
+#define CAN_ESR1_TXWRN_MASK			(0x00000200U)
+#define CAN_ESR1_STFERR_MASK		(0x00000400U)
+#define CAN_ESR1_FRMERR_MASK		(0x00000800U)
+#define CAN_ESR1_CRCERR_MASK		(0x00001000U)
+#define CAN_ESR1_ACKERR_MASK		(0x00002000U)
+#define CAN_ESR1_BIT0ERR_MASK		(0x00004000U)
+#define CAN_ESR1_BIT1ERR_MASK		(0x00008000U)
+#define CAN_ESR1_RWRNINT_MASK		(0x00010000U)
+#define CAN_ESR1_TWRNINT_MASK		(0x00020000U)
+#define CAN_ESR1_BOFFDONEINT_MASK	(0x00080000U)
+#define CAN_ESR1_ERRINT_FAST_MASK	(0x00100000U)
+#define CAN_ESR1_ERROVR_MASK		(0x00200000U)
+
+/* CAN ECR */
+#define CAN_ECR_TXERRCNT_MASK		(0x000000FFU)
+#define CAN_ECR_TXERRCNT_SHIFT		(0U)
+#define CAN_ECR_RXERRCNT_MASK		(0x0000FF00U)
+#define CAN_ECR_RXERRCNT_SHIFT		(8U)
+
+/* CAN CBT */
+#define CAN_CBT_BTF_MASK			(0x80000000U)
+#define CAN_CBT_EPRESDIV_MASK		(0x7FE00000U)
+#define CAN_CBT_EPRESDIV_SHIFT		(21U)
+#define CAN_CBT_EPRESDIV(x)			(((uint32_t)(x) << CAN_CBT_EPRESDIV_SHIFT) & CAN_CBT_EPRESDIV_MASK)
+#define CAN_CBT_ERJW_MASK			(0x001F0000U)
+#define CAN_CBT_ERJW(x)				(((uint32_t)(x) << 16U) & CAN_CBT_ERJW_MASK)
+#define CAN_CBT_EPROPSEG_MASK		(0x0000FC00U)
+#define CAN_CBT_EPROPSEG_SHIFT		(10U)
+#define CAN_CBT_EPROPSEG(x)			(((uint32_t)(x) << CAN_CBT_EPROPSEG_SHIFT) & CAN_CBT_EPROPSEG_MASK)
+#define CAN_CBT_EPSEG1_MASK			(0x000003E0U)
+#define CAN_CBT_EPSEG1_SHIFT		(5U)
+#define CAN_CBT_EPSEG1(x)			(((uint32_t)(x) << CAN_CBT_EPSEG1_SHIFT) & CAN_CBT_EPSEG1_MASK)
+#define CAN_CBT_EPSEG2_MASK			(0x0000001FU)
+#define CAN_CBT_EPSEG2(x)			((uint32_t)(x) & CAN_CBT_EPSEG2_MASK)
+
+/* CAN FDCTRL */
+#define CAN_FDCTRL_FDRATE_MASK		(0x80000000U)
+#define CAN_FDCTRL_MBDSR0_MASK		(0x00030000U)
+#define CAN_FDCTRL_MBDSR0_SHIFT		(16U)
+#define CAN_FDCTRL_MBDSR0(x)		(((uint32_t)(x) << CAN_FDCTRL_MBDSR0_SHIFT) & CAN_FDCTRL_MBDSR0_MASK)
+#define CAN_FDCTRL_TDCEN_MASK		(0x00008000U)
+#define CAN_FDCTRL_TDCFAIL_MASK		(0x00004000U)
+#define CAN_FDCTRL_TDCOFF_MASK		(0x00001F00U)
+#define CAN_FDCTRL_TDCOFF(x)		(((uint32_t)(x) << 8U) & CAN_FDCTRL_TDCOFF_MASK)
+
+/* CAN FDCBT */
+#define CAN_FDCBT_FPRESDIV_MASK		(0x3FF00000U)
+#define CAN_FDCBT_FPRESDIV_SHIFT	(20U)
+#define CAN_FDCBT_FPRESDIV(x)		(((uint32_t)(x) << CAN_FDCBT_FPRESDIV_SHIFT) & CAN_FDCBT_FPRESDIV_MASK)
+#define CAN_FDCBT_FRJW_MASK			(0x00070000U)
+#define CAN_FDCBT_FRJW(x)			(((uint32_t)(x) << 16U) & CAN_FDCBT_FRJW_MASK)
+#define CAN_FDCBT_FPROPSEG_MASK		(0x00007C00U)
+#define CAN_FDCBT_FPROPSEG_SHIFT	(10U)
+#define CAN_FDCBT_FPROPSEG(x)		(((uint32_t)(x) << CAN_FDCBT_FPROPSEG_SHIFT) & CAN_FDCBT_FPROPSEG_MASK)
+#define CAN_FDCBT_FPSEG1_MASK		(0x000000E0U)
+#define CAN_FDCBT_FPSEG1_SHIFT		(5U)
+#define CAN_FDCBT_FPSEG1(x)			(((uint32_t)(x) << CAN_FDCBT_FPSEG1_SHIFT) & CAN_FDCBT_FPSEG1_MASK)
+#define CAN_FDCBT_FPSEG2_MASK		(0x00000007U)
+#define CAN_FDCBT_FPSEG2(x)			((uint32_t)(x) & CAN_FDCBT_FPSEG2_MASK)
+
+/* CAN RXFIR, WMB */
+#define CAN_RXFIR_IDHIT_MASK		(0x000001FFU)
+#define CAN_RXFIR_IDHIT_SHIFT		(0U)
+#define CAN_WMBn_CS_DLC_MASK		(0x000F0000U)
+#define CAN_WMBn_CS_DLC_SHIFT		(16U)
+#define CAN_WMBn_ID_ID_MASK			(0x1FFFFFFFU)
+#define CAN_WMBn_ID_ID_SHIFT		(0U)
+
+/* PCC */
+#define PCC_PCCn_CGC_MASK			(0x40000000U)
+#define PCC_PCCn_PCS_MASK			(0x07000000U)
+#define PCC_PCCn_PCS(x)				(((uint32_t)(x) << 24U) & PCC_PCCn_PCS_MASK)
+#define PCC_DMAMUX_INDEX			(33U)
+#define PCC_FlexCAN0_INDEX			(36U)
+#define PCC_FlexCAN1_INDEX			(37U)
+#define PCC_FlexCAN2_INDEX			(43U)
+#define PCC_LPIT_INDEX				(55U)
+#define PCC_PORTA_INDEX				(73U)
+#define PCC_PORTD_INDEX				(76U)
+#define PCC_PORTE_INDEX				(77U)
+
+/* LPIT */
+#define LPIT_MCR_M_CEN_MASK			(0x00000001U)
+#define LPIT_MCR_DBG_EN_MASK		(0x00000008U)
+#define LPIT_MIER_TIE0_MASK			(0x00000001U)
+#define LPIT_MSR_TIF0_MASK			(0x00000001U)
+#define LPIT_TMR_TCTRL_T_EN_MASK	(0x00000001U)
+#define LPIT_TMR_TCTRL_MODE(x)		(((uint32_t)(x) << 2U) & 0x0000000CU)
+
+/* eDMA TCD */
+#define DMA_TCD_ATTR_DSIZE(x)		((uint16_t)((x) & 0x7U))
+#define DMA_TCD_ATTR_DMOD(x)		((uint16_t)(((x) << 3U) & 0xF8U))
+#define DMA_TCD_ATTR_SSIZE(x)		((uint16_t)(((x) << 8U) & 0x700U))
+#define DMA_TCD_ATTR_SMOD(x)		((uint16_t)(((x) << 11U) & 0xF800U))
+#define DMA_TCD_NBYTES_MLNO_NBYTES(x)	((uint32_t)(x))
+#define DMA_TCD_CITER_ELINKNO_CITER_MASK	(0x7FFFU)
+#define DMA_TCD_CITER_ELINKNO_CITER(x)	((uint16_t)((x) & DMA_TCD_CITER_ELINKNO_CITER_MASK))
+#define DMA_TCD_BITER_ELINKNO_BITER_MASK	(0x7FFFU)
+#define DMA_TCD_BITER_ELINKNO_BITER(x)	((uint16_t)((x) & DMA_TCD_BITER_ELINKNO_BITER_MASK))
+#define DMA_TCD_CSR_START_MASK		(0x0001U)
+#define DMA_TCD_CSR_INTMAJOR_MASK	(0x0002U)
+#define DMA_TCD_CSR_INTHALF_MASK	(0x0004U)
+#define DMA_TCD_CSR_DREQ_MASK		(0x0008U)
+#define DMA_TCD_CSR_ACTIVE_MASK		(0x0040U)
+#define DMA_TCD_CSR_DONE_MASK		(0x0080U)
+
+/* DMAMUX */
+#define DMAMUX_CHCFG_SOURCE(x)		((uint8_t)((x) & 0x3FU))
+#define DMAMUX_CHCFG_TRIG_MASK		(0x40U)
+#define DMAMUX_CHCFG_ENBL_MASK		(0x80U)
+
+/* FTFC FSTAT */
+#define FTFC_FSTAT_CCIF_MASK		(0x80U)
+#define FTFC_FSTAT_RDCOLERR_MASK	(0x40U)
+#define FTFC_FSTAT_ACCERR_MASK		(0x20U)
+#define FTFC_FSTAT_FPVIOL_MASK		(0x10U)
+#define FTFC_FSTAT_MGSTAT0_MASK		(0x01U)
+
+/* LMEM PCCCR */
+#define LMEM_PCCCR_INVW0_MASK		(0x01000000U)
+#define LMEM_PCCCR_INVW1_MASK		(0x04000000U)
+#define LMEM_PCCCR_GO_MASK			(0x80000000U)
+
+/* PORT */
+#define PORT_PCR_MUX_MASK			(0x00000700U)
+#define PORT_PCR_MUX(x)				(((uint32_t)(x) << 8U) & PORT_PCR_MUX_MASK)
+
+/* SysTick */
+#define S32_SysTick_CSR_ENABLE_MASK		(0x00000001U)
+#define S32_SysTick_CSR_TICKINT_MASK	(0x00000002U)
+#define S32_SysTick_CSR_CLKSOURCE_MASK	(0x00000004U)
+#define S32_SysTick_RVR_RELOAD(x)		((uint32_t)(x) & 0x00FFFFFFU)
+
+/* FlexCAN poll loops advance the model (see flexcan_core.h) */
+#define FLEXCAN_POLL_HOOK(pCan)		sim_can_poll(pCan)
+
+/* The model runs interrupts between bus events only: no barrier instruction needed after an NVIC write */
+#define FLEXCAN_IRQ_BARRIER()		__asm volatile ("" ::: "memory")
+
+/* Flash commands run on the model (see ftfc.h): the buses go on, interrupts are held off */
+#define FTFC_LAUNCH(pFstat)			sim_can_flash_launch(pFstat)
+#define FTFC_IRQ_DISABLE()			sim_can_irq_mask(1U)
+#define FTFC_IRQ_ENABLE()			sim_can_irq_mask(0U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Model poll.
+* @details          Called from the FlexCAN register poll loops: completes a pending freeze, disable or
+*					start-up transition of the instance. See sim_can.c.
+* @param[in]        pCan - FlexCAN instance.
+* @return           void.
+*/
+void sim_can_poll(volatile CAN_Type *pCan);
+
+/**
+* @brief            Flash command launch.
+* @details          FTFC_LAUNCH() of ftfc.c: starts the command loaded in FCCOB and runs the model until
+*					CCIF is set again. See sim_can.c.
+* @param[in]        pu8Fstat - FTFC->FSTAT.
+* @return           void.
+*/
+void sim_can_flash_launch(volatile uint8_t *pu8Fstat);
+
+/**
+* @brief            Interrupt mask.
+* @details          PRIMASK of the model: with u8Masked=1 no handler runs. See sim_can.c.
+* @param[in]        u8Masked - 1: interrupts held off, 0: taken again.
+* @return           void.
+*/
+void sim_can_irq_mask(uint8_t u8Masked);
+
+
+#endif	/* DEVICE_REGISTERS_H */
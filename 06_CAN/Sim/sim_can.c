@@ -0,0 +1,2972 @@
+/**
+* @file			sim_can.c
+* @brief		Host FlexCAN register model and virtual CAN buses
+* @details		Each register block is a memfd page mapped twice: at its silicon address without access
+*				rights (device view, used by the drivers) and anywhere else read/write (model view, used
+*				here). A driver access faults. The SIGSEGV handler updates the register for the access
+*				(TIMER), opens the page and single-steps the instruction with the x86 trap flag; the
+*				SIGTRAP handler closes the page again and applies the side effects of the access: write 1
+*				to clear, freeze mode only fields, MB lock and unlock, RX FIFO pop, NVIC enable state. A
+*				read fault opens the page read-only, so a read-modify-write instruction faults a second
+*				time and is handled as a write.
+*
+*				eDMA channels routed to a FlexCAN RX FIFO (DMAMUX source 54-56) run their TCD when the
+*				FIFO holds a frame: one minor loop per frame, CITER/BITER, SMOD/DMOD, SLAST/DLASTSGA,
+*				INTHALF/INTMAJOR and DREQ. Addresses outside the register blocks are host addresses, so
+*				a test using the eDMA must link its buffers below 4 GB (-no-pie).
+*
+*				P-Flash from SIM_CAN_FLASH_START is plain memory at its address. The FTFC runs sector
+*				erase and phrase program (ERSSCR, PGM8) launched through FSTAT[CCIF]: CCIF stays 0 for
+*				the command time while the buses go on, ftfc.c holds interrupts off meanwhile
+*				(sim_can_irq_mask()). LMEM cache invalidation completes at once.
+*
+*				Interrupts are taken from sim_can_run() between bus events, never inside thread code.
+*				Every frame is acknowledged: a bus tool is assumed on each bus. Linux on x86-64 only.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "sim_can.h"
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "sim_can.c: register access trapping needs Linux on x86-64"
+#endif
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Register block at its silicon address */
+typedef struct
+{
+	uintptr_t uBase;				/* Silicon address */
+	uint32_t u32Size;				/* Bytes, whole pages */
+	uint8_t u8Kind;					/* SIM_REGION_xxx */
+	uint8_t u8Inst;					/* FlexCAN instance */
+	volatile uint8_t *pu8Model;		/* Model view */
+} sim_region_t;
+
+/* Trapped access in progress */
+typedef struct
+{
+	sim_region_t *pRegion;			/* NULL: none */
+	uintptr_t uPage;				/* Device view page */
+	uint32_t u32Offset;				/* Word offset in the region */
+	uint32_t u32Old;				/* Word before the access */
+	uint8_t u8Write;				/* Write or read-modify-write */
+} sim_access_t;
+
+/* Frame on a bus, or waiting in the RX SMB for a locked MB */
+typedef struct
+{
+	sim_can_frame_t frame;
+	uint64_t u64Start;				/* Start of frame */
+	uint64_t u64End;				/* End of intermission */
+	uint32_t u32NominalTicks;		/* Bit times of the transmitter */
+	uint32_t u32DataTicks;
+	uint8_t u8Src;					/* Instance, SIM_CAN_SRC_GEN + n or SIM_CAN_SRC_INJECT */
+	uint8_t u8Mb;					/* Transmit MB of an instance */
+} sim_bus_frame_t;
+
+/* RX FIFO entry: MB0 words 0-3 and IDHIT */
+typedef struct
+{
+	uint32_t au32Word[4];
+	uint16_t u16IdHit;
+} sim_fifo_entry_t;
+
+/* FlexCAN instance */
+typedef struct
+{
+	uint8_t u8State;				/* SIM_STATE_xxx acknowledged in MCR */
+	uint8_t u8Countdown;			/* Polls until the requested state is reached, 0: none requested */
+	uint32_t u32Polls;				/* Polls without a pending transition */
+	uint8_t u8Bus;					/* Attached bus */
+	int16_t s16Locked;				/* Locked MB, -1: none */
+	uint32_t u32Serviced;			/* FULL/OVERRUN MBs read and unlocked since their last frame */
+	uint8_t u8Held;					/* A frame waits for the locked MB */
+	sim_bus_frame_t held;
+	uint16_t u16HeldStamp;
+	uint16_t u16TimerBase;			/* TIMER at u64TimerT0 */
+	uint64_t u64TimerT0;
+	sim_fifo_entry_t aFifo[6];		/* RX FIFO, [0] is the output */
+	uint8_t u8FifoCount;
+	uint16_t u16Tec;				/* Error counters, TEC > 255: bus off */
+	uint16_t u16Rec;
+	uint8_t u8BusOff;
+	uint64_t u64RecoverAt;			/* End of the bus off recovery, 0: not running */
+} sim_inst_t;
+
+/* Virtual bus */
+typedef struct
+{
+	uint8_t u8Active;				/* Frame in progress */
+	sim_bus_frame_t cur;
+	uint32_t u32NominalTicks;		/* Bit times of generated and injected frames */
+	uint32_t u32DataTicks;
+	sim_bus_frame_t aInject[64];	/* Injected frames, by time */
+	uint8_t u8InjectCount;
+} sim_bus_t;
+
+/* Frame generator */
+typedef struct
+{
+	uint8_t u8Used;
+	uint8_t u8Bus;
+	uint8_t u8LoadPct;				/* 0: periodic */
+	sim_can_frame_t tmpl;
+	uint32_t u32IdHigh;
+	uint32_t u32NextId;
+	uint64_t u64Period;				/* Ticks */
+	uint64_t u64Due;				/* Next frame takes part in arbitration from here */
+	uint32_t u32Count;				/* 0: no limit */
+	uint32_t u32Sent;
+} sim_gen_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+#define SIM_PAGE				(0x1000U)
+
+/* Register block kinds */
+#define SIM_REGION_CAN			(0U)
+#define SIM_REGION_SCS			(1U)		/* NVIC, SysTick */
+#define SIM_REGION_LPIT			(2U)
+#define SIM_REGION_PLAIN		(3U)		/* Plain memory, not trapped */
+#define SIM_REGION_DMA			(4U)		/* eDMA control registers and TCDs */
+#define SIM_REGION_FLASH		(5U)		/* FTFC, LMEM */
+#define SIM_REGION_COUNT		(11U)
+
+/* Instance states */
+#define SIM_STATE_DISABLED		(0U)		/* MDIS=1, LPMACK=1 */
+#define SIM_STATE_FROZEN		(1U)		/* FRZACK=1 */
+#define SIM_STATE_RUNNING		(2U)		/* FRZACK=0, NOTRDY=0 */
+
+/* Polls a mode change takes, polls after which a wait is reported as hung */
+#define SIM_ACK_POLLS			(3U)
+#define SIM_POLL_LIMIT			(100000U)
+
+/* Buses: SIM_CAN_BUS_COUNT shared, then one internal bus per instance in loopback (CTRL1[LPB]) */
+#define SIM_BUS_TOTAL			(SIM_CAN_BUS_COUNT + 3U)
+
+/* Interrupt numbers handled */
+#define SIM_IRQ_COUNT			(128U)
+
+/* MB C/S word */
+#define SIM_CS_EDL				(0x80000000U)
+#define SIM_CS_BRS				(0x40000000U)
+#define SIM_CS_CODE(cs)			(((cs) >> 24U) & 0xFU)
+#define SIM_CS_SRR				(0x00400000U)
+#define SIM_CS_IDE				(0x00200000U)
+#define SIM_CS_RTR				(0x00100000U)
+#define SIM_CS_DLC(cs)			(((cs) >> 16U) & 0xFU)
+#define SIM_CS_IDHIT_SHIFT		(23U)		/* RX FIFO output with MCR[DMA]=1 */
+
+/* MB codes */
+#define SIM_CODE_RX_FULL		(0x2U)
+#define SIM_CODE_RX_EMPTY		(0x4U)
+#define SIM_CODE_RX_OVERRUN		(0x6U)
+#define SIM_CODE_TX_INACTIVE	(0x8U)
+#define SIM_CODE_TX_DATA		(0xCU)
+
+/* IFLAG1 with the RX FIFO */
+#define SIM_BUF5I				(0x20U)
+#define SIM_BUF6I				(0x40U)
+#define SIM_BUF7I				(0x80U)
+
+/* Register offsets */
+#define SIM_OFF(reg)			((uint32_t)offsetof(CAN_Type, reg))
+#define SIM_RAM_OFF				SIM_OFF(RAMn)
+#define SIM_RXIMR_OFF			SIM_OFF(RXIMR)
+
+/* NVIC and LPIT offsets in their pages */
+#define SIM_NVIC_OFF			(S32_NVIC_BASE - 0xE000E000U)
+#define SIM_LPIT_MSR_OFF		((uint32_t)offsetof(LPIT_Type, MSR))
+#define SIM_LPIT_TCTRL0_OFF		((uint32_t)offsetof(LPIT_Type, TMR[0].TCTRL))
+#define SIM_LPIT_CVAL0_OFF		((uint32_t)offsetof(LPIT_Type, TMR[0].CVAL))
+
+/* eDMA: byte wide set/clear registers, left at NOP=1 between writes to see which byte was written */
+#define SIM_DMA_CEEI_OFF		((uint32_t)offsetof(DMA_Type, CEEI))	/* CEEI, SEEI, CERQ, SERQ */
+#define SIM_DMA_CDNE_OFF		((uint32_t)offsetof(DMA_Type, CDNE))	/* CDNE, SSRT, CERR, CINT */
+#define SIM_DMA_INT_OFF			((uint32_t)offsetof(DMA_Type, INT))
+#define SIM_DMA_BYTES_NOP		(0x80808080U)
+#define SIM_DMA_NOP				(0x80U)
+#define SIM_DMA_ALL				(0x40U)		/* CAER, SAER, ...: all channels */
+
+/* eDMA TCD fields not modelled: scatter/gather, channel linking */
+#define SIM_DMA_CSR_ESG			(0x0010U)
+#define SIM_DMA_CSR_MAJORELINK	(0x0020U)
+#define SIM_DMA_ITER_ELINK		(0x8000U)
+
+/* DMAMUX request source of FlexCAN0, FlexCAN1 and FlexCAN2 follow */
+#define SIM_DMA_REQ_CAN0		(54U)
+
+/* FTFC commands and their alignment */
+#define SIM_FTFC_PGM8			(0x07U)
+#define SIM_FTFC_ERSSCR			(0x09U)
+#define SIM_FTFC_SECTOR			(4096U)
+#define SIM_FTFC_PHRASE			(8U)
+#define SIM_FTFC_W1C			(FTFC_FSTAT_RDCOLERR_MASK | FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK)
+
+/* Freeze mode only fields */
+#define SIM_MCR_FREEZE_ONLY		(CAN_MCR_RFEN_MASK | CAN_MCR_WRNEN_MASK | CAN_MCR_SRXDIS_MASK | CAN_MCR_IRMQ_MASK \
+								| CAN_MCR_DMA_MASK | CAN_MCR_LPRIOEN_MASK | CAN_MCR_AEN_MASK | CAN_MCR_FDEN_MASK \
+								| CAN_MCR_IDAM_MASK | CAN_MCR_MAXMB_MASK)
+#define SIM_MCR_READ_ONLY		(CAN_MCR_NOTRDY_MASK | CAN_MCR_FRZACK_MASK | CAN_MCR_LPMACK_MASK | CAN_MCR_SOFTRST_MASK)
+#define SIM_CTRL1_FREEZE_ONLY	(CAN_CTRL1_PRESDIV_MASK | CAN_CTRL1_RJW_MASK | CAN_CTRL1_PSEG1_MASK | CAN_CTRL1_PSEG2_MASK \
+								| CAN_CTRL1_LPB_MASK | CAN_CTRL1_SMP_MASK | CAN_CTRL1_TSYN_MASK | CAN_CTRL1_LBUF_MASK \
+								| CAN_CTRL1_LOM_MASK | CAN_CTRL1_PROPSEG_MASK)
+#define SIM_CTRL2_FREEZE_ONLY	(~(CAN_CTRL2_ERRMSK_FAST_MASK | CAN_CTRL2_BOFFDONEMSK_MASK))
+#define SIM_ESR1_W1C			(CAN_ESR1_WAKINT_MASK | CAN_ESR1_ERRINT_MASK | CAN_ESR1_BOFFINT_MASK | CAN_ESR1_RWRNINT_MASK \
+								| CAN_ESR1_TWRNINT_MASK | CAN_ESR1_BOFFDONEINT_MASK | CAN_ESR1_ERRINT_FAST_MASK \
+								| CAN_ESR1_ERROVR_MASK)
+#define SIM_ESR1_ERRORS			(CAN_ESR1_STFERR_MASK | CAN_ESR1_FRMERR_MASK | CAN_ESR1_CRCERR_MASK | CAN_ESR1_ACKERR_MASK \
+								| CAN_ESR1_BIT0ERR_MASK | CAN_ESR1_BIT1ERR_MASK)
+
+/* Model views */
+#define SIM_REGS(inst)			((CAN_Type *)(uintptr_t)s_aRegion[(inst)].pu8Model)
+#define SIM_WORD(region, off)	(*(volatile uint32_t *)&(region)->pu8Model[(off)])
+#define SIM_NVIC()				((S32_NVIC_Type *)(uintptr_t)&s_aRegion[3].pu8Model[SIM_NVIC_OFF])
+#define SIM_LPIT()				((LPIT_Type *)(uintptr_t)s_aRegion[4].pu8Model)
+#define SIM_PCC()				((PCC_Type *)(uintptr_t)s_aRegion[5].pu8Model)
+#define SIM_DMA()				((DMA_Type *)(uintptr_t)s_aRegion[6].pu8Model)
+#define SIM_DMAMUX()			((DMAMUX_Type *)(uintptr_t)s_aRegion[7].pu8Model)
+#define SIM_FTFC()				((FTFC_Type *)(uintptr_t)s_aRegion[8].pu8Model)
+#define SIM_LMEM()				((LMEM_Type *)(uintptr_t)s_aRegion[9].pu8Model)
+#define SIM_PFLASH(addr)		(&s_aRegion[10].pu8Model[(addr) - SIM_CAN_FLASH_START])
+
+/* Silicon layout */
+_Static_assert(offsetof(CAN_Type, RAMn) == 0x80U, "CAN_Type RAMn");
+_Static_assert(offsetof(CAN_Type, RXIMR) == 0x880U, "CAN_Type RXIMR");
+_Static_assert(offsetof(CAN_Type, FDCTRL) == 0xC00U, "CAN_Type FDCTRL");
+_Static_assert(offsetof(S32_NVIC_Type, IP) == 0x300U, "S32_NVIC_Type IP");
+_Static_assert(offsetof(DMA_Type, TCD) == 0x1000U, "DMA_Type TCD");
+_Static_assert(offsetof(DMA_Type, CDNE) == 0x1CU, "DMA_Type CDNE");
+_Static_assert(offsetof(DMA_Type, INT) == 0x24U, "DMA_Type INT");
+_Static_assert(offsetof(LPIT_Type, TMR[0].TCTRL) == 0x28U, "LPIT_Type TCTRL");
+_Static_assert(offsetof(FTFC_Type, FPROT) == 0x10U, "FTFC_Type FPROT");
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* PCC slot of each instance */
+static const uint8_t s_au8PccIndex[3] = {PCC_FlexCAN0_INDEX, PCC_FlexCAN1_INDEX, PCC_FlexCAN2_INDEX};
+
+/* FD DLC code -> number of data bytes */
+static const uint8_t s_au8DlcLength[16] = {0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Register blocks */
+static sim_region_t s_aRegion[SIM_REGION_COUNT] =
+{
+	{CAN0_BASE, SIM_PAGE, SIM_REGION_CAN, 0U, NULL},
+	{CAN1_BASE, SIM_PAGE, SIM_REGION_CAN, 1U, NULL},
+	{CAN2_BASE, SIM_PAGE, SIM_REGION_CAN, 2U, NULL},
+	{0xE000E000U, SIM_PAGE, SIM_REGION_SCS, 0U, NULL},
+	{LPIT0_BASE, SIM_PAGE, SIM_REGION_LPIT, 0U, NULL},
+	{PCC_BASE, SIM_PAGE, SIM_REGION_PLAIN, 0U, NULL},
+	{DMA_BASE, 2U * SIM_PAGE, SIM_REGION_DMA, 0U, NULL},
+	{DMAMUX_BASE, SIM_PAGE, SIM_REGION_PLAIN, 0U, NULL},
+	{FTFC_BASE, SIM_PAGE, SIM_REGION_FLASH, 0U, NULL},
+	{LMEM_BASE, SIM_PAGE, SIM_REGION_FLASH, 0U, NULL},
+	{SIM_CAN_FLASH_START, SIM_CAN_FLASH_END - SIM_CAN_FLASH_START, SIM_REGION_PLAIN, 0U, NULL}
+};
+
+static sim_access_t s_Access;
+static sim_inst_t s_aInst[3];
+static sim_bus_t s_aBus[SIM_BUS_TOTAL];
+static sim_gen_t s_aGen[SIM_CAN_GEN_COUNT];
+static sim_can_stats_t s_Stats;
+static sim_can_monitor_t s_pfMonitor;
+
+/* Interrupts: handlers, NVIC state, handler calls without time passing, PRIMASK */
+static sim_can_isr_t s_apfIsr[SIM_IRQ_COUNT];
+static uint32_t s_au32NvicEnabled[4];
+static uint32_t s_au32NvicPending[4];
+static uint8_t s_au8IrqCalls[SIM_IRQ_COUNT];
+static uint8_t s_u8IrqMask;
+
+/* Model time */
+static uint64_t s_u64Now;
+
+/* LPIT0 ch0 expiry, 0: stopped */
+static uint64_t s_u64LpitDue;
+
+/* FTFC command running: end, 0: idle. Command, address and phrase latched at the launch */
+static uint64_t s_u64FlashDue;
+static uint8_t s_u8FlashCmd;
+static uint32_t s_u32FlashAddr;
+static uint8_t s_au8FlashData[SIM_FTFC_PHRASE];
+
+/* Random numbers of the load generators */
+static uint32_t s_u32Random;
+
+/* Checks */
+static uint32_t s_u32Checks;
+static uint32_t s_u32Failed;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void sim_fatal(const char *pcFormat, ...);
+static sim_region_t *sim_region_find(uintptr_t uAddr);
+static void sim_segv(int iSig, siginfo_t *pInfo, void *pvContext);
+static void sim_trap(int iSig, siginfo_t *pInfo, void *pvContext);
+static void sim_map(void);
+static uint32_t sim_random(void);
+static uint8_t sim_dlc(const sim_can_frame_t *pFrame);
+static uint32_t sim_id_word(uint32_t u32Id);
+static uint32_t sim_key(const sim_can_frame_t *pFrame);
+static uint32_t sim_mb_words(uint8_t u8Inst);
+static uint32_t sim_mb_first(uint8_t u8Inst);
+static uint32_t sim_mb_count(uint8_t u8Inst);
+static uint16_t sim_timer_at(uint8_t u8Inst, uint64_t u64Time);
+static void sim_state_enter(uint8_t u8Inst, uint8_t u8State);
+static void sim_state_request(uint8_t u8Inst);
+static uint32_t sim_freeze_only(uint8_t u8Inst, uint32_t u32Old, uint32_t u32New, uint32_t u32Mask);
+static void sim_lock(uint8_t u8Inst, int16_t s16Mb);
+static void sim_fifo_load(uint8_t u8Inst);
+static void sim_fifo_pop(uint8_t u8Inst);
+static void sim_can_pre(sim_region_t *pRegion, uint32_t u32Off);
+static void sim_can_read(sim_region_t *pRegion, uint32_t u32Off);
+static void sim_can_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static void sim_scs_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static void sim_lpit_pre(sim_region_t *pRegion, uint32_t u32Off);
+static void sim_lpit_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static void sim_dma_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static volatile uint8_t *sim_dma_addr(uint32_t u32Addr);
+static uint32_t sim_dma_next(uint32_t u32Addr, int16_t s16Offset, uint32_t u32Mod);
+static void sim_dma_minor(uint32_t u32Ch);
+static void sim_dma_service(void);
+static void sim_flash_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old);
+static uint8_t sim_flash_start(uint8_t u8Fstat);
+static void sim_flash_done(void);
+static void sim_frame_words(const sim_can_frame_t *pFrame, uint32_t *pu32Words, uint32_t u32Count);
+static int32_t sim_fifo_match(uint8_t u8Inst, const sim_can_frame_t *pFrame);
+static uint8_t sim_mb_match(uint8_t u8Inst, uint32_t u32Mb, const sim_can_frame_t *pFrame);
+static void sim_rx_mb(uint8_t u8Inst, const sim_bus_frame_t *pBf, uint16_t u16Stamp);
+static void sim_rx(uint8_t u8Inst, const sim_bus_frame_t *pBf);
+static uint8_t sim_inst_online(uint8_t u8Inst);
+static uint8_t sim_inst_bus(uint8_t u8Inst);
+static uint8_t sim_tx_candidate(uint8_t u8Inst, sim_bus_frame_t *pBf);
+static void sim_gen_schedule(sim_gen_t *pGen, uint64_t u64From, uint64_t u64FrameTicks);
+static void sim_gen_frame(uint8_t u8Gen, sim_bus_frame_t *pBf);
+static void sim_bus_start(uint8_t u8Bus);
+static void sim_bus_end(uint8_t u8Bus);
+static void sim_err_update(uint8_t u8Inst, uint16_t u16OldTec, uint16_t u16OldRec);
+static uint8_t sim_irq_active(uint32_t u32Irq);
+static void sim_irq_dispatch(void);
+static void sim_settle(void);
+static uint8_t sim_idle(void);
+static uint8_t sim_run(uint64_t u64End, uint8_t u8StopIdle);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Stop on a model error.
+* @param[in]        pcFormat - printf format.
+* @return           void.
+*/
+static void sim_fatal(const char *pcFormat, ...)
+{
+	va_list args;
+
+	va_start(args, pcFormat);
+	(void)fprintf(stderr, "sim_can: ");
+	(void)vfprintf(stderr, pcFormat, args);
+	(void)fprintf(stderr, "\n");
+	va_end(args);
+	(void)fflush(stderr);
+	_exit(2);
+}
+
+/**
+* @brief            Register block of an address.
+* @param[in]        uAddr - Address.
+* @return           Region, NULL if none.
+*/
+static sim_region_t *sim_region_find(uintptr_t uAddr)
+{
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		if ((uAddr >= s_aRegion[u32Index].uBase) && (uAddr < (s_aRegion[u32Index].uBase + s_aRegion[u32Index].u32Size)))
+		{
+			return &s_aRegion[u32Index];
+		}
+	}
+	return NULL;
+}
+
+/**
+* @brief            Register access fault.
+* @details          Pre-access update, open the page, single-step the instruction.
+* @param[in]        iSig - SIGSEGV.
+* @param[in]        pInfo - Fault address.
+* @param[in]        pvContext - Interrupted context.
+* @return           void.
+*/
+static void sim_segv(int iSig, siginfo_t *pInfo, void *pvContext)
+{
+	ucontext_t *pContext = (ucontext_t *)pvContext;
+	uintptr_t uAddr = (uintptr_t)pInfo->si_addr;
+	sim_region_t *pRegion = sim_region_find(uAddr);
+	uint8_t u8Write = (0 != (pContext->uc_mcontext.gregs[REG_ERR] & 2)) ? 1U : 0U;
+
+	(void)iSig;
+	if (NULL == pRegion)
+	{
+		sim_fatal("access to %p, not a modelled register", pInfo->si_addr);
+	}
+
+	if (NULL != s_Access.pRegion)				/* Second fault of the instruction: it also writes */
+	{
+		if ((pRegion != s_Access.pRegion) || (0U == u8Write))
+		{
+			sim_fatal("instruction accesses two registers at %p", pInfo->si_addr);
+		}
+		s_Access.u8Write = 1U;
+		(void)mprotect((void *)s_Access.uPage, SIM_PAGE, PROT_READ | PROT_WRITE);
+		return;
+	}
+
+	if ((SIM_REGION_CAN == pRegion->u8Kind)
+		&& (0U == (SIM_PCC()->PCCn[s_au8PccIndex[pRegion->u8Inst]] & PCC_PCCn_CGC_MASK)))
+	{
+		sim_fatal("CAN%u register access with the PCC clock gated (offset 0x%03X)", pRegion->u8Inst,
+				  (uint32_t)(uAddr - pRegion->uBase));
+	}
+	if ((SIM_REGION_LPIT == pRegion->u8Kind) && (0U == (SIM_PCC()->PCCn[PCC_LPIT_INDEX] & PCC_PCCn_CGC_MASK)))
+	{
+		sim_fatal("LPIT0 register access with the PCC clock gated");
+	}
+
+	s_Stats.u32Accesses++;
+	s_Access.pRegion = pRegion;
+	s_Access.uPage = uAddr & ~(uintptr_t)(SIM_PAGE - 1U);
+	s_Access.u32Offset = (uint32_t)(uAddr - pRegion->uBase) & ~3U;
+	s_Access.u8Write = u8Write;
+
+	if (SIM_REGION_CAN == pRegion->u8Kind)
+	{
+		sim_can_pre(pRegion, s_Access.u32Offset);
+	}
+	else if (SIM_REGION_LPIT == pRegion->u8Kind)
+	{
+		sim_lpit_pre(pRegion, s_Access.u32Offset);
+	}
+	s_Access.u32Old = SIM_WORD(pRegion, s_Access.u32Offset);
+
+	(void)mprotect((void *)s_Access.uPage, SIM_PAGE, (0U != u8Write) ? (PROT_READ | PROT_WRITE) : PROT_READ);
+	pContext->uc_mcontext.gregs[REG_EFL] |= 0x100;	/* TF: trap after the instruction */
+}
+
+/**
+* @brief            Register access done.
+* @details          Close the page, apply the side effects of the access.
+* @param[in]        iSig - SIGTRAP.
+* @param[in]        pInfo - Unused.
+* @param[in]        pvContext - Interrupted context.
+* @return           void.
+*/
+static void sim_trap(int iSig, siginfo_t *pInfo, void *pvContext)
+{
+	ucontext_t *pContext = (ucontext_t *)pvContext;
+	sim_region_t *pRegion = s_Access.pRegion;
+
+	(void)iSig;
+	(void)pInfo;
+	if (NULL == pRegion)
+	{
+		sim_fatal("unexpected SIGTRAP");
+	}
+	pContext->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+	(void)mprotect((void *)s_Access.uPage, SIM_PAGE, PROT_NONE);
+	s_Access.pRegion = NULL;
+
+	switch (pRegion->u8Kind)
+	{
+		case SIM_REGION_CAN:
+			if (0U != s_Access.u8Write)
+			{
+				sim_can_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			else
+			{
+				sim_can_read(pRegion, s_Access.u32Offset);
+			}
+			break;
+		case SIM_REGION_SCS:
+			if (0U != s_Access.u8Write)
+			{
+				sim_scs_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+		case SIM_REGION_DMA:
+			if (0U != s_Access.u8Write)
+			{
+				sim_dma_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+		case SIM_REGION_FLASH:
+			if (0U != s_Access.u8Write)
+			{
+				sim_flash_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+		default:
+			if (0U != s_Access.u8Write)
+			{
+				sim_lpit_write(pRegion, s_Access.u32Offset, s_Access.u32Old);
+			}
+			break;
+	}
+}
+
+/**
+* @brief            Map the register blocks.
+* @param        	void.
+* @return           void.
+*/
+static void sim_map(void)
+{
+	struct sigaction action;
+	uint32_t u32Index = 0U;
+	uint32_t u32Total = 0U;
+	uint32_t u32Offset = 0U;
+	void *pvDevice = NULL;
+	void *pvModel = NULL;
+	int iFd = memfd_create("sim_can", 0U);
+
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		u32Total += s_aRegion[u32Index].u32Size;
+	}
+	if ((iFd < 0) || (0 != ftruncate(iFd, (off_t)u32Total)))
+	{
+		sim_fatal("memfd");
+	}
+
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		pvDevice = mmap((void *)s_aRegion[u32Index].uBase, s_aRegion[u32Index].u32Size,
+						(SIM_REGION_PLAIN == s_aRegion[u32Index].u8Kind) ? (PROT_READ | PROT_WRITE) : PROT_NONE,
+						MAP_SHARED | MAP_FIXED_NOREPLACE, iFd, (off_t)u32Offset);
+		pvModel = mmap(NULL, s_aRegion[u32Index].u32Size, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, (off_t)u32Offset);
+		if ((pvDevice != (void *)s_aRegion[u32Index].uBase) || (MAP_FAILED == pvModel))
+		{
+			sim_fatal("cannot map the registers at 0x%08lX", (unsigned long)s_aRegion[u32Index].uBase);
+		}
+		s_aRegion[u32Index].pu8Model = (volatile uint8_t *)pvModel;
+		u32Offset += s_aRegion[u32Index].u32Size;
+	}
+
+	(void)memset(&action, 0, sizeof(action));
+	action.sa_sigaction = sim_segv;
+	action.sa_flags = SA_SIGINFO;
+	(void)sigaction(SIGSEGV, &action, NULL);
+	action.sa_sigaction = sim_trap;
+	(void)sigaction(SIGTRAP, &action, NULL);
+}
+
+/**
+* @brief            Random number (xorshift32).
+* @param        	void.
+* @return           Number.
+*/
+static uint32_t sim_random(void)
+{
+	s_u32Random ^= s_u32Random << 13U;
+	s_u32Random ^= s_u32Random >> 17U;
+	s_u32Random ^= s_u32Random << 5U;
+	return s_u32Random;
+}
+
+/**
+* @brief            DLC of a frame.
+* @param[in]        pFrame - Frame.
+* @return           DLC: length for classic frames, smallest DLC that holds the length for FD frames.
+*/
+static uint8_t sim_dlc(const sim_can_frame_t *pFrame)
+{
+	uint8_t u8Dlc = 0U;
+
+	if (0U == (pFrame->u8Flags & SIM_CAN_FDF))
+	{
+		return (pFrame->u8Length > 8U) ? 8U : pFrame->u8Length;
+	}
+	while ((u8Dlc < 15U) && (s_au8DlcLength[u8Dlc] < pFrame->u8Length))
+	{
+		u8Dlc++;
+	}
+	return u8Dlc;
+}
+
+/**
+* @brief            MB ID word of a frame ID.
+* @param[in]        u32Id - Standard ID, or extended ID with SIM_CAN_EXT.
+* @return           ID word.
+*/
+static uint32_t sim_id_word(uint32_t u32Id)
+{
+	return (0U != (u32Id & SIM_CAN_EXT)) ? (u32Id & 0x1FFFFFFFU) : ((u32Id & 0x7FFU) << 18U);
+}
+
+/**
+* @brief            Arbitration key.
+* @details          Arbitration field bits in bus order, MSB first: the lowest key wins.
+* @param[in]        pFrame - Frame.
+* @return           Key.
+*/
+static uint32_t sim_key(const sim_can_frame_t *pFrame)
+{
+	uint32_t u32Rtr = ((0U != (pFrame->u8Flags & SIM_CAN_RTR)) && (0U == (pFrame->u8Flags & SIM_CAN_FDF))) ? 1U : 0U;
+
+	if (0U != (pFrame->u32Id & SIM_CAN_EXT))
+	{
+		return (((pFrame->u32Id >> 18U) & 0x7FFU) << 21U) | (1U << 20U) | (1U << 19U)	/* Base ID, SRR, IDE */
+			 | ((pFrame->u32Id & 0x3FFFFU) << 1U) | u32Rtr;
+	}
+	return ((pFrame->u32Id & 0x7FFU) << 21U) | (u32Rtr << 20U);							/* Base ID, RTR, IDE=0 */
+}
+
+/**
+* @brief            Words per MB.
+* @param[in]        u8Inst - Instance.
+* @return           Words.
+*/
+static uint32_t sim_mb_words(uint8_t u8Inst)
+{
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Mbds = 0U;
+
+	if ((0U == u8Inst) && (0U != (pRegs->MCR & CAN_MCR_FDEN_MASK)))
+	{
+		u32Mbds = (pRegs->FDCTRL & CAN_FDCTRL_MBDSR0_MASK) >> CAN_FDCTRL_MBDSR0_SHIFT;
+	}
+	return 2U + (2U << u32Mbds);
+}
+
+/**
+* @brief            First MB not taken by the RX FIFO and its filter table.
+* @param[in]        u8Inst - Instance.
+* @return           MB.
+*/
+static uint32_t sim_mb_first(uint8_t u8Inst)
+{
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+
+	if (0U == (pRegs->MCR & CAN_MCR_RFEN_MASK))
+	{
+		return 0U;
+	}
+	return 8U + 2U*((pRegs->CTRL2 & CAN_CTRL2_RFFN_MASK) >> CAN_CTRL2_RFFN_SHIFT);
+}
+
+/**
+* @brief            MBs in use: RAM size, MCR[MAXMB] and the number of IFLAG1 bits.
+* @param[in]        u8Inst - Instance.
+* @return           Number of MBs.
+*/
+static uint32_t sim_mb_count(uint8_t u8Inst)
+{
+	uint32_t u32Count = ((0U == u8Inst) ? 128U : 64U) / sim_mb_words(u8Inst);
+	uint32_t u32MaxMb = (SIM_REGS(u8Inst)->MCR & CAN_MCR_MAXMB_MASK) + 1U;
+	uint32_t u32Flags = (0U == u8Inst) ? 32U : 16U;
+
+	u32Count = (u32MaxMb < u32Count) ? u32MaxMb : u32Count;
+	return (u32Flags < u32Count) ? u32Flags : u32Count;
+}
+
+/**
+* @brief            TIMER value.
+* @param[in]        u8Inst - Instance.
+* @param[in]        u64Time - Model time, not before the instance started.
+* @return           TIMER.
+*/
+static uint16_t sim_timer_at(uint8_t u8Inst, uint64_t u64Time)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+
+	if ((SIM_STATE_RUNNING != pInst->u8State) || (u64Time < pInst->u64TimerT0))
+	{
+		return pInst->u16TimerBase;
+	}
+	return (uint16_t)(pInst->u16TimerBase + (u64Time - pInst->u64TimerT0) / sim_can_bit_ticks(u8Inst, 0U));
+}
+
+/**
+* @brief            Enter a mode, update the MCR acknowledge bits.
+* @param[in]        u8Inst - Instance.
+* @param[in]        u8State - SIM_STATE_xxx.
+* @return           void.
+*/
+static void sim_state_enter(uint8_t u8Inst, uint8_t u8State)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Mcr = pRegs->MCR & ~(CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK | CAN_MCR_LPMACK_MASK);
+
+	if (SIM_STATE_RUNNING == pInst->u8State)
+	{
+		pInst->u16TimerBase = sim_timer_at(u8Inst, s_u64Now);	/* TIMER stops outside normal mode */
+	}
+	pInst->u8State = u8State;
+	pInst->u8Countdown = 0U;
+	pInst->u32Polls = 0U;
+
+	if (SIM_STATE_DISABLED == u8State)
+	{
+		u32Mcr |= CAN_MCR_LPMACK_MASK | CAN_MCR_NOTRDY_MASK;
+	}
+	else if (SIM_STATE_FROZEN == u8State)
+	{
+		u32Mcr |= CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK;
+	}
+	else
+	{
+		pInst->u64TimerT0 = s_u64Now;
+	}
+	pRegs->MCR = u32Mcr;
+}
+
+/**
+* @brief            Mode requested by MCR.
+* @details          MDIS: disabled, FRZ and HALT: freeze mode, else normal mode. The acknowledge bits
+*					follow after SIM_ACK_POLLS polls or at the next sim_can_run().
+* @param[in]        u8Inst - Instance.
+* @return           void.
+*/
+static void sim_state_request(uint8_t u8Inst)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	uint32_t u32Mcr = SIM_REGS(u8Inst)->MCR;
+	uint8_t u8Target = SIM_STATE_RUNNING;
+
+	if (0U != (u32Mcr & CAN_MCR_MDIS_MASK))
+	{
+		u8Target = SIM_STATE_DISABLED;
+	}
+	else if ((0U != (u32Mcr & CAN_MCR_FRZ_MASK)) && (0U != (u32Mcr & CAN_MCR_HALT_MASK)))
+	{
+		u8Target = SIM_STATE_FROZEN;
+	}
+	pInst->u8Countdown = (u8Target != pInst->u8State) ? SIM_ACK_POLLS : 0U;
+	pInst->u32Polls = 0U;
+}
+
+/**
+* @brief            Write of freeze mode only fields.
+* @param[in]        u8Inst - Instance.
+* @param[in]        u32Old - Register before the write.
+* @param[in]        u32New - Written value.
+* @param[in]        u32Mask - Freeze mode only fields.
+* @return           Register value: fields in u32Mask keep u32Old outside freeze mode.
+*/
+static uint32_t sim_freeze_only(uint8_t u8Inst, uint32_t u32Old, uint32_t u32New, uint32_t u32Mask)
+{
+	if ((SIM_STATE_FROZEN != s_aInst[u8Inst].u8State) && (0U != ((u32Old ^ u32New) & u32Mask)))
+	{
+		s_Stats.u32FreezeViolations++;
+		u32New = (u32New & ~u32Mask) | (u32Old & u32Mask);
+	}
+	return u32New;
+}
+
+/**
+* @brief            Lock an MB.
+* @details          Locking another MB or -1 (TIMER read) releases the locked one; a frame that waited
+*					for it is stored then.
+* @param[in]        u8Inst - Instance.
+* @param[in]        s16Mb - MB to lock, -1: unlock.
+* @return           void.
+*/
+static void sim_lock(uint8_t u8Inst, int16_t s16Mb)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+
+	if (s16Mb == pInst->s16Locked)
+	{
+		return;
+	}
+	if (pInst->s16Locked >= 0)
+	{
+		pInst->u32Serviced |= 1UL << pInst->s16Locked;	/* Read by the CPU: takes the next frame as FULL */
+	}
+	pInst->s16Locked = s16Mb;
+	if (0U != pInst->u8Held)
+	{
+		pInst->u8Held = 0U;
+		sim_rx_mb(u8Inst, &pInst->held, pInst->u16HeldStamp);
+	}
+}
+
+/**
+* @brief            Copy the RX FIFO head to the output (MB0) and RXFIR.
+* @param[in]        u8Inst - Instance.
+* @return           void.
+*/
+static void sim_fifo_load(uint8_t u8Inst)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < 4U; u32Index++)
+	{
+		pRegs->RAMn[u32Index] = pInst->aFifo[0].au32Word[u32Index];
+	}
+	*(volatile uint32_t *)&pRegs->RXFIR = pInst->aFifo[0].u16IdHit;
+	pRegs->IFLAG1 |= SIM_BUF5I;
+}
+
+/**
+* @brief            Release the RX FIFO output, the next frame moves up.
+* @param[in]        u8Inst - Instance.
+* @return           void.
+*/
+static void sim_fifo_pop(uint8_t u8Inst)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+
+	if (0U == pInst->u8FifoCount)
+	{
+		return;
+	}
+	pInst->u8FifoCount--;
+	(void)memmove(&pInst->aFifo[0], &pInst->aFifo[1], pInst->u8FifoCount * sizeof(pInst->aFifo[0]));
+	if (0U != pInst->u8FifoCount)
+	{
+		sim_fifo_load(u8Inst);
+	}
+}
+
+/**
+* @brief            FlexCAN access, before the instruction.
+* @param[in]        pRegion - Instance registers.
+* @param[in]        u32Off - Word offset.
+* @return           void.
+*/
+static void sim_can_pre(sim_region_t *pRegion, uint32_t u32Off)
+{
+	if (SIM_OFF(TIMER) == u32Off)
+	{
+		SIM_WORD(pRegion, u32Off) = sim_timer_at(pRegion->u8Inst, s_u64Now);
+	}
+}
+
+/**
+* @brief            FlexCAN read, after the instruction.
+* @details          TIMER read unlocks, C/S read of a receive MB locks it, ESR1 read clears the error bits.
+* @param[in]        pRegion - Instance registers.
+* @param[in]        u32Off - Word offset.
+* @return           void.
+*/
+static void sim_can_read(sim_region_t *pRegion, uint32_t u32Off)
+{
+	uint8_t u8Inst = pRegion->u8Inst;
+	uint32_t u32Word = 0U;
+	uint32_t u32Words = 0U;
+
+	if (SIM_OFF(TIMER) == u32Off)
+	{
+		sim_lock(u8Inst, -1);
+	}
+	else if (SIM_OFF(ESR1) == u32Off)
+	{
+		SIM_WORD(pRegion, u32Off) &= ~SIM_ESR1_ERRORS;
+	}
+	else if ((u32Off >= SIM_RAM_OFF) && (u32Off < (SIM_RAM_OFF + 4U*((0U == u8Inst) ? 128U : 64U))))
+	{
+		u32Word = (u32Off - SIM_RAM_OFF) / 4U;
+		u32Words = sim_mb_words(u8Inst);
+		if ((0U == (u32Word % u32Words)) && ((u32Word / u32Words) >= sim_mb_first(u8Inst))
+			&& (0U == (SIM_CS_CODE(SIM_WORD(pRegion, u32Off)) & 0x8U)))
+		{
+			sim_lock(u8Inst, (int16_t)(u32Word / u32Words));	/* C/S word of a receive MB */
+		}
+	}
+	else
+	{
+	}
+}
+
+/**
+* @brief            FlexCAN write, after the instruction.
+* @param[in]        pRegion - Instance registers.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_can_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	uint8_t u8Inst = pRegion->u8Inst;
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	volatile uint32_t *pu32Word = &SIM_WORD(pRegion, u32Off);
+	uint32_t u32New = *pu32Word;
+	uint32_t u32Word = 0U;
+	uint32_t u32Filters = 0U;
+
+	if ((u32Off >= SIM_RAM_OFF) && (u32Off < (SIM_RAM_OFF + 4U*((0U == u8Inst) ? 128U : 64U))))
+	{
+		u32Word = (u32Off - SIM_RAM_OFF) / 4U;
+		if (0U != (SIM_REGS(u8Inst)->MCR & CAN_MCR_RFEN_MASK))
+		{
+			u32Filters = 8U*(((SIM_REGS(u8Inst)->CTRL2 & CAN_CTRL2_RFFN_MASK) >> CAN_CTRL2_RFFN_SHIFT) + 1U);
+			if (u32Word < 24U)
+			{
+				*pu32Word = u32Old;					/* FIFO output and internal MBs: not writable */
+			}
+			else if (u32Word < (24U + u32Filters))
+			{
+				*pu32Word = sim_freeze_only(u8Inst, u32Old, u32New, 0xFFFFFFFFU);	/* Filter table */
+			}
+			else
+			{
+			}
+		}
+		if (0U == (u32Word % sim_mb_words(u8Inst)))
+		{
+			pInst->u32Serviced &= ~(1UL << (u32Word / sim_mb_words(u8Inst)));	/* C/S rewritten */
+		}
+		return;
+	}
+
+	if ((u32Off >= SIM_RXIMR_OFF) && (u32Off < (SIM_RXIMR_OFF + 4U*((0U == u8Inst) ? 32U : 16U))))
+	{
+		*pu32Word = sim_freeze_only(u8Inst, u32Old, u32New, 0xFFFFFFFFU);
+		return;
+	}
+
+	switch (u32Off)
+	{
+		case SIM_OFF(MCR):
+			u32New = sim_freeze_only(u8Inst, u32Old, u32New, SIM_MCR_FREEZE_ONLY);
+			*pu32Word = (u32New & ~SIM_MCR_READ_ONLY) | (u32Old & SIM_MCR_READ_ONLY);
+			if (0U != u8Inst)
+			{
+				*pu32Word &= ~CAN_MCR_FDEN_MASK;	/* CAN FD on CAN0 only */
+			}
+			sim_state_request(u8Inst);
+			break;
+		case SIM_OFF(CTRL1):
+			u32New = sim_freeze_only(u8Inst, u32Old, u32New, SIM_CTRL1_FREEZE_ONLY);
+			if ((SIM_STATE_DISABLED != pInst->u8State) && (0U != ((u32Old ^ u32New) & CAN_CTRL1_CLKSRC_MASK)))
+			{
+				s_Stats.u32FreezeViolations++;		/* CLKSRC: disabled mode only */
+				u32New = (u32New & ~CAN_CTRL1_CLKSRC_MASK) | (u32Old & CAN_CTRL1_CLKSRC_MASK);
+			}
+			*pu32Word = u32New;
+			break;
+		case SIM_OFF(TIMER):
+			pInst->u16TimerBase = (uint16_t)u32New;
+			pInst->u64TimerT0 = s_u64Now;
+			*pu32Word = u32New & 0xFFFFU;
+			break;
+		case SIM_OFF(ECR):
+			*pu32Word = sim_freeze_only(u8Inst, u32Old, u32New, 0xFFFFFFFFU);
+			pInst->u16Tec = (uint16_t)(*pu32Word & CAN_ECR_TXERRCNT_MASK);
+			pInst->u16Rec = (uint16_t)((*pu32Word & CAN_ECR_RXERRCNT_MASK) >> CAN_ECR_RXERRCNT_SHIFT);
+			break;
+		case SIM_OFF(ESR1):
+			*pu32Word = u32Old & ~(u32New & SIM_ESR1_W1C);
+			break;
+		case SIM_OFF(IFLAG1):
+			*pu32Word = u32Old & ~u32New;			/* Write 1 to clear */
+			if ((0U != (SIM_REGS(u8Inst)->MCR & CAN_MCR_RFEN_MASK)) && (0U != (u32Old & u32New & SIM_BUF5I)))
+			{
+				sim_fifo_pop(u8Inst);
+			}
+			break;
+		case SIM_OFF(CTRL2):
+			*pu32Word = sim_freeze_only(u8Inst, u32Old, u32New, SIM_CTRL2_FREEZE_ONLY);
+			break;
+		case SIM_OFF(RXMGMASK):
+		case SIM_OFF(RX14MASK):
+		case SIM_OFF(RX15MASK):
+		case SIM_OFF(RXFGMASK):
+		case SIM_OFF(CBT):
+		case SIM_OFF(FDCBT):
+			*pu32Word = sim_freeze_only(u8Inst, u32Old, u32New, 0xFFFFFFFFU);
+			break;
+		case SIM_OFF(FDCTRL):
+			*pu32Word = sim_freeze_only(u8Inst, u32Old, u32New, ~CAN_FDCTRL_TDCFAIL_MASK);
+			break;
+		case SIM_OFF(ESR2):
+		case SIM_OFF(CRCR):
+		case SIM_OFF(RXFIR):
+		case SIM_OFF(FDCRC):
+			*pu32Word = u32Old;						/* Read only */
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+* @brief            NVIC write: ISER/ICER set and clear the enables, ISPR/ICPR the pending bits.
+* @param[in]        pRegion - System control space.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_scs_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	S32_NVIC_Type *pNvic = SIM_NVIC();
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+	uint32_t u32Reg = 0U;
+	uint32_t u32Index = 0U;
+
+	(void)u32Old;
+	if ((u32Off < SIM_NVIC_OFF) || (u32Off >= (SIM_NVIC_OFF + 0x200U)))
+	{
+		return;										/* SysTick, IABR, IP: plain */
+	}
+	u32Reg = (u32Off - SIM_NVIC_OFF) / 0x80U;
+	u32Index = ((u32Off - SIM_NVIC_OFF) % 0x80U) / 4U;
+	if (u32Index >= 4U)
+	{
+		return;
+	}
+
+	switch (u32Reg)
+	{
+		case 0U:
+			s_au32NvicEnabled[u32Index] |= u32New;
+			break;
+		case 1U:
+			s_au32NvicEnabled[u32Index] &= ~u32New;
+			break;
+		case 2U:
+			s_au32NvicPending[u32Index] |= u32New;
+			break;
+		default:
+			s_au32NvicPending[u32Index] &= ~u32New;
+			break;
+	}
+	pNvic->ISER[u32Index] = s_au32NvicEnabled[u32Index];	/* Both read the enable state */
+	pNvic->ICER[u32Index] = s_au32NvicEnabled[u32Index];
+	pNvic->ISPR[u32Index] = s_au32NvicPending[u32Index];
+	pNvic->ICPR[u32Index] = s_au32NvicPending[u32Index];
+}
+
+/**
+* @brief            LPIT access, before the instruction: current value of channel 0.
+* @param[in]        pRegion - LPIT0 registers.
+* @param[in]        u32Off - Word offset.
+* @return           void.
+*/
+static void sim_lpit_pre(sim_region_t *pRegion, uint32_t u32Off)
+{
+	if ((SIM_LPIT_CVAL0_OFF == u32Off) && (0U != s_u64LpitDue))
+	{
+		SIM_WORD(pRegion, u32Off) = (uint32_t)((s_u64LpitDue - s_u64Now) / 2U);	/* 40 MHz LPIT clock */
+	}
+}
+
+/**
+* @brief            LPIT write: MSR write 1 to clear, TCTRL[T_EN] starts and stops channel 0.
+* @param[in]        pRegion - LPIT0 registers.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_lpit_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+
+	if (SIM_LPIT_MSR_OFF == u32Off)
+	{
+		SIM_WORD(pRegion, u32Off) = u32Old & ~u32New;
+	}
+	else if (SIM_LPIT_TCTRL0_OFF == u32Off)
+	{
+		if (0U == (u32New & LPIT_TMR_TCTRL_T_EN_MASK))
+		{
+			s_u64LpitDue = 0U;
+		}
+		else if (0U == (u32Old & LPIT_TMR_TCTRL_T_EN_MASK))
+		{
+			s_u64LpitDue = s_u64Now + 2U*((uint64_t)SIM_LPIT()->TMR[0].TVAL + 1U);
+		}
+		else
+		{
+		}
+	}
+	else
+	{
+	}
+}
+
+/**
+* @brief            eDMA write: CERQ/SERQ set and clear ERQ, CDNE clears DONE, CINT and INT clear INT.
+* @details          CEEI, SEEI, SSRT and CERR are ignored, the other registers and the TCDs are plain.
+* @param[in]        pRegion - eDMA registers.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_dma_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	DMA_Type *pDma = SIM_DMA();
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+	uint32_t u32Byte = 0U;
+	uint32_t u32Value = 0U;
+	uint32_t u32Mask = 0U;
+	uint32_t u32Ch = 0U;
+
+	if (SIM_DMA_INT_OFF == u32Off)
+	{
+		SIM_WORD(pRegion, u32Off) = u32Old & ~u32New;	/* Write 1 to clear */
+		return;
+	}
+	if ((SIM_DMA_CEEI_OFF != u32Off) && (SIM_DMA_CDNE_OFF != u32Off))
+	{
+		return;
+	}
+
+	SIM_WORD(pRegion, u32Off) = SIM_DMA_BYTES_NOP;
+	for (u32Byte = 0U; u32Byte < 4U; u32Byte++)
+	{
+		u32Value = (u32New >> (8U*u32Byte)) & 0xFFU;
+		if (0U != (u32Value & SIM_DMA_NOP))
+		{
+			continue;								/* Not written, or NOP */
+		}
+		u32Mask = (0U != (u32Value & SIM_DMA_ALL)) ? 0xFFFFU : (1UL << (u32Value & 0xFU));
+		switch (u32Off + u32Byte)
+		{
+			case (uint32_t)offsetof(DMA_Type, CERQ):
+				pDma->ERQ &= ~u32Mask;
+				break;
+			case (uint32_t)offsetof(DMA_Type, SERQ):
+				pDma->ERQ |= u32Mask;
+				break;
+			case (uint32_t)offsetof(DMA_Type, CDNE):
+				for (u32Ch = 0U; u32Ch < 16U; u32Ch++)
+				{
+					if (0U != (u32Mask & (1UL << u32Ch)))
+					{
+						pDma->TCD[u32Ch].CSR &= (uint16_t)~DMA_TCD_CSR_DONE_MASK;
+					}
+				}
+				break;
+			case (uint32_t)offsetof(DMA_Type, CINT):
+				pDma->INT &= ~u32Mask;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/**
+* @brief            eDMA bus address.
+* @param[in]        u32Addr - Address in a TCD.
+* @return           Model view of a register block, else the host address itself.
+*/
+static volatile uint8_t *sim_dma_addr(uint32_t u32Addr)
+{
+	sim_region_t *pRegion = sim_region_find(u32Addr);
+
+	if (NULL != pRegion)
+	{
+		return &pRegion->pu8Model[u32Addr - pRegion->uBase];
+	}
+	return (volatile uint8_t *)(uintptr_t)u32Addr;
+}
+
+/**
+* @brief            eDMA address after a transfer.
+* @param[in]        u32Addr - Address.
+* @param[in]        s16Offset - SOFF or DOFF.
+* @param[in]        u32Mod - SMOD or DMOD: only the low u32Mod bits change, 0: no modulo.
+* @return           Next address.
+*/
+static uint32_t sim_dma_next(uint32_t u32Addr, int16_t s16Offset, uint32_t u32Mod)
+{
+	uint32_t u32Next = u32Addr + (uint32_t)(int32_t)s16Offset;
+	uint32_t u32Mask = (0U == u32Mod) ? 0xFFFFFFFFU : ((1UL << u32Mod) - 1UL);
+
+	return (u32Addr & ~u32Mask) | (u32Next & u32Mask);
+}
+
+/**
+* @brief            eDMA minor loop of a channel.
+* @details          NBYTES in SSIZE transfers, then CITER counts down: INTHALF at BITER/2, at 0 the
+*					major loop ends (SLAST, DLASTSGA, CITER reload, DONE, INTMAJOR, DREQ).
+* @param[in]        u32Ch - Channel.
+* @return           void.
+*/
+static void sim_dma_minor(uint32_t u32Ch)
+{
+	DMA_Type *pDma = SIM_DMA();
+	uint32_t u32Attr = pDma->TCD[u32Ch].ATTR;
+	uint32_t u32Size = 1UL << ((u32Attr >> 8U) & 0x7U);
+	uint32_t u32Biter = pDma->TCD[u32Ch].BITER.ELINKNO;
+	uint32_t u32Citer = pDma->TCD[u32Ch].CITER.ELINKNO;
+	uint32_t u32Bytes = pDma->TCD[u32Ch].NBYTES.MLNO;
+	uint32_t u32Done = 0U;
+	uint32_t u32Word = 0U;
+
+	if ((u32Size != (1UL << (u32Attr & 0x7U))) || (u32Size > 4U) || (0U == u32Bytes) || (0U != (u32Bytes % u32Size))
+		|| (0U == (u32Biter & DMA_TCD_BITER_ELINKNO_BITER_MASK)) || (0U == (u32Citer & DMA_TCD_CITER_ELINKNO_CITER_MASK))
+		|| (0U != ((u32Biter | u32Citer) & SIM_DMA_ITER_ELINK))
+		|| (0U != (pDma->TCD[u32Ch].CSR & (SIM_DMA_CSR_ESG | SIM_DMA_CSR_MAJORELINK))))
+	{
+		sim_fatal("eDMA channel %u: TCD setup not modelled (ATTR 0x%04X, NBYTES %u, CITER %u, BITER %u, CSR 0x%04X)",
+				  u32Ch, u32Attr, u32Bytes, u32Citer, u32Biter, (uint32_t)pDma->TCD[u32Ch].CSR);
+	}
+
+	for (u32Done = 0U; u32Done < u32Bytes; u32Done += u32Size)
+	{
+		(void)memcpy(&u32Word, (const void *)(uintptr_t)sim_dma_addr(pDma->TCD[u32Ch].SADDR), u32Size);
+		(void)memcpy((void *)(uintptr_t)sim_dma_addr(pDma->TCD[u32Ch].DADDR), &u32Word, u32Size);
+		pDma->TCD[u32Ch].SADDR = sim_dma_next(pDma->TCD[u32Ch].SADDR, (int16_t)pDma->TCD[u32Ch].SOFF, (u32Attr >> 11U) & 0x1FU);
+		pDma->TCD[u32Ch].DADDR = sim_dma_next(pDma->TCD[u32Ch].DADDR, (int16_t)pDma->TCD[u32Ch].DOFF, (u32Attr >> 3U) & 0x1FU);
+	}
+	s_Stats.u32DmaMinorLoops++;
+
+	u32Citer--;
+	if (0U != u32Citer)
+	{
+		pDma->TCD[u32Ch].CITER.ELINKNO = (uint16_t)u32Citer;
+		if ((0U != (pDma->TCD[u32Ch].CSR & DMA_TCD_CSR_INTHALF_MASK)) && (u32Citer == (u32Biter / 2U)))
+		{
+			pDma->INT |= 1UL << u32Ch;
+		}
+		return;
+	}
+	pDma->TCD[u32Ch].SADDR += pDma->TCD[u32Ch].SLAST;
+	pDma->TCD[u32Ch].DADDR += pDma->TCD[u32Ch].DLASTSGA;
+	pDma->TCD[u32Ch].CITER.ELINKNO = (uint16_t)u32Biter;
+	pDma->TCD[u32Ch].CSR |= DMA_TCD_CSR_DONE_MASK;
+	if (0U != (pDma->TCD[u32Ch].CSR & DMA_TCD_CSR_INTMAJOR_MASK))
+	{
+		pDma->INT |= 1UL << u32Ch;
+	}
+	if (0U != (pDma->TCD[u32Ch].CSR & DMA_TCD_CSR_DREQ_MASK))
+	{
+		pDma->ERQ &= ~(1UL << u32Ch);				/* DREQ: requests off after the major loop */
+	}
+}
+
+/**
+* @brief            eDMA requests.
+* @details          A channel with ERQ set, routed by the DMAMUX (clock on) to a FlexCAN with the RX FIFO in
+*					DMA mode (MCR[RFEN]=1, MCR[DMA]=1) runs one minor loop per FIFO frame. The FIFO moves
+*					on after each minor loop. Other request sources are not modelled.
+* @param        	void.
+* @return           void.
+*/
+static void sim_dma_service(void)
+{
+	DMA_Type *pDma = SIM_DMA();
+	CAN_Type *pRegs = NULL;
+	uint32_t u32Ch = 0U;
+	uint32_t u32Source = 0U;
+	uint8_t u8Inst = 0U;
+
+	if (0U == (SIM_PCC()->PCCn[PCC_DMAMUX_INDEX] & PCC_PCCn_CGC_MASK))
+	{
+		return;
+	}
+	for (u32Ch = 0U; u32Ch < 16U; u32Ch++)
+	{
+		u32Source = SIM_DMAMUX()->CHCFG[u32Ch];
+		if ((0U == (u32Source & DMAMUX_CHCFG_ENBL_MASK)) || ((u32Source & 0x3FU) < SIM_DMA_REQ_CAN0)
+			|| ((u32Source & 0x3FU) >= (SIM_DMA_REQ_CAN0 + 3U)))
+		{
+			continue;
+		}
+		u8Inst = (uint8_t)((u32Source & 0x3FU) - SIM_DMA_REQ_CAN0);
+		pRegs = SIM_REGS(u8Inst);
+		while ((0U != (pDma->ERQ & (1UL << u32Ch))) && (0U != s_aInst[u8Inst].u8FifoCount)
+			   && ((CAN_MCR_RFEN_MASK | CAN_MCR_DMA_MASK) == (pRegs->MCR & (CAN_MCR_RFEN_MASK | CAN_MCR_DMA_MASK))))
+		{
+			sim_dma_minor(u32Ch);
+			pRegs->IFLAG1 &= ~SIM_BUF5I;			/* Output read by the DMA */
+			sim_fifo_pop(u8Inst);
+		}
+	}
+}
+
+/**
+* @brief            FTFC and LMEM write.
+* @details          FSTAT: RDCOLERR, ACCERR and FPVIOL are write 1 to clear, CCIF=1 launches the command in
+*					FCCOB. LMEM PCCCR: GO completes at once. The other fields are plain.
+* @param[in]        pRegion - FTFC or LMEM.
+* @param[in]        u32Off - Word offset.
+* @param[in]        u32Old - Word before the write.
+* @return           void.
+*/
+static void sim_flash_write(sim_region_t *pRegion, uint32_t u32Off, uint32_t u32Old)
+{
+	uint32_t u32New = SIM_WORD(pRegion, u32Off);
+	uint8_t u8Fstat = 0U;
+
+	if (LMEM_BASE == pRegion->uBase)
+	{
+		SIM_LMEM()->PCCCR &= ~(LMEM_PCCCR_GO_MASK | LMEM_PCCCR_INVW0_MASK | LMEM_PCCCR_INVW1_MASK);
+		return;
+	}
+	if (0U != u32Off)
+	{
+		return;										/* FCCOB, FPROT */
+	}
+
+	u8Fstat = (uint8_t)(u32Old & ~(u32New & SIM_FTFC_W1C));
+	if ((0U != (u32New & FTFC_FSTAT_CCIF_MASK)) && (0U != (u32Old & FTFC_FSTAT_CCIF_MASK)))
+	{
+		u8Fstat = sim_flash_start(u8Fstat);
+	}
+	SIM_WORD(pRegion, u32Off) = (u32Old & 0xFFFFFF00U) | u8Fstat;	/* FCNFG, FSEC, FOPT: not written */
+}
+
+/**
+* @brief            FTFC command launch.
+* @details          A command is not started while ACCERR or FPVIOL is set. ERSSCR and PGM8 only; an
+*					unaligned address or one past P-Flash gives ACCERR, one below SIM_CAN_FLASH_START
+*					FPVIOL.
+* @param[in]        u8Fstat - FSTAT after the write 1 to clear.
+* @return           New FSTAT: CCIF=0 while the command runs, or the error.
+*/
+static uint8_t sim_flash_start(uint8_t u8Fstat)
+{
+	FTFC_Type *pFtfc = SIM_FTFC();
+	uint32_t u32Addr = ((uint32_t)pFtfc->FCCOB[2] << 16U) | ((uint32_t)pFtfc->FCCOB[1] << 8U) | pFtfc->FCCOB[0];
+	uint32_t u32Align = SIM_FTFC_SECTOR;
+	uint32_t u32Us = SIM_CAN_FLASH_ERASE_US;
+
+	if (0U != (u8Fstat & (FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK)))
+	{
+		return u8Fstat;
+	}
+	if (SIM_FTFC_PGM8 == pFtfc->FCCOB[3])
+	{
+		u32Align = SIM_FTFC_PHRASE;
+		u32Us = SIM_CAN_FLASH_PGM8_US;
+		(void)memcpy(s_au8FlashData, (const void *)&pFtfc->FCCOB[4], SIM_FTFC_PHRASE);	/* FCCOB7..4, FCCOBB..8 */
+	}
+	else if (SIM_FTFC_ERSSCR != pFtfc->FCCOB[3])
+	{
+		sim_fatal("FTFC command 0x%02X not modelled", (uint32_t)pFtfc->FCCOB[3]);
+	}
+	else
+	{
+	}
+
+	if ((0U != (u32Addr & (u32Align - 1U))) || (u32Addr >= SIM_CAN_FLASH_END))
+	{
+		return u8Fstat | FTFC_FSTAT_ACCERR_MASK;
+	}
+	if (u32Addr < SIM_CAN_FLASH_START)
+	{
+		return u8Fstat | FTFC_FSTAT_FPVIOL_MASK;
+	}
+
+	s_u8FlashCmd = pFtfc->FCCOB[3];
+	s_u32FlashAddr = u32Addr;
+	s_u64FlashDue = s_u64Now + SIM_CAN_US(u32Us);
+	return u8Fstat & (uint8_t)~FTFC_FSTAT_CCIF_MASK;
+}
+
+/**
+* @brief            FTFC command end: erase to 0xFF, or program (a bit can only go from 1 to 0), CCIF=1.
+* @param        	void.
+* @return           void.
+*/
+static void sim_flash_done(void)
+{
+	volatile uint8_t *pu8Flash = SIM_PFLASH(s_u32FlashAddr);
+	uint32_t u32Index = 0U;
+
+	if (SIM_FTFC_ERSSCR == s_u8FlashCmd)
+	{
+		(void)memset((void *)pu8Flash, 0xFF, SIM_FTFC_SECTOR);
+		s_Stats.u32FlashErases++;
+	}
+	else
+	{
+		for (u32Index = 0U; u32Index < SIM_FTFC_PHRASE; u32Index++)
+		{
+			if (0xFFU != pu8Flash[u32Index])
+			{
+				s_Stats.u32FlashOverwrites++;
+				break;
+			}
+		}
+		for (u32Index = 0U; u32Index < SIM_FTFC_PHRASE; u32Index++)
+		{
+			pu8Flash[u32Index] &= s_au8FlashData[u32Index];
+		}
+		s_Stats.u32FlashPrograms++;
+	}
+	s_u64FlashDue = 0U;
+	SIM_FTFC()->FSTAT |= FTFC_FSTAT_CCIF_MASK;
+}
+
+/**
+* @brief            Data bytes of a frame as big-endian MB words.
+* @param[in]        pFrame - Frame.
+* @param[out]       pu32Words - Words.
+* @param[in]        u32Count - Number of words.
+* @return           void.
+*/
+static void sim_frame_words(const sim_can_frame_t *pFrame, uint32_t *pu32Words, uint32_t u32Count)
+{
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		pu32Words[u32Index] = ((uint32_t)pFrame->au8Data[4U*u32Index] << 24U) | ((uint32_t)pFrame->au8Data[4U*u32Index + 1U] << 16U)
+							| ((uint32_t)pFrame->au8Data[4U*u32Index + 2U] << 8U) | pFrame->au8Data[4U*u32Index + 3U];
+	}
+}
+
+/**
+* @brief            RX FIFO filter table match.
+* @details          Format A, B or C (MCR[IDAM]). Elements 0 to 8+2xRFFN-1 use RXIMR with IRMQ=1,
+*					the others RXFGMASK.
+* @param[in]        u8Inst - Instance.
+* @param[in]        pFrame - Frame.
+* @return           Matching element (IDHIT), -1 if none.
+*/
+static int32_t sim_fifo_match(uint8_t u8Inst, const sim_can_frame_t *pFrame)
+{
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Rffn = (pRegs->CTRL2 & CAN_CTRL2_RFFN_MASK) >> CAN_CTRL2_RFFN_SHIFT;
+	uint32_t u32Elements = 8U*(u32Rffn + 1U);
+	uint32_t u32Individual = 8U + 2U*u32Rffn;
+	uint32_t u32Format = (pRegs->MCR & CAN_MCR_IDAM_MASK) >> CAN_MCR_IDAM_SHIFT;
+	uint32_t u32Ext = (0U != (pFrame->u32Id & SIM_CAN_EXT)) ? 1U : 0U;
+	uint32_t u32Rtr = (0U != (pFrame->u8Flags & SIM_CAN_RTR)) ? 1U : 0U;
+	uint32_t u32Id = pFrame->u32Id & 0x1FFFFFFFU;
+	uint32_t u32Value = 0U;
+	uint32_t u32Element = 0U;
+	uint32_t u32Mask = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Part = 0U;
+
+	if (0U == (pRegs->MCR & CAN_MCR_IRMQ_MASK))
+	{
+		u32Individual = 0U;
+	}
+	else if (u32Individual > ((0U == u8Inst) ? 32U : 16U))
+	{
+		u32Individual = (0U == u8Inst) ? 32U : 16U;
+	}
+	else
+	{
+	}
+
+	switch (u32Format)
+	{
+		case 0U:	/* A: RTR, IDE, standard ID 29:19 or extended ID 29:1 */
+			u32Value = (u32Rtr << 31U) | (u32Ext << 30U) | ((0U != u32Ext) ? (u32Id << 1U) : (u32Id << 19U));
+			break;
+		case 1U:	/* B: per half RTR, IDE, standard ID 13:3 or extended ID 28:15 in 13:0 */
+			u32Part = (u32Rtr << 15U) | (u32Ext << 14U) | ((0U != u32Ext) ? ((u32Id >> 15U) & 0x3FFFU) : (u32Id << 3U));
+			u32Value = (u32Part << 16U) | u32Part;
+			break;
+		case 2U:	/* C: per byte ID bits 10:3 or 28:21 */
+			u32Part = (0U != u32Ext) ? ((u32Id >> 21U) & 0xFFU) : ((u32Id >> 3U) & 0xFFU);
+			u32Value = u32Part * 0x01010101U;
+			break;
+		default:	/* D: reject all */
+			return -1;
+	}
+
+	for (u32Index = 0U; u32Index < u32Elements; u32Index++)
+	{
+		u32Element = pRegs->RAMn[24U + u32Index];
+		u32Mask = (u32Index < u32Individual) ? pRegs->RXIMR[u32Index] : pRegs->RXFGMASK;
+		if (0U == u32Format)
+		{
+			if (0U == ((u32Element ^ u32Value) & u32Mask))
+			{
+				return (int32_t)u32Index;
+			}
+		}
+		else if (1U == u32Format)
+		{
+			if ((0U == ((u32Element ^ u32Value) & u32Mask & 0xFFFF0000U)) || (0U == ((u32Element ^ u32Value) & u32Mask & 0x0000FFFFU)))
+			{
+				return (int32_t)u32Index;
+			}
+		}
+		else
+		{
+			for (u32Part = 0U; u32Part < 32U; u32Part += 8U)
+			{
+				if (0U == (((u32Element ^ u32Value) & u32Mask) & (0xFFU << u32Part)))
+				{
+					return (int32_t)u32Index;
+				}
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+* @brief            MB ID match.
+* @details          IDE is always compared (EACEN=0). Mask: RXIMR with IRMQ=1, else RXMGMASK, RX14MASK
+*					or RX15MASK.
+* @param[in]        u8Inst - Instance.
+* @param[in]        u32Mb - MB.
+* @param[in]        pFrame - Frame.
+* @return           1 on a match.
+*/
+static uint8_t sim_mb_match(uint8_t u8Inst, uint32_t u32Mb, const sim_can_frame_t *pFrame)
+{
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Base = u32Mb * sim_mb_words(u8Inst);
+	uint32_t u32Cs = pRegs->RAMn[u32Base];
+	uint32_t u32Mask = 0U;
+
+	if ((0U != (u32Cs & SIM_CS_IDE)) != (0U != (pFrame->u32Id & SIM_CAN_EXT)))
+	{
+		return 0U;
+	}
+	if (0U != (pRegs->MCR & CAN_MCR_IRMQ_MASK))
+	{
+		u32Mask = pRegs->RXIMR[u32Mb];
+	}
+	else
+	{
+		u32Mask = (14U == u32Mb) ? pRegs->RX14MASK : ((15U == u32Mb) ? pRegs->RX15MASK : pRegs->RXMGMASK);
+	}
+	return (0U == ((sim_id_word(pFrame->u32Id) ^ pRegs->RAMn[u32Base + 1U]) & u32Mask & 0x1FFFFFFFU)) ? 1U : 0U;
+}
+
+/**
+* @brief            Store a frame in a receive MB.
+* @details          First matching free MB (EMPTY, or FULL/OVERRUN already serviced by the CPU), else
+*					the last matching FULL one (OVERRUN). A frame for the locked MB waits until it is unlocked.
+* @param[in]        u8Inst - Instance.
+* @param[in]        pBf - Frame.
+* @param[in]        u16Stamp - TIME STAMP.
+* @return           void.
+*/
+static void sim_rx_mb(uint8_t u8Inst, const sim_bus_frame_t *pBf, uint16_t u16Stamp)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	const sim_can_frame_t *pFrame = &pBf->frame;
+	uint32_t u32Words = sim_mb_words(u8Inst);
+	uint32_t u32Count = sim_mb_count(u8Inst);
+	uint32_t au32Data[16];
+	uint32_t u32Code = 0U;
+	uint32_t u32Mb = 0U;
+	uint32_t u32Payload = 0U;
+	int32_t s32Empty = -1;
+	int32_t s32Full = -1;
+	uint8_t u8Locked = 0U;
+
+	for (u32Mb = sim_mb_first(u8Inst); u32Mb < u32Count; u32Mb++)
+	{
+		u32Code = SIM_CS_CODE(pRegs->RAMn[u32Mb * u32Words]);
+		if (((SIM_CODE_RX_EMPTY != u32Code) && (SIM_CODE_RX_FULL != u32Code) && (SIM_CODE_RX_OVERRUN != u32Code))
+			|| (0U == sim_mb_match(u8Inst, u32Mb, pFrame)))
+		{
+			continue;
+		}
+		if ((int16_t)u32Mb == pInst->s16Locked)
+		{
+			u8Locked = 1U;
+		}
+		else if ((SIM_CODE_RX_EMPTY == u32Code) || (0U != ((pInst->u32Serviced >> u32Mb) & 1U)))
+		{
+			s32Empty = (int32_t)u32Mb;
+			break;
+		}
+		else
+		{
+			s32Full = (int32_t)u32Mb;
+		}
+	}
+
+	if ((s32Empty < 0) && (0U != u8Locked))
+	{
+		if (0U != pInst->u8Held)
+		{
+			s_Stats.au32RxOverrun[u8Inst]++;		/* RX SMB overwritten */
+		}
+		pInst->held = *pBf;
+		pInst->u16HeldStamp = u16Stamp;
+		pInst->u8Held = 1U;
+		return;
+	}
+	if (s32Empty >= 0)
+	{
+		u32Mb = (uint32_t)s32Empty;
+		u32Code = SIM_CODE_RX_FULL;
+	}
+	else if (s32Full >= 0)
+	{
+		u32Mb = (uint32_t)s32Full;
+		u32Code = SIM_CODE_RX_OVERRUN;
+		s_Stats.au32RxOverrun[u8Inst]++;
+	}
+	else
+	{
+		return;										/* No matching MB: filtered out */
+	}
+
+	u32Payload = s_au8DlcLength[sim_dlc(pFrame)];
+	if (u32Payload > (4U*(u32Words - 2U)))
+	{
+		u32Payload = 4U*(u32Words - 2U);			/* Longer frame than the MB stores */
+	}
+	sim_frame_words(pFrame, au32Data, (u32Payload + 3U) / 4U);
+	(void)memcpy((void *)&pRegs->RAMn[u32Mb * u32Words + 2U], au32Data, 4U*((u32Payload + 3U) / 4U));
+	pRegs->RAMn[u32Mb * u32Words + 1U] = sim_id_word(pFrame->u32Id);
+	pRegs->RAMn[u32Mb * u32Words] = ((0U != (pFrame->u8Flags & SIM_CAN_FDF)) ? SIM_CS_EDL : 0U)
+								  | ((0U != (pFrame->u8Flags & SIM_CAN_BRS)) ? SIM_CS_BRS : 0U)
+								  | (u32Code << 24U)
+								  | ((0U != (pFrame->u32Id & SIM_CAN_EXT)) ? (SIM_CS_SRR | SIM_CS_IDE) : 0U)
+								  | ((0U != (pFrame->u8Flags & SIM_CAN_RTR)) ? SIM_CS_RTR : 0U)
+								  | ((uint32_t)sim_dlc(pFrame) << 16U) | u16Stamp;
+	pRegs->IFLAG1 |= 1UL << u32Mb;
+	pInst->u32Serviced &= ~(1UL << u32Mb);
+	s_Stats.au32RxFrames[u8Inst]++;
+}
+
+/**
+* @brief            Frame received by an instance.
+* @details          RX FIFO first (CTRL2[MRP]=0), then the MBs.
+* @param[in]        u8Inst - Instance.
+* @param[in]        pBf - Frame.
+* @return           void.
+*/
+static void sim_rx(uint8_t u8Inst, const sim_bus_frame_t *pBf)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	const sim_can_frame_t *pFrame = &pBf->frame;
+	sim_fifo_entry_t *pEntry = NULL;
+	uint16_t u16Stamp = sim_timer_at(u8Inst, pBf->u64Start + pBf->u32NominalTicks);	/* Start of the ID field */
+	int32_t s32Hit = -1;
+
+	if ((0U != (pFrame->u8Flags & SIM_CAN_FDF)) && (0U == (pRegs->MCR & CAN_MCR_FDEN_MASK)))
+	{
+		s_Stats.au32FdDropped[u8Inst]++;
+		return;
+	}
+	if ((sim_can_bit_ticks(u8Inst, 0U) != pBf->u32NominalTicks)
+		|| ((0U != (pFrame->u8Flags & SIM_CAN_BRS)) && (sim_can_bit_ticks(u8Inst, 1U) != pBf->u32DataTicks)))
+	{
+		s_Stats.au32RateMismatch[u8Inst]++;
+		return;
+	}
+
+	if (0U != (pRegs->MCR & CAN_MCR_RFEN_MASK))
+	{
+		s32Hit = sim_fifo_match(u8Inst, pFrame);
+	}
+	if (s32Hit < 0)
+	{
+		sim_rx_mb(u8Inst, pBf, u16Stamp);
+		return;
+	}
+
+	if (pInst->u8FifoCount >= 6U)
+	{
+		s_Stats.au32FifoOverflow[u8Inst]++;
+		pRegs->IFLAG1 |= SIM_BUF7I;
+		return;
+	}
+	pEntry = &pInst->aFifo[pInst->u8FifoCount];
+	pEntry->u16IdHit = (uint16_t)s32Hit;
+	pEntry->au32Word[0] = ((0U != (pFrame->u32Id & SIM_CAN_EXT)) ? (SIM_CS_SRR | SIM_CS_IDE) : 0U)
+						| ((0U != (pFrame->u8Flags & SIM_CAN_RTR)) ? SIM_CS_RTR : 0U)
+						| ((uint32_t)sim_dlc(pFrame) << 16U) | u16Stamp
+						| ((0U != (pRegs->MCR & CAN_MCR_DMA_MASK)) ? ((uint32_t)s32Hit << SIM_CS_IDHIT_SHIFT) : 0U);
+	pEntry->au32Word[1] = sim_id_word(pFrame->u32Id);
+	sim_frame_words(pFrame, &pEntry->au32Word[2], 2U);
+	pInst->u8FifoCount++;
+	s_Stats.au32RxFrames[u8Inst]++;
+	if (1U == pInst->u8FifoCount)
+	{
+		sim_fifo_load(u8Inst);
+	}
+	if (5U == pInst->u8FifoCount)
+	{
+		pRegs->IFLAG1 |= SIM_BUF6I;					/* Almost full */
+	}
+}
+
+/**
+* @brief            Instance takes part in bus traffic.
+* @param[in]        u8Inst - Instance.
+* @return           1 in normal mode and not bus off.
+*/
+static uint8_t sim_inst_online(uint8_t u8Inst)
+{
+	return ((SIM_STATE_RUNNING == s_aInst[u8Inst].u8State) && (0U == s_aInst[u8Inst].u8BusOff)) ? 1U : 0U;
+}
+
+/**
+* @brief            Bus of an instance.
+* @param[in]        u8Inst - Instance.
+* @return           Attached bus, or the internal bus of the instance in loopback.
+*/
+static uint8_t sim_inst_bus(uint8_t u8Inst)
+{
+	return (0U != (SIM_REGS(u8Inst)->CTRL1 & CAN_CTRL1_LPB_MASK)) ? (uint8_t)(SIM_CAN_BUS_COUNT + u8Inst) : s_aInst[u8Inst].u8Bus;
+}
+
+/**
+* @brief            Transmit MB that enters arbitration.
+* @details          CODE=0xC MBs: lowest arbitration key (LBUF=0) or lowest MB number (LBUF=1).
+* @param[in]        u8Inst - Instance.
+* @param[out]       pBf - Frame, source, MB and bit times.
+* @return           1 if the instance has a frame to send.
+*/
+static uint8_t sim_tx_candidate(uint8_t u8Inst, sim_bus_frame_t *pBf)
+{
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Words = sim_mb_words(u8Inst);
+	uint32_t u32Count = sim_mb_count(u8Inst);
+	uint32_t u32Mb = 0U;
+	uint32_t u32Cs = 0U;
+	uint32_t u32Key = 0U;
+	uint32_t u32BestKey = 0xFFFFFFFFU;
+	uint32_t au32Data[16];
+	int32_t s32Best = -1;
+	sim_can_frame_t frame;
+	uint32_t u32Payload = 0U;
+	uint32_t u32Index = 0U;
+
+	if ((0U == sim_inst_online(u8Inst)) || (0U != (pRegs->CTRL1 & CAN_CTRL1_LOM_MASK)))
+	{
+		return 0U;
+	}
+
+	for (u32Mb = sim_mb_first(u8Inst); u32Mb < u32Count; u32Mb++)
+	{
+		u32Cs = pRegs->RAMn[u32Mb * u32Words];
+		if (SIM_CODE_TX_DATA != SIM_CS_CODE(u32Cs))
+		{
+			continue;
+		}
+		(void)memset(&frame, 0, sizeof(frame));
+		u32Index = pRegs->RAMn[u32Mb * u32Words + 1U];
+		frame.u32Id = (0U != (u32Cs & SIM_CS_IDE)) ? ((u32Index & 0x1FFFFFFFU) | SIM_CAN_EXT) : ((u32Index >> 18U) & 0x7FFU);
+		frame.u8Flags = (0U != (u32Cs & SIM_CS_RTR)) ? SIM_CAN_RTR : 0U;
+		if ((0U != (u32Cs & SIM_CS_EDL)) && (0U != (pRegs->MCR & CAN_MCR_FDEN_MASK)))
+		{
+			frame.u8Flags = SIM_CAN_FDF;
+			if ((0U != (u32Cs & SIM_CS_BRS)) && (0U != (pRegs->FDCTRL & CAN_FDCTRL_FDRATE_MASK)))
+			{
+				frame.u8Flags |= SIM_CAN_BRS;
+			}
+			frame.u8Length = s_au8DlcLength[SIM_CS_DLC(u32Cs)];
+		}
+		else
+		{
+			frame.u8Length = (SIM_CS_DLC(u32Cs) > 8U) ? 8U : (uint8_t)SIM_CS_DLC(u32Cs);
+		}
+		u32Key = sim_key(&frame);
+		if ((s32Best < 0) || (u32Key < u32BestKey))
+		{
+			s32Best = (int32_t)u32Mb;
+			u32BestKey = u32Key;
+			pBf->frame = frame;
+			if (0U != (pRegs->CTRL1 & CAN_CTRL1_LBUF_MASK))
+			{
+				break;								/* Lowest MB first */
+			}
+		}
+	}
+	if (s32Best < 0)
+	{
+		return 0U;
+	}
+
+	u32Payload = pBf->frame.u8Length;
+	if (u32Payload > (4U*(u32Words - 2U)))
+	{
+		u32Payload = 4U*(u32Words - 2U);
+		pBf->frame.u8Length = (uint8_t)u32Payload;
+	}
+	(void)memcpy(au32Data, (const void *)&pRegs->RAMn[(uint32_t)s32Best * u32Words + 2U], 4U*((u32Payload + 3U) / 4U));
+	for (u32Index = 0U; u32Index < u32Payload; u32Index++)
+	{
+		pBf->frame.au8Data[u32Index] = (uint8_t)(au32Data[u32Index / 4U] >> (24U - 8U*(u32Index % 4U)));
+	}
+	pBf->u8Src = u8Inst;
+	pBf->u8Mb = (uint8_t)s32Best;
+	pBf->u32NominalTicks = sim_can_bit_ticks(u8Inst, 0U);
+	pBf->u32DataTicks = sim_can_bit_ticks(u8Inst, 1U);
+	return 1U;
+}
+
+/**
+* @brief            Schedule the next frame of a generator.
+* @param[in]        pGen - Generator.
+* @param[in]        u64From - End of its last frame (load) or its last due time (periodic).
+* @param[in]        u64FrameTicks - Length of its last frame.
+* @return           void.
+*/
+static void sim_gen_schedule(sim_gen_t *pGen, uint64_t u64From, uint64_t u64FrameTicks)
+{
+	uint64_t u64Gap = 0U;
+
+	if (0U == pGen->u8LoadPct)
+	{
+		pGen->u64Due = u64From + pGen->u64Period;
+		return;
+	}
+	u64Gap = u64FrameTicks * (100U - pGen->u8LoadPct) / pGen->u8LoadPct;		/* Mean gap for the load */
+	pGen->u64Due = u64From + u64Gap / 2U + (u64Gap * (sim_random() % 1024U)) / 1023U;	/* 0.5 to 1.5 x mean */
+	pGen->u32NextId = pGen->tmpl.u32Id + sim_random() % ((pGen->u32IdHigh & 0x1FFFFFFFU) - (pGen->tmpl.u32Id & 0x1FFFFFFFU) + 1U);
+}
+
+/**
+* @brief            Next frame of a generator.
+* @param[in]        u8Gen - Generator.
+* @param[out]       pBf - Frame.
+* @return           void.
+*/
+static void sim_gen_frame(uint8_t u8Gen, sim_bus_frame_t *pBf)
+{
+	sim_gen_t *pGen = &s_aGen[u8Gen];
+	uint32_t u32Index = 0U;
+
+	pBf->frame = pGen->tmpl;
+	pBf->frame.u32Id = pGen->u32NextId;
+	for (u32Index = 0U; u32Index < 64U; u32Index++)
+	{
+		pBf->frame.au8Data[u32Index] = 0xA5U;
+	}
+	pBf->frame.au8Data[0] = (uint8_t)(pGen->u32Sent >> 24U);
+	pBf->frame.au8Data[1] = (uint8_t)(pGen->u32Sent >> 16U);
+	pBf->frame.au8Data[2] = (uint8_t)(pGen->u32Sent >> 8U);
+	pBf->frame.au8Data[3] = (uint8_t)pGen->u32Sent;
+	pBf->frame.au8Data[4] = u8Gen;
+	for (u32Index = pBf->frame.u8Length; u32Index < 64U; u32Index++)
+	{
+		pBf->frame.au8Data[u32Index] = 0U;
+	}
+	pBf->u8Src = (uint8_t)(SIM_CAN_SRC_GEN + u8Gen);
+	pBf->u32NominalTicks = s_aBus[pGen->u8Bus].u32NominalTicks;
+	pBf->u32DataTicks = s_aBus[pGen->u8Bus].u32DataTicks;
+}
+
+/**
+* @brief            Arbitration on an idle bus.
+* @details          Transmit MBs of the attached instances, due generator and injected frames: the
+*					lowest arbitration key starts now.
+* @param[in]        u8Bus - Bus.
+* @return           void.
+*/
+static void sim_bus_start(uint8_t u8Bus)
+{
+	sim_bus_t *pBus = &s_aBus[u8Bus];
+	sim_bus_frame_t candidate;
+	uint32_t u32Key = 0U;
+	uint32_t u32BestKey = 0xFFFFFFFFU;
+	uint32_t u32Bits = 0U;
+	uint32_t u32DataBits = 0U;
+	uint8_t u8Found = 0U;
+	uint8_t u8Index = 0U;
+
+	for (u8Index = 0U; u8Index < 3U; u8Index++)
+	{
+		if ((sim_inst_bus(u8Index) == u8Bus) && (0U != sim_tx_candidate(u8Index, &candidate)))
+		{
+			u32Key = sim_key(&candidate.frame);
+			if ((0U == u8Found) || (u32Key < u32BestKey))
+			{
+				pBus->cur = candidate;
+				u32BestKey = u32Key;
+				u8Found = 1U;
+			}
+		}
+	}
+	for (u8Index = 0U; u8Index < SIM_CAN_GEN_COUNT; u8Index++)
+	{
+		if ((0U != s_aGen[u8Index].u8Used) && (s_aGen[u8Index].u8Bus == u8Bus) && (s_aGen[u8Index].u64Due <= s_u64Now))
+		{
+			sim_gen_frame(u8Index, &candidate);
+			u32Key = sim_key(&candidate.frame);
+			if ((0U == u8Found) || (u32Key < u32BestKey))
+			{
+				pBus->cur = candidate;
+				u32BestKey = u32Key;
+				u8Found = 1U;
+			}
+		}
+	}
+	if ((0U != pBus->u8InjectCount) && (pBus->aInject[0].u64Start <= s_u64Now))
+	{
+		u32Key = sim_key(&pBus->aInject[0].frame);
+		if ((0U == u8Found) || (u32Key < u32BestKey))
+		{
+			pBus->cur = pBus->aInject[0];
+			u8Found = 1U;
+		}
+	}
+	if (0U == u8Found)
+	{
+		return;
+	}
+
+	if (SIM_CAN_SRC_INJECT == pBus->cur.u8Src)
+	{
+		pBus->u8InjectCount--;
+		(void)memmove(&pBus->aInject[0], &pBus->aInject[1], pBus->u8InjectCount * sizeof(pBus->aInject[0]));
+	}
+	u32Bits = sim_can_frame_bits(&pBus->cur.frame, &u32DataBits);
+	pBus->cur.u64Start = s_u64Now;
+	pBus->cur.u64End = s_u64Now + (uint64_t)(u32Bits - u32DataBits) * pBus->cur.u32NominalTicks
+					 + (uint64_t)u32DataBits * pBus->cur.u32DataTicks;
+	pBus->u8Active = 1U;
+}
+
+/**
+* @brief            End of frame.
+* @details          Completes the transmit MB, delivers the frame to every instance on the bus (to the
+*					transmitter with SRXDIS=0), reschedules a generator. A frame without error moves the
+*					error counters down: TEC of the transmitter by 1, REC of a receiver by 1, or back to
+*					127 from above.
+* @param[in]        u8Bus - Bus.
+* @return           void.
+*/
+static void sim_bus_end(uint8_t u8Bus)
+{
+	sim_bus_t *pBus = &s_aBus[u8Bus];
+	sim_bus_frame_t *pBf = &pBus->cur;
+	sim_gen_t *pGen = NULL;
+	sim_inst_t *pInst = NULL;
+	CAN_Type *pRegs = NULL;
+	uint32_t u32Cs = 0U;
+	uint32_t u32Base = 0U;
+	uint8_t u8Index = 0U;
+
+	pBus->u8Active = 0U;
+	if (u8Bus < SIM_CAN_BUS_COUNT)
+	{
+		s_Stats.au64BusyTicks[u8Bus] += pBf->u64End - pBf->u64Start;
+		s_Stats.au32Frames[u8Bus]++;
+	}
+
+	if (pBf->u8Src < 3U)
+	{
+		pRegs = SIM_REGS(pBf->u8Src);
+		u32Base = (uint32_t)pBf->u8Mb * sim_mb_words(pBf->u8Src);
+		u32Cs = pRegs->RAMn[u32Base];
+		if (SIM_CODE_TX_DATA == SIM_CS_CODE(u32Cs))		/* Not aborted or rewritten meanwhile */
+		{
+			pRegs->RAMn[u32Base] = (u32Cs & ~0x0F00FFFFU)
+								 | (((0U != (u32Cs & SIM_CS_RTR)) ? SIM_CODE_RX_EMPTY : SIM_CODE_TX_INACTIVE) << 24U)
+								 | sim_timer_at(pBf->u8Src, pBf->u64Start + pBf->u32NominalTicks);
+			pRegs->IFLAG1 |= 1UL << pBf->u8Mb;
+		}
+		pInst = &s_aInst[pBf->u8Src];
+		if (0U != pInst->u16Tec)
+		{
+			pInst->u16Tec--;
+			sim_err_update(pBf->u8Src, pInst->u16Tec + 1U, pInst->u16Rec);
+		}
+	}
+
+	for (u8Index = 0U; u8Index < 3U; u8Index++)
+	{
+		if ((sim_inst_bus(u8Index) != u8Bus) || (0U == sim_inst_online(u8Index))
+			|| (s_aInst[u8Index].u64TimerT0 > pBf->u64Start))
+		{
+			continue;								/* Not on this bus, or joined during the frame */
+		}
+		pInst = &s_aInst[u8Index];
+		if ((u8Index != pBf->u8Src) && (0U != pInst->u16Rec))
+		{
+			pInst->u16Rec = (pInst->u16Rec > 127U) ? 127U : (pInst->u16Rec - 1U);
+			sim_err_update(u8Index, pInst->u16Tec, pInst->u16Rec);
+		}
+		if ((u8Index == pBf->u8Src) && (0U != (SIM_REGS(u8Index)->MCR & CAN_MCR_SRXDIS_MASK)))
+		{
+			continue;								/* Self reception disabled */
+		}
+		sim_rx(u8Index, pBf);
+	}
+
+	if ((pBf->u8Src >= SIM_CAN_SRC_GEN) && (pBf->u8Src < (SIM_CAN_SRC_GEN + SIM_CAN_GEN_COUNT)))
+	{
+		pGen = &s_aGen[pBf->u8Src - SIM_CAN_SRC_GEN];
+		pGen->u32Sent++;
+		if ((0U != pGen->u32Count) && (pGen->u32Sent >= pGen->u32Count))
+		{
+			pGen->u8Used = 0U;
+		}
+		else
+		{
+			sim_gen_schedule(pGen, (0U == pGen->u8LoadPct) ? pGen->u64Due : pBf->u64End, pBf->u64End - pBf->u64Start);
+		}
+	}
+
+	if ((NULL != s_pfMonitor) && (u8Bus < SIM_CAN_BUS_COUNT))
+	{
+		s_pfMonitor(u8Bus, pBf->u8Src, &pBf->frame, pBf->u64Start, pBf->u64End);
+	}
+}
+
+/**
+* @brief            Fault confinement after an error counter change.
+* @details          TX/RX warning at 96 (TWRNINT/RWRNINT with WRNEN=1), error passive at 128, bus off
+*					above 255. Bus off recovery: 128 x 11 recessive bits, with BOFFREC=1 only after
+*					software clears it.
+* @param[in]        u8Inst - Instance.
+* @param[in]        u16OldTec - TEC before the change.
+* @param[in]        u16OldRec - REC before the change.
+* @return           void.
+*/
+static void sim_err_update(uint8_t u8Inst, uint16_t u16OldTec, uint16_t u16OldRec)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Esr1 = pRegs->ESR1 & ~(CAN_ESR1_FLTCONF_MASK | CAN_ESR1_TXWRN_MASK | CAN_ESR1_RXWRN_MASK);
+	uint32_t u32FltConf = 0U;
+
+	if (pInst->u16Tec >= 96U)
+	{
+		u32Esr1 |= CAN_ESR1_TXWRN_MASK;
+	}
+	if (pInst->u16Rec >= 96U)
+	{
+		u32Esr1 |= CAN_ESR1_RXWRN_MASK;
+	}
+	if (0U != (pRegs->MCR & CAN_MCR_WRNEN_MASK))
+	{
+		if ((u16OldTec < 96U) && (pInst->u16Tec >= 96U))
+		{
+			u32Esr1 |= CAN_ESR1_TWRNINT_MASK;
+		}
+		if ((u16OldRec < 96U) && (pInst->u16Rec >= 96U))
+		{
+			u32Esr1 |= CAN_ESR1_RWRNINT_MASK;
+		}
+	}
+	if ((pInst->u16Tec > 255U) && (0U == pInst->u8BusOff))
+	{
+		pInst->u8BusOff = 1U;
+		u32Esr1 |= CAN_ESR1_BOFFINT_MASK;
+		pInst->u64RecoverAt = (0U != (pRegs->CTRL1 & CAN_CTRL1_BOFFREC_MASK))
+							? 0U : (s_u64Now + 128U*11U*(uint64_t)sim_can_bit_ticks(u8Inst, 0U));
+	}
+
+	if (0U != pInst->u8BusOff)
+	{
+		u32FltConf = 2U;
+	}
+	else if ((pInst->u16Tec >= 128U) || (pInst->u16Rec >= 128U))
+	{
+		u32FltConf = 1U;
+	}
+	else
+	{
+	}
+	pRegs->ESR1 = u32Esr1 | (u32FltConf << CAN_ESR1_FLTCONF_SHIFT);
+	pRegs->ECR = ((uint32_t)pInst->u16Rec << CAN_ECR_RXERRCNT_SHIFT) | ((pInst->u16Tec > 255U) ? 255U : pInst->u16Tec);
+}
+
+/**
+* @brief            Interrupt source state.
+* @param[in]        u32Irq - Interrupt number.
+* @return           1 if the source requests the interrupt.
+*/
+static uint8_t sim_irq_active(uint32_t u32Irq)
+{
+	CAN_Type *pRegs = NULL;
+	uint32_t u32Esr1 = 0U;
+	uint32_t u32Enabled = 0U;
+
+	if (u32Irq < 16U)								/* eDMA channel */
+	{
+		return (0U != (SIM_DMA()->INT & (1UL << u32Irq))) ? 1U : 0U;
+	}
+	if (SIM_CAN_IRQ_LPIT0_CH0 == u32Irq)
+	{
+		return ((0U != (SIM_LPIT()->MSR & LPIT_MSR_TIF0_MASK)) && (0U != (SIM_LPIT()->MIER & LPIT_MIER_TIE0_MASK))) ? 1U : 0U;
+	}
+	if ((u32Irq < 78U) || (u32Irq >= (78U + 3U*7U)))
+	{
+		return 0U;
+	}
+
+	pRegs = SIM_REGS((u32Irq - 78U) / 7U);
+	u32Esr1 = pRegs->ESR1;
+	switch ((u32Irq - 78U) % 7U)
+	{
+		case 0U:									/* ORed */
+			u32Enabled = ((0U != (pRegs->CTRL1 & CAN_CTRL1_BOFFMSK_MASK)) ? CAN_ESR1_BOFFINT_MASK : 0U)
+					   | ((0U != (pRegs->CTRL1 & CAN_CTRL1_TWRNMSK_MASK)) ? CAN_ESR1_TWRNINT_MASK : 0U)
+					   | ((0U != (pRegs->CTRL1 & CAN_CTRL1_RWRNMSK_MASK)) ? CAN_ESR1_RWRNINT_MASK : 0U)
+					   | ((0U != (pRegs->CTRL2 & CAN_CTRL2_BOFFDONEMSK_MASK)) ? CAN_ESR1_BOFFDONEINT_MASK : 0U);
+			return (0U != (u32Esr1 & u32Enabled)) ? 1U : 0U;
+		case 1U:									/* Error */
+			return ((0U != (u32Esr1 & CAN_ESR1_ERRINT_MASK)) && (0U != (pRegs->CTRL1 & CAN_CTRL1_ERRMSK_MASK))) ? 1U : 0U;
+		case 3U:									/* MB 0-15 */
+			return (0U != (pRegs->IFLAG1 & pRegs->IMASK1 & 0x0000FFFFU)) ? 1U : 0U;
+		case 4U:									/* MB 16-31, CAN0 only */
+			return ((78U + 4U == u32Irq) && (0U != (pRegs->IFLAG1 & pRegs->IMASK1 & 0xFFFF0000U))) ? 1U : 0U;
+		default:
+			return 0U;
+	}
+}
+
+/**
+* @brief            Take the pending interrupts, lowest IP value first.
+* @param        	void.
+* @return           void.
+*/
+static void sim_irq_dispatch(void)
+{
+	S32_NVIC_Type *pNvic = SIM_NVIC();
+	uint32_t u32Irq = 0U;
+	int32_t s32Best = -1;
+	uint32_t u32BestPrio = 0U;
+	uint32_t u32Bit = 0U;
+
+	while (0U == s_u8IrqMask)
+	{
+		s32Best = -1;
+		for (u32Irq = 0U; u32Irq < SIM_IRQ_COUNT; u32Irq++)
+		{
+			u32Bit = 1UL << (u32Irq % 32U);
+			if ((NULL == s_apfIsr[u32Irq]) || (s_au8IrqCalls[u32Irq] > SIM_CAN_STORM_CALLS)
+				|| (0U == (s_au32NvicEnabled[u32Irq / 32U] & u32Bit))
+				|| ((0U == (s_au32NvicPending[u32Irq / 32U] & u32Bit)) && (0U == sim_irq_active(u32Irq))))
+			{
+				continue;
+			}
+			if ((s32Best < 0) || (pNvic->IP[u32Irq] < u32BestPrio))
+			{
+				s32Best = (int32_t)u32Irq;
+				u32BestPrio = pNvic->IP[u32Irq];
+			}
+		}
+		if (s32Best < 0)
+		{
+			return;
+		}
+
+		u32Irq = (uint32_t)s32Best;
+		s_au32NvicPending[u32Irq / 32U] &= ~(1UL << (u32Irq % 32U));
+		pNvic->ISPR[u32Irq / 32U] = s_au32NvicPending[u32Irq / 32U];
+		pNvic->ICPR[u32Irq / 32U] = s_au32NvicPending[u32Irq / 32U];
+		s_au8IrqCalls[u32Irq]++;
+		if (s_au8IrqCalls[u32Irq] > SIM_CAN_STORM_CALLS)
+		{
+			s_Stats.u32IrqStorms++;					/* Source never cleared: held off until time passes */
+			continue;
+		}
+		s_Stats.u32Irqs++;
+		s_apfIsr[u32Irq]();
+	}
+}
+
+/**
+* @brief            Complete requested mode changes, start manual bus off recovery.
+* @param        	void.
+* @return           void.
+*/
+static void sim_settle(void)
+{
+	sim_inst_t *pInst = NULL;
+	uint8_t u8Inst = 0U;
+
+	for (u8Inst = 0U; u8Inst < 3U; u8Inst++)
+	{
+		pInst = &s_aInst[u8Inst];
+		if (0U != pInst->u8Countdown)
+		{
+			sim_state_request(u8Inst);				/* Target may have changed since */
+			if (0U != pInst->u8Countdown)
+			{
+				sim_state_enter(u8Inst, (0U != (SIM_REGS(u8Inst)->MCR & CAN_MCR_MDIS_MASK)) ? SIM_STATE_DISABLED
+										: (((SIM_REGS(u8Inst)->MCR & (CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK))
+											== (CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK)) ? SIM_STATE_FROZEN : SIM_STATE_RUNNING));
+			}
+		}
+		if ((0U != pInst->u8BusOff) && (0U == pInst->u64RecoverAt)
+			&& (0U == (SIM_REGS(u8Inst)->CTRL1 & CAN_CTRL1_BOFFREC_MASK)))
+		{
+			pInst->u64RecoverAt = s_u64Now + 128U*11U*(uint64_t)sim_can_bit_ticks(u8Inst, 0U);
+		}
+	}
+}
+
+/**
+* @brief            Nothing on the buses and nothing waiting to be sent.
+* @param        	void.
+* @return           1 if idle.
+*/
+static uint8_t sim_idle(void)
+{
+	sim_bus_frame_t candidate;
+	uint8_t u8Index = 0U;
+
+	for (u8Index = 0U; u8Index < SIM_BUS_TOTAL; u8Index++)
+	{
+		if ((0U != s_aBus[u8Index].u8Active) || (0U != s_aBus[u8Index].u8InjectCount))
+		{
+			return 0U;
+		}
+	}
+	for (u8Index = 0U; u8Index < SIM_CAN_GEN_COUNT; u8Index++)
+	{
+		if (0U != s_aGen[u8Index].u8Used)
+		{
+			return 0U;
+		}
+	}
+	for (u8Index = 0U; u8Index < 3U; u8Index++)
+	{
+		if (0U != sim_tx_candidate(u8Index, &candidate))
+		{
+			return 0U;
+		}
+	}
+	return 1U;
+}
+
+/**
+* @brief            Event loop.
+* @param[in]        u64End - Model time to stop at.
+* @param[in]        u8StopIdle - Stop as soon as sim_idle().
+* @return           1 if stopped idle.
+*/
+static uint8_t sim_run(uint64_t u64End, uint8_t u8StopIdle)
+{
+	sim_inst_t *pInst = NULL;
+	uint64_t u64Next = 0U;
+	uint8_t u8Index = 0U;
+
+	for (;;)
+	{
+		sim_settle();
+		sim_dma_service();
+		sim_irq_dispatch();
+		for (u8Index = 0U; u8Index < SIM_BUS_TOTAL; u8Index++)
+		{
+			if (0U == s_aBus[u8Index].u8Active)
+			{
+				sim_bus_start(u8Index);
+			}
+		}
+		if ((0U != u8StopIdle) && (0U != sim_idle()))
+		{
+			return 1U;
+		}
+		if (s_u64Now >= u64End)
+		{
+			return 0U;
+		}
+
+		u64Next = u64End;							/* Next event */
+		for (u8Index = 0U; u8Index < SIM_BUS_TOTAL; u8Index++)
+		{
+			if ((0U != s_aBus[u8Index].u8Active) && (s_aBus[u8Index].cur.u64End < u64Next))
+			{
+				u64Next = s_aBus[u8Index].cur.u64End;
+			}
+			if ((0U != s_aBus[u8Index].u8InjectCount) && (s_aBus[u8Index].aInject[0].u64Start > s_u64Now)
+				&& (s_aBus[u8Index].aInject[0].u64Start < u64Next))
+			{
+				u64Next = s_aBus[u8Index].aInject[0].u64Start;
+			}
+		}
+		for (u8Index = 0U; u8Index < SIM_CAN_GEN_COUNT; u8Index++)
+		{
+			if ((0U != s_aGen[u8Index].u8Used) && (s_aGen[u8Index].u64Due > s_u64Now) && (s_aGen[u8Index].u64Due < u64Next))
+			{
+				u64Next = s_aGen[u8Index].u64Due;
+			}
+		}
+		if ((0U != s_u64LpitDue) && (s_u64LpitDue < u64Next))
+		{
+			u64Next = s_u64LpitDue;
+		}
+		if ((0U != s_u64FlashDue) && (s_u64FlashDue < u64Next))
+		{
+			u64Next = s_u64FlashDue;
+		}
+		for (u8Index = 0U; u8Index < 3U; u8Index++)
+		{
+			if ((0U != s_aInst[u8Index].u64RecoverAt) && (s_aInst[u8Index].u64RecoverAt < u64Next))
+			{
+				u64Next = s_aInst[u8Index].u64RecoverAt;
+			}
+		}
+
+		s_u64Now = (u64Next > s_u64Now) ? u64Next : (s_u64Now + 1U);
+		(void)memset(s_au8IrqCalls, 0, sizeof(s_au8IrqCalls));
+
+		for (u8Index = 0U; u8Index < SIM_BUS_TOTAL; u8Index++)
+		{
+			if ((0U != s_aBus[u8Index].u8Active) && (s_aBus[u8Index].cur.u64End <= s_u64Now))
+			{
+				sim_bus_end(u8Index);
+			}
+		}
+		if ((0U != s_u64LpitDue) && (s_u64LpitDue <= s_u64Now))
+		{
+			SIM_LPIT()->MSR |= LPIT_MSR_TIF0_MASK;
+			s_u64LpitDue += 2U*((uint64_t)SIM_LPIT()->TMR[0].TVAL + 1U);
+		}
+		if ((0U != s_u64FlashDue) && (s_u64FlashDue <= s_u64Now))
+		{
+			sim_flash_done();
+		}
+		for (u8Index = 0U; u8Index < 3U; u8Index++)
+		{
+			pInst = &s_aInst[u8Index];
+			if ((0U != pInst->u64RecoverAt) && (pInst->u64RecoverAt <= s_u64Now))
+			{
+				pInst->u64RecoverAt = 0U;
+				pInst->u8BusOff = 0U;
+				pInst->u16Tec = 0U;
+				pInst->u16Rec = 0U;
+				sim_err_update(u8Index, 0U, 0U);
+				SIM_REGS(u8Index)->ESR1 |= CAN_ESR1_BOFFDONEINT_MASK;
+			}
+		}
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Model reset.
+* @details          Maps the register blocks on the first call. Every call puts all registers to their
+*					reset values and clears time, buses, generators, handlers and counters.
+* @param        	void.
+* @return           void.
+*/
+void sim_can_init(void)
+{
+	uint32_t u32Index = 0U;
+	CAN_Type *pRegs = NULL;
+
+	if (NULL == s_aRegion[0].pu8Model)
+	{
+		sim_map();
+	}
+	for (u32Index = 0U; u32Index < SIM_REGION_COUNT; u32Index++)
+	{
+		(void)memset((void *)s_aRegion[u32Index].pu8Model, 0, s_aRegion[u32Index].u32Size);
+	}
+
+	for (u32Index = 0U; u32Index < 3U; u32Index++)
+	{
+		sim_can_trap((uint8_t)u32Index, 1U);					/* After a timing run with it off */
+	}
+
+	(void)memset(&s_Access, 0, sizeof(s_Access));
+	(void)memset(s_aInst, 0, sizeof(s_aInst));
+	(void)memset(s_aBus, 0, sizeof(s_aBus));
+	(void)memset(s_aGen, 0, sizeof(s_aGen));
+	(void)memset(&s_Stats, 0, sizeof(s_Stats));
+	(void)memset(s_apfIsr, 0, sizeof(s_apfIsr));
+	(void)memset(s_au32NvicEnabled, 0, sizeof(s_au32NvicEnabled));
+	(void)memset(s_au32NvicPending, 0, sizeof(s_au32NvicPending));
+	(void)memset(s_au8IrqCalls, 0, sizeof(s_au8IrqCalls));
+	SIM_WORD(&s_aRegion[6], SIM_DMA_CEEI_OFF) = SIM_DMA_BYTES_NOP;
+	SIM_WORD(&s_aRegion[6], SIM_DMA_CDNE_OFF) = SIM_DMA_BYTES_NOP;
+	(void)memset((void *)SIM_PFLASH(SIM_CAN_FLASH_START), 0xFF, SIM_CAN_FLASH_END - SIM_CAN_FLASH_START);	/* Erased */
+	SIM_FTFC()->FSTAT = FTFC_FSTAT_CCIF_MASK;
+	s_u8IrqMask = 0U;
+	s_u64FlashDue = 0U;
+	s_pfMonitor = NULL;
+	s_u64Now = 0U;
+	s_u64LpitDue = 0U;
+	s_u32Random = 0x2545F491U;
+
+	for (u32Index = 0U; u32Index < 3U; u32Index++)
+	{
+		pRegs = SIM_REGS(u32Index);
+		pRegs->MCR = 0xD890000FU;					/* MDIS, FRZ, HALT, NOTRDY, SUPV, LPMACK, MAXMB=15 */
+		pRegs->RXMGMASK = 0xFFFFFFFFU;
+		pRegs->RX14MASK = 0xFFFFFFFFU;
+		pRegs->RX15MASK = 0xFFFFFFFFU;
+		pRegs->RXFGMASK = 0xFFFFFFFFU;
+		pRegs->FDCTRL = 0x80000100U;
+		s_aInst[u32Index].u8State = SIM_STATE_DISABLED;
+		s_aInst[u32Index].u8Bus = (uint8_t)u32Index;
+		s_aInst[u32Index].s16Locked = -1;
+	}
+	for (u32Index = 0U; u32Index < SIM_BUS_TOTAL; u32Index++)
+	{
+		sim_can_bus_rate((uint8_t)u32Index, 500000U, 2000000U);
+	}
+}
+
+/**
+* @brief            Registers of an instance.
+* @details          Model view: reads and writes have no side effects (no locking, no write 1 to clear).
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @return           Registers.
+*/
+CAN_Type *sim_can_regs(uint8_t u8Inst)
+{
+	return SIM_REGS(u8Inst);
+}
+
+/**
+* @brief            Model poll.
+* @details          Called from the FlexCAN register poll loops: completes a pending freeze, disable or
+*					start-up transition of the instance.
+* @param[in]        pCan - FlexCAN instance.
+* @return           void.
+*/
+void sim_can_poll(volatile CAN_Type *pCan)
+{
+	sim_region_t *pRegion = sim_region_find((uintptr_t)pCan);
+	sim_inst_t *pInst = NULL;
+
+	if ((NULL == pRegion) || (SIM_REGION_CAN != pRegion->u8Kind))
+	{
+		sim_fatal("poll of %p, not a FlexCAN instance", (const void *)pCan);
+	}
+	pInst = &s_aInst[pRegion->u8Inst];
+	if (0U != pInst->u8Countdown)
+	{
+		pInst->u8Countdown--;
+		if (0U == pInst->u8Countdown)
+		{
+			pInst->u8Countdown = 1U;
+			sim_settle();
+		}
+	}
+	else if (++pInst->u32Polls > SIM_POLL_LIMIT)
+	{
+		sim_fatal("CAN%u poll loop does not end, MCR 0x%08X", pRegion->u8Inst, SIM_REGS(pRegion->u8Inst)->MCR);
+	}
+	else
+	{
+	}
+}
+
+/**
+* @brief            Flash command launch.
+* @details          FTFC_LAUNCH() of ftfc.c: starts the command loaded in FCCOB and runs the model until
+*					CCIF is set again.
+* @param[in]        pu8Fstat - FTFC->FSTAT.
+* @return           void.
+*/
+void sim_can_flash_launch(volatile uint8_t *pu8Fstat)
+{
+	*pu8Fstat = FTFC_FSTAT_CCIF_MASK;
+	while (0U == (SIM_FTFC()->FSTAT & FTFC_FSTAT_CCIF_MASK))
+	{
+		(void)sim_run(s_u64FlashDue, 0U);
+	}
+}
+
+/**
+* @brief            Interrupt mask.
+* @details          PRIMASK of the model: with u8Masked=1 no handler runs, pending sources are taken
+*					at the first sim_can_run() event after u8Masked=0.
+* @param[in]        u8Masked - 1: interrupts held off, 0: taken again.
+* @return           void.
+*/
+void sim_can_irq_mask(uint8_t u8Masked)
+{
+	s_u8IrqMask = u8Masked;
+}
+
+/**
+* @brief            Attach an instance to a bus.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8Bus - Bus (0 to SIM_CAN_BUS_COUNT-1).
+* @return           void.
+*/
+void sim_can_connect(uint8_t u8Inst, uint8_t u8Bus)
+{
+	s_aInst[u8Inst].u8Bus = u8Bus;
+}
+
+/**
+* @brief            Bus bit rates.
+* @details          Bit rates of the generated and injected frames (default 500 kbit/s, 2 Mbit/s).
+*					An instance whose bit timing differs does not receive them.
+* @param[in]        u8Bus - Bus.
+* @param[in]        u32Nominal - Nominal bit rate in bit/s, must divide SIM_CAN_TICK_HZ.
+* @param[in]        u32Data - FD data phase bit rate in bit/s, must divide SIM_CAN_TICK_HZ.
+* @return           void.
+*/
+void sim_can_bus_rate(uint8_t u8Bus, uint32_t u32Nominal, uint32_t u32Data)
+{
+	s_aBus[u8Bus].u32NominalTicks = SIM_CAN_TICK_HZ / u32Nominal;
+	s_aBus[u8Bus].u32DataTicks = SIM_CAN_TICK_HZ / u32Data;
+}
+
+/**
+* @brief            Periodic generator.
+* @details          Sends u32Count frames (0: no limit) with ID u32Id every u32PeriodUs, the first one
+*					u32PeriodUs from now. Data bytes 0-3: sequence number (big-endian), byte 4: generator,
+*					further bytes 0xA5.
+* @param[in]        u8Bus - Bus.
+* @param[in]        pTemplate - ID, length and flags of the frames.
+* @param[in]        u32PeriodUs - Period.
+* @param[in]        u32Count - Number of frames, 0: no limit.
+* @return           Generator index, 0xFF if none is free.
+*/
+uint8_t sim_can_gen_periodic(uint8_t u8Bus, const sim_can_frame_t *pTemplate, uint32_t u32PeriodUs, uint32_t u32Count)
+{
+	uint8_t u8Gen = 0U;
+
+	for (u8Gen = 0U; (u8Gen < SIM_CAN_GEN_COUNT) && (0U != s_aGen[u8Gen].u8Used); u8Gen++)
+	{
+	}
+	if (u8Gen >= SIM_CAN_GEN_COUNT)
+	{
+		return 0xFFU;
+	}
+	(void)memset(&s_aGen[u8Gen], 0, sizeof(s_aGen[u8Gen]));
+	s_aGen[u8Gen].u8Used = 1U;
+	s_aGen[u8Gen].u8Bus = u8Bus;
+	s_aGen[u8Gen].tmpl = *pTemplate;
+	s_aGen[u8Gen].u32NextId = pTemplate->u32Id;
+	s_aGen[u8Gen].u64Period = SIM_CAN_US(u32PeriodUs);
+	s_aGen[u8Gen].u64Due = s_u64Now + s_aGen[u8Gen].u64Period;
+	s_aGen[u8Gen].u32Count = u32Count;
+	return u8Gen;
+}
+
+/**
+* @brief            Load generator.
+* @details          Sends frames with IDs u32IdLow..u32IdHigh (random, uniform) so that this generator
+*					alone keeps the bus busy u8LoadPct percent of the time. Gaps are random around the
+*					mean, so frames of several sources collide and arbitrate.
+* @param[in]        u8Bus - Bus.
+* @param[in]        pTemplate - ID flags, length and flags of the frames.
+* @param[in]        u32IdHigh - Highest ID, pTemplate->u32Id is the lowest.
+* @param[in]        u8LoadPct - Bus load of this generator, 1-100.
+* @param[in]        u32Count - Number of frames, 0: no limit.
+* @return           Generator index, 0xFF if none is free.
+*/
+uint8_t sim_can_gen_load(uint8_t u8Bus, const sim_can_frame_t *pTemplate, uint32_t u32IdHigh, uint8_t u8LoadPct, uint32_t u32Count)
+{
+	uint8_t u8Gen = sim_can_gen_periodic(u8Bus, pTemplate, 0U, u32Count);
+
+	if (0xFFU != u8Gen)
+	{
+		s_aGen[u8Gen].u8LoadPct = u8LoadPct;
+		s_aGen[u8Gen].u32IdHigh = u32IdHigh;
+		sim_gen_schedule(&s_aGen[u8Gen], s_u64Now, 0U);
+	}
+	return u8Gen;
+}
+
+/**
+* @brief            Stop a generator.
+* @param[in]        u8Gen - Generator index.
+* @return           void.
+*/
+void sim_can_gen_stop(uint8_t u8Gen)
+{
+	s_aGen[u8Gen].u8Used = 0U;
+}
+
+/**
+* @brief            Frames sent by a generator.
+* @param[in]        u8Gen - Generator index.
+* @return           Number of frames.
+*/
+uint32_t sim_can_gen_sent(uint8_t u8Gen)
+{
+	return s_aGen[u8Gen].u32Sent;
+}
+
+/**
+* @brief            Inject a frame.
+* @details          The frame takes part in the next arbitration on the bus from u64At on.
+* @param[in]        u8Bus - Bus.
+* @param[in]        pFrame - Frame.
+* @param[in]        u64At - Model time, ticks.
+* @return           1 if queued, 0 if the injection queue of the bus is full.
+*/
+uint8_t sim_can_inject(uint8_t u8Bus, const sim_can_frame_t *pFrame, uint64_t u64At)
+{
+	sim_bus_t *pBus = &s_aBus[u8Bus];
+	uint32_t u32Pos = pBus->u8InjectCount;
+
+	if (u32Pos >= (sizeof(pBus->aInject) / sizeof(pBus->aInject[0])))
+	{
+		return 0U;
+	}
+	while ((u32Pos > 0U) && (pBus->aInject[u32Pos - 1U].u64Start > u64At))	/* Keep time order */
+	{
+		pBus->aInject[u32Pos] = pBus->aInject[u32Pos - 1U];
+		u32Pos--;
+	}
+	(void)memset(&pBus->aInject[u32Pos], 0, sizeof(pBus->aInject[u32Pos]));
+	pBus->aInject[u32Pos].frame = *pFrame;
+	pBus->aInject[u32Pos].u64Start = u64At;
+	pBus->aInject[u32Pos].u8Src = SIM_CAN_SRC_INJECT;
+	pBus->aInject[u32Pos].u32NominalTicks = pBus->u32NominalTicks;
+	pBus->aInject[u32Pos].u32DataTicks = pBus->u32DataTicks;
+	pBus->u8InjectCount++;
+	return 1U;
+}
+
+/**
+* @brief            Register trapping of an instance.
+* @details          For timing the driver code on the host: with trapping off, accesses to the register
+*					block go straight to the model memory, without side effects and not counted. Only
+*					for code that touches MB RAM alone, e.g. payload copies. On after sim_can_init().
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8On - 1: trapped, 0: plain memory.
+* @return           void.
+*/
+void sim_can_trap(uint8_t u8Inst, uint8_t u8On)
+{
+	(void)mprotect((void *)s_aRegion[u8Inst].uBase, s_aRegion[u8Inst].u32Size,
+				   (0U != u8On) ? PROT_NONE : (PROT_READ | PROT_WRITE));
+}
+
+/**
+* @brief            Bus monitor.
+* @param[in]        pfMonitor - Called at the end of every frame, NULL: none.
+* @return           void.
+*/
+void sim_can_monitor(sim_can_monitor_t pfMonitor)
+{
+	s_pfMonitor = pfMonitor;
+}
+
+/**
+* @brief            Interrupt handler.
+* @details          The handler runs while its source is active and its NVIC bit is enabled, lowest
+*					IP value first. Handlers run between bus events only, never inside the caller.
+* @param[in]        u32Irq - Interrupt number, SIM_CAN_IRQ_xxx.
+* @param[in]        pfIsr - Handler, NULL: none.
+* @return           void.
+*/
+void sim_can_irq(uint32_t u32Irq, sim_can_isr_t pfIsr)
+{
+	s_apfIsr[u32Irq] = pfIsr;
+}
+
+/**
+* @brief            Run the model.
+* @details          Advances time by u64Ticks: frames start and end, timers expire, interrupts are
+*					taken.
+* @param[in]        u64Ticks - Ticks.
+* @return           void.
+*/
+void sim_can_run(uint64_t u64Ticks)
+{
+	(void)sim_run(s_u64Now + u64Ticks, 0U);
+}
+
+/**
+* @brief            Run until idle.
+* @details          Runs until no frame is on any bus and nothing waits to be sent, or for u64MaxTicks.
+*					Unlimited generators never become idle.
+* @param[in]        u64MaxTicks - Limit.
+* @return           1 if idle, 0 at the limit.
+*/
+uint8_t sim_can_run_idle(uint64_t u64MaxTicks)
+{
+	return sim_run(s_u64Now + u64MaxTicks, 1U);
+}
+
+/**
+* @brief            Model time.
+* @param        	void.
+* @return           Ticks since sim_can_init().
+*/
+uint64_t sim_can_now(void)
+{
+	return s_u64Now;
+}
+
+/**
+* @brief            Bit time of an instance.
+* @details          From CTRL1 or CBT (BTF=1) and CTRL1[CLKSRC]: 8 MHz oscillator or 80 MHz SYS_CLK.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8Data - 0: nominal bit, 1: FD data phase bit (FDCBT).
+* @return           Ticks per bit.
+*/
+uint32_t sim_can_bit_ticks(uint8_t u8Inst, uint8_t u8Data)
+{
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint32_t u32Clock = (0U != (pRegs->CTRL1 & CAN_CTRL1_CLKSRC_MASK)) ? 1U : 10U;	/* Ticks per CAN clock */
+	uint32_t u32Presc = 0U;
+	uint32_t u32Tq = 0U;
+
+	if (0U != u8Data)
+	{
+		u32Presc = ((pRegs->FDCBT & CAN_FDCBT_FPRESDIV_MASK) >> CAN_FDCBT_FPRESDIV_SHIFT) + 1U;
+		u32Tq = 1U + ((pRegs->FDCBT & CAN_FDCBT_FPROPSEG_MASK) >> CAN_FDCBT_FPROPSEG_SHIFT)
+			  + ((pRegs->FDCBT & CAN_FDCBT_FPSEG1_MASK) >> CAN_FDCBT_FPSEG1_SHIFT) + 1U
+			  + (pRegs->FDCBT & CAN_FDCBT_FPSEG2_MASK) + 1U;
+	}
+	else if (0U != (pRegs->CBT & CAN_CBT_BTF_MASK))
+	{
+		u32Presc = ((pRegs->CBT & CAN_CBT_EPRESDIV_MASK) >> CAN_CBT_EPRESDIV_SHIFT) + 1U;
+		u32Tq = 1U + ((pRegs->CBT & CAN_CBT_EPROPSEG_MASK) >> CAN_CBT_EPROPSEG_SHIFT) + 1U
+			  + ((pRegs->CBT & CAN_CBT_EPSEG1_MASK) >> CAN_CBT_EPSEG1_SHIFT) + 1U
+			  + (pRegs->CBT & CAN_CBT_EPSEG2_MASK) + 1U;
+	}
+	else
+	{
+		u32Presc = ((pRegs->CTRL1 & CAN_CTRL1_PRESDIV_MASK) >> CAN_CTRL1_PRESDIV_SHIFT) + 1U;
+		u32Tq = 1U + (pRegs->CTRL1 & CAN_CTRL1_PROPSEG_MASK) + 1U
+			  + ((pRegs->CTRL1 & CAN_CTRL1_PSEG1_MASK) >> CAN_CTRL1_PSEG1_SHIFT) + 1U
+			  + ((pRegs->CTRL1 & CAN_CTRL1_PSEG2_MASK) >> CAN_CTRL1_PSEG2_SHIFT) + 1U;
+	}
+	return u32Presc * u32Tq * u32Clock;
+}
+
+/**
+* @brief            Frame length.
+* @details          Bits from SOF to the end of intermission, stuff bits included.
+* @param[in]        pFrame - Frame.
+* @param[out]       pu32DataBits - Bits at the data bit rate (FD with BRS), the rest are nominal bits.
+* @return           Total number of bits.
+*/
+uint32_t sim_can_frame_bits(const sim_can_frame_t *pFrame, uint32_t *pu32DataBits)
+{
+	uint8_t au8Bit[640];
+	uint8_t au8Phase[640];
+	uint32_t u32Count = 0U;
+	uint32_t u32Ext = (0U != (pFrame->u32Id & SIM_CAN_EXT)) ? 1U : 0U;
+	uint32_t u32Fd = (0U != (pFrame->u8Flags & SIM_CAN_FDF)) ? 1U : 0U;
+	uint32_t u32Brs = ((0U != u32Fd) && (0U != (pFrame->u8Flags & SIM_CAN_BRS))) ? 1U : 0U;
+	uint32_t u32Rtr = ((0U == u32Fd) && (0U != (pFrame->u8Flags & SIM_CAN_RTR))) ? 1U : 0U;
+	uint32_t u32Dlc = sim_dlc(pFrame);
+	uint32_t u32Length = (0U != u32Fd) ? s_au8DlcLength[u32Dlc] : u32Dlc;
+	uint32_t u32Nominal = 0U;
+	uint32_t u32Data = 0U;
+	uint32_t u32Fields[12][3];
+	uint32_t u32Field = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Bit = 0U;
+	uint32_t u32Last = 2U;
+	uint32_t u32Run = 0U;
+	uint32_t u32Crc = 0U;
+	uint32_t u32CrcLength = 0U;
+
+	/* Fields up to the data: value, bits, data phase */
+	u32Fields[u32Field][0] = 0U; u32Fields[u32Field][1] = 1U; u32Fields[u32Field++][2] = 0U;					/* SOF */
+	u32Fields[u32Field][0] = (0U != u32Ext) ? ((pFrame->u32Id >> 18U) & 0x7FFU) : (pFrame->u32Id & 0x7FFU);
+	u32Fields[u32Field][1] = 11U; u32Fields[u32Field++][2] = 0U;												/* Base ID */
+	if (0U != u32Ext)
+	{
+		u32Fields[u32Field][0] = 3U; u32Fields[u32Field][1] = 2U; u32Fields[u32Field++][2] = 0U;				/* SRR, IDE */
+		u32Fields[u32Field][0] = pFrame->u32Id & 0x3FFFFU; u32Fields[u32Field][1] = 18U; u32Fields[u32Field++][2] = 0U;
+		u32Fields[u32Field][0] = u32Rtr; u32Fields[u32Field][1] = 1U; u32Fields[u32Field++][2] = 0U;			/* RTR / RRS */
+	}
+	else
+	{
+		u32Fields[u32Field][0] = u32Rtr << 1U; u32Fields[u32Field][1] = 2U; u32Fields[u32Field++][2] = 0U;		/* RTR / RRS, IDE */
+	}
+	if (0U != u32Fd)
+	{
+		u32Fields[u32Field][0] = 4U | u32Brs; u32Fields[u32Field][1] = 3U; u32Fields[u32Field++][2] = 0U;		/* FDF, res, BRS */
+		u32Fields[u32Field][0] = 0U; u32Fields[u32Field][1] = 1U; u32Fields[u32Field++][2] = u32Brs;			/* ESI */
+	}
+	else
+	{
+		u32Fields[u32Field][0] = 0U; u32Fields[u32Field][1] = (0U != u32Ext) ? 2U : 1U; u32Fields[u32Field++][2] = 0U;	/* r1, r0 */
+	}
+	u32Fields[u32Field][0] = u32Dlc; u32Fields[u32Field][1] = 4U; u32Fields[u32Field++][2] = u32Brs;			/* DLC */
+
+	for (u32Index = 0U; u32Index < u32Field; u32Index++)
+	{
+		for (u32Bit = u32Fields[u32Index][1]; u32Bit-- > 0U;)
+		{
+			au8Bit[u32Count] = (uint8_t)((u32Fields[u32Index][0] >> u32Bit) & 1U);
+			au8Phase[u32Count++] = (uint8_t)u32Fields[u32Index][2];
+		}
+	}
+	for (u32Index = 0U; (0U == u32Rtr) && (u32Index < u32Length); u32Index++)
+	{
+		for (u32Bit = 8U; u32Bit-- > 0U;)
+		{
+			au8Bit[u32Count] = (uint8_t)((((u32Index < pFrame->u8Length) ? pFrame->au8Data[u32Index] : 0U) >> u32Bit) & 1U);
+			au8Phase[u32Count++] = (uint8_t)u32Brs;
+		}
+	}
+	if (0U == u32Fd)
+	{
+		for (u32Index = 0U; u32Index < u32Count; u32Index++)	/* CRC-15, x^15 + x^14 + x^10 + x^8 + x^7 + x^4 + x^3 + 1 */
+		{
+			u32Bit = au8Bit[u32Index] ^ ((u32Crc >> 14U) & 1U);
+			u32Crc = (u32Crc << 1U) & 0x7FFFU;
+			if (0U != u32Bit)
+			{
+				u32Crc ^= 0x4599U;
+			}
+		}
+		for (u32Bit = 15U; u32Bit-- > 0U;)
+		{
+			au8Bit[u32Count] = (uint8_t)((u32Crc >> u32Bit) & 1U);
+			au8Phase[u32Count++] = 0U;
+		}
+	}
+
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)	/* Dynamic stuffing: complement after 5 equal bits */
+	{
+		if (0U != au8Phase[u32Index])
+		{
+			u32Data++;
+		}
+		else
+		{
+			u32Nominal++;
+		}
+		if (au8Bit[u32Index] == u32Last)
+		{
+			u32Run++;
+		}
+		else
+		{
+			u32Last = au8Bit[u32Index];
+			u32Run = 1U;
+		}
+		if (5U == u32Run)
+		{
+			if (0U != au8Phase[u32Index])
+			{
+				u32Data++;
+			}
+			else
+			{
+				u32Nominal++;
+			}
+			u32Last ^= 1U;
+			u32Run = 1U;
+		}
+	}
+
+	if (0U != u32Fd)										/* Stuff count and CRC-17/21 with fixed stuff bits */
+	{
+		u32CrcLength = 4U + ((u32Length > 16U) ? 21U : 17U);
+		u32CrcLength += 1U + (u32CrcLength - 1U) / 4U;
+		if (0U != u32Brs)
+		{
+			u32Data += u32CrcLength;
+		}
+		else
+		{
+			u32Nominal += u32CrcLength;
+		}
+	}
+	u32Nominal += 13U;										/* CRC delimiter, ACK, ACK delimiter, EOF, IFS */
+
+	*pu32DataBits = u32Data;
+	if (0U == u32Brs)
+	{
+		u32Nominal += u32Data;
+		*pu32DataBits = 0U;
+	}
+	return u32Nominal + *pu32DataBits;
+}
+
+/**
+* @brief            Bus error.
+* @details          An error frame seen by an instance: sets the ESR1 error bits and ERRINT, moves the
+*					error counters and the fault confinement state (warning, passive, bus off).
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u32Esr1 - CAN_ESR1_STFERR_MASK ... CAN_ESR1_BIT1ERR_MASK.
+* @param[in]        s32Tec - Transmit error counter change.
+* @param[in]        s32Rec - Receive error counter change.
+* @return           void.
+*/
+void sim_can_error(uint8_t u8Inst, uint32_t u32Esr1, int32_t s32Tec, int32_t s32Rec)
+{
+	sim_inst_t *pInst = &s_aInst[u8Inst];
+	CAN_Type *pRegs = SIM_REGS(u8Inst);
+	uint16_t u16OldTec = pInst->u16Tec;
+	uint16_t u16OldRec = pInst->u16Rec;
+	int32_t s32Value = 0;
+
+	if (0U != (pRegs->ESR1 & SIM_ESR1_ERRORS))
+	{
+		pRegs->ESR1 |= CAN_ESR1_ERROVR_MASK;		/* Previous error bits not read yet */
+	}
+	pRegs->ESR1 |= (u32Esr1 & SIM_ESR1_ERRORS) | CAN_ESR1_ERRINT_MASK;
+
+	s32Value = (int32_t)pInst->u16Tec + s32Tec;
+	pInst->u16Tec = (uint16_t)((s32Value < 0) ? 0 : ((s32Value > 256) ? 256 : s32Value));
+	s32Value = (int32_t)pInst->u16Rec + s32Rec;
+	pInst->u16Rec = (uint16_t)((s32Value < 0) ? 0 : ((s32Value > 255) ? 255 : s32Value));
+	sim_err_update(u8Inst, u16OldTec, u16OldRec);
+}
+
+/**
+* @brief            Model counters.
+* @param        	void.
+* @return           Counters.
+*/
+const sim_can_stats_t *sim_can_stats(void)
+{
+	return &s_Stats;
+}
+
+/**
+* @brief            Test check.
+* @param[in]        iOk - Result.
+* @param[in]        pcText - Condition.
+* @param[in]        pcFile - File.
+* @param[in]        iLine - Line.
+* @return           iOk.
+*/
+int sim_check(int iOk, const char *pcText, const char *pcFile, int iLine)
+{
+	s_u32Checks++;
+	if (0 == iOk)
+	{
+		s_u32Failed++;
+		(void)printf("%s:%d: check failed: %s\n", pcFile, iLine, pcText);
+	}
+	return iOk;
+}
+
+/**
+* @brief            Test result.
+* @details          Prints the number of checks and failures.
+* @param[in]        pcName - Test name.
+* @return           0 if all checks passed, else 1 (process exit code).
+*/
+int sim_check_result(const char *pcName)
+{
+	(void)printf("%s: %u checks, %u failed\n", pcName, s_u32Checks, s_u32Failed);
+	return (0U == s_u32Failed) ? 0 : 1;
+}
+
+
+/* END sim_can */
@@ -0,0 +1,331 @@
+/**
+* @file				sim_can.h
+* @brief            Header for sim_can.c file
+* @details			Host model of the three FlexCAN instances and the peripherals around them, for
+*					running the unchanged 06_CAN and 07_CANFD drivers in host tests. Register blocks sit at
+*					their S32K144 addresses (see device_registers.h); every driver access is trapped and
+*					gets the silicon side effects. Instances are attached to virtual buses, which
+*					arbitrate, time frames bit-exact (stuff bits included) and deliver them at end of frame.
+*/
+
+#ifndef SIM_CAN_H
+#define SIM_CAN_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+#include "device_registers.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Bus frame */
+typedef struct
+{
+	uint32_t u32Id;				/* Standard ID, or extended ID with SIM_CAN_EXT */
+	uint8_t u8Length;			/* Data bytes: 0-8, FD 0-64 (rounded up to a DLC length on the bus) */
+	uint8_t u8Flags;			/* SIM_CAN_FDF, SIM_CAN_BRS, SIM_CAN_RTR */
+	uint8_t au8Data[64];		/* Data bytes, byte 0 first on the bus */
+} sim_can_frame_t;
+
+/* Bus monitor, called at the end of every frame on a bus */
+typedef void (*sim_can_monitor_t)(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+
+/* Interrupt handler */
+typedef void (*sim_can_isr_t)(void);
+
+/* Model counters, cleared by sim_can_init() */
+typedef struct
+{
+	uint64_t au64BusyTicks[3];			/* Ticks with a frame on the bus */
+	uint32_t au32Frames[3];				/* Frames on the bus */
+	uint32_t au32RxFrames[3];			/* Frames stored in an MB or the RX FIFO of an instance */
+	uint32_t au32RxOverrun[3];			/* Frames written over a full MB (CODE=OVERRUN) */
+	uint32_t au32FifoOverflow[3];		/* Frames lost with the RX FIFO full */
+	uint32_t au32RateMismatch[3];		/* Frames not received: instance bit timing differs from the frame */
+	uint32_t au32FdDropped[3];			/* FD frames seen by an instance with FDEN=0 */
+	uint32_t u32Accesses;				/* Trapped register accesses */
+	uint32_t u32FreezeViolations;		/* Writes to freeze mode only fields outside freeze mode (ignored) */
+	uint32_t u32IrqStorms;				/* Interrupt still active after SIM_CAN_STORM_CALLS handler calls */
+	uint32_t u32Irqs;					/* Handler calls */
+	uint32_t u32DmaMinorLoops;			/* eDMA minor loops (frames moved from an RX FIFO) */
+	uint32_t u32FlashErases;			/* FTFC sector erases (ERSSCR) */
+	uint32_t u32FlashPrograms;			/* FTFC phrase programs (PGM8) */
+	uint32_t u32FlashOverwrites;		/* PGM8 on a phrase that was not erased: bits only cleared */
+} sim_can_stats_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Model time base: SYS_CLK, 12.5 ns per tick */
+#define SIM_CAN_TICK_HZ			(80000000U)
+#define SIM_CAN_US(us)			((uint64_t)(us) * (SIM_CAN_TICK_HZ / 1000000U))
+#define SIM_CAN_MS(ms)			((uint64_t)(ms) * (SIM_CAN_TICK_HZ / 1000U))
+
+/* Virtual buses (default: instance n on bus n) */
+#define SIM_CAN_BUS_COUNT		(3U)
+
+/* Frame generators */
+#define SIM_CAN_GEN_COUNT		(16U)
+
+/* Frame ID flag: 29 bit extended ID, same bit as CAN_ID_EXT_FLAG */
+#define SIM_CAN_EXT				(0x80000000U)
+
+/* Frame flags */
+#define SIM_CAN_FDF				(0x01U)		/* CAN FD frame */
+#define SIM_CAN_BRS				(0x02U)		/* Data phase at the data bit rate */
+#define SIM_CAN_RTR				(0x04U)		/* Remote frame (classic only) */
+
+/* Frame source passed to the monitor: instance number, or generator / injected frame */
+#define SIM_CAN_SRC_GEN			(0x10U)		/* + generator index */
+#define SIM_CAN_SRC_INJECT		(0x20U)
+
+/* Interrupt numbers of the modelled sources */
+#define SIM_CAN_IRQ_DMA0		(0U)
+#define SIM_CAN_IRQ_LPIT0_CH0	(48U)
+#define SIM_CAN_IRQ_ORED(inst)	(78U + 7U*(inst))		/* Bus off, bus off done, TX/RX warning */
+#define SIM_CAN_IRQ_ERROR(inst)	(79U + 7U*(inst))		/* Error frames */
+#define SIM_CAN_IRQ_MB0(inst)	(81U + 7U*(inst))		/* MB 0-15 */
+#define SIM_CAN_IRQ_MB16		(82U)					/* CAN0 MB 16-31 */
+
+/* P-Flash model: SIM_CAN_FLASH_START up to 512 KB, the sectors below are not mapped and read as
+   protected (FPVIOL). Command times: typical values of the S32K144 data sheet */
+#define SIM_CAN_FLASH_START		(0x00010000U)
+#define SIM_CAN_FLASH_END		(0x00080000U)
+#define SIM_CAN_FLASH_ERASE_US	(12000U)	/* ERSSCR, 4 KB sector */
+#define SIM_CAN_FLASH_PGM8_US	(90U)		/* PGM8, 8 bytes */
+
+/* A handler that leaves its source active this often in a row is counted as an interrupt storm */
+#define SIM_CAN_STORM_CALLS		(64U)
+
+/* Test check: prints the failed condition, counted by sim_check_result() */
+#define SIM_CHECK(cond)			sim_check((cond) ? 1 : 0, #cond, __FILE__, __LINE__)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Model reset.
+* @details          Maps the register blocks on the first call. Every call puts all registers to their
+*					reset values and clears time, buses, generators, handlers and counters.
+* @param        	void.
+* @return           void.
+*/
+void sim_can_init(void);
+
+/**
+* @brief            Registers of an instance.
+* @details          Model view: reads and writes have no side effects (no locking, no write 1 to clear).
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @return           Registers.
+*/
+CAN_Type *sim_can_regs(uint8_t u8Inst);
+
+/**
+* @brief            Attach an instance to a bus.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8Bus - Bus (0 to SIM_CAN_BUS_COUNT-1).
+* @return           void.
+*/
+void sim_can_connect(uint8_t u8Inst, uint8_t u8Bus);
+
+/**
+* @brief            Bus bit rates.
+* @details          Bit rates of the generated and injected frames (default 500 kbit/s, 2 Mbit/s).
+*					An instance whose bit timing differs does not receive them.
+* @param[in]        u8Bus - Bus.
+* @param[in]        u32Nominal - Nominal bit rate in bit/s, must divide SIM_CAN_TICK_HZ.
+* @param[in]        u32Data - FD data phase bit rate in bit/s, must divide SIM_CAN_TICK_HZ.
+* @return           void.
+*/
+void sim_can_bus_rate(uint8_t u8Bus, uint32_t u32Nominal, uint32_t u32Data);
+
+/**
+* @brief            Periodic generator.
+* @details          Sends u32Count frames (0: no limit) with ID u32Id every u32PeriodUs, the first one
+*					u32PeriodUs from now. Data bytes 0-3: sequence number (big-endian), byte 4: generator,
+*					further bytes 0xA5.
+* @param[in]        u8Bus - Bus.
+* @param[in]        pTemplate - ID, length and flags of the frames.
+* @param[in]        u32PeriodUs - Period.
+* @param[in]        u32Count - Number of frames, 0: no limit.
+* @return           Generator index, 0xFF if none is free.
+*/
+uint8_t sim_can_gen_periodic(uint8_t u8Bus, const sim_can_frame_t *pTemplate, uint32_t u32PeriodUs, uint32_t u32Count);
+
+/**
+* @brief            Load generator.
+* @details          Sends frames with IDs u32IdLow..u32IdHigh (random, uniform) so that this generator
+*					alone keeps the bus busy u8LoadPct percent of the time. Gaps are random around the
+*					mean, so frames of several sources collide and arbitrate.
+* @param[in]        u8Bus - Bus.
+* @param[in]        pTemplate - ID flags, length and flags of the frames.
+* @param[in]        u32IdHigh - Highest ID, pTemplate->u32Id is the lowest.
+* @param[in]        u8LoadPct - Bus load of this generator, 1-100.
+* @param[in]        u32Count - Number of frames, 0: no limit.
+* @return           Generator index, 0xFF if none is free.
+*/
+uint8_t sim_can_gen_load(uint8_t u8Bus, const sim_can_frame_t *pTemplate, uint32_t u32IdHigh, uint8_t u8LoadPct, uint32_t u32Count);
+
+/**
+* @brief            Stop a generator.
+* @param[in]        u8Gen - Generator index.
+* @return           void.
+*/
+void sim_can_gen_stop(uint8_t u8Gen);
+
+/**
+* @brief            Frames sent by a generator.
+* @param[in]        u8Gen - Generator index.
+* @return           Number of frames.
+*/
+uint32_t sim_can_gen_sent(uint8_t u8Gen);
+
+/**
+* @brief            Inject a frame.
+* @details          The frame takes part in the next arbitration on the bus from u64At on.
+* @param[in]        u8Bus - Bus.
+* @param[in]        pFrame - Frame.
+* @param[in]        u64At - Model time, ticks.
+* @return           1 if queued, 0 if the injection queue of the bus is full.
+*/
+uint8_t sim_can_inject(uint8_t u8Bus, const sim_can_frame_t *pFrame, uint64_t u64At);
+
+/**
+* @brief            Register trapping of an instance.
+* @details          For timing the driver code on the host: with trapping off, accesses to the register
+*					block go straight to the model memory, without side effects and not counted. Only
+*					for code that touches MB RAM alone, e.g. payload copies. On after sim_can_init().
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8On - 1: trapped, 0: plain memory.
+* @return           void.
+*/
+void sim_can_trap(uint8_t u8Inst, uint8_t u8On);
+
+/**
+* @brief            Bus monitor.
+* @param[in]        pfMonitor - Called at the end of every frame, NULL: none.
+* @return           void.
+*/
+void sim_can_monitor(sim_can_monitor_t pfMonitor);
+
+/**
+* @brief            Interrupt handler.
+* @details          The handler runs while its source is active and its NVIC bit is enabled, lowest
+*					IP value first. Handlers run between bus events only, never inside the caller.
+* @param[in]        u32Irq - Interrupt number, SIM_CAN_IRQ_xxx.
+* @param[in]        pfIsr - Handler, NULL: none.
+* @return           void.
+*/
+void sim_can_irq(uint32_t u32Irq, sim_can_isr_t pfIsr);
+
+/**
+* @brief            Run the model.
+* @details          Advances time by u64Ticks: frames start and end, timers expire, interrupts are
+*					taken.
+* @param[in]        u64Ticks - Ticks.
+* @return           void.
+*/
+void sim_can_run(uint64_t u64Ticks);
+
+/**
+* @brief            Run until idle.
+* @details          Runs until no frame is on any bus and nothing waits to be sent, or for u64MaxTicks.
+*					Unlimited generators never become idle.
+* @param[in]        u64MaxTicks - Limit.
+* @return           1 if idle, 0 at the limit.
+*/
+uint8_t sim_can_run_idle(uint64_t u64MaxTicks);
+
+/**
+* @brief            Model time.
+* @param        	void.
+* @return           Ticks since sim_can_init().
+*/
+uint64_t sim_can_now(void);
+
+/**
+* @brief            Bit time of an instance.
+* @details          From CTRL1 or CBT (BTF=1) and CTRL1[CLKSRC]: 8 MHz oscillator or 80 MHz SYS_CLK.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8Data - 0: nominal bit, 1: FD data phase bit (FDCBT).
+* @return           Ticks per bit.
+*/
+uint32_t sim_can_bit_ticks(uint8_t u8Inst, uint8_t u8Data);
+
+/**
+* @brief            Frame length.
+* @details          Bits from SOF to the end of intermission, stuff bits included.
+* @param[in]        pFrame - Frame.
+* @param[out]       pu32DataBits - Bits at the data bit rate (FD with BRS), the rest are nominal bits.
+* @return           Total number of bits.
+*/
+uint32_t sim_can_frame_bits(const sim_can_frame_t *pFrame, uint32_t *pu32DataBits);
+
+/**
+* @brief            Bus error.
+* @details          An error frame seen by an instance: sets the ESR1 error bits and ERRINT, moves the
+*					error counters and the fault confinement state (warning, passive, bus off).
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u32Esr1 - CAN_ESR1_STFERR_MASK ... CAN_ESR1_BIT1ERR_MASK.
+* @param[in]        s32Tec - Transmit error counter change.
+* @param[in]        s32Rec - Receive error counter change.
+* @return           void.
+*/
+void sim_can_error(uint8_t u8Inst, uint32_t u32Esr1, int32_t s32Tec, int32_t s32Rec);
+
+/**
+* @brief            Model counters.
+* @param        	void.
+* @return           Counters.
+*/
+const sim_can_stats_t *sim_can_stats(void);
+
+/**
+* @brief            Test check.
+* @param[in]        iOk - Result.
+* @param[in]        pcText - Condition.
+* @param[in]        pcFile - File.
+* @param[in]        iLine - Line.
+* @return           iOk.
+*/
+int sim_check(int iOk, const char *pcText, const char *pcFile, int iLine);
+
+/**
+* @brief            Test result.
+* @details          Prints the number of checks and failures.
+* @param[in]        pcName - Test name.
+* @return           0 if all checks passed, else 1 (process exit code).
+*/
+int sim_check_result(const char *pcName);
+
+
+#endif	/* SIM_CAN_H */
@@ -0,0 +1,530 @@
+/**
+* @file			sim_replay.c
+* @brief		Replay of candump and Vector ASC logs into CAN0 on the register model
+* @details		Parses a log (the formats Tools/can_trace_dump.c writes, and candump -l / CANalyzer
+*				output), injects its frames on bus 0 and receives them with the CAN0 MB interrupt of
+*				main.c, built with RX_FIFO_MODE=1. CAN0 is set up as in main.c, with one RX FIFO filter
+*				element that accepts every standard and extended ID. A main loop takes the frames out of
+*				the receive ring every -p microseconds and records the reception to application latency,
+*				as main() does.
+*
+*				sim_replay [-s pct | -f] [-p us] [-c] file.log|file.asc
+*
+*				-s pct	timing in percent of the original (100, default: original gaps, 200: half speed)
+*				-f		as fast as the bus takes the frames
+*				-p us	main loop period, default 1000
+*				-c		exit code 1 if a frame was lost (RX FIFO or ring full) or a line not understood
+*
+*				Reported: frames, bus load, RX FIFO overflows, ring drops and high-water mark, the CanLatRx
+*				histogram. CAN FD frames are skipped: CAN0 runs classic CAN at 500 kbit/s.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "sim_can.h"
+#include "main.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Log record */
+typedef struct
+{
+	double dTime;				/* Seconds, as in the log */
+	sim_can_frame_t frame;		/* Frame */
+} replay_record_t;
+
+/* Parsed log */
+typedef struct
+{
+	replay_record_t *pRecords;
+	uint32_t u32Count;
+	uint32_t u32Capacity;
+	uint32_t u32Lines;			/* Frame lines */
+	uint32_t u32Fd;				/* CAN FD frames, skipped */
+	uint32_t u32Bad;			/* Lines that look like frames but do not parse */
+} replay_log_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Timing argument for as fast as possible */
+#define REPLAY_FAST				(0U)
+
+/* Default main loop period */
+#define REPLAY_LOOP_US			(1000U)
+
+/* Bus time after the last frame before the results are taken */
+#define REPLAY_DRAIN_MS			(20U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static int replay_hex(const char *pcText, uint32_t u32Digits, uint32_t *pu32Value);
+static int replay_add(replay_log_t *pLog, double dTime, const sim_can_frame_t *pFrame);
+static int replay_candump(const char *pcLine, double *pdTime, sim_can_frame_t *pFrame);
+static int replay_asc(char *pcLine, int iHex, double *pdTime, sim_can_frame_t *pFrame);
+static int replay_load(const char *pcPath, replay_log_t *pLog);
+static void replay_setup(void);
+static uint32_t replay_drain(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Hex number.
+* @param[in]        pcText - Text.
+* @param[in]        u32Digits - Number of digits to read, 0: up to the first non hex character.
+* @param[out]       pu32Value - Value.
+* @return           Number of characters read, 0 if none.
+*/
+static int replay_hex(const char *pcText, uint32_t u32Digits, uint32_t *pu32Value)
+{
+	uint32_t u32Value = 0U;
+	int iCount = 0;
+
+	while ((0 != isxdigit((unsigned char)pcText[iCount])) && ((0U == u32Digits) || ((uint32_t)iCount < u32Digits)))
+	{
+		u32Value = (u32Value << 4U) | (uint32_t)(isdigit((unsigned char)pcText[iCount])
+				 ? (pcText[iCount] - '0') : (toupper((unsigned char)pcText[iCount]) - 'A' + 10));
+		iCount++;
+	}
+	*pu32Value = u32Value;
+	return iCount;
+}
+
+/**
+* @brief            Append a record.
+* @return           1 if stored, 0 out of memory.
+*/
+static int replay_add(replay_log_t *pLog, double dTime, const sim_can_frame_t *pFrame)
+{
+	replay_record_t *pGrown = NULL;
+
+	if (pLog->u32Count == pLog->u32Capacity)
+	{
+		pLog->u32Capacity = (0U != pLog->u32Capacity) ? (2U * pLog->u32Capacity) : 1024U;
+		pGrown = realloc(pLog->pRecords, pLog->u32Capacity * sizeof(replay_record_t));
+		if (NULL == pGrown)
+		{
+			return 0;
+		}
+		pLog->pRecords = pGrown;
+	}
+	pLog->pRecords[pLog->u32Count].dTime = dTime;
+	pLog->pRecords[pLog->u32Count].frame = *pFrame;
+	pLog->u32Count++;
+	return 1;
+}
+
+/**
+* @brief            candump log line.
+* @details          "(sec.usec) iface ID#DATA", "ID#R" remote frame, "ID##<flags>DATA" CAN FD. A 3 digit
+*					ID is standard, 8 digits extended.
+* @return           1 classic frame, 2 CAN FD frame, 0 not a frame line, -1 malformed.
+*/
+static int replay_candump(const char *pcLine, double *pdTime, sim_can_frame_t *pFrame)
+{
+	const char *pcPos = NULL;
+	uint32_t u32Value = 0U;
+	int iDigits = 0;
+
+	if ('(' != pcLine[0])
+	{
+		return 0;
+	}
+	if (1 != sscanf(pcLine, "(%lf)", pdTime))
+	{
+		return -1;
+	}
+	pcPos = strchr(pcLine, ')');
+	pcPos = (NULL != pcPos) ? strchr(pcPos + 2, ' ') : NULL;	/* Skip the interface name */
+	if (NULL == pcPos)
+	{
+		return -1;
+	}
+	pcPos++;
+
+	(void)memset(pFrame, 0, sizeof(*pFrame));
+	iDigits = replay_hex(pcPos, 0U, &pFrame->u32Id);
+	if (('#' != pcPos[iDigits]) || ((3 != iDigits) && (8 != iDigits)))
+	{
+		return -1;
+	}
+	if (8 == iDigits)
+	{
+		pFrame->u32Id |= SIM_CAN_EXT;
+	}
+	pcPos += iDigits + 1;
+
+	if ('#' == pcPos[0])
+	{
+		return 2;										/* CAN FD */
+	}
+	if ('R' == pcPos[0])
+	{
+		pFrame->u8Flags = SIM_CAN_RTR;
+		pFrame->u8Length = (0 != isdigit((unsigned char)pcPos[1])) ? (uint8_t)(pcPos[1] - '0') : 0U;
+		return (pFrame->u8Length <= 8U) ? 1 : -1;
+	}
+	while (2 == replay_hex(pcPos, 2U, &u32Value))
+	{
+		if (pFrame->u8Length >= 8U)
+		{
+			return -1;
+		}
+		pFrame->au8Data[pFrame->u8Length++] = (uint8_t)u32Value;
+		pcPos += 2;
+	}
+	return ((0 == isxdigit((unsigned char)pcPos[0])) && (0 == isgraph((unsigned char)pcPos[0]))) ? 1 : -1;
+}
+
+/**
+* @brief            Vector ASC line.
+* @details          "time channel ID[x] Rx|Tx d|r DLC bytes ...", "time CANFD channel ..." for CAN FD.
+*					Header, trigger block, error frame and event lines are not frames.
+* @param[in,out]    pcLine - Line, split into tokens.
+* @param[in]        iHex - 1 if the log has "base hex".
+* @return           1 classic frame, 2 CAN FD frame, 0 not a frame line, -1 malformed.
+*/
+static int replay_asc(char *pcLine, int iHex, double *pdTime, sim_can_frame_t *pFrame)
+{
+	char *apcTok[16];
+	char *pcSave = NULL;
+	char *pcEnd = NULL;
+	uint32_t u32Count = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Value = 0U;
+	unsigned long ulLength = 0UL;
+
+	for (apcTok[0] = strtok_r(pcLine, " \t\r\n", &pcSave); (NULL != apcTok[u32Count]) && (u32Count < 15U);
+		 apcTok[u32Count] = strtok_r(NULL, " \t\r\n", &pcSave))
+	{
+		u32Count++;
+	}
+	if (u32Count < 2U)
+	{
+		return 0;
+	}
+	*pdTime = strtod(apcTok[0], &pcEnd);
+	if (('\0' != *pcEnd) || (pcEnd == apcTok[0]))
+	{
+		return 0;										/* Header and trigger block lines */
+	}
+	if (0 == strcmp(apcTok[1], "CANFD"))
+	{
+		return 2;
+	}
+	if ((0 == isdigit((unsigned char)apcTok[1][0])) || (u32Count < 6U))
+	{
+		return 0;
+	}
+	if ((0 != strcmp(apcTok[3], "Rx")) && (0 != strcmp(apcTok[3], "Tx")))
+	{
+		return 0;										/* ErrorFrame, statistics and other events */
+	}
+
+	(void)memset(pFrame, 0, sizeof(*pFrame));
+	pFrame->u32Id = (uint32_t)strtoul(apcTok[2], &pcEnd, (0 != iHex) ? 16 : 10);
+	if ('x' == *pcEnd)
+	{
+		pFrame->u32Id |= SIM_CAN_EXT;
+		pcEnd++;
+	}
+	if ('\0' != *pcEnd)
+	{
+		return -1;
+	}
+
+	ulLength = strtoul(apcTok[5], &pcEnd, 16);
+	if (('\0' != *pcEnd) || (ulLength > 8UL))
+	{
+		return -1;
+	}
+	pFrame->u8Length = (uint8_t)ulLength;
+	if (0 == strcmp(apcTok[4], "r"))
+	{
+		pFrame->u8Flags = SIM_CAN_RTR;
+		return 1;
+	}
+	if ((0 != strcmp(apcTok[4], "d")) || (u32Count < (6U + ulLength)))
+	{
+		return -1;
+	}
+	for (u32Index = 0U; u32Index < ulLength; u32Index++)
+	{
+		if ((2 != replay_hex(apcTok[6U + u32Index], 0U, &u32Value)) || ('\0' != apcTok[6U + u32Index][2]))
+		{
+			return -1;
+		}
+		pFrame->au8Data[u32Index] = (uint8_t)u32Value;
+	}
+	return 1;
+}
+
+/**
+* @brief            Read a log.
+* @details          Lines starting with '(' are candump, the others ASC. ASC relative time stamps are
+*					summed up.
+* @return           1 if read, 0 if the file cannot be opened or holds no frame.
+*/
+static int replay_load(const char *pcPath, replay_log_t *pLog)
+{
+	char acLine[512];
+	sim_can_frame_t frame;
+	double dTime = 0.0;
+	double dLast = 0.0;
+	int iHex = 1;
+	int iRelative = 0;
+	int iResult = 0;
+	FILE *pFile = fopen(pcPath, "r");
+
+	(void)memset(pLog, 0, sizeof(*pLog));
+	if (NULL == pFile)
+	{
+		perror(pcPath);
+		return 0;
+	}
+
+	while (NULL != fgets(acLine, sizeof(acLine), pFile))
+	{
+		if (0 == strncmp(acLine, "base ", 5U))
+		{
+			iHex = (NULL != strstr(acLine, "hex")) ? 1 : 0;
+			iRelative = (NULL != strstr(acLine, "relative")) ? 1 : 0;
+			continue;
+		}
+		iResult = ('(' == acLine[0]) ? replay_candump(acLine, &dTime, &frame) : replay_asc(acLine, iHex, &dTime, &frame);
+		if (0 == iResult)
+		{
+			continue;
+		}
+		pLog->u32Lines++;
+		if ((0 != iRelative) && ('(' != acLine[0]))
+		{
+			dTime += dLast;
+		}
+		dLast = dTime;
+		if (iResult < 0)
+		{
+			pLog->u32Bad++;
+		}
+		else if (2 == iResult)
+		{
+			pLog->u32Fd++;
+		}
+		else if (0 == replay_add(pLog, dTime, &frame))
+		{
+			break;
+		}
+	}
+	fclose(pFile);
+
+	if (0U == pLog->u32Count)
+	{
+		fprintf(stderr, "%s: no CAN frames\n", pcPath);
+		return 0;
+	}
+	return 1;
+}
+
+/**
+* @brief            CAN0 as in main.c with RX_FIFO_MODE=1, the filter element accepts every ID.
+*/
+static void replay_setup(void)
+{
+	static const uint32_t au32Filter[1] = {FLEXCAN_FIFO_ID_A(0U)};
+	static const uint32_t au32Mask[1] = {0U};			/* No bit compared, IDE included */
+
+	sim_can_init();
+	(void)FLEXCAN0_init_rx_fifo(FLEXCAN_FIFO_FORMAT_A, au32Filter, au32Mask, 1U);
+	can_ring_init(&CanRxRing);
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN_FIFO_AVAILABLE_FLAG);
+	RxFifoOverflow = 0U;
+	can_stats_init();
+	can_tx_init(NULL);
+
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), CAN0_ORed_0_15_MB_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_ORED(0U), CAN0_ORed_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_ERROR(0U), CAN0_Error_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_LPIT0_CH0, LPIT0_Ch0_IRQHandler);
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	S32_NVIC->IP[81] = 0x8U;
+	can_time_init();
+	can_err_init(CAN_ERR_RECOVER_AUTO, NULL);
+	can_stats_reset();
+	can_lat_reset(&CanLatRx);
+}
+
+/**
+* @brief            Main loop pass: take the frames out of the receive ring, as main() does.
+* @return           Number of frames.
+*/
+static uint32_t replay_drain(void)
+{
+	can_frame_t frame;
+	uint32_t u32Count = 0U;
+
+	while (1U == can_ring_pop(&CanRxRing, &frame))
+	{
+		can_lat_record(&CanLatRx, frame.u64Timestamp, can_time_now());
+		u32Count++;
+	}
+	return u32Count;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Replay a log file.
+*/
+int main(int argc, char **argv)
+{
+	const char *pcPath = NULL;
+	replay_log_t log;
+	uint32_t u32ScalePct = 100U;
+	uint32_t u32LoopUs = REPLAY_LOOP_US;
+	uint32_t u32Next = 0U;
+	uint32_t u32Received = 0U;
+	uint32_t u32Index = 0U;
+	uint64_t u64Start = 0U;
+	uint64_t u64Due = 0U;
+	uint64_t u64End = 0U;
+	uint64_t u64Low = 0U;
+	int iCheck = 0;
+	int iArg = 0;
+	int iLost = 0;
+
+	for (iArg = 1; iArg < argc; iArg++)
+	{
+		if ((0 == strcmp(argv[iArg], "-s")) && ((iArg + 1) < argc))
+		{
+			u32ScalePct = (uint32_t)strtoul(argv[++iArg], NULL, 10);
+		}
+		else if (0 == strcmp(argv[iArg], "-f"))
+		{
+			u32ScalePct = REPLAY_FAST;
+		}
+		else if ((0 == strcmp(argv[iArg], "-p")) && ((iArg + 1) < argc))
+		{
+			u32LoopUs = (uint32_t)strtoul(argv[++iArg], NULL, 10);
+		}
+		else if (0 == strcmp(argv[iArg], "-c"))
+		{
+			iCheck = 1;
+		}
+		else
+		{
+			pcPath = argv[iArg];
+		}
+	}
+	if ((NULL == pcPath) || (0U == u32LoopUs))
+	{
+		fprintf(stderr, "usage: %s [-s pct | -f] [-p us] [-c] file.log|file.asc\n", argv[0]);
+		return 2;
+	}
+	if (0 == replay_load(pcPath, &log))
+	{
+		return 1;
+	}
+
+	replay_setup();
+	u64Start = sim_can_now();
+	while ((u32Next < log.u32Count) || (0U != can_ring_count(&CanRxRing)) || (0U == u64End))
+	{
+		/* Frames due before the end of this main loop pass, in log order */
+		while (u32Next < log.u32Count)
+		{
+			u64Due = sim_can_now();
+			if (REPLAY_FAST != u32ScalePct)
+			{
+				u64Due = u64Start + (uint64_t)((log.pRecords[u32Next].dTime - log.pRecords[0].dTime)
+											   * (double)SIM_CAN_TICK_HZ * (double)u32ScalePct / 100.0);
+				if (u64Due >= (sim_can_now() + SIM_CAN_US(u32LoopUs)))
+				{
+					break;
+				}
+				u64Due = (u64Due > sim_can_now()) ? u64Due : sim_can_now();
+			}
+			if (0U == sim_can_inject(0U, &log.pRecords[u32Next].frame, u64Due))
+			{
+				break;									/* Injection queue full: next pass */
+			}
+			u32Next++;
+		}
+		if (u32Next < log.u32Count)
+		{
+			sim_can_run(SIM_CAN_US(u32LoopUs));
+		}
+		else if ((0U == u64End) && (1U == sim_can_run_idle(SIM_CAN_US(u32LoopUs))))
+		{
+			u64End = sim_can_now();						/* Last frame off the bus */
+		}
+		u32Received += replay_drain();
+	}
+	sim_can_run(SIM_CAN_MS(REPLAY_DRAIN_MS));
+	u32Received += replay_drain();
+
+	iLost = ((0U != RxFifoOverflow) || (0U != CanRxRing.u32Overflow) || (0U != log.u32Bad)
+			 || (u32Received != (log.u32Count - RxFifoOverflow - CanRxRing.u32Overflow))) ? 1 : 0;
+
+	printf("sim_replay: %s, %u frames (%u CAN FD skipped, %u lines not understood), ", pcPath,
+		   (unsigned)log.u32Count, (unsigned)log.u32Fd, (unsigned)log.u32Bad);
+	if (REPLAY_FAST == u32ScalePct)
+	{
+		printf("as fast as possible\n");
+	}
+	else
+	{
+		printf("%u %% of the original timing\n", (unsigned)u32ScalePct);
+	}
+	printf("  bus: %.3f s, load %.1f %%\n", (double)(u64End - u64Start) / SIM_CAN_TICK_HZ,
+		   100.0 * (double)sim_can_stats()->au64BusyTicks[0] / (double)((u64End > u64Start) ? (u64End - u64Start) : 1U));
+	printf("  CAN0: %u received, %u RX FIFO overflows, %u ring drops, ring high-water %u of %u (main loop every %u us)\n",
+		   (unsigned)u32Received, (unsigned)RxFifoOverflow, (unsigned)CanRxRing.u32Overflow,
+		   (unsigned)CanRxRing.u32MaxDepth, (unsigned)CAN_RING_SIZE, (unsigned)u32LoopUs);
+	printf("  reception to main loop, bit times: p50 %u p99 %u max %u\n",
+		   (unsigned)can_lat_percentile(&CanLatRx, 500U), (unsigned)can_lat_percentile(&CanLatRx, 990U),
+		   (unsigned)CanLatRx.u32Max);
+	for (u32Index = 0U; u32Index < CAN_LAT_BUCKETS; u32Index++)
+	{
+		if (0U != CanLatRx.au32Bucket[u32Index])
+		{
+			u64Low = (0U != u32Index) ? (1ULL << (u32Index - 1U)) : 0U;
+			printf("  %6llu-%-6llu %8u\n", (unsigned long long)u64Low,
+				   (unsigned long long)((0U != u32Index) ? ((u64Low << 1U) - 1U) : 0U), (unsigned)CanLatRx.au32Bucket[u32Index]);
+		}
+	}
+
+	free(log.pRecords);
+	return ((0 != iCheck) && (0 != iLost)) ? 1 : 0;
+}
+
+
+/* END sim_replay */
@@ -0,0 +1,251 @@
+/**
+* @file			test_can_dma.c
+* @brief		Host test of the eDMA RX path (can_dma.c) on the register model
+* @details		CAN0 set up as main.c does with RX_DMA_MODE: the RX FIFO raises DMA requests, channel 0
+*				copies each frame into a 64 frame buffer, the half and major loop interrupts hand one
+*				half at a time to the block callback. A generator keeps the bus 100 % busy at 1 Mbit/s
+*				(built with FLEXCAN0_BITRATE 1000000) with a sequence number in data bytes 0-3, so every
+*				lost frame shows up as a gap.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "flexcan.h"
+#include "can_dma.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* RX FIFO filter of main.c */
+#define TEST_ID					(0x511U)
+
+/* DMA buffer (RX_DMA_FRAMES of main.c) and frames per interrupt */
+#define TEST_DMA_FRAMES			(64U)
+#define TEST_HALF				(TEST_DMA_FRAMES / 2U)
+
+/* Full load run */
+#define TEST_LOAD_MS			(1000U)
+
+/* DMA interrupt disabled right after an interrupt: late by less than a half after the next one
+   completed (no loss), late by more (the other half is written over) */
+#define TEST_LATE_FRAMES		(TEST_HALF + TEST_HALF / 2U)
+#define TEST_LOST_FRAMES		(2U * TEST_HALF + TEST_HALF / 2U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* RX FIFO filter table of main.c: accept TEST_ID only */
+static const uint32_t s_au32Filters[1] = {FLEXCAN_FIFO_ID_A(TEST_ID)};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* RX FIFO frames, written by the DMA */
+static can_dma_frame_t s_aBuf[TEST_DMA_FRAMES];
+
+/* Sequence numbers handed to the block callback: next expected, frames, gaps, frames in the gaps */
+static uint32_t s_u32NextSeq;
+static uint32_t s_u32Received;
+static uint32_t s_u32Gaps;
+static uint32_t s_u32GapFrames;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_block(const can_dma_frame_t *pFrames, uint32_t u32Count);
+static void test_setup(void);
+static uint8_t test_start_load(void);
+static void test_run_until(uint32_t u32Loops);
+static void test_irq_off(uint32_t u32Frames);
+static void test_full_load(void);
+static void test_overrun(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Block callback: count sequence gaps.
+*/
+static void test_block(const can_dma_frame_t *pFrames, uint32_t u32Count)
+{
+	can_frame_t frame;
+	uint32_t u32Index = 0U;
+
+	SIM_CHECK(TEST_HALF == u32Count);
+	for (u32Index = 0U; u32Index < u32Count; u32Index++)
+	{
+		can_dma_decode(&pFrames[u32Index], &frame);
+		SIM_CHECK(TEST_ID == frame.u32Id);
+		SIM_CHECK(8U == frame.u8Length);
+		if (frame.u32Data[0] != s_u32NextSeq)
+		{
+			SIM_CHECK(frame.u32Data[0] > s_u32NextSeq);
+			s_u32Gaps++;
+			s_u32GapFrames += frame.u32Data[0] - s_u32NextSeq;
+		}
+		s_u32NextSeq = frame.u32Data[0] + 1U;
+		s_u32Received++;
+	}
+}
+
+/**
+* @brief            CAN0 at 1 Mbit/s as in main() with RX_DMA_MODE, DMA interrupt at priority 10.
+*/
+static void test_setup(void)
+{
+	sim_can_init();
+	sim_can_bus_rate(0U, FLEXCAN0_BITRATE, 2000000U);
+	can_dma_init(s_aBuf, TEST_DMA_FRAMES, test_block);
+	SIM_CHECK(1U == FLEXCAN0_init_rx_fifo_dma(FLEXCAN_FIFO_FORMAT_A, s_au32Filters, NULL, 1U));
+	sim_can_irq(SIM_CAN_IRQ_DMA0, can_dma_isr);
+
+	s_u32NextSeq = 0U;
+	s_u32Received = 0U;
+	s_u32Gaps = 0U;
+	s_u32GapFrames = 0U;
+}
+
+/**
+* @brief            Back to back TEST_ID frames, sequence number in data bytes 0-3.
+*/
+static uint8_t test_start_load(void)
+{
+	sim_can_frame_t frame;
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = TEST_ID;
+	frame.u8Length = 8U;
+	return sim_can_gen_load(0U, &frame, TEST_ID, 100U, 0U);
+}
+
+/**
+* @brief            Run in 10 us steps until the DMA has moved u32Loops more frames.
+*/
+static void test_run_until(uint32_t u32Loops)
+{
+	uint32_t u32Start = sim_can_stats()->u32DmaMinorLoops;
+
+	while ((sim_can_stats()->u32DmaMinorLoops - u32Start) < u32Loops)
+	{
+		sim_can_run(SIM_CAN_MS(1U) / 100U);
+	}
+}
+
+/**
+* @brief            Disable the DMA interrupt right after an interrupt for u32Frames frames.
+*/
+static void test_irq_off(uint32_t u32Frames)
+{
+	uint32_t u32Blocks = CanDmaStats.u32Blocks;
+
+	while (u32Blocks == CanDmaStats.u32Blocks)
+	{
+		sim_can_run(SIM_CAN_MS(1U) / 100U);
+	}
+	u32Blocks = CanDmaStats.u32Blocks;
+	S32_NVIC->ICER[0] = 1UL << CAN_DMA_CH;
+	test_run_until(u32Frames);
+	SIM_CHECK(u32Blocks == CanDmaStats.u32Blocks);
+	S32_NVIC->ISER[0] = 1UL << CAN_DMA_CH;
+	test_run_until(2U * TEST_HALF);
+}
+
+/**
+* @brief            1 Mbit/s, 100 % load: every frame arrives in order, one interrupt per half.
+*/
+static void test_full_load(void)
+{
+	uint32_t u32Irqs = 0U;
+	uint32_t u32Loops = 0U;
+	uint8_t u8Gen = 0U;
+
+	test_setup();
+	u8Gen = test_start_load();
+	sim_can_run(SIM_CAN_MS(TEST_LOAD_MS));
+	sim_can_gen_stop(u8Gen);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	u32Irqs = sim_can_stats()->u32Irqs;
+	u32Loops = sim_can_stats()->u32DmaMinorLoops;
+
+	(void)printf("test_can_dma: 1 Mbit/s, 100 %% load: %u frames/s, %u interrupts/s, %u frames per interrupt\n",
+				 (uint32_t)((uint64_t)sim_can_gen_sent(u8Gen) * 1000U / TEST_LOAD_MS),
+				 (uint32_t)((uint64_t)u32Irqs * 1000U / TEST_LOAD_MS), s_u32Received / u32Irqs);
+
+	SIM_CHECK(0U == sim_can_stats()->au32FifoOverflow[0]);
+	SIM_CHECK(sim_can_gen_sent(u8Gen) == u32Loops);					/* Every frame moved by the DMA */
+	SIM_CHECK(0U == CanDmaStats.u32Overruns);
+	SIM_CHECK((u32Loops / TEST_HALF) == CanDmaStats.u32Blocks);		/* Half and major loop interrupts */
+	SIM_CHECK(CanDmaStats.u32Blocks == u32Irqs);
+	SIM_CHECK((u32Loops % TEST_HALF) == can_dma_pending());
+	SIM_CHECK(TEST_HALF * CanDmaStats.u32Blocks == s_u32Received);
+	SIM_CHECK(0U == s_u32Gaps);
+	SIM_CHECK(0U == (sim_can_stats()->u32IrqStorms));
+}
+
+/**
+* @brief            Late DMA interrupt: the position tells the completed half until the other half is
+*					written over, then one overrun is counted and one half is lost.
+*/
+static void test_overrun(void)
+{
+	uint8_t u8Gen = 0U;
+
+	test_setup();
+	u8Gen = test_start_load();
+	test_run_until(2U * TEST_HALF);
+	test_irq_off(TEST_LATE_FRAMES);
+
+	(void)printf("test_can_dma: DMA interrupt off for %u frames: %u overruns, %u frames lost\n",
+				 TEST_LATE_FRAMES, CanDmaStats.u32Overruns, s_u32GapFrames);
+
+	SIM_CHECK(0U == CanDmaStats.u32Overruns);
+	SIM_CHECK(0U == s_u32Gaps);
+
+	test_irq_off(TEST_LOST_FRAMES);
+	sim_can_gen_stop(u8Gen);
+
+	(void)printf("test_can_dma: DMA interrupt off for %u frames: %u overruns, %u frames lost\n",
+				 TEST_LOST_FRAMES, CanDmaStats.u32Overruns, s_u32GapFrames);
+
+	SIM_CHECK(0U == sim_can_stats()->au32FifoOverflow[0]);
+	SIM_CHECK(1U == CanDmaStats.u32Overruns);
+	SIM_CHECK(1U == s_u32Gaps);
+	SIM_CHECK(TEST_HALF == s_u32GapFrames);							/* The half written over */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_full_load();
+	test_overrun();
+
+	return sim_check_result("test_can_dma");
+}
+
+
+/* END test_can_dma */
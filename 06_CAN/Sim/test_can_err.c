@@ -0,0 +1,362 @@
+/**
+* @file			test_can_err.c
+* @brief		Host test of the error handling (can_err.c) on the register model
+* @details		Error frames drive CAN0 through warning and error passive, frames without error bring it
+*				back to error active. Bus off with automatic and manual (BOFFREC=1) recovery, the recovery
+*				time, and the re-arm of an overrun receive MB. The CAN0 interrupts are the handlers of
+*				main.c, built with SIM_CAN (MB mode).
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "main.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* State changes kept by the callback */
+#define TEST_LOG_SIZE			(16U)
+
+/* Bus off recovery: 128 x 11 recessive bits, in bit times; allowed delay of the interrupt */
+#define TEST_RECOVERY			(128U * 11U)
+#define TEST_RECOVERY_TOL		(2U)
+
+/* Receive MB of 0x511 (FLEXCAN0_RX_MB_MASK) */
+#define TEST_RX_MB				(4U)
+
+/* Manual recovery: time bus off before can_err_recover() */
+#define TEST_HOLD_MS			(10U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* States reported by the callback */
+static uint8_t s_au8State[TEST_LOG_SIZE];
+static uint32_t s_u32StateCount;
+
+/* Start of the first CAN0 frame on bus 0 */
+static uint64_t s_u64FirstTx;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_state(uint8_t u8State);
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_setup(uint8_t u8Recovery);
+static uint8_t test_mb_code(uint8_t u8Mb);
+static void test_bus_off(void);
+static void test_passive(void);
+static void test_receive_passive(void);
+static void test_auto_recovery(void);
+static void test_manual_recovery(void);
+static void test_overrun(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            State change callback: log the state.
+*/
+static void test_state(uint8_t u8State)
+{
+	if (s_u32StateCount < TEST_LOG_SIZE)
+	{
+		s_au8State[s_u32StateCount] = u8State;
+	}
+	s_u32StateCount++;
+}
+
+/**
+* @brief            Bus monitor: start of the first CAN0 frame.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	(void)pFrame;
+	(void)u64End;
+	if ((0U == u8Bus) && (0U == u8Src) && (0U == s_u64FirstTx))
+	{
+		s_u64FirstTx = u64Start;
+	}
+}
+
+/**
+* @brief            CAN0 as in main.c: MB4 receives, MB8-11 transmit, time base, error interrupts.
+*/
+static void test_setup(uint8_t u8Recovery)
+{
+	sim_can_init();
+	FLEXCAN0_init();
+	can_ring_init(&CanRxRing);
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);
+	can_stats_init();
+	can_tx_init(NULL);
+
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), CAN0_ORed_0_15_MB_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_ORED(0U), CAN0_ORed_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_ERROR(0U), CAN0_Error_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_LPIT0_CH0, LPIT0_Ch0_IRQHandler);
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	S32_NVIC->IP[81] = 0x8U;
+	can_time_init();
+	can_err_init(u8Recovery, test_state);
+
+	sim_can_monitor(test_monitor);
+	s_u32StateCount = 0U;
+	s_u64FirstTx = 0U;
+}
+
+/**
+* @brief            CODE field of a CAN0 MB, read without locking it.
+*/
+static uint8_t test_mb_code(uint8_t u8Mb)
+{
+	return (uint8_t)((sim_can_regs(0U)->RAMn[(uint32_t)u8Mb * 4U] & FLEXCAN_MB_CS_CODE_MASK) >> FLEXCAN_MB_CS_CODE_SHIFT);
+}
+
+/**
+* @brief            Transmit errors until CAN0 goes bus off (TEC above 255).
+*/
+static void test_bus_off(void)
+{
+	sim_can_error(0U, CAN_ESR1_BIT1ERR_MASK, 256, 0);
+	sim_can_run(SIM_CAN_US(10U));
+}
+
+/**
+* @brief            Error frames: warning at 96, error passive at 128, counted per type. Frames without
+*					error lower TEC until can_err_poll() reports warning and error active again.
+*/
+static void test_passive(void)
+{
+	static const uint32_t au32Esr1[4] = {CAN_ESR1_STFERR_MASK, CAN_ESR1_CRCERR_MASK, CAN_ESR1_ACKERR_MASK, CAN_ESR1_BIT0ERR_MASK};
+	static const uint8_t au8Data[8] = {0U};
+	uint32_t u32Index = 0U;
+	uint32_t u32Sent = 0U;
+
+	test_setup(CAN_ERR_RECOVER_AUTO);
+	for (u32Index = 0U; u32Index < 11U; u32Index++)		/* TEC 88 */
+	{
+		sim_can_error(0U, au32Esr1[u32Index % 4U], 8, 0);
+		sim_can_run(SIM_CAN_US(10U));
+	}
+	SIM_CHECK(CAN_ERR_ACTIVE == CanErr.u8State);
+	SIM_CHECK(0U == s_u32StateCount);
+	SIM_CHECK(11U == CanErr.u32ErrorFrames);
+	SIM_CHECK(3U == CanErr.u32StuffErrors);
+	SIM_CHECK(3U == CanErr.u32CrcErrors);
+	SIM_CHECK(3U == CanErr.u32AckErrors);
+	SIM_CHECK(2U == CanErr.u32BitErrors);
+	SIM_CHECK(0U == CanErr.u32ErrorOverruns);
+
+	sim_can_error(0U, CAN_ESR1_FRMERR_MASK, 8, 0);		/* TEC 96: TWRNINT */
+	sim_can_run(SIM_CAN_US(10U));
+	SIM_CHECK(CAN_ERR_WARNING == CanErr.u8State);
+	SIM_CHECK(1U == CanErr.u32Warnings);
+	SIM_CHECK(1U == CanErr.u32FormErrors);
+
+	sim_can_error(0U, CAN_ESR1_BIT0ERR_MASK, 8, 0);		/* Two errors before the interrupt: ERROVR */
+	sim_can_error(0U, CAN_ESR1_BIT0ERR_MASK, 8, 0);
+	sim_can_run(SIM_CAN_US(10U));
+	sim_can_error(0U, CAN_ESR1_BIT0ERR_MASK, 8, 0);		/* TEC 120 */
+	sim_can_run(SIM_CAN_US(10U));
+	SIM_CHECK(CAN_ERR_WARNING == CanErr.u8State);
+	SIM_CHECK(1U == CanErr.u32ErrorOverruns);
+	SIM_CHECK(14U == CanErr.u32ErrorFrames);
+
+	sim_can_error(0U, CAN_ESR1_ACKERR_MASK, 8, 0);		/* TEC 128 */
+	sim_can_run(SIM_CAN_US(10U));
+	SIM_CHECK(CAN_ERR_PASSIVE == CanErr.u8State);
+	SIM_CHECK(1U == ((sim_can_regs(0U)->ESR1 & CAN_ESR1_FLTCONF_MASK) >> CAN_ESR1_FLTCONF_SHIFT));
+	SIM_CHECK(2U == s_u32StateCount);
+
+	for (u32Index = 0U; (u32Index < 40U) && (CAN_ERR_ACTIVE != can_err_poll()); u32Index++)
+	{
+		u32Sent += can_send(0x100U, au8Data, 8U);		/* Each frame lowers TEC by 1 */
+		sim_can_run(SIM_CAN_US(400U));
+	}
+	SIM_CHECK(33U == u32Sent);							/* TEC 95 */
+	SIM_CHECK(0U == CanErr.u32BusOff);
+	SIM_CHECK(4U == s_u32StateCount);
+	SIM_CHECK((CAN_ERR_WARNING == s_au8State[0]) && (CAN_ERR_PASSIVE == s_au8State[1])
+			  && (CAN_ERR_WARNING == s_au8State[2]) && (CAN_ERR_ACTIVE == s_au8State[3]));
+	SIM_CHECK(0U == sim_can_stats()->u32IrqStorms);
+}
+
+/**
+* @brief            Receive errors: error passive at REC 128, one frame received without error sets REC
+*					back to 127, below error passive.
+*/
+static void test_receive_passive(void)
+{
+	sim_can_frame_t frame;
+
+	test_setup(CAN_ERR_RECOVER_AUTO);
+	sim_can_error(0U, CAN_ESR1_STFERR_MASK, 0, 128);
+	sim_can_run(SIM_CAN_US(10U));
+	SIM_CHECK(CAN_ERR_PASSIVE == CanErr.u8State);
+	SIM_CHECK(1U == CanErr.u32Warnings);				/* RWRNINT */
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = 0x511U;
+	frame.u8Length = 8U;
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now()));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(127U == ((sim_can_regs(0U)->ECR & CAN_ECR_RXERRCNT_MASK) >> CAN_ECR_RXERRCNT_SHIFT));
+	SIM_CHECK(CAN_ERR_WARNING == can_err_poll());
+	SIM_CHECK(1U == can_ring_count(&CanRxRing));
+}
+
+/**
+* @brief            Automatic recovery: back to error active 128 x 11 bit times after bus off, a frame
+*					sent while bus off leaves after the recovery.
+*/
+static void test_auto_recovery(void)
+{
+	static const uint8_t au8Data[8] = {0U};
+	uint64_t u64BusOff = 0U;
+
+	test_setup(CAN_ERR_RECOVER_AUTO);
+	u64BusOff = sim_can_now();
+	test_bus_off();
+	SIM_CHECK(CAN_ERR_BUS_OFF == CanErr.u8State);
+	SIM_CHECK(1U == CanErr.u32BusOff);
+	SIM_CHECK(0U == CanErr.u32Recoveries);
+	SIM_CHECK(2U == ((sim_can_regs(0U)->ESR1 & CAN_ESR1_FLTCONF_MASK) >> CAN_ESR1_FLTCONF_SHIFT));
+	SIM_CHECK(0U == can_err_recover());					/* Automatic: nothing to start */
+	SIM_CHECK(1U == can_send(0x123U, au8Data, 8U));
+
+	sim_can_run(SIM_CAN_MS(5U));
+	SIM_CHECK(CAN_ERR_ACTIVE == CanErr.u8State);
+	SIM_CHECK(1U == CanErr.u32Recoveries);
+	SIM_CHECK((CanErr.u64LastRecovery >= TEST_RECOVERY) && (CanErr.u64LastRecovery <= (TEST_RECOVERY + TEST_RECOVERY_TOL)));
+	SIM_CHECK(CanErr.u64MaxRecovery == CanErr.u64LastRecovery);
+	SIM_CHECK(0U == (sim_can_regs(0U)->ECR & CAN_ECR_TXERRCNT_MASK));
+	SIM_CHECK(s_u64FirstTx >= (u64BusOff + (uint64_t)TEST_RECOVERY * sim_can_bit_ticks(0U, 0U)));
+	SIM_CHECK(2U == s_u32StateCount);					/* Passive and warning are skipped */
+	SIM_CHECK((CAN_ERR_BUS_OFF == s_au8State[0]) && (CAN_ERR_ACTIVE == s_au8State[1]));
+
+	(void)printf("test_can_err: bus off to error active %u bit times (%.3f ms)\n",
+				 (unsigned int)CanErr.u64LastRecovery, 1000.0 * (double)CanErr.u64LastRecovery / (double)FLEXCAN0_BITRATE);
+}
+
+/**
+* @brief            Manual recovery: bus off until can_err_recover(), then 128 x 11 bit times. BOFFREC
+*					is set again, so the next bus off is held as well.
+*/
+static void test_manual_recovery(void)
+{
+	uint64_t u64Hold = 0U;
+
+	test_setup(CAN_ERR_RECOVER_MANUAL);
+	SIM_CHECK(0U == can_err_recover());					/* Not bus off */
+	test_bus_off();
+	sim_can_run(SIM_CAN_MS(TEST_HOLD_MS));
+	SIM_CHECK(CAN_ERR_BUS_OFF == can_err_poll());
+	SIM_CHECK(0U == CanErr.u32Recoveries);
+
+	u64Hold = can_time_now() - CanErr.u64BusOffTime;
+	SIM_CHECK(1U == can_err_recover());
+	SIM_CHECK(0U == (sim_can_regs(0U)->CTRL1 & CAN_CTRL1_BOFFREC_MASK));
+	sim_can_run(SIM_CAN_MS(5U));
+	SIM_CHECK(CAN_ERR_ACTIVE == CanErr.u8State);
+	SIM_CHECK(1U == CanErr.u32Recoveries);
+	SIM_CHECK((CanErr.u64LastRecovery >= (u64Hold + TEST_RECOVERY))
+			  && (CanErr.u64LastRecovery <= (u64Hold + TEST_RECOVERY + TEST_RECOVERY_TOL)));
+	SIM_CHECK(0U != (sim_can_regs(0U)->CTRL1 & CAN_CTRL1_BOFFREC_MASK));
+	SIM_CHECK(0U == can_err_recover());
+
+	test_bus_off();										/* Held again */
+	sim_can_run(SIM_CAN_MS(TEST_HOLD_MS));
+	SIM_CHECK(CAN_ERR_BUS_OFF == can_err_poll());
+	SIM_CHECK(2U == CanErr.u32BusOff);
+	SIM_CHECK(1U == CanErr.u32Recoveries);
+	SIM_CHECK(CanErr.u64MaxRecovery >= CanErr.u64LastRecovery);
+}
+
+/**
+* @brief            MB overrun: with the MB interrupt off, three frames reach MB4. The interrupt reads
+*					MB4 with CODE=OVERRUN and re-arms it, the next frame is received without overrun and
+*					without waiting for a TIMER read.
+*/
+static void test_overrun(void)
+{
+	sim_can_frame_t frame;
+	can_frame_t rx;
+	uint32_t u32Index = 0U;
+
+	test_setup(CAN_ERR_RECOVER_AUTO);
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = 0x511U;
+	frame.u8Length = 8U;
+
+	S32_NVIC->ICER[2] = 1U << (81 % 32);				/* MB interrupt late */
+	for (u32Index = 0U; u32Index < 3U; u32Index++)
+	{
+		frame.au8Data[0] = (uint8_t)u32Index;
+		SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now()));
+	}
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(2U == sim_can_stats()->au32RxOverrun[0]);
+	SIM_CHECK(FLEXCAN_RX_OVERRUN == test_mb_code(TEST_RX_MB));
+
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	sim_can_run(SIM_CAN_US(10U));
+	SIM_CHECK(1U == CanErr.u32MbOverruns);
+	SIM_CHECK(FLEXCAN_RX_EMPTY == test_mb_code(TEST_RX_MB));
+	SIM_CHECK(1U == can_ring_pop(&CanRxRing, &rx));
+	SIM_CHECK(2U == (rx.u32Data[0] >> 24U));			/* The last frame overwrote the others */
+
+	frame.au8Data[0] = 3U;
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now()));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == can_ring_pop(&CanRxRing, &rx));
+	SIM_CHECK(3U == (rx.u32Data[0] >> 24U));
+	SIM_CHECK(1U == CanErr.u32MbOverruns);
+	SIM_CHECK(2U == sim_can_stats()->au32RxOverrun[0]);
+	SIM_CHECK(FLEXCAN_RX_FULL == test_mb_code(TEST_RX_MB));		/* Read, takes the next frame */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_passive();
+	test_receive_passive();
+	test_auto_recovery();
+	test_manual_recovery();
+	test_overrun();
+
+	return sim_check_result("test_can_err");
+}
+
+
+/* END test_can_err */
@@ -0,0 +1,402 @@
+/**
+* @file			test_can_filter.c
+* @brief		Host test of the acceptance filter planner (can_filter.c)
+* @details		Merges against the best split of small ID sets found by trying every one, false accept
+*				counts against the IDs each filter really accepts, the 32 ID limit, duplicates, standard
+*				and extended IDs kept apart, and the planned filters on the controller: an ID sweep on
+*				the bus reaches the receive MBs exactly for the wanted IDs plus the counted false accepts.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "flexcan.h"
+#include "can_filter.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Random sets compared with the best split, IDs per set */
+#define TEST_SETS				(200U)
+#define TEST_SET_IDS			(8U)
+
+/* Most don't care bits the brute force count walks through */
+#define TEST_MAX_FREE			(16U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+static uint32_t s_u32Seed = 0x2468ACE1U;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint32_t test_rand(void);
+static uint8_t test_match(uint32_t u32Id, const can_filter_t *pFilter);
+static uint32_t test_count(const uint32_t *pu32Ids, uint8_t u8Count, const can_filter_t *pFilter);
+static uint32_t test_full(uint32_t u32Id);
+static uint32_t test_best(const uint32_t *pu32Ids, uint8_t u8Count, uint8_t u8Budget);
+static uint32_t test_check(const uint32_t *pu32Ids, uint8_t u8Count, const can_filter_t *pFilters, uint8_t u8Filters);
+static void test_example(void);
+static void test_optimal(void);
+static void test_limits(void);
+static void test_types(void);
+static void test_controller(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            xorshift32.
+*/
+static uint32_t test_rand(void)
+{
+	s_u32Seed ^= s_u32Seed << 13U;
+	s_u32Seed ^= s_u32Seed >> 17U;
+	s_u32Seed ^= s_u32Seed << 5U;
+	return s_u32Seed;
+}
+
+/**
+* @brief            Frame ID accepted by the filter, as the controller compares it (IDE always).
+*/
+static uint8_t test_match(uint32_t u32Id, const can_filter_t *pFilter)
+{
+	return (0U == ((u32Id ^ pFilter->u32Id) & (pFilter->u32Mask | CAN_ID_EXT_FLAG))) ? 1U : 0U;
+}
+
+/**
+* @brief            Full ID mask of an ID type.
+*/
+static uint32_t test_full(uint32_t u32Id)
+{
+	return (0U != (u32Id & CAN_ID_EXT_FLAG)) ? CAN_FILTER_EXT_MASK : CAN_FILTER_STD_MASK;
+}
+
+/**
+* @brief            Unwanted IDs accepted by the filter, every ID it accepts walked through.
+*/
+static uint32_t test_count(const uint32_t *pu32Ids, uint8_t u8Count, const can_filter_t *pFilter)
+{
+	uint32_t u32Free = test_full(pFilter->u32Id) & ~pFilter->u32Mask;
+	uint32_t u32Base = pFilter->u32Id & (pFilter->u32Mask | CAN_ID_EXT_FLAG);
+	uint32_t u32Sub = 0U;
+	uint32_t u32Id = 0U;
+	uint32_t u32False = 0U;
+	uint8_t u8Index = 0U;
+	uint8_t u8Wanted = 0U;
+
+	SIM_CHECK(__builtin_popcount(u32Free) <= (int)TEST_MAX_FREE);
+	do
+	{
+		u32Id = u32Base | u32Sub;
+		SIM_CHECK(1U == test_match(u32Id, pFilter));
+		u8Wanted = 0U;
+		for (u8Index = 0U; u8Index < u8Count; u8Index++)
+		{
+			u8Wanted |= (pu32Ids[u8Index] == u32Id) ? 1U : 0U;
+		}
+		u32False += (0U == u8Wanted) ? 1U : 0U;
+		u32Sub = (u32Sub - u32Free) & u32Free;				/* Next subset of the don't care bits */
+	} while (0U != u32Sub);
+
+	return u32False;
+}
+
+/**
+* @brief            Fewest false accepts of any split of the set into u8Budget filters, all splits tried.
+*/
+static uint32_t test_best(const uint32_t *pu32Ids, uint8_t u8Count, uint8_t u8Budget)
+{
+	uint8_t au8Group[TEST_SET_IDS];
+	uint32_t u32Best = 0xFFFFFFFFU;
+	uint32_t u32Total = 0U;
+	uint32_t u32Free = 0U;
+	uint32_t u32Index = 0U;
+	uint8_t u8Group = 0U;
+	uint8_t u8Index = 0U;
+	uint8_t u8First = 0U;
+	can_filter_t filter;
+
+	(void)memset(au8Group, 0, sizeof(au8Group));
+	for (;;)
+	{
+		u32Total = 0U;
+		for (u8Group = 0U; u8Group < u8Budget; u8Group++)
+		{
+			u8First = u8Count;
+			filter.u32Mask = CAN_FILTER_STD_MASK;
+			for (u8Index = 0U; u8Index < u8Count; u8Index++)
+			{
+				if (au8Group[u8Index] == u8Group)
+				{
+					u8First = (u8First == u8Count) ? u8Index : u8First;
+					filter.u32Mask &= ~(pu32Ids[u8Index] ^ pu32Ids[u8First]);
+				}
+			}
+			if (u8First == u8Count)
+			{
+				continue;									/* Unused filter */
+			}
+			filter.u32Id = pu32Ids[u8First];
+			u32Free = CAN_FILTER_STD_MASK & ~filter.u32Mask;
+			u32Total += 1UL << __builtin_popcount(u32Free);
+			for (u32Index = 0U; u32Index < u8Count; u32Index++)
+			{
+				u32Total -= test_match(pu32Ids[u32Index], &filter);
+			}
+		}
+		u32Best = (u32Total < u32Best) ? u32Total : u32Best;
+
+		for (u8Index = 0U; (u8Index < u8Count) && (++au8Group[u8Index] == u8Budget); u8Index++)
+		{
+			au8Group[u8Index] = 0U;							/* Next split, counting in base u8Budget */
+		}
+		if (u8Index == u8Count)
+		{
+			return u32Best;
+		}
+	}
+}
+
+/**
+* @brief            Every wanted ID accepted, each false accept count walked through; total false accepts.
+*/
+static uint32_t test_check(const uint32_t *pu32Ids, uint8_t u8Count, const can_filter_t *pFilters, uint8_t u8Filters)
+{
+	uint32_t u32Total = 0U;
+	uint8_t u8Accepted = 0U;
+	uint8_t u8Index = 0U;
+	uint8_t u8Filter = 0U;
+
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		u8Accepted = 0U;
+		for (u8Filter = 0U; u8Filter < u8Filters; u8Filter++)
+		{
+			u8Accepted |= test_match(pu32Ids[u8Index], &pFilters[u8Filter]);
+		}
+		SIM_CHECK(1U == u8Accepted);
+	}
+	for (u8Filter = 0U; u8Filter < u8Filters; u8Filter++)
+	{
+		SIM_CHECK(test_count(pu32Ids, u8Count, &pFilters[u8Filter]) == pFilters[u8Filter].u32FalseAccepts);
+		u32Total += pFilters[u8Filter].u32FalseAccepts;
+	}
+	return u32Total;
+}
+
+/**
+* @brief            The 06_CAN.md example: 0x100-0x103 and 0x511 in two filters.
+*/
+static void test_example(void)
+{
+	static const uint32_t au32Wanted[5] = {0x100U, 0x101U, 0x102U, 0x103U, 0x511U};
+	can_filter_t aFilters[2];
+
+	SIM_CHECK(2U == can_filter_plan(au32Wanted, 5U, 2U, aFilters));
+	SIM_CHECK((0x100U == aFilters[0].u32Id) && (0x7FCU == aFilters[0].u32Mask));
+	SIM_CHECK((0x511U == aFilters[1].u32Id) && (0x7FFU == aFilters[1].u32Mask));
+	SIM_CHECK(0U == test_check(au32Wanted, 5U, aFilters, 2U));
+
+	SIM_CHECK(0U == test_best(au32Wanted, 5U, 2U));
+
+	SIM_CHECK(1U == can_filter_plan(au32Wanted, 5U, 1U, aFilters));	/* 0x100/0x3EC: 16 IDs, 5 wanted */
+	SIM_CHECK((0x100U == aFilters[0].u32Id) && (0x3ECU == aFilters[0].u32Mask));
+	SIM_CHECK(11U == test_check(au32Wanted, 5U, aFilters, 1U));
+	SIM_CHECK(11U == test_best(au32Wanted, 5U, 1U));
+}
+
+/**
+* @brief            Random 8 ID sets in 2 and 3 filters against the best split. The merges are greedy, so
+*					the planner is checked never to beat the best split (false accepts counted right)
+*					and to stay within 1.5 times its false accepts over all sets.
+*/
+static void test_optimal(void)
+{
+	uint32_t au32Ids[TEST_SET_IDS];
+	can_filter_t aFilters[TEST_SET_IDS];
+	uint32_t au32Optimal[2] = {0U, 0U};
+	uint32_t au32Worst[2] = {0U, 0U};
+	uint32_t au32Plan[2] = {0U, 0U};
+	uint32_t au32Best[2] = {0U, 0U};
+	uint32_t u32Plan = 0U;
+	uint32_t u32Best = 0U;
+	uint32_t u32Set = 0U;
+	uint8_t u8Budget = 0U;
+	uint8_t u8Filters = 0U;
+	uint8_t u8Index = 0U;
+
+	for (u32Set = 0U; u32Set < TEST_SETS; u32Set++)
+	{
+		for (u8Index = 0U; u8Index < TEST_SET_IDS; u8Index++)		/* Clusters as in a DBC: two ID ranges */
+		{
+			au32Ids[u8Index] = ((0U != (test_rand() & 1U)) ? 0x100U : 0x400U) | (test_rand() & 0xFFU);
+		}
+		for (u8Budget = 2U; u8Budget <= 3U; u8Budget++)
+		{
+			u8Filters = can_filter_plan(au32Ids, TEST_SET_IDS, u8Budget, aFilters);
+			SIM_CHECK((0U != u8Filters) && (u8Filters <= u8Budget));
+			u32Plan = test_check(au32Ids, TEST_SET_IDS, aFilters, u8Filters);
+			u32Best = test_best(au32Ids, TEST_SET_IDS, u8Budget);
+			SIM_CHECK(u32Plan >= u32Best);
+			au32Optimal[u8Budget - 2U] += (u32Plan == u32Best) ? 1U : 0U;
+			au32Worst[u8Budget - 2U] = (u32Plan - u32Best > au32Worst[u8Budget - 2U]) ? (u32Plan - u32Best) : au32Worst[u8Budget - 2U];
+			au32Plan[u8Budget - 2U] += u32Plan;
+			au32Best[u8Budget - 2U] += u32Best;
+		}
+	}
+
+	for (u8Budget = 2U; u8Budget <= 3U; u8Budget++)
+	{
+		(void)printf("test_can_filter: %u IDs in %u filters: best split in %u of %u sets, %.1f false accepts (best %.1f), worst +%u\n",
+					 TEST_SET_IDS, u8Budget, au32Optimal[u8Budget - 2U], TEST_SETS,
+					 (double)au32Plan[u8Budget - 2U] / TEST_SETS, (double)au32Best[u8Budget - 2U] / TEST_SETS,
+					 au32Worst[u8Budget - 2U]);
+		SIM_CHECK((2U * au32Plan[u8Budget - 2U]) <= (3U * au32Best[u8Budget - 2U]));
+		SIM_CHECK(au32Optimal[u8Budget - 2U] >= (TEST_SETS / 3U));
+	}
+}
+
+/**
+* @brief            1 to 32 IDs, 33 and 0 refused, duplicates counted once, exact filters when they fit.
+*/
+static void test_limits(void)
+{
+	uint32_t au32Ids[CAN_FILTER_MAX_IDS + 1U];
+	can_filter_t aFilters[CAN_FILTER_MAX_IDS];
+	uint8_t u8Index = 0U;
+	uint8_t u8Filters = 0U;
+
+	for (u8Index = 0U; u8Index <= CAN_FILTER_MAX_IDS; u8Index++)
+	{
+		au32Ids[u8Index] = 0x200U + 3U * u8Index;
+	}
+	SIM_CHECK(0U == can_filter_plan(au32Ids, 0U, 4U, aFilters));
+	SIM_CHECK(0U == can_filter_plan(au32Ids, CAN_FILTER_MAX_IDS + 1U, CAN_FILTER_MAX_IDS, aFilters));
+
+	SIM_CHECK(CAN_FILTER_MAX_IDS == can_filter_plan(au32Ids, CAN_FILTER_MAX_IDS, CAN_FILTER_MAX_IDS, aFilters));
+	SIM_CHECK(0U == test_check(au32Ids, CAN_FILTER_MAX_IDS, aFilters, CAN_FILTER_MAX_IDS));
+	for (u8Index = 1U; u8Index <= 8U; u8Index++)
+	{
+		u8Filters = can_filter_plan(au32Ids, CAN_FILTER_MAX_IDS, u8Index, aFilters);
+		SIM_CHECK((0U != u8Filters) && (u8Filters <= u8Index));
+		(void)test_check(au32Ids, CAN_FILTER_MAX_IDS, aFilters, u8Filters);
+	}
+
+	for (u8Index = 0U; u8Index < CAN_FILTER_MAX_IDS; u8Index++)		/* 4 IDs, 8 times each */
+	{
+		au32Ids[u8Index] = 0x300U + (u8Index & 3U) * 0x40U;
+	}
+	SIM_CHECK(4U == can_filter_plan(au32Ids, CAN_FILTER_MAX_IDS, 4U, aFilters));
+	SIM_CHECK(0U == test_check(au32Ids, CAN_FILTER_MAX_IDS, aFilters, 4U));
+	SIM_CHECK(1U == can_filter_plan(au32Ids, CAN_FILTER_MAX_IDS, 1U, aFilters));	/* 0x300/0x73F: 4 IDs */
+	SIM_CHECK(0U == test_check(au32Ids, CAN_FILTER_MAX_IDS, aFilters, 1U));
+}
+
+/**
+* @brief            Standard and extended IDs never share a filter, extended counts walked through.
+*/
+static void test_types(void)
+{
+	static const uint32_t au32Wanted[6] =
+	{
+		0x100U, 0x101U,
+		0x18FF0001U | CAN_ID_EXT_FLAG, 0x18FF0002U | CAN_ID_EXT_FLAG,
+		0x18FF0103U | CAN_ID_EXT_FLAG, 0x18FF0104U | CAN_ID_EXT_FLAG
+	};
+	static const uint32_t au32Same[2] = {0x0FFU, 0x0FFU | CAN_ID_EXT_FLAG};	/* Same ID bits */
+	can_filter_t aFilters[6];
+
+	SIM_CHECK(0U == can_filter_plan(au32Wanted, 6U, 1U, aFilters));
+	SIM_CHECK(2U == can_filter_plan(au32Wanted, 6U, 2U, aFilters));
+	SIM_CHECK(0U != ((aFilters[0].u32Id ^ aFilters[1].u32Id) & CAN_ID_EXT_FLAG));	/* One of each */
+	(void)test_check(au32Wanted, 6U, aFilters, 2U);
+	SIM_CHECK(3U == can_filter_plan(au32Wanted, 6U, 3U, aFilters));
+	(void)test_check(au32Wanted, 6U, aFilters, 3U);
+
+	SIM_CHECK(0U == can_filter_plan(au32Same, 2U, 1U, aFilters));
+	SIM_CHECK(2U == can_filter_plan(au32Same, 2U, 2U, aFilters));
+	SIM_CHECK(0U == test_check(au32Same, 2U, aFilters, 2U));
+}
+
+/**
+* @brief            Planned filters in MB4-MB7: every standard ID from 0x000 to 0x7FF sent once, the MBs
+*					receive the wanted IDs and exactly the false accepts the planner counted.
+*/
+static void test_controller(void)
+{
+	static const uint32_t au32Wanted[10] = {0x100U, 0x101U, 0x102U, 0x103U, 0x108U, 0x20AU, 0x20EU, 0x511U, 0x513U, 0x7F0U};
+	can_filter_t aFilters[4];
+	sim_can_frame_t frame;
+	uint32_t u32Expected = 0U;
+	uint32_t u32Id = 0U;
+	uint8_t u8Filters = 0U;
+	uint8_t u8Index = 0U;
+
+	u8Filters = can_filter_plan(au32Wanted, 10U, 4U, aFilters);
+	SIM_CHECK(4U == u8Filters);
+	u32Expected = 10U + test_check(au32Wanted, 10U, aFilters, u8Filters);
+
+	sim_can_init();
+	SIM_CHECK(0U == FLEXCAN0_init_rx_filters(aFilters, u8Filters, 5U));	/* MB8 would be reached */
+	SIM_CHECK(0xF0U == FLEXCAN0_init_rx_filters(aFilters, u8Filters, 4U));
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u8Length = 1U;
+	for (u32Id = 0U; u32Id <= CAN_FILTER_STD_MASK; u32Id++)
+	{
+		frame.u32Id = u32Id;
+		while (0U == sim_can_inject(0U, &frame, 0U))
+		{
+			(void)sim_can_run_idle(SIM_CAN_MS(100U));
+		}
+	}
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1000U)));
+
+	(void)printf("test_can_filter: %u IDs in %u MBs, %u of 2048 standard IDs received (%u expected)\n",
+				 10U, u8Filters, sim_can_stats()->au32RxFrames[0], u32Expected);
+	SIM_CHECK(u32Expected == sim_can_stats()->au32RxFrames[0]);
+	for (u8Index = 0U; u8Index < u8Filters; u8Index++)
+	{
+		SIM_CHECK(FLEXCAN_MB_ID(aFilters[u8Index].u32Mask) == sim_can_regs(0U)->RXIMR[4U + u8Index]);
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+int main(void)
+{
+	test_example();
+	test_optimal();
+	test_limits();
+	test_types();
+	test_controller();
+
+	return sim_check_result("test_can_filter");
+}
+
+/* END test_can_filter */
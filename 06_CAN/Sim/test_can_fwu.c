@@ -0,0 +1,547 @@
+/**
+* @file			test_can_fwu.c
+* @brief		Host test of the 07_CANFD firmware update (can_fwu.c, ftfc.c) on the register and flash model
+* @details		The node runs FLEXCAN0_init() and can_fwu_poll() as from the main loop of main.c
+*				(FWU_MODE), every TEST_NODE_POLL_US. The host side is Tools/can_fwu_send.c itself: its
+*				SocketCAN calls, clock and image file are redirected to bus 0 of the model, model time
+*				and an image in RAM. It runs as a coroutine that wakes up at the end of each response
+*				frame, also while the node waits for a flash command, so the data frames overlap the
+*				programming as on the bus. START to VERIFY response: image throughput, with the
+*				typical flash times of the model and no CPU time on the node.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include "sim_can.h"
+#include "flexcan_fd.h"
+#include "can_fwu.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Node main loop period */
+#define TEST_NODE_POLL_US		(10U)
+
+/* Image: size, and sectors and phrases it takes */
+#define TEST_IMAGE_SIZE			(64U * 1024U)
+#define TEST_IMAGE_SECTORS		(TEST_IMAGE_SIZE / FTFC_SECTOR_SIZE)
+#define TEST_IMAGE_PHRASES		(TEST_IMAGE_SIZE / FTFC_PHRASE_SIZE)
+
+/* Host turnaround that makes the bus the limit (the documented bound is about 270 us) */
+#define TEST_SLOW_HOST_US		(400U)
+
+/* Image byte corrupted between the host file and the bus, in the CRC case */
+#define TEST_CORRUPT_OFFSET		(1000U)
+
+/* Response frames kept for the host */
+#define TEST_RESP_COUNT			(4U)
+
+/* Stack of the host coroutine */
+#define TEST_HOST_STACK			(256U * 1024U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Image file of the host */
+static uint8_t s_au8Image[TEST_IMAGE_SIZE];
+
+/* Host coroutine: contexts, stack, arguments, exit code */
+static ucontext_t s_HostCtx;
+static ucontext_t s_NodeCtx;
+static uint8_t s_au8HostStack[TEST_HOST_STACK];
+static char *s_apcHostArgs[5];
+static int s_iHostResult;
+static uint8_t s_u8HostDone;
+
+/* Host in poll(): until a response arrives or the deadline */
+static uint8_t s_u8HostWaiting;
+static uint64_t s_u64HostDeadline;
+
+/* Responses not read yet */
+static sim_can_frame_t s_aResp[TEST_RESP_COUNT];
+static uint32_t s_u32RespCount;
+
+/* Host side: turnaround, data bytes sent, image byte to corrupt (TEST_IMAGE_SIZE: none) */
+static uint64_t s_u64Turnaround;
+static uint32_t s_u32DataSent;
+static uint32_t s_u32CorruptOffset;
+
+/* Model time of the START and VERIFY responses */
+static uint64_t s_u64StartResp;
+static uint64_t s_u64VerifyResp;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static int test_socket(int iDomain, int iType, int iProtocol);
+static int test_ioctl(int iFd, unsigned long ulRequest, struct ifreq *pIfr);
+static int test_setsockopt(int iFd, int iLevel, int iName, const void *pvValue, socklen_t uLength);
+static int test_bind(int iFd, const struct sockaddr *pAddr, socklen_t uLength);
+static ssize_t test_write(int iFd, const void *pvBuf, size_t uCount);
+static ssize_t test_read(int iFd, void *pvBuf, size_t uCount);
+static int test_poll(struct pollfd *pFds, nfds_t uCount, int iTimeoutMs);
+static int test_close(int iFd);
+static int test_clock_gettime(clockid_t iClock, struct timespec *pTs);
+static FILE *test_fopen(const char *pcPath, const char *pcMode);
+static int can_fwu_send_main(int argc, char **argv);
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_host_entry(void);
+static int test_send(uint32_t u32Addr);
+static void test_setup(void);
+static double test_kib_s(void);
+static void test_ftfc(void);
+static void test_update(void);
+static void test_slow_host(void);
+static void test_bad_range(void);
+static void test_crc_mismatch(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/* Tools/can_fwu_send.c, its main() as can_fwu_send_main(), system calls to the wrappers below */
+#define socket(d, t, p)				test_socket(d, t, p)
+#define ioctl(f, r, a)				test_ioctl(f, r, a)
+#define setsockopt(f, l, n, v, s)	test_setsockopt(f, l, n, v, s)
+#define bind(f, a, s)				test_bind(f, a, s)
+#define write(f, b, n)				test_write(f, b, n)
+#define read(f, b, n)				test_read(f, b, n)
+#define poll(p, n, t)				test_poll(p, n, t)
+#define close(f)					test_close(f)
+#define clock_gettime(c, t)			test_clock_gettime(c, t)
+#define fopen(p, m)					test_fopen(p, m)
+#define main						can_fwu_send_main
+#include "can_fwu_send.c"
+#undef main
+#undef socket
+#undef ioctl
+#undef setsockopt
+#undef bind
+#undef write
+#undef read
+#undef poll
+#undef close
+#undef clock_gettime
+#undef fopen
+
+/**
+* @brief            socket(): the bus.
+*/
+static int test_socket(int iDomain, int iType, int iProtocol)
+{
+	(void)iDomain;
+	(void)iType;
+	(void)iProtocol;
+	return 3;
+}
+
+/**
+* @brief            ioctl(SIOCGIFINDEX): interface 1.
+*/
+static int test_ioctl(int iFd, unsigned long ulRequest, struct ifreq *pIfr)
+{
+	(void)iFd;
+	(void)ulRequest;
+	pIfr->ifr_ifindex = 1;
+	return 0;
+}
+
+/**
+* @brief            setsockopt(): FD frames and the response filter, applied in test_monitor().
+*/
+static int test_setsockopt(int iFd, int iLevel, int iName, const void *pvValue, socklen_t uLength)
+{
+	(void)iFd;
+	(void)iLevel;
+	(void)iName;
+	(void)pvValue;
+	(void)uLength;
+	return 0;
+}
+
+/**
+* @brief            bind().
+*/
+static int test_bind(int iFd, const struct sockaddr *pAddr, socklen_t uLength)
+{
+	(void)iFd;
+	(void)pAddr;
+	(void)uLength;
+	return 0;
+}
+
+/**
+* @brief            write(): the frame goes on bus 0 after the host turnaround.
+*/
+static ssize_t test_write(int iFd, const void *pvBuf, size_t uCount)
+{
+	const struct canfd_frame *pFd = (const struct canfd_frame *)pvBuf;
+	sim_can_frame_t frame;
+
+	(void)iFd;
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = pFd->can_id & CAN_SFF_MASK;
+	frame.u8Length = pFd->len;
+	frame.u8Flags = SIM_CAN_FDF | ((0U != (pFd->flags & CANFD_BRS)) ? SIM_CAN_BRS : 0U);
+	(void)memcpy(frame.au8Data, pFd->data, pFd->len);
+
+	if (CAN_FWU_DATA_ID == frame.u32Id)
+	{
+		if ((s_u32CorruptOffset >= s_u32DataSent) && (s_u32CorruptOffset < (s_u32DataSent + CAN_FWU_CHUNK)))
+		{
+			frame.au8Data[s_u32CorruptOffset - s_u32DataSent] ^= 0x01U;	/* Before the CAN CRC */
+		}
+		s_u32DataSent += CAN_FWU_CHUNK;
+	}
+
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now() + s_u64Turnaround));
+	return (ssize_t)uCount;
+}
+
+/**
+* @brief            read(): oldest response.
+*/
+static ssize_t test_read(int iFd, void *pvBuf, size_t uCount)
+{
+	struct canfd_frame *pFd = (struct canfd_frame *)pvBuf;
+
+	(void)iFd;
+	if ((0U == s_u32RespCount) || (uCount < sizeof(*pFd)))
+	{
+		return -1;
+	}
+	(void)memset(pFd, 0, sizeof(*pFd));
+	pFd->can_id = s_aResp[0].u32Id;
+	pFd->len = s_aResp[0].u8Length;
+	(void)memcpy(pFd->data, s_aResp[0].au8Data, s_aResp[0].u8Length);
+	s_u32RespCount--;
+	(void)memmove(&s_aResp[0], &s_aResp[1], s_u32RespCount * sizeof(s_aResp[0]));
+	return (ssize_t)sizeof(*pFd);
+}
+
+/**
+* @brief            poll(): back to the node until a response arrives or the timeout passes.
+*/
+static int test_poll(struct pollfd *pFds, nfds_t uCount, int iTimeoutMs)
+{
+	(void)uCount;
+	if (0U == s_u32RespCount)
+	{
+		s_u64HostDeadline = sim_can_now() + SIM_CAN_MS(iTimeoutMs);
+		s_u8HostWaiting = 1U;
+		(void)swapcontext(&s_HostCtx, &s_NodeCtx);
+	}
+	pFds->revents = (0U != s_u32RespCount) ? POLLIN : 0;
+	return (0U != s_u32RespCount) ? 1 : 0;
+}
+
+/**
+* @brief            close().
+*/
+static int test_close(int iFd)
+{
+	(void)iFd;
+	return 0;
+}
+
+/**
+* @brief            clock_gettime(): model time.
+*/
+static int test_clock_gettime(clockid_t iClock, struct timespec *pTs)
+{
+	uint64_t u64Now = sim_can_now();
+
+	(void)iClock;
+	pTs->tv_sec = (time_t)(u64Now / SIM_CAN_TICK_HZ);
+	pTs->tv_nsec = (long)((u64Now % SIM_CAN_TICK_HZ) * 1000000000ULL / SIM_CAN_TICK_HZ);
+	return 0;
+}
+
+/**
+* @brief            fopen(): the image in RAM.
+*/
+static FILE *test_fopen(const char *pcPath, const char *pcMode)
+{
+	(void)pcPath;
+	(void)pcMode;
+	return fmemopen(s_au8Image, sizeof(s_au8Image), "rb");
+}
+
+/**
+* @brief            Bus monitor: node responses to the host, which runs at once if it waits for one.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	(void)u8Bus;
+	(void)u64Start;
+	if ((0U != u8Src) || (CAN_FWU_RESP_ID != pFrame->u32Id))
+	{
+		return;
+	}
+	if ((CAN_FWU_CMD_START | CAN_FWU_RESP) == pFrame->au8Data[0])
+	{
+		s_u64StartResp = u64End;
+	}
+	if ((CAN_FWU_CMD_VERIFY | CAN_FWU_RESP) == pFrame->au8Data[0])
+	{
+		s_u64VerifyResp = u64End;
+	}
+	SIM_CHECK(s_u32RespCount < TEST_RESP_COUNT);
+	if (s_u32RespCount < TEST_RESP_COUNT)
+	{
+		s_aResp[s_u32RespCount] = *pFrame;
+		s_u32RespCount++;
+	}
+	if (0U != s_u8HostWaiting)
+	{
+		s_u8HostWaiting = 0U;
+		(void)swapcontext(&s_NodeCtx, &s_HostCtx);
+	}
+}
+
+/**
+* @brief            Host coroutine.
+*/
+static void test_host_entry(void)
+{
+	s_iHostResult = can_fwu_send_main(4, s_apcHostArgs);
+	s_u8HostDone = 1U;
+}
+
+/**
+* @brief            can_fwu_send -a u32Addr image.bin against the node.
+* @return           Exit code of can_fwu_send.
+*/
+static int test_send(uint32_t u32Addr)
+{
+	static char acAddr[16];
+
+	(void)snprintf(acAddr, sizeof(acAddr), "0x%X", u32Addr);
+	s_apcHostArgs[0] = "can_fwu_send";
+	s_apcHostArgs[1] = "-a";
+	s_apcHostArgs[2] = acAddr;
+	s_apcHostArgs[3] = "image.bin";
+	s_apcHostArgs[4] = NULL;
+	s_u8HostDone = 0U;
+	s_u8HostWaiting = 0U;
+	s_u32RespCount = 0U;
+	s_u32DataSent = 0U;
+	s_u64StartResp = 0U;
+	s_u64VerifyResp = 0U;
+
+	(void)getcontext(&s_HostCtx);
+	s_HostCtx.uc_stack.ss_sp = s_au8HostStack;
+	s_HostCtx.uc_stack.ss_size = sizeof(s_au8HostStack);
+	s_HostCtx.uc_link = &s_NodeCtx;
+	makecontext(&s_HostCtx, test_host_entry, 0);
+	(void)swapcontext(&s_NodeCtx, &s_HostCtx);
+
+	while (0U == s_u8HostDone)
+	{
+		can_fwu_poll();
+		sim_can_run(SIM_CAN_US(TEST_NODE_POLL_US));
+		if ((0U != s_u8HostWaiting) && (sim_can_now() >= s_u64HostDeadline))
+		{
+			s_u8HostWaiting = 0U;
+			(void)swapcontext(&s_NodeCtx, &s_HostCtx);	/* Timeout */
+		}
+	}
+	(void)fflush(stdout);
+	return s_iHostResult;
+}
+
+/**
+* @brief            Node as with FWU_MODE, pseudo random image, fast host.
+*/
+static void test_setup(void)
+{
+	uint32_t u32Index = 0U;
+	uint32_t u32Random = 0x12345678U;
+
+	for (u32Index = 0U; u32Index < TEST_IMAGE_SIZE; u32Index++)
+	{
+		u32Random = u32Random * 1103515245U + 12345U;
+		s_au8Image[u32Index] = (uint8_t)(u32Random >> 16U);
+	}
+	sim_can_init();
+	FLEXCAN0_init();
+	can_fwu_init();
+	sim_can_monitor(test_monitor);
+	s_u64Turnaround = 0U;
+	s_u32CorruptOffset = TEST_IMAGE_SIZE;
+}
+
+/**
+* @brief            Image KiB/s from the START response to the VERIFY response.
+*/
+static double test_kib_s(void)
+{
+	return ((double)TEST_IMAGE_SIZE / 1024.0) * (double)SIM_CAN_TICK_HZ / (double)(s_u64VerifyResp - s_u64StartResp);
+}
+
+/**
+* @brief            Flash model through ftfc.c: erase and program times, protection, alignment.
+*/
+static void test_ftfc(void)
+{
+	static const uint8_t au8Phrase[FTFC_PHRASE_SIZE] = {0x01U, 0x23U, 0x45U, 0x67U, 0x89U, 0xABU, 0xCDU, 0xEFU};
+	static const uint8_t au8Zero[FTFC_PHRASE_SIZE] = {0U};
+	const volatile uint8_t *pu8Flash = (const volatile uint8_t *)(uintptr_t)CAN_FWU_REGION_START;
+	uint64_t u64Start = 0U;
+
+	sim_can_init();
+	u64Start = sim_can_now();
+	SIM_CHECK(0U == FTFC_program_phrase(CAN_FWU_REGION_START + 8U, au8Phrase));
+	SIM_CHECK(SIM_CAN_US(SIM_CAN_FLASH_PGM8_US) == (sim_can_now() - u64Start));
+	SIM_CHECK(0 == memcmp((const void *)(uintptr_t)(CAN_FWU_REGION_START + 8U), au8Phrase, FTFC_PHRASE_SIZE));
+	SIM_CHECK(0xFFU == pu8Flash[7]);
+	SIM_CHECK(0U == FTFC_program_phrase(CAN_FWU_REGION_START + 8U, au8Zero));
+	SIM_CHECK(1U == sim_can_stats()->u32FlashOverwrites);
+
+	u64Start = sim_can_now();
+	SIM_CHECK(0U == FTFC_erase_sector(CAN_FWU_REGION_START));
+	SIM_CHECK(SIM_CAN_US(SIM_CAN_FLASH_ERASE_US) == (sim_can_now() - u64Start));
+	SIM_CHECK((0xFFU == pu8Flash[8]) && (0xFFU == pu8Flash[FTFC_SECTOR_SIZE - 1U]));
+
+	SIM_CHECK(FTFC_FSTAT_FPVIOL_MASK == FTFC_erase_sector(0x00008000U));		/* Bootloader: protected */
+	SIM_CHECK(FTFC_FSTAT_ACCERR_MASK == FTFC_erase_sector(CAN_FWU_REGION_START + 0x100U));
+	SIM_CHECK(FTFC_FSTAT_ACCERR_MASK == FTFC_program_phrase(CAN_FWU_REGION_START + 4U, au8Phrase));
+	SIM_CHECK(FTFC_FSTAT_ACCERR_MASK == FTFC_erase_sector(FTFC_PFLASH_SIZE));	/* Refused by ftfc.c */
+	SIM_CHECK(0U == FTFC_erase_sector(CAN_FWU_REGION_START + FTFC_SECTOR_SIZE));	/* Errors cleared */
+	SIM_CHECK(2U == sim_can_stats()->u32FlashErases);
+	SIM_CHECK(2U == sim_can_stats()->u32FlashPrograms);
+}
+
+/**
+* @brief            64 KB image: programmed, verified, limited by the flash.
+*/
+static void test_update(void)
+{
+	double dKibS = 0.0;
+
+	test_setup();
+	SIM_CHECK(0 == test_send(CAN_FWU_REGION_START));
+	dKibS = test_kib_s();
+
+	(void)printf("test_can_fwu: %u KiB: erase %.1f ms, data and verify %.1f KiB/s (flash limit %.1f KiB/s)\n",
+				 TEST_IMAGE_SIZE / 1024U, 1000.0 * (double)s_u64StartResp / (double)SIM_CAN_TICK_HZ, dKibS,
+				 ((double)CAN_FWU_CHUNK / 1024.0) * 1e6 / (double)(8U * SIM_CAN_FLASH_PGM8_US));
+
+	SIM_CHECK(CAN_FWU_DONE == CanFwu.u8State);
+	SIM_CHECK(TEST_IMAGE_SIZE / CAN_FWU_CHUNK == CanFwu.u32Chunks);
+	SIM_CHECK(0 == memcmp((const void *)(uintptr_t)CAN_FWU_REGION_START, s_au8Image, TEST_IMAGE_SIZE));
+	SIM_CHECK(TEST_IMAGE_SECTORS == sim_can_stats()->u32FlashErases);
+	SIM_CHECK(TEST_IMAGE_PHRASES == sim_can_stats()->u32FlashPrograms);
+	SIM_CHECK(0U == sim_can_stats()->u32FlashOverwrites);
+	SIM_CHECK(0U == sim_can_stats()->au32RxOverrun[0]);
+	SIM_CHECK(s_u64StartResp >= SIM_CAN_US(TEST_IMAGE_SECTORS * SIM_CAN_FLASH_ERASE_US));
+	SIM_CHECK((dKibS > 80.0) && (dKibS < 87.0));
+}
+
+/**
+* @brief            Host turnaround above the programming slack: the bus is the limit again.
+*/
+static void test_slow_host(void)
+{
+	double dKibS = 0.0;
+
+	test_setup();
+	s_u64Turnaround = SIM_CAN_US(TEST_SLOW_HOST_US);
+	SIM_CHECK(0 == test_send(CAN_FWU_REGION_START));
+	dKibS = test_kib_s();
+
+	(void)printf("test_can_fwu: host turnaround %u us: %.1f KiB/s\n", TEST_SLOW_HOST_US, dKibS);
+
+	SIM_CHECK(CAN_FWU_DONE == CanFwu.u8State);
+	SIM_CHECK(0 == memcmp((const void *)(uintptr_t)CAN_FWU_REGION_START, s_au8Image, TEST_IMAGE_SIZE));
+	SIM_CHECK((dKibS > 60.0) && (dKibS < 80.0));
+}
+
+/**
+* @brief            Image in the bootloader or past the end of P-Flash: START refused, nothing erased.
+*/
+static void test_bad_range(void)
+{
+	test_setup();
+	SIM_CHECK(1 == test_send(0x00008000U));
+	SIM_CHECK((CAN_FWU_ERROR == CanFwu.u8State) && (CAN_FWU_ERR_RANGE == CanFwu.u8Status));
+
+	SIM_CHECK(1 == test_send(CAN_FWU_REGION_END - FTFC_SECTOR_SIZE));
+	SIM_CHECK((CAN_FWU_ERROR == CanFwu.u8State) && (CAN_FWU_ERR_RANGE == CanFwu.u8Status));
+
+	SIM_CHECK(1 == test_send(CAN_FWU_REGION_START + 0x100U));
+	SIM_CHECK((CAN_FWU_ERROR == CanFwu.u8State) && (CAN_FWU_ERR_RANGE == CanFwu.u8Status));
+	SIM_CHECK(0U == sim_can_stats()->u32FlashErases);
+	SIM_CHECK(0U == CanFwu.u32Chunks);
+}
+
+/**
+* @brief            One image bit flipped before the CAN CRC: programmed, VERIFY reports the mismatch.
+*/
+static void test_crc_mismatch(void)
+{
+	const volatile uint8_t *pu8Flash = (const volatile uint8_t *)(uintptr_t)CAN_FWU_REGION_START;
+
+	test_setup();
+	s_u32CorruptOffset = TEST_CORRUPT_OFFSET;
+	SIM_CHECK(1 == test_send(CAN_FWU_REGION_START));
+
+	SIM_CHECK((CAN_FWU_ERROR == CanFwu.u8State) && (CAN_FWU_ERR_CRC == CanFwu.u8Status));
+	SIM_CHECK(TEST_IMAGE_SIZE == CanFwu.u32Received);
+	SIM_CHECK((s_au8Image[TEST_CORRUPT_OFFSET] ^ 0x01U) == pu8Flash[TEST_CORRUPT_OFFSET]);
+	SIM_CHECK(0 == memcmp((const void *)(uintptr_t)CAN_FWU_REGION_START, s_au8Image, TEST_CORRUPT_OFFSET));
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	(void)setvbuf(stdout, NULL, _IOLBF, 0U);	/* In order with the can_fwu_send errors on stderr */
+	test_ftfc();
+	test_update();
+	test_slow_host();
+	test_bad_range();
+	test_crc_mismatch();
+
+	return sim_check_result("test_can_fwu");
+}
+
+
+/* END test_can_fwu */
@@ -0,0 +1,458 @@
+/**
+* @file			test_can_gw.c
+* @brief		Host test of the gateway (can_gw.c) between CAN0 and CAN1 on the register model
+* @details		Forwarding and ID translation, frames without a route, rate limit, both directions
+*				without echo, and frames waiting in the RX FIFO while the destination cannot send.
+*				can_gw_service() is called from a polling loop as from the main.c main loop.
+*				Latency (end of the frame on the source bus to start of the forwarded frame) and
+*				throughput at full bus load for several main loop periods, and head-of-line blocking:
+*				a frame for a blocked destination holds up the frames behind it in the FIFO.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "can_gw.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Main loop period */
+#define TEST_LOOP_TICKS			(SIM_CAN_US(20U))
+
+/* Frames kept per bus */
+#define TEST_FRAMES				(32U)
+
+/* Source frame end times kept per bus, by sequence number (data bytes 0-3) */
+#define TEST_SEQ				(1024U)
+
+/* Throughput run */
+#define TEST_RUN_MS				(200U)
+
+/* Model ticks to us */
+#define TEST_TICKS_US(t)		((uint32_t)((t) / SIM_CAN_US(1U)))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* The 06_CAN.md routing table */
+static const can_gw_route_t s_aRoutes[3] =
+{
+	/* first ID, last ID, new ID,         min gap ms, src, destinations */
+	{0x100U,     0x1FFU,  CAN_GW_KEEP_ID, 0U,         0U,  CAN_GW_DST(1U)},
+	{0x300U,     0x30FU,  0x400U,         10U,        0U,  CAN_GW_DST(1U) | CAN_GW_DST(2U)},
+	{0x000U,     0x7FFU,  CAN_GW_KEEP_ID, 0U,         1U,  CAN_GW_DST(0U)}
+};
+
+/* Head-of-line case: 0x300-0x30F to CAN1 and CAN2, no rate limit */
+static const can_gw_route_t s_aHolRoutes[2] =
+{
+	/* first ID, last ID, new ID,         min gap ms, src, destinations */
+	{0x100U,     0x1FFU,  CAN_GW_KEEP_ID, 0U,         0U,  CAN_GW_DST(1U)},
+	{0x300U,     0x30FU,  CAN_GW_KEEP_ID, 0U,         0U,  CAN_GW_DST(1U) | CAN_GW_DST(2U)}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Frames sent by the gateway, per bus, and their latency in ticks */
+static sim_can_frame_t s_aFrames[2][TEST_FRAMES];
+static uint64_t s_au64Latency[2][TEST_FRAMES];
+static uint32_t s_au32Frames[2];
+
+/* End of the source frames, per bus */
+static uint64_t s_au64SrcEnd[2][TEST_SEQ];
+
+/* Latency of every forwarded frame: count, sum, min, max in ticks */
+static uint32_t s_u32LatCount;
+static uint64_t s_u64LatSum;
+static uint64_t s_u64LatMin;
+static uint64_t s_u64LatMax;
+
+/* Main loop period */
+static uint64_t s_u64LoopTicks;
+
+/* Rate limit state */
+static uint32_t s_au32RouteMs[3];
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_setup(void);
+static void test_poll(uint64_t u64Ticks);
+static void test_inject(uint8_t u8Bus, uint32_t u32Id, uint8_t u8Flags, uint64_t u64At);
+static void test_inject_seq(uint8_t u8Bus, uint32_t u32Id, uint32_t u32Seq, uint64_t u64At);
+static void test_forward(void);
+static void test_rate_limit(void);
+static void test_blocked(void);
+static void test_throughput(void);
+static void test_head_of_line(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Bus monitor: end of the source frames, latency and copy of the frames sent by the
+*					instances. A frame is matched to its source by the sequence number in data bytes 0-3.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	uint32_t u32Seq = ((uint32_t)pFrame->au8Data[0] << 24U) | ((uint32_t)pFrame->au8Data[1] << 16U)
+					| ((uint32_t)pFrame->au8Data[2] << 8U) | pFrame->au8Data[3];
+	uint64_t u64Latency = 0U;
+
+	if (u8Bus >= 2U)
+	{
+		return;
+	}
+	if (u8Src >= SIM_CAN_SRC_GEN)
+	{
+		s_au64SrcEnd[u8Bus][u32Seq % TEST_SEQ] = u64End;
+	}
+	else if (u8Src < 2U)
+	{
+		u64Latency = u64Start - s_au64SrcEnd[1U - u8Bus][u32Seq % TEST_SEQ];
+		s_u32LatCount++;
+		s_u64LatSum += u64Latency;
+		s_u64LatMin = (u64Latency < s_u64LatMin) ? u64Latency : s_u64LatMin;
+		s_u64LatMax = (u64Latency > s_u64LatMax) ? u64Latency : s_u64LatMax;
+		if (s_au32Frames[u8Bus] < TEST_FRAMES)
+		{
+			s_aFrames[u8Bus][s_au32Frames[u8Bus]] = *pFrame;
+			s_au64Latency[u8Bus][s_au32Frames[u8Bus]] = u64Latency;
+			s_au32Frames[u8Bus]++;
+		}
+	}
+}
+
+/**
+* @brief            CAN0 and CAN1 as gateway instances on buses 0 and 1, routes of 06_CAN.md.
+*/
+static void test_setup(void)
+{
+	sim_can_init();
+	can_gw_init_controller(0U);
+	can_gw_init_controller(1U);
+	can_gw_init_controller(2U);
+	can_gw_init(s_aRoutes, 3U, s_au32RouteMs);
+
+	s_au32Frames[0] = 0U;
+	s_au32Frames[1] = 0U;
+	s_u32LatCount = 0U;
+	s_u64LatSum = 0U;
+	s_u64LatMin = UINT64_MAX;
+	s_u64LatMax = 0U;
+	s_u64LoopTicks = TEST_LOOP_TICKS;
+	sim_can_monitor(test_monitor);
+}
+
+/**
+* @brief            Main loop: service both instances every s_u64LoopTicks for u64Ticks.
+*/
+static void test_poll(uint64_t u64Ticks)
+{
+	uint64_t u64End = sim_can_now() + u64Ticks;
+
+	while (sim_can_now() < u64End)
+	{
+		can_gw_service(0U, (uint32_t)(sim_can_now() / SIM_CAN_MS(1U)));
+		can_gw_service(1U, (uint32_t)(sim_can_now() / SIM_CAN_MS(1U)));
+		sim_can_run(s_u64LoopTicks);
+	}
+}
+
+/**
+* @brief            Inject a frame of 8 bytes, byte 0 is the low byte of the ID.
+*/
+static void test_inject(uint8_t u8Bus, uint32_t u32Id, uint8_t u8Flags, uint64_t u64At)
+{
+	sim_can_frame_t frame;
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = u32Id;
+	frame.u8Length = 8U;
+	frame.u8Flags = u8Flags;
+	frame.au8Data[0] = (uint8_t)u32Id;
+	frame.au8Data[7] = 0x5AU;
+	SIM_CHECK(1U == sim_can_inject(u8Bus, &frame, u64At));
+}
+
+/**
+* @brief            Inject a frame of 8 bytes with a sequence number in bytes 0-3.
+*/
+static void test_inject_seq(uint8_t u8Bus, uint32_t u32Id, uint32_t u32Seq, uint64_t u64At)
+{
+	sim_can_frame_t frame;
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = u32Id;
+	frame.u8Length = 8U;
+	frame.au8Data[0] = (uint8_t)(u32Seq >> 24U);
+	frame.au8Data[1] = (uint8_t)(u32Seq >> 16U);
+	frame.au8Data[2] = (uint8_t)(u32Seq >> 8U);
+	frame.au8Data[3] = (uint8_t)u32Seq;
+	SIM_CHECK(1U == sim_can_inject(u8Bus, &frame, u64At));
+}
+
+/**
+* @brief            Forwarding, ID translation, no route, remote frames, both directions without echo.
+*/
+static void test_forward(void)
+{
+	test_setup();
+
+	test_inject(0U, 0x123U, 0U, 0U);					/* To CAN1, same ID */
+	test_inject(0U, 0x305U, 0U, SIM_CAN_US(500U));		/* To CAN1 and CAN2 as 0x405 */
+	test_inject(0U, 0x050U, 0U, SIM_CAN_US(1000U));		/* No route */
+	test_inject(0U, 0x150U, SIM_CAN_RTR, SIM_CAN_US(1500U));	/* Remote frame: not forwarded */
+	test_inject(1U, 0x700U, 0U, SIM_CAN_US(2000U));		/* To CAN0 */
+	test_poll(SIM_CAN_MS(5U));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+
+	SIM_CHECK(2U == s_au32Frames[1]);
+	SIM_CHECK(0x123U == s_aFrames[1][0].u32Id);
+	SIM_CHECK((8U == s_aFrames[1][0].u8Length) && (0x23U == s_aFrames[1][0].au8Data[0]) && (0x5AU == s_aFrames[1][0].au8Data[7]));
+	SIM_CHECK(0x405U == s_aFrames[1][1].u32Id);
+	SIM_CHECK(0x05U == s_aFrames[1][1].au8Data[0]);
+	SIM_CHECK(1U == sim_can_stats()->au32Frames[2]);	/* 0x405 on CAN2 */
+
+	SIM_CHECK(1U == s_au32Frames[0]);					/* 0x700 only, CAN1 frames not sent back */
+	SIM_CHECK(0x700U == s_aFrames[0][0].u32Id);
+
+	SIM_CHECK(3U == CanGwStats.u32Forwarded);
+	SIM_CHECK(2U == CanGwStats.u32NoRoute);
+	SIM_CHECK(0U == CanGwStats.u32FifoOverflow);
+	SIM_CHECK(0U == sim_can_stats()->u32FreezeViolations);
+}
+
+/**
+* @brief            Route with a 10 ms minimum gap: a frame 2 ms after a forwarded one is dropped.
+*/
+static void test_rate_limit(void)
+{
+	test_setup();
+
+	test_inject(0U, 0x301U, 0U, SIM_CAN_MS(1U));
+	test_inject(0U, 0x301U, 0U, SIM_CAN_MS(3U));
+	test_inject(0U, 0x302U, 0U, SIM_CAN_MS(13U));
+	test_poll(SIM_CAN_MS(15U));
+
+	SIM_CHECK(2U == s_au32Frames[1]);
+	SIM_CHECK(0x401U == s_aFrames[1][0].u32Id);
+	SIM_CHECK(0x402U == s_aFrames[1][1].u32Id);
+	SIM_CHECK(2U == CanGwStats.u32Forwarded);
+	SIM_CHECK(1U == CanGwStats.u32RateLimited);
+}
+
+/**
+* @brief            CAN1 loses every arbitration: 8 frames fill its transmit MBs, the next ones wait in
+*                   the CAN0 RX FIFO and leave in order once the bus is free.
+*/
+static void test_blocked(void)
+{
+	sim_can_frame_t load;
+	uint32_t u32Index = 0U;
+	uint8_t u8Gen = 0U;
+
+	test_setup();
+	can_gw_init(s_aRoutes, 2U, s_au32RouteMs);			/* CAN0 routes only, load frames stay on CAN1 */
+
+	(void)memset(&load, 0, sizeof(load));
+	load.u32Id = 0x000U;
+	load.u8Length = 8U;
+	u8Gen = sim_can_gen_load(1U, &load, 0x00FU, 100U, 0U);	/* IDs below every forwarded ID */
+	SIM_CHECK(0xFFU != u8Gen);
+
+	for (u32Index = 0U; u32Index < 12U; u32Index++)
+	{
+		test_inject(0U, 0x100U + u32Index, 0U, 0U);
+	}
+	test_poll(SIM_CAN_MS(10U));
+
+	SIM_CHECK(0U == s_au32Frames[1]);
+	SIM_CHECK(8U == CanGwStats.u32Forwarded);			/* All transmit MBs pending */
+	SIM_CHECK(0U != (sim_can_regs(0U)->IFLAG1 & FLEXCAN_FIFO_AVAILABLE_FLAG));	/* 4 frames wait */
+	SIM_CHECK(0U == CanGwStats.u32FifoOverflow);
+
+	sim_can_gen_stop(u8Gen);
+	test_poll(SIM_CAN_MS(10U));
+
+	SIM_CHECK(12U == s_au32Frames[1]);
+	for (u32Index = 0U; u32Index < s_au32Frames[1]; u32Index++)
+	{
+		SIM_CHECK((0x100U + u32Index) == s_aFrames[1][u32Index].u32Id);
+	}
+	SIM_CHECK(12U == CanGwStats.u32Forwarded);
+	SIM_CHECK(0U == CanGwStats.u32FifoOverflow);
+	SIM_CHECK(0U == (sim_can_regs(0U)->IFLAG1 & FLEXCAN_FIFO_AVAILABLE_FLAG));
+}
+
+/**
+* @brief            Full load of 8 byte frames on CAN0 (and on CAN1 the other way) at 500 kbit/s, for
+*					several main loop periods: frames forwarded per second, latency, FIFO overflows and
+*					register accesses per forwarded frame.
+*/
+static void test_throughput(void)
+{
+	static const uint32_t au32LoopUs[4] = {20U, 1000U, 1000U, 2000U};
+	static const uint8_t au8LoadPct[4] = {100U, 80U, 45U, 100U};
+	static const uint8_t au8Both[4] = {0U, 0U, 1U, 0U};				/* CAN1 to CAN0 as well */
+	sim_can_frame_t load;
+	uint32_t u32Case = 0U;
+	uint32_t u32Sent = 0U;
+	uint32_t u32Accesses = 0U;
+	uint32_t u32Lost = 0U;
+	uint8_t au8Gen[2] = {0xFFU, 0xFFU};
+
+	(void)memset(&load, 0, sizeof(load));
+	load.u8Length = 8U;
+	for (u32Case = 0U; u32Case < 4U; u32Case++)
+	{
+		test_setup();
+		s_u64LoopTicks = SIM_CAN_US(au32LoopUs[u32Case]);
+		load.u32Id = 0x100U;
+		au8Gen[0] = sim_can_gen_load(0U, &load, 0x1FFU, au8LoadPct[u32Case], 0U);
+		au8Gen[1] = 0xFFU;
+		if (0U != au8Both[u32Case])
+		{
+			load.u32Id = 0x200U;
+			au8Gen[1] = sim_can_gen_load(1U, &load, 0x2FFU, au8LoadPct[u32Case], 0U);
+		}
+		u32Accesses = sim_can_stats()->u32Accesses;
+		test_poll(SIM_CAN_MS(TEST_RUN_MS));
+		sim_can_gen_stop(au8Gen[0]);
+		if (0xFFU != au8Gen[1])
+		{
+			sim_can_gen_stop(au8Gen[1]);
+		}
+		test_poll(SIM_CAN_MS(10U));
+		u32Sent = sim_can_gen_sent(au8Gen[0]) + ((0xFFU != au8Gen[1]) ? sim_can_gen_sent(au8Gen[1]) : 0U);
+		u32Lost = sim_can_stats()->au32FifoOverflow[0] + sim_can_stats()->au32FifoOverflow[1];
+		u32Accesses = sim_can_stats()->u32Accesses - u32Accesses;
+
+		(void)printf("test_can_gw: %s at %u %% load, loop %u us: %u frames/s forwarded of %u, latency min %u mean %u "
+					 "max %u us, %u frames lost in a full RX FIFO, %u register accesses per frame\n",
+					 (0xFFU != au8Gen[1]) ? "CAN0<->CAN1" : "CAN0->CAN1 ", au8LoadPct[u32Case], au32LoopUs[u32Case],
+					 CanGwStats.u32Forwarded * (1000U / TEST_RUN_MS), u32Sent * (1000U / TEST_RUN_MS),
+					 TEST_TICKS_US(s_u64LatMin), TEST_TICKS_US(s_u64LatSum / ((0U != s_u32LatCount) ? s_u32LatCount : 1U)),
+					 TEST_TICKS_US(s_u64LatMax), u32Lost,
+					 u32Accesses / ((0U != CanGwStats.u32Forwarded) ? CanGwStats.u32Forwarded : 1U));
+
+		SIM_CHECK(CanGwStats.u32Forwarded == s_u32LatCount);
+		SIM_CHECK((CanGwStats.u32Forwarded + u32Lost) == u32Sent);
+		SIM_CHECK(0U == CanGwStats.u32NoRoute);
+		if (au32LoopUs[u32Case] <= 1000U)
+		{
+			SIM_CHECK(0U == u32Lost);
+			SIM_CHECK(0U == CanGwStats.u32FifoOverflow);
+			SIM_CHECK(s_u64LatMax < (3U * s_u64LoopTicks + SIM_CAN_US(300U)));
+		}
+		else
+		{
+			SIM_CHECK(0U != u32Lost);								/* 8 frames per loop, the FIFO holds 6 */
+			SIM_CHECK(0U != CanGwStats.u32FifoOverflow);
+		}
+	}
+}
+
+/**
+* @brief            Head-of-line blocking: CAN2 loses every arbitration. Frames for CAN1 and CAN2 fill
+*					the CAN2 transmit MBs, the next one waits at the head of the CAN0 RX FIFO, and frames
+*					behind it for CAN1 alone wait too, although CAN1 is idle.
+*/
+static void test_head_of_line(void)
+{
+	sim_can_frame_t load;
+	uint64_t u64Free = SIM_CAN_MS(20U);
+	uint64_t u64Before = 0U;
+	uint64_t u64Behind = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Behind = 0U;
+	uint8_t u8Gen = 0U;
+
+	test_setup();
+	can_gw_init(s_aHolRoutes, 2U, s_au32RouteMs);
+
+	(void)memset(&load, 0, sizeof(load));
+	load.u8Length = 8U;
+	u8Gen = sim_can_gen_load(2U, &load, 0x00FU, 100U, 0U);	/* IDs below every forwarded ID */
+	SIM_CHECK(0xFFU != u8Gen);
+
+	test_inject_seq(0U, 0x120U, 0U, 0U);					/* CAN1 only, nothing blocked yet */
+	for (u32Index = 0U; u32Index < (CAN_GW_TX_MB_COUNT + 1U); u32Index++)
+	{
+		test_inject_seq(0U, 0x300U + u32Index, 1U + u32Index, SIM_CAN_US(500U));	/* 8 fill CAN2, 1 waits */
+	}
+	for (u32Index = 0U; u32Index < 5U; u32Index++)
+	{
+		test_inject_seq(0U, 0x121U + u32Index, 10U + u32Index, SIM_CAN_MS(4U));	/* CAN1 only, behind it */
+	}
+	test_poll(u64Free);
+	SIM_CHECK(0U == CanGwStats.u32FifoOverflow);
+	SIM_CHECK((1U + CAN_GW_TX_MB_COUNT) == s_au32Frames[1]);	/* 0x120, 0x300-0x307 */
+	sim_can_gen_stop(u8Gen);
+	test_poll(SIM_CAN_MS(10U));
+
+	for (u32Index = 0U; u32Index < s_au32Frames[1]; u32Index++)
+	{
+		if (0x120U == s_aFrames[1][u32Index].u32Id)
+		{
+			u64Before = s_au64Latency[1][u32Index];
+		}
+		else if ((s_aFrames[1][u32Index].u32Id >= 0x121U) && (s_aFrames[1][u32Index].u32Id <= 0x125U))
+		{
+			u64Behind = (s_au64Latency[1][u32Index] > u64Behind) ? s_au64Latency[1][u32Index] : u64Behind;
+			u32Behind++;
+		}
+	}
+
+	(void)printf("test_can_gw: head-of-line, CAN2 blocked for %u us: CAN1 frame latency %u us before, up to %u us "
+				 "behind a frame for CAN2\n",
+				 TEST_TICKS_US(u64Free), TEST_TICKS_US(u64Before), TEST_TICKS_US(u64Behind));
+
+	SIM_CHECK(5U == u32Behind);
+	SIM_CHECK(u64Before <= (TEST_LOOP_TICKS + SIM_CAN_US(1U)));
+	SIM_CHECK(u64Behind > (u64Free - SIM_CAN_MS(6U)));			/* Held until CAN2 is free */
+	SIM_CHECK((1U + 2U * (CAN_GW_TX_MB_COUNT + 1U) + 5U) == (CanGwStats.u32Forwarded + CAN_GW_TX_MB_COUNT + 1U));
+	SIM_CHECK(0U == CanGwStats.u32FifoOverflow);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_forward();
+	test_rate_limit();
+	test_blocked();
+	test_throughput();
+	test_head_of_line();
+
+	return sim_check_result("test_can_gw");
+}
+
+
+/* END test_can_gw */
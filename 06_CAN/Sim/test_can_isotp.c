@@ -0,0 +1,771 @@
+/**
+* @file			test_can_isotp.c
+* @brief		Host test of the ISO-TP transport layer (can_isotp.c) on the register model
+* @details		Link A runs on CAN0 as in main.c with ISOTP_MODE=1: it sends through can_send() and
+*				gets its frames from MB4 and the CAN0 MB interrupt of main.c. Link B is the tester on
+*				the other end of bus 0: its frames are injected into the bus, the frames of CAN0 reach
+*				it through the bus monitor. Tests that need frames no link sends (FC WAIT, bad first
+*				and consecutive frames, a peer that stops) inject them by hand. CAN FD links are
+*				tested over a plain frame queue, CAN0 of this project sends classic frames only.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "main.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Indications of one link */
+typedef struct
+{
+	uint32_t u32RxCount;			/* Receive indications */
+	uint32_t u32RxLength;			/* Length of the last one */
+	uint8_t u8RxResult;				/* Result of the last one */
+	uint32_t u32RxUs;				/* Time of the last one */
+	uint32_t u32TxCount;			/* Transmit confirmations */
+	uint8_t u8TxResult;				/* Result of the last one */
+	uint32_t u32TxUs;				/* Time of the last one */
+} test_link_log_t;
+
+/* Frame on bus 0, or on the CAN FD frame queue */
+typedef struct
+{
+	uint64_t u64Start;				/* Start of frame, ticks (bus 0 only) */
+	uint32_t u32Id;					/* ID */
+	uint8_t u8Length;				/* Data length */
+	uint8_t au8Data[64];			/* Data */
+} test_frame_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Link A IDs: TX_MSG_ID and RX_MSG_ID of main.c, MB4 receives RX_MSG_ID */
+#define TEST_A_TX_ID			(0x555U)
+#define TEST_A_RX_ID			(0x511U)
+
+/* Main loop period of both links */
+#define TEST_POLL_US			(20U)
+
+/* Longest message, frames kept per test */
+#define TEST_MSG_MAX			(4096U)
+#define TEST_LOG_SIZE			(1024U)
+
+/* Frames from CAN0 waiting for link B, frames on the CAN FD queue */
+#define TEST_QUEUE_SIZE			(64U)
+
+/* 4 KiB transfer at 500 kbit/s: bus busy for at least this share of the transfer time, in % */
+#define TEST_BUSY_MIN_PCT		(95U)
+
+/* Time base in microseconds as the links see it */
+#define TEST_NOW_US()			((uint32_t)(sim_can_now() / SIM_CAN_US(1U)))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Link A (CAN0) and link B (tester), their indications */
+static can_isotp_t s_LinkA;
+static can_isotp_t s_LinkB;
+static test_link_log_t s_aLog[2];
+
+/* Message sent, receive buffers of A and B */
+static uint8_t s_au8Msg[TEST_MSG_MAX];
+static uint8_t s_au8RxA[TEST_MSG_MAX];
+static uint8_t s_au8RxB[TEST_MSG_MAX];
+
+/* Frames on bus 0 since the last test_setup() */
+static test_frame_t s_aBus[TEST_LOG_SIZE];
+static uint32_t s_u32BusCount;
+
+/* Frames of CAN0 for link B, 0: not passed on (B is replaced by hand made frames) */
+static test_frame_t s_aPeer[TEST_QUEUE_SIZE];
+static uint32_t s_u32PeerHead;
+static uint32_t s_u32PeerTail;
+static uint8_t s_u8PeerOn;
+
+/* CAN FD frame queue between two links, frames sent on it */
+static test_frame_t s_aWire[TEST_QUEUE_SIZE];
+static uint32_t s_u32WireHead;
+static uint32_t s_u32WireTail;
+static test_frame_t s_aWireLog[TEST_LOG_SIZE];
+static uint32_t s_u32WireCount;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_rx_done_a(uint32_t u32Length, uint8_t u8Result);
+static void test_rx_done_b(uint32_t u32Length, uint8_t u8Result);
+static void test_tx_done_a(uint8_t u8Result);
+static void test_tx_done_b(uint8_t u8Result);
+static uint8_t test_peer_send(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+static uint8_t test_wire_send(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_setup(uint8_t u8BlockSizeB, uint8_t u8StMinB, uint32_t u32RxSizeB);
+static void test_run(uint32_t u32Us);
+static uint8_t test_run_until(const uint32_t *pu32Count, uint32_t u32Us);
+static void test_inject(const uint8_t *pu8Data, uint8_t u8Length);
+static uint32_t test_bus_pci(uint8_t u8Pci, uint32_t u32Id);
+static uint64_t test_bus_blocks(uint32_t u32CfId, uint8_t u8BlockSize, uint8_t u8StMin, uint32_t *pu32MaxRun);
+static void test_single(void);
+static void test_transfer(void);
+static void test_block_stmin(void);
+static void test_wait(void);
+static void test_overflow(void);
+static void test_timeouts(void);
+static void test_first_frame(void);
+static void test_consecutive_length(void);
+static void test_fd(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Receive indication of link A.
+*/
+static void test_rx_done_a(uint32_t u32Length, uint8_t u8Result)
+{
+	s_aLog[0].u32RxCount++;
+	s_aLog[0].u32RxLength = u32Length;
+	s_aLog[0].u8RxResult = u8Result;
+	s_aLog[0].u32RxUs = TEST_NOW_US();
+}
+
+/**
+* @brief            Receive indication of link B.
+*/
+static void test_rx_done_b(uint32_t u32Length, uint8_t u8Result)
+{
+	s_aLog[1].u32RxCount++;
+	s_aLog[1].u32RxLength = u32Length;
+	s_aLog[1].u8RxResult = u8Result;
+	s_aLog[1].u32RxUs = TEST_NOW_US();
+}
+
+/**
+* @brief            Transmit confirmation of link A.
+*/
+static void test_tx_done_a(uint8_t u8Result)
+{
+	s_aLog[0].u32TxCount++;
+	s_aLog[0].u8TxResult = u8Result;
+	s_aLog[0].u32TxUs = TEST_NOW_US();
+}
+
+/**
+* @brief            Transmit confirmation of link B.
+*/
+static void test_tx_done_b(uint8_t u8Result)
+{
+	s_aLog[1].u32TxCount++;
+	s_aLog[1].u8TxResult = u8Result;
+	s_aLog[1].u32TxUs = TEST_NOW_US();
+}
+
+/**
+* @brief            Send function of link B: the frame joins the next arbitration on bus 0.
+*/
+static uint8_t test_peer_send(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	sim_can_frame_t frame;
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = u32Id;
+	frame.u8Length = u8Length;
+	(void)memcpy(frame.au8Data, pu8Data, u8Length);
+	return sim_can_inject(0U, &frame, sim_can_now());
+}
+
+/**
+* @brief            Send function of the CAN FD links: queue the frame, test_fd() hands it over.
+*/
+static uint8_t test_wire_send(uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	test_frame_t *pFrame = &s_aWire[s_u32WireHead % TEST_QUEUE_SIZE];
+
+	if ((s_u32WireHead - s_u32WireTail) >= TEST_QUEUE_SIZE)
+	{
+		return 0U;
+	}
+	pFrame->u32Id = u32Id;
+	pFrame->u8Length = u8Length;
+	(void)memcpy(pFrame->au8Data, pu8Data, u8Length);
+	if (s_u32WireCount < TEST_LOG_SIZE)
+	{
+		s_aWireLog[s_u32WireCount] = *pFrame;
+	}
+	s_u32WireCount++;
+	s_u32WireHead++;
+	return 1U;
+}
+
+/**
+* @brief            Bus monitor: log bus 0, pass the frames of CAN0 on to link B.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	test_frame_t *pPeer = &s_aPeer[s_u32PeerHead % TEST_QUEUE_SIZE];
+
+	(void)u64End;
+	if (0U != u8Bus)
+	{
+		return;
+	}
+	if (s_u32BusCount < TEST_LOG_SIZE)
+	{
+		s_aBus[s_u32BusCount].u64Start = u64Start;
+		s_aBus[s_u32BusCount].u32Id = pFrame->u32Id;
+		s_aBus[s_u32BusCount].u8Length = pFrame->u8Length;
+		(void)memcpy(s_aBus[s_u32BusCount].au8Data, pFrame->au8Data, pFrame->u8Length);
+	}
+	s_u32BusCount++;
+
+	if ((0U == u8Src) && (TEST_A_TX_ID == pFrame->u32Id) && (1U == s_u8PeerOn))
+	{
+		SIM_CHECK((s_u32PeerHead - s_u32PeerTail) < TEST_QUEUE_SIZE);
+		pPeer->u32Id = pFrame->u32Id;
+		pPeer->u8Length = pFrame->u8Length;
+		(void)memcpy(pPeer->au8Data, pFrame->au8Data, pFrame->u8Length);
+		s_u32PeerHead++;
+	}
+}
+
+/**
+* @brief            CAN0 as in main.c with ISOTP_MODE=1, link A on it, link B on the other end of bus 0.
+* @param[in]        u8BlockSizeB - BS sent by link B.
+* @param[in]        u8StMinB - STmin sent by link B.
+* @param[in]        u32RxSizeB - Receive buffer of link B.
+*/
+static void test_setup(uint8_t u8BlockSizeB, uint8_t u8StMinB, uint32_t u32RxSizeB)
+{
+	can_isotp_cfg_t cfgA = {TEST_A_TX_ID, TEST_A_RX_ID, 8U, 0U, 0U, 0xCCU, can_send, test_rx_done_a, test_tx_done_a};
+	can_isotp_cfg_t cfgB = {TEST_A_RX_ID, TEST_A_TX_ID, 8U, 0U, 0U, 0xAAU, test_peer_send, test_rx_done_b, test_tx_done_b};
+
+	sim_can_init();
+	FLEXCAN0_init();
+	can_ring_init(&CanRxRing);
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);
+	can_stats_init();
+	can_tx_init(NULL);
+
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), CAN0_ORed_0_15_MB_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_LPIT0_CH0, LPIT0_Ch0_IRQHandler);
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	S32_NVIC->IP[81] = 0x8U;
+	can_time_init();
+	sim_can_monitor(test_monitor);
+
+	cfgB.u8BlockSize = u8BlockSizeB;
+	cfgB.u8StMin = u8StMinB;
+	SIM_CHECK(1U == can_isotp_init(&s_LinkA, &cfgA));
+	SIM_CHECK(1U == can_isotp_init(&s_LinkB, &cfgB));
+	can_isotp_set_rx_buffer(&s_LinkA, s_au8RxA, sizeof(s_au8RxA));
+	can_isotp_set_rx_buffer(&s_LinkB, s_au8RxB, u32RxSizeB);
+
+	(void)memset(s_aLog, 0, sizeof(s_aLog));
+	(void)memset(s_au8RxA, 0, sizeof(s_au8RxA));
+	(void)memset(s_au8RxB, 0, sizeof(s_au8RxB));
+	s_u32BusCount = 0U;
+	s_u32PeerHead = 0U;
+	s_u32PeerTail = 0U;
+	s_u8PeerOn = 1U;
+}
+
+/**
+* @brief            Main loop of both links for u32Us: frames in, then can_isotp_poll(), every TEST_POLL_US.
+*/
+static void test_run(uint32_t u32Us)
+{
+	uint64_t u64End = sim_can_now() + SIM_CAN_US(u32Us);
+	can_frame_t rx;
+	uint8_t au8Data[8];
+	uint8_t u8Index = 0U;
+
+	while (sim_can_now() < u64End)
+	{
+		sim_can_run(SIM_CAN_US(TEST_POLL_US));
+		while (1U == can_ring_pop(&CanRxRing, &rx))
+		{
+			for (u8Index = 0U; u8Index < rx.u8Length; u8Index++)	/* As main.c */
+			{
+				au8Data[u8Index] = (uint8_t)(rx.u32Data[u8Index >> 2U] >> (24U - 8U*(u8Index & 3U)));
+			}
+			can_isotp_rx_frame(&s_LinkA, au8Data, rx.u8Length, TEST_NOW_US());
+		}
+		while (s_u32PeerTail != s_u32PeerHead)
+		{
+			can_isotp_rx_frame(&s_LinkB, s_aPeer[s_u32PeerTail % TEST_QUEUE_SIZE].au8Data,
+							   s_aPeer[s_u32PeerTail % TEST_QUEUE_SIZE].u8Length, TEST_NOW_US());
+			s_u32PeerTail++;
+		}
+		can_isotp_poll(&s_LinkA, TEST_NOW_US());
+		can_isotp_poll(&s_LinkB, TEST_NOW_US());
+	}
+}
+
+/**
+* @brief            Run the links until *pu32Count is not 0.
+* @return           1 if it happened within u32Us.
+*/
+static uint8_t test_run_until(const uint32_t *pu32Count, uint32_t u32Us)
+{
+	uint32_t u32Step = 0U;
+
+	for (u32Step = 0U; (u32Step < (u32Us / TEST_POLL_US)) && (0U == *pu32Count); u32Step++)
+	{
+		test_run(TEST_POLL_US);
+	}
+	return (0U != *pu32Count) ? 1U : 0U;
+}
+
+/**
+* @brief            Inject a hand made frame for link A (ID TEST_A_RX_ID) now.
+*/
+static void test_inject(const uint8_t *pu8Data, uint8_t u8Length)
+{
+	SIM_CHECK(1U == test_peer_send(TEST_A_RX_ID, pu8Data, u8Length));
+}
+
+/**
+* @brief            Count frames on bus 0 with ID u32Id and PCI type u8Pci (high nibble of byte 0).
+*/
+static uint32_t test_bus_pci(uint8_t u8Pci, uint32_t u32Id)
+{
+	uint32_t u32Index = 0U;
+	uint32_t u32Count = 0U;
+
+	for (u32Index = 0U; (u32Index < s_u32BusCount) && (u32Index < TEST_LOG_SIZE); u32Index++)
+	{
+		if ((u32Id == s_aBus[u32Index].u32Id) && (u8Pci == (s_aBus[u32Index].au8Data[0] & 0xF0U)))
+		{
+			u32Count++;
+		}
+	}
+	return u32Count;
+}
+
+/**
+* @brief            Blocks of CFs on bus 0: each FC must carry BS and STmin, CFs in a block must be STmin apart.
+* @param[in]        u32CfId - ID of the CFs, the FCs have the other link ID.
+* @param[in]        u8BlockSize - Expected BS.
+* @param[in]        u8StMin - Expected STmin.
+* @param[out]       pu32MaxRun - Most CFs between two FCs.
+* @return           Shortest time between the starts of two CFs of a block, ticks.
+*/
+static uint64_t test_bus_blocks(uint32_t u32CfId, uint8_t u8BlockSize, uint8_t u8StMin, uint32_t *pu32MaxRun)
+{
+	uint32_t u32Index = 0U;
+	uint32_t u32Run = 0U;
+	uint64_t u64Last = 0U;
+	uint64_t u64MinGap = UINT64_MAX;
+
+	*pu32MaxRun = 0U;
+	for (u32Index = 0U; (u32Index < s_u32BusCount) && (u32Index < TEST_LOG_SIZE); u32Index++)
+	{
+		if ((u32CfId != s_aBus[u32Index].u32Id) && (0x30U == (s_aBus[u32Index].au8Data[0] & 0xF0U)))
+		{
+			SIM_CHECK((u8BlockSize == s_aBus[u32Index].au8Data[1]) && (u8StMin == s_aBus[u32Index].au8Data[2]));
+			u32Run = 0U;
+			u64Last = 0U;
+		}
+		else if ((u32CfId == s_aBus[u32Index].u32Id) && (0x20U == (s_aBus[u32Index].au8Data[0] & 0xF0U)))
+		{
+			u32Run++;
+			*pu32MaxRun = (u32Run > *pu32MaxRun) ? u32Run : *pu32MaxRun;
+			if ((0U != u64Last) && ((s_aBus[u32Index].u64Start - u64Last) < u64MinGap))
+			{
+				u64MinGap = s_aBus[u32Index].u64Start - u64Last;
+			}
+			u64Last = s_aBus[u32Index].u64Start;
+		}
+	}
+	return u64MinGap;
+}
+
+/**
+* @brief            Single frames both ways, padding, empty message.
+*/
+static void test_single(void)
+{
+	test_setup(0U, 0U, TEST_MSG_MAX);
+
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 5U));
+	SIM_CHECK(CAN_ISOTP_BUSY == can_isotp_send(&s_LinkA, s_au8Msg, 5U));
+	SIM_CHECK(CAN_ISOTP_INVALID_LENGTH == can_isotp_send(&s_LinkB, s_au8Msg, 0U));
+	SIM_CHECK(1U == test_run_until(&s_aLog[1].u32RxCount, 10000U));
+	SIM_CHECK((CAN_ISOTP_OK == s_aLog[1].u8RxResult) && (5U == s_aLog[1].u32RxLength));
+	SIM_CHECK(0 == memcmp(s_au8RxB, s_au8Msg, 5U));
+	SIM_CHECK((1U == s_aLog[0].u32TxCount) && (CAN_ISOTP_OK == s_aLog[0].u8TxResult));
+	SIM_CHECK((1U == s_u32BusCount) && (8U == s_aBus[0].u8Length) && (0x05U == s_aBus[0].au8Data[0]));
+	SIM_CHECK((0xCCU == s_aBus[0].au8Data[6]) && (0xCCU == s_aBus[0].au8Data[7]));	/* Padding of A */
+
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkB, &s_au8Msg[100], 7U));
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32RxCount, 10000U));
+	SIM_CHECK((CAN_ISOTP_OK == s_aLog[0].u8RxResult) && (7U == s_aLog[0].u32RxLength));
+	SIM_CHECK(0 == memcmp(s_au8RxA, &s_au8Msg[100], 7U));
+}
+
+/**
+* @brief            4 KiB from A to B, BS 0 and STmin 0: one FC, 585 CFs back to back.
+*/
+static void test_transfer(void)
+{
+	uint32_t u32StartUs = 0U;
+	uint32_t u32Us = 0U;
+	uint64_t u64Busy = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Short = 0U;
+
+	test_setup(0U, 0U, TEST_MSG_MAX);
+	u32StartUs = TEST_NOW_US();
+	u64Busy = sim_can_stats()->au64BusyTicks[0];
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, TEST_MSG_MAX));
+	SIM_CHECK(1U == test_run_until(&s_aLog[1].u32RxCount, 1000000U));
+	u32Us = s_aLog[1].u32RxUs - u32StartUs;
+	u64Busy = sim_can_stats()->au64BusyTicks[0] - u64Busy;
+
+	SIM_CHECK((CAN_ISOTP_OK == s_aLog[1].u8RxResult) && (TEST_MSG_MAX == s_aLog[1].u32RxLength));
+	SIM_CHECK(0 == memcmp(s_au8RxB, s_au8Msg, TEST_MSG_MAX));
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32TxCount, 10000U));
+	SIM_CHECK(CAN_ISOTP_OK == s_aLog[0].u8TxResult);
+	SIM_CHECK(1U == test_bus_pci(0x10U, TEST_A_TX_ID));
+	SIM_CHECK(585U == test_bus_pci(0x20U, TEST_A_TX_ID));		/* (4096 - 6) / 7 rounded up */
+	SIM_CHECK(1U == test_bus_pci(0x30U, TEST_A_RX_ID));
+	for (u32Index = 0U; u32Index < s_u32BusCount; u32Index++)
+	{
+		if (8U != s_aBus[u32Index].u8Length)
+		{
+			u32Short++;											/* Classic frames are always padded */
+		}
+	}
+	SIM_CHECK(0U == u32Short);
+
+	/* The CFs keep the bus busy: the transfer takes about the bus time of its frames */
+	printf("test_can_isotp: 4096 bytes in %u.%03u ms (%u B/s), bus busy %u %%\n",
+		   (unsigned)(u32Us / 1000U), (unsigned)(u32Us % 1000U),
+		   (unsigned)((uint64_t)TEST_MSG_MAX * 1000000U / u32Us),
+		   (unsigned)(u64Busy * 100U / SIM_CAN_US(u32Us)));
+	SIM_CHECK((u64Busy * 100U) >= (SIM_CAN_US(u32Us) * TEST_BUSY_MIN_PCT));
+}
+
+/**
+* @brief            BS 8 and STmin 500 us from B: FC after every 8 CFs, CFs at least 500 us apart.
+*/
+static void test_block_stmin(void)
+{
+	uint32_t u32MaxRun = 0U;
+
+	test_setup(8U, 0xF5U, TEST_MSG_MAX);
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 200U));	/* FF and 28 CFs */
+	SIM_CHECK(1U == test_run_until(&s_aLog[1].u32RxCount, 1000000U));
+	SIM_CHECK((CAN_ISOTP_OK == s_aLog[1].u8RxResult) && (200U == s_aLog[1].u32RxLength));
+	SIM_CHECK(0 == memcmp(s_au8RxB, s_au8Msg, 200U));
+	SIM_CHECK(28U == test_bus_pci(0x20U, TEST_A_TX_ID));
+	SIM_CHECK(4U == test_bus_pci(0x30U, TEST_A_RX_ID));	/* After the FF and after CF 8, 16, 24 */
+
+	SIM_CHECK(test_bus_blocks(TEST_A_TX_ID, 8U, 0xF5U, &u32MaxRun) >= SIM_CAN_US(500U));
+	SIM_CHECK(8U == u32MaxRun);
+
+	/* Same from A to B: BS 2 and STmin 1 ms of link A, sent by the tester link */
+	s_LinkA.cfg.u8BlockSize = 2U;
+	s_LinkA.cfg.u8StMin = 1U;
+	s_u32BusCount = 0U;
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkB, s_au8Msg, 50U));	/* FF and 7 CFs */
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32RxCount, 1000000U));
+	SIM_CHECK((CAN_ISOTP_OK == s_aLog[0].u8RxResult) && (50U == s_aLog[0].u32RxLength));
+	SIM_CHECK(0 == memcmp(s_au8RxA, s_au8Msg, 50U));
+	SIM_CHECK(4U == test_bus_pci(0x30U, TEST_A_TX_ID));	/* After the FF and after CF 2, 4, 6 */
+	SIM_CHECK((s_aLog[0].u32RxUs - s_aLog[1].u32TxUs) < 1000U);
+	SIM_CHECK(test_bus_blocks(TEST_A_RX_ID, 2U, 1U, &u32MaxRun) >= SIM_CAN_MS(1U));
+	SIM_CHECK(2U == u32MaxRun);
+}
+
+/**
+* @brief            FC WAIT restarts N_Bs, more than CAN_ISOTP_WFT_MAX in a row end the transfer.
+*/
+static void test_wait(void)
+{
+	static const uint8_t au8Wait[8] = {0x31U, 0U, 0U, 0xAAU, 0xAAU, 0xAAU, 0xAAU, 0xAAU};
+	static const uint8_t au8Cts[8] = {0x30U, 0U, 0U, 0xAAU, 0xAAU, 0xAAU, 0xAAU, 0xAAU};
+	uint32_t u32Index = 0U;
+
+	test_setup(0U, 0U, TEST_MSG_MAX);
+	s_u8PeerOn = 0U;										/* Flow control by hand */
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 100U));
+	for (u32Index = 0U; u32Index < 3U; u32Index++)
+	{
+		test_run(800000U);									/* 3 x 0.8 s: longer than N_Bs in total */
+		test_inject(au8Wait, 8U);
+	}
+	test_run(800000U);
+	SIM_CHECK((0U == s_aLog[0].u32TxCount) && (CAN_ISOTP_TX_WAIT_FC == s_LinkA.u8TxState));
+	test_inject(au8Cts, 8U);
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32TxCount, 100000U));
+	SIM_CHECK(CAN_ISOTP_OK == s_aLog[0].u8TxResult);		/* All CFs queued by can_send() */
+	test_run(10000U);
+	SIM_CHECK(14U == test_bus_pci(0x20U, TEST_A_TX_ID));	/* (100 - 6) / 7 rounded up */
+
+	s_u32BusCount = 0U;
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 100U));
+	for (u32Index = 0U; u32Index <= CAN_ISOTP_WFT_MAX; u32Index++)
+	{
+		test_run(1000U);
+		SIM_CHECK(1U == s_aLog[0].u32TxCount);
+		test_inject(au8Wait, 8U);
+	}
+	test_run(1000U);
+	SIM_CHECK((2U == s_aLog[0].u32TxCount) && (CAN_ISOTP_WFT_OVERRUN == s_aLog[0].u8TxResult));
+	SIM_CHECK(0U == test_bus_pci(0x20U, TEST_A_TX_ID));
+}
+
+/**
+* @brief            Message larger than the receive buffer of B: FC overflow, both ends report it.
+*/
+static void test_overflow(void)
+{
+	test_setup(0U, 0U, 64U);
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 100U));
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32TxCount, 10000U));
+	SIM_CHECK(CAN_ISOTP_OVERFLOW == s_aLog[0].u8TxResult);
+	SIM_CHECK((1U == s_aLog[1].u32RxCount) && (CAN_ISOTP_OVERFLOW == s_aLog[1].u8RxResult) && (0U == s_aLog[1].u32RxLength));
+	SIM_CHECK(1U == test_bus_pci(0x30U, TEST_A_RX_ID));
+	SIM_CHECK(0x32U == s_aBus[1].au8Data[0]);
+	SIM_CHECK(0U == test_bus_pci(0x20U, TEST_A_TX_ID));
+
+	/* Single frame larger than the buffer */
+	can_isotp_set_rx_buffer(&s_LinkB, s_au8RxB, 4U);
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 5U));
+	test_run(5000U);
+	SIM_CHECK((2U == s_aLog[1].u32RxCount) && (CAN_ISOTP_OVERFLOW == s_aLog[1].u8RxResult));
+}
+
+/**
+* @brief            N_Bs: no FC after the FF. N_Cr: no CF after our FC.
+*/
+static void test_timeouts(void)
+{
+	static const uint8_t au8First[8] = {0x10U, 100U, 1U, 2U, 3U, 4U, 5U, 6U};
+	uint32_t u32StartUs = 0U;
+
+	test_setup(0U, 0U, TEST_MSG_MAX);
+	s_u8PeerOn = 0U;
+	u32StartUs = TEST_NOW_US();
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 100U));
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32TxCount, 2000000U));
+	SIM_CHECK(CAN_ISOTP_TIMEOUT == s_aLog[0].u8TxResult);
+	SIM_CHECK((s_aLog[0].u32TxUs - u32StartUs) >= CAN_ISOTP_TIMEOUT_US);
+	SIM_CHECK((s_aLog[0].u32TxUs - u32StartUs) <= (CAN_ISOTP_TIMEOUT_US + 1000U));
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 7U));	/* Link usable again */
+	test_run(5000U);
+	SIM_CHECK((2U == s_aLog[0].u32TxCount) && (CAN_ISOTP_OK == s_aLog[0].u8TxResult));
+
+	s_u32BusCount = 0U;
+	u32StartUs = TEST_NOW_US();
+	test_inject(au8First, 8U);
+	SIM_CHECK(1U == test_run_until(&s_aLog[0].u32RxCount, 2000000U));
+	SIM_CHECK((CAN_ISOTP_TIMEOUT == s_aLog[0].u8RxResult) && (0U == s_aLog[0].u32RxLength));
+	SIM_CHECK(1U == test_bus_pci(0x30U, TEST_A_TX_ID));	/* FC CTS was sent */
+	SIM_CHECK((s_aLog[0].u32RxUs - u32StartUs) >= CAN_ISOTP_TIMEOUT_US);
+	SIM_CHECK((s_aLog[0].u32RxUs - u32StartUs) <= (CAN_ISOTP_TIMEOUT_US + 1000U));
+}
+
+/**
+* @brief            First frame length checks: the 32 bit escape is only valid above 4095 bytes.
+*/
+static void test_first_frame(void)
+{
+	static const uint8_t au8Escape4095[8] = {0x10U, 0U, 0U, 0U, 0x0FU, 0xFFU, 1U, 2U};
+	static const uint8_t au8Escape4096[8] = {0x10U, 0U, 0U, 0U, 0x10U, 0x00U, 1U, 2U};
+	static const uint8_t au8Fits[8] = {0x10U, 6U, 1U, 2U, 3U, 4U, 5U, 6U};
+	static const uint8_t au8Short[7] = {0x10U, 20U, 1U, 2U, 3U, 4U, 5U};
+
+	test_setup(0U, 0U, TEST_MSG_MAX);
+	s_u8PeerOn = 0U;
+	test_inject(au8Escape4095, 8U);
+	test_inject(au8Fits, 8U);								/* Fits a SF */
+	test_inject(au8Short, 7U);								/* FF shorter than 8 bytes */
+	test_run(5000U);
+	SIM_CHECK(0U == test_bus_pci(0x30U, TEST_A_TX_ID));
+	SIM_CHECK((0U == s_aLog[0].u32RxCount) && (CAN_ISOTP_RX_IDLE == s_LinkA.u8RxState));
+
+	test_inject(au8Escape4096, 8U);
+	test_run(5000U);
+	SIM_CHECK(1U == test_bus_pci(0x30U, TEST_A_TX_ID));
+	SIM_CHECK((CAN_ISOTP_RX_CF == s_LinkA.u8RxState) && (4096U == s_LinkA.u32RxLength) && (2U == s_LinkA.u32RxPos));
+}
+
+/**
+* @brief            Consecutive frame length against RX_DL (8 here): only the last CF may be shorter.
+*/
+static void test_consecutive_length(void)
+{
+	static const uint8_t au8First[8] = {0x10U, 16U, 0U, 1U, 2U, 3U, 4U, 5U};
+	static const uint8_t au8Cf1[8] = {0x21U, 6U, 7U, 8U, 9U, 10U, 11U, 12U};
+	static const uint8_t au8Cf2[4] = {0x22U, 13U, 14U, 15U};
+	static const uint8_t au8Cf1Short[4] = {0x21U, 6U, 7U, 8U};
+	uint8_t u8Index = 0U;
+
+	test_setup(0U, 0U, TEST_MSG_MAX);
+	s_u8PeerOn = 0U;
+	test_inject(au8First, 8U);
+	test_inject(au8Cf1, 8U);
+	test_inject(au8Cf2, 4U);								/* Last CF without padding */
+	test_run(5000U);
+	SIM_CHECK((1U == s_aLog[0].u32RxCount) && (CAN_ISOTP_OK == s_aLog[0].u8RxResult) && (16U == s_aLog[0].u32RxLength));
+	for (u8Index = 0U; u8Index < 16U; u8Index++)
+	{
+		SIM_CHECK(u8Index == s_au8RxA[u8Index]);
+	}
+
+	test_inject(au8First, 8U);
+	test_inject(au8Cf1Short, 4U);							/* CF 1 too short: data would shift */
+	test_run(5000U);
+	SIM_CHECK((2U == s_aLog[0].u32RxCount) && (CAN_ISOTP_WRONG_DL == s_aLog[0].u8RxResult));
+
+	test_inject(au8First, 8U);
+	test_inject(au8Cf1, 8U);
+	test_inject(au8Cf2, 3U);								/* Last CF without all of the rest */
+	test_run(5000U);
+	SIM_CHECK((3U == s_aLog[0].u32RxCount) && (CAN_ISOTP_WRONG_DL == s_aLog[0].u8RxResult));
+}
+
+/**
+* @brief            CAN FD links: configuration checks, FD single frame, 4 KiB in 64 byte frames, RX_DL.
+*/
+static void test_fd(void)
+{
+	can_isotp_cfg_t cfgA = {0x600U, 0x601U, 64U, 0U, 0U, 0xCCU, test_wire_send, test_rx_done_a, test_tx_done_a};
+	can_isotp_cfg_t cfgB = {0x601U, 0x600U, 64U, 0U, 0U, 0xCCU, test_wire_send, test_rx_done_b, test_tx_done_b};
+	can_isotp_cfg_t cfg = cfgA;
+	test_frame_t *pFrame = NULL;
+	uint32_t u32Index = 0U;
+	uint32_t u32Steps = 0U;
+	uint32_t u32Wrong = 0U;
+	static const uint8_t au8First[16] = {0x10U, 100U, 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U};
+	uint8_t au8Cf[20];
+
+	cfg.pfSend = can_send;									/* Classic frames only */
+	SIM_CHECK(0U == can_isotp_init(&s_LinkA, &cfg));
+	cfg.u8FrameSize = 8U;
+	SIM_CHECK(1U == can_isotp_init(&s_LinkA, &cfg));
+	cfg = cfgA;
+	cfg.u8FrameSize = 10U;									/* Not a CAN_DL */
+	SIM_CHECK(0U == can_isotp_init(&s_LinkA, &cfg));
+	cfg.u8FrameSize = 7U;
+	SIM_CHECK(0U == can_isotp_init(&s_LinkA, &cfg));
+
+	SIM_CHECK(1U == can_isotp_init(&s_LinkA, &cfgA));
+	SIM_CHECK(1U == can_isotp_init(&s_LinkB, &cfgB));
+	can_isotp_set_rx_buffer(&s_LinkA, s_au8RxA, sizeof(s_au8RxA));
+	can_isotp_set_rx_buffer(&s_LinkB, s_au8RxB, sizeof(s_au8RxB));
+	(void)memset(s_aLog, 0, sizeof(s_aLog));
+	(void)memset(s_au8RxB, 0, sizeof(s_au8RxB));
+	s_u32WireHead = 0U;
+	s_u32WireTail = 0U;
+	s_u32WireCount = 0U;
+
+	/* Single frames up to 62 bytes, 4 KiB in a FF of 58 (32 bit FF_DL) and 64 byte CFs */
+	SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, 40U));
+	for (u32Steps = 0U; (u32Steps < 1000U) && ((s_aLog[1].u32RxCount < 2U) || (s_aLog[0].u32TxCount < 2U)); u32Steps++)
+	{
+		while (s_u32WireTail != s_u32WireHead)
+		{
+			pFrame = &s_aWire[s_u32WireTail % TEST_QUEUE_SIZE];
+			can_isotp_rx_frame((0x600U == pFrame->u32Id) ? &s_LinkB : &s_LinkA, pFrame->au8Data, pFrame->u8Length, u32Steps * 100U);
+			s_u32WireTail++;
+		}
+		can_isotp_poll(&s_LinkA, u32Steps * 100U);
+		can_isotp_poll(&s_LinkB, u32Steps * 100U);
+		if ((1U == s_aLog[1].u32RxCount) && (1U == s_aLog[0].u32TxCount) && (CAN_ISOTP_TX_IDLE == s_LinkA.u8TxState))
+		{
+			SIM_CHECK((40U == s_aLog[1].u32RxLength) && (0 == memcmp(s_au8RxB, s_au8Msg, 40U)));
+			SIM_CHECK((1U == s_u32WireCount) && (48U == s_aWireLog[0].u8Length));
+			SIM_CHECK((0x00U == s_aWireLog[0].au8Data[0]) && (40U == s_aWireLog[0].au8Data[1]));
+			s_u32WireCount = 0U;
+			SIM_CHECK(CAN_ISOTP_OK == can_isotp_send(&s_LinkA, s_au8Msg, TEST_MSG_MAX));
+		}
+	}
+	SIM_CHECK((2U == s_aLog[1].u32RxCount) && (CAN_ISOTP_OK == s_aLog[1].u8RxResult) && (TEST_MSG_MAX == s_aLog[1].u32RxLength));
+	SIM_CHECK(0 == memcmp(s_au8RxB, s_au8Msg, TEST_MSG_MAX));
+	SIM_CHECK((2U == s_aLog[0].u32TxCount) && (CAN_ISOTP_OK == s_aLog[0].u8TxResult));
+	SIM_CHECK(67U == s_u32WireCount);						/* FF, FC, (4096 - 58) / 63 rounded up CFs */
+	SIM_CHECK((64U == s_aWireLog[0].u8Length) && (0x10U == s_aWireLog[0].au8Data[0]) && (0U == s_aWireLog[0].au8Data[1]));
+	SIM_CHECK(8U == s_aWireLog[1].u8Length);				/* FC in a classic length frame */
+	for (u32Index = 2U; u32Index < (s_u32WireCount - 1U); u32Index++)
+	{
+		if (64U != s_aWireLog[u32Index].u8Length)
+		{
+			u32Wrong++;
+		}
+	}
+	SIM_CHECK(0U == u32Wrong);
+	SIM_CHECK(8U == s_aWireLog[s_u32WireCount - 1U].u8Length);	/* 4096 - 58 - 64 * 63 = 6 bytes, padded to 8 */
+
+	/* RX_DL 16 from the FF: a 20 byte CF is longer than RX_DL, a 12 byte CF not the last one is short */
+	can_isotp_rx_frame(&s_LinkB, au8First, 16U, 0U);
+	(void)memset(au8Cf, 0, sizeof(au8Cf));
+	au8Cf[0] = 0x21U;
+	can_isotp_rx_frame(&s_LinkB, au8Cf, 20U, 0U);
+	SIM_CHECK((3U == s_aLog[1].u32RxCount) && (CAN_ISOTP_WRONG_DL == s_aLog[1].u8RxResult));
+	can_isotp_rx_frame(&s_LinkB, au8First, 16U, 0U);
+	can_isotp_rx_frame(&s_LinkB, au8Cf, 12U, 0U);
+	SIM_CHECK((4U == s_aLog[1].u32RxCount) && (CAN_ISOTP_WRONG_DL == s_aLog[1].u8RxResult));
+	can_isotp_rx_frame(&s_LinkB, au8First, 16U, 0U);
+	for (u32Index = 1U; u32Index <= 6U; u32Index++)		/* 14 + 5 x 15 + 11 */
+	{
+		au8Cf[0] = (uint8_t)(0x20U | u32Index);
+		can_isotp_rx_frame(&s_LinkB, au8Cf, (6U == u32Index) ? 12U : 16U, 0U);
+	}
+	SIM_CHECK((5U == s_aLog[1].u32RxCount) && (CAN_ISOTP_OK == s_aLog[1].u8RxResult) && (100U == s_aLog[1].u32RxLength));
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < TEST_MSG_MAX; u32Index++)
+	{
+		s_au8Msg[u32Index] = (uint8_t)((u32Index * 7U) + (u32Index >> 8U));
+	}
+
+	test_single();
+	test_transfer();
+	test_block_stmin();
+	test_wait();
+	test_overflow();
+	test_timeouts();
+	test_first_frame();
+	test_consecutive_length();
+	test_fd();
+
+	return sim_check_result("test_can_isotp");
+}
+
+
+/* END test_can_isotp */
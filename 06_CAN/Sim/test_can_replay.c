@@ -0,0 +1,188 @@
+/**
+* @file			test_can_replay.c
+* @brief		Host test of the trace replay (can_replay.c) on the register model
+* @details		A can_trace stream whose first frame was recorded 2 s after can_trace_start() is played
+*				back through can_send() with CAN0 in loopback, as main.c does with REPLAY_MODE=1. The
+*				frames come back through MB4 and the CAN0 MB interrupt of main.c. Checked: the first
+*				frame is sent at once, the gaps of the others in original, scaled and fast timing.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "main.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Trace: first frame 2 s after the trace start, then TEST_FRAMES-1 frames TEST_GAP bit times apart */
+#define TEST_FIRST				(2U * FLEXCAN0_BITRATE)
+#define TEST_GAP				(500U)
+#define TEST_FRAMES				(4U)
+
+/* Replay poll period (main loop) and the allowed error of a gap, in bit times */
+#define TEST_POLL_US			(20U)
+#define TEST_GAP_TOL			(30U)
+
+/* Fast replay: 4 byte frames of 0x511 take 79 to 96 bit times, stuff bits included */
+#define TEST_FAST_MAX			(100U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Trace stream: header and records */
+static uint8_t s_au8Trace[CAN_TRACE_HEADER_SIZE + TEST_FRAMES * CAN_TRACE_RECORD_MAX];
+static uint32_t s_u32TraceSize;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_trace(void);
+static void test_setup(void);
+static void test_replay(uint16_t u16ScalePct, uint32_t u32Gap);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Record the test trace with can_trace.c.
+*/
+static void test_trace(void)
+{
+	uint32_t au32Data[2] = {0U, 0U};
+	uint32_t u32Index = 0U;
+
+	can_trace_start(0U);
+	for (u32Index = 0U; u32Index < TEST_FRAMES; u32Index++)
+	{
+		au32Data[0] = u32Index << 24U;
+		(void)can_trace_record(CAN_TRACE_RX, 0x511U, TEST_FIRST + u32Index * TEST_GAP, au32Data, 4U);
+	}
+	(void)can_trace_record(CAN_TRACE_TX, 0x555U, TEST_FIRST + TEST_FRAMES * TEST_GAP, au32Data, 8U);	/* Skipped */
+	can_trace_stop();
+
+	can_trace_header(s_au8Trace, FLEXCAN0_BITRATE);
+	s_u32TraceSize = CAN_TRACE_HEADER_SIZE + can_trace_read(&s_au8Trace[CAN_TRACE_HEADER_SIZE],
+															 sizeof(s_au8Trace) - CAN_TRACE_HEADER_SIZE);
+}
+
+/**
+* @brief            CAN0 as in main.c with REPLAY_MODE=1: MB4, transmit pool, loopback, time base.
+*/
+static void test_setup(void)
+{
+	sim_can_init();
+	FLEXCAN0_init();
+	can_ring_init(&CanRxRing);
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);
+	FLEXCAN0_set_loopback(1U);
+	can_stats_init();
+	can_tx_init(NULL);
+
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), CAN0_ORed_0_15_MB_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_LPIT0_CH0, LPIT0_Ch0_IRQHandler);
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	S32_NVIC->IP[81] = 0x8U;
+	can_time_init();
+}
+
+/**
+* @brief            Replay the trace, check when the frames come back.
+* @param[in]        u16ScalePct - Timing.
+* @param[in]        u32Gap - Expected gap between the frames, bit times.
+*/
+static void test_replay(uint16_t u16ScalePct, uint32_t u32Gap)
+{
+	can_replay_t replay;
+	can_frame_t rx;
+	uint64_t u64Start = 0U;
+	uint64_t u64Last = 0U;
+	uint32_t u32Count = 0U;
+	uint32_t u32Poll = 0U;
+	uint32_t u32Gaps = 1U;
+	uint32_t u32Order = 1U;
+	int64_t s64Error = 0;
+
+	test_setup();
+	u64Start = can_time_now();
+	SIM_CHECK(1U == can_replay_start(&replay, s_au8Trace, s_u32TraceSize, u16ScalePct, can_send, u64Start));
+	for (u32Poll = 0U; (u32Poll < 1000U) && (1U == can_replay_poll(&replay, can_time_now())); u32Poll++)
+	{
+		sim_can_run(SIM_CAN_US(TEST_POLL_US));
+	}
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(5U)));
+
+	SIM_CHECK(0U == replay.u8Error);
+	SIM_CHECK(TEST_FRAMES == replay.u32Sent);
+	SIM_CHECK(1U == replay.u32Skipped);
+	SIM_CHECK(TEST_FRAMES == can_ring_count(&CanRxRing));
+	while (1U == can_ring_pop(&CanRxRing, &rx))
+	{
+		if (0U == u32Count)
+		{
+			SIM_CHECK((rx.u64Timestamp - u64Start) < (2U * TEST_FAST_MAX));	/* Not 2 s after the start */
+		}
+		else
+		{
+			s64Error = (int64_t)(rx.u64Timestamp - u64Last) - (int64_t)u32Gap;
+			if ((0U == u32Gap) ? ((rx.u64Timestamp - u64Last) > TEST_FAST_MAX) : ((s64Error > (int64_t)TEST_GAP_TOL) || (s64Error < -(int64_t)TEST_GAP_TOL)))
+			{
+				u32Gaps = 0U;
+			}
+		}
+		if (u32Count != (rx.u32Data[0] >> 24U))
+		{
+			u32Order = 0U;
+		}
+		u64Last = rx.u64Timestamp;
+		u32Count++;
+	}
+	SIM_CHECK(1U == u32Gaps);
+	SIM_CHECK(1U == u32Order);
+	SIM_CHECK(0U == sim_can_stats()->au32Frames[0]);	/* Loopback: bus stays idle */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_trace();
+	SIM_CHECK(s_u32TraceSize > CAN_TRACE_HEADER_SIZE);
+
+	test_replay(CAN_REPLAY_ORIGINAL, TEST_GAP);
+	test_replay(200U, 2U * TEST_GAP);
+	test_replay(CAN_REPLAY_FAST, 0U);
+
+	return sim_check_result("test_can_replay");
+}
+
+
+/* END test_can_replay */
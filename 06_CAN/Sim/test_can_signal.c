@@ -0,0 +1,424 @@
+/**
+* @file			test_can_signal.c
+* @brief		Host test of the signal codec (can_signal.c)
+* @details		Intel and Motorola layouts, sign extension, unsigned 32 bit values above 0x7FFFFFFF,
+*				rounding and saturation of packed values. The tables generated by Tools/can_dbc_gen.c
+*				from signal_sample.dbc are checked against a bit by bit decoder of the DBC fields, which
+*				is also the baseline of the decode benchmark.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <time.h>
+#include "sim_can.h"
+#include "can_signal.h"
+#include "signal_sample.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* SG_ fields as written in the DBC file, for the bit by bit decoder */
+typedef struct
+{
+	uint8_t u8Start;			/* DBC start bit */
+	uint8_t u8Length;			/* Bits */
+	uint8_t u8Motorola;			/* 1: @0 */
+	uint8_t u8Signed;			/* 1: - */
+	float fFactor;
+	float fOffset;
+} test_dbc_signal_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Random payloads compared, payloads decoded per benchmark run */
+#define TEST_PAYLOADS			(20000U)
+#define TEST_BENCH_LOOPS		(200U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* SG_ Speed : 7|16@0+ (0.01,0)   SG_ Temp : 16|8@1- (1,-40), the 06_CAN.md example */
+static const can_signal_t s_aMsg511[2] =
+{
+	CAN_SIGNAL_MOTOROLA(7U, 16U, 0U, 0.01f, 0.0f),
+	CAN_SIGNAL_INTEL(16U, 8U, 1U, 1.0f, -40.0f)
+};
+
+/* SG_ Count : 0|32@1+ (1,0)   SG_ Offset : 39|32@0- (1,0) */
+static const can_signal_t s_aMsg32[2] =
+{
+	CAN_SIGNAL_INTEL(0U, 32U, 0U, 1.0f, 0.0f),
+	CAN_SIGNAL_MOTOROLA(39U, 32U, 1U, 1.0f, 0.0f)
+};
+
+/* SG_ Level : 4|12@1- (0.5,0) */
+static const can_signal_t s_Level = CAN_SIGNAL_INTEL(4U, 12U, 1U, 0.5f, 0.0f);
+
+/* signal_sample.dbc, the signals can_dbc_gen keeps, in the order of the generated tables */
+static const test_dbc_signal_t s_aDbcEngine[DBC_ENGINE_COUNT] =
+{
+	{7U, 16U, 1U, 0U, 0.01f, 0.0f}, {16U, 8U, 0U, 1U, 1.0f, -40.0f}, {24U, 14U, 0U, 0U, 0.5f, 0.0f},
+	{38U, 4U, 0U, 0U, 1.0f, 0.0f}, {55U, 12U, 1U, 1U, 0.25f, -100.0f}
+};
+static const test_dbc_signal_t s_aDbcBattery[DBC_BATTERY_COUNT] =
+{
+	{0U, 16U, 0U, 0U, 0.001f, 0.0f}, {16U, 16U, 0U, 1U, 0.05f, 0.0f}, {39U, 32U, 1U, 0U, 1.0f, 0.0f}
+};
+static const test_dbc_signal_t s_aDbcMixed[DBC_MIXED_COUNT] =
+{
+	{0U, 4U, 0U, 0U, 1.0f, 0.0f}, {4U, 4U, 0U, 0U, 1.0f, 0.0f}, {31U, 10U, 1U, 1U, 1.0f, 0.0f},
+	{40U, 8U, 0U, 0U, 1.0f, 0.0f}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Random payloads: bytes and the same payloads as MB words */
+static uint8_t s_au8Payload[TEST_PAYLOADS][8];
+static uint32_t s_au32Payload[TEST_PAYLOADS][2];
+
+/* Benchmark result sink */
+static volatile float s_fSink;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_layout(void);
+static void test_unsigned32(void);
+static void test_signed32(void);
+static void test_saturation(void);
+static uint32_t test_random(void);
+static uint32_t test_naive_raw(const test_dbc_signal_t *pSig, const uint8_t *pu8Data);
+static void test_naive_unpack(const test_dbc_signal_t *pSigs, uint8_t u8Count, const uint8_t *pu8Data, float *pfValues);
+static void test_generated(const can_signal_t *pSignals, const test_dbc_signal_t *pDbc, uint8_t u8Count);
+static uint64_t test_ns(void);
+static void test_benchmark(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Motorola and Intel signals at their DBC start bits, other bits kept.
+*/
+static void test_layout(void)
+{
+	uint32_t au32Data[2] = { 0x1234D8FFU, 0xFFFFFFFFU };	/* Bytes 12 34 D8 FF FF FF FF FF */
+	float afValues[2];
+
+	can_signal_unpack(s_aMsg511, 2U, au32Data, afValues);
+	SIM_CHECK(0x1234 == can_signal_get_raw(&s_aMsg511[0], au32Data));
+	SIM_CHECK(-40 == can_signal_get_raw(&s_aMsg511[1], au32Data));
+	SIM_CHECK((afValues[0] > 46.59f) && (afValues[0] < 46.61f));
+	SIM_CHECK(-80.0f == afValues[1]);
+
+	afValues[0] = 123.45f;
+	afValues[1] = 25.0f;
+	can_signal_pack(s_aMsg511, 2U, afValues, au32Data);
+	SIM_CHECK(0x30394100U == au32Data[0]);	/* 12345 = 0x3039, 65 = 0x41 */
+	SIM_CHECK(0U == au32Data[1]);
+
+	au32Data[0] = 0xFFFFFFFFU;
+	au32Data[1] = 0xFFFFFFFFU;
+	can_signal_set_raw(&s_Level, au32Data, 0U);
+	SIM_CHECK(0x0F00FFFFU == au32Data[0]);	/* Bits 4-15: byte 0 high nibble, byte 1 */
+	SIM_CHECK(0xFFFFFFFFU == au32Data[1]);
+}
+
+/**
+* @brief            Unsigned 32 bit signal: raw values of 0x80000000 and more decode and pack positive.
+*/
+static void test_unsigned32(void)
+{
+	uint32_t au32Data[2] = { 0x00000080U, 0U };		/* Count = 0x80000000 */
+	float afValues[2];
+
+	can_signal_unpack(s_aMsg32, 2U, au32Data, afValues);
+	SIM_CHECK(0x80000000U == (uint32_t)can_signal_get_raw(&s_aMsg32[0], au32Data));
+	SIM_CHECK(2147483648.0f == afValues[0]);
+
+	au32Data[0] = 0xFFFFFFFFU;
+	can_signal_unpack(s_aMsg32, 2U, au32Data, afValues);
+	SIM_CHECK(4294967296.0f == afValues[0]);		/* 0xFFFFFFFF rounded to float */
+
+	au32Data[0] = 0x01000001U;						/* Count = 0x01000001: 2^24 + 1 */
+	can_signal_unpack(s_aMsg32, 2U, au32Data, afValues);
+	SIM_CHECK(16777216.0f == afValues[0]);			/* float has 24 bits, the raw value is exact */
+	SIM_CHECK(0x01000001 == can_signal_get_raw(&s_aMsg32[0], au32Data));
+
+	afValues[0] = 2147483648.0f;
+	afValues[1] = 0.0f;
+	can_signal_pack(s_aMsg32, 2U, afValues, au32Data);
+	SIM_CHECK(0x00000080U == au32Data[0]);
+
+	afValues[0] = 3000000000.0f;
+	can_signal_pack(s_aMsg32, 2U, afValues, au32Data);
+	SIM_CHECK(3000000000U == (uint32_t)can_signal_get_raw(&s_aMsg32[0], au32Data));
+
+	afValues[0] = 4294967296.0f;
+	can_signal_pack(s_aMsg32, 2U, afValues, au32Data);
+	SIM_CHECK(0xFFFFFFFFU == au32Data[0]);
+}
+
+/**
+* @brief            Signed 32 bit Motorola signal in the second payload word.
+*/
+static void test_signed32(void)
+{
+	uint32_t au32Data[2] = { 0x12345678U, 0x9ABCDEF0U };
+	float afValues[2];
+
+	can_signal_set_raw(&s_aMsg32[1], au32Data, (uint32_t)-2);
+	SIM_CHECK(0x12345678U == au32Data[0]);			/* Offset is bytes 4-7 */
+	SIM_CHECK(0xFFFFFFFEU == au32Data[1]);
+	SIM_CHECK(-2 == can_signal_get_raw(&s_aMsg32[1], au32Data));
+
+	afValues[0] = 0.0f;
+	afValues[1] = -2147483648.0f;
+	can_signal_pack(s_aMsg32, 2U, afValues, au32Data);
+	can_signal_unpack(s_aMsg32, 2U, au32Data, afValues);
+	SIM_CHECK(-2147483648.0f == afValues[1]);
+
+	afValues[1] = 2147483648.0f;
+	can_signal_pack(s_aMsg32, 2U, afValues, au32Data);
+	SIM_CHECK(0x7FFFFFFF == can_signal_get_raw(&s_aMsg32[1], au32Data));
+}
+
+/**
+* @brief            Rounding halves away from zero, saturation at both ends of the range.
+*/
+static void test_saturation(void)
+{
+	uint32_t au32Data[2];
+	float afValues[2];
+
+	afValues[0] = 655.36f;							/* Raw 65536 */
+	afValues[1] = -200.0f;
+	can_signal_pack(s_aMsg511, 2U, afValues, au32Data);
+	SIM_CHECK(0xFFFF == can_signal_get_raw(&s_aMsg511[0], au32Data));
+	SIM_CHECK(-128 == can_signal_get_raw(&s_aMsg511[1], au32Data));
+
+	afValues[0] = -1.0f;
+	afValues[1] = 100.0f;
+	can_signal_pack(s_aMsg511, 2U, afValues, au32Data);
+	SIM_CHECK(0 == can_signal_get_raw(&s_aMsg511[0], au32Data));
+	SIM_CHECK(127 == can_signal_get_raw(&s_aMsg511[1], au32Data));
+
+	can_signal_pack(&s_Level, 1U, (const float[]){ -1.25f }, au32Data);
+	SIM_CHECK(-3 == can_signal_get_raw(&s_Level, au32Data));
+	can_signal_pack(&s_Level, 1U, (const float[]){ 1.25f }, au32Data);
+	SIM_CHECK(3 == can_signal_get_raw(&s_Level, au32Data));
+	can_signal_pack(&s_Level, 1U, (const float[]){ 1.0e9f }, au32Data);
+	SIM_CHECK(2047 == can_signal_get_raw(&s_Level, au32Data));
+}
+
+/**
+* @brief            xorshift32 random numbers, fixed seed.
+*/
+static uint32_t test_random(void)
+{
+	static uint32_t s_u32State = 0x2545F491U;
+
+	s_u32State ^= s_u32State << 13U;
+	s_u32State ^= s_u32State >> 17U;
+	s_u32State ^= s_u32State << 5U;
+	return s_u32State;
+}
+
+/**
+* @brief            Raw value the DBC way: one bit per iteration. Intel walks up from the LSB,
+*					Motorola down from the MSB in sawtooth numbering (bit 0 of a byte goes on to bit 7 of
+*					the next byte).
+*/
+static uint32_t test_naive_raw(const test_dbc_signal_t *pSig, const uint8_t *pu8Data)
+{
+	uint32_t u32Raw = 0U;
+	uint32_t u32Bit = pSig->u8Start;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < pSig->u8Length; u32Index++)
+	{
+		if (0U == pSig->u8Motorola)
+		{
+			u32Bit = (uint32_t)pSig->u8Start + u32Index;
+			u32Raw |= ((uint32_t)(pu8Data[u32Bit >> 3U] >> (u32Bit & 7U)) & 1U) << u32Index;
+		}
+		else
+		{
+			u32Raw = (u32Raw << 1U) | ((uint32_t)(pu8Data[u32Bit >> 3U] >> (u32Bit & 7U)) & 1U);
+			u32Bit = (0U == (u32Bit & 7U)) ? (u32Bit + 15U) : (u32Bit - 1U);
+		}
+	}
+	return u32Raw;
+}
+
+/**
+* @brief            Physical values with the bit by bit decoder, same float math as can_signal_unpack().
+*/
+static void test_naive_unpack(const test_dbc_signal_t *pSigs, uint8_t u8Count, const uint8_t *pu8Data, float *pfValues)
+{
+	uint32_t u32Raw = 0U;
+	float fRaw = 0.0f;
+	uint8_t u8Index = 0U;
+
+	for (u8Index = 0U; u8Index < u8Count; u8Index++)
+	{
+		u32Raw = test_naive_raw(&pSigs[u8Index], pu8Data);
+		if ((0U != pSigs[u8Index].u8Signed) && (0U != (u32Raw & (1UL << (pSigs[u8Index].u8Length - 1U)))))
+		{
+			fRaw = (float)(int32_t)(u32Raw | ~(0xFFFFFFFFU >> (32U - pSigs[u8Index].u8Length)));
+		}
+		else
+		{
+			fRaw = (float)u32Raw;
+		}
+		pfValues[u8Index] = fRaw * pSigs[u8Index].fFactor + pSigs[u8Index].fOffset;
+	}
+}
+
+/**
+* @brief            Generated table against the DBC fields: raw and physical values of random payloads,
+*					and a raw value set with can_signal_set_raw() read back bit by bit.
+*/
+static void test_generated(const can_signal_t *pSignals, const test_dbc_signal_t *pDbc, uint8_t u8Count)
+{
+	float afTable[8];
+	float afNaive[8];
+	uint32_t au32Data[2];
+	uint8_t au8Data[8];
+	uint32_t u32Raw = 0U;
+	uint32_t u32Payload = 0U;
+	uint32_t u32Errors = 0U;
+	uint8_t u8Index = 0U;
+
+	for (u32Payload = 0U; u32Payload < TEST_PAYLOADS; u32Payload++)
+	{
+		can_signal_unpack(pSignals, u8Count, s_au32Payload[u32Payload], afTable);
+		test_naive_unpack(pDbc, u8Count, s_au8Payload[u32Payload], afNaive);
+		for (u8Index = 0U; u8Index < u8Count; u8Index++)
+		{
+			u32Raw = test_naive_raw(&pDbc[u8Index], s_au8Payload[u32Payload]);
+			if ((afTable[u8Index] != afNaive[u8Index])
+				|| (u32Raw != ((uint32_t)can_signal_get_raw(&pSignals[u8Index], s_au32Payload[u32Payload])
+							   & CAN_SIGNAL_MASK(pDbc[u8Index].u8Length))))
+			{
+				u32Errors++;
+			}
+
+			au32Data[0] = 0U;
+			au32Data[1] = 0U;
+			can_signal_set_raw(&pSignals[u8Index], au32Data, s_au32Payload[u32Payload][0]);
+			for (u32Raw = 0U; u32Raw < 8U; u32Raw++)
+			{
+				au8Data[u32Raw] = (uint8_t)(au32Data[u32Raw >> 2U] >> (24U - 8U*(u32Raw & 3U)));
+			}
+			if (test_naive_raw(&pDbc[u8Index], au8Data) != (s_au32Payload[u32Payload][0] & CAN_SIGNAL_MASK(pDbc[u8Index].u8Length)))
+			{
+				u32Errors++;
+			}
+		}
+	}
+	SIM_CHECK(0U == u32Errors);
+}
+
+/**
+* @brief            Monotonic host time in ns.
+*/
+static uint64_t test_ns(void)
+{
+	struct timespec time;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000U + (uint64_t)time.tv_nsec;
+}
+
+/**
+* @brief            Decode cost of the 5 signal Engine message: can_signal_unpack() against the bit by bit
+*					decoder, host ns per message. Printed only, host timing is not checked.
+*/
+static void test_benchmark(void)
+{
+	float afValues[DBC_ENGINE_COUNT];
+	uint64_t u64Table = 0U;
+	uint64_t u64Naive = 0U;
+	uint32_t u32Loop = 0U;
+	uint32_t u32Payload = 0U;
+
+	u64Table = test_ns();
+	for (u32Loop = 0U; u32Loop < TEST_BENCH_LOOPS; u32Loop++)
+	{
+		for (u32Payload = 0U; u32Payload < TEST_PAYLOADS; u32Payload++)
+		{
+			can_signal_unpack(s_aEngine, DBC_ENGINE_COUNT, s_au32Payload[u32Payload], afValues);
+			s_fSink = afValues[DBC_ENGINE_TORQUE];
+		}
+	}
+	u64Table = test_ns() - u64Table;
+
+	u64Naive = test_ns();
+	for (u32Loop = 0U; u32Loop < TEST_BENCH_LOOPS; u32Loop++)
+	{
+		for (u32Payload = 0U; u32Payload < TEST_PAYLOADS; u32Payload++)
+		{
+			test_naive_unpack(s_aDbcEngine, DBC_ENGINE_COUNT, s_au8Payload[u32Payload], afValues);
+			s_fSink = afValues[DBC_ENGINE_TORQUE];
+		}
+	}
+	u64Naive = test_ns() - u64Naive;
+
+	printf("test_can_signal: %u-signal unpack %.1f ns/message, bit loop %.1f ns/message (%.1fx)\n",
+		   (unsigned)DBC_ENGINE_COUNT, (double)u64Table / (TEST_BENCH_LOOPS * TEST_PAYLOADS),
+		   (double)u64Naive / (TEST_BENCH_LOOPS * TEST_PAYLOADS), (double)u64Naive / (double)u64Table);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	uint32_t u32Payload = 0U;
+	uint32_t u32Byte = 0U;
+
+	for (u32Payload = 0U; u32Payload < TEST_PAYLOADS; u32Payload++)
+	{
+		s_au32Payload[u32Payload][0] = test_random();
+		s_au32Payload[u32Payload][1] = test_random();
+		for (u32Byte = 0U; u32Byte < 8U; u32Byte++)	/* Byte 0 is the MSB of word 0 */
+		{
+			s_au8Payload[u32Payload][u32Byte] = (uint8_t)(s_au32Payload[u32Payload][u32Byte >> 2U] >> (24U - 8U*(u32Byte & 3U)));
+		}
+	}
+
+	test_layout();
+	test_unsigned32();
+	test_signed32();
+	test_saturation();
+	SIM_CHECK((5U == DBC_ENGINE_COUNT) && (3U == DBC_BATTERY_COUNT) && (4U == DBC_MIXED_COUNT));	/* 4 signals left out */
+	SIM_CHECK((0x511U == DBC_ENGINE_ID) && (0x98FEF001U == DBC_BATTERY_ID));
+	test_generated(s_aEngine, s_aDbcEngine, DBC_ENGINE_COUNT);
+	test_generated(s_aBattery, s_aDbcBattery, DBC_BATTERY_COUNT);
+	test_generated(s_aMixed, s_aDbcMixed, DBC_MIXED_COUNT);
+	test_benchmark();
+
+	return sim_check_result("test_can_signal");
+}
+
+
+/* END test_can_signal */
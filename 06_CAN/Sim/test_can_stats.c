@@ -0,0 +1,237 @@
+/**
+* @file			test_can_stats.c
+* @brief		Host test of the bus load of can_stats.c on the register model
+* @details		A load generator keeps bus 0 busy 25, 50 and 75 % of the time. CAN0 receives every frame
+*				in an accept-all MB through the CAN0 MB interrupt of main.c (SIM_CAN, MB mode). The
+*				u16BusLoad of a snapshot is compared to the time the model had a frame on the bus.
+*				CAN_STATS_FRAME_BITS() leaves out the stuff bits, so u16BusLoad reads low by their
+*				share: about 6 % with the generator data, 15 % with heavily stuffed frames, at most 18 %
+*				for 8 byte frames (24 stuff bits in 135).
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "main.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Measurement window of each load */
+#define TEST_WINDOW_MS			(1000U)
+
+/* Generator load: allowed distance of the bus load from the set load, per mille */
+#define TEST_GEN_TOL			(30U)
+
+/* u16BusLoad against the frame bits without stuff bits seen on the bus, per mille */
+#define TEST_BITS_TOL			(2U)
+
+/* Lowest u16BusLoad over the true bus load: stuff bits of 8 byte frames, at most 24 of 135 bits */
+#define TEST_MIN_RATIO			(0.80)
+
+/* Heavily stuffed frames: back-to-back, ID 0x02F with 8 bytes of 0x3C (131 bits, 20 stuff bits) */
+#define TEST_STUFF_FRAMES		(60U)
+#define TEST_STUFF_ID			(0x02FU)
+#define TEST_STUFF_BYTE			(0x3CU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Frame bits on bus 0 after the statistics reset: without stuff bits (CAN_STATS_FRAME_BITS), all */
+static uint64_t s_u64StatsBits;
+static uint64_t s_u64BusBits;
+static uint64_t s_u64WindowStart;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_setup(void);
+static void test_window(void);
+static void test_load(uint8_t u8LoadPct);
+static void test_stuffed_frames(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Bus monitor: frame bits with and without stuff bits, frames after the window start.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	uint32_t u32DataBits = 0U;
+
+	(void)u8Src;
+	(void)u64End;
+	if ((0U == u8Bus) && (u64Start >= s_u64WindowStart))
+	{
+		s_u64StatsBits += CAN_STATS_FRAME_BITS(pFrame->u32Id, pFrame->u8Length);
+		s_u64BusBits += sim_can_frame_bits(pFrame, &u32DataBits);
+	}
+}
+
+/**
+* @brief            CAN0 with one accept-all MB (MB4, mask 0), time base, statistics.
+*/
+static void test_setup(void)
+{
+	static const can_filter_t filter = {0U, 0U, 0U};
+
+	sim_can_init();
+	SIM_CHECK(FLEXCAN0_RX_MB_MASK == FLEXCAN0_init_rx_filters(&filter, 1U, 4U));
+	can_ring_init(&CanRxRing);
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);
+	can_stats_init();
+	can_tx_init(NULL);
+
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), CAN0_ORed_0_15_MB_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_LPIT0_CH0, LPIT0_Ch0_IRQHandler);
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	S32_NVIC->IP[81] = 0x8U;
+	can_time_init();
+
+	sim_can_monitor(test_monitor);
+}
+
+/**
+* @brief            Start the measurement window on an idle bus.
+*/
+static void test_window(void)
+{
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	can_ring_init(&CanRxRing);
+	can_stats_reset();
+	s_u64WindowStart = sim_can_now();
+	s_u64StatsBits = 0U;
+	s_u64BusBits = 0U;
+}
+
+/**
+* @brief            Generator load: u16BusLoad follows the frame bits without stuff bits, and is at most
+*					the stuff bit share below the time the bus was busy.
+* @param[in]        u8LoadPct - Generator load.
+*/
+static void test_load(uint8_t u8LoadPct)
+{
+	can_stats_snapshot_t snapshot;
+	sim_can_frame_t frame;
+	uint64_t u64Busy = 0U;
+	uint64_t u64Elapsed = 0U;
+	uint32_t u32Expected = 0U;
+	uint32_t u32True = 0U;
+	uint8_t u8Gen = 0U;
+
+	test_setup();
+	test_window();
+	u64Busy = sim_can_stats()->au64BusyTicks[0];
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = 0x100U;
+	frame.u8Length = 8U;
+	u8Gen = sim_can_gen_load(0U, &frame, 0x4FFU, u8LoadPct, 0U);
+	sim_can_run(SIM_CAN_MS(TEST_WINDOW_MS));
+	sim_can_gen_stop(u8Gen);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));	/* Last frame counted */
+	can_stats_snapshot(&snapshot);
+
+	u64Elapsed = sim_can_now() - s_u64WindowStart;
+	u64Busy = sim_can_stats()->au64BusyTicks[0] - u64Busy;
+	u32True = (uint32_t)(u64Busy * 1000U / u64Elapsed);
+	u32Expected = (uint32_t)(s_u64StatsBits * sim_can_bit_ticks(0U, 0U) * 1000U / u64Elapsed);
+
+	(void)printf("test_can_stats: load %2u %%: bus busy %.1f %%, u16BusLoad %.1f %%, %.1f %% low (stuff bits %.1f %% of the frame bits)\n",
+				 u8LoadPct, (double)u32True / 10.0, (double)snapshot.u16BusLoad / 10.0,
+				 100.0 * (double)(u32True - snapshot.u16BusLoad) / (double)u32True,
+				 100.0 * (double)(s_u64BusBits - s_u64StatsBits) / (double)s_u64BusBits);
+
+	SIM_CHECK(sim_can_gen_sent(u8Gen) == snapshot.counters.u32Frames);	/* Accept-all: every frame counted */
+	SIM_CHECK(0U == sim_can_stats()->au32RxOverrun[0]);
+	SIM_CHECK((u32True + TEST_GEN_TOL >= 10U * u8LoadPct) && (u32True <= 10U * u8LoadPct + TEST_GEN_TOL));
+	SIM_CHECK((snapshot.u16BusLoad + TEST_BITS_TOL >= u32Expected) && (snapshot.u16BusLoad <= u32Expected + TEST_BITS_TOL));
+	SIM_CHECK(snapshot.u16BusLoad <= u32True);							/* Never high */
+	SIM_CHECK((double)snapshot.u16BusLoad >= TEST_MIN_RATIO * (double)u32True);
+}
+
+/**
+* @brief            Heavily stuffed frames on a fully busy bus: u16BusLoad reads about 15 % low.
+*/
+static void test_stuffed_frames(void)
+{
+	can_stats_snapshot_t snapshot;
+	sim_can_frame_t frame;
+	uint64_t u64Busy = 0U;
+	uint64_t u64Elapsed = 0U;
+	uint32_t u32Load = 0U;
+	uint32_t u32Index = 0U;
+
+	test_setup();
+	test_window();
+	u64Busy = sim_can_stats()->au64BusyTicks[0];
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = TEST_STUFF_ID;
+	frame.u8Length = 8U;
+	(void)memset(frame.au8Data, TEST_STUFF_BYTE, 8U);
+	for (u32Index = 0U; u32Index < TEST_STUFF_FRAMES; u32Index++)
+	{
+		SIM_CHECK(1U == sim_can_inject(0U, &frame, s_u64WindowStart));	/* Back to back */
+	}
+	sim_can_run(SIM_CAN_MS(20U));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	u64Elapsed = s_u64BusBits * sim_can_bit_ticks(0U, 0U);			/* Window: the frames only */
+	u64Busy = sim_can_stats()->au64BusyTicks[0] - u64Busy;
+	SIM_CHECK(u64Busy == u64Elapsed);
+
+	can_stats_snapshot(&snapshot);									/* Same formula as u16BusLoad, over the frames */
+	u32Load = (uint32_t)((uint64_t)snapshot.counters.u32Bits * 1000U * sim_can_bit_ticks(0U, 0U) / u64Elapsed);
+
+	(void)printf("test_can_stats: stuffed frames, bus 100 %% busy: load %.1f %% (%u of %u bits per frame)\n",
+				 (double)u32Load / 10.0, CAN_STATS_FRAME_BITS(TEST_STUFF_ID, 8U), (uint32_t)(s_u64BusBits / TEST_STUFF_FRAMES));
+
+	SIM_CHECK(TEST_STUFF_FRAMES == snapshot.counters.u32Frames);
+	SIM_CHECK(s_u64StatsBits == snapshot.counters.u32Bits);
+	SIM_CHECK(131U * TEST_STUFF_FRAMES == s_u64BusBits);
+	SIM_CHECK(u32Load < 860U);											/* Far below the true 100 % */
+	SIM_CHECK((double)u32Load >= TEST_MIN_RATIO * 1000.0);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_load(25U);
+	test_load(50U);
+	test_load(75U);
+	test_stuffed_frames();
+
+	return sim_check_result("test_can_stats");
+}
+
+
+/* END test_can_stats */
@@ -0,0 +1,301 @@
+/**
+* @file			test_can_trace.c
+* @brief		Host test of the trace recorder (can_trace.c) and its decoder (Tools/can_trace_dump.c)
+* @details		Full load traces: back-to-back frames with random IDs and data, each stamped at the end
+*				of the previous one from the exact frame length (stuff bits included). Each frame is
+*				recorded with can_trace_record() as from the CAN0 interrupt, the ring is drained with
+*				can_trace_read() as by the application, and the dump is decoded with read_record() of
+*				can_trace_dump.c. Prints the bytes per frame, the ratio to a raw MB with a 64 bit time
+*				stamp and the encode time on the host.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "sim_can.h"
+#include "flexcan.h"
+#include "can_trace.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Full load case */
+typedef struct
+{
+	const char *pcName;
+	uint32_t u32DataHz;				/* Data phase bit rate, FD frames with BRS */
+	uint8_t u8Dir;					/* CAN_TRACE_RX, with CAN_TRACE_FDF / CAN_TRACE_BRS */
+	uint8_t u8Ext;					/* 1: 29 bit IDs */
+	uint8_t u8Dlc;
+	uint8_t u8RawSize;				/* MB bytes (C/S, ID, data) + 64 bit time stamp */
+} test_case_t;
+
+/* Recorded frame */
+typedef struct
+{
+	uint64_t u64Time;
+	uint32_t u32Id;
+	uint8_t u8Dir;
+	uint8_t au8Data[64];
+} test_frame_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Frames per case */
+#define TEST_FRAMES				(4000U)
+
+/* Nominal bit rate, the CAN0 timebase counts nominal bits */
+#define TEST_TICK_HZ			(500000U)
+
+/* The application drains the ring when it is this full */
+#define TEST_DRAIN_LEVEL		(CAN_TRACE_SIZE / 2U)
+
+/* Dump: header and every record at its largest size */
+#define TEST_DUMP_SIZE			(CAN_TRACE_HEADER_SIZE + TEST_FRAMES * CAN_TRACE_RECORD_MAX)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* The 06_CAN.md record size table */
+static const test_case_t s_aCases[3] =
+{
+	{"500 kbit/s, 11 bit ID, 8 bytes", TEST_TICK_HZ, CAN_TRACE_RX, 0U, 8U, 24U},
+	{"500 kbit/s, 29 bit ID, 8 bytes", TEST_TICK_HZ, CAN_TRACE_RX, 1U, 8U, 24U},
+	{"500k/2M FD, 11 bit ID, 64 bytes", 2000000U, CAN_TRACE_RX | CAN_TRACE_FDF | CAN_TRACE_BRS, 0U, 15U, 80U}
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Frames of the case and the dump */
+static test_frame_t s_aFrames[TEST_FRAMES];
+static uint8_t s_au8Dump[TEST_DUMP_SIZE];
+static uint32_t s_u32DumpSize;
+
+/* Random IDs and data: xorshift32 */
+static uint32_t s_u32Random = 0x2545F491U;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+int can_trace_dump_main(int argc, char **argv);
+static uint32_t test_random(void);
+static void test_drain(void);
+static uint32_t test_decode(uint32_t u32Count, uint8_t u8Length);
+static void test_full_load(const test_case_t *pCase);
+static void test_order(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/* Tools/can_trace_dump.c, its main() as can_trace_dump_main() */
+#define main						can_trace_dump_main
+#include "../Tools/can_trace_dump.c"
+#undef main
+
+/**
+* @brief            Next random word.
+*/
+static uint32_t test_random(void)
+{
+	s_u32Random ^= s_u32Random << 13U;
+	s_u32Random ^= s_u32Random >> 17U;
+	s_u32Random ^= s_u32Random << 5U;
+	return s_u32Random;
+}
+
+/**
+* @brief            Move the recorded bytes to the dump, as the application does.
+*/
+static void test_drain(void)
+{
+	s_u32DumpSize += can_trace_read(&s_au8Dump[s_u32DumpSize], TEST_DUMP_SIZE - s_u32DumpSize);
+}
+
+/**
+* @brief            Decode the dump with can_trace_dump.c.
+* @return           Records that differ from s_aFrames, or are missing or extra.
+*/
+static uint32_t test_decode(uint32_t u32Count, uint8_t u8Length)
+{
+	trace_record_t rec;
+	FILE *pFile = fmemopen(s_au8Dump, s_u32DumpSize, "rb");
+	uint8_t au8Header[TRACE_HEADER_SIZE];
+	uint32_t u32Bad = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32TickHz = 0U;
+	int iResult = 0;
+
+	SIM_CHECK(NULL != pFile);
+	SIM_CHECK(TRACE_HEADER_SIZE == fread(au8Header, 1U, TRACE_HEADER_SIZE, pFile));
+	SIM_CHECK((0 == memcmp(au8Header, "CTR", 3U)) && (TRACE_VERSION == au8Header[3]));
+	u32TickHz = (uint32_t)au8Header[4] | ((uint32_t)au8Header[5] << 8U)
+			  | ((uint32_t)au8Header[6] << 16U) | ((uint32_t)au8Header[7] << 24U);
+	SIM_CHECK(TEST_TICK_HZ == u32TickHz);
+
+	(void)memset(&rec, 0, sizeof(rec));
+	while (1 == (iResult = read_record(pFile, &rec)))
+	{
+		if ((u32Index >= u32Count)
+			|| ((int64_t)s_aFrames[u32Index].u64Time != rec.s64Time)
+			|| ((s_aFrames[u32Index].u32Id & ~CAN_ID_EXT_FLAG) != rec.u32Id)
+			|| ((0U != (s_aFrames[u32Index].u32Id & CAN_ID_EXT_FLAG)) != (0U != (rec.u8Flags & TRACE_IDE)))
+			|| ((s_aFrames[u32Index].u8Dir & (TRACE_TX | TRACE_FDF | TRACE_BRS)) != (rec.u8Flags & (TRACE_TX | TRACE_FDF | TRACE_BRS)))
+			|| (u8Length != rec.u8Length)
+			|| (0 != memcmp(s_aFrames[u32Index].au8Data, rec.au8Data, u8Length)))
+		{
+			u32Bad++;
+		}
+		u32Index++;
+	}
+	(void)fclose(pFile);
+
+	SIM_CHECK(0 == iResult);								/* Nothing cut off */
+	return u32Bad + ((u32Index < u32Count) ? (u32Count - u32Index) : 0U);
+}
+
+/**
+* @brief            Record, drain and decode TEST_FRAMES back-to-back frames of a case.
+*/
+static void test_full_load(const test_case_t *pCase)
+{
+	sim_can_frame_t frame;
+	uint32_t au32Data[16];
+	struct timespec start;
+	struct timespec end;
+	uint64_t u64Ticks4 = 0U;						/* Time in 1/4 nominal bits: 2M data bits are exact */
+	uint64_t u64Ns = 0U;
+	uint32_t u32DataBits = 0U;
+	uint32_t u32Bits = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Byte = 0U;
+	uint32_t u32Stored = 0U;
+	uint32_t u32Bad = 0U;
+	uint8_t u8Length = (0U != (pCase->u8Dir & CAN_TRACE_FDF)) ? s_au8DlcLength[1][pCase->u8Dlc] : pCase->u8Dlc;
+	double dBytes = 0.0;
+	double dFrameHz = 0.0;
+
+	/* Frames first, so only the recorder is timed */
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u8Length = u8Length;
+	frame.u8Flags = (uint8_t)(((0U != (pCase->u8Dir & CAN_TRACE_FDF)) ? SIM_CAN_FDF : 0U)
+							| ((0U != (pCase->u8Dir & CAN_TRACE_BRS)) ? SIM_CAN_BRS : 0U));
+	for (u32Index = 0U; u32Index < TEST_FRAMES; u32Index++)
+	{
+		frame.u32Id = (0U != pCase->u8Ext) ? ((test_random() & 0x1FFFFFFFU) | SIM_CAN_EXT) : (test_random() & 0x7FFU);
+		for (u32Byte = 0U; u32Byte < u8Length; u32Byte++)
+		{
+			frame.au8Data[u32Byte] = (uint8_t)test_random();
+		}
+		u32Bits = sim_can_frame_bits(&frame, &u32DataBits);
+		u64Ticks4 += 4U * (u32Bits - u32DataBits) + (4U * u32DataBits * TEST_TICK_HZ) / pCase->u32DataHz;
+
+		s_aFrames[u32Index].u64Time = u64Ticks4 / 4U;
+		s_aFrames[u32Index].u32Id = frame.u32Id;			/* SIM_CAN_EXT is CAN_ID_EXT_FLAG */
+		s_aFrames[u32Index].u8Dir = pCase->u8Dir;
+		(void)memcpy(s_aFrames[u32Index].au8Data, frame.au8Data, u8Length);
+	}
+
+	can_trace_header(s_au8Dump, TEST_TICK_HZ);
+	s_u32DumpSize = CAN_TRACE_HEADER_SIZE;
+	can_trace_start(0U);
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+	for (u32Index = 0U; u32Index < TEST_FRAMES; u32Index++)
+	{
+		for (u32Byte = 0U; u32Byte < u8Length; u32Byte += 4U)	/* MB words: byte 0 is the MSB */
+		{
+			au32Data[u32Byte / 4U] = ((uint32_t)s_aFrames[u32Index].au8Data[u32Byte] << 24U)
+								   | ((uint32_t)s_aFrames[u32Index].au8Data[u32Byte + 1U] << 16U)
+								   | ((uint32_t)s_aFrames[u32Index].au8Data[u32Byte + 2U] << 8U)
+								   | s_aFrames[u32Index].au8Data[u32Byte + 3U];
+		}
+		u32Stored += can_trace_record(pCase->u8Dir, s_aFrames[u32Index].u32Id, s_aFrames[u32Index].u64Time,
+									  au32Data, pCase->u8Dlc);
+		if ((CanTrace.u32Head - CanTrace.u32Tail) >= TEST_DRAIN_LEVEL)
+		{
+			test_drain();
+		}
+	}
+	(void)clock_gettime(CLOCK_MONOTONIC, &end);
+	test_drain();
+	u64Ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000U + (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+	u32Bad = test_decode(TEST_FRAMES, u8Length);
+
+	dBytes = (double)(s_u32DumpSize - CAN_TRACE_HEADER_SIZE) / TEST_FRAMES;
+	dFrameHz = (double)TEST_FRAMES * TEST_TICK_HZ / (double)s_aFrames[TEST_FRAMES - 1U].u64Time;
+	(void)printf("test_can_trace: %-31s %.2f bytes/frame (MB + 64 bit time %u, ratio %.2f), %.0f frames/s, %.1f KB/s, "
+				 "ring holds %.0f ms; encode %.0f ns/frame on the host incl. drain, %u records differ after decoding\n",
+				 pCase->pcName, dBytes, pCase->u8RawSize, dBytes / pCase->u8RawSize, dFrameHz, dBytes * dFrameHz / 1000.0,
+				 1000.0 * CAN_TRACE_SIZE / (dBytes * dFrameHz), (double)u64Ns / TEST_FRAMES, u32Bad);
+
+	SIM_CHECK(TEST_FRAMES == u32Stored);
+	SIM_CHECK(0U == CanTrace.u32Dropped);
+	SIM_CHECK(0U == u32Bad);
+	SIM_CHECK(dBytes < pCase->u8RawSize);
+}
+
+/**
+* @brief            TX completions handled after a later RX frame: negative deltas, decoded in order.
+*/
+static void test_order(void)
+{
+	static const uint32_t au32Data[2] = {0x01020304U, 0x05060708U};
+	uint32_t u32Index = 0U;
+
+	can_trace_header(s_au8Dump, TEST_TICK_HZ);
+	s_u32DumpSize = CAN_TRACE_HEADER_SIZE;
+	can_trace_start(1000U);
+	for (u32Index = 0U; u32Index < 16U; u32Index++)
+	{
+		s_aFrames[u32Index].u8Dir = (0U != (u32Index & 1U)) ? CAN_TRACE_TX : CAN_TRACE_RX;
+		s_aFrames[u32Index].u32Id = 0x100U + u32Index;
+		s_aFrames[u32Index].u64Time = 1000U + 130U * u32Index - ((0U != (u32Index & 1U)) ? 200U : 0U);
+		(void)memcpy(s_aFrames[u32Index].au8Data, "\x01\x02\x03\x04\x05\x06\x07\x08", 8U);
+		SIM_CHECK(1U == can_trace_record(s_aFrames[u32Index].u8Dir, s_aFrames[u32Index].u32Id,
+										 s_aFrames[u32Index].u64Time, au32Data, 8U));
+		s_aFrames[u32Index].u64Time -= 1000U;						/* Decoded relative to the start */
+	}
+	can_trace_stop();
+	SIM_CHECK(0U == can_trace_record(CAN_TRACE_RX, 0x123U, 5000U, au32Data, 8U));	/* Stopped */
+	test_drain();
+
+	SIM_CHECK(0U == test_decode(16U, 8U));
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	uint32_t u32Case = 0U;
+
+	for (u32Case = 0U; u32Case < 3U; u32Case++)
+	{
+		test_full_load(&s_aCases[u32Case]);
+	}
+	test_order();
+
+	return sim_check_result("test_can_trace");
+}
+
+
+/* END test_can_trace */
@@ -0,0 +1,378 @@
+/**
+* @file			test_can_tx.c
+* @brief		Host test of the transmit engine (can_tx.c) on the register model
+* @details		Priority order across the MB pool and the queue, same-ID order, back to back frames,
+*				CAN0 sending and receiving at 70-80 % bus load next to a load generator, and CAN0 alone
+*				offered more frames than the bus carries. The CAN0 MB and LPIT0 interrupts are the
+*				handlers of main.c, built with SIM_CAN (MB mode).
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "sim_can.h"
+#include "main.h"
+#include "can_trace.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Sent IDs kept for the order checks */
+#define TEST_LOG_SIZE			(64U)
+
+/* Load test: length, generator load, CAN0 period and frames per period (about 10 % of the bus) */
+#define TEST_LOAD_MS			(2000U)
+#define TEST_LOAD_PCT			(65U)
+#define TEST_DUT_PERIOD_MS		(10U)
+#define TEST_DUT_FRAMES			(3U)
+
+/* Saturation: length, frames offered per 1 ms tick (8 bytes, about 125 % of 500 kbit/s), longest
+   8 byte frame with stuff bits and interframe space in bit times */
+#define TEST_SAT_MS				(1000U)
+#define TEST_SAT_FRAMES			(5U)
+#define TEST_SAT_FRAME_BITS		(138U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* IDs sent by CAN0 each period in the load test: above, between and below the generator IDs */
+static const uint32_t s_au32DutId[TEST_DUT_FRAMES] = {0x050U, 0x120U, 0x300U};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* IDs reported by the TX complete callback */
+static uint32_t s_au32Sent[TEST_LOG_SIZE];
+static uint32_t s_u32SentCount;
+
+/* Frames on bus 0: last end, gaps between frames of CAN0 */
+static uint64_t s_u64LastEnd;
+static uint32_t s_u32Gaps;
+static uint32_t s_u32DutOnBus;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_tx_done(uint32_t u32Id);
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_setup(void);
+static void test_priority(void);
+static void test_same_id(void);
+static void test_back_to_back(void);
+static void test_load(void);
+static void test_saturation(uint32_t u32IdCount);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            TX complete callback: log the ID.
+*/
+static void test_tx_done(uint32_t u32Id)
+{
+	if (s_u32SentCount < TEST_LOG_SIZE)
+	{
+		s_au32Sent[s_u32SentCount] = u32Id;
+	}
+	s_u32SentCount++;
+}
+
+/**
+* @brief            Bus monitor: CAN0 frames that do not start at the end of the previous frame.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	(void)pFrame;
+	if ((0U == u8Bus) && (0U == u8Src))
+	{
+		if ((0U != s_u32DutOnBus) && (u64Start != s_u64LastEnd))
+		{
+			s_u32Gaps++;
+		}
+		s_u32DutOnBus++;
+	}
+	s_u64LastEnd = u64End;
+}
+
+/**
+* @brief            CAN0 as in main.c: MB4 receives, MB8-11 transmit, time base, interrupts at priority 8.
+*/
+static void test_setup(void)
+{
+	sim_can_init();
+	FLEXCAN0_init();
+	can_ring_init(&CanRxRing);
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);
+	can_stats_init();
+	can_lat_reset(&CanLatTx);
+	can_tx_init(test_tx_done);
+
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), CAN0_ORed_0_15_MB_IRQHandler);
+	sim_can_irq(SIM_CAN_IRQ_LPIT0_CH0, LPIT0_Ch0_IRQHandler);
+	S32_NVIC->ICPR[2] = 1U << (81 % 32);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+	S32_NVIC->IP[81] = 0x8U;
+	can_time_init();
+
+	sim_can_monitor(test_monitor);
+	s_u32SentCount = 0U;
+	s_u32Gaps = 0U;
+	s_u32DutOnBus = 0U;
+}
+
+/**
+* @brief            Frames leave lowest ID first: 0x400 is already in an MB when 0x010-0x01F are queued.
+*/
+static void test_priority(void)
+{
+	static const uint8_t au8Data[8] = {1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U};
+	uint32_t u32Index = 0U;
+
+	test_setup();
+	for (u32Index = 0U; u32Index < 4U; u32Index++)
+	{
+		SIM_CHECK(1U == can_send(0x400U + u32Index, au8Data, 8U));		/* MB8-11 */
+	}
+	for (u32Index = 0U; u32Index < 16U; u32Index++)
+	{
+		SIM_CHECK(1U == can_send(0x01FU - u32Index, au8Data, 8U));		/* Queued, highest ID first */
+	}
+	SIM_CHECK(16U == can_tx_pending());
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(20U)));
+
+	SIM_CHECK(20U == s_u32SentCount);
+	SIM_CHECK(0x400U == s_au32Sent[0]);
+	for (u32Index = 0U; u32Index < 16U; u32Index++)
+	{
+		SIM_CHECK((0x010U + u32Index) == s_au32Sent[1U + u32Index]);
+	}
+	for (u32Index = 0U; u32Index < 3U; u32Index++)
+	{
+		SIM_CHECK((0x401U + u32Index) == s_au32Sent[17U + u32Index]);
+	}
+	SIM_CHECK(20U == CanLatTx.u32Count);
+	SIM_CHECK(0U == sim_can_stats()->u32IrqStorms);
+}
+
+/**
+* @brief            Frames with the same ID leave in call order.
+*/
+static void test_same_id(void)
+{
+	uint8_t au8Data[1] = {0U};
+	uint32_t u32Index = 0U;
+	uint32_t u32Order = 1U;
+	can_frame_t rx;
+
+	test_setup();
+	FLEXCAN0_set_loopback(1U);					/* Sent frames come back into MB4 */
+	for (u32Index = 0U; u32Index < 10U; u32Index++)
+	{
+		au8Data[0] = (uint8_t)u32Index;
+		SIM_CHECK(1U == can_send(0x511U, au8Data, 1U));
+	}
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(10U)));
+
+	SIM_CHECK(10U == s_u32SentCount);
+	SIM_CHECK(10U == can_ring_count(&CanRxRing));
+	for (u32Index = 0U; u32Index < 10U; u32Index++)
+	{
+		if ((0U == can_ring_pop(&CanRxRing, &rx)) || (u32Index != (rx.u32Data[0] >> 24U)))
+		{
+			u32Order = 0U;
+		}
+	}
+	SIM_CHECK(1U == u32Order);
+}
+
+/**
+* @brief            Queued frames follow each other without idle bits.
+*/
+static void test_back_to_back(void)
+{
+	static const uint8_t au8Data[8] = {0U};
+	uint32_t u32Index = 0U;
+
+	test_setup();
+	for (u32Index = 0U; u32Index < 24U; u32Index++)
+	{
+		SIM_CHECK(1U == can_send(0x200U + (u32Index % 5U), au8Data, 8U));
+	}
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(20U)));
+	SIM_CHECK(24U == s_u32DutOnBus);
+	SIM_CHECK(0U == s_u32Gaps);
+	SIM_CHECK(0U == can_tx_dropped());
+}
+
+/**
+* @brief            Bus load: generator at TEST_LOAD_PCT %, CAN0 sends TEST_DUT_FRAMES frames every
+*					TEST_DUT_PERIOD_MS and receives 0x511 every 5 ms. Nothing may be lost.
+*/
+static void test_load(void)
+{
+	sim_can_frame_t frame;
+	can_frame_t rx;
+	uint8_t au8Data[8] = {0U};
+	uint32_t u32Period = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Received = 0U;
+	uint32_t u32Queued = 0U;
+	uint32_t u32Order = 1U;
+	uint8_t u8Gen = 0U;
+	uint8_t u8Rx = 0U;
+	double dLoad = 0.0;
+
+	test_setup();
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = 0x080U;
+	frame.u8Length = 8U;
+	u8Gen = sim_can_gen_load(0U, &frame, 0x0FFU, TEST_LOAD_PCT, 0U);
+	frame.u32Id = 0x511U;
+	u8Rx = sim_can_gen_periodic(0U, &frame, 5000U, 0U);
+
+	for (u32Period = 0U; u32Period < (TEST_LOAD_MS / TEST_DUT_PERIOD_MS); u32Period++)
+	{
+		for (u32Index = 0U; u32Index < TEST_DUT_FRAMES; u32Index++)
+		{
+			au8Data[0] = (uint8_t)(u32Period >> 8U);
+			au8Data[1] = (uint8_t)u32Period;
+			u32Queued += can_send(s_au32DutId[u32Index], au8Data, 8U);
+		}
+		sim_can_run(SIM_CAN_MS(TEST_DUT_PERIOD_MS));
+		while (1U == can_ring_pop(&CanRxRing, &rx))	/* Main loop: application takes the frames */
+		{
+			if ((rx.u32Data[0] >> 24U) != ((u32Received >> 24U) & 0xFFU))
+			{
+				u32Order = 0U;
+			}
+			if (((rx.u32Data[0] >> 16U) & 0xFFU) != ((u32Received >> 16U) & 0xFFU))
+			{
+				u32Order = 0U;
+			}
+			u32Received++;
+		}
+	}
+	sim_can_gen_stop(u8Gen);
+	sim_can_gen_stop(u8Rx);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(10U)));
+	u32Received += can_ring_count(&CanRxRing);	/* Last frames, after the loop */
+
+	dLoad = (double)sim_can_stats()->au64BusyTicks[0] / (double)sim_can_now();
+	(void)printf("test_can_tx: load %.1f %%, %.0f frames/s, CAN0 TX latency p50 %u p99 %u max %u bit times\n",
+				 100.0 * dLoad, (double)sim_can_stats()->au32Frames[0] * SIM_CAN_TICK_HZ / (double)sim_can_now(),
+				 can_lat_percentile(&CanLatTx, 500U), can_lat_percentile(&CanLatTx, 990U), CanLatTx.u32Max);
+
+	SIM_CHECK((dLoad >= 0.70) && (dLoad <= 0.85));
+	SIM_CHECK((TEST_LOAD_MS / TEST_DUT_PERIOD_MS) * TEST_DUT_FRAMES == u32Queued);
+	SIM_CHECK(u32Queued == s_u32SentCount);
+	SIM_CHECK(0U == can_tx_dropped());
+	SIM_CHECK(sim_can_gen_sent(u8Rx) == u32Received);
+	SIM_CHECK(1U == u32Order);
+	SIM_CHECK(0U == CanRxRing.u32Overflow);
+	SIM_CHECK(0U == sim_can_stats()->au32RxOverrun[0]);
+	SIM_CHECK(0U == sim_can_stats()->u32IrqStorms);
+	SIM_CHECK(CanLatTx.u32Max < (TEST_DUT_PERIOD_MS * 500U));	/* Sent within its period */
+	SIM_CHECK(can_lat_percentile(&CanLatTx, 990U) <= CanLatTx.u32Max);
+	SIM_CHECK(can_lat_percentile(&CanLatTx, 1000U) == CanLatTx.u32Max);
+}
+
+/**
+* @brief            Saturation: CAN0 alone offered TEST_SAT_FRAMES frames every 1 ms over u32IdCount IDs.
+*					The queue stays full and the bus busy, can_send() refuses the excess. One ID: each
+*					frame waits behind a full queue, the latency is bounded. More IDs: the highest ID
+*					only leaves when the queue holds nothing else, and its frames wait without bound.
+* @param[in]        u32IdCount - IDs 0x200 up, used in turn.
+*/
+static void test_saturation(uint32_t u32IdCount)
+{
+	static const uint8_t au8Data[8] = {0U};
+	uint64_t u64Busy = 0U;
+	uint64_t u64Start = 0U;
+	uint64_t u64DepthSum = 0U;
+	uint32_t u32DepthMax = 0U;
+	uint32_t u32Offered = 0U;
+	uint32_t u32Queued = 0U;
+	uint32_t u32Tick = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Bound = 0U;
+	double dLoad = 0.0;
+
+	test_setup();
+	u64Start = sim_can_now();
+	u64Busy = sim_can_stats()->au64BusyTicks[0];
+	for (u32Tick = 0U; u32Tick < TEST_SAT_MS; u32Tick++)
+	{
+		for (u32Index = 0U; u32Index < TEST_SAT_FRAMES; u32Index++)
+		{
+			u32Queued += can_send(0x200U + (u32Offered % u32IdCount), au8Data, 8U);
+			u32Offered++;
+		}
+		u64DepthSum += can_tx_pending();							/* Depth after the tick's frames */
+		u32DepthMax = (can_tx_pending() > u32DepthMax) ? can_tx_pending() : u32DepthMax;
+		sim_can_run(SIM_CAN_MS(1U));
+	}
+	dLoad = (double)(sim_can_stats()->au64BusyTicks[0] - u64Busy) / (double)(sim_can_now() - u64Start);
+	u32Bound = (CAN_TX_QUEUE_SIZE + CAN_TX_MB_COUNT + 1U) * TEST_SAT_FRAME_BITS;	/* Queue, MBs, frame on the bus */
+
+	(void)printf("test_can_tx: saturation, %u ID(s), %u frames offered per ms: load %.1f %%, %.0f frames/s, %.0f refused/s, queue depth mean %.1f max %u, TX latency p50 %u p99 %u max %u bit times\n",
+				 u32IdCount, TEST_SAT_FRAMES,
+				 100.0 * dLoad, (double)s_u32SentCount * 1000.0 / TEST_SAT_MS, (double)can_tx_dropped() * 1000.0 / TEST_SAT_MS,
+				 (double)u64DepthSum / TEST_SAT_MS, u32DepthMax,
+				 can_lat_percentile(&CanLatTx, 500U), can_lat_percentile(&CanLatTx, 990U), CanLatTx.u32Max);
+
+	SIM_CHECK(dLoad > 0.99);										/* No idle bits once the queue is full */
+	SIM_CHECK(0U == s_u32Gaps);
+	SIM_CHECK(CAN_TX_QUEUE_SIZE == u32DepthMax);
+	SIM_CHECK((u32Offered - u32Queued) == can_tx_dropped());
+	SIM_CHECK(s_u32SentCount == CanLatTx.u32Count);
+	SIM_CHECK(0U == sim_can_stats()->u32IrqStorms);
+	if (1U == u32IdCount)
+	{
+		SIM_CHECK(CanLatTx.u32Max <= u32Bound);
+	}
+	else
+	{
+		SIM_CHECK(CanLatTx.u32Max > u32Bound);						/* Highest ID starved */
+	}
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(20U)));			/* Queue drains */
+	SIM_CHECK(u32Queued == s_u32SentCount);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_priority();
+	test_same_id();
+	test_back_to_back();
+	test_load();
+	test_saturation(1U);
+	test_saturation(4U);
+
+	return sim_check_result("test_can_tx");
+}
+
+
+/* END test_can_tx */
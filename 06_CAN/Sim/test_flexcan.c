@@ -0,0 +1,386 @@
+/**
+* @file			test_flexcan.c
+* @brief		Host test of the FlexCAN0 driver (flexcan.c) on the register model
+* @details		Init handshake and bit timing, MB reception and filtering, RX FIFO order and overflow,
+*				loopback, freeze mode only fields, frame timing on the bus and interrupt storm detection.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <string.h>
+#include "sim_can.h"
+#include "flexcan.h"
+#include "can_stats.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Ticks per bit at 500 kbit/s */
+#define TEST_BIT_TICKS			(SIM_CAN_TICK_HZ / 500000U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Last frame on bus 0 */
+static uint64_t s_u64Start;
+static uint64_t s_u64End;
+static uint32_t s_u32Frames;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_frame(sim_can_frame_t *pFrame, uint32_t u32Id, uint8_t u8Length);
+static void test_init(void);
+static void test_mb_rx(void);
+static void test_rx_filters(void);
+static void test_receive_all(void);
+static void test_rx_fifo(void);
+static void test_loopback(void);
+static void test_freeze_only(void);
+static void test_frame_bits(void);
+static void test_isr_idle(void);
+static void test_irq_storm(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Bus monitor: keep the last frame.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	(void)u8Bus;
+	(void)u8Src;
+	(void)pFrame;
+	s_u64Start = u64Start;
+	s_u64End = u64End;
+	s_u32Frames++;
+}
+
+/**
+* @brief            Classic data frame, data bytes 0x10, 0x11, ...
+*/
+static void test_frame(sim_can_frame_t *pFrame, uint32_t u32Id, uint8_t u8Length)
+{
+	uint8_t u8Index = 0U;
+
+	(void)memset(pFrame, 0, sizeof(*pFrame));
+	pFrame->u32Id = u32Id;
+	pFrame->u8Length = u8Length;
+	for (u8Index = 0U; u8Index < u8Length; u8Index++)
+	{
+		pFrame->au8Data[u8Index] = (uint8_t)(0x10U + u8Index);
+	}
+}
+
+/**
+* @brief            FLEXCAN0_init(): freeze handshake, 500 kbit/s from the 8 MHz oscillator, normal mode.
+*/
+static void test_init(void)
+{
+	sim_can_init();
+	FLEXCAN0_init();
+
+	SIM_CHECK(0U == (sim_can_regs(0U)->MCR & (CAN_MCR_MDIS_MASK | CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK)));
+	SIM_CHECK(0U == (sim_can_regs(0U)->CTRL1 & CAN_CTRL1_CLKSRC_MASK));
+	SIM_CHECK(TEST_BIT_TICKS == sim_can_bit_ticks(0U, 0U));
+	SIM_CHECK(0U == sim_can_stats()->u32FreezeViolations);
+	SIM_CHECK(0U != sim_can_stats()->u32Accesses);	/* Driver went through the trapped registers */
+}
+
+/**
+* @brief            MB4 receives 0x511 only; reading it clears its flag and no other.
+*/
+static void test_mb_rx(void)
+{
+	sim_can_frame_t frame;
+	can_frame_t rx;
+
+	sim_can_init();
+	FLEXCAN0_init();
+
+	test_frame(&frame, 0x511U, 8U);
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, 0U));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(0x10U == (sim_can_regs(0U)->IFLAG1 & 0x10U));
+
+	sim_can_regs(0U)->IFLAG1 |= 0x200U;			/* Another flag pending */
+	FLEXCAN0_read_mb(4U, &rx);
+	SIM_CHECK(0x200U == sim_can_regs(0U)->IFLAG1);
+	SIM_CHECK(0x511U == rx.u32Id);
+	SIM_CHECK(8U == rx.u8Length);
+	SIM_CHECK(0x10111213U == rx.u32Data[0]);
+	SIM_CHECK(0x14151617U == rx.u32Data[1]);
+	SIM_CHECK(FLEXCAN_RX_FULL == rx.u8Code);
+
+	test_frame(&frame, 0x512U, 2U);				/* Not for MB4 */
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now()));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == sim_can_stats()->au32RxFrames[0]);
+	SIM_CHECK(2U == sim_can_stats()->au32Frames[0]);
+}
+
+/**
+* @brief            FLEXCAN0_init_rx_filters(): individual masks per MB, IDE always compared, no MB in
+*					the transmit pool.
+*/
+static void test_rx_filters(void)
+{
+	static const can_filter_t aFilters[2] =
+	{
+		{0x100U, 0x7F0U, 0U},
+		{0x1ABCDE00U | CAN_ID_EXT_FLAG, 0x1FFFFF00U, 0U}
+	};
+	sim_can_frame_t frame;
+	can_frame_t rx;
+
+	sim_can_init();
+	SIM_CHECK(0U == FLEXCAN0_init_rx_filters(aFilters, 2U, FLEXCAN0_TX_MB_FIRST - 1U));	/* MB8 is transmit */
+	SIM_CHECK(0U == FLEXCAN0_init_rx_filters(aFilters, 0U, 6U));
+	SIM_CHECK(0U == sim_can_stats()->u32Accesses);	/* Refused before the module is touched */
+	SIM_CHECK(0xC0U == FLEXCAN0_init_rx_filters(aFilters, 2U, 6U));
+
+	test_frame(&frame, 0x105U, 1U);				/* MB6 */
+	(void)sim_can_inject(0U, &frame, 0U);
+	test_frame(&frame, 0x110U, 1U);				/* Outside both */
+	(void)sim_can_inject(0U, &frame, 0U);
+	test_frame(&frame, 0x1ABCDE42U | SIM_CAN_EXT, 1U);	/* MB7 */
+	(void)sim_can_inject(0U, &frame, 0U);
+	test_frame(&frame, 0x0FFU, 1U);				/* Same ID word bits as MB7, standard: IDE differs */
+	(void)sim_can_inject(0U, &frame, 0U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(2U)));
+
+	SIM_CHECK(0xC0U == sim_can_regs(0U)->IFLAG1);
+	SIM_CHECK(2U == sim_can_stats()->au32RxFrames[0]);
+	FLEXCAN0_read_mb(6U, &rx);
+	SIM_CHECK(0x105U == rx.u32Id);
+	FLEXCAN0_read_mb(7U, &rx);
+	SIM_CHECK((0x1ABCDE42U | CAN_ID_EXT_FLAG) == rx.u32Id);
+}
+
+/**
+* @brief            FLEXCAN0_receive_all(): MB4 and MB5 in one batch, lowest first. A frame for MB4 waits
+*					while MB4 is locked and is stored when the batch moves on to MB5: its flag must stay set.
+*/
+static void test_receive_all(void)
+{
+	static const can_filter_t aFilters[2] =
+	{
+		{0x100U, 0x7FFU, 0U},
+		{0x200U, 0x7FFU, 0U}
+	};
+	sim_can_frame_t frame;
+	can_frame_t aRx[2];
+	uint32_t dummy = 0U;
+
+	sim_can_init();
+	SIM_CHECK(0x30U == FLEXCAN0_init_rx_filters(aFilters, 2U, 4U));
+	test_frame(&frame, 0x200U, 2U);
+	(void)sim_can_inject(0U, &frame, 0U);
+	test_frame(&frame, 0x100U, 1U);
+	(void)sim_can_inject(0U, &frame, 0U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(0x30U == sim_can_regs(0U)->IFLAG1);
+
+	dummy = FLEXCAN_MB(FLEXCAN0_INST, 4U)->CS;	/* MB4 locked, as by the batch copying it */
+	(void)dummy;
+	test_frame(&frame, 0x100U, 3U);				/* Arrives during the batch */
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now()));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(2U == sim_can_stats()->au32RxFrames[0]);	/* Held for MB4, not stored yet */
+
+	SIM_CHECK(2U == FLEXCAN0_receive_all(0x30U, aRx));
+	SIM_CHECK((0x100U == aRx[0].u32Id) && (1U == aRx[0].u8Length));
+	SIM_CHECK((0x200U == aRx[1].u32Id) && (2U == aRx[1].u8Length));
+	SIM_CHECK(0x10U == sim_can_regs(0U)->IFLAG1);	/* Stored when MB5 was locked */
+
+	SIM_CHECK(1U == FLEXCAN0_receive_all(0x30U, aRx));
+	SIM_CHECK((0x100U == aRx[0].u32Id) && (3U == aRx[0].u8Length));
+	SIM_CHECK(0U == sim_can_regs(0U)->IFLAG1);
+	SIM_CHECK(0U == FLEXCAN0_receive_all(0x30U, aRx));
+	SIM_CHECK(0U == sim_can_stats()->au32RxOverrun[0]);
+}
+
+/**
+* @brief            RX FIFO: element count checked, six frames in arrival order with their filter element, the
+*					seventh is lost.
+*/
+static void test_rx_fifo(void)
+{
+	static const uint32_t au32Filters[2] = {FLEXCAN_FIFO_ID_A(0x100U), FLEXCAN_FIFO_ID_A(0x200U)};
+	sim_can_frame_t frame;
+	can_frame_t rx;
+	uint32_t u32Index = 0U;
+
+	sim_can_init();
+	SIM_CHECK(0U == FLEXCAN0_init_rx_fifo(FLEXCAN_FIFO_FORMAT_A, au32Filters, NULL, 0U));
+	SIM_CHECK(0U == FLEXCAN0_init_rx_fifo(FLEXCAN_FIFO_FORMAT_A, au32Filters, NULL, FLEXCAN0_FIFO_MAX_FILTERS + 1U));	/* MB8: transmit pool */
+	SIM_CHECK(0U == FLEXCAN0_init_rx_fifo(FLEXCAN_FIFO_FORMAT_A, au32Filters, NULL, 105U));	/* RFFN>12 */
+	SIM_CHECK(0U == (sim_can_regs(0U)->MCR & CAN_MCR_RFEN_MASK));	/* Not touched */
+	SIM_CHECK(1U == FLEXCAN0_init_rx_fifo(FLEXCAN_FIFO_FORMAT_A, au32Filters, NULL, 2U));
+	SIM_CHECK(0U == (sim_can_regs(0U)->CTRL2 & CAN_CTRL2_RFFN_MASK));
+	RxFifoOverflow = 0U;
+
+	for (u32Index = 0U; u32Index < 7U; u32Index++)
+	{
+		test_frame(&frame, (0U != (u32Index & 1U)) ? 0x200U : 0x100U, 8U);
+		frame.au8Data[0] = (uint8_t)u32Index;
+		(void)sim_can_inject(0U, &frame, 0U);
+	}
+	test_frame(&frame, 0x300U, 8U);				/* No element */
+	(void)sim_can_inject(0U, &frame, 0U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(3U)));
+	SIM_CHECK(1U == sim_can_stats()->au32FifoOverflow[0]);
+
+	for (u32Index = 0U; u32Index < 6U; u32Index++)
+	{
+		SIM_CHECK(1U == FLEXCAN0_read_rx_fifo(&rx));
+		SIM_CHECK(((0U != (u32Index & 1U)) ? 0x200U : 0x100U) == rx.u32Id);
+		SIM_CHECK((u32Index & 1U) == rx.u8Code);	/* IDHIT */
+		SIM_CHECK(u32Index == (rx.u32Data[0] >> 24U));
+	}
+	SIM_CHECK(0U == FLEXCAN0_read_rx_fifo(&rx));
+	SIM_CHECK(1U == RxFifoOverflow);
+}
+
+/**
+* @brief            Loopback: MB8 is received by MB4, nothing goes on the bus.
+*/
+static void test_loopback(void)
+{
+	static const uint32_t au32Data[2] = {0xA5112233U, 0x44556677U};
+	can_frame_t rx;
+
+	sim_can_init();
+	FLEXCAN0_init();
+	FLEXCAN0_set_loopback(1U);
+	SIM_CHECK(0U == sim_can_stats()->u32FreezeViolations);
+
+	FLEXCAN0_write_mb(8U, 0x511U, au32Data, 8U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(0x110U == sim_can_regs(0U)->IFLAG1);
+	SIM_CHECK(0U == sim_can_stats()->au32Frames[0]);
+	FLEXCAN0_read_mb(4U, &rx);
+	SIM_CHECK(0xA5112233U == rx.u32Data[0]);
+
+	FLEXCAN0_set_loopback(0U);
+	FLEXCAN0_write_mb(8U, 0x511U, au32Data, 8U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == sim_can_stats()->au32Frames[0]);
+}
+
+/**
+* @brief            Bit timing written outside freeze mode is ignored.
+*/
+static void test_freeze_only(void)
+{
+	sim_can_init();
+	FLEXCAN0_init();
+
+	CAN0->CTRL1 |= CAN_CTRL1_PRESDIV(3U);
+	SIM_CHECK(1U == sim_can_stats()->u32FreezeViolations);
+	SIM_CHECK(TEST_BIT_TICKS == sim_can_bit_ticks(0U, 0U));
+}
+
+/**
+* @brief            Frame length with stuff bits, and frame time on the bus.
+*/
+static void test_frame_bits(void)
+{
+	static const uint32_t au32Data[2] = {0xA5112233U, 0x44556677U};
+	sim_can_frame_t frame;
+	uint32_t u32DataBits = 0U;
+
+	test_frame(&frame, 0x000U, 0U);				/* 34 dominant bits up to the CRC delimiter: 6 stuff bits */
+	SIM_CHECK(53U == sim_can_frame_bits(&frame, &u32DataBits));
+	SIM_CHECK(0U == u32DataBits);
+	test_frame(&frame, 0x555U, 8U);				/* Alternating ID: CAN_STATS_FRAME_BITS or more */
+	SIM_CHECK(CAN_STATS_FRAME_BITS(0x555U, 8U) <= sim_can_frame_bits(&frame, &u32DataBits));
+	test_frame(&frame, 0x555U | SIM_CAN_EXT, 8U);
+	SIM_CHECK(CAN_STATS_FRAME_BITS(0x555U | CAN_ID_EXT_FLAG, 8U) <= sim_can_frame_bits(&frame, &u32DataBits));
+
+	sim_can_init();
+	FLEXCAN0_init();
+	sim_can_monitor(test_monitor);
+	s_u32Frames = 0U;
+	FLEXCAN0_write_mb(8U, 0x555U, au32Data, 8U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == s_u32Frames);
+	test_frame(&frame, 0x555U, 8U);
+	(void)memcpy(frame.au8Data, "\xA5\x11\x22\x33\x44\x55\x66\x77", 8U);
+	SIM_CHECK((uint64_t)sim_can_frame_bits(&frame, &u32DataBits) * TEST_BIT_TICKS == (s_u64End - s_u64Start));
+	SIM_CHECK(FLEXCAN_TX_INACTIVE == (FLEXCAN_MB(FLEXCAN0_INST, 8U)->CS >> FLEXCAN_MB_CS_CODE_SHIFT) % 16U);
+}
+
+/**
+* @brief            MB interrupt handler that leaves the flag set.
+*/
+static void test_isr_idle(void)
+{
+}
+
+/**
+* @brief            A flag nobody clears is reported as an interrupt storm, not an endless loop.
+*/
+static void test_irq_storm(void)
+{
+	sim_can_frame_t frame;
+
+	sim_can_init();
+	FLEXCAN0_init();
+	FLEXCAN0_enable_mb_interrupts(FLEXCAN0_RX_MB_MASK);
+	sim_can_irq(SIM_CAN_IRQ_MB0(0U), test_isr_idle);
+	S32_NVIC->ISER[2] = 1U << (81 % 32);
+
+	test_frame(&frame, 0x511U, 8U);
+	(void)sim_can_inject(0U, &frame, 0U);
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == sim_can_stats()->u32IrqStorms);
+	SIM_CHECK(SIM_CAN_STORM_CALLS == sim_can_stats()->u32Irqs);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_init();
+	test_mb_rx();
+	test_rx_filters();
+	test_receive_all();
+	test_rx_fifo();
+	test_loopback();
+	test_freeze_only();
+	test_frame_bits();
+	test_irq_storm();
+
+	return sim_check_result("test_flexcan");
+}
+
+
+/* END test_flexcan */
@@ -0,0 +1,327 @@
+/**
+* @file			test_flexcan_fd.c
+* @brief		Host test of the 07_CANFD FlexCAN0 driver (flexcan_fd.c) on the register model
+* @details		500 kbit/s / 2 Mbit/s bit timing, 64 byte frames with bit rate switch in both
+*				directions, frame time split into nominal and data phase, data bit rate mismatch.
+*				Payload copy benchmark for 8, 12, 32 and 64 byte frames: MB RAM accesses per frame on
+*				the trapped registers, and bytes per host cycle (TSC) with trapping off, against a
+*				byte at a time copy.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+#include "sim_can.h"
+#include "flexcan_fd.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Ticks per nominal bit (500 kbit/s) and per data bit (2 Mbit/s) */
+#define TEST_NOMINAL_TICKS		(SIM_CAN_TICK_HZ / 500000U)
+#define TEST_DATA_TICKS			(SIM_CAN_TICK_HZ / 2000000U)
+
+/* Benchmark MB (inactive after FLEXCAN0_init()) and copies per timing run */
+#define TEST_BENCH_MB			(6U)
+#define TEST_BENCH_RUNS			(200000U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Last frame on bus 0 */
+static sim_can_frame_t s_Frame;
+static uint64_t s_u64Ticks;
+static uint32_t s_u32Frames;
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End);
+static void test_init(void);
+static void test_tx(void);
+static void test_rx(void);
+static void test_write_bytes(uint8_t u8Mb, const uint8_t *pu8Data, uint8_t u8Length);
+static uint8_t test_read_bytes(uint8_t u8Mb, uint8_t *pu8Data);
+static uint32_t test_accesses(void);
+static double test_cycles(uint8_t u8Bytewise, uint8_t *pu8Data, uint8_t u8Length);
+static void test_bench(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Bus monitor: keep the last frame and its length.
+*/
+static void test_monitor(uint8_t u8Bus, uint8_t u8Src, const sim_can_frame_t *pFrame, uint64_t u64Start, uint64_t u64End)
+{
+	(void)u8Bus;
+	(void)u8Src;
+	s_Frame = *pFrame;
+	s_u64Ticks = u64End - u64Start;
+	s_u32Frames++;
+}
+
+/**
+* @brief            FLEXCAN0_init(): CBT / FDCBT timing, FD mode, 7 MBs of 64 bytes.
+*/
+static void test_init(void)
+{
+	sim_can_init();
+	FLEXCAN0_init();
+
+	SIM_CHECK(0U != (sim_can_regs(0U)->MCR & CAN_MCR_FDEN_MASK));
+	SIM_CHECK(0U == (sim_can_regs(0U)->MCR & (CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK)));
+	SIM_CHECK(TEST_NOMINAL_TICKS == sim_can_bit_ticks(0U, 0U));
+	SIM_CHECK(TEST_DATA_TICKS == sim_can_bit_ticks(0U, 1U));
+	SIM_CHECK(0U == sim_can_stats()->u32FreezeViolations);
+}
+
+/**
+* @brief            64 byte frame with BRS: nominal and data phase at their bit rates.
+*/
+static void test_tx(void)
+{
+	uint8_t au8Data[64];
+	uint32_t u32Bits = 0U;
+	uint32_t u32DataBits = 0U;
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < 64U; u32Index++)
+	{
+		au8Data[u32Index] = (uint8_t)(3U*u32Index);
+	}
+	sim_can_init();
+	FLEXCAN0_init();
+	sim_can_monitor(test_monitor);
+	s_u32Frames = 0U;
+
+	SIM_CHECK(1U == FLEXCAN0_send(0U, 0x555U, au8Data, 64U));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == s_u32Frames);
+	SIM_CHECK((SIM_CAN_FDF | SIM_CAN_BRS) == s_Frame.u8Flags);
+	SIM_CHECK(64U == s_Frame.u8Length);
+	SIM_CHECK(0 == memcmp(au8Data, s_Frame.au8Data, 64U));
+	SIM_CHECK(1U == (sim_can_regs(0U)->IFLAG1 & 1U));
+
+	u32Bits = sim_can_frame_bits(&s_Frame, &u32DataBits);
+	SIM_CHECK(((uint64_t)(u32Bits - u32DataBits) * TEST_NOMINAL_TICKS + (uint64_t)u32DataBits * TEST_DATA_TICKS) == s_u64Ticks);
+	SIM_CHECK(u32Bits - u32DataBits >= 30U);	/* SOF to BRS 17, CRC delimiter to IFS 13, plus stuff bits */
+	SIM_CHECK(u32DataBits >= 549U);				/* ESI, DLC, 512 data, stuff count 4, CRC 21, 7 fixed stuff */
+}
+
+/**
+* @brief            64 byte frame into MB4; a data phase at another bit rate is not received.
+*/
+static void test_rx(void)
+{
+	sim_can_frame_t frame;
+	uint8_t au8Data[64];
+	uint32_t u32Index = 0U;
+
+	sim_can_init();
+	FLEXCAN0_init();
+
+	(void)memset(&frame, 0, sizeof(frame));
+	frame.u32Id = 0x511U;
+	frame.u8Length = 64U;
+	frame.u8Flags = SIM_CAN_FDF | SIM_CAN_BRS;
+	for (u32Index = 0U; u32Index < 64U; u32Index++)
+	{
+		frame.au8Data[u32Index] = (uint8_t)(0xFFU - u32Index);
+	}
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, 0U));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(0x10U == (sim_can_regs(0U)->IFLAG1 & 0x10U));
+	SIM_CHECK(64U == FLEXCAN0_read_mb(4U, au8Data));
+	SIM_CHECK(0 == memcmp(au8Data, frame.au8Data, 64U));
+	SIM_CHECK(0U == (sim_can_regs(0U)->IFLAG1 & 0x10U));
+
+	sim_can_bus_rate(0U, 500000U, 1000000U);
+	SIM_CHECK(1U == sim_can_inject(0U, &frame, sim_can_now()));
+	SIM_CHECK(1U == sim_can_run_idle(SIM_CAN_MS(1U)));
+	SIM_CHECK(1U == sim_can_stats()->au32RateMismatch[0]);
+	SIM_CHECK(0U == (sim_can_regs(0U)->IFLAG1 & 0x10U));
+}
+
+/**
+* @brief            Reference copy, one MB RAM byte access per data byte (byte 0 in bits 31:24).
+*/
+static void test_write_bytes(uint8_t u8Mb, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	volatile uint8_t *pu8Mb = (volatile uint8_t *)FLEXCAN0_MB(u8Mb)->DATA;
+	uint32_t u32Padded = FLEXCAN_dlc_to_length(FLEXCAN_length_to_dlc(u8Length));
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u8Length; u32Index++)
+	{
+		pu8Mb[u32Index ^ 3U] = pu8Data[u32Index];
+	}
+	for (; u32Index < u32Padded; u32Index++)
+	{
+		pu8Mb[u32Index ^ 3U] = 0U;
+	}
+}
+
+/**
+* @brief            Reference copy back, one MB RAM byte access per data byte.
+*/
+static uint8_t test_read_bytes(uint8_t u8Mb, uint8_t *pu8Data)
+{
+	volatile flexcan_mb_t *pMb = FLEXCAN0_MB(u8Mb);
+	volatile const uint8_t *pu8Mb = (volatile const uint8_t *)pMb->DATA;
+	uint8_t u8Length = FLEXCAN_dlc_to_length((uint8_t)((pMb->CS & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT));
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < u8Length; u32Index++)
+	{
+		pu8Data[u32Index] = pu8Mb[u32Index ^ 3U];
+	}
+	return u8Length;
+}
+
+/**
+* @brief            Trapped access count, read as volatile so the inlined MB accesses stay on their side of it.
+*/
+static uint32_t test_accesses(void)
+{
+	return *(volatile const uint32_t *)&sim_can_stats()->u32Accesses;
+}
+
+/**
+* @brief            Host TSC cycles of one write and one read of u8Length bytes, trapping off.
+*/
+static double test_cycles(uint8_t u8Bytewise, uint8_t *pu8Data, uint8_t u8Length)
+{
+	uint64_t u64Start = 0U;
+	uint32_t u32Run = 0U;
+
+	sim_can_trap(0U, 0U);
+	u64Start = __rdtsc();
+	for (u32Run = 0U; u32Run < TEST_BENCH_RUNS; u32Run++)
+	{
+		if (0U != u8Bytewise)
+		{
+			test_write_bytes(TEST_BENCH_MB, pu8Data, u8Length);
+			(void)test_read_bytes(TEST_BENCH_MB, pu8Data);
+		}
+		else
+		{
+			(void)FLEXCAN0_write_payload(TEST_BENCH_MB, pu8Data, u8Length);
+			(void)FLEXCAN0_read_payload(TEST_BENCH_MB, pu8Data);
+		}
+		__asm volatile ("" ::: "memory");
+	}
+	u64Start = __rdtsc() - u64Start;
+	sim_can_trap(0U, 1U);
+
+	return (double)u64Start / TEST_BENCH_RUNS;
+}
+
+/**
+* @brief            FLEXCAN0_write_payload() / FLEXCAN0_read_payload() against the byte at a time copy:
+*					MB RAM accesses and bytes per cycle for 8, 12, 32 and 64 byte frames.
+*/
+static void test_bench(void)
+{
+	static const uint8_t au8Length[4] = {8U, 12U, 32U, 64U};
+	volatile flexcan_mb_t *pModel = NULL;
+	uint8_t au8Data[64];
+	uint8_t au8Back[64];
+	uint32_t au32Access[4];
+	uint32_t u32Words = 0U;
+	uint32_t u32Case = 0U;
+	uint32_t u32Index = 0U;
+	double dWord = 0.0;
+	double dByte = 0.0;
+
+	sim_can_init();
+	FLEXCAN0_init();
+	pModel = (volatile flexcan_mb_t *)&sim_can_regs(0U)->RAMn[TEST_BENCH_MB * FLEXCAN_MB_WORDS(FLEXCAN0_INST)];
+	for (u32Index = 0U; u32Index < 64U; u32Index++)
+	{
+		au8Data[u32Index] = (uint8_t)(7U * u32Index + 1U);
+	}
+
+	for (u32Case = 0U; u32Case < 4U; u32Case++)
+	{
+		/* DLC of the frame in the C/S word, MB stays inactive */
+		pModel->CS = (uint32_t)FLEXCAN_length_to_dlc(au8Length[u32Case]) << CAN_WMBn_CS_DLC_SHIFT;
+		u32Words = ((uint32_t)au8Length[u32Case] + 3U) >> 2U;
+
+		/* MB RAM accesses per copy, counted on the trapped registers */
+		au32Access[0] = test_accesses();
+		SIM_CHECK(1U == FLEXCAN0_write_payload(TEST_BENCH_MB, au8Data, au8Length[u32Case]));
+		au32Access[0] = test_accesses() - au32Access[0];
+		(void)memset(au8Back, 0, sizeof(au8Back));
+		au32Access[1] = test_accesses();
+		SIM_CHECK(au8Length[u32Case] == FLEXCAN0_read_payload(TEST_BENCH_MB, au8Back));
+		au32Access[1] = test_accesses() - au32Access[1];
+		SIM_CHECK(0 == memcmp(au8Data, au8Back, au8Length[u32Case]));
+
+		au32Access[2] = test_accesses();
+		test_write_bytes(TEST_BENCH_MB, au8Data, au8Length[u32Case]);
+		au32Access[2] = test_accesses() - au32Access[2];
+		(void)memset(au8Back, 0, sizeof(au8Back));
+		au32Access[3] = test_accesses();
+		SIM_CHECK(au8Length[u32Case] == test_read_bytes(TEST_BENCH_MB, au8Back));
+		au32Access[3] = test_accesses() - au32Access[3];
+		SIM_CHECK(0 == memcmp(au8Data, au8Back, au8Length[u32Case]));
+
+		dWord = test_cycles(0U, au8Back, au8Length[u32Case]);
+		dByte = test_cycles(1U, au8Back, au8Length[u32Case]);
+
+		(void)printf("test_flexcan_fd: %2u byte frame: word copy %2u + %2u MB accesses (write + read), %.2f bytes/cycle; "
+					 "byte copy %2u + %2u, %.2f bytes/cycle\n",
+					 au8Length[u32Case], au32Access[0], au32Access[1], 2.0 * au8Length[u32Case] / dWord,
+					 au32Access[2], au32Access[3], 2.0 * au8Length[u32Case] / dByte);
+
+		SIM_CHECK(u32Words == au32Access[0]);						/* One store per word */
+		SIM_CHECK((u32Words + 1U) == au32Access[1]);				/* C/S, then one load per word */
+		SIM_CHECK(au8Length[u32Case] == au32Access[2]);
+		SIM_CHECK((au8Length[u32Case] + 1U) == au32Access[3]);
+		SIM_CHECK(0 == memcmp(au8Data, au8Back, au8Length[u32Case]));	/* Timing runs copied right too */
+	}
+	SIM_CHECK(dWord < dByte);										/* 64 bytes: 16 words against 64 bytes */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Test entry.
+* @return           0 if all checks passed.
+*/
+int main(void)
+{
+	test_init();
+	test_tx();
+	test_rx();
+	test_bench();
+
+	return sim_check_result("test_flexcan_fd");
+}
+
+
+/* END test_flexcan_fd */
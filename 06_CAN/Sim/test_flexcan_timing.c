@@ -0,0 +1,213 @@
+/**
+* @file			test_flexcan_timing.c
+* @brief		Host test of the bit timing calculator (flexcan_timing.h)
+* @details		Table of known-good settings: classic CTRL1 from the 8 MHz oscillator at 250 kbit/s to
+*				1 Mbit/s, CBT nominal and FDCBT data phase from the 80 MHz SYS_CLK at 250 kbit/s to
+*				8 Mbit/s, sample points 75 to 87.5%. Each row is checked field by field, and the valid
+*				ones also for the exact bit rate and the sample point within half a time quantum.
+*				Settings the register ranges or TDCOFF cannot reach must be rejected.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim_can.h"
+#include "flexcan_timing.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Timing register the row is computed for */
+typedef enum
+{
+	TEST_CTRL1 = 0,
+	TEST_CBT,
+	TEST_FDCBT
+} test_reg_t;
+
+/* Setting and the expected solution, in time quanta */
+typedef struct
+{
+	test_reg_t eReg;
+	uint32_t u32Clk;
+	uint32_t u32Bitrate;
+	uint32_t u32SamplePoint;	/* Per mille */
+	uint32_t u32Valid;
+	uint32_t u32Presc;
+	uint32_t u32Tq;
+	uint32_t u32Prop;
+	uint32_t u32Pseg1;
+	uint32_t u32Pseg2;
+	uint32_t u32Rjw;
+} test_timing_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+static const char * const s_apcReg[3] = {"CTRL1", "CBT", "FDCBT"};
+
+/* Known-good settings; Valid 0: no setting reaches the bit rate and sample point */
+static const test_timing_t s_aTable[] =
+{
+	/* Reg		  Clk		  Bitrate	 SP	   Valid Presc TQ Prop PSEG1 PSEG2 RJW */
+	{TEST_CTRL1,  8000000U,   250000U,   875U, 1U,   2U,  16U, 8U,  5U,  2U,  2U},
+	{TEST_CTRL1,  8000000U,   500000U,   750U, 1U,   1U,  16U, 7U,  4U,  4U,  4U},	/* flexcan.h */
+	{TEST_CTRL1,  8000000U,   500000U,   875U, 1U,   1U,  16U, 8U,  5U,  2U,  2U},
+	{TEST_CTRL1,  8000000U,   1000000U,  750U, 1U,   1U,  8U,  3U,  2U,  2U,  2U},
+	{TEST_CTRL1,  8000000U,   2000000U,  750U, 0U,   1U,  4U,  1U,  1U,  1U,  1U},	/* Phase_Seg2 1 TQ */
+	{TEST_CBT,    80000000U,  250000U,   875U, 1U,   4U,  80U, 59U, 10U, 10U, 10U},
+	{TEST_CBT,    80000000U,  500000U,   750U, 1U,   2U,  80U, 39U, 20U, 20U, 20U},	/* flexcan_fd.c */
+	{TEST_CBT,    80000000U,  500000U,   800U, 1U,   2U,  80U, 47U, 16U, 16U, 16U},
+	{TEST_CBT,    80000000U,  1000000U,  800U, 1U,   1U,  80U, 47U, 16U, 16U, 16U},
+	{TEST_FDCBT,  80000000U,  2000000U,  750U, 1U,   2U,  20U, 9U,  5U,  5U,  5U},	/* flexcan_fd.c */
+	{TEST_FDCBT,  80000000U,  2000000U,  800U, 0U,   1U,  40U, 23U, 8U,  8U,  8U},	/* TDCOFF 32 with any prescaler */
+	{TEST_FDCBT,  80000000U,  5000000U,  750U, 1U,   1U,  16U, 7U,  4U,  4U,  4U},
+	{TEST_FDCBT,  80000000U,  5000000U,  800U, 1U,   1U,  16U, 9U,  3U,  3U,  3U},	/* 81.25% */
+	{TEST_FDCBT,  80000000U,  8000000U,  750U, 1U,   1U,  10U, 5U,  2U,  2U,  2U},
+	{TEST_FDCBT,  40000000U,  5000000U,  750U, 1U,   1U,  8U,  3U,  2U,  2U,  2U},
+	{TEST_FDCBT,  40000000U,  8000000U,  750U, 0U,   1U,  5U,  2U,  1U,  1U,  1U}	/* 5 TQ per bit */
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void test_solve(const test_timing_t *pSet, test_timing_t *pOut);
+static void test_table(void);
+static void test_registers(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Calculator output for the register, clock, bit rate and sample point of a row.
+*/
+static void test_solve(const test_timing_t *pSet, test_timing_t *pOut)
+{
+	uint32_t u32Clk = pSet->u32Clk;
+	uint32_t u32Br = pSet->u32Bitrate;
+	uint32_t u32Sp = pSet->u32SamplePoint;
+
+	*pOut = *pSet;
+	switch (pSet->eReg)
+	{
+		case TEST_CTRL1:
+			pOut->u32Valid = FLEXCAN_CTRL1_VALID(u32Clk, u32Br, u32Sp);
+			pOut->u32Presc = FLEXCAN_CTRL1_PRESC(u32Clk, u32Br, u32Sp);
+			pOut->u32Tq = FLEXCAN_CTRL1_TQ(u32Clk, u32Br, u32Sp);
+			pOut->u32Prop = FLEXCAN_CTRL1_PROP(u32Clk, u32Br, u32Sp);
+			pOut->u32Pseg1 = FLEXCAN_CTRL1_PSEG1(u32Clk, u32Br, u32Sp);
+			pOut->u32Pseg2 = FLEXCAN_CTRL1_PSEG2(u32Clk, u32Br, u32Sp);
+			pOut->u32Rjw = FLEXCAN_CTRL1_RJW(u32Clk, u32Br, u32Sp);
+			break;
+		case TEST_CBT:
+			pOut->u32Valid = FLEXCAN_CBT_VALID(u32Clk, u32Br, u32Sp);
+			pOut->u32Presc = FLEXCAN_CBT_PRESC(u32Clk, u32Br, u32Sp);
+			pOut->u32Tq = FLEXCAN_CBT_TQ(u32Clk, u32Br, u32Sp);
+			pOut->u32Prop = FLEXCAN_CBT_PROP(u32Clk, u32Br, u32Sp);
+			pOut->u32Pseg1 = FLEXCAN_CBT_PSEG1(u32Clk, u32Br, u32Sp);
+			pOut->u32Pseg2 = FLEXCAN_CBT_PSEG2(u32Clk, u32Br, u32Sp);
+			pOut->u32Rjw = FLEXCAN_CBT_RJW(u32Clk, u32Br, u32Sp);
+			break;
+		default:
+			pOut->u32Valid = FLEXCAN_FDCBT_VALID(u32Clk, u32Br, u32Sp);
+			pOut->u32Presc = FLEXCAN_FDCBT_PRESC(u32Clk, u32Br, u32Sp);
+			pOut->u32Tq = FLEXCAN_FDCBT_TQ(u32Clk, u32Br, u32Sp);
+			pOut->u32Prop = FLEXCAN_FDCBT_PROP(u32Clk, u32Br, u32Sp);
+			pOut->u32Pseg1 = FLEXCAN_FDCBT_PSEG1(u32Clk, u32Br, u32Sp);
+			pOut->u32Pseg2 = FLEXCAN_FDCBT_PSEG2(u32Clk, u32Br, u32Sp);
+			pOut->u32Rjw = FLEXCAN_FDCBT_RJW(u32Clk, u32Br, u32Sp);
+			break;
+	}
+}
+
+/**
+* @brief            Every row: fields as in the table, valid rows give the bit rate exactly and the sample
+*					point within half a time quantum.
+*/
+static void test_table(void)
+{
+	const test_timing_t *pRow = NULL;
+	test_timing_t out;
+	uint32_t u32Row = 0U;
+	uint32_t u32Sp = 0U;
+
+	for (u32Row = 0U; u32Row < (sizeof(s_aTable) / sizeof(s_aTable[0])); u32Row++)
+	{
+		pRow = &s_aTable[u32Row];
+		test_solve(pRow, &out);
+		u32Sp = ((1U + out.u32Prop + out.u32Pseg1) * 10000U) / out.u32Tq;	/* 0.1 per mille */
+		(void)printf("test_flexcan_timing: %-5s %2u MHz %4u kbit/s %5.1f%%: %s prescaler %u, %2u TQ = 1 + %u + %u + %u, "
+					 "RJW %u, sample point %5.2f%%\n",
+					 s_apcReg[pRow->eReg], pRow->u32Clk / 1000000U, pRow->u32Bitrate / 1000U,
+					 pRow->u32SamplePoint / 10.0, (0U != out.u32Valid) ? "valid,   " : "rejected,",
+					 out.u32Presc, out.u32Tq, out.u32Prop, out.u32Pseg1, out.u32Pseg2, out.u32Rjw, u32Sp / 100.0);
+
+		SIM_CHECK(pRow->u32Valid == out.u32Valid);
+		SIM_CHECK(pRow->u32Presc == out.u32Presc);
+		SIM_CHECK(pRow->u32Tq == out.u32Tq);
+		SIM_CHECK(pRow->u32Prop == out.u32Prop);
+		SIM_CHECK(pRow->u32Pseg1 == out.u32Pseg1);
+		SIM_CHECK(pRow->u32Pseg2 == out.u32Pseg2);
+		SIM_CHECK(pRow->u32Rjw == out.u32Rjw);
+		if (0U != out.u32Valid)
+		{
+			SIM_CHECK(pRow->u32Clk == (pRow->u32Bitrate * out.u32Presc * out.u32Tq));
+			SIM_CHECK(out.u32Tq == (1U + out.u32Prop + out.u32Pseg1 + out.u32Pseg2));
+			SIM_CHECK(abs((int32_t)((1U + out.u32Prop + out.u32Pseg1) * 1000U)
+						  - (int32_t)(pRow->u32SamplePoint * out.u32Tq)) <= 500);	/* Half a TQ */
+			SIM_CHECK(out.u32Rjw <= out.u32Pseg2);
+		}
+	}
+}
+
+/**
+* @brief            Register values: the CTRL1 value of the original 500 kbit/s setup, FDCBT fields and
+*					TDCOFF of the 2 Mbit/s data phase.
+*/
+static void test_registers(void)
+{
+	SIM_CHECK(0x00DB0006U == FLEXCAN_CTRL1_TIMING(8000000U, 500000U, 750U));
+
+	SIM_CHECK(CAN_CBT_BTF_MASK == (FLEXCAN_CBT_TIMING(80000000U, 500000U, 750U) & CAN_CBT_BTF_MASK));
+	SIM_CHECK((CAN_CBT_EPRESDIV(1U) | CAN_CBT_EPROPSEG(38U) | CAN_CBT_EPSEG1(19U) | CAN_CBT_EPSEG2(19U) | CAN_CBT_ERJW(19U))
+			  == (FLEXCAN_CBT_TIMING(80000000U, 500000U, 750U) & ~CAN_CBT_BTF_MASK));
+
+	SIM_CHECK((CAN_FDCBT_FPRESDIV(1U) | CAN_FDCBT_FPROPSEG(9U) | CAN_FDCBT_FPSEG1(4U) | CAN_FDCBT_FPSEG2(4U) | CAN_FDCBT_FRJW(4U))
+			  == FLEXCAN_FDCBT_TIMING(80000000U, 2000000U, 750U));
+	SIM_CHECK(30U == FLEXCAN_FDCBT_TDCOFF(80000000U, 2000000U, 750U));
+	SIM_CHECK(32U == FLEXCAN_FDCBT_TDCOFF(80000000U, 2000000U, 800U));		/* The rejected row */
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+int main(void)
+{
+	test_table();
+	test_registers();
+
+	return sim_check_result("test_flexcan_timing");
+}
+
+/* END test_flexcan_timing */
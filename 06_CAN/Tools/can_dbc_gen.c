@@ -0,0 +1,445 @@
+/**
+* @file			can_dbc_gen.c
+* @brief		Host generator of can_signal tables from a DBC file
+* @details		Writes a C header with one const can_signal_t table per DBC message (BO_), one
+*				CAN_SIGNAL_INTEL() / CAN_SIGNAL_MOTOROLA() entry per signal (SG_), and the message ID,
+*				signal count and signal index as macros. Host tool, not part of the firmware build:
+*
+*				cc -std=c99 -O2 -o can_dbc_gen can_dbc_gen.c
+*				can_dbc_gen [-p PREFIX] file.dbc > file_signals.h
+*
+*				Signals can_signal.c cannot hold are left out with a warning on stderr: longer than
+*				32 bits, outside the DLC, multiplexed (mN; the multiplexer M is kept) and IEEE float
+*				or double (SIG_VALTYPE_). So are messages longer than 8 bytes.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* SG_ line */
+typedef struct
+{
+	char acName[64];			/* Signal name */
+	char acUnit[32];			/* Unit */
+	uint32_t u32Start;			/* DBC start bit: LSB (Intel), MSB in sawtooth numbering (Motorola) */
+	uint32_t u32Length;			/* Length in bits */
+	uint8_t u8Motorola;			/* 1: @0, big endian */
+	uint8_t u8Signed;			/* 1: - */
+	uint8_t u8Mux;				/* 1: multiplexed signal (mN) */
+	uint8_t u8Float;			/* 1: IEEE float or double (SIG_VALTYPE_ 1 or 2) */
+	double dFactor;				/* Scale */
+	double dOffset;				/* Offset */
+} dbc_signal_t;
+
+/* BO_ line */
+typedef struct
+{
+	char acName[64];			/* Message name */
+	uint32_t u32Id;				/* DBC ID, bit 31 set for extended IDs (same as CAN_ID_EXT_FLAG) */
+	uint32_t u32Dlc;			/* Length in bytes */
+	uint32_t u32First;			/* First signal in s_aSignals */
+	uint32_t u32Count;			/* Signals */
+} dbc_message_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Messages and signals of one DBC file */
+#define DBC_MESSAGE_MAX			(1024U)
+#define DBC_SIGNAL_MAX			(16384U)
+
+/* Longest DBC line */
+#define DBC_LINE_MAX			(1024U)
+
+/* Signals the can_signal_t layout holds */
+#define DBC_SIGNAL_BITS_MAX		(32U)
+#define DBC_PAYLOAD_MAX			(8U)
+
+/* Pseudo message of signals without a message, written by some DBC editors */
+#define DBC_INDEPENDENT_ID		(0xC0000000U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+static dbc_message_t s_aMessages[DBC_MESSAGE_MAX];
+static uint32_t s_u32Messages = 0U;
+static dbc_signal_t s_aSignals[DBC_SIGNAL_MAX];
+static uint32_t s_u32Signals = 0U;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static int parse_message(const char *pcLine);
+static int parse_signal(const char *pcLine);
+static void parse_valtype(const char *pcLine);
+static const char *signal_skip_reason(const dbc_message_t *pMsg, const dbc_signal_t *pSig);
+static void print_upper(const char *pcText);
+static void print_float(double dValue);
+static void print_message(const dbc_message_t *pMsg, const char *pcPrefix, const char *pcPath);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Parse "BO_ <id> <name>: <dlc> <sender>".
+* @return           1 if read, 0 if malformed or the table is full.
+*/
+static int parse_message(const char *pcLine)
+{
+	dbc_message_t *pMsg = &s_aMessages[s_u32Messages];
+	unsigned long ulId = 0UL;
+	unsigned uDlc = 0U;
+	char *pcColon = NULL;
+
+	if ((s_u32Messages >= DBC_MESSAGE_MAX)
+		|| (3 != sscanf(pcLine, "BO_ %lu %63[^: ] : %u", &ulId, pMsg->acName, &uDlc)))
+	{
+		return 0;
+	}
+	pcColon = strchr(pMsg->acName, ':');
+	if (NULL != pcColon)
+	{
+		*pcColon = '\0';
+	}
+	pMsg->u32Id = (uint32_t)ulId;
+	pMsg->u32Dlc = uDlc;
+	pMsg->u32First = s_u32Signals;
+	pMsg->u32Count = 0U;
+	s_u32Messages++;
+	return 1;
+}
+
+/**
+* @brief            Parse "SG_ <name> [M|mN] : <start>|<len>@<order><sign> (<factor>,<offset>) [<min>|<max>] "<unit>" <receivers>".
+* @return           1 if read, 0 if malformed, outside a message or the table is full.
+*/
+static int parse_signal(const char *pcLine)
+{
+	dbc_signal_t *pSig = &s_aSignals[s_u32Signals];
+	char acMux[16];
+	char cOrder = 0;
+	char cSign = 0;
+	unsigned uStart = 0U;
+	unsigned uLength = 0U;
+	const char *pcRest = NULL;
+	const char *pcUnit = NULL;
+	size_t uUnit = 0U;
+	int iName = 0;
+
+	if ((0U == s_u32Messages) || (s_u32Signals >= DBC_SIGNAL_MAX))
+	{
+		return 0;
+	}
+	memset(pSig, 0, sizeof(*pSig));
+	if (1 != sscanf(pcLine, "SG_ %63s%n", pSig->acName, &iName))
+	{
+		return 0;
+	}
+	pcRest = pcLine + iName;
+	if ((1 == sscanf(pcRest, " %15s", acMux)) && (0 != strcmp(acMux, ":")))
+	{
+		pSig->u8Mux = ('m' == acMux[0]) ? 1U : 0U;		/* M: multiplexer switch, kept */
+	}
+	pcRest = strchr(pcRest, ':');
+	if ((NULL == pcRest)
+		|| (6 != sscanf(pcRest + 1, " %u|%u@%c%c ( %lf , %lf )", &uStart, &uLength, &cOrder, &cSign,
+						&pSig->dFactor, &pSig->dOffset))
+		|| (('0' != cOrder) && ('1' != cOrder)) || (('+' != cSign) && ('-' != cSign)))
+	{
+		return 0;
+	}
+	pSig->u32Start = uStart;
+	pSig->u32Length = uLength;
+	pSig->u8Motorola = ('0' == cOrder) ? 1U : 0U;
+	pSig->u8Signed = ('-' == cSign) ? 1U : 0U;
+
+	pcUnit = strchr(strchr(pcRest, ']') ? strchr(pcRest, ']') : pcRest, '"');
+	if (NULL != pcUnit)
+	{
+		uUnit = strcspn(pcUnit + 1, "\"");
+		uUnit = (uUnit < (sizeof(pSig->acUnit) - 1U)) ? uUnit : (sizeof(pSig->acUnit) - 1U);
+		memcpy(pSig->acUnit, pcUnit + 1, uUnit);
+		pSig->acUnit[uUnit] = '\0';
+	}
+
+	s_aMessages[s_u32Messages - 1U].u32Count++;
+	s_u32Signals++;
+	return 1;
+}
+
+/**
+* @brief            Parse "SIG_VALTYPE_ <id> <name> : <1|2>;", mark the signal as IEEE float or double.
+*/
+static void parse_valtype(const char *pcLine)
+{
+	unsigned long ulId = 0UL;
+	char acName[64];
+	unsigned uType = 0U;
+	uint32_t u32Msg = 0U;
+	uint32_t u32Sig = 0U;
+
+	if (3 != sscanf(pcLine, "SIG_VALTYPE_ %lu %63s : %u", &ulId, acName, &uType))
+	{
+		return;
+	}
+	for (u32Msg = 0U; u32Msg < s_u32Messages; u32Msg++)
+	{
+		if ((uint32_t)ulId != s_aMessages[u32Msg].u32Id)
+		{
+			continue;
+		}
+		for (u32Sig = 0U; u32Sig < s_aMessages[u32Msg].u32Count; u32Sig++)
+		{
+			if (0 == strcmp(acName, s_aSignals[s_aMessages[u32Msg].u32First + u32Sig].acName))
+			{
+				s_aSignals[s_aMessages[u32Msg].u32First + u32Sig].u8Float = (0U != uType) ? 1U : 0U;
+			}
+		}
+	}
+}
+
+/**
+* @brief            Check a signal against the can_signal_t limits and the message DLC.
+* @return           NULL if it can be written, otherwise the reason it is left out.
+*/
+static const char *signal_skip_reason(const dbc_message_t *pMsg, const dbc_signal_t *pSig)
+{
+	uint32_t u32Lsb = 0U;		/* Bit number of the LSB in the 64 bit value of can_signal.c */
+	uint32_t u32Msb = 0U;
+
+	if ((0U == pSig->u32Length) || (pSig->u32Length > DBC_SIGNAL_BITS_MAX))
+	{
+		return "length not 1-32 bits";
+	}
+	if (0U != pSig->u8Mux)
+	{
+		return "multiplexed";
+	}
+	if (0U != pSig->u8Float)
+	{
+		return "IEEE float";
+	}
+	if (pSig->u32Start > 63U)
+	{
+		return "start bit above 63";
+	}
+	if (0U == pSig->u8Motorola)
+	{
+		u32Msb = pSig->u32Start + pSig->u32Length - 1U;
+		return (u32Msb < (pMsg->u32Dlc * 8U)) ? NULL : "outside the DLC";
+	}
+
+	/* Motorola: byte 0 in bits 63:56, the LSB is len - 1 bits below the MSB */
+	u32Msb = (7U - (pSig->u32Start >> 3U)) * 8U + (pSig->u32Start & 7U);
+	if ((u32Msb + 1U) < pSig->u32Length)
+	{
+		return "outside the DLC";
+	}
+	u32Lsb = u32Msb + 1U - pSig->u32Length;
+	return (u32Lsb >= ((DBC_PAYLOAD_MAX - pMsg->u32Dlc) * 8U)) ? NULL : "outside the DLC";
+}
+
+/**
+* @brief            Print a DBC name as a macro name part: upper case, other characters as '_'.
+*/
+static void print_upper(const char *pcText)
+{
+	for (; '\0' != *pcText; pcText++)
+	{
+		putchar(isalnum((unsigned char)*pcText) ? toupper((unsigned char)*pcText) : '_');
+	}
+}
+
+/**
+* @brief            Print a float constant: shortest exact form, always with a '.' or exponent and 'f'.
+*/
+static void print_float(double dValue)
+{
+	char acText[40];
+
+	snprintf(acText, sizeof(acText), "%.9g", dValue);
+	printf("%s%sf", acText, (NULL == strpbrk(acText, ".en")) ? ".0" : "");
+}
+
+/**
+* @brief            Print the macros and the can_signal_t table of a message.
+*/
+static void print_message(const dbc_message_t *pMsg, const char *pcPrefix, const char *pcPath)
+{
+	const dbc_signal_t *pSig = NULL;
+	const char *pcSkip = NULL;
+	uint32_t u32Index = 0U;
+	uint32_t u32Kept = 0U;
+
+	for (u32Index = 0U; u32Index < pMsg->u32Count; u32Index++)
+	{
+		pSig = &s_aSignals[pMsg->u32First + u32Index];
+		pcSkip = signal_skip_reason(pMsg, pSig);
+		if (NULL != pcSkip)
+		{
+			fprintf(stderr, "%s: %s.%s left out: %s\n", pcPath, pMsg->acName, pSig->acName, pcSkip);
+		}
+		else
+		{
+			u32Kept++;
+		}
+	}
+	if (0U == u32Kept)
+	{
+		return;
+	}
+
+	printf("/* BO_ %lu %s: %u */\n", (unsigned long)pMsg->u32Id, pMsg->acName, (unsigned)pMsg->u32Dlc);
+	printf("#define %s_", pcPrefix);
+	print_upper(pMsg->acName);
+	printf("_ID\t(0x%XU)%s\n", (unsigned)pMsg->u32Id, (0U != (pMsg->u32Id & 0x80000000U)) ? "\t/* Extended, CAN_ID_EXT_FLAG set */" : "");
+	printf("#define %s_", pcPrefix);
+	print_upper(pMsg->acName);
+	printf("_COUNT\t(%uU)\n", (unsigned)u32Kept);
+
+	u32Kept = 0U;
+	for (u32Index = 0U; u32Index < pMsg->u32Count; u32Index++)
+	{
+		pSig = &s_aSignals[pMsg->u32First + u32Index];
+		if (NULL == signal_skip_reason(pMsg, pSig))
+		{
+			printf("#define %s_", pcPrefix);
+			print_upper(pMsg->acName);
+			putchar('_');
+			print_upper(pSig->acName);
+			printf("\t(%uU)\n", (unsigned)u32Kept++);
+		}
+	}
+
+	printf("static const can_signal_t s_a%s[%s_", pMsg->acName, pcPrefix);
+	print_upper(pMsg->acName);
+	printf("_COUNT] =\n{\n");
+	for (u32Index = 0U; u32Index < pMsg->u32Count; u32Index++)
+	{
+		pSig = &s_aSignals[pMsg->u32First + u32Index];
+		if (NULL != signal_skip_reason(pMsg, pSig))
+		{
+			continue;
+		}
+		printf("\t%s(%uU, %uU, %uU, ", (0U != pSig->u8Motorola) ? "CAN_SIGNAL_MOTOROLA" : "CAN_SIGNAL_INTEL",
+			   (unsigned)pSig->u32Start, (unsigned)pSig->u32Length, (unsigned)pSig->u8Signed);
+		print_float(pSig->dFactor);
+		printf(", ");
+		print_float(pSig->dOffset);
+		printf("),\t/* %s : %u|%u@%c%c \"%s\" */\n", pSig->acName, (unsigned)pSig->u32Start, (unsigned)pSig->u32Length,
+			   (0U != pSig->u8Motorola) ? '0' : '1', (0U != pSig->u8Signed) ? '-' : '+', pSig->acUnit);
+	}
+	printf("};\n\n");
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Tool entry.
+* @return           0 if done, 1 on a read or table size error, 2 on a usage error.
+*/
+int main(int argc, char **argv)
+{
+	const char *pcPath = NULL;
+	const char *pcPrefix = "DBC";
+	const char *pcLine = NULL;
+	char acLine[DBC_LINE_MAX];
+	uint32_t u32Line = 0U;
+	uint32_t u32Index = 0U;
+	int iArg = 0;
+	int iResult = 0;
+	FILE *pFile = NULL;
+
+	for (iArg = 1; iArg < argc; iArg++)
+	{
+		if ((0 == strcmp(argv[iArg], "-p")) && ((iArg + 1) < argc))
+		{
+			pcPrefix = argv[++iArg];
+		}
+		else
+		{
+			pcPath = argv[iArg];
+		}
+	}
+
+	if (NULL == pcPath)
+	{
+		fprintf(stderr, "usage: %s [-p PREFIX] file.dbc\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(pcPath, "r");
+	if (NULL == pFile)
+	{
+		perror(pcPath);
+		return 1;
+	}
+
+	while (NULL != fgets(acLine, sizeof(acLine), pFile))
+	{
+		u32Line++;
+		for (pcLine = acLine; (' ' == *pcLine) || ('\t' == *pcLine); pcLine++)
+		{
+		}
+		if (0 == strncmp(pcLine, "BO_ ", 4U))
+		{
+			if (0 == parse_message(pcLine))
+			{
+				fprintf(stderr, "%s:%u: bad or too many messages\n", pcPath, (unsigned)u32Line);
+				iResult = 1;
+			}
+		}
+		else if (0 == strncmp(pcLine, "SG_ ", 4U))
+		{
+			if (0 == parse_signal(pcLine))
+			{
+				fprintf(stderr, "%s:%u: bad or too many signals\n", pcPath, (unsigned)u32Line);
+				iResult = 1;
+			}
+		}
+		else if (0 == strncmp(pcLine, "SIG_VALTYPE_ ", 13U))
+		{
+			parse_valtype(pcLine);
+		}
+	}
+	fclose(pFile);
+
+	printf("/* Generated by can_dbc_gen from %s, do not edit. Include can_signal.h first */\n\n", pcPath);
+	printf("#ifndef %s_SIGNALS_H\n#define %s_SIGNALS_H\n\n", pcPrefix, pcPrefix);
+	for (u32Index = 0U; u32Index < s_u32Messages; u32Index++)
+	{
+		if (DBC_INDEPENDENT_ID == s_aMessages[u32Index].u32Id)
+		{
+			continue;
+		}
+		if (s_aMessages[u32Index].u32Dlc > DBC_PAYLOAD_MAX)
+		{
+			fprintf(stderr, "%s: %s left out: longer than 8 bytes\n", pcPath, s_aMessages[u32Index].acName);
+			continue;
+		}
+		print_message(&s_aMessages[u32Index], pcPrefix, pcPath);
+	}
+	printf("#endif\t/* %s_SIGNALS_H */\n", pcPrefix);
+
+	return iResult;
+}
+
+
+/* END can_dbc_gen */
@@ -0,0 +1,290 @@
+/**
+* @file			can_trace_dump.c
+* @brief		Host decoder for can_trace dumps
+* @details		Turns a trace stream (can_trace_header() followed by can_trace_read() output) into a
+*				candump log or Vector ASC text. Host tool, not part of the firmware build:
+*
+*				cc -std=c99 -O2 -o can_trace_dump can_trace_dump.c
+*				can_trace_dump [-a] [-i can0] trace.bin > trace.log
+*
+*				Record format, see can_trace.h: flags byte (TX, IDE, FDF, BRS, DLC), time delta to the
+*				previous record as zigzag varint, ID as varint, data bytes.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Decoded record */
+typedef struct
+{
+	int64_t s64Time;			/* Ticks since the start of the trace */
+	uint32_t u32Id;				/* Raw 11 or 29 bit ID */
+	uint8_t u8Flags;			/* Record flags byte */
+	uint8_t u8Length;			/* Number of data bytes */
+	uint8_t au8Data[64];		/* Data bytes */
+} trace_record_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Same values as can_trace.h */
+#define TRACE_HEADER_SIZE		(8U)
+#define TRACE_VERSION			(1U)
+#define TRACE_TX				(0x80U)
+#define TRACE_IDE				(0x40U)
+#define TRACE_FDF				(0x20U)
+#define TRACE_BRS				(0x10U)
+#define TRACE_DLC_MASK			(0x0FU)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Data bytes per DLC, classic frames stop at 8 */
+static const uint8_t s_au8DlcLength[2][16] =
+{
+	{0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 8U, 8U, 8U, 8U, 8U, 8U, 8U},
+	{0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U}
+};
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static int read_varint(FILE *pFile, uint64_t *pu64Value);
+static int read_record(FILE *pFile, trace_record_t *pRec);
+static void print_candump(const trace_record_t *pRec, uint32_t u32TickHz, const char *pcIface);
+static void print_asc(const trace_record_t *pRec, uint32_t u32TickHz);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Read varint.
+* @param[in]        pFile - Input.
+* @param[out]       pu64Value - Value.
+* @return           1 if read, 0 at end of input or on a malformed value.
+*/
+static int read_varint(FILE *pFile, uint64_t *pu64Value)
+{
+	uint64_t u64Value = 0U;
+	uint32_t u32Shift = 0U;
+	int c = 0;
+
+	do
+	{
+		c = fgetc(pFile);
+		if ((EOF == c) || (u32Shift > 63U))
+		{
+			return 0;
+		}
+		u64Value |= (uint64_t)((uint32_t)c & 0x7FU) << u32Shift;
+		u32Shift += 7U;
+	} while (0 != (c & 0x80));
+
+	*pu64Value = u64Value;
+	return 1;
+}
+
+/**
+* @brief            Read record.
+* @details          Decode the next record and advance the trace time.
+* @param[in]        pFile - Input.
+* @param[in,out]    pRec - Record, s64Time holds the time of the previous record on entry.
+* @return           1 if read, 0 at the end of the input, -1 if the last record is cut off.
+*/
+static int read_record(FILE *pFile, trace_record_t *pRec)
+{
+	uint64_t u64Delta = 0U;
+	uint64_t u64Id = 0U;
+	int c = fgetc(pFile);
+
+	if (EOF == c)
+	{
+		return 0;
+	}
+
+	pRec->u8Flags = (uint8_t)c;
+	if ((0 == read_varint(pFile, &u64Delta)) || (0 == read_varint(pFile, &u64Id)))
+	{
+		return -1;
+	}
+
+	pRec->s64Time += (int64_t)((u64Delta >> 1U) ^ (0U - (u64Delta & 1U)));	/* Undo zigzag */
+	pRec->u32Id = (uint32_t)u64Id;
+	pRec->u8Length = s_au8DlcLength[(0U != (pRec->u8Flags & TRACE_FDF)) ? 1U : 0U][pRec->u8Flags & TRACE_DLC_MASK];
+
+	if (pRec->u8Length != fread(pRec->au8Data, 1U, pRec->u8Length, pFile))
+	{
+		return -1;
+	}
+	return 1;
+}
+
+/**
+* @brief            Print candump log line.
+* @details          "(sec.usec) iface ID#DATA", CAN FD frames as "ID##<flags>DATA".
+*/
+static void print_candump(const trace_record_t *pRec, uint32_t u32TickHz, const char *pcIface)
+{
+	uint64_t u64Time = (pRec->s64Time > 0) ? (uint64_t)pRec->s64Time : 0U;
+	uint32_t u32Index = 0U;
+
+	printf("(%llu.%06llu) %s ", (unsigned long long)(u64Time / u32TickHz),
+		   (unsigned long long)((u64Time % u32TickHz) * 1000000U / u32TickHz), pcIface);
+	printf((0U != (pRec->u8Flags & TRACE_IDE)) ? "%08X" : "%03X", (unsigned)pRec->u32Id);
+
+	if (0U != (pRec->u8Flags & TRACE_FDF))
+	{
+		printf("##%X", (0U != (pRec->u8Flags & TRACE_BRS)) ? 1U : 0U);
+	}
+	else
+	{
+		putchar('#');
+	}
+
+	for (u32Index = 0U; u32Index < pRec->u8Length; u32Index++)
+	{
+		printf("%02X", pRec->au8Data[u32Index]);
+	}
+	putchar('\n');
+}
+
+/**
+* @brief            Print ASC line.
+* @details          Vector ASC, absolute time stamps, channel 1. CAN FD lines stop after the data bytes.
+*/
+static void print_asc(const trace_record_t *pRec, uint32_t u32TickHz)
+{
+	const char *pcDir = (0U != (pRec->u8Flags & TRACE_TX)) ? "Tx" : "Rx";
+	char acId[16];
+	uint32_t u32Index = 0U;
+
+	(void)snprintf(acId, sizeof(acId), (0U != (pRec->u8Flags & TRACE_IDE)) ? "%Xx" : "%X", (unsigned)pRec->u32Id);
+
+	if (0U != (pRec->u8Flags & TRACE_FDF))
+	{
+		printf("%11.6f CANFD   1 %s %8s %u 0 %x %2u", (double)pRec->s64Time / u32TickHz, pcDir, acId,
+			   (0U != (pRec->u8Flags & TRACE_BRS)) ? 1U : 0U, (unsigned)(pRec->u8Flags & TRACE_DLC_MASK), pRec->u8Length);
+	}
+	else
+	{
+		printf("%11.6f 1  %-15s %s   d %u", (double)pRec->s64Time / u32TickHz, acId, pcDir, pRec->u8Length);
+	}
+
+	for (u32Index = 0U; u32Index < pRec->u8Length; u32Index++)
+	{
+		printf(" %02X", pRec->au8Data[u32Index]);
+	}
+	putchar('\n');
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief			Decode a trace file to stdout.
+*/
+int main(int argc, char **argv)
+{
+	const char *pcIface = "can0";
+	const char *pcPath = NULL;
+	int iAsc = 0;
+	int iArg = 0;
+	int iResult = 0;
+	uint8_t au8Header[TRACE_HEADER_SIZE];
+	uint32_t u32TickHz = 0U;
+	uint32_t u32Count = 0U;
+	trace_record_t rec;
+	FILE *pFile = NULL;
+
+	for (iArg = 1; iArg < argc; iArg++)
+	{
+		if (0 == strcmp(argv[iArg], "-a"))
+		{
+			iAsc = 1;
+		}
+		else if ((0 == strcmp(argv[iArg], "-i")) && ((iArg + 1) < argc))
+		{
+			pcIface = argv[++iArg];
+		}
+		else
+		{
+			pcPath = argv[iArg];
+		}
+	}
+
+	if (NULL == pcPath)
+	{
+		fprintf(stderr, "usage: %s [-a] [-i iface] trace.bin\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(pcPath, "rb");
+	if (NULL == pFile)
+	{
+		perror(pcPath);
+		return 1;
+	}
+
+	if ((TRACE_HEADER_SIZE != fread(au8Header, 1U, TRACE_HEADER_SIZE, pFile))
+		|| (0 != memcmp(au8Header, "CTR", 3U)) || (TRACE_VERSION != au8Header[3]))
+	{
+		fprintf(stderr, "%s: not a version %u CAN trace\n", pcPath, TRACE_VERSION);
+		fclose(pFile);
+		return 1;
+	}
+
+	u32TickHz = (uint32_t)au8Header[4] | ((uint32_t)au8Header[5] << 8U)
+			  | ((uint32_t)au8Header[6] << 16U) | ((uint32_t)au8Header[7] << 24U);
+	if (0U == u32TickHz)
+	{
+		fprintf(stderr, "%s: tick rate is 0\n", pcPath);
+		fclose(pFile);
+		return 1;
+	}
+
+	if (0 != iAsc)
+	{
+		printf("date Thu Jan 1 00:00:00.000 1970\nbase hex  timestamps absolute\nno internal events logged\n");
+		printf("Begin Triggerblock Thu Jan 1 00:00:00.000 1970\n");
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	while (1 == (iResult = read_record(pFile, &rec)))
+	{
+		if (0 != iAsc)
+		{
+			print_asc(&rec, u32TickHz);
+		}
+		else
+		{
+			print_candump(&rec, u32TickHz, pcIface);
+		}
+		u32Count++;
+	}
+
+	if (0 != iAsc)
+	{
+		printf("End TriggerBlock\n");
+	}
+
+	if (iResult < 0)
+	{
+		fprintf(stderr, "%s: last record cut off after %u records\n", pcPath, (unsigned)u32Count);
+	}
+
+	fclose(pFile);
+	return (iResult < 0) ? 1 : 0;
+}
+
+
+/* END can_trace_dump */
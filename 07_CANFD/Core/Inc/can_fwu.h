@@ -0,0 +1,129 @@
+/**
+* @file				can_fwu.h
+* @brief            Header for can_fwu.c file
+*/
+
+#ifndef CAN_FWU_H
+#define CAN_FWU_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan_fd.h"
+#include "ftfc.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* Update service state, for the debugger */
+typedef struct
+{
+	uint8_t u8State;				/* CAN_FWU_IDLE / RUN / DONE / ERROR */
+	uint8_t u8Status;				/* Last error, CAN_FWU_OK if none */
+	uint32_t u32Addr;				/* Image start address */
+	uint32_t u32Size;				/* Image size in bytes */
+	uint32_t u32Crc;				/* Expected image CRC-32 */
+	uint32_t u32Received;			/* Image bytes received and programmed */
+	uint32_t u32Chunks;				/* Data frames received */
+} can_fwu_t;
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* CAN IDs: host commands, image data (64 byte frames), node responses */
+#define CAN_FWU_CTRL_ID				(0x7E0U)
+#define CAN_FWU_DATA_ID				(0x7E1U)
+#define CAN_FWU_RESP_ID				(0x7E8U)
+
+/* Msg buffers. MB0 and MB4 stay with the FLEXCAN0_transmit_msg() / FLEXCAN0_receive_msg() demo */
+#define CAN_FWU_DATA_MB				(1U)
+#define CAN_FWU_CTRL_MB				(2U)
+#define CAN_FWU_RESP_MB				(3U)
+
+/* Image bytes per data frame */
+#define CAN_FWU_CHUNK				(64U)
+
+/* Image region: the first 64 KB hold the bootloader itself */
+#define CAN_FWU_REGION_START		(0x00010000U)
+#define CAN_FWU_REGION_END			(FTFC_PFLASH_SIZE)
+
+/* Commands (byte 0 of a CAN_FWU_CTRL_ID frame). The response has bit 7 set */
+#define CAN_FWU_CMD_START			(0x01U)	/* [1..4] address, [5..8] size, [9..12] CRC-32, big endian */
+#define CAN_FWU_CMD_DATA			(0x02U)	/* Response only: ack of a data frame, value = bytes received */
+#define CAN_FWU_CMD_VERIFY			(0x03U)	/* Value = CRC-32 of the programmed image */
+#define CAN_FWU_RESP				(0x80U)
+
+/* Status (byte 1 of a response) */
+#define CAN_FWU_OK					(0U)
+#define CAN_FWU_ERR_RANGE			(1U)	/* Image outside the region or not sector aligned */
+#define CAN_FWU_ERR_FLASH			(2U)	/* Erase or program failed */
+#define CAN_FWU_ERR_SEQUENCE		(3U)	/* Unexpected command or data frame */
+#define CAN_FWU_ERR_CRC				(4U)	/* Image CRC-32 mismatch */
+
+/* States */
+#define CAN_FWU_IDLE				(0U)
+#define CAN_FWU_RUN					(1U)
+#define CAN_FWU_DONE				(2U)
+#define CAN_FWU_ERROR				(3U)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* Update service state */
+extern can_fwu_t CanFwu;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Start update service.
+* @details          Function to set up the command and data receive msg buffers. FLEXCAN0_init() first.
+* @param        	void.
+* @return           void.
+*/
+void can_fwu_init(void);
+
+/**
+* @brief            Run update service.
+* @details          Function to handle received commands and data frames. Call it from the main loop.
+* @param        	void.
+* @return           void.
+*/
+void can_fwu_poll(void);
+
+/**
+* @brief            CRC-32.
+* @details          Function to continue a CRC-32 (IEEE 802.3, as zlib crc32()) over u32Size bytes.
+* @param[in]        u32Crc - CRC of the previous bytes, 0 to start.
+* @param[in]        pu8Data - Data.
+* @param[in]        u32Size - Number of bytes.
+* @return           CRC-32.
+*/
+uint32_t can_fwu_crc32(uint32_t u32Crc, const uint8_t *pu8Data, uint32_t u32Size);
+
+
+#endif	/* CAN_FWU_H */
@@ -13,14 +13,29 @@
 * 3) internal and external interfaces from this unit
 ==================================================================================================*/
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
+#include "flexcan_core.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
 ==================================================================================================*/
-
 /*==================================================================================================
 *                                       LOCAL MACROS
 ==================================================================================================*/
+/* Largest CAN FD payload in bytes (DLC 15) */
+#define FLEXCAN_FD_MAX_PAYLOAD	(64U)
+
+/* FlexCAN instance driven by the FLEXCAN0_xxx functions */
+#define FLEXCAN0_INST			(0U)
+
+/* Registers of that instance */
+#define FLEXCAN0_BASE			FLEXCAN_BASE(FLEXCAN0_INST)
+
+/* Msg buffer mb: FDCTRL[MBDSR0] = FLEXCAN_CFG_MBDS, constant offset for a constant mb */
+#define FLEXCAN0_MB(mb)			FLEXCAN_MB(FLEXCAN0_INST, (mb))
+
+/* Number of msg buffers and payload bytes per msg buffer (7 x 64 bytes ... 32 x 8 bytes) */
+#define FLEXCAN0_MB_COUNT		FLEXCAN_MB_COUNT(FLEXCAN0_INST)
+#define FLEXCAN0_MB_PAYLOAD		FLEXCAN_MB_PAYLOAD(FLEXCAN0_INST)
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
@@ -43,11 +58,11 @@ extern uint32_t RxCODE;
 /* Received message ID */
 extern uint32_t RxID;
 
-/* Received message number of data bytes */
+/* Received message number of data bytes (decoded from DLC) */
 extern uint32_t RxLENGTH;
 
-/* Received message data (2 words) */
-extern uint32_t RxDATA[2];
+/* Received message data (up to 64 bytes, byte 0 first on the bus) */
+extern uint8_t RxDATA[FLEXCAN_FD_MAX_PAYLOAD];
 
 /* Received message time */
 extern uint32_t RxTIMESTAMP;
@@ -87,5 +102,74 @@ void FLEXCAN0_transmit_msg(void);
 */
 void FLEXCAN0_receive_msg(void);
 
+/**
+* @brief            DLC to payload length.
+* @details          Decodes a CAN FD DLC code (0..15) into 0..8, 12, 16, 20, 24, 32, 48 or 64 bytes.
+* @param        	u8Dlc: DLC code, only bits 3:0 are used.
+* @return           Number of payload bytes.
+*/
+uint8_t FLEXCAN_dlc_to_length(uint8_t u8Dlc);
+
+/**
+* @brief            Payload length to DLC.
+* @details          Returns the smallest DLC code whose payload holds u8Length bytes.
+* @param        	u8Length: number of data bytes, 0..64.
+* @return           DLC code, 0xFF if u8Length is above 64.
+*/
+uint8_t FLEXCAN_length_to_dlc(uint8_t u8Length);
+
+/**
+* @brief            Write msg buffer payload.
+* @details          Copies u8Length bytes into the data words of msg buffer u8Mb with a byte swap
+*					into bus order, padding with zeros up to the next DLC length.
+* @param        	u8Mb: msg buffer number.
+* @param        	pu8Data: payload bytes, byte 0 is sent first.
+* @param        	u8Length: number of data bytes, up to FLEXCAN0_MB_PAYLOAD.
+* @return           1 if written, 0 if u8Length does not fit the MB (nothing written).
+*/
+uint8_t FLEXCAN0_write_payload(uint8_t u8Mb, const uint8_t *pu8Data, uint8_t u8Length);
+
+/**
+* @brief            Read msg buffer payload.
+* @details          Decodes the DLC of msg buffer u8Mb and copies that many bytes into pu8Data
+*					with a byte swap from bus order, at most FLEXCAN0_MB_PAYLOAD. pu8Data must hold 64 bytes.
+* @param        	u8Mb: msg buffer number.
+* @param        	pu8Data: destination, byte 0 is the first byte received.
+* @return           Number of data bytes copied.
+*/
+uint8_t FLEXCAN0_read_payload(uint8_t u8Mb, uint8_t *pu8Data);
+
+/**
+* @brief            Set up receive msg buffer.
+* @details          Function to arm msg buffer u8Mb for reception of standard ID u32Id at run time.
+*					The global mask checks all ID bits (FLEXCAN_reset_mbs()).
+* @param        	u8Mb: msg buffer number.
+* @param        	u32Id: standard ID.
+* @return           void.
+*/
+void FLEXCAN0_set_rx_mb(uint8_t u8Mb, uint32_t u32Id);
+
+/**
+* @brief            Send frame.
+* @details          Function to load msg buffer u8Mb with standard ID u32Id and u8Length data bytes and
+*					start the transmission. The caller checks that the MB is not still transmitting.
+* @param        	u8Mb: msg buffer number.
+* @param        	u32Id: standard ID.
+* @param        	pu8Data: payload bytes, byte 0 is sent first.
+* @param        	u8Length: number of data bytes, up to FLEXCAN0_MB_PAYLOAD.
+* @return           1 if started, 0 if u8Length does not fit the MB.
+*/
+uint8_t FLEXCAN0_send(uint8_t u8Mb, uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+
+/**
+* @brief            Read receive msg buffer.
+* @details          Function to lock msg buffer u8Mb, copy its payload, unlock it and clear its flag.
+*					The MB is free for the next frame on return.
+* @param        	u8Mb: msg buffer number.
+* @param        	pu8Data: destination, must hold 64 bytes.
+* @return           Number of data bytes copied.
+*/
+uint8_t FLEXCAN0_read_mb(uint8_t u8Mb, uint8_t *pu8Data);
+
 
 #endif	/* FLEXCAN_FD_H */
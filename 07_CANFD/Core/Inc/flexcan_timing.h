@@ -0,0 +1,193 @@
+/**
+* @file				flexcan_timing.h
+* @brief            Compile time FlexCAN bit timing calculator
+* @details          Derives CTRL1 (classic), CBT (nominal phase) and FDCBT (data phase) values from the CAN
+*                   clock, the bit rate and the sample point. Everything is an integer constant expression,
+*                   so the *_VALID() macros can be checked with #if / #error and out-of-range settings never
+*                   reach the target.
+*
+*                   Time quanta per bit (TQ) are chosen as large as the segment limits allow, using the
+*                   smallest prescaler that keeps Phase_Seg2 in range and divides the clock exactly:
+*                     Prescaler  = ceil(Fcanclk / (Bitrate x TQ_LIMIT)) ... + 3, first exact one
+*                     TQ         = Fcanclk / (Bitrate x Prescaler)
+*                     Phase_Seg2 = TQ - round(TQ x SamplePoint)
+*                     Phase_Seg1 = Phase_Seg2 (clipped to its range), Prop_Seg = the rest
+*                     RJW        = Phase_Seg2 (clipped to its range)
+*                   The sample point is given in per mille (750U = 75%).
+*/
+
+#ifndef FLEXCAN_TIMING_H
+#define FLEXCAN_TIMING_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+#define FLEXCAN_BT_MIN(a, b)		(((a) < (b)) ? (a) : (b))
+
+/* Largest TQ per bit that keeps Phase_Seg2 <= p2max at sample point sp */
+#define FLEXCAN_BT_TQ_LIMIT(sp, tqmax, p2max) \
+			FLEXCAN_BT_MIN((tqmax), ((p2max) * 1000U) / (1000U - (sp)))
+
+/* Smallest prescaler that keeps TQ per bit within the limit */
+#define FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) \
+			(((clk) + (br) * FLEXCAN_BT_TQ_LIMIT(sp, tqmax, p2max) - 1U) / ((br) * FLEXCAN_BT_TQ_LIMIT(sp, tqmax, p2max)))
+
+/* Prescaler p gives the bit rate exactly */
+#define FLEXCAN_BT_EXACT(clk, br, p)	(((clk) % ((br) * (p))) == 0U)
+
+/* Prescaler: first of PRESC0..PRESC0+3 that gives the bit rate exactly */
+#define FLEXCAN_BT_PRESC(clk, br, sp, tqmax, p2max) \
+			(FLEXCAN_BT_EXACT(clk, br, FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max)) \
+				? FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) \
+			: FLEXCAN_BT_EXACT(clk, br, FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) + 1U) \
+				? (FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) + 1U) \
+			: FLEXCAN_BT_EXACT(clk, br, FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) + 2U) \
+				? (FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) + 2U) \
+				: (FLEXCAN_BT_PRESC0(clk, br, sp, tqmax, p2max) + 3U))
+
+/* Time quanta per bit */
+#define FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max) \
+			((clk) / ((br) * FLEXCAN_BT_PRESC(clk, br, sp, tqmax, p2max)))
+
+/* Phase_Seg2 and Prop_Seg + Phase_Seg1, in TQ */
+#define FLEXCAN_BT_TSEG2(tq, sp)	((tq) - ((tq) * (sp) + 500U) / 1000U)
+#define FLEXCAN_BT_TSEG1(tq, sp)	((tq) - 1U - FLEXCAN_BT_TSEG2(tq, sp))
+
+/* Phase_Seg1 in TQ: as close to Phase_Seg2 as the Prop_Seg range allows */
+#define FLEXCAN_BT_PSEG1_PREF(tq, sp, p1max, propmin) \
+			FLEXCAN_BT_MIN(FLEXCAN_BT_MIN(FLEXCAN_BT_TSEG2(tq, sp), (p1max)), FLEXCAN_BT_TSEG1(tq, sp) - (propmin))
+#define FLEXCAN_BT_PSEG1(tq, sp, p1max, propmin, propmax) \
+			(((FLEXCAN_BT_TSEG1(tq, sp) - FLEXCAN_BT_PSEG1_PREF(tq, sp, p1max, propmin)) > (propmax)) \
+			? (FLEXCAN_BT_TSEG1(tq, sp) - (propmax)) : FLEXCAN_BT_PSEG1_PREF(tq, sp, p1max, propmin))
+
+/* Prop_Seg in TQ */
+#define FLEXCAN_BT_PROP(tq, sp, p1max, propmin, propmax) \
+			(FLEXCAN_BT_TSEG1(tq, sp) - FLEXCAN_BT_PSEG1(tq, sp, p1max, propmin, propmax))
+
+/* Resync jump width in TQ */
+#define FLEXCAN_BT_RJW(tq, sp, rjwmax)	FLEXCAN_BT_MIN(FLEXCAN_BT_TSEG2(tq, sp), (rjwmax))
+
+/* All segments in range and the bit rate is met exactly */
+#define FLEXCAN_BT_VALID(clk, br, sp, tqmax, prescmax, propmin, propmax, p1max, p2max) \
+			(((sp) >= 500U) && ((sp) < 1000U) \
+			&& (FLEXCAN_BT_PRESC(clk, br, sp, tqmax, p2max) <= (prescmax)) \
+			&& (((clk) % ((br) * FLEXCAN_BT_PRESC(clk, br, sp, tqmax, p2max))) == 0U) \
+			&& (FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max) >= (3U + (propmin))) \
+			&& (FLEXCAN_BT_TSEG2(FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max), sp) >= 2U) \
+			&& (FLEXCAN_BT_TSEG2(FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max), sp) <= (p2max)) \
+			&& (FLEXCAN_BT_PSEG1(FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max), sp, p1max, propmin, propmax) >= 1U) \
+			&& (FLEXCAN_BT_PSEG1(FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max), sp, p1max, propmin, propmax) <= (p1max)) \
+			&& (FLEXCAN_BT_PROP(FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max), sp, p1max, propmin, propmax) >= (propmin)) \
+			&& (FLEXCAN_BT_PROP(FLEXCAN_BT_TQ(clk, br, sp, tqmax, p2max), sp, p1max, propmin, propmax) <= (propmax)))
+
+/*--------------------------------------------------------------------------------------------------
+* CTRL1: classic CAN. PRESDIV 1-256, PROPSEG 1-8, PSEG1 1-8, PSEG2 2-8, RJW 1-4 (field = value - 1)
+--------------------------------------------------------------------------------------------------*/
+#define FLEXCAN_CTRL1_TQ(clk, br, sp)		FLEXCAN_BT_TQ(clk, br, sp, 25U, 8U)
+#define FLEXCAN_CTRL1_PRESC(clk, br, sp)	FLEXCAN_BT_PRESC(clk, br, sp, 25U, 8U)
+#define FLEXCAN_CTRL1_PROP(clk, br, sp)		FLEXCAN_BT_PROP(FLEXCAN_CTRL1_TQ(clk, br, sp), sp, 8U, 1U, 8U)
+#define FLEXCAN_CTRL1_PSEG1(clk, br, sp)	FLEXCAN_BT_PSEG1(FLEXCAN_CTRL1_TQ(clk, br, sp), sp, 8U, 1U, 8U)
+#define FLEXCAN_CTRL1_PSEG2(clk, br, sp)	FLEXCAN_BT_TSEG2(FLEXCAN_CTRL1_TQ(clk, br, sp), sp)
+#define FLEXCAN_CTRL1_RJW(clk, br, sp)		FLEXCAN_BT_RJW(FLEXCAN_CTRL1_TQ(clk, br, sp), sp, 4U)
+
+/* Usable with #if */
+#define FLEXCAN_CTRL1_VALID(clk, br, sp)	FLEXCAN_BT_VALID(clk, br, sp, 25U, 256U, 1U, 8U, 8U, 8U)
+
+/* CTRL1 timing fields (CLKSRC, SMP and the interrupt masks are not included) */
+#define FLEXCAN_CTRL1_TIMING(clk, br, sp) \
+			( CAN_CTRL1_PRESDIV(FLEXCAN_CTRL1_PRESC(clk, br, sp) - 1U) \
+			| CAN_CTRL1_PROPSEG(FLEXCAN_CTRL1_PROP(clk, br, sp) - 1U) \
+			| CAN_CTRL1_PSEG1(FLEXCAN_CTRL1_PSEG1(clk, br, sp) - 1U) \
+			| CAN_CTRL1_PSEG2(FLEXCAN_CTRL1_PSEG2(clk, br, sp) - 1U) \
+			| CAN_CTRL1_RJW(FLEXCAN_CTRL1_RJW(clk, br, sp) - 1U))
+
+/*--------------------------------------------------------------------------------------------------
+* CBT: nominal phase. EPRESDIV 1-1024, EPROPSEG 1-64, EPSEG1 1-32, EPSEG2 2-32, ERJW 1-32 (field = value - 1)
+--------------------------------------------------------------------------------------------------*/
+#define FLEXCAN_CBT_TQ(clk, br, sp)			FLEXCAN_BT_TQ(clk, br, sp, 129U, 32U)
+#define FLEXCAN_CBT_PRESC(clk, br, sp)		FLEXCAN_BT_PRESC(clk, br, sp, 129U, 32U)
+#define FLEXCAN_CBT_PROP(clk, br, sp)		FLEXCAN_BT_PROP(FLEXCAN_CBT_TQ(clk, br, sp), sp, 32U, 1U, 64U)
+#define FLEXCAN_CBT_PSEG1(clk, br, sp)		FLEXCAN_BT_PSEG1(FLEXCAN_CBT_TQ(clk, br, sp), sp, 32U, 1U, 64U)
+#define FLEXCAN_CBT_PSEG2(clk, br, sp)		FLEXCAN_BT_TSEG2(FLEXCAN_CBT_TQ(clk, br, sp), sp)
+#define FLEXCAN_CBT_RJW(clk, br, sp)		FLEXCAN_BT_RJW(FLEXCAN_CBT_TQ(clk, br, sp), sp, 32U)
+
+/* Usable with #if */
+#define FLEXCAN_CBT_VALID(clk, br, sp)		FLEXCAN_BT_VALID(clk, br, sp, 129U, 1024U, 1U, 64U, 32U, 32U)
+
+/* CBT value, BTF=1: CBT replaces the CTRL1 timing fields */
+#define FLEXCAN_CBT_TIMING(clk, br, sp) \
+			( CAN_CBT_BTF_MASK \
+			| CAN_CBT_EPRESDIV(FLEXCAN_CBT_PRESC(clk, br, sp) - 1U) \
+			| CAN_CBT_EPROPSEG(FLEXCAN_CBT_PROP(clk, br, sp) - 1U) \
+			| CAN_CBT_EPSEG1(FLEXCAN_CBT_PSEG1(clk, br, sp) - 1U) \
+			| CAN_CBT_EPSEG2(FLEXCAN_CBT_PSEG2(clk, br, sp) - 1U) \
+			| CAN_CBT_ERJW(FLEXCAN_CBT_RJW(clk, br, sp) - 1U))
+
+/*--------------------------------------------------------------------------------------------------
+* FDCBT: data phase. FPRESDIV 1-1024, FPROPSEG 0-31 (field = value), FPSEG1 1-8, FPSEG2 2-8, FRJW 1-8
+--------------------------------------------------------------------------------------------------*/
+#define FLEXCAN_FDCBT_TQ(clk, br, sp)		FLEXCAN_BT_TQ(clk, br, sp, 48U, 8U)
+#define FLEXCAN_FDCBT_PRESC(clk, br, sp)	FLEXCAN_BT_PRESC(clk, br, sp, 48U, 8U)
+#define FLEXCAN_FDCBT_PROP(clk, br, sp)		FLEXCAN_BT_PROP(FLEXCAN_FDCBT_TQ(clk, br, sp), sp, 8U, 0U, 31U)
+#define FLEXCAN_FDCBT_PSEG1(clk, br, sp)	FLEXCAN_BT_PSEG1(FLEXCAN_FDCBT_TQ(clk, br, sp), sp, 8U, 0U, 31U)
+#define FLEXCAN_FDCBT_PSEG2(clk, br, sp)	FLEXCAN_BT_TSEG2(FLEXCAN_FDCBT_TQ(clk, br, sp), sp)
+#define FLEXCAN_FDCBT_RJW(clk, br, sp)		FLEXCAN_BT_RJW(FLEXCAN_FDCBT_TQ(clk, br, sp), sp, 8U)
+
+/* Transceiver delay compensation offset in CAN clocks: data phase sample point, (FPROPSEG + FPSEG1 + 2) x (FPRESDIV + 1) */
+#define FLEXCAN_FDCBT_TDCOFF(clk, br, sp) \
+			((FLEXCAN_FDCBT_PROP(clk, br, sp) + FLEXCAN_FDCBT_PSEG1(clk, br, sp) + 1U) * FLEXCAN_FDCBT_PRESC(clk, br, sp))
+
+/* Usable with #if, includes the 5 bit TDCOFF range */
+#define FLEXCAN_FDCBT_VALID(clk, br, sp) \
+			(FLEXCAN_BT_VALID(clk, br, sp, 48U, 1024U, 0U, 31U, 8U, 8U) && (FLEXCAN_FDCBT_TDCOFF(clk, br, sp) <= 31U))
+
+/* FDCBT value */
+#define FLEXCAN_FDCBT_TIMING(clk, br, sp) \
+			( CAN_FDCBT_FPRESDIV(FLEXCAN_FDCBT_PRESC(clk, br, sp) - 1U) \
+			| CAN_FDCBT_FPROPSEG(FLEXCAN_FDCBT_PROP(clk, br, sp)) \
+			| CAN_FDCBT_FPSEG1(FLEXCAN_FDCBT_PSEG1(clk, br, sp) - 1U) \
+			| CAN_FDCBT_FPSEG2(FLEXCAN_FDCBT_PSEG2(clk, br, sp) - 1U) \
+			| CAN_FDCBT_FRJW(FLEXCAN_FDCBT_RJW(clk, br, sp) - 1U))
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+
+
+#endif	/* FLEXCAN_TIMING_H */
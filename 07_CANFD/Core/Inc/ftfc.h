@@ -0,0 +1,105 @@
+/**
+* @file				ftfc.h
+* @brief            Header for ftfc.c file
+*/
+
+#ifndef FTFC_H
+#define FTFC_H
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "device_registers.h"	/* include peripheral declarations S32K144 */
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* P-Flash geometry: 512 KB, 4 KB erase sectors, 8 byte program phrases */
+#define FTFC_PFLASH_SIZE			(0x00080000U)
+#define FTFC_SECTOR_SIZE			(4096U)
+#define FTFC_PHRASE_SIZE			(8U)
+
+/* Error bits of a command result (FSTAT) */
+#define FTFC_ERROR_MASK				(FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK | FTFC_FSTAT_MGSTAT0_MASK)
+
+/* Starts the loaded command and waits for CCIF. It must not run from P-Flash, which is busy meanwhile,
+   so the default is FTFC_launch_ram(). A host flash model can define it (before this header, e.g. in
+   its device_registers.h) to execute the command on its model */
+#ifndef FTFC_LAUNCH
+#define FTFC_LAUNCH(pFstat)			FTFC_launch_ram(pFstat)
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Launch command from RAM.
+* @details          Function to clear CCIF, which starts the loaded command, and wait for CCIF again with
+*                   code that runs from SRAM. Interrupts must be disabled (vectors and handlers are in flash).
+* @param[in]        pFstat - FTFC->FSTAT.
+* @return           void.
+*/
+void FTFC_launch_ram(volatile uint8_t *pFstat);
+
+/**
+* @brief            Erase sector.
+* @details          Function to erase the 4 KB P-Flash sector at u32Addr (ERSSCR). Blocks with interrupts
+*                   disabled until the sector is erased.
+* @param[in]        u32Addr - Sector address, FTFC_SECTOR_SIZE aligned, below FTFC_PFLASH_SIZE.
+* @return           0 on success, else FSTAT error bits (FTFC_ERROR_MASK). ACCERR without a command if
+*                   u32Addr is outside P-Flash.
+*/
+uint8_t FTFC_erase_sector(uint32_t u32Addr);
+
+/**
+* @brief            Program phrase.
+* @details          Function to program 8 bytes at u32Addr (PGM8). Blocks with interrupts disabled until the
+*                   phrase is written. The phrase must be erased.
+* @param[in]        u32Addr - Phrase address, FTFC_PHRASE_SIZE aligned, below FTFC_PFLASH_SIZE.
+* @param[in]        pu8Data - 8 data bytes, byte 0 at u32Addr.
+* @return           0 on success, else FSTAT error bits (FTFC_ERROR_MASK). ACCERR without a command if
+*                   u32Addr is outside P-Flash.
+*/
+uint8_t FTFC_program_phrase(uint32_t u32Addr, const uint8_t *pu8Data);
+
+/**
+* @brief            Invalidate flash cache.
+* @details          Function to invalidate the code cache (LMEM), so reads after programming see the new data.
+* @param        	void.
+* @return           void.
+*/
+void FTFC_invalidate_cache(void);
+
+
+#endif	/* FTFC_H */
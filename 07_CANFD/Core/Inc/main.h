@@ -15,6 +15,7 @@
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
 #include "clocks_and_modes.h"
 #include "flexcan_fd.h"
+#include "can_fwu.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
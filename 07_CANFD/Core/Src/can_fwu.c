@@ -0,0 +1,323 @@
+/**
+* @file			can_fwu.c
+* @brief		Firmware update over CAN FD
+* @details		The host sends START (address, size, CRC-32), the image as 64 byte data frames and
+*				VERIFY. A data frame is copied from its msg buffer to RAM and acknowledged before its 8
+*				phrases are programmed, so the host sends the next frame while the flash is busy: the
+*				msg buffer receives chunk n+1 while the RAM copy of chunk n is written. One frame in
+*				flight keeps the receive msg buffer from being overwritten.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "can_fwu.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Response length: command, status, 32 bit value */
+#define CAN_FWU_RESP_LENGTH			(6U)
+
+/* Big endian 32 bit field */
+#define CAN_FWU_GET32(p)			(((uint32_t)(p)[0] << 24U) | ((uint32_t)(p)[1] << 16U) \
+									| ((uint32_t)(p)[2] << 8U) | (uint32_t)(p)[3])
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* CRC-32 of one nibble, reflected polynomial 0xEDB88320 */
+static const uint32_t s_au32CrcNibble[16] =
+{
+	0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+	0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* RAM copy of the data frame being programmed */
+static uint8_t s_au8Chunk[CAN_FWU_CHUNK];
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+/* Update service state */
+can_fwu_t CanFwu;
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static void can_fwu_respond(uint8_t u8Cmd, uint8_t u8Status, uint32_t u32Value);
+static uint8_t can_fwu_fail(uint8_t u8Status);
+static void can_fwu_start(const uint8_t *pu8Cmd, uint8_t u8Length);
+static void can_fwu_verify(void);
+static void can_fwu_data(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Send response.
+* @details          Wait for the previous response to leave the msg buffer and send the next one.
+* @param[in]        u8Cmd - Command answered.
+* @param[in]        u8Status - CAN_FWU_OK or error.
+* @param[in]        u32Value - Command specific value.
+* @return           void.
+*/
+static void can_fwu_respond(uint8_t u8Cmd, uint8_t u8Status, uint32_t u32Value)
+{
+	uint8_t au8Resp[CAN_FWU_RESP_LENGTH];
+
+	au8Resp[0] = u8Cmd | CAN_FWU_RESP;
+	au8Resp[1] = u8Status;
+	au8Resp[2] = (uint8_t)(u32Value >> 24U);
+	au8Resp[3] = (uint8_t)(u32Value >> 16U);
+	au8Resp[4] = (uint8_t)(u32Value >> 8U);
+	au8Resp[5] = (uint8_t)u32Value;
+
+	while (FLEXCAN_TX_DATA == ((FLEXCAN0_MB(CAN_FWU_RESP_MB)->CS & FLEXCAN_MB_CS_CODE_MASK) >> FLEXCAN_MB_CS_CODE_SHIFT))
+	{
+		FLEXCAN_POLL_HOOK(FLEXCAN0_BASE);		/* Previous response still pending */
+	}
+	(void)FLEXCAN0_send(CAN_FWU_RESP_MB, CAN_FWU_RESP_ID, au8Resp, CAN_FWU_RESP_LENGTH);
+}
+
+/**
+* @brief            Enter error state.
+* @param[in]        u8Status - Error.
+* @return           u8Status.
+*/
+static uint8_t can_fwu_fail(uint8_t u8Status)
+{
+	CanFwu.u8State = CAN_FWU_ERROR;
+	CanFwu.u8Status = u8Status;
+
+	return u8Status;
+}
+
+/**
+* @brief            START command.
+* @details          Check the image range and erase its sectors. The host waits for the response,
+*                   about 12 ms per 4 KB sector.
+* @param[in]        pu8Cmd - Command frame.
+* @param[in]        u8Length - Command frame length.
+* @return           void.
+*/
+static void can_fwu_start(const uint8_t *pu8Cmd, uint8_t u8Length)
+{
+	uint32_t u32Sector = 0U;
+	uint8_t u8Status = CAN_FWU_OK;
+
+	CanFwu.u8State = CAN_FWU_IDLE;
+	CanFwu.u8Status = CAN_FWU_OK;
+	CanFwu.u32Received = 0U;
+	CanFwu.u32Chunks = 0U;
+
+	if (u8Length < 13U)
+	{
+		can_fwu_respond(CAN_FWU_CMD_START, can_fwu_fail(CAN_FWU_ERR_SEQUENCE), 0U);
+		return;
+	}
+
+	CanFwu.u32Addr = CAN_FWU_GET32(&pu8Cmd[1]);
+	CanFwu.u32Size = CAN_FWU_GET32(&pu8Cmd[5]);
+	CanFwu.u32Crc = CAN_FWU_GET32(&pu8Cmd[9]);
+
+	if ((0U != (CanFwu.u32Addr & (FTFC_SECTOR_SIZE - 1U))) || (CanFwu.u32Addr < CAN_FWU_REGION_START)
+		|| (CanFwu.u32Addr >= CAN_FWU_REGION_END)		/* Before the subtraction below, which would wrap */
+		|| (0U == CanFwu.u32Size) || (CanFwu.u32Size > (CAN_FWU_REGION_END - CanFwu.u32Addr)))
+	{
+		can_fwu_respond(CAN_FWU_CMD_START, can_fwu_fail(CAN_FWU_ERR_RANGE), 0U);
+		return;
+	}
+
+	for (u32Sector = CanFwu.u32Addr; u32Sector < (CanFwu.u32Addr + CanFwu.u32Size); u32Sector += FTFC_SECTOR_SIZE)
+	{
+		if (0U != FTFC_erase_sector(u32Sector))
+		{
+			u8Status = can_fwu_fail(CAN_FWU_ERR_FLASH);
+			break;
+		}
+	}
+
+	if (CAN_FWU_OK == u8Status)
+	{
+		CanFwu.u8State = CAN_FWU_RUN;
+	}
+	can_fwu_respond(CAN_FWU_CMD_START, u8Status, CanFwu.u32Size);
+}
+
+/**
+* @brief            VERIFY command.
+* @details          Compute the CRC-32 of the programmed image and compare it with the START value.
+* @param        	void.
+* @return           void.
+*/
+static void can_fwu_verify(void)
+{
+	uint32_t u32Crc = 0U;
+	uint8_t u8Status = CAN_FWU_OK;
+
+	if (CAN_FWU_DONE != CanFwu.u8State)
+	{
+		can_fwu_respond(CAN_FWU_CMD_VERIFY, (CAN_FWU_ERROR == CanFwu.u8State) ? CanFwu.u8Status : CAN_FWU_ERR_SEQUENCE, 0U);
+		return;
+	}
+
+	FTFC_invalidate_cache();					/* The cache may hold erased lines of the image */
+	u32Crc = can_fwu_crc32(0U, (const uint8_t *)CanFwu.u32Addr, CanFwu.u32Size);
+	if (u32Crc != CanFwu.u32Crc)
+	{
+		u8Status = can_fwu_fail(CAN_FWU_ERR_CRC);
+	}
+	can_fwu_respond(CAN_FWU_CMD_VERIFY, u8Status, u32Crc);
+}
+
+/**
+* @brief            Data frame.
+* @details          Copy the frame out of its msg buffer, acknowledge it so the host sends the next one,
+*                   then program the copy. Every frame but the last carries CAN_FWU_CHUNK bytes.
+* @param        	void.
+* @return           void.
+*/
+static void can_fwu_data(void)
+{
+	uint32_t u32Addr = CanFwu.u32Addr + CanFwu.u32Received;
+	uint32_t u32Left = CanFwu.u32Size - CanFwu.u32Received;
+	uint32_t u32Count = 0U;
+	uint32_t u32Index = 0U;
+
+	u32Count = FLEXCAN0_read_mb(CAN_FWU_DATA_MB, s_au8Chunk);	/* Data MB free for the next frame */
+	CanFwu.u32Chunks++;
+
+	if (CAN_FWU_RUN != CanFwu.u8State)
+	{
+		can_fwu_respond(CAN_FWU_CMD_DATA, (CAN_FWU_ERROR == CanFwu.u8State) ? CanFwu.u8Status : CAN_FWU_ERR_SEQUENCE,
+						CanFwu.u32Received);
+		return;
+	}
+
+	if (u32Count > u32Left)
+	{
+		u32Count = u32Left;						/* DLC padding of the last frame */
+	}
+	else if ((u32Count < CAN_FWU_CHUNK) && (u32Count != u32Left))
+	{
+		can_fwu_respond(CAN_FWU_CMD_DATA, can_fwu_fail(CAN_FWU_ERR_SEQUENCE), CanFwu.u32Received);
+		return;
+	}
+	else
+	{
+	}
+
+	CanFwu.u32Received += u32Count;
+	can_fwu_respond(CAN_FWU_CMD_DATA, CAN_FWU_OK, CanFwu.u32Received);	/* Host sends the next frame now */
+
+	for (u32Index = u32Count; 0U != (u32Index & (FTFC_PHRASE_SIZE - 1U)); u32Index++)
+	{
+		s_au8Chunk[u32Index] = 0xFFU;			/* Pad the last phrase with the erased value */
+	}
+	for (u32Index = 0U; u32Index < u32Count; u32Index += FTFC_PHRASE_SIZE)
+	{
+		if (0U != FTFC_program_phrase(u32Addr + u32Index, &s_au8Chunk[u32Index]))
+		{
+			(void)can_fwu_fail(CAN_FWU_ERR_FLASH);	/* Reported by the next ack or VERIFY */
+			return;
+		}
+	}
+
+	if (CanFwu.u32Received == CanFwu.u32Size)
+	{
+		CanFwu.u8State = CAN_FWU_DONE;
+	}
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Start update service.
+* @details          Function to set up the command and data receive msg buffers. FLEXCAN0_init() first.
+* @param        	void.
+* @return           void.
+*/
+void can_fwu_init(void)
+{
+	CanFwu.u8State = CAN_FWU_IDLE;
+	CanFwu.u8Status = CAN_FWU_OK;
+
+	FLEXCAN0_set_rx_mb(CAN_FWU_DATA_MB, CAN_FWU_DATA_ID);
+	FLEXCAN0_set_rx_mb(CAN_FWU_CTRL_MB, CAN_FWU_CTRL_ID);
+}
+
+/**
+* @brief            Run update service.
+* @details          Function to handle received commands and data frames. Call it from the main loop.
+* @param        	void.
+* @return           void.
+*/
+void can_fwu_poll(void)
+{
+	uint8_t au8Cmd[FLEXCAN_FD_MAX_PAYLOAD];
+	uint8_t u8Length = 0U;
+
+	if (0U != (FLEXCAN0_BASE->IFLAG1 & (1UL << CAN_FWU_DATA_MB)))
+	{
+		can_fwu_data();
+	}
+
+	if (0U != (FLEXCAN0_BASE->IFLAG1 & (1UL << CAN_FWU_CTRL_MB)))
+	{
+		u8Length = FLEXCAN0_read_mb(CAN_FWU_CTRL_MB, au8Cmd);
+		if ((0U != u8Length) && (CAN_FWU_CMD_START == au8Cmd[0]))
+		{
+			can_fwu_start(au8Cmd, u8Length);
+		}
+		else if ((0U != u8Length) && (CAN_FWU_CMD_VERIFY == au8Cmd[0]))
+		{
+			can_fwu_verify();
+		}
+		else
+		{
+			can_fwu_respond((0U != u8Length) ? au8Cmd[0] : 0U, CAN_FWU_ERR_SEQUENCE, 0U);
+		}
+	}
+}
+
+/**
+* @brief            CRC-32.
+* @details          Function to continue a CRC-32 (IEEE 802.3, as zlib crc32()) over u32Size bytes.
+* @param[in]        u32Crc - CRC of the previous bytes, 0 to start.
+* @param[in]        pu8Data - Data.
+* @param[in]        u32Size - Number of bytes.
+* @return           CRC-32.
+*/
+uint32_t can_fwu_crc32(uint32_t u32Crc, const uint8_t *pu8Data, uint32_t u32Size)
+{
+	uint32_t u32Index = 0U;
+
+	u32Crc = ~u32Crc;
+	for (u32Index = 0U; u32Index < u32Size; u32Index++)
+	{
+		u32Crc ^= pu8Data[u32Index];
+		u32Crc = (u32Crc >> 4U) ^ s_au32CrcNibble[u32Crc & 0x0FU];
+		u32Crc = (u32Crc >> 4U) ^ s_au32CrcNibble[u32Crc & 0x0FU];
+	}
+
+	return ~u32Crc;
+}
+
+
+/* END can_fwu */
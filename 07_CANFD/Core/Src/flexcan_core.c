@@ -0,0 +1,150 @@
+/**
+* @file			flexcan_core.c
+* @brief		FlexCAN instance configuration shared by the classic and FD drivers
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "flexcan_core.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Instance base addresses */
+static CAN_Type * const s_apCan[FLEXCAN_INSTANCE_COUNT] = CAN_BASE_PTRS;
+
+/* Instance PCC slots */
+static const uint8_t s_au8PccIndex[FLEXCAN_INSTANCE_COUNT] =
+{
+	PCC_FlexCAN0_INDEX, PCC_FlexCAN1_INDEX, PCC_FlexCAN2_INDEX
+};
+
+/* Instance MB RAM size in words */
+static const uint8_t s_au8RamWords[FLEXCAN_INSTANCE_COUNT] =
+{
+	FLEXCAN_RAM_WORDS(0U), FLEXCAN_RAM_WORDS(1U), FLEXCAN_RAM_WORDS(2U)
+};
+
+/* Instance number of RXIMR registers (one per MB) */
+static const uint8_t s_au8MaxMb[FLEXCAN_INSTANCE_COUNT] =
+{
+	FLEXCAN_MAX_MB(0U), FLEXCAN_MAX_MB(1U), FLEXCAN_MAX_MB(2U)
+};
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Enter freeze mode.
+* @details          Enable the instance clock, select the CAN clock source and enter freeze mode.
+*					Bit timing is left to the caller.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u8Clksrc - 0: oscillator clock, 1: peripheral clock (SYS_CLK).
+* @return           void.
+*/
+void FLEXCAN_enter_freeze(uint8_t u8Inst, uint8_t u8Clksrc)
+{
+	CAN_Type *pCan = s_apCan[u8Inst];
+
+	PCC->PCCn[s_au8PccIndex[u8Inst]] |= PCC_PCCn_CGC_MASK; 	/* CGC=1: enable clock to FlexCAN */
+
+	pCan->MCR |= CAN_MCR_MDIS_MASK;         				/* MDIS=1: Disable module before selecting clock  */
+	if (0U != u8Clksrc)
+	{
+		pCan->CTRL1 |= CAN_CTRL1_CLKSRC_MASK;  				/* CLKSRC=1: Clock Source = peripheral clock      */
+	}
+	else
+	{
+		pCan->CTRL1 &= ~CAN_CTRL1_CLKSRC_MASK;  			/* CLKSRC=0: Clock Source = oscillator            */
+	}
+	pCan->MCR &= ~CAN_MCR_MDIS_MASK;        				/* MDIS=0; Enable module config. (Sets FRZ, HALT) */
+
+	while (!((pCan->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT))  /* wait for FRZACK=1 on freeze mode entry/exit */
+	{
+		FLEXCAN_POLL_HOOK(pCan);
+	}
+}
+
+/**
+* @brief            Leave freeze mode.
+* @details          Write the final MCR value, which negates FRZ/HALT, and wait for the module to be ready.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @param[in]        u32Mcr - MCR value.
+* @return           void.
+*/
+void FLEXCAN_leave_freeze(uint8_t u8Inst, uint32_t u32Mcr)
+{
+	CAN_Type *pCan = s_apCan[u8Inst];
+
+	pCan->MCR = u32Mcr;
+
+	while ((pCan->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)  /* wait for FRZACK to clear (not in freeze mode) */
+	{
+		FLEXCAN_POLL_HOOK(pCan);
+	}
+
+	while ((pCan->MCR & CAN_MCR_NOTRDY_MASK) >> CAN_MCR_NOTRDY_SHIFT)  /* wait for NOTRDY to clear (module ready) */
+	{
+		FLEXCAN_POLL_HOOK(pCan);
+	}
+}
+
+/**
+* @brief            Reset msg buffers.
+* @details          In freeze mode, clear the whole MB RAM (all CODE=0, inactive) and set every
+*					individual and the global mask to check all ID bits.
+* @param[in]        u8Inst - FlexCAN instance (0-2).
+* @return           void.
+*/
+void FLEXCAN_reset_mbs(uint8_t u8Inst)
+{
+	CAN_Type *pCan = s_apCan[u8Inst];
+	uint32_t u32Index = 0U;
+
+	for (u32Index = 0U; u32Index < s_au8RamWords[u8Inst]; u32Index++)
+	{
+		pCan->RAMn[u32Index] = 0U;  					/* Clear msg buf word */
+	}
+
+	for (u32Index = 0U; u32Index < s_au8MaxMb[u8Inst]; u32Index++)
+	{
+		pCan->RXIMR[u32Index] = 0xFFFFFFFFU;    		/* Check all ID bits for incoming messages */
+	}
+
+	pCan->RXMGMASK = 0x1FFFFFFFU;                  		/* Global acceptance mask: check all ID bits */
+}
+
+
+/* END flexcan_core */
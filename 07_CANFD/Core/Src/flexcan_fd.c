@@ -9,7 +9,9 @@
 * 2) needed interfaces from external units
 * 3) internal and external interfaces from this unit
 ==================================================================================================*/
+#include <string.h>
 #include "flexcan_fd.h"
+#include "flexcan_timing.h"
 
 /*==================================================================================================
 *                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
@@ -18,12 +20,68 @@
 /*==================================================================================================
 *                                       LOCAL MACROS
 ==================================================================================================*/
-/* Msg Buffer Size. (2 words hdr + 16 words data = 18 words) */
-#define MSG_BUF_SIZE		(18U)
+/* CAN clock. CLKSRC=1: Fcanclk = peripheral clock = SYS_CLK = 80 MHz */
+#define FLEXCAN0_CLK_HZ					(80000000U)
+
+/* Nominal (arbitration) phase bit rate and sample point in per mille */
+#define FLEXCAN0_NOMINAL_BITRATE		(500000U)
+#define FLEXCAN0_NOMINAL_SAMPLE_POINT	(750U)
+
+/* Data phase bit rate and sample point in per mille (e.g. 5000000U or 8000000U with 1000000U nominal) */
+#define FLEXCAN0_DATA_BITRATE			(2000000U)
+#define FLEXCAN0_DATA_SAMPLE_POINT		(750U)
+
+#if !FLEXCAN_CBT_VALID(FLEXCAN0_CLK_HZ, FLEXCAN0_NOMINAL_BITRATE, FLEXCAN0_NOMINAL_SAMPLE_POINT)
+#error "FLEXCAN0: nominal bit rate / sample point not reachable with CBT segment ranges"
+#endif
+
+#if !FLEXCAN_FDCBT_VALID(FLEXCAN0_CLK_HZ, FLEXCAN0_DATA_BITRATE, FLEXCAN0_DATA_SAMPLE_POINT)
+#error "FLEXCAN0: data bit rate / sample point not reachable with FDCBT segment ranges"
+#endif
+
+/* Reverse byte order of a word: MB data words are big-endian (byte 0 in bits 31:24) */
+#if defined(__CC_ARM)
+#define FLEXCAN_BSWAP32(x)	(__rev(x))
+#else
+#define FLEXCAN_BSWAP32(x)	(__builtin_bswap32(x))
+#endif
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
 ==================================================================================================*/
+/* DLC code -> number of payload bytes */
+static const uint8_t s_au8DlcToLength[16U] =
+{
+	0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U
+};
+
+/* Number of payload bytes -> smallest DLC code that holds them */
+static const uint8_t s_au8LengthToDlc[FLEXCAN_FD_MAX_PAYLOAD + 1U] =
+{
+	 0U,  1U,  2U,  3U,  4U,  5U,  6U,  7U,  8U,					/*  0 ..  8 */
+	 9U,  9U,  9U,  9U,											/*  9 .. 12 */
+	10U, 10U, 10U, 10U,											/* 13 .. 16 */
+	11U, 11U, 11U, 11U,											/* 17 .. 20 */
+	12U, 12U, 12U, 12U,											/* 21 .. 24 */
+	13U, 13U, 13U, 13U, 13U, 13U, 13U, 13U,						/* 25 .. 32 */
+	14U, 14U, 14U, 14U, 14U, 14U, 14U, 14U,						/* 33 .. 40 */
+	14U, 14U, 14U, 14U, 14U, 14U, 14U, 14U,						/* 41 .. 48 */
+	15U, 15U, 15U, 15U, 15U, 15U, 15U, 15U,						/* 49 .. 56 */
+	15U, 15U, 15U, 15U, 15U, 15U, 15U, 15U						/* 57 .. 64 */
+};
+
+/* Payload sent by FLEXCAN0_transmit_msg() */
+static const uint8_t s_au8TxMsgData[FLEXCAN_FD_MAX_PAYLOAD] =
+{
+	0xA5U, 0x11U, 0x22U, 0x33U, 0x44U, 0x55U, 0x66U, 0x77U,
+	0x88U, 0x99U, 0xAAU, 0xBBU, 0xCCU, 0xDDU, 0xEEU, 0xFFU,
+	0x00U, 0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U,
+	0x08U, 0x09U, 0x0AU, 0x0BU, 0x0CU, 0x0DU, 0x0EU, 0x0FU,
+	0x10U, 0x11U, 0x12U, 0x13U, 0x14U, 0x15U, 0x16U, 0x17U,
+	0x18U, 0x19U, 0x1AU, 0x1BU, 0x1CU, 0x1DU, 0x1EU, 0x1FU,
+	0x20U, 0x21U, 0x22U, 0x23U, 0x24U, 0x25U, 0x26U, 0x27U,
+	0x28U, 0x29U, 0x2AU, 0x2BU, 0x2CU, 0x2DU, 0x2EU, 0x2FU
+};
 
 /*==================================================================================================
 *                                      LOCAL VARIABLES
@@ -42,11 +100,11 @@ uint32_t RxCODE = 0U;
 /* Received message ID */
 uint32_t RxID = 0U;
 
-/* Received message number of data bytes */
+/* Received message number of data bytes (decoded from DLC) */
 uint32_t RxLENGTH = 0U;
 
-/* Received message data (2 words) */
-uint32_t RxDATA[2] = {0U};
+/* Received message data (up to 64 bytes, byte 0 first on the bus) */
+uint8_t RxDATA[FLEXCAN_FD_MAX_PAYLOAD] = {0U};
 
 /* Received message time */
 uint32_t RxTIMESTAMP = 0U;
@@ -70,61 +128,32 @@ uint32_t RxTIMESTAMP = 0U;
 */
 void FLEXCAN0_init(void)
 {
-	uint32_t u32Index = 0U;
+	FLEXCAN_enter_freeze(FLEXCAN0_INST, 1U);	/* CLKSRC=1: Clock Source = peripheral clock (SYS_CLK 80 MHz) */
 	
-	PCC->PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK; 	/* CGC=1: enable clock to FlexCAN0 */
-	CAN0->MCR |= CAN_MCR_MDIS_MASK; 						/* MDIS=1: Disable module before selecting clock */
-	CAN0->CTRL1 |= CAN_CTRL1_CLKSRC_MASK; 					/* CLKSRC=1: Clock Source = BUSCLK (40 MHz) */
-	CAN0->MCR &= ~CAN_MCR_MDIS_MASK; 						/* MDIS=0; Enable module config. (Sets FRZ, HALT)*/
-	while (!((CAN0->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)) /* wait for FRZACK=1 on freeze mode entry/exit */
-	{
-	}
-	
-	/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
-	CAN0->CBT = CAN_CBT_BTF_MASK
-				| CAN_CBT_EPRESDIV(1U)
-				| CAN_CBT_EPSEG2(15U)    /* Prescaler = CANCLK / Sclock = 40 MHz / 40 MHz = 1 */
-				| CAN_CBT_EPSEG1(15U)    /* EPRESDIV = Prescaler - 1 = 0 */
-				| CAN_CBT_EPROPSEG(47U)  /* EPSEG2 = 15 */
-				| CAN_CBT_ERJW(15U);     /* EPSEG1 = 15 */
-                                         /* EPROPSEG = 46 */
-                                         /* ERJW = 15 */
-                                         /* BITRATEn =Fcanclk /( [(1 + (EPSEG1+1) + (EPSEG2+1) + (EPROPSEG + 1)] x (EPRESDIV+1)) */
-                                         /*          = 40 MHz /( [(1 + ( 15   +1) + ( 15   +1) + (   46    + 1)] x (    0   +1)) */
-                                         /*          = 40 MHz /( [1+16+16+47] x 1) = 40 MHz /(80x1) = 500 Kz */
-
-	/* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
-	CAN0->FDCBT = CAN_CBT_EPSEG2(3U)	 /* Prescaler = CANCLK / Sclock = 40 MHz / 40 MHz = 1 */
-				| CAN_CBT_EPSEG1(7U)	 /* FPRESDIV = Prescaler - 1 = 0 */
-				| CAN_CBT_EPROPSEG(7U)	 /* FPSEG2 = 3 */
-				| CAN_CBT_ERJW(3U)		 /* FPSEG1 = 7 */
-				| CAN_FDCBT_FPRESDIV(1U);/* FPROPSEG = 7 */
-										 /* FRJW = 3 */
-										 /* BITRATEf =Fcanclk /( [(1 + (FPSEG1+1) + (FPSEG2+1) + (FPROPSEG)] x (FPRESDIV+!)) */
-										 /*          = 40 MHz /( [(1 + (  7   +1) + (  3   +1) + (   7    )] x (    0   +1)) */
-										 /*          = 40 MHz /( [1+8+4+7] x 1) = 40 MHz /(20x1) = 40 MHz / 20 = 2 MHz  */
+	/* Configure nominal phase: 500 KHz bit time, 75% sample point */
+	FLEXCAN0_BASE->CBT = FLEXCAN_CBT_TIMING(FLEXCAN0_CLK_HZ, FLEXCAN0_NOMINAL_BITRATE, FLEXCAN0_NOMINAL_SAMPLE_POINT);
+										/* Prescaler = 2: Sclock = 80 MHz / 2 = 40 MHz */
+										/* 80 time quanta: 1 + Prop_Seg 39 + Phase_Seg1 20 + Phase_Seg2 20 */
+										/* BITRATEn = 40 MHz / 80 = 500 KHz */
+
+	/* Configure data phase: 2 MHz bit time, 75% sample point */
+	FLEXCAN0_BASE->FDCBT = FLEXCAN_FDCBT_TIMING(FLEXCAN0_CLK_HZ, FLEXCAN0_DATA_BITRATE, FLEXCAN0_DATA_SAMPLE_POINT);
+										/* Prescaler = 2: Sclock = 80 MHz / 2 = 40 MHz */
+										/* 20 time quanta: 1 + Prop_Seg 9 + Phase_Seg1 5 + Phase_Seg2 5 */
+										/* BITRATEf = 40 MHz / 20 = 2 MHz */
 	
-	CAN0->FDCTRL = CAN_FDCTRL_FDRATE_MASK  	/* Configure bit rate switch, data size, transcv'r delay  */
-				| CAN_FDCTRL_MBDSR0(3U)   	/* BRS=1: enable Bit Rate Swtich in frame's header */
-				| CAN_FDCTRL_TDCEN_MASK  	/* MBDSR1: Not applicable */
-				| CAN_FDCTRL_TDCOFF(5U);   	/* MBDSR0=3: Region 0 has 64 bytes data in frame's payload */
-											/* TDCEN=1: enable Transceiver Delay Compensation */
-											/* TDCOFF=5: 5 CAN clocks (300us) offset used */
+											/* Configure bit rate switch, data size, transcv'r delay  */
+	FLEXCAN0_BASE->FDCTRL = CAN_FDCTRL_FDRATE_MASK  	/* BRS=1: enable Bit Rate Swtich in frame's header */
+				| CAN_FDCTRL_MBDSR0(FLEXCAN_CFG_MBDS)	/* MBDSR0: data size from flexcan_cfg.h (3: 7 MBs of 64 bytes) */
+				| CAN_FDCTRL_TDCEN_MASK  	/* TDCEN=1: enable Transceiver Delay Compensation */
+				| CAN_FDCTRL_TDCOFF(FLEXCAN_FDCBT_TDCOFF(FLEXCAN0_CLK_HZ, FLEXCAN0_DATA_BITRATE, FLEXCAN0_DATA_SAMPLE_POINT));
+											/* TDCOFF: data phase sample point in CAN clocks (30 for 2 MHz) */
 	 
-	for(u32Index = 0U; u32Index < 128U; u32Index++)	/* CAN0: clear 128 words RAM in FlexCAN 0 */ 
-	{    
-		CAN0->RAMn[u32Index] = 0U;       			/* Clear msg buf words. All buffers CODE=0 (inactive) */
-	}
-	
-	for(u32Index = 0U; u32Index < 16U; u32Index++)	/* In FRZ mode, init CAN0 16 msg buf filters */ 
-	{
-		CAN0->RXIMR[u32Index] = 0xFFFFFFFFU;  		/* Check all ID bits for incoming messages */
-	}
-	
-	CAN0->RXMGMASK = 0x1FFFFFFFU;  					/* Global acceptance mask: check all ID bits */
+	FLEXCAN_reset_mbs(FLEXCAN0_INST);			/* CAN0: clear 128 words RAM, all buffers CODE=0 (inactive), check all ID bits */
 
 	/* Message Buffer 4 - receive setup: */
-	CAN0->RAMn[4U*MSG_BUF_SIZE + 0U] = 0xC4000000U; /* Msg Buf 4, word 0: Enable for reception */
+	FLEXCAN0_MB(4U)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_RX_EMPTY, 0U);
+													/* Msg Buf 4, word 0: Enable for reception */
 													/* EDL=1: Extended Data Length for CAN FD */
 													/* BRS = 1: Bit Rate Switch enabled */
 													/* ESI = 0: Error state */
@@ -132,19 +161,12 @@ void FLEXCAN0_init(void)
 													/* IDE=0: Standard ID */
 													/* SRR, RTR, TIME STAMP = 0: not applicable */
 
-	CAN0->RAMn[4U*MSG_BUF_SIZE + 1U] = 0x14440000U; /* Msg Buf 4, word 1: Standard ID = 0x511 */
+	FLEXCAN0_MB(4U)->ID = FLEXCAN_MB_ID(0x511U);	/* Msg Buf 4, word 1: Standard ID = 0x511 */
 
 	/* PRIO = 0: CANFD not used */
-	CAN0->CTRL2 |= CAN_CTRL2_ISOCANFDEN_MASK;       /* Enable CRC fix for ISO CAN FD */
-	CAN0->MCR = 0x0000081FU;       					/* Negate FlexCAN 1 halt state & enable CAN FD for 32 MBs */
-	
-	while ((CAN0->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)  /* wait for FRZACK to clear (not in freeze mode) */
-	{
-	}
-	
-	while ((CAN0->MCR & CAN_MCR_NOTRDY_MASK) >> CAN_MCR_NOTRDY_SHIFT)  /* wait for NOTRDY to clear (module ready)  */
-	{
-	}
+	FLEXCAN0_BASE->CTRL2 |= CAN_CTRL2_ISOCANFDEN_MASK;	/* Enable CRC fix for ISO CAN FD */
+	FLEXCAN_leave_freeze(FLEXCAN0_INST, 0x00000800U | CAN_MCR_MAXMB(FLEXCAN0_MB_COUNT - 1U));
+													/* Negate FlexCAN 1 halt state & enable CAN FD for all MBs */
 }
 
 /**
@@ -155,12 +177,12 @@ void FLEXCAN0_init(void)
 */
 void FLEXCAN0_transmit_msg(void)
 { 
-	CAN0->IFLAG1 = 0x00000001U;  				  /* Clear CAN 0 MB 0 flag without clearing others*/
+	FLEXCAN0_BASE->IFLAG1 = 0x00000001U;  				  /* Clear CAN 0 MB 0 flag without clearing others*/
 
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 2U] = 0xA5112233U; /* MB0 word 2: data word 0 */
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 3U] = 0x44556677U; /* MB0 word 3: data word 1 */
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 1U] = 0x15540000U; /* MB0 word 1: Tx msg with STD ID 0x555 */
-	CAN0->RAMn[0U*MSG_BUF_SIZE + 0U] = 0xCC4F0000U | 8U << CAN_WMBn_CS_DLC_SHIFT;
+	(void)FLEXCAN0_write_payload(0U, s_au8TxMsgData, FLEXCAN0_MB_PAYLOAD);	/* MB0 words 2..17: 64 data bytes */
+	FLEXCAN0_MB(0U)->ID = 0x15540000U; 				/* MB0 word 1: Tx msg with STD ID 0x555 */
+	FLEXCAN0_MB(0U)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_TX_DATA, FLEXCAN_length_to_dlc(FLEXCAN0_MB_PAYLOAD))
+						| FLEXCAN_MB_CS_SRR_MASK;
 													/* EDL=1 CAN FD format frame*/
 													/* BRS=1: Bit rate is switched inside msg */
 													/* ESI=0: ??? */
@@ -179,24 +201,190 @@ void FLEXCAN0_transmit_msg(void)
 */
 void FLEXCAN0_receive_msg(void)
 {
-	uint8_t u8Index = 0U;
 	uint32_t dummy = 0U;
 
-	RxCODE   = (CAN0->RAMn[4U*MSG_BUF_SIZE + 0U] & 0x07000000U) >> 24U;  							/* Read CODE field */
-	RxID     = (CAN0->RAMn[4U*MSG_BUF_SIZE + 1U] & CAN_WMBn_ID_ID_MASK)  >> CAN_WMBn_ID_ID_SHIFT;  	/* Read ID          */
-	RxLENGTH = (CAN0->RAMn[4U*MSG_BUF_SIZE + 0U] & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT; 	/* Read Message Length */
-
-	for (u8Index = 0U; u8Index < 2U; u8Index++)
-	{  
-		/* Read two words of data (8 bytes) */
-		RxDATA[u8Index] = CAN0->RAMn[4U*MSG_BUF_SIZE + 2U + u8Index];
-	}
+	RxCODE   = (FLEXCAN0_MB(4U)->CS & 0x07000000U) >> 24U;  							/* Read CODE field */
+	RxID     = (FLEXCAN0_MB(4U)->ID & CAN_WMBn_ID_ID_MASK)  >> CAN_WMBn_ID_ID_SHIFT;  	/* Read ID          */
+	RxLENGTH = FLEXCAN0_read_payload(4U, RxDATA);	/* Read Message Length and all data words */
 	
-	RxTIMESTAMP = (CAN0->RAMn[0U*MSG_BUF_SIZE + 0U] & 0x000FFFFU);
+	RxTIMESTAMP = (FLEXCAN0_MB(4U)->CS & FLEXCAN_MB_CS_TIME_MASK);	/* Time stamp of MB4 */
 	
-	dummy = CAN0->TIMER;				/* Read TIMER to unlock message buffers */
+	dummy = FLEXCAN0_BASE->TIMER;				/* Read TIMER to unlock message buffers */
 	
-	CAN0->IFLAG1 = 0x00000010U;       	/* Clear CAN 0 MB 4 flag without clearing others*/
+	FLEXCAN0_BASE->IFLAG1 = 0x00000010U;       	/* Clear CAN 0 MB 4 flag without clearing others*/
+}
+
+/**
+* @brief            DLC to payload length.
+* @details          Decodes a CAN FD DLC code (0..15) into 0..8, 12, 16, 20, 24, 32, 48 or 64 bytes.
+* @param        	u8Dlc: DLC code, only bits 3:0 are used.
+* @return           Number of payload bytes.
+*/
+uint8_t FLEXCAN_dlc_to_length(uint8_t u8Dlc)
+{
+	return s_au8DlcToLength[u8Dlc & 0x0FU];
+}
+
+/**
+* @brief            Payload length to DLC.
+* @details          Returns the smallest DLC code whose payload holds u8Length bytes.
+* @param        	u8Length: number of data bytes, 0..64.
+* @return           DLC code, 0xFF if u8Length is above 64.
+*/
+uint8_t FLEXCAN_length_to_dlc(uint8_t u8Length)
+{
+	return (u8Length <= FLEXCAN_FD_MAX_PAYLOAD) ? s_au8LengthToDlc[u8Length] : 0xFFU;
+}
+
+/**
+* @brief            Write msg buffer payload.
+* @details          Copies u8Length bytes into the data words of msg buffer u8Mb, one word at a time
+*					with a byte swap into bus order. Pads with zeros up to the next DLC length.
+*					The buffer needs no alignment. Does not touch the CS and ID words.
+* @param        	u8Mb: msg buffer number.
+* @param        	pu8Data: payload bytes, byte 0 is sent first.
+* @param        	u8Length: number of data bytes, up to FLEXCAN0_MB_PAYLOAD.
+* @return           1 if written, 0 if u8Length does not fit the MB (nothing written).
+*/
+uint8_t FLEXCAN0_write_payload(uint8_t u8Mb, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	volatile uint32_t *pu32Mb = FLEXCAN0_MB(u8Mb)->DATA;
+	uint32_t u32Words = (uint32_t)u8Length >> 2U;
+	uint32_t u32Padded = ((uint32_t)FLEXCAN_dlc_to_length(FLEXCAN_length_to_dlc(u8Length)) + 3U) >> 2U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Word = 0U;
+
+	if (u8Length > FLEXCAN0_MB_PAYLOAD)		/* Would run into the next MB */
+	{
+		return 0U;
+	}
+
+	for (u32Index = 0U; u32Index < u32Words; u32Index++)
+	{
+		(void)memcpy(&u32Word, &pu8Data[u32Index << 2U], 4U);	/* Single LDR on Cortex-M4 */
+		pu32Mb[u32Index] = FLEXCAN_BSWAP32(u32Word);
+	}
+
+	if (0U != (u8Length & 3U))				/* Partial last word: unused bytes are zero */
+	{
+		u32Word = 0U;
+		(void)memcpy(&u32Word, &pu8Data[u32Index << 2U], (uint32_t)u8Length & 3U);
+		pu32Mb[u32Index] = FLEXCAN_BSWAP32(u32Word);
+		u32Index++;
+	}
+
+	for (; u32Index < u32Padded; u32Index++)	/* DLC padding words, never past FLEXCAN0_MB_PAYLOAD */
+	{
+		pu32Mb[u32Index] = 0U;
+	}
+
+	return 1U;
+}
+
+/**
+* @brief            Read msg buffer payload.
+* @details          Decodes the DLC of msg buffer u8Mb and copies that many bytes into pu8Data,
+*					one word at a time with a byte swap from bus order. The buffer needs no
+*					alignment and must hold 64 bytes. The MB must be locked by reading its CS word.
+*					The DLC comes from the bus, so the copy stops at FLEXCAN0_MB_PAYLOAD.
+* @param        	u8Mb: msg buffer number.
+* @param        	pu8Data: destination, byte 0 is the first byte received.
+* @return           Number of data bytes copied.
+*/
+uint8_t FLEXCAN0_read_payload(uint8_t u8Mb, uint8_t *pu8Data)
+{
+	volatile flexcan_mb_t *pMb = FLEXCAN0_MB(u8Mb);
+	volatile const uint32_t *pu32Mb = pMb->DATA;
+	uint8_t u8Length = FLEXCAN_dlc_to_length((uint8_t)((pMb->CS & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT));
+	uint32_t u32Words = 0U;
+	uint32_t u32Index = 0U;
+	uint32_t u32Word = 0U;
+
+	if (u8Length > FLEXCAN0_MB_PAYLOAD)		/* Longer frame than the MB stores: keep to the MB */
+	{
+		u8Length = FLEXCAN0_MB_PAYLOAD;
+	}
+	u32Words = (uint32_t)u8Length >> 2U;
+
+	for (u32Index = 0U; u32Index < u32Words; u32Index++)
+	{
+		u32Word = FLEXCAN_BSWAP32(pu32Mb[u32Index]);
+		(void)memcpy(&pu8Data[u32Index << 2U], &u32Word, 4U);	/* Single STR on Cortex-M4 */
+	}
+
+	if (0U != (u8Length & 3U))				/* Partial last word (DLC 1..7) */
+	{
+		u32Word = FLEXCAN_BSWAP32(pu32Mb[u32Index]);
+		(void)memcpy(&pu8Data[u32Index << 2U], &u32Word, (uint32_t)u8Length & 3U);
+	}
+
+	return u8Length;
+}
+
+
+/**
+* @brief            Set up receive msg buffer.
+* @details          Function to arm msg buffer u8Mb for reception of standard ID u32Id at run time.
+*					The global mask checks all ID bits (FLEXCAN_reset_mbs()).
+* @param        	u8Mb: msg buffer number.
+* @param        	u32Id: standard ID.
+* @return           void.
+*/
+void FLEXCAN0_set_rx_mb(uint8_t u8Mb, uint32_t u32Id)
+{
+	FLEXCAN0_MB(u8Mb)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_RX_INACTIVE, 0U);	/* Deactivate before the ID changes */
+	FLEXCAN0_MB(u8Mb)->ID = FLEXCAN_MB_ID(u32Id);
+	FLEXCAN0_MB(u8Mb)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_RX_EMPTY, 0U);		/* CODE=4: RX empty */
+}
+
+/**
+* @brief            Send frame.
+* @details          Function to load msg buffer u8Mb with standard ID u32Id and u8Length data bytes and
+*					start the transmission. The caller checks that the MB is not still transmitting.
+* @param        	u8Mb: msg buffer number.
+* @param        	u32Id: standard ID.
+* @param        	pu8Data: payload bytes, byte 0 is sent first.
+* @param        	u8Length: number of data bytes, up to FLEXCAN0_MB_PAYLOAD.
+* @return           1 if started, 0 if u8Length does not fit the MB.
+*/
+uint8_t FLEXCAN0_send(uint8_t u8Mb, uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	if (u8Length > FLEXCAN0_MB_PAYLOAD)
+	{
+		return 0U;
+	}
+
+	FLEXCAN0_BASE->IFLAG1 = 1UL << u8Mb;		/* Clear the flag of the previous transmission */
+
+	(void)FLEXCAN0_write_payload(u8Mb, pu8Data, u8Length);
+	FLEXCAN0_MB(u8Mb)->ID = FLEXCAN_MB_ID(u32Id);
+	FLEXCAN0_MB(u8Mb)->CS = FLEXCAN_MB_CS(FLEXCAN0_INST, FLEXCAN_TX_DATA, FLEXCAN_length_to_dlc(u8Length))
+						  | FLEXCAN_MB_CS_SRR_MASK;	/* CODE=0xC: transmit */
+
+	return 1U;
+}
+
+/**
+* @brief            Read receive msg buffer.
+* @details          Function to lock msg buffer u8Mb, copy its payload, unlock it and clear its flag.
+*					The MB is free for the next frame on return.
+* @param        	u8Mb: msg buffer number.
+* @param        	pu8Data: destination, must hold 64 bytes.
+* @return           Number of data bytes copied.
+*/
+uint8_t FLEXCAN0_read_mb(uint8_t u8Mb, uint8_t *pu8Data)
+{
+	uint32_t dummy = 0U;
+	uint8_t u8Length = 0U;
+
+	dummy = FLEXCAN0_MB(u8Mb)->CS;				/* Read CS to lock the msg buffer */
+	u8Length = FLEXCAN0_read_payload(u8Mb, pu8Data);
+	dummy = FLEXCAN0_BASE->TIMER;				/* Read TIMER to unlock message buffers */
+	(void)dummy;
+
+	FLEXCAN0_BASE->IFLAG1 = 1UL << u8Mb;		/* Clear the MB flag without clearing others */
+
+	return u8Length;
 }
 
 
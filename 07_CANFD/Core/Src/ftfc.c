@@ -0,0 +1,185 @@
+/**
+* @file			ftfc.c
+* @brief		P-Flash erase and program through the FTFC
+* @details		The CPU cannot read P-Flash while the FTFC runs a command on it, so the launch-and-wait
+*				loop runs from SRAM with interrupts disabled. CAN reception goes on in the FlexCAN msg
+*				buffers meanwhile.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include "ftfc.h"
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+/* RAM routine entry */
+typedef void (*ftfc_ram_fn_t)(volatile uint8_t *pFstat);
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* FCCOB registers in FTFC->FCCOB[]: each group of 4 is stored in reverse order */
+#define FTFC_FCCOB0					(3U)	/* Command */
+#define FTFC_FCCOB1					(2U)	/* Address 23:16 */
+#define FTFC_FCCOB2					(1U)	/* Address 15:8 */
+#define FTFC_FCCOB3					(0U)	/* Address 7:0 */
+#define FTFC_FCCOB_DATA				(4U)	/* Phrase byte 0 (FCCOB7), bytes 1..7 follow in memory order */
+
+/* FTFC commands */
+#define FTFC_CMD_PGM8				(0x07U)	/* Program phrase */
+#define FTFC_CMD_ERSSCR				(0x09U)	/* Erase flash sector */
+
+/* Interrupt disable / enable around a flash command. A host flash model can define them, as FTFC_LAUNCH */
+#ifndef FTFC_IRQ_DISABLE
+#if defined(__CC_ARM)
+#define FTFC_IRQ_DISABLE()			__disable_irq()
+#define FTFC_IRQ_ENABLE()			__enable_irq()
+#else
+#define FTFC_IRQ_DISABLE()			__asm volatile ("cpsid i" ::: "memory")
+#define FTFC_IRQ_ENABLE()			__asm volatile ("cpsie i" ::: "memory")
+#endif
+#endif
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      LOCAL VARIABLES
+==================================================================================================*/
+/* Thumb code of the launch routine, placed in SRAM as initialized data (r0 = &FSTAT):
+   movs r1,#0x80 / strb r1,[r0] / 1: ldrb r2,[r0] / tst r2,r1 / beq 1b / bx lr */
+static uint16_t s_au16LaunchRam[6] = {0x2180U, 0x7001U, 0x7802U, 0x420AU, 0xD0FCU, 0x4770U};
+
+/*==================================================================================================
+*                                      GLOBAL CONSTANTS
+==================================================================================================*/
+
+/*==================================================================================================
+*                                      GLOBAL VARIABLES
+==================================================================================================*/
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint8_t FTFC_run(void);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Run command.
+* @details          Launch the command loaded in FCCOB with interrupts disabled and return its result.
+* @param        	void.
+* @return           0 on success, else FSTAT error bits.
+*/
+static uint8_t FTFC_run(void)
+{
+	FTFC_IRQ_DISABLE();
+	FTFC_LAUNCH(&FTFC->FSTAT);
+	FTFC_IRQ_ENABLE();
+
+	return (uint8_t)(FTFC->FSTAT & FTFC_ERROR_MASK);
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            Launch command from RAM.
+* @details          Function to clear CCIF, which starts the loaded command, and wait for CCIF again with
+*                   code that runs from SRAM. Interrupts must be disabled (vectors and handlers are in flash).
+* @param[in]        pFstat - FTFC->FSTAT.
+* @return           void.
+*/
+void FTFC_launch_ram(volatile uint8_t *pFstat)
+{
+	ftfc_ram_fn_t pfLaunch = (ftfc_ram_fn_t)((uint32_t)s_au16LaunchRam | 1U);	/* Bit 0 = 1: Thumb state */
+
+	pfLaunch(pFstat);
+}
+
+/**
+* @brief            Erase sector.
+* @details          Function to erase the 4 KB P-Flash sector at u32Addr (ERSSCR). Blocks with interrupts
+*                   disabled until the sector is erased.
+* @param[in]        u32Addr - Sector address, FTFC_SECTOR_SIZE aligned, below FTFC_PFLASH_SIZE.
+* @return           0 on success, else FSTAT error bits (FTFC_ERROR_MASK). ACCERR without a command if
+*                   u32Addr is outside P-Flash.
+*/
+uint8_t FTFC_erase_sector(uint32_t u32Addr)
+{
+	if (u32Addr >= FTFC_PFLASH_SIZE)		/* FCCOB takes address bits 23:0 only: 0x00800000 is FlexNVM */
+	{
+		return FTFC_FSTAT_ACCERR_MASK;
+	}
+
+	while (0U == (FTFC->FSTAT & FTFC_FSTAT_CCIF_MASK))	/* Previous command still running */
+	{
+	}
+	FTFC->FSTAT = FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK;	/* Clear old errors (write 1) */
+
+	FTFC->FCCOB[FTFC_FCCOB0] = FTFC_CMD_ERSSCR;
+	FTFC->FCCOB[FTFC_FCCOB1] = (uint8_t)(u32Addr >> 16U);
+	FTFC->FCCOB[FTFC_FCCOB2] = (uint8_t)(u32Addr >> 8U);
+	FTFC->FCCOB[FTFC_FCCOB3] = (uint8_t)u32Addr;
+
+	return FTFC_run();
+}
+
+/**
+* @brief            Program phrase.
+* @details          Function to program 8 bytes at u32Addr (PGM8). Blocks with interrupts disabled until the
+*                   phrase is written. The phrase must be erased.
+* @param[in]        u32Addr - Phrase address, FTFC_PHRASE_SIZE aligned, below FTFC_PFLASH_SIZE.
+* @param[in]        pu8Data - 8 data bytes, byte 0 at u32Addr.
+* @return           0 on success, else FSTAT error bits (FTFC_ERROR_MASK). ACCERR without a command if
+*                   u32Addr is outside P-Flash.
+*/
+uint8_t FTFC_program_phrase(uint32_t u32Addr, const uint8_t *pu8Data)
+{
+	uint32_t u32Index = 0U;
+
+	if (u32Addr >= FTFC_PFLASH_SIZE)		/* FCCOB takes address bits 23:0 only */
+	{
+		return FTFC_FSTAT_ACCERR_MASK;
+	}
+
+	while (0U == (FTFC->FSTAT & FTFC_FSTAT_CCIF_MASK))	/* Previous command still running */
+	{
+	}
+	FTFC->FSTAT = FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK;	/* Clear old errors (write 1) */
+
+	FTFC->FCCOB[FTFC_FCCOB0] = FTFC_CMD_PGM8;
+	FTFC->FCCOB[FTFC_FCCOB1] = (uint8_t)(u32Addr >> 16U);
+	FTFC->FCCOB[FTFC_FCCOB2] = (uint8_t)(u32Addr >> 8U);
+	FTFC->FCCOB[FTFC_FCCOB3] = (uint8_t)u32Addr;
+	for (u32Index = 0U; u32Index < FTFC_PHRASE_SIZE; u32Index++)
+	{
+		FTFC->FCCOB[FTFC_FCCOB_DATA + u32Index] = pu8Data[u32Index];	/* FCCOB7..4, FCCOBB..8 */
+	}
+
+	return FTFC_run();
+}
+
+/**
+* @brief            Invalidate flash cache.
+* @details          Function to invalidate the code cache (LMEM), so reads after programming see the new data.
+* @param        	void.
+* @return           void.
+*/
+void FTFC_invalidate_cache(void)
+{
+	LMEM->PCCCR |= LMEM_PCCCR_INVW0_MASK | LMEM_PCCCR_INVW1_MASK | LMEM_PCCCR_GO_MASK;	/* Invalidate both ways */
+	while (0U != (LMEM->PCCCR & LMEM_PCCCR_GO_MASK))
+	{
+	}
+}
+
+
+/* END ftfc */
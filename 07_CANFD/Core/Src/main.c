@@ -24,6 +24,8 @@
 #define PTE5		(5U)
 /* Port PTD16, bit 16: EVB output to green LED */
 #define PTD16		(16U)
+/* 1: serve firmware updates over CAN FD (can_fwu) next to the echo loop */
+#define FWU_MODE	(0U)
 
 /*==================================================================================================
 *                                      LOCAL CONSTANTS
@@ -121,6 +123,10 @@ int main(void)
 	
 	FLEXCAN0_transmit_msg(); /* Transmit initial message from EVB to CAN tool */
 	
+#if (1U == FWU_MODE)
+	can_fwu_init();			/* Update service on MB1..3 */
+#endif
+	
 	/*----------------------------------------------------------- */
 	/*    Infinite For                                            */
 	/*----------------------------------------------------------- */ 
@@ -137,6 +143,9 @@ int main(void)
 			}
 			FLEXCAN0_transmit_msg(); /* Transmit message using MB0 */	
 		}
+#if (1U == FWU_MODE)
+		can_fwu_poll();			/* Update commands and image data */
+#endif
 	}
 }
 
@@ -0,0 +1,322 @@
+/**
+* @file			can_fwu_send.c
+* @brief		Host sender for the CAN FD firmware update service
+* @details		Sends a binary image to a node running can_fwu over a Linux SocketCAN CAN FD interface
+*				and reports the throughput. Host tool, not part of the firmware build:
+*
+*				cc -std=gnu99 -O2 -o can_fwu_send can_fwu_send.c
+*				ip link set can0 up type can bitrate 500000 dbitrate 2000000 fd on
+*				can_fwu_send [-i can0] [-a 0x10000] image.bin
+*
+*				Protocol, see can_fwu.h: START, one 64 byte data frame per ack, VERIFY.
+*/
+
+/*==================================================================================================
+*                                        INCLUDE FILES
+* 1) system and project includes
+* 2) needed interfaces from external units
+* 3) internal and external interfaces from this unit
+==================================================================================================*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+/*==================================================================================================
+*                          LOCAL TYPEDEFS (STRUCTURES, UNIONS, ENUMS)
+==================================================================================================*/
+
+/*==================================================================================================
+*                                       LOCAL MACROS
+==================================================================================================*/
+/* Same values as can_fwu.h */
+#define FWU_CTRL_ID				(0x7E0U)
+#define FWU_DATA_ID				(0x7E1U)
+#define FWU_RESP_ID				(0x7E8U)
+#define FWU_CHUNK				(64U)
+#define FWU_CMD_START			(0x01U)
+#define FWU_CMD_DATA			(0x02U)
+#define FWU_CMD_VERIFY			(0x03U)
+#define FWU_RESP				(0x80U)
+#define FWU_REGION_SIZE			(0x00070000U)	/* 0x00010000 .. 0x00080000 */
+
+/* Response timeouts in ms: START erases up to 112 sectors of about 12 ms each */
+#define FWU_TIMEOUT_START		(5000)
+#define FWU_TIMEOUT_DATA		(200)
+#define FWU_TIMEOUT_VERIFY		(2000)
+
+/*==================================================================================================
+*                                      LOCAL CONSTANTS
+==================================================================================================*/
+/* Status names, by status code */
+static const char *const s_apcStatus[] = {"ok", "range", "flash", "sequence", "crc"};
+
+/*==================================================================================================
+*                                   LOCAL FUNCTION PROTOTYPES
+==================================================================================================*/
+static uint32_t crc32(const uint8_t *pu8Data, uint32_t u32Size);
+static double now_s(void);
+static int send_frame(int iSock, uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length);
+static int wait_response(int iSock, uint8_t u8Cmd, int iTimeoutMs, uint32_t *pu32Value);
+static int fail(const char *pcStep, int iStatus);
+
+/*==================================================================================================
+*                                       LOCAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief            CRC-32 (IEEE 802.3), same as can_fwu_crc32().
+*/
+static uint32_t crc32(const uint8_t *pu8Data, uint32_t u32Size)
+{
+	uint32_t u32Crc = 0xFFFFFFFFU;
+	uint32_t u32Index = 0U;
+	uint32_t u32Bit = 0U;
+
+	for (u32Index = 0U; u32Index < u32Size; u32Index++)
+	{
+		u32Crc ^= pu8Data[u32Index];
+		for (u32Bit = 0U; u32Bit < 8U; u32Bit++)
+		{
+			u32Crc = (u32Crc >> 1U) ^ (0xEDB88320U & (0U - (u32Crc & 1U)));
+		}
+	}
+
+	return ~u32Crc;
+}
+
+/**
+* @brief            Monotonic time in seconds.
+*/
+static double now_s(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/**
+* @brief            Send CAN FD frame with bit rate switch.
+* @details          The length is rounded up to a CAN FD length, padding with 0xFF.
+* @return           0 on success, -1 on error.
+*/
+static int send_frame(int iSock, uint32_t u32Id, const uint8_t *pu8Data, uint8_t u8Length)
+{
+	static const uint8_t au8FdLength[] = {0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U};
+	struct canfd_frame frame;
+	uint32_t u32Index = 0U;
+
+	while (au8FdLength[u32Index] < u8Length)
+	{
+		u32Index++;
+	}
+
+	memset(&frame, 0xFF, sizeof(frame));
+	frame.can_id = u32Id;
+	frame.len = au8FdLength[u32Index];
+	frame.flags = CANFD_BRS;
+	frame.__res0 = 0U;
+	frame.__res1 = 0U;
+	memcpy(frame.data, pu8Data, u8Length);
+
+	return (sizeof(frame) == (size_t)write(iSock, &frame, sizeof(frame))) ? 0 : -1;
+}
+
+/**
+* @brief            Wait for the response to a command.
+* @param[out]       pu32Value - Response value.
+* @return           Status of the response, -1 on timeout.
+*/
+static int wait_response(int iSock, uint8_t u8Cmd, int iTimeoutMs, uint32_t *pu32Value)
+{
+	struct pollfd pfd;
+	struct canfd_frame frame;
+	double dEnd = now_s() + ((double)iTimeoutMs * 1e-3);
+	int iLeft = iTimeoutMs;
+
+	pfd.fd = iSock;
+	pfd.events = POLLIN;
+
+	while ((iLeft > 0) && (poll(&pfd, 1U, iLeft) > 0))
+	{
+		if ((read(iSock, &frame, sizeof(frame)) > 0) && (FWU_RESP_ID == frame.can_id) && (frame.len >= 6U)
+			&& ((u8Cmd | FWU_RESP) == frame.data[0]))
+		{
+			*pu32Value = ((uint32_t)frame.data[2] << 24U) | ((uint32_t)frame.data[3] << 16U)
+					   | ((uint32_t)frame.data[4] << 8U) | (uint32_t)frame.data[5];
+			return frame.data[1];
+		}
+		iLeft = (int)((dEnd - now_s()) * 1e3);
+	}
+
+	return -1;
+}
+
+/**
+* @brief            Print a failed step and return the exit code.
+*/
+static int fail(const char *pcStep, int iStatus)
+{
+	if (iStatus < 0)
+	{
+		fprintf(stderr, "%s: send failed or no response\n", pcStep);
+	}
+	else
+	{
+		fprintf(stderr, "%s: %s\n", pcStep,
+				((size_t)iStatus < (sizeof(s_apcStatus) / sizeof(s_apcStatus[0]))) ? s_apcStatus[iStatus] : "error");
+	}
+	return 1;
+}
+
+/*==================================================================================================
+*                                       GLOBAL FUNCTIONS
+==================================================================================================*/
+/**
+* @brief			Send an image file.
+*/
+int main(int argc, char **argv)
+{
+	const char *pcIface = "can0";
+	const char *pcPath = NULL;
+	uint32_t u32Addr = 0x00010000U;
+	uint32_t u32Size = 0U;
+	uint32_t u32Crc = 0U;
+	uint32_t u32Offset = 0U;
+	uint32_t u32Value = 0U;
+	uint32_t u32Count = 0U;
+	uint8_t au8Cmd[13];
+	static uint8_t au8Image[FWU_REGION_SIZE];
+	struct sockaddr_can addr;
+	struct ifreq ifr;
+	struct can_filter filter;
+	double dStart = 0.0;
+	double dData = 0.0;
+	double dEnd = 0.0;
+	int iEnable = 1;
+	int iSock = -1;
+	int iArg = 0;
+	int iStatus = 0;
+	FILE *pFile = NULL;
+
+	for (iArg = 1; iArg < argc; iArg++)
+	{
+		if ((0 == strcmp(argv[iArg], "-i")) && ((iArg + 1) < argc))
+		{
+			pcIface = argv[++iArg];
+		}
+		else if ((0 == strcmp(argv[iArg], "-a")) && ((iArg + 1) < argc))
+		{
+			u32Addr = (uint32_t)strtoul(argv[++iArg], NULL, 0);
+		}
+		else
+		{
+			pcPath = argv[iArg];
+		}
+	}
+
+	if (NULL == pcPath)
+	{
+		fprintf(stderr, "usage: %s [-i iface] [-a address] image.bin\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(pcPath, "rb");
+	if (NULL == pFile)
+	{
+		perror(pcPath);
+		return 1;
+	}
+	u32Size = (uint32_t)fread(au8Image, 1U, sizeof(au8Image), pFile);
+	if ((0U == u32Size) || (EOF != fgetc(pFile)))
+	{
+		fprintf(stderr, "%s: empty or larger than %u bytes\n", pcPath, (unsigned)FWU_REGION_SIZE);
+		fclose(pFile);
+		return 1;
+	}
+	fclose(pFile);
+	u32Crc = crc32(au8Image, u32Size);
+
+	iSock = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, pcIface, IFNAMSIZ - 1U);
+	filter.can_id = FWU_RESP_ID;
+	filter.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+	if ((iSock < 0) || (ioctl(iSock, SIOCGIFINDEX, &ifr) < 0)
+		|| (setsockopt(iSock, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &iEnable, sizeof(iEnable)) < 0)
+		|| (setsockopt(iSock, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter)) < 0))
+	{
+		perror(pcIface);
+		return 1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifr.ifr_ifindex;
+	if (bind(iSock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		perror(pcIface);
+		return 1;
+	}
+
+	printf("%s: %u bytes, CRC-32 %08X, to 0x%08X\n", pcPath, (unsigned)u32Size, (unsigned)u32Crc, (unsigned)u32Addr);
+
+	/* START: erase */
+	au8Cmd[0] = FWU_CMD_START;
+	for (iArg = 0; iArg < 4; iArg++)
+	{
+		au8Cmd[1 + iArg] = (uint8_t)(u32Addr >> (24 - (8 * iArg)));
+		au8Cmd[5 + iArg] = (uint8_t)(u32Size >> (24 - (8 * iArg)));
+		au8Cmd[9 + iArg] = (uint8_t)(u32Crc >> (24 - (8 * iArg)));
+	}
+	dStart = now_s();
+	if ((0 != (iStatus = send_frame(iSock, FWU_CTRL_ID, au8Cmd, 13U)))
+		|| (0 != (iStatus = wait_response(iSock, FWU_CMD_START, FWU_TIMEOUT_START, &u32Value))))
+	{
+		return fail("start", iStatus);
+	}
+
+	/* Data: the ack comes before the node programs the chunk, so the next frame overlaps the flash write */
+	dData = now_s();
+	for (u32Offset = 0U; u32Offset < u32Size; u32Offset += u32Count)
+	{
+		u32Count = ((u32Size - u32Offset) < FWU_CHUNK) ? (u32Size - u32Offset) : FWU_CHUNK;
+		if ((0 != (iStatus = send_frame(iSock, FWU_DATA_ID, &au8Image[u32Offset], (uint8_t)u32Count)))
+			|| (0 != (iStatus = wait_response(iSock, FWU_CMD_DATA, FWU_TIMEOUT_DATA, &u32Value))))
+		{
+			fprintf(stderr, "at offset %u: ", (unsigned)u32Offset);
+			return fail("data", iStatus);
+		}
+		if (u32Value != (u32Offset + u32Count))
+		{
+			fprintf(stderr, "data: node has %u bytes, expected %u\n", (unsigned)u32Value, (unsigned)(u32Offset + u32Count));
+			return 1;
+		}
+	}
+
+	/* VERIFY: CRC-32 of the flash contents */
+	au8Cmd[0] = FWU_CMD_VERIFY;
+	if ((0 != (iStatus = send_frame(iSock, FWU_CTRL_ID, au8Cmd, 1U)))
+		|| (0 != (iStatus = wait_response(iSock, FWU_CMD_VERIFY, FWU_TIMEOUT_VERIFY, &u32Value))))
+	{
+		return fail("verify", iStatus);
+	}
+	dEnd = now_s();
+
+	printf("erase %.3f s, data %.3f s (%.1f KiB/s), total %.3f s (%.1f KiB/s), node CRC-32 %08X\n",
+		   dData - dStart, dEnd - dData, ((double)u32Size / 1024.0) / (dEnd - dData),
+		   dEnd - dStart, ((double)u32Size / 1024.0) / (dEnd - dStart), (unsigned)u32Value);
+
+	close(iSock);
+	return 0;
+}
+
+
+/* END can_fwu_send */